@@ -126,6 +126,7 @@ public:
     return original_.hostGauges();
   }
   SystemTime snapshotTime() const override { return original_.snapshotTime(); }
+  bool partial() const override { return original_.partial(); }
 
 private:
   Stats::MetricSnapshot& original_;
@@ -264,6 +264,14 @@ public:
    */
   virtual void* linearize(uint32_t size) PURE;
 
+  /**
+   * Release memory the buffer holds but does not need for its content. The content is copied into
+   * storage sized to fit it if that frees memory, unless the buffer holds fragments or drain
+   * trackers. Memory is acquired again as data is added.
+   * @return uint64_t the number of bytes of memory released.
+   */
+  virtual uint64_t shrinkToFit() PURE;
+
   /**
    * Move a buffer into this buffer. As little copying is done as possible.
    * @param rhs supplies the buffer to move.
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include "envoy/common/pure.h"
 #include "envoy/network/address.h"
 #include "envoy/thread_local/thread_local.h"
 
+struct statx;
+
 namespace Envoy {
 namespace Io {
 
@@ -27,9 +31,12 @@ public:
     Close = 0x10,
     Cancel = 0x20,
     Shutdown = 0x40,
+    // An operation on a regular file, which is not tied to an io_uring socket.
+    File = 0x80,
   };
 
-  Request(RequestType type, IoUringSocket& socket) : type_(type), socket_(socket) {}
+  Request(RequestType type, IoUringSocket& socket) : type_(type), socket_(&socket) {}
+  explicit Request(RequestType type) : type_(type) {}
   virtual ~Request() = default;
 
   /**
@@ -38,13 +45,14 @@ public:
   RequestType type() const { return type_; }
 
   /**
-   * Returns the io_uring socket the request belongs to.
+   * Returns the io_uring socket the request belongs to. Must not be called for requests of type
+   * RequestType::File.
    */
-  IoUringSocket& socket() const { return socket_; }
+  IoUringSocket& socket() const { return *socket_; }
 
 private:
   RequestType type_;
-  IoUringSocket& socket_;
+  IoUringSocket* socket_{};
 };
 
 /**
@@ -52,9 +60,12 @@ private:
  * @param user_data is any data attached to an entry submitted to the submission
  * queue.
  * @param result is a return code of submitted system call.
+ * @param flags are the flags of the completion queue entry, e.g. IORING_CQE_F_MORE for a
+ * multishot request which stays armed. Always 0 for injected completions.
  * @param injected indicates whether the completion is injected or not.
  */
-using CompletionCb = std::function<void(Request* user_data, int32_t result, bool injected)>;
+using CompletionCb =
+    std::function<void(Request* user_data, int32_t result, uint32_t flags, bool injected)>;
 
 /**
  * Callback for releasing the user data.
@@ -101,6 +112,14 @@ public:
   virtual IoUringResult prepareAccept(os_fd_t fd, struct sockaddr* remote_addr,
                                       socklen_t* remote_addr_len, Request* user_data) PURE;
 
+  /**
+   * Prepares a multishot accept, which completes once per accepted socket until it is canceled
+   * or fails, and puts it into the submission queue.
+   * Returns IoUringResult::Failed in case the submission queue is full already
+   * and IoUringResult::Ok otherwise.
+   */
+  virtual IoUringResult prepareAcceptMultishot(os_fd_t fd, Request* user_data) PURE;
+
   /**
    * Prepares a connect system call and puts it into the submission queue.
    * Returns IoUringResult::Failed in case the submission queue is full already
@@ -118,6 +137,33 @@ public:
   virtual IoUringResult prepareReadv(os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs,
                                      off_t offset, Request* user_data) PURE;
 
+  /**
+   * Prepares a multishot recv into the provided buffers, which completes once per received chunk
+   * of data until it is canceled, fails or the peer closes the connection, and puts it into the
+   * submission queue. Provided buffers must have been registered with registerProvidedBuffers().
+   * Returns IoUringResult::Failed in case the submission queue is full already
+   * and IoUringResult::Ok otherwise.
+   */
+  virtual IoUringResult prepareRecvMultishot(os_fd_t fd, Request* user_data) PURE;
+
+  /**
+   * Prepares a recvmsg system call and puts it into the submission queue.
+   * Returns IoUringResult::Failed in case the submission queue is full already
+   * and IoUringResult::Ok otherwise.
+   */
+  virtual IoUringResult prepareRecvmsg(os_fd_t fd, struct msghdr* msg, Request* user_data) PURE;
+
+  /**
+   * Prepares a multishot recvmsg into the provided buffers, which completes once per received
+   * datagram until it is canceled or fails, and puts it into the submission queue. Only the name
+   * and control lengths of msg are used. Provided buffers must have been registered with
+   * registerProvidedBuffers().
+   * Returns IoUringResult::Failed in case the submission queue is full already
+   * and IoUringResult::Ok otherwise.
+   */
+  virtual IoUringResult prepareRecvmsgMultishot(os_fd_t fd, struct msghdr* msg,
+                                                Request* user_data) PURE;
+
   /**
    * Prepares a writev system call and puts it into the submission queue.
    * Returns IoUringResult::Failed in case the submission queue is full already
@@ -147,6 +193,45 @@ public:
    */
   virtual IoUringResult prepareShutdown(os_fd_t fd, int how, Request* user_data) PURE;
 
+  /**
+   * Prepares an openat system call and puts it into the submission queue.
+   * Returns IoUringResult::Failed in case the submission queue is full already
+   * and IoUringResult::Ok otherwise.
+   */
+  virtual IoUringResult prepareOpenat(os_fd_t dir_fd, const char* path, int flags, mode_t mode,
+                                      Request* user_data) PURE;
+
+  /**
+   * Prepares a statx system call and puts it into the submission queue.
+   * Returns IoUringResult::Failed in case the submission queue is full already
+   * and IoUringResult::Ok otherwise.
+   */
+  virtual IoUringResult prepareStatx(os_fd_t dir_fd, const char* path, int flags, unsigned mask,
+                                     struct statx* statx_buf, Request* user_data) PURE;
+
+  /**
+   * Prepares an unlinkat system call and puts it into the submission queue.
+   * Returns IoUringResult::Failed in case the submission queue is full already
+   * and IoUringResult::Ok otherwise.
+   */
+  virtual IoUringResult prepareUnlinkat(os_fd_t dir_fd, const char* path, int flags,
+                                        Request* user_data) PURE;
+
+  /**
+   * Prepares a linkat system call and puts it into the submission queue.
+   * Returns IoUringResult::Failed in case the submission queue is full already
+   * and IoUringResult::Ok otherwise.
+   */
+  virtual IoUringResult prepareLinkat(os_fd_t old_dir_fd, const char* old_path, os_fd_t new_dir_fd,
+                                      const char* new_path, int flags, Request* user_data) PURE;
+
+  /**
+   * Prepares an ftruncate system call and puts it into the submission queue.
+   * Returns IoUringResult::Failed in case the submission queue is full already
+   * and IoUringResult::Ok otherwise.
+   */
+  virtual IoUringResult prepareFtruncate(os_fd_t fd, off_t length, Request* user_data) PURE;
+
   /**
    * Submits the entries in the submission queue to the kernel using the
    * `io_uring_enter()` system call.
@@ -157,6 +242,29 @@ public:
    */
   virtual IoUringResult submit() PURE;
 
+  /**
+   * Registers a ring of buffers which the kernel picks from for multishot receives.
+   * Returns IoUringResult::Failed if the kernel does not support provided buffer rings and
+   * IoUringResult::Ok otherwise. Must be called at most once.
+   * @param num_buffers is the number of buffers, which must be a power of two no larger than
+   * 32768.
+   * @param buffer_size is the size of each buffer.
+   */
+  virtual IoUringResult registerProvidedBuffers(uint32_t num_buffers, uint32_t buffer_size) PURE;
+
+  /**
+   * Returns the provided buffer the kernel filled for a completion. The buffer stays owned by
+   * the kernel again once it is recycled with recycleProvidedBuffer().
+   * @param buffer_id is the id of the buffer, in the flags of the completion.
+   */
+  virtual uint8_t* providedBuffer(uint16_t buffer_id) PURE;
+
+  /**
+   * Hands a provided buffer back to the kernel.
+   * @param buffer_id is the id of the buffer, in the flags of the completion.
+   */
+  virtual void recycleProvidedBuffer(uint16_t buffer_id) PURE;
+
   /**
    * Inject a request completion into the io_uring. Those completions will be iterated
    * when calling the `forEveryCompletion`. This is used to inject an emulated iouring
@@ -204,6 +312,22 @@ struct ReadParam {
   int32_t result_;
 };
 
+/**
+ * A datagram received by a datagram socket.
+ */
+struct ReceivedDatagram {
+  // The source address of the datagram.
+  sockaddr_storage peer_address_{};
+  socklen_t peer_address_len_{};
+  // The control messages of the datagram, laid out as recvmsg() lays them out in msg_control.
+  std::vector<uint8_t> control_;
+  std::vector<uint8_t> payload_;
+  // The msg_flags recvmsg() returned with the datagram, e.g. MSG_TRUNC.
+  int flags_{};
+};
+
+using ReceivedDatagramPtr = std::unique_ptr<ReceivedDatagram>;
+
 /**
  * The data returned from the write request.
  */
@@ -376,6 +500,18 @@ public:
    * @param cb the callback function.
    */
   virtual void setFileReadyCb(Event::FileReadyCb cb) PURE;
+
+  /**
+   * Return the next socket an accept socket accepted.
+   * @return the file descriptor of the accepted socket, or INVALID_SOCKET if there is none.
+   */
+  virtual os_fd_t nextAcceptedSocket() PURE;
+
+  /**
+   * Return the next datagram a datagram socket received.
+   * @return the datagram, or nullptr if there is none.
+   */
+  virtual ReceivedDatagramPtr nextReceivedDatagram() PURE;
 };
 
 using IoUringSocketPtr = std::unique_ptr<IoUringSocket>;
@@ -405,11 +541,31 @@ public:
   virtual IoUringSocket& addClientSocket(os_fd_t fd, Event::FileReadyCb cb,
                                          bool enable_close_event) PURE;
 
+  /**
+   * Add a listening socket to the worker. The callback is invoked with
+   * `Event::FileReadyType::Read` when there are accepted sockets to take with
+   * `IoUringSocket::nextAcceptedSocket()`.
+   */
+  virtual IoUringSocket& addAcceptSocket(os_fd_t fd, Event::FileReadyCb cb) PURE;
+
+  /**
+   * Add a datagram socket to the worker. The callback is invoked with
+   * `Event::FileReadyType::Read` when there are datagrams to take with
+   * `IoUringSocket::nextReceivedDatagram()`.
+   */
+  virtual IoUringSocket& addDatagramSocket(os_fd_t fd, Event::FileReadyCb cb) PURE;
+
   /**
    * Return the current thread's dispatcher.
    */
   virtual Event::Dispatcher& dispatcher() PURE;
 
+  /**
+   * Submit an accept request for a listening socket. The request is multishot if the worker has
+   * provided buffers.
+   */
+  virtual Request* submitAcceptRequest(IoUringSocket& socket) PURE;
+
   /**
    * Submit a connect request for a socket.
    */
@@ -418,10 +574,17 @@ public:
                        const Network::Address::InstanceConstSharedPtr& address) PURE;
 
   /**
-   * Submit a read request for a socket.
+   * Submit a read request for a socket. The request is multishot, reading into the provided
+   * buffers, if the worker has provided buffers.
    */
   virtual Request* submitReadRequest(IoUringSocket& socket) PURE;
 
+  /**
+   * Submit a recvmsg request for a datagram socket. The request is multishot, reading into the
+   * provided buffers, if the worker has provided buffers.
+   */
+  virtual Request* submitRecvmsgRequest(IoUringSocket& socket) PURE;
+
   /**
    * Submit a write request for a socket.
    */
@@ -447,6 +610,11 @@ public:
    * Return the number of sockets in the worker.
    */
   virtual uint32_t getNumOfSockets() const PURE;
+
+  /**
+   * Return whether the worker reads into provided buffers with multishot requests.
+   */
+  virtual bool hasProvidedBuffers() const PURE;
 };
 
 /**
@@ -286,6 +286,12 @@ public:
    * the handle.
    */
   virtual RequestDecoderHandlePtr getRequestDecoderHandle() PURE;
+
+  /**
+   * @return the arena that the codec should allocate this stream's request headers and trailers
+   * from, or nullptr to allocate them from the heap.
+   */
+  virtual StreamArenaSharedPtr streamArena() PURE;
 };
 
 /**
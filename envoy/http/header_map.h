@@ -5,6 +5,7 @@
 #include <cstring>
 #include <iosfwd>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -310,6 +311,14 @@ private:
   DEFINE_INLINE_HEADER(name)                                                                       \
   virtual void set##name(uint64_t) PURE;
 
+/**
+ * Memory that the header maps of a single stream allocate their entries from, released in one go
+ * once the stream and every header map allocated from it are gone. Each such header map holds a
+ * reference to the resource, so maps that outlive the stream remain valid. The resource is not
+ * thread safe: header maps allocated from it may only be modified on the stream's thread.
+ */
+using StreamArenaSharedPtr = std::shared_ptr<std::pmr::memory_resource>;
+
 /**
  * Wraps a set of HTTP headers.
  */
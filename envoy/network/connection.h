@@ -279,12 +279,28 @@ public:
    */
   virtual void setConnectionStats(const ConnectionStats& stats) PURE;
 
+  /**
+   * Account bytes that were moved directly on the connection's socket without passing through
+   * the connection's buffers, e.g. with splice(2). The bytes are added to the totals of the stats
+   * set with setConnectionStats().
+   * @param bytes_read supplies the number of bytes read from the socket.
+   * @param bytes_written supplies the number of bytes written to the socket.
+   */
+  virtual void addDirectSocketBytes(uint64_t bytes_read, uint64_t bytes_written) PURE;
+
   /**
    * @return the const SSL connection data if this is an SSL connection, or nullptr if it is not.
    */
   // TODO(snowp): Remove this in favor of StreamInfo::downstreamSslConnection.
   virtual Ssl::ConnectionInfoConstSharedPtr ssl() const PURE;
 
+  /**
+   * @return true if the connection's transport socket passes bytes through unmodified, i.e. the
+   *         payload on the wire is exactly what is read from and written to the connection.
+   *         @see TransportSocket::isPassthrough().
+   */
+  virtual bool hasPassthroughTransport() const PURE;
+
   /**
    * @return requested server name (e.g. SNI in TLS), if any.
    */
@@ -443,6 +459,18 @@ public:
    */
   virtual void setTransportSocketConnectTimeout(std::chrono::milliseconds timeout,
                                                 Stats::Counter& timeout_stat) PURE;
+
+  /**
+   * Set the amount of time the connection may go without socket events before it releases the
+   * memory its buffers hold but don't need. Memory is acquired again on the next read or write. A
+   * zero timeout disables the release.
+   *
+   * Each time the timeout is reached, `shed_stat` is incremented and `shed_bytes_stat` is
+   * increased by the number of bytes released.
+   */
+  virtual void setIdleMemoryShedTimeout(std::chrono::milliseconds timeout,
+                                        Stats::Counter& shed_stat,
+                                        Stats::Counter& shed_bytes_stat) PURE;
 };
 
 using ServerConnectionPtr = std::unique_ptr<ServerConnection>;
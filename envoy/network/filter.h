@@ -339,6 +339,13 @@ public:
    */
   virtual bool initializeReadFilters() PURE;
 
+  /**
+   * @param filter supplies a read filter installed on the connection.
+   * @return true if the given filter is the only read filter and no write filters are installed,
+   *         i.e. no other filter would observe data that the given filter moves past the chain.
+   */
+  virtual bool isSoleFilter(const ReadFilter& filter) const PURE;
+
   /**
    * Add a network access log handler to the connection. The added log handlers will be called on
    * during connections' destruction.
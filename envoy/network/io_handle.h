@@ -15,6 +15,7 @@
 
 #include "absl/container/fixed_array.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 
 namespace Envoy {
 namespace Buffer {
@@ -129,6 +130,31 @@ public:
                                           int flags, const Address::Ip* self_ip,
                                           const Address::Instance& peer_address) PURE;
 
+  /**
+   * Send each slice as a datagram of its own to the address, with a single sendmmsg() call if the
+   * platform supports it. The default implementation sends them one at a time with sendmsg().
+   * @param datagrams supplies the datagrams to be sent.
+   * @param peer_address is the destination address.
+   * @return a Api::IoCallUint64Result with err_ = an Api::IoError instance if the first datagram
+   * could not be sent, or err_ = nullptr and rc_ = the number of datagrams sent, which may be fewer
+   * than given.
+   */
+  virtual Api::IoCallUint64Result sendmmsg(absl::Span<const Buffer::RawSlice> datagrams,
+                                           const Address::Instance& peer_address) {
+    uint64_t sent = 0;
+    for (const Buffer::RawSlice& datagram : datagrams) {
+      Api::IoCallUint64Result result = sendmsg(&datagram, 1, 0, nullptr, peer_address);
+      if (!result.ok()) {
+        if (sent == 0) {
+          return result;
+        }
+        break;
+      }
+      ++sent;
+    }
+    return Api::IoCallUint64Result(sent, Api::IoError::none());
+  }
+
   struct RecvMsgPerPacketInfo {
     // The destination address from transport header.
     Address::InstanceConstSharedPtr local_address_;
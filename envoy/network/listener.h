@@ -168,6 +168,12 @@ public:
    * @return bool whether the listener should bypass overload manager actions
    */
   virtual bool shouldBypassOverloadManager() const PURE;
+
+  /**
+   * @return bool whether accepted connections that were received on a different CPU than the one
+   * the accepting worker runs on should be counted.
+   */
+  virtual bool trackIncomingCpu() const PURE;
 };
 
 using ListenerInfoConstSharedPtr = std::shared_ptr<const ListenerInfo>;
@@ -222,6 +228,13 @@ public:
    */
   virtual std::chrono::milliseconds perConnectionBufferHighWatermarkTimeout() const PURE;
 
+  /**
+   * @return std::chrono::milliseconds specifying how long a connection may go without socket
+   * events before it releases the memory its buffers hold but don't need. A zero duration disables
+   * the release.
+   */
+  virtual std::chrono::milliseconds perConnectionIdleMemoryShedTimeout() const PURE;
+
   /**
    * @return std::chrono::milliseconds the time to wait for all listener filters to complete
    *         operation. If the timeout is reached, the accepted socket is closed without a
@@ -182,6 +182,12 @@ static_assert(IP_RECVDSTADDR == IP_SENDSRCADDR);
 #define ENVOY_ATTACH_REUSEPORT_CBPF Network::SocketOptionName()
 #endif
 
+#ifdef SO_INCOMING_CPU
+#define ENVOY_SOCKET_SO_INCOMING_CPU ENVOY_MAKE_SOCKET_OPTION_NAME(SOL_SOCKET, SO_INCOMING_CPU)
+#else
+#define ENVOY_SOCKET_SO_INCOMING_CPU Network::SocketOptionName()
+#endif
+
 #if !defined(ANDROID) && defined(__APPLE__)
 // Only include TargetConditionals after testing ANDROID as some Android builds
 // on the Mac have this header available and it's not needed unless the target
@@ -191,6 +191,13 @@ public:
    */
   virtual Ssl::ConnectionInfoConstSharedPtr ssl() const PURE;
 
+  /**
+   * @return true if this transport socket reads and writes the bytes of the underlying socket
+   * without transforming or injecting any data, so that callers may move payload directly between
+   * file descriptors (e.g. with splice(2)) once the connection is established.
+   */
+  virtual bool isPassthrough() const { return false; }
+
   /**
    * Instructs a transport socket to start using secure transport.
    * It is up to the caller of this method to manage the coordination between the client
@@ -94,6 +94,13 @@ public:
    * @return uint32_t a multiple of the flush interval to perform stats eviction, or 0 if disabled.
    */
   virtual uint32_t evictOnFlush() const PURE;
+
+  /**
+   * @return uint32_t a multiple of the flush interval at which flushes include all metrics, with
+   *         the flushes in between only including the metrics that changed, or 0 if every flush
+   *         includes all metrics.
+   */
+  virtual uint32_t fullFlushOnFlush() const PURE;
 };
 
 /**
@@ -267,6 +267,12 @@ public:
    */
   virtual bool cpusetThreadsEnabled() const PURE;
 
+  /**
+   * @return the CPUs that worker threads are pinned to, indexed by worker. Empty if workers are not
+   *         pinned.
+   */
+  virtual const std::vector<uint32_t>& workerCpus() const PURE;
+
   /**
    * @return the names of extensions to disable.
    */
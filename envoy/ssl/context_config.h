@@ -125,6 +125,12 @@ public:
   virtual absl::optional<
       envoy::extensions::transport_sockets::tls::v3::TlsParameters::CompliancePolicy>
   compliancePolicy() const PURE;
+
+  /**
+   * @return true if the record layer of established connections should be offloaded to kernel
+   * TLS when the negotiated parameters allow it.
+   */
+  virtual bool kernelTlsOffload() const PURE;
 };
 
 class ClientContextConfig : public virtual ContextConfig {
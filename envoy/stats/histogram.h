@@ -31,6 +31,13 @@ public:
    * @return An optional override for the number of bins.
    */
   virtual absl::optional<uint32_t> bins(absl::string_view stat_name) const PURE;
+
+  /**
+   * Number of helper threads over which the merge of thread local histograms is spread at each
+   * stats flush.
+   * @return The number of helper threads, or zero to merge on the main thread only.
+   */
+  virtual uint32_t mergeThreads() const PURE;
 };
 
 using HistogramSettingsConstPtr = std::unique_ptr<const HistogramSettings>;
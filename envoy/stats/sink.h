@@ -57,6 +57,13 @@ public:
    * @return the time in UTC since epoch when the snapshot was created.
    */
   virtual SystemTime snapshotTime() const PURE;
+
+  /**
+   * @return true if the snapshot only includes the metrics that changed since the previous
+   *         snapshot, i.e. the metrics that are not included kept the values they were last
+   *         flushed with.
+   */
+  virtual bool partial() const PURE;
 };
 
 /**
@@ -238,6 +238,14 @@ public:
    */
   virtual void setStatsMatcher(StatsMatcherPtr&& stats_matcher) PURE;
 
+  /**
+   * Attach a StatsMatcher selecting the counters that are sharded, i.e. that spread their
+   * increments over per-thread slots to avoid contention between workers. Only affects counters
+   * created after the call.
+   * @param sharded_counter_matcher a StatsMatcher accepting the names of sharded counters.
+   */
+  virtual void setShardedCounterMatcher(StatsMatcherPtr&& sharded_counter_matcher) PURE;
+
   /**
    * Attach a HistogramSettings to this StoreRoot to generate histogram configurations
    * according to some ruleset.
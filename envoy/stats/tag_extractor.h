@@ -59,6 +59,20 @@ public:
    */
   virtual absl::string_view prefixToken() const PURE;
 
+  /**
+   * Finds an RE2 pattern that matches at least every stat name from which this
+   * extractor can extract a tag. This is used to test many extractors against a
+   * stat name in a single scan, and only apply those whose pattern matched.
+   *
+   * If no such pattern is known, an empty string_view is returned, and the
+   * extractor must be applied on all inputs.
+   *
+   * The storage for the pattern is owned by the TagExtractor.
+   *
+   * @return absl::string_view the pattern, or an empty string_view if none is known.
+   */
+  virtual absl::string_view prefilterPattern() const PURE;
+
   virtual bool otherExtractorWithSameNameExists() const PURE;
   virtual void setOtherExtractorWithSameNameExists(bool e) PURE;
 };
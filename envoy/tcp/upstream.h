@@ -181,6 +181,12 @@ public:
    * @return the failure reason of the local close.
    */
   virtual absl::string_view localCloseReason() const { return ""; }
+
+  /**
+   * @return the upstream network connection if this upstream proxies raw bytes over a single
+   *         connection (i.e. it is not tunneling), or an empty reference otherwise.
+   */
+  virtual OptRef<Network::Connection> rawConnection() { return {}; }
 };
 
 using GenericConnPoolPtr = std::unique_ptr<GenericConnPool>;
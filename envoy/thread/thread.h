@@ -65,6 +65,9 @@ struct Options {
   // If no value is set, the thread will be created with the default thread priority for the
   // platform.
   absl::optional<int> priority_{absl::nullopt};
+  // An optional CPU to pin the thread to. Only honored on Linux; elsewhere the thread is left
+  // unpinned.
+  absl::optional<uint32_t> cpu_{absl::nullopt};
 };
 
 using OptionsOptConstRef = const absl::optional<Options>&;
@@ -539,6 +539,13 @@ public:
    * @return true to use host weights to calculate the health of a priority.
    */
   virtual bool weightedPriorityHealth() const PURE;
+
+  /**
+   * @return true if all hosts in the set had the same weight when the set was last updated. The
+   * value is computed once on the main thread and carried to the worker copies of the set with
+   * each membership update, so that worker load balancers do not have to scan the hosts again.
+   */
+  virtual bool hostWeightsAreEqual() const PURE;
 };
 
 using HostSetPtr = std::unique_ptr<HostSet>;
@@ -607,6 +614,9 @@ public:
     HostsPerLocalityConstSharedPtr healthy_hosts_per_locality;
     HostsPerLocalityConstSharedPtr degraded_hosts_per_locality;
     HostsPerLocalityConstSharedPtr excluded_hosts_per_locality;
+    // Whether all hosts have the same weight, if already known from the host set the hosts were
+    // taken from. Computed from the hosts otherwise.
+    absl::optional<bool> host_weights_are_equal;
   };
 
   /**
@@ -17,6 +17,14 @@ namespace {
 static constexpr Filesystem::FlagSet default_flags{1 << Filesystem::File::Operation::Write |
                                                    1 << Filesystem::File::Operation::Create |
                                                    1 << Filesystem::File::Operation::Append};
+
+// Index of the calling thread among all threads that wrote to an access log, used to pick a write
+// shard. Assigned on the first write so that a worker keeps appending to the same shard.
+uint32_t writerThreadIndex() {
+  static std::atomic<uint32_t> next_index{0};
+  thread_local const uint32_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
 } // namespace
 
 AccessLogManagerImpl::~AccessLogManagerImpl() {
@@ -64,8 +72,11 @@ AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatch
                                      Thread::ThreadFactory& thread_factory)
     : file_(std::move(file)), file_lock_(lock),
       flush_timer_(dispatcher.createTimer([this]() -> void {
-        stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        // Don't wake up the flush thread just to find every shard empty.
+        if (hasBufferedWrites()) {
+          stats_.flushed_by_timer_.inc();
+          requestFlush();
+        }
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
       thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec),
@@ -74,26 +85,36 @@ AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatch
 }
 
 void AccessLogFileImpl::reopen() {
-  Thread::LockGuard lock(write_lock_);
+  Thread::LockGuard lock(flush_event_lock_);
   reopen_file_ = true;
   flush_event_.notifyOne();
 }
 
+void AccessLogFileImpl::requestFlush() {
+  Thread::LockGuard lock(flush_event_lock_);
+  flush_requested_ = true;
+  flush_event_.notifyOne();
+}
+
 AccessLogFileImpl::~AccessLogFileImpl() {
+  Thread::ThreadPtr flush_thread;
   {
-    Thread::LockGuard lock(write_lock_);
+    Thread::LockGuard lock(flush_event_lock_);
     flush_thread_exit_ = true;
     flush_event_.notifyOne();
+    flush_thread = std::move(flush_thread_);
   }
 
-  if (flush_thread_ != nullptr) {
-    flush_thread_->join();
+  if (flush_thread != nullptr) {
+    flush_thread->join();
   }
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (file_->isOpen()) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
+    Thread::LockGuard flush_lock(flush_lock_);
+    collectWriteShards();
+    if (about_to_write_buffer_.length() > 0) {
+      doWrite(about_to_write_buffer_);
     }
     const Api::IoCallBoolResult result = file_->close();
     ASSERT(result.return_value_, fmt::format("unable to close file '{}': {}", file_->path(),
@@ -130,6 +151,23 @@ void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
   buffer.drain(buffer.length());
 }
 
+void AccessLogFileImpl::collectWriteShards() {
+  for (WriteShard& shard : write_shards_) {
+    Thread::LockGuard shard_lock(shard.lock_);
+    about_to_write_buffer_.move(shard.buffer_);
+  }
+}
+
+bool AccessLogFileImpl::hasBufferedWrites() {
+  for (WriteShard& shard : write_shards_) {
+    Thread::LockGuard shard_lock(shard.lock_);
+    if (shard.buffer_.length() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void AccessLogFileImpl::flushThreadFunc() {
 
   // Transfer the action from `reopen_file_` to this variable so that `reopen_file_` is only
@@ -138,36 +176,35 @@ void AccessLogFileImpl::flushThreadFunc() {
   bool do_reopen = false;
 
   while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
-
     {
-      Thread::LockGuard write_lock(write_lock_);
+      Thread::LockGuard event_lock(flush_event_lock_);
 
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
+      // flush_event_ can be woken up either by a large enough write shard or by timer. The timer
+      // only requests a flush when a shard had data, but a synchronous flush may have collected
+      // it since, so the write shards can still be empty.
       //
       // Note: do not stop waiting when only `do_reopen` is true. In this case, we tried to
       // reopen and failed. We don't want to retry this in a tight loop, so wait for the next
       // event (timer or flush).
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_ && !reopen_file_) {
+      while (!flush_requested_ && !flush_thread_exit_ && !reopen_file_) {
         // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
+        flush_event_.wait(flush_event_lock_);
       }
 
       if (flush_thread_exit_) {
         return;
       }
 
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
-
+      flush_requested_ = false;
       if (reopen_file_) {
         do_reopen = true;
         reopen_file_ = false;
       }
     }
 
+    Thread::LockGuard flush_lock(flush_lock_);
+    collectWriteShards();
+
     if (do_reopen) {
       if (file_->isOpen()) {
         const Api::IoCallBoolResult result = file_->close();
@@ -187,47 +224,51 @@ void AccessLogFileImpl::flushThreadFunc() {
 }
 
 void AccessLogFileImpl::flush() {
-  std::unique_lock<Thread::BasicLockable> flush_buffer_lock;
-
-  {
-    Thread::LockGuard write_lock(write_lock_);
-
-    // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
-    // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
-    // but has not yet completed doWrite(). This would allow flush() to
-    // return before the pending data has actually been written to disk.
-    flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
-
-    about_to_write_buffer_.move(flush_buffer_);
-    ASSERT(flush_buffer_.length() == 0);
+  // flush_lock_ must be held while collecting the write shards or else it is
+  // possible that flushThreadFunc() has already moved data from the shards
+  // to about_to_write_buffer_ but has not yet completed doWrite(). This would
+  // allow flush() to return before the pending data has actually been written
+  // to disk.
+  Thread::LockGuard flush_lock(flush_lock_);
+  collectWriteShards();
+  if (about_to_write_buffer_.length() == 0) {
+    return;
   }
 
   doWrite(about_to_write_buffer_);
 }
 
 void AccessLogFileImpl::write(absl::string_view data) {
-  Thread::LockGuard lock(write_lock_);
+  stats_.write_buffered_.inc();
+  stats_.write_total_buffered_.add(data.length());
 
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
+  bool flush_needed;
+  {
+    WriteShard& shard = write_shards_[writerThreadIndex() % WriteShards];
+    Thread::LockGuard lock(shard.lock_);
+    shard.buffer_.add(data.data(), data.size());
+    flush_needed = shard.buffer_.length() > min_flush_size_;
   }
 
-  stats_.write_buffered_.inc();
-  stats_.write_total_buffered_.add(data.length());
-  flush_buffer_.add(data.data(), data.size());
-  if (flush_buffer_.length() > min_flush_size_) {
-    flush_event_.notifyOne();
+  ensureFlushThread();
+  if (flush_needed) {
+    requestFlush();
   }
 }
 
-void AccessLogFileImpl::createFlushStructures() {
-  flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); },
-                                               Thread::Options{"AccessLogFlush"});
+void AccessLogFileImpl::ensureFlushThread() {
+  if (flush_thread_started_.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  Thread::LockGuard lock(flush_event_lock_);
+  if (flush_thread_ == nullptr && !flush_thread_exit_) {
+    // Flush whatever has been written so far as soon as the thread runs.
+    flush_requested_ = true;
+    flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); },
+                                                 Thread::Options{"AccessLogFlush"});
+  }
+  flush_thread_started_.store(true, std::memory_order_release);
 }
 
 } // namespace AccessLog
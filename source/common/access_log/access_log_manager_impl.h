@@ -2,6 +2,8 @@
 
 #include <sys/types.h>
 
+#include <array>
+#include <atomic>
 #include <string>
 
 #include "envoy/access_log/access_log.h"
@@ -65,6 +67,11 @@ private:
  * This implementation uses a flush thread per file, with the idea there aren't that many
  * files. If this turns out to be a good implementation we can potentially have a single flush
  * thread that flushes all files, but we will start with this.
+ *
+ * Writers append to one of several write shards, picked by the writing thread, so that workers
+ * logging to the same file do not contend on a single lock. The flush thread collects all shards
+ * when it flushes. Lines from different threads may therefore be written in a different order than
+ * they were logged, but every line is written in one piece.
  */
 class AccessLogFileImpl : public AccessLogFile {
 public:
@@ -77,6 +84,10 @@ public:
   // AccessLog::AccessLogFile
   void write(absl::string_view data) override;
 
+  // Number of buffers writers append to. Threads are spread over the shards round robin, in the
+  // order in which they first write to any access log.
+  static constexpr uint32_t WriteShards = 16;
+
   /**
    * Reopen file asynchronously.
    * This only sets reopen flag, actual reopen operation is delayed.
@@ -86,16 +97,30 @@ public:
   void flush() override;
 
 private:
+  // Each shard gets its own cache line, so that writers on different shards don't invalidate each
+  // other's lock.
+  struct alignas(64) WriteShard {
+    Thread::MutexBasicLockable lock_; // Only contended by threads sharing the shard and by the
+                                      // thread collecting the shards for a flush.
+    Buffer::OwnedImpl buffer_ ABSL_GUARDED_BY(lock_);
+  };
+
   void doWrite(Buffer::Instance& buffer);
   void flushThreadFunc();
-  void createFlushStructures();
+  void ensureFlushThread();
+  void requestFlush();
+  // Returns true if any write shard holds data that has not been collected for a flush yet.
+  bool hasBufferedWrites();
+  // Moves the contents of all write shards into about_to_write_buffer_. flush_lock_ must be held.
+  void collectWriteShards();
 
   Filesystem::FilePtr file_;
 
   // These locks are always acquired in the following order if multiple locks are held:
-  //    1) write_lock_
-  //    2) flush_lock_
+  //    1) flush_lock_
+  //    2) WriteShard::lock_
   //    3) file_lock_
+  // flush_event_lock_ is never held while acquiring any of the other locks.
   Thread::BasicLockable& file_lock_;      // This lock is used only by the flush thread when writing
                                           // to disk. This is used to make sure that file blocks do
                                           // not get interleaved by multiple processes writing to
@@ -106,23 +131,21 @@ private:
                                           // and all other data used during flushing and file
                                           // re-opening.
   Thread::MutexBasicLockable
-      write_lock_; // The lock is used when filling the flush buffer. It allows
-                   // multiple threads to write to the same file at relatively
-                   // high performance. It is always local to the process.
-  Thread::ThreadPtr flush_thread_;
+      flush_event_lock_; // This lock protects the state used to wake up the flush thread. Writers
+                         // only take it when their shard grew past min_flush_size_.
+  std::array<WriteShard, WriteShards> write_shards_;
+  std::atomic<bool> flush_thread_started_{false};
+  Thread::ThreadPtr flush_thread_ ABSL_GUARDED_BY(flush_event_lock_);
   Thread::CondVar flush_event_;
-  bool flush_thread_exit_ ABSL_GUARDED_BY(write_lock_){false};
-  bool reopen_file_ ABSL_GUARDED_BY(write_lock_){false};
-  Buffer::OwnedImpl
-      flush_buffer_ ABSL_GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It
-                                                  // gets filled and then flushed either when max
-                                                  // size is reached or when a timer fires.
+  bool flush_thread_exit_ ABSL_GUARDED_BY(flush_event_lock_){false};
+  bool reopen_file_ ABSL_GUARDED_BY(flush_event_lock_){false};
+  bool flush_requested_ ABSL_GUARDED_BY(flush_event_lock_){false};
   // TODO(jmarantz): this should be ABSL_GUARDED_BY(flush_lock_) but the analysis cannot poke
   // through the std::make_unique assignment. I do not believe it's possible to annotate this
   // properly now due to limitations in the clang thread annotation analysis.
-  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only by the flush thread. Data
-                                            // is moved from flush_buffer_ under lock, and then
-                                            // the lock is released so that flush_buffer_ can
+  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only while flushing. Data is
+                                            // moved from the write shards under their locks,
+                                            // which are then released so that the shards can
                                             // continue to fill. This buffer is then used for the
                                             // final write to disk.
   Event::TimerPtr flush_timer_;
@@ -19,10 +19,6 @@ namespace {
 constexpr uint64_t CopyThreshold = 512;
 } // namespace
 
-thread_local absl::InlinedVector<Slice::StoragePtr,
-                                 OwnedImpl::OwnedImplReservationSlicesOwnerMultiple::free_list_max_>
-    OwnedImpl::OwnedImplReservationSlicesOwnerMultiple::free_list_;
-
 uint64_t Slice::prepend(const void* data, uint64_t size) {
   const uint8_t* src = static_cast<const uint8_t*>(data);
   uint64_t copy_size;
@@ -204,6 +200,33 @@ void OwnedImpl::drainImpl(uint64_t size) {
   }
 }
 
+void OwnedImpl::extractSlices(uint64_t length, SliceDeque& slices) {
+  ASSERT(length <= length_);
+  while (length != 0 && !slices_.empty()) {
+    Slice& front = slices_.front();
+    const uint64_t slice_size = front.dataSize();
+    if (slice_size > length) {
+      // Copy the bytes that are not extracted so that the extracted slice is never modified.
+      const uint64_t remaining = slice_size - length;
+      Slice tail(remaining, account_);
+      tail.append(front.data() + length, remaining);
+      slices.emplace_back(std::move(front));
+      slices_.pop_front();
+      slices_.emplace_front(std::move(tail));
+      length_ -= length;
+      length = 0;
+    } else {
+      if (slice_size != 0) {
+        slices.emplace_back(std::move(front));
+      }
+      slices_.pop_front();
+      length_ -= slice_size;
+      length -= slice_size;
+    }
+  }
+  postProcess();
+}
+
 RawSliceVector OwnedImpl::getRawSlices(absl::optional<uint64_t> max_slices) const {
   uint64_t max_out = slices_.size();
   if (max_slices.has_value()) {
@@ -309,6 +332,33 @@ void* OwnedImpl::linearize(uint32_t size) {
   return slices_.front().data();
 }
 
+uint64_t OwnedImpl::shrinkToFit() {
+  uint64_t capacity = 0;
+  bool can_copy = length_ > 0;
+  for (const Slice& slice : slices_) {
+    if (!slice.canCoalesce() || slice.hasDrainTrackers()) {
+      can_copy = false;
+      break;
+    }
+    capacity += slice.ownedCapacity();
+  }
+
+  uint64_t released = 0;
+  // Storage is allocated by the page, so the content is only copied if that frees a page or more.
+  if (can_copy && Slice::sliceSize(length_) < capacity) {
+    Slice fitted(length_, account_);
+    for (const Slice& slice : slices_) {
+      fitted.append(slice.data(), slice.dataSize());
+    }
+    released = capacity - fitted.ownedCapacity();
+    while (!slices_.empty()) {
+      slices_.pop_front();
+    }
+    slices_.emplace_back(std::move(fitted));
+  }
+  return released + slices_.shrinkToFit();
+}
+
 void OwnedImpl::coalesceOrAddSlice(Slice&& other_slice) {
   const uint64_t slice_size = other_slice.dataSize();
   // The `other_slice` content can be coalesced into the existing slice IFF:
@@ -9,6 +9,7 @@
 #include "envoy/buffer/buffer.h"
 #include "envoy/http/stream_reset_handler.h"
 
+#include "source/common/buffer/slice_storage_pool.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/non_copyable.h"
 #include "source/common/common/utility.h"
@@ -37,7 +38,7 @@ namespace Buffer {
 class Slice {
 public:
   using Reservation = RawSlice;
-  using StoragePtr = std::unique_ptr<uint8_t[]>;
+  using StoragePtr = SliceStoragePool::StoragePtr;
 
   struct SizedStorage {
     StoragePtr mem_;
@@ -57,7 +58,7 @@ public:
    * @param account the account to charge.
    */
   Slice(uint64_t min_capacity, const BufferMemoryAccountSharedPtr& account)
-      : capacity_(sliceSize(min_capacity)), storage_(new uint8_t[capacity_]),
+      : capacity_(sliceSize(min_capacity)), storage_(allocateStorage(capacity_)),
         base_(storage_.get()) {
     if (account) {
       account->charge(capacity_);
@@ -114,6 +115,7 @@ public:
   Slice& operator=(Slice&& rhs) noexcept {
     if (this != &rhs) {
       callAndClearDrainTrackersAndCharges();
+      releaseStorage(std::move(storage_), capacity_);
 
       capacity_ = rhs.capacity_;
       storage_ = std::move(rhs.storage_);
@@ -142,6 +144,7 @@ public:
     if (releasor_) {
       releasor_();
     }
+    releaseStorage(std::move(storage_), capacity_);
   }
 
   /**
@@ -154,6 +157,16 @@ public:
    */
   bool canCoalesce() const { return storage_ != nullptr; }
 
+  /**
+   * @return the number of bytes of storage the slice owns.
+   */
+  uint64_t ownedCapacity() const { return storage_ != nullptr ? capacity_ : 0; }
+
+  /**
+   * @return true if drain trackers are attached to the slice.
+   */
+  bool hasDrainTrackers() const { return !drain_trackers_.empty(); }
+
   /**
    * @return a pointer to the start of the usable content.
    */
@@ -365,7 +378,29 @@ public:
    */
   static inline SizedStorage newStorage(uint64_t min_capacity) {
     const uint64_t slice_size = sliceSize(min_capacity);
-    return {StoragePtr{new uint8_t[slice_size]}, static_cast<size_t>(slice_size)};
+    return {allocateStorage(slice_size), static_cast<size_t>(slice_size)};
+  }
+
+  /**
+   * Allocate backend storage of exactly the given size. Default-sized storage comes from the
+   * SliceStoragePool.
+   * @param size the size of the storage, in bytes.
+   */
+  static inline StoragePtr allocateStorage(uint64_t size) {
+    static_assert(SliceStoragePool::StorageSize == default_slice_size_);
+    return size == default_slice_size_ ? SliceStoragePool::allocate()
+                                       : StoragePtr{new uint8_t[size]};
+  }
+
+  /**
+   * Free backend storage, returning default-sized storage to the SliceStoragePool.
+   * @param storage the storage to free, which may be null.
+   * @param size the size the storage was allocated with.
+   */
+  static inline void releaseStorage(StoragePtr storage, uint64_t size) {
+    if (storage != nullptr && size == default_slice_size_) {
+      SliceStoragePool::release(std::move(storage));
+    }
   }
 
 protected:
@@ -529,6 +564,25 @@ public:
 
   ConstIterator end() const noexcept { return {*this, size_}; }
 
+  /**
+   * Move the slices back to the inline ring if they fit in it, freeing the external ring.
+   * @return the number of bytes freed.
+   */
+  size_t shrinkToFit() {
+    if (external_ring_ == nullptr || size_ > InlineRingCapacity) {
+      return 0;
+    }
+    const size_t freed = capacity_ * sizeof(Slice);
+    for (size_t i = 0; i < size_; i++) {
+      inline_ring_[i] = std::move(ring_[internalIndex(i)]);
+    }
+    external_ring_.reset();
+    ring_ = inline_ring_;
+    start_ = 0;
+    capacity_ = InlineRingCapacity;
+    return freed;
+  }
+
 private:
   constexpr static size_t InlineRingCapacity = 8;
 
@@ -666,6 +720,7 @@ public:
   SliceDataPtr extractMutableFrontSlice() override;
   uint64_t length() const override;
   void* linearize(uint32_t size) override;
+  uint64_t shrinkToFit() override;
   void move(Instance& rhs) override;
   void move(Instance& rhs, uint64_t length) override;
   void move(Instance& rhs, uint64_t length, bool reset_drain_trackers_and_accounting) override;
@@ -678,6 +733,19 @@ public:
   // LibEventInstance
   void postProcess() override;
 
+  /**
+   * Removes the slices holding the first `length` bytes of the buffer and appends them to
+   * `slices` without copying or coalescing their storage, so that the memory stays valid and
+   * unmodified for as long as the extracted slices are alive. This is used by zero copy sends,
+   * where the kernel keeps referencing the sent bytes until it reports completion. A slice that is
+   * only partially covered by `length` is extracted as a whole and its remaining bytes are copied
+   * into a new slice at the front of the buffer. Drain trackers and account charges of extracted
+   * slices are released when the slices are destroyed.
+   * @param length supplies the number of bytes to remove from the front of the buffer.
+   * @param slices supplies the container the extracted slices are appended to.
+   */
+  void extractSlices(uint64_t length, SliceDeque& slices);
+
   /**
    * Create a new slice at the end of the buffer, and copy the supplied content into it.
    * @param data start of the content to copy.
@@ -763,32 +831,18 @@ private:
 
   struct OwnedImplReservationSlicesOwnerMultiple : public OwnedImplReservationSlicesOwner {
   public:
-    static constexpr uint32_t free_list_max_ = Buffer::Reservation::MAX_SLICES_;
-
-    OwnedImplReservationSlicesOwnerMultiple() : free_list_ref_(free_list_) {}
     ~OwnedImplReservationSlicesOwnerMultiple() override {
       for (auto r = owned_storages_.rbegin(); r != owned_storages_.rend(); r++) {
         if (r->mem_ != nullptr) {
           ASSERT(r->len_ == Slice::default_slice_size_);
-          if (free_list_ref_.size() < free_list_max_) {
-            free_list_ref_.push_back(std::move(r->mem_));
-          }
+          SliceStoragePool::release(std::move(r->mem_));
         }
       }
     }
 
     Slice::SizedStorage newStorage() {
       ASSERT(Slice::sliceSize(Slice::default_slice_size_) == Slice::default_slice_size_);
-
-      Slice::SizedStorage storage{nullptr, Slice::default_slice_size_};
-      if (!free_list_ref_.empty()) {
-        storage.mem_ = std::move(free_list_ref_.back());
-        free_list_ref_.pop_back();
-      } else {
-        storage.mem_.reset(new uint8_t[Slice::default_slice_size_]);
-      }
-
-      return storage;
+      return {SliceStoragePool::allocate(), Slice::default_slice_size_};
     }
 
     absl::Span<Slice::SizedStorage> ownedStorages() override {
@@ -796,19 +850,13 @@ private:
     }
 
     absl::InlinedVector<Slice::SizedStorage, Buffer::Reservation::MAX_SLICES_> owned_storages_;
-
-  private:
-    // Thread local resolving introduces additional overhead. Initialize this reference once when
-    // constructing the owner to reduce thread local resolving to improve performance.
-    absl::InlinedVector<Slice::StoragePtr, free_list_max_>& free_list_ref_;
-
-    // Simple thread local cache to reduce unnecessary memory allocation and release. This cache
-    // is currently only used for multiple slices reservation because of the additional overhead
-    // that thread local resolving would introduce.
-    static thread_local absl::InlinedVector<Slice::StoragePtr, free_list_max_> free_list_;
   };
 
   struct OwnedImplReservationSlicesOwnerSingle : public OwnedImplReservationSlicesOwner {
+    ~OwnedImplReservationSlicesOwnerSingle() override {
+      Slice::releaseStorage(std::move(owned_storage_.mem_), owned_storage_.len_);
+    }
+
     absl::Span<Slice::SizedStorage> ownedStorages() override {
       return absl::MakeSpan(&owned_storage_, 1);
     }
@@ -0,0 +1,171 @@
+#include "source/common/buffer/slice_storage_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "source/common/common/macros.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Buffer {
+
+namespace {
+
+using StoragePtr = SliceStoragePool::StoragePtr;
+
+struct GlobalPool {
+  absl::Mutex mutex_;
+  std::vector<StoragePtr> free_ ABSL_GUARDED_BY(mutex_);
+  uint64_t max_storages_ ABSL_GUARDED_BY(mutex_){SliceStoragePool::DefaultMaxGlobalBytes /
+                                                 SliceStoragePool::StorageSize};
+  // Mirrors free_.size() so that threads can skip the lock when the pool is empty.
+  std::atomic<size_t> size_{0};
+  // Incremented by releaseFreeMemory() to make the thread caches drop their storages.
+  std::atomic<uint64_t> generation_{0};
+};
+
+// Intentionally leaked so that thread caches can still reach it while threads exit during
+// process teardown.
+GlobalPool& globalPool() { MUTABLE_CONSTRUCT_ON_FIRST_USE(GlobalPool); }
+
+// Slices owned by other thread locals can be freed after the thread's cache is destroyed; they
+// then bypass the pool. A bool has no destructor, so it stays readable until the thread is gone.
+thread_local bool thread_cache_destroyed = false;
+
+class ThreadCache {
+public:
+  ~ThreadCache() { thread_cache_destroyed = true; }
+
+  StoragePtr allocate() {
+    maybeDrop();
+    if (free_.empty()) {
+      refill();
+    }
+    if (free_.empty()) {
+      return StoragePtr{new uint8_t[SliceStoragePool::StorageSize]};
+    }
+    StoragePtr storage = std::move(free_.back());
+    free_.pop_back();
+    return storage;
+  }
+
+  void release(StoragePtr storage) {
+    maybeDrop();
+    if (free_.size() == SliceStoragePool::ThreadCacheMax) {
+      spill();
+    }
+    free_.push_back(std::move(storage));
+  }
+
+  // Drops the cached storages if releaseFreeMemory() was called since the last check.
+  void maybeDrop() {
+    const uint64_t generation = globalPool().generation_.load(std::memory_order_relaxed);
+    if (generation != generation_) {
+      free_.clear();
+      generation_ = generation;
+    }
+  }
+
+  size_t size() const { return free_.size(); }
+
+private:
+  void refill() {
+    GlobalPool& global = globalPool();
+    if (global.size_.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+    absl::MutexLock lock(global.mutex_);
+    const size_t count = std::min<size_t>(SliceStoragePool::TransferBatch, global.free_.size());
+    for (size_t i = 0; i < count; ++i) {
+      free_.push_back(std::move(global.free_.back()));
+      global.free_.pop_back();
+    }
+    global.size_.store(global.free_.size(), std::memory_order_relaxed);
+  }
+
+  void spill() {
+    // Storages that do not fit in the global pool are freed after the lock is released.
+    absl::InlinedVector<StoragePtr, SliceStoragePool::TransferBatch> overflow;
+    GlobalPool& global = globalPool();
+    absl::MutexLock lock(global.mutex_);
+    for (uint32_t i = 0; i < SliceStoragePool::TransferBatch; ++i) {
+      if (global.free_.size() < global.max_storages_) {
+        global.free_.push_back(std::move(free_.back()));
+      } else {
+        overflow.push_back(std::move(free_.back()));
+      }
+      free_.pop_back();
+    }
+    global.size_.store(global.free_.size(), std::memory_order_relaxed);
+  }
+
+  absl::InlinedVector<StoragePtr, SliceStoragePool::ThreadCacheMax> free_;
+  uint64_t generation_{};
+};
+
+ThreadCache* threadCache() {
+  if (thread_cache_destroyed) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+} // namespace
+
+StoragePtr SliceStoragePool::allocate() {
+  ThreadCache* cache = threadCache();
+  return cache != nullptr ? cache->allocate() : StoragePtr{new uint8_t[StorageSize]};
+}
+
+void SliceStoragePool::release(StoragePtr storage) {
+  ThreadCache* cache = threadCache();
+  if (cache != nullptr) {
+    cache->release(std::move(storage));
+  }
+}
+
+void SliceStoragePool::setMaxGlobalBytes(uint64_t max_bytes) {
+  std::vector<StoragePtr> excess;
+  GlobalPool& global = globalPool();
+  absl::MutexLock lock(global.mutex_);
+  global.max_storages_ = max_bytes / StorageSize;
+  while (global.free_.size() > global.max_storages_) {
+    excess.push_back(std::move(global.free_.back()));
+    global.free_.pop_back();
+  }
+  global.size_.store(global.free_.size(), std::memory_order_relaxed);
+}
+
+void SliceStoragePool::releaseFreeMemory() {
+  std::vector<StoragePtr> released;
+  GlobalPool& global = globalPool();
+  {
+    absl::MutexLock lock(global.mutex_);
+    released.swap(global.free_);
+    global.size_.store(0, std::memory_order_relaxed);
+    global.generation_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Only the calling thread's cache can be dropped right away.
+  if (ThreadCache* cache = threadCache(); cache != nullptr) {
+    cache->maybeDrop();
+  }
+}
+
+uint64_t SliceStoragePool::globalPoolBytes() {
+  GlobalPool& global = globalPool();
+  absl::MutexLock lock(global.mutex_);
+  return global.free_.size() * StorageSize;
+}
+
+size_t SliceStoragePool::threadCacheSize() {
+  ThreadCache* cache = threadCache();
+  return cache != nullptr ? cache->size() : 0;
+}
+
+} // namespace Buffer
+} // namespace Envoy
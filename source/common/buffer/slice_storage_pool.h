@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * Recycles the backing storage of default-sized buffer slices, which account for nearly all slice
+ * allocations on the data path, to take the allocator out of the read/drain cycle.
+ *
+ * Each thread keeps a small cache of free storages that it allocates from and releases to without
+ * any locking. A thread whose cache overflows hands a batch of storages to a global pool, which
+ * other threads refill their caches from; the global pool is bounded by DefaultMaxGlobalBytes, and
+ * storages beyond the bound are returned to the allocator. releaseFreeMemory() empties the global
+ * pool and tells every thread to empty its cache the next time it allocates or releases a slice,
+ * and is called when the overload manager asks to shrink the heap.
+ */
+class SliceStoragePool {
+public:
+  using StoragePtr = std::unique_ptr<uint8_t[]>;
+
+  // Size of the pooled storages. Matches Slice::default_slice_size_.
+  static constexpr uint64_t StorageSize = 16384;
+  // Maximum number of free storages cached by each thread.
+  static constexpr uint32_t ThreadCacheMax = 16;
+  // Number of storages moved between a thread cache and the global pool at a time.
+  static constexpr uint32_t TransferBatch = ThreadCacheMax / 2;
+  // Default bound of the global pool.
+  static constexpr uint64_t DefaultMaxGlobalBytes = 16 * 1024 * 1024;
+
+  /**
+   * @return a storage of StorageSize bytes.
+   */
+  static StoragePtr allocate();
+
+  /**
+   * Returns a storage of StorageSize bytes, allocated with new[], to the pool.
+   */
+  static void release(StoragePtr storage);
+
+  /**
+   * Frees every storage in the global pool, and makes each thread free its cache the next time it
+   * uses the pool.
+   */
+  static void releaseFreeMemory();
+
+  /**
+   * @return the number of bytes held by the global pool.
+   */
+  static uint64_t globalPoolBytes();
+
+  /**
+   * @return the number of storages cached by the calling thread.
+   */
+  static size_t threadCacheSize();
+
+private:
+  /**
+   * Sets the maximum number of bytes held by the global pool. Storages in excess of the new bound
+   * are freed. The bound is DefaultMaxGlobalBytes outside of tests.
+   */
+  static void setMaxGlobalBytes(uint64_t max_bytes);
+
+  friend class SliceStoragePoolPeer;
+};
+
+} // namespace Buffer
+} // namespace Envoy
@@ -232,8 +232,15 @@ Event::SchedulableCallbackPtr DispatcherImpl::createSchedulableCallback(std::fun
   });
 }
 
+void DispatcherImpl::enableTimingWheel(std::chrono::milliseconds resolution) {
+  ASSERT(isThreadSafe());
+  ASSERT(timing_wheel_ == nullptr);
+  timing_wheel_ = std::make_unique<TimingWheelScheduler>(*scheduler_, *this, resolution);
+}
+
 TimerPtr DispatcherImpl::createTimerInternal(TimerCb cb) {
-  return scheduler_->createTimer(
+  Scheduler& scheduler = timing_wheel_ != nullptr ? *timing_wheel_ : *scheduler_;
+  return scheduler.createTimer(
       [this, cb]() {
         touchWatchdog();
         cb();
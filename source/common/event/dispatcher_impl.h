@@ -18,6 +18,7 @@
 #include "source/common/common/thread.h"
 #include "source/common/event/libevent.h"
 #include "source/common/event/libevent_scheduler.h"
+#include "source/common/event/timing_wheel_scheduler.h"
 #include "source/common/signal/fatal_error_handler.h"
 
 #include "absl/container/inlined_vector.h"
@@ -55,6 +56,15 @@ public:
    */
   event_base& base() { return base_scheduler_.base(); }
 
+  /**
+   * Makes timers created from now on, including the timers backing scaled timers, live in a
+   * hierarchical timing wheel with the given resolution rather than in libevent. Arming and
+   * disarming such a timer is O(1), at the cost of rounding its deadline up to the resolution.
+   * Timers armed with enableHRTimer(), and timers created before the call, keep using libevent.
+   * May only be called once.
+   */
+  void enableTimingWheel(std::chrono::milliseconds resolution);
+
   // Event::Dispatcher
   const std::string& name() override { return name_; }
   void registerWatchdog(const Server::WatchDogSharedPtr& watchdog,
@@ -150,6 +160,8 @@ private:
   Buffer::WatermarkFactorySharedPtr buffer_factory_;
   LibeventScheduler base_scheduler_;
   SchedulerPtr scheduler_;
+  // Declared before everything that may own a timer, so that it outlives them.
+  std::unique_ptr<TimingWheelScheduler> timing_wheel_;
 
   SchedulableCallbackPtr thread_local_delete_cb_;
   Thread::MutexBasicLockable thread_local_deletable_lock_;
@@ -0,0 +1,310 @@
+#include "source/common/event/timing_wheel_scheduler.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/scope_tracker.h"
+
+#include "absl/numeric/bits.h"
+
+namespace Envoy {
+namespace Event {
+
+namespace {
+
+// Level ids of the slots that are not part of the wheel proper.
+constexpr uint32_t OverflowLevel = TimingWheelScheduler::Levels;
+constexpr uint32_t DueLevel = TimingWheelScheduler::Levels + 1;
+// Number of ticks spanned by the wheel.
+constexpr uint32_t WheelBits = TimingWheelScheduler::SlotBits * TimingWheelScheduler::Levels;
+constexpr uint64_t WordBits = 64;
+
+} // namespace
+
+TimingWheelScheduler::TimingWheelScheduler(Scheduler& base_scheduler, Dispatcher& dispatcher,
+                                           std::chrono::milliseconds resolution)
+    : base_scheduler_(base_scheduler), dispatcher_(dispatcher), resolution_(resolution),
+      epoch_(dispatcher.timeSource().monotonicTime()),
+      base_timer_(base_scheduler.createTimer([this]() { onBaseTimer(); }, dispatcher)) {
+  ASSERT(resolution_.count() > 0);
+}
+
+TimingWheelScheduler::~TimingWheelScheduler() = default;
+
+TimerPtr TimingWheelScheduler::createTimer(const TimerCb& cb, Dispatcher& dispatcher) {
+  return std::make_unique<TimingWheelTimer>(*this, cb, dispatcher);
+}
+
+void TimingWheelScheduler::arm(TimingWheelTimer& timer, std::chrono::microseconds delay) {
+  if (timer.slot_ != nullptr) {
+    disarm(timer);
+  }
+
+  if (delay.count() < 0) {
+    IS_ENVOY_BUG(
+        fmt::format("Negative duration passed to a timing wheel timer: {}", delay.count()));
+    delay = std::chrono::microseconds(0);
+  }
+  // Same bound as TimerUtils::durationToTimeval().
+  delay = std::min<std::chrono::microseconds>(delay, std::chrono::seconds(INT32_MAX));
+
+  // Zero delay timers run on the next base timer run, like libevent timers do, rather than being
+  // deferred to the next tick.
+  timer.expiry_tick_ =
+      delay.count() == 0
+          ? current_tick_
+          : ticksSinceEpoch(dispatcher_.timeSource().monotonicTime() + delay, true);
+  file(timer);
+  ++size_;
+
+  const uint64_t tick = slotTick(timer);
+  if (!base_timer_tick_.has_value() || tick < base_timer_tick_.value()) {
+    scheduleBaseTimer();
+  }
+}
+
+void TimingWheelScheduler::disarm(TimingWheelTimer& timer) {
+  // The base timer is left armed, and finds nothing to do if this was the only timer it was armed
+  // for. Re-arming it here would cost a scan of the wheel on every cancellation.
+  unlink(timer);
+  --size_;
+}
+
+void TimingWheelScheduler::file(TimingWheelTimer& timer) {
+  if (timer.expiry_tick_ <= current_tick_) {
+    link(timer, due_, DueLevel, 0);
+    return;
+  }
+
+  const uint64_t diff = timer.expiry_tick_ ^ current_tick_;
+  if ((diff >> WheelBits) != 0) {
+    link(timer, overflow_, OverflowLevel, 0);
+    return;
+  }
+
+  // The highest level at which the expiry tick differs from the current tick.
+  const uint32_t level = (WordBits - 1 - absl::countl_zero(diff)) / SlotBits;
+  const uint32_t index = (timer.expiry_tick_ >> (level * SlotBits)) & (SlotsPerLevel - 1);
+  link(timer, slots_[level][index], level, index);
+  occupied_[level][index / WordBits] |= uint64_t(1) << (index % WordBits);
+}
+
+void TimingWheelScheduler::link(TimingWheelTimer& timer, Slot& slot, uint32_t level,
+                                uint32_t index) {
+  timer.slot_ = &slot;
+  timer.level_ = level;
+  timer.index_ = index;
+  timer.next_ = nullptr;
+  timer.prev_ = slot.tail_;
+  if (slot.tail_ != nullptr) {
+    slot.tail_->next_ = &timer;
+  } else {
+    slot.head_ = &timer;
+  }
+  slot.tail_ = &timer;
+}
+
+void TimingWheelScheduler::unlink(TimingWheelTimer& timer) {
+  Slot& slot = *timer.slot_;
+  if (timer.prev_ != nullptr) {
+    timer.prev_->next_ = timer.next_;
+  } else {
+    slot.head_ = timer.next_;
+  }
+  if (timer.next_ != nullptr) {
+    timer.next_->prev_ = timer.prev_;
+  } else {
+    slot.tail_ = timer.prev_;
+  }
+  if (slot.head_ == nullptr && timer.level_ < Levels) {
+    clearOccupied(timer.level_, timer.index_);
+  }
+  timer.slot_ = nullptr;
+  timer.prev_ = nullptr;
+  timer.next_ = nullptr;
+}
+
+void TimingWheelScheduler::clearOccupied(uint32_t level, uint32_t index) {
+  occupied_[level][index / WordBits] &= ~(uint64_t(1) << (index % WordBits));
+}
+
+uint64_t TimingWheelScheduler::slotTick(const TimingWheelTimer& timer) const {
+  switch (timer.level_) {
+  case DueLevel:
+    return current_tick_;
+  case OverflowLevel:
+    return ((current_tick_ >> WheelBits) + 1) << WheelBits;
+  default:
+    return slotStart(timer.level_, timer.index_);
+  }
+}
+
+uint64_t TimingWheelScheduler::slotStart(uint32_t level, uint32_t index) const {
+  const uint32_t shift = (level + 1) * SlotBits;
+  return ((current_tick_ >> shift) << shift) | (uint64_t(index) << (level * SlotBits));
+}
+
+absl::optional<uint64_t> TimingWheelScheduler::nextSlotTick(uint32_t& level,
+                                                            uint32_t& index) const {
+  // Slots at a lower level all start before the next slot of a higher level, so the first
+  // occupied slot found from the bottom up is the earliest one.
+  for (uint32_t l = 0; l < Levels; ++l) {
+    const uint32_t first = ((current_tick_ >> (l * SlotBits)) & (SlotsPerLevel - 1)) + 1;
+    for (uint32_t word = first / WordBits; word < occupied_[l].size(); ++word) {
+      uint64_t bits = occupied_[l][word];
+      if (word == first / WordBits) {
+        bits &= ~uint64_t(0) << (first % WordBits);
+      }
+      if (bits != 0) {
+        level = l;
+        index = word * WordBits + absl::countr_zero(bits);
+        return slotStart(level, index);
+      }
+    }
+  }
+  if (overflow_.head_ != nullptr) {
+    level = OverflowLevel;
+    index = 0;
+    return ((current_tick_ >> WheelBits) + 1) << WheelBits;
+  }
+  return absl::nullopt;
+}
+
+void TimingWheelScheduler::advance(uint64_t now_tick) {
+  uint32_t level;
+  uint32_t index;
+  for (absl::optional<uint64_t> tick = nextSlotTick(level, index);
+       tick.has_value() && tick.value() <= now_tick; tick = nextSlotTick(level, index)) {
+    current_tick_ = tick.value();
+    Slot& slot = level == OverflowLevel ? overflow_ : slots_[level][index];
+    TimingWheelTimer* timer = slot.head_;
+    slot.head_ = nullptr;
+    slot.tail_ = nullptr;
+    if (level < Levels) {
+      clearOccupied(level, index);
+    }
+    while (timer != nullptr) {
+      TimingWheelTimer* next = timer->next_;
+      file(*timer);
+      timer = next;
+    }
+  }
+  // No slot starts before now_tick, so no timer has to move when the current tick catches up.
+  current_tick_ = std::max(current_tick_, now_tick);
+}
+
+void TimingWheelScheduler::onBaseTimer() {
+  base_timer_tick_.reset();
+  advance(ticksSinceEpoch(dispatcher_.timeSource().monotonicTime(), false));
+
+  // Timers armed by the callbacks below with a zero delay run on the next base timer run, rather
+  // than in this loop, so that a timer re-arming itself cannot starve the event loop.
+  Slot expired = due_;
+  due_ = Slot();
+  for (TimingWheelTimer* timer = expired.head_; timer != nullptr; timer = timer->next_) {
+    timer->slot_ = &expired;
+  }
+  while (expired.head_ != nullptr) {
+    TimingWheelTimer& timer = *expired.head_;
+    unlink(timer);
+    --size_;
+    // The callback may destroy the timer, or any other expired timer.
+    timer.run();
+  }
+
+  scheduleBaseTimer();
+}
+
+void TimingWheelScheduler::scheduleBaseTimer() {
+  uint32_t level;
+  uint32_t index;
+  const absl::optional<uint64_t> tick =
+      due_.head_ != nullptr ? current_tick_ : nextSlotTick(level, index);
+  base_timer_tick_ = tick;
+  if (!tick.has_value()) {
+    base_timer_->disableTimer();
+    return;
+  }
+
+  const MonotonicTime deadline =
+      epoch_ + std::chrono::microseconds(resolution_.count() * static_cast<int64_t>(tick.value()));
+  const MonotonicTime now = dispatcher_.timeSource().monotonicTime();
+  base_timer_->enableHRTimer(
+      deadline > now ? std::chrono::duration_cast<std::chrono::microseconds>(deadline - now)
+                     : std::chrono::microseconds(0));
+}
+
+uint64_t TimingWheelScheduler::ticksSinceEpoch(MonotonicTime time, bool round_up) const {
+  if (time <= epoch_) {
+    return 0;
+  }
+  const uint64_t elapsed =
+      std::chrono::duration_cast<std::chrono::microseconds>(time - epoch_).count();
+  const uint64_t resolution = resolution_.count();
+  return elapsed / resolution + (round_up && elapsed % resolution != 0 ? 1 : 0);
+}
+
+TimingWheelTimer::TimingWheelTimer(TimingWheelScheduler& wheel, TimerCb cb,
+                                   Dispatcher& dispatcher)
+    : wheel_(wheel), cb_(std::move(cb)), dispatcher_(dispatcher) {
+  ASSERT(cb_);
+}
+
+TimingWheelTimer::~TimingWheelTimer() {
+  if (slot_ != nullptr) {
+    wheel_.disarm(*this);
+  }
+}
+
+void TimingWheelTimer::disableTimer() {
+  ASSERT(dispatcher_.isThreadSafe());
+  if (slot_ != nullptr) {
+    wheel_.disarm(*this);
+  }
+  if (hr_timer_ != nullptr) {
+    hr_timer_->disableTimer();
+  }
+}
+
+void TimingWheelTimer::enableTimer(std::chrono::milliseconds d,
+                                   const ScopeTrackedObject* object) {
+  ASSERT(dispatcher_.isThreadSafe());
+  if (hr_timer_ != nullptr) {
+    hr_timer_->disableTimer();
+  }
+  object_ = object;
+  wheel_.arm(*this, d);
+}
+
+void TimingWheelTimer::enableHRTimer(std::chrono::microseconds us,
+                                     const ScopeTrackedObject* object) {
+  ASSERT(dispatcher_.isThreadSafe());
+  // High resolution deadlines would be rounded up to a tick by the wheel, so they are left to the
+  // wrapped scheduler, whose timer does its own scope tracking.
+  if (slot_ != nullptr) {
+    wheel_.disarm(*this);
+  }
+  object_ = nullptr;
+  if (hr_timer_ == nullptr) {
+    hr_timer_ = wheel_.base_scheduler_.createTimer(cb_, dispatcher_);
+  }
+  hr_timer_->enableHRTimer(us, object);
+}
+
+bool TimingWheelTimer::enabled() {
+  ASSERT(dispatcher_.isThreadSafe());
+  return slot_ != nullptr || (hr_timer_ != nullptr && hr_timer_->enabled());
+}
+
+void TimingWheelTimer::run() {
+  if (object_ == nullptr) {
+    cb_();
+    return;
+  }
+  ScopeTrackerScopeState scope(object_, dispatcher_);
+  object_ = nullptr;
+  cb_();
+}
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "envoy/common/scope_tracker.h"
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Event {
+
+class TimingWheelTimer;
+
+/**
+ * Scheduler whose timers live in a hierarchical timing wheel, so that arming and disarming a timer
+ * is O(1) regardless of how many timers are armed. Timer deadlines are rounded up to the wheel's
+ * resolution, which makes it a good fit for the coarse idle and request timeouts that dominate
+ * dispatchers with many mostly idle connections. Timers armed with enableHRTimer() are not rounded,
+and run on a timer of the wrapped scheduler instead.
+ *
+ * The wheel has Levels levels of SlotsPerLevel slots. A timer is filed at the highest level at
+ * which its expiry tick differs from the current tick, in the slot given by the expiry's digit at
+ * that level. When the current tick reaches the start of a slot, the slot's timers are refiled at
+ * lower levels, until they reach their expiry tick and fire. Only a single timer of the wrapped
+ * scheduler is armed, for the next tick at which a slot has to be processed.
+ */
+class TimingWheelScheduler : public Scheduler {
+public:
+  static constexpr uint32_t SlotBits = 8;
+  static constexpr uint32_t SlotsPerLevel = 1 << SlotBits;
+  static constexpr uint32_t Levels = 4;
+
+  /**
+   * @param base_scheduler supplies the timer driving the wheel.
+   * @param dispatcher the dispatcher the wheel's timers run on.
+   * @param resolution the duration of a tick.
+   */
+  TimingWheelScheduler(Scheduler& base_scheduler, Dispatcher& dispatcher,
+                       std::chrono::milliseconds resolution);
+  ~TimingWheelScheduler() override;
+
+  // Scheduler
+  TimerPtr createTimer(const TimerCb& cb, Dispatcher& dispatcher) override;
+
+  /**
+   * @return the number of armed timers.
+   */
+  uint64_t size() const { return size_; }
+
+private:
+  friend class TimingWheelTimer;
+
+  // An intrusive list of timers, in the order they were filed.
+  struct Slot {
+    TimingWheelTimer* head_{};
+    TimingWheelTimer* tail_{};
+  };
+
+  void arm(TimingWheelTimer& timer, std::chrono::microseconds delay);
+  void disarm(TimingWheelTimer& timer);
+  void file(TimingWheelTimer& timer);
+  void link(TimingWheelTimer& timer, Slot& slot, uint32_t level, uint32_t index);
+  void unlink(TimingWheelTimer& timer);
+  void clearOccupied(uint32_t level, uint32_t index);
+  // Returns the tick at which the wheel next has to act on the slot the timer is filed in.
+  uint64_t slotTick(const TimingWheelTimer& timer) const;
+  uint64_t slotStart(uint32_t level, uint32_t index) const;
+  void advance(uint64_t now_tick);
+  void onBaseTimer();
+  void scheduleBaseTimer();
+  // Returns the next tick after current_tick_ at which a slot has to be processed, if any.
+  absl::optional<uint64_t> nextSlotTick(uint32_t& level, uint32_t& index) const;
+  uint64_t ticksSinceEpoch(MonotonicTime time, bool round_up) const;
+
+  Scheduler& base_scheduler_;
+  Dispatcher& dispatcher_;
+  const std::chrono::microseconds resolution_;
+  const MonotonicTime epoch_;
+  TimerPtr base_timer_;
+  // The tick the base timer is armed for, if it is armed.
+  absl::optional<uint64_t> base_timer_tick_;
+  // The last tick the wheel was advanced to. Lags the clock between base timer runs.
+  uint64_t current_tick_{};
+  uint64_t size_{};
+  std::array<std::array<Slot, SlotsPerLevel>, Levels> slots_;
+  // One bit per slot, set when the slot is not empty.
+  std::array<std::array<uint64_t, SlotsPerLevel / 64>, Levels> occupied_{};
+  // Timers expiring beyond the span of the wheel, refiled each time the top level wraps around.
+  Slot overflow_;
+  // Timers whose expiry tick has been reached, waiting for the base timer to run them.
+  Slot due_;
+};
+
+/**
+ * Timer filed in a TimingWheelScheduler.
+ */
+class TimingWheelTimer : public Timer {
+public:
+  TimingWheelTimer(TimingWheelScheduler& wheel, TimerCb cb, Dispatcher& dispatcher);
+  ~TimingWheelTimer() override;
+
+  // Timer
+  void disableTimer() override;
+  void enableTimer(std::chrono::milliseconds d, const ScopeTrackedObject* object) override;
+  void enableHRTimer(std::chrono::microseconds us, const ScopeTrackedObject* object) override;
+  bool enabled() override;
+
+private:
+  friend class TimingWheelScheduler;
+
+  void run();
+
+  TimingWheelScheduler& wheel_;
+  const TimerCb cb_;
+  Dispatcher& dispatcher_;
+  // Timer of the wrapped scheduler, created on the first enableHRTimer() call. It is armed instead
+  // of the wheel for high resolution deadlines.
+  TimerPtr hr_timer_;
+  const ScopeTrackedObject* object_{};
+  uint64_t expiry_tick_{};
+  // Position in the wheel. slot_ is null while the timer is disarmed.
+  TimingWheelScheduler::Slot* slot_{};
+  TimingWheelTimer* prev_{};
+  TimingWheelTimer* next_{};
+  uint32_t level_{};
+  uint32_t index_{};
+};
+
+} // namespace Event
+} // namespace Envoy
@@ -15,6 +15,7 @@
 #include "envoy/type/v3/percent.pb.h"
 
 #include "source/common/http/date_provider.h"
+#include "source/common/http/filter_latency.h"
 #include "source/common/local_reply/local_reply.h"
 #include "source/common/network/utility.h"
 #include "source/common/stats/symbol_table.h"
@@ -561,6 +562,18 @@ public:
    */
   virtual const HttpConnectionManagerProto::ProxyStatusConfig* proxyStatusConfig() const PURE;
 
+  /**
+   * @return the per-filter latency tracking configuration. If nullptr, filter latencies are not
+   * tracked.
+   */
+  virtual const FilterLatencyConfig* filterLatencyConfig() const PURE;
+
+  /**
+   * @return the size in bytes of the first block of the arena that each stream's request headers
+   * and trailers are allocated from. If 0, streams do not use an arena.
+   */
+  virtual uint32_t streamArenaInitialBlockSize() const PURE;
+
   /**
    * Creates new header validator. This method always returns nullptr unless the `ENVOY_ENABLE_UHV`
    * pre-processor variable is defined.
@@ -7,6 +7,7 @@
 #include <limits>
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
@@ -890,6 +891,15 @@ absl::optional<uint64_t> ConnectionManagerImpl::HttpStreamIdProviderImpl::toInte
 
 namespace {
 constexpr absl::string_view kRouteFactoryName = "envoy.route_config_update_requester.default";
+
+StreamArenaSharedPtr makeStreamArena(uint32_t initial_block_size) {
+  if (initial_block_size == 0) {
+    return nullptr;
+  }
+  // Deallocation is a no-op; everything is freed at once when the last header map allocated from
+  // the arena, or the stream, is destroyed.
+  return std::make_shared<std::pmr::monotonic_buffer_resource>(initial_block_size);
+}
 } // namespace
 
 ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connection_manager,
@@ -901,6 +911,7 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
                                              : makeOptRef<const TracingConnectionManagerConfig>(
                                                    *connection_manager_.config_->tracingConfig())),
       stream_id_(connection_manager.random_generator_.random()),
+      arena_(makeStreamArena(connection_manager_.config_->streamArenaInitialBlockSize())),
       filter_manager_(*this, *connection_manager_.dispatcher_,
                       connection_manager_.read_callbacks_->connection(), stream_id_,
                       std::move(account), connection_manager_.config_->proxy100Continue(),
@@ -934,6 +945,12 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
   filter_manager_.streamInfo().setShouldSchemeMatchUpstream(
       connection_manager.config_->shouldSchemeMatchUpstream());
 
+  const FilterLatencyConfig* filter_latency = connection_manager_.config_->filterLatencyConfig();
+  if (filter_latency != nullptr &&
+      filter_latency->sampleStream(connection_manager_.random_generator_)) {
+    filter_manager_.enableFilterLatencyTracking(*filter_latency);
+  }
+
   // Record the downstream connection begin time point for COMMON_DURATION access logging.
   filter_manager_.streamInfo().downstreamTiming().setDownstreamConnectionBegin(
       connection_manager_.read_callbacks_->connection().streamInfo().startTimeMonotonic());
@@ -217,6 +217,7 @@ private:
     RequestDecoderHandlePtr getRequestDecoderHandle() override {
       return std::make_unique<ActiveStreamHandle>(*this);
     }
+    StreamArenaSharedPtr streamArena() override { return arena_; }
 
     // Hand off headers/trailers and stream info to the codec's response encoder, for logging later
     // (i.e. possibly after this stream has been destroyed).
@@ -453,6 +454,8 @@ private:
     // TODO(snowp): It might make sense to move this to the FilterManager to avoid storing it in
     // both locations, then refer to the FM when doing stream logs.
     const uint64_t stream_id_;
+    // Backs the request headers and trailers decoded by the codec, if configured.
+    const StreamArenaSharedPtr arena_;
 
     RequestHeaderMapSharedPtr request_headers_;
     RequestTrailerMapPtr request_trailers_;
@@ -0,0 +1,118 @@
+#include "source/common/http/filter_latency.h"
+
+#include "source/common/common/macros.h"
+#include "source/common/protobuf/utility.h"
+#include "source/common/stats/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+
+namespace Envoy {
+namespace Http {
+
+namespace {
+
+constexpr std::array<absl::string_view, FilterLatencyCallbackCount> CallbackStatNames = {
+    "decode_headers_us", "decode_data_us", "encode_headers_us", "encode_data_us"};
+
+int64_t toMicroseconds(std::chrono::nanoseconds duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+} // namespace
+
+std::chrono::nanoseconds FilterLatency::total() const {
+  std::chrono::nanoseconds total{};
+  for (const auto& duration : callbacks_) {
+    total += duration;
+  }
+  return total;
+}
+
+const std::string& FilterLatencyFilterState::key() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "envoy.http.filter_latency");
+}
+
+absl::optional<std::string> FilterLatencyFilterState::serializeAsString() const {
+  return absl::StrJoin(entries_, ",", [](std::string* out, const auto& entry) {
+    absl::StrAppend(out, entry.first, ":", toMicroseconds(entry.second.total()));
+  });
+}
+
+StreamInfo::FilterState::Object::FieldType
+FilterLatencyFilterState::getField(absl::string_view filter_name) const {
+  for (const auto& [name, latency] : entries_) {
+    if (name == filter_name) {
+      return toMicroseconds(latency.total());
+    }
+  }
+  return {};
+}
+
+FilterLatencyConfig::FilterLatencyConfig(const envoy::type::v3::FractionalPercent& sampling,
+                                         const std::vector<std::string>& filter_names,
+                                         const std::string& stat_prefix, Stats::Scope& scope)
+    : sampling_numerator_(sampling.numerator()),
+      sampling_denominator_(
+          ProtobufPercentHelper::fractionalPercentDenominatorToInt(sampling.denominator())),
+      scope_(scope), stat_names_(scope.symbolTable().makeSet("FilterLatency")),
+      prefix_(stat_names_->add(absl::StrCat(stat_prefix, "filter_latency"))),
+      other_filter_(stat_names_->add("other")) {
+  stat_names_->rememberBuiltins(filter_names);
+  for (size_t i = 0; i < FilterLatencyCallbackCount; ++i) {
+    callback_names_[i] = stat_names_->add(CallbackStatNames[i]);
+  }
+}
+
+bool FilterLatencyConfig::sampleStream(Random::RandomGenerator& random) const {
+  return sampling_numerator_ > 0 && random.random() % sampling_denominator_ < sampling_numerator_;
+}
+
+void FilterLatencyConfig::recordHistograms(absl::string_view filter_name,
+                                           const FilterLatency& latency) const {
+  const Stats::StatName filter = stat_names_->getBuiltin(filter_name, other_filter_);
+  for (size_t i = 0; i < FilterLatencyCallbackCount; ++i) {
+    if (latency.calls_[i] == 0) {
+      continue;
+    }
+    Stats::Utility::histogramFromStatNames(scope_, {prefix_, filter, callback_names_[i]},
+                                           Stats::Histogram::Unit::Microseconds)
+        .recordValue(toMicroseconds(latency.callbacks_[i]));
+  }
+}
+
+void FilterLatencyTracker::onCallbackEnd(absl::string_view filter_name,
+                                         FilterLatencyCallback callback, const Timing& timing) {
+  const std::chrono::nanoseconds elapsed = time_source_.monotonicTime() - timing.start_;
+  const size_t index = static_cast<size_t>(callback);
+  FilterLatency& latency = latencyFor(filter_name);
+  latency.callbacks_[index] += std::max(elapsed - nested_, std::chrono::nanoseconds::zero());
+  ++latency.calls_[index];
+  // From the point of view of the enclosing callback, if any, all of this one was nested.
+  nested_ = timing.outer_nested_ + elapsed;
+}
+
+void FilterLatencyTracker::finalize(StreamInfo::StreamInfo& stream_info) {
+  FilterLatencyFilterState::Entries entries;
+  entries.reserve(latencies_.size());
+  for (const auto& [name, latency] : latencies_) {
+    config_.recordHistograms(name, latency);
+    entries.emplace_back(std::string(name), latency);
+  }
+  stream_info.filterState()->setData(
+      FilterLatencyFilterState::key(),
+      std::make_shared<FilterLatencyFilterState>(std::move(entries)),
+      StreamInfo::FilterState::LifeSpan::Request);
+}
+
+FilterLatency& FilterLatencyTracker::latencyFor(absl::string_view filter_name) {
+  for (auto& [name, latency] : latencies_) {
+    if (name == filter_name) {
+      return latency;
+    }
+  }
+  return latencies_.emplace_back(filter_name, FilterLatency{}).second;
+}
+
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/random_generator.h"
+#include "envoy/common/time.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stream_info/filter_state.h"
+#include "envoy/stream_info/stream_info.h"
+#include "envoy/type/v3/percent.pb.h"
+
+#include "source/common/stats/symbol_table.h"
+
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * The filter callbacks whose running time is attributed to the filter that handled them.
+ */
+enum class FilterLatencyCallback : uint8_t { DecodeHeaders, DecodeData, EncodeHeaders, EncodeData };
+constexpr size_t FilterLatencyCallbackCount = 4;
+
+/**
+ * Time spent inside each callback of a single filter over the life of a stream. Time while the
+ * filter has stopped iteration is not included, as no callback of the filter is running.
+ */
+struct FilterLatency {
+  std::chrono::nanoseconds total() const;
+
+  std::array<std::chrono::nanoseconds, FilterLatencyCallbackCount> callbacks_{};
+  // Number of times each callback ran, so callbacks that never ran are not reported as zero.
+  std::array<uint32_t, FilterLatencyCallbackCount> calls_{};
+};
+
+/**
+ * Sampled per-filter latencies of a stream, stored in the request filter state under key() so
+ * that access logs can read them with %FILTER_STATE(envoy.http.filter_latency:PLAIN)%, or a
+ * single filter's total with %FILTER_STATE(envoy.http.filter_latency:FIELD:<filter name>)%.
+ * Latencies are reported in microseconds.
+ */
+class FilterLatencyFilterState : public StreamInfo::FilterState::Object {
+public:
+  using Entries = std::vector<std::pair<std::string, FilterLatency>>;
+
+  explicit FilterLatencyFilterState(Entries entries) : entries_(std::move(entries)) {}
+
+  static const std::string& key();
+
+  const Entries& entries() const { return entries_; }
+
+  // StreamInfo::FilterState::Object
+  absl::optional<std::string> serializeAsString() const override;
+  bool hasFieldSupport() const override { return true; }
+  FieldType getField(absl::string_view filter_name) const override;
+
+private:
+  const Entries entries_;
+};
+
+/**
+ * Per connection manager configuration of filter latency tracking: which streams are sampled, and
+ * the histograms the latencies of sampled streams are recorded into. The histograms are named
+ * <stat_prefix>filter_latency.<filter name>.<callback>_us; filters that were not known when the
+ * configuration was created, e.g. ones added by the composite filter, share the filter name
+ * "other" so that no stat names need to be allocated on the request path.
+ */
+class FilterLatencyConfig {
+public:
+  FilterLatencyConfig(const envoy::type::v3::FractionalPercent& sampling,
+                      const std::vector<std::string>& filter_names, const std::string& stat_prefix,
+                      Stats::Scope& scope);
+
+  /**
+   * @return whether a new stream should have its filter latencies tracked.
+   */
+  bool sampleStream(Random::RandomGenerator& random) const;
+
+  /**
+   * Records the latencies of one filter of a finished stream into the filter's histograms.
+   */
+  void recordHistograms(absl::string_view filter_name, const FilterLatency& latency) const;
+
+private:
+  const uint64_t sampling_numerator_;
+  const uint64_t sampling_denominator_;
+  Stats::Scope& scope_;
+  Stats::StatNameSetPtr stat_names_;
+  const Stats::StatName prefix_;
+  const Stats::StatName other_filter_;
+  std::array<Stats::StatName, FilterLatencyCallbackCount> callback_names_;
+};
+
+using FilterLatencyConfigPtr = std::unique_ptr<const FilterLatencyConfig>;
+
+/**
+ * Accumulates the per-filter latencies of a single sampled stream.
+ *
+ * Filter callbacks nest when a filter resumes iteration synchronously, e.g. by calling
+ * continueDecoding() or sendLocalReply() from one of its own callbacks. The time spent in the
+ * nested callbacks is attributed to the filters that ran them, and subtracted from the outer one.
+ */
+class FilterLatencyTracker {
+public:
+  struct Timing {
+    MonotonicTime start_;
+    std::chrono::nanoseconds outer_nested_;
+  };
+
+  FilterLatencyTracker(const FilterLatencyConfig& config, TimeSource& time_source)
+      : config_(config), time_source_(time_source) {}
+
+  /**
+   * Starts timing a filter callback. Must be paired with onCallbackEnd().
+   */
+  Timing onCallbackStart() {
+    Timing timing{time_source_.monotonicTime(), nested_};
+    nested_ = {};
+    return timing;
+  }
+
+  /**
+   * Attributes the time since the matching onCallbackStart(), minus any nested callbacks, to the
+   * filter.
+   */
+  void onCallbackEnd(absl::string_view filter_name, FilterLatencyCallback callback,
+                     const Timing& timing);
+
+  /**
+   * Records the accumulated latencies into the per-filter histograms and the stream's filter
+   * state. Called once when the stream completes.
+   */
+  void finalize(StreamInfo::StreamInfo& stream_info);
+
+private:
+  FilterLatency& latencyFor(absl::string_view filter_name);
+
+  const FilterLatencyConfig& config_;
+  TimeSource& time_source_;
+  // Time spent in callbacks nested inside the callback currently running.
+  std::chrono::nanoseconds nested_{};
+  // Filter chains are short, so a linear scan keyed by the filter config name is cheapest.
+  absl::InlinedVector<std::pair<absl::string_view, FilterLatency>, 8> latencies_;
+};
+
+using FilterLatencyTrackerPtr = std::unique_ptr<FilterLatencyTracker>;
+
+} // namespace Http
+} // namespace Envoy
@@ -18,6 +18,7 @@
 #include "source/common/common/linked_object.h"
 #include "source/common/common/logger.h"
 #include "source/common/grpc/common.h"
+#include "source/common/http/filter_latency.h"
 #include "source/common/http/header_utility.h"
 #include "source/common/http/headers.h"
 #include "source/common/http/matching/data_impl.h"
@@ -733,6 +734,20 @@ public:
     for (auto filter : filters_) {
       filter->onStreamComplete();
     }
+    if (filter_latency_ != nullptr) {
+      filter_latency_->finalize(streamInfo());
+      filter_latency_ = nullptr;
+    }
+  }
+
+  /**
+   * Enables per-filter latency tracking for this stream. The time spent in each filter's
+   * decodeHeaders/decodeData/encodeHeaders/encodeData callbacks is accumulated and recorded when
+   * the stream completes.
+   * @param config the tracking configuration, which must outlive the stream.
+   */
+  void enableFilterLatencyTracking(const FilterLatencyConfig& config) {
+    filter_latency_ = std::make_unique<FilterLatencyTracker>(config, dispatcher_.timeSource());
   }
 
   void destroyFilters() {
@@ -1118,6 +1133,19 @@ private:
 
   bool stopEncoderFilterChain() { return state_.encoder_filter_chain_aborted_; }
 
+  // Filter latency tracking is sampled, so an untracked stream only pays for a null check.
+  absl::optional<FilterLatencyTracker::Timing> startFilterLatency() {
+    return filter_latency_ != nullptr ? absl::make_optional(filter_latency_->onCallbackStart())
+                                      : absl::nullopt;
+  }
+  void endFilterLatency(const ActiveStreamFilterBase& filter, FilterLatencyCallback callback,
+                        const absl::optional<FilterLatencyTracker::Timing>& timing) {
+    // The stream may have completed, and recorded its latencies, from inside the callback.
+    if (timing.has_value() && filter_latency_ != nullptr) {
+      filter_latency_->onCallbackEnd(filter.filter_context_.config_name, callback, *timing);
+    }
+  }
+
   bool isTerminalDecoderFilter(const ActiveStreamDecoderFilter& filter) const;
 
   FilterManagerCallbacks& filter_manager_callbacks_;
@@ -1146,6 +1174,8 @@ private:
   Network::Socket::OptionsSharedPtr upstream_options_ =
       std::make_shared<Network::Socket::Options>();
   Upstream::LoadBalancerContext::OverrideHost upstream_override_host_;
+  // Only set for streams sampled for filter latency tracking.
+  FilterLatencyTrackerPtr filter_latency_;
 
   // TODO(snowp): Once FM has been moved to its own file we'll make these private classes of FM,
   // at which point they no longer need to be friends.
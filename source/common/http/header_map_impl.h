@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <type_traits>
 
@@ -54,8 +55,10 @@ public:
 class HeaderMapImpl : NonCopyable {
 public:
   HeaderMapImpl(const uint32_t max_headers_kb = UINT32_MAX,
-                const uint32_t max_headers_count = UINT32_MAX)
-      : max_headers_kb_(max_headers_kb), max_headers_count_(max_headers_count) {}
+                const uint32_t max_headers_count = UINT32_MAX, StreamArenaSharedPtr arena = nullptr)
+      : arena_(std::move(arena)),
+        headers_(arena_ != nullptr ? arena_.get() : std::pmr::new_delete_resource()),
+        max_headers_kb_(max_headers_kb), max_headers_count_(max_headers_count) {}
   virtual ~HeaderMapImpl() = default;
 
   // The following "constructors" call virtual functions during construction and must use the
@@ -128,9 +131,9 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
+    std::pmr::list<HeaderEntryImpl>::iterator entry_;
   };
-  using HeaderNode = std::list<HeaderEntryImpl>::iterator;
+  using HeaderNode = std::pmr::list<HeaderEntryImpl>::iterator;
 
   /**
    * This is the static lookup table that is used to determine whether a header is one of the O(1)
@@ -195,7 +198,8 @@ protected:
    * of the list (as required by nghttp2) and otherwise maintains insertion order.
    * When the list size is greater or equal to 3, all headers are added to a map, to allow fast
    * access given a header key. Once the map is initialized, it will be used even
-   * if the number of headers decreases below the threshold.
+   * if the number of headers decreases below the threshold. The list entries are allocated from
+   * the given memory resource, which is the stream arena for header maps that have one.
    *
    * Note: the internal iterators held in fields make this unsafe to copy and move, since the
    * reference to end() is not preserved across a move (see Notes in
@@ -206,10 +210,12 @@ protected:
    */
   class HeaderList : NonCopyable {
   public:
+    using EntryList = std::pmr::list<HeaderEntryImpl>;
     using HeaderNodeVector = absl::InlinedVector<HeaderNode, 1>;
     using HeaderLazyMap = absl::flat_hash_map<absl::string_view, HeaderNodeVector>;
 
-    HeaderList() : pseudo_headers_end_(headers_.end()) {}
+    explicit HeaderList(std::pmr::memory_resource* resource)
+        : headers_(resource), pseudo_headers_end_(headers_.end()) {}
 
     template <class Key> bool isPseudoHeader(const Key& key) {
       return !key.getStringView().empty() && key.getStringView()[0] == ':';
@@ -299,12 +305,12 @@ protected:
      */
     size_t remove(absl::string_view key);
 
-    std::list<HeaderEntryImpl>::iterator begin() { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::iterator end() { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_iterator begin() const { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::const_iterator end() const { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rend() const { return headers_.rend(); }
+    EntryList::iterator begin() { return headers_.begin(); }
+    EntryList::iterator end() { return headers_.end(); }
+    EntryList::const_iterator begin() const { return headers_.begin(); }
+    EntryList::const_iterator end() const { return headers_.end(); }
+    EntryList::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
+    EntryList::const_reverse_iterator rend() const { return headers_.rend(); }
     HeaderLazyMap::iterator mapFind(absl::string_view key) { return lazy_map_.find(key); }
     HeaderLazyMap::iterator mapEnd() { return lazy_map_.end(); }
     size_t size() const { return headers_.size(); }
@@ -316,7 +322,7 @@ protected:
     }
 
   private:
-    std::list<HeaderEntryImpl> headers_;
+    EntryList headers_;
     HeaderNode pseudo_headers_end_;
     HeaderLazyMap lazy_map_;
   };
@@ -339,6 +345,9 @@ protected:
   virtual void clearInline() PURE;
   virtual HeaderEntryImpl** inlineHeaders() PURE;
 
+  // The arena that the entries of headers_ are allocated from, if any. Declared first so that it
+  // outlives them.
+  const StreamArenaSharedPtr arena_;
   HeaderList headers_;
   // TODO(mattklein123): The formatter does not currently get copied when a header map gets
   // copied. This may be problematic in certain cases like request shadowing. This is omitted
@@ -364,8 +373,9 @@ protected:
 template <class Interface> class TypedHeaderMapImpl : public HeaderMapImpl, public Interface {
 public:
   TypedHeaderMapImpl(const uint32_t max_headers_kb = UINT32_MAX,
-                     const uint32_t max_headers_count = UINT32_MAX)
-      : HeaderMapImpl(max_headers_kb, max_headers_count) {}
+                     const uint32_t max_headers_count = UINT32_MAX,
+                     StreamArenaSharedPtr arena = nullptr)
+      : HeaderMapImpl(max_headers_kb, max_headers_count, std::move(arena)) {}
   void setFormatter(StatefulHeaderKeyFormatterPtr&& formatter) {
     formatter_ = std::move(formatter);
   }
@@ -491,9 +501,9 @@ class RequestHeaderMapImpl final : public TypedHeaderMapImpl<RequestHeaderMap>,
 public:
   static std::unique_ptr<RequestHeaderMapImpl>
   create(const uint32_t max_headers_kb = UINT32_MAX,
-         const uint32_t max_headers_count = UINT32_MAX) {
-    return std::unique_ptr<RequestHeaderMapImpl>(
-        new (inlineHeadersSize()) RequestHeaderMapImpl(max_headers_kb, max_headers_count));
+         const uint32_t max_headers_count = UINT32_MAX, StreamArenaSharedPtr arena = nullptr) {
+    return std::unique_ptr<RequestHeaderMapImpl>(new (inlineHeadersSize()) RequestHeaderMapImpl(
+        max_headers_kb, max_headers_count, std::move(arena)));
   }
 
   INLINE_REQ_STRING_HEADERS(DEFINE_INLINE_HEADER_STRING_FUNCS)
@@ -521,8 +531,9 @@ private:
   using HeaderHandles = ConstSingleton<HeaderHandleValues>;
 
   RequestHeaderMapImpl(const uint32_t max_headers_kb = UINT32_MAX,
-                       const uint32_t max_headers_count = UINT32_MAX)
-      : TypedHeaderMapImpl<RequestHeaderMap>(max_headers_kb, max_headers_count) {
+                       const uint32_t max_headers_count = UINT32_MAX,
+                       StreamArenaSharedPtr arena = nullptr)
+      : TypedHeaderMapImpl<RequestHeaderMap>(max_headers_kb, max_headers_count, std::move(arena)) {
     clearInline();
   }
 
@@ -538,9 +549,9 @@ class RequestTrailerMapImpl final : public TypedHeaderMapImpl<RequestTrailerMap>
 public:
   static std::unique_ptr<RequestTrailerMapImpl>
   create(const uint32_t max_headers_kb = UINT32_MAX,
-         const uint32_t max_headers_count = UINT32_MAX) {
-    return std::unique_ptr<RequestTrailerMapImpl>(
-        new (inlineHeadersSize()) RequestTrailerMapImpl(max_headers_kb, max_headers_count));
+         const uint32_t max_headers_count = UINT32_MAX, StreamArenaSharedPtr arena = nullptr) {
+    return std::unique_ptr<RequestTrailerMapImpl>(new (inlineHeadersSize()) RequestTrailerMapImpl(
+        max_headers_kb, max_headers_count, std::move(arena)));
   }
 
 protected:
@@ -551,8 +562,9 @@ protected:
 
 private:
   RequestTrailerMapImpl(const uint32_t max_headers_kb = UINT32_MAX,
-                        const uint32_t max_headers_count = UINT32_MAX)
-      : TypedHeaderMapImpl<RequestTrailerMap>(max_headers_kb, max_headers_count) {
+                        const uint32_t max_headers_count = UINT32_MAX,
+                        StreamArenaSharedPtr arena = nullptr)
+      : TypedHeaderMapImpl<RequestTrailerMap>(max_headers_kb, max_headers_count, std::move(arena)) {
     clearInline();
   }
 
@@ -568,9 +580,9 @@ class ResponseHeaderMapImpl final : public TypedHeaderMapImpl<ResponseHeaderMap>
 public:
   static std::unique_ptr<ResponseHeaderMapImpl>
   create(const uint32_t max_headers_kb = UINT32_MAX,
-         const uint32_t max_headers_count = UINT32_MAX) {
-    return std::unique_ptr<ResponseHeaderMapImpl>(
-        new (inlineHeadersSize()) ResponseHeaderMapImpl(max_headers_kb, max_headers_count));
+         const uint32_t max_headers_count = UINT32_MAX, StreamArenaSharedPtr arena = nullptr) {
+    return std::unique_ptr<ResponseHeaderMapImpl>(new (inlineHeadersSize()) ResponseHeaderMapImpl(
+        max_headers_kb, max_headers_count, std::move(arena)));
   }
 
   INLINE_RESP_STRING_HEADERS(DEFINE_INLINE_HEADER_STRING_FUNCS)
@@ -599,8 +611,9 @@ private:
   using HeaderHandles = ConstSingleton<HeaderHandleValues>;
 
   ResponseHeaderMapImpl(const uint32_t max_headers_kb = UINT32_MAX,
-                        const uint32_t max_headers_count = UINT32_MAX)
-      : TypedHeaderMapImpl<ResponseHeaderMap>(max_headers_kb, max_headers_count) {
+                        const uint32_t max_headers_count = UINT32_MAX,
+                        StreamArenaSharedPtr arena = nullptr)
+      : TypedHeaderMapImpl<ResponseHeaderMap>(max_headers_kb, max_headers_count, std::move(arena)) {
     clearInline();
   }
   HeaderEntryImpl* inline_headers_[];
@@ -615,9 +628,9 @@ class ResponseTrailerMapImpl final : public TypedHeaderMapImpl<ResponseTrailerMa
 public:
   static std::unique_ptr<ResponseTrailerMapImpl>
   create(const uint32_t max_headers_kb = UINT32_MAX,
-         const uint32_t max_headers_count = UINT32_MAX) {
-    return std::unique_ptr<ResponseTrailerMapImpl>(
-        new (inlineHeadersSize()) ResponseTrailerMapImpl(max_headers_kb, max_headers_count));
+         const uint32_t max_headers_count = UINT32_MAX, StreamArenaSharedPtr arena = nullptr) {
+    return std::unique_ptr<ResponseTrailerMapImpl>(new (inlineHeadersSize()) ResponseTrailerMapImpl(
+        max_headers_kb, max_headers_count, std::move(arena)));
   }
 
   INLINE_RESP_STRING_HEADERS_TRAILERS(DEFINE_INLINE_HEADER_STRING_FUNCS)
@@ -638,8 +651,10 @@ private:
   using HeaderHandles = ConstSingleton<HeaderHandleValues>;
 
   ResponseTrailerMapImpl(const uint32_t max_headers_kb = UINT32_MAX,
-                         const uint32_t max_headers_count = UINT32_MAX)
-      : TypedHeaderMapImpl<ResponseTrailerMap>(max_headers_kb, max_headers_count) {
+                         const uint32_t max_headers_count = UINT32_MAX,
+                         StreamArenaSharedPtr arena = nullptr)
+      : TypedHeaderMapImpl<ResponseTrailerMap>(max_headers_kb, max_headers_count,
+                                               std::move(arena)) {
     clearInline();
   }
 
@@ -591,8 +591,10 @@ Status ConnectionImpl::onMessageBeginImpl() {
   protocol_ = Protocol::Http11;
   processing_trailers_ = false;
   header_parsing_state_ = HeaderParsingState::Field;
+  // The server side creates the stream first, so that the headers can use its arena.
+  Status status = onMessageBeginBase();
   allocHeaders(statefulFormatterFromSettings(codec_settings_));
-  return onMessageBeginBase();
+  return status;
 }
 
 uint32_t ConnectionImpl::getHeadersSize() {
@@ -533,7 +533,7 @@ private:
   }
   void allocHeaders(StatefulHeaderKeyFormatterPtr&& formatter) override {
     ASSERT(!processing_trailers_);
-    auto headers = RequestHeaderMapImpl::create(max_headers_kb_, max_headers_count_);
+    auto headers = RequestHeaderMapImpl::create(max_headers_kb_, max_headers_count_, streamArena());
     headers->setFormatter(std::move(formatter));
     headers_or_trailers_.emplace<RequestHeaderMapPtr>(std::move(headers));
   }
@@ -541,9 +541,17 @@ private:
     ASSERT(processing_trailers_);
     if (!absl::holds_alternative<RequestTrailerMapPtr>(headers_or_trailers_)) {
       headers_or_trailers_.emplace<RequestTrailerMapPtr>(
-          RequestTrailerMapImpl::create(max_headers_kb_, max_headers_count_));
+          RequestTrailerMapImpl::create(max_headers_kb_, max_headers_count_, streamArena()));
     }
   }
+  // @return the arena of the stream being decoded, if any.
+  StreamArenaSharedPtr streamArena() {
+    if (active_request_ == nullptr || active_request_->request_decoder_handle_ == nullptr) {
+      return nullptr;
+    }
+    OptRef<RequestDecoder> decoder = active_request_->request_decoder_handle_->get();
+    return decoder.has_value() ? decoder->streamArena() : nullptr;
+  }
   void dumpAdditionalState(std::ostream& os, int indent_level) const override;
 
   void releaseOutboundResponse(const Buffer::OwnedBufferFragmentImpl* fragment);
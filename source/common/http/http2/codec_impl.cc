@@ -2502,7 +2502,9 @@ Status ServerConnectionImpl::onBeginHeaders(int32_t stream_id) {
   if (connection_.aboveHighWatermark()) {
     stream->runHighWatermarkCallbacks();
   }
-  stream->setRequestDecoder(callbacks_.newStream(*stream));
+  RequestDecoder& decoder = callbacks_.newStream(*stream);
+  stream->setRequestDecoder(decoder);
+  stream->allocHeaders(decoder);
   stream->stream_id_ = stream_id;
   LinkedList::moveIntoList(std::move(stream), active_streams_);
   adapter_->SetStreamUserData(stream_id, active_streams_.front().get());
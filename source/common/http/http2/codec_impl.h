@@ -586,9 +586,14 @@ protected:
    */
   struct ServerStreamImpl : public StreamImpl, public ResponseEncoder {
     ServerStreamImpl(ConnectionImpl& parent, uint32_t buffer_limit)
-        : StreamImpl(parent, buffer_limit),
-          headers_or_trailers_(
-              RequestHeaderMapImpl::create(parent_.max_headers_kb_, parent_.max_headers_count_)) {}
+        : StreamImpl(parent, buffer_limit) {}
+
+    // Creates the map that the request headers are decoded into, in the arena of the decoder.
+    void allocHeaders(RequestDecoder& decoder) {
+      arena_ = decoder.streamArena();
+      headers_or_trailers_.emplace<RequestHeaderMapSharedPtr>(RequestHeaderMapImpl::create(
+          parent_.max_headers_kb_, parent_.max_headers_count_, arena_));
+    }
 
     // StreamImpl
     void destroy() override;
@@ -611,8 +616,8 @@ protected:
       }
     }
     void allocTrailers() override {
-      headers_or_trailers_.emplace<RequestTrailerMapPtr>(
-          RequestTrailerMapImpl::create(parent_.max_headers_kb_, parent_.max_headers_count_));
+      headers_or_trailers_.emplace<RequestTrailerMapPtr>(RequestTrailerMapImpl::create(
+          parent_.max_headers_kb_, parent_.max_headers_count_, arena_));
     }
     HeaderMapPtr cloneTrailers(const HeaderMap& trailers) override {
       return createHeaderMap<ResponseTrailerMapImpl>(trailers);
@@ -636,6 +641,7 @@ protected:
     // ScopeTrackedObject
     void dumpState(std::ostream& os, int indent_level) const override;
 
+    StreamArenaSharedPtr arena_;
     absl::variant<RequestHeaderMapSharedPtr, RequestTrailerMapPtr> headers_or_trailers_;
 
     bool streamErrorOnInvalidHttpMessage() const override {
@@ -17,6 +17,16 @@ bool isIoUringSupported() {
   return is_supported;
 }
 
+bool isIoUringOperationSupported(uint8_t opcode) {
+  struct io_uring_probe* probe = io_uring_get_probe();
+  if (probe == nullptr) {
+    return false;
+  }
+  const bool is_supported = io_uring_opcode_supported(probe, opcode);
+  io_uring_free_probe(probe);
+  return is_supported;
+}
+
 IoUringImpl::IoUringImpl(uint32_t io_uring_size, bool use_submission_queue_polling)
     : cqes_(io_uring_size, nullptr) {
   struct io_uring_params p {};
@@ -30,7 +40,12 @@ IoUringImpl::IoUringImpl(uint32_t io_uring_size, bool use_submission_queue_polli
   RELEASE_ASSERT(ret == 0, fmt::format("unable to initialize io_uring: {}", errorDetails(-ret)));
 }
 
-IoUringImpl::~IoUringImpl() { io_uring_queue_exit(&ring_); }
+IoUringImpl::~IoUringImpl() {
+  if (buf_ring_ != nullptr) {
+    io_uring_free_buf_ring(&ring_, buf_ring_, num_provided_buffers_, ProvidedBufferGroup);
+  }
+  io_uring_queue_exit(&ring_);
+}
 
 os_fd_t IoUringImpl::registerEventfd() {
   ASSERT(!isEventfdRegistered());
@@ -69,7 +84,7 @@ void IoUringImpl::forEveryCompletion(const CompletionCb& completion_cb) {
 
   for (unsigned i = 0; i < count; ++i) {
     struct io_uring_cqe* cqe = cqes_[i];
-    completion_cb(reinterpret_cast<Request*>(cqe->user_data), cqe->res, false);
+    completion_cb(reinterpret_cast<Request*>(cqe->user_data), cqe->res, cqe->flags, false);
   }
 
   io_uring_cq_advance(&ring_, count);
@@ -81,7 +96,7 @@ void IoUringImpl::forEveryCompletion(const CompletionCb& completion_cb) {
   while (!injected_completions_.empty()) {
     auto completion = injected_completions_.front();
     injected_completions_.pop_front();
-    completion_cb(completion.user_data_, completion.result_, true);
+    completion_cb(completion.user_data_, completion.result_, 0, true);
   }
 }
 
@@ -100,6 +115,21 @@ IoUringResult IoUringImpl::prepareAccept(os_fd_t fd, struct sockaddr* remote_add
   return IoUringResult::Ok;
 }
 
+IoUringResult IoUringImpl::prepareAcceptMultishot(os_fd_t fd, Request* user_data) {
+  ENVOY_LOG(trace, "prepare multishot accept for fd = {}", fd);
+  // TODO (soulxu): Handling the case of CQ ring is overflow.
+  ASSERT(!(*(ring_.sq.kflags) & IORING_SQ_CQ_OVERFLOW));
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+  if (sqe == nullptr) {
+    return IoUringResult::Failed;
+  }
+
+  // The remote address can't be returned, as every accept would write it to the same place.
+  io_uring_prep_multishot_accept(sqe, fd, nullptr, nullptr, 0);
+  io_uring_sqe_set_data(sqe, user_data);
+  return IoUringResult::Ok;
+}
+
 IoUringResult IoUringImpl::prepareConnect(os_fd_t fd,
                                           const Network::Address::InstanceConstSharedPtr& address,
                                           Request* user_data) {
@@ -131,6 +161,55 @@ IoUringResult IoUringImpl::prepareReadv(os_fd_t fd, const struct iovec* iovecs,
   return IoUringResult::Ok;
 }
 
+IoUringResult IoUringImpl::prepareRecvMultishot(os_fd_t fd, Request* user_data) {
+  ENVOY_LOG(trace, "prepare multishot recv for fd = {}", fd);
+  ASSERT(buf_ring_ != nullptr);
+  // TODO (soulxu): Handling the case of CQ ring is overflow.
+  ASSERT(!(*(ring_.sq.kflags) & IORING_SQ_CQ_OVERFLOW));
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+  if (sqe == nullptr) {
+    return IoUringResult::Failed;
+  }
+
+  io_uring_prep_recv_multishot(sqe, fd, nullptr, 0, 0);
+  sqe->flags |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group = ProvidedBufferGroup;
+  io_uring_sqe_set_data(sqe, user_data);
+  return IoUringResult::Ok;
+}
+
+IoUringResult IoUringImpl::prepareRecvmsg(os_fd_t fd, struct msghdr* msg, Request* user_data) {
+  ENVOY_LOG(trace, "prepare recvmsg for fd = {}", fd);
+  // TODO (soulxu): Handling the case of CQ ring is overflow.
+  ASSERT(!(*(ring_.sq.kflags) & IORING_SQ_CQ_OVERFLOW));
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+  if (sqe == nullptr) {
+    return IoUringResult::Failed;
+  }
+
+  io_uring_prep_recvmsg(sqe, fd, msg, 0);
+  io_uring_sqe_set_data(sqe, user_data);
+  return IoUringResult::Ok;
+}
+
+IoUringResult IoUringImpl::prepareRecvmsgMultishot(os_fd_t fd, struct msghdr* msg,
+                                                   Request* user_data) {
+  ENVOY_LOG(trace, "prepare multishot recvmsg for fd = {}", fd);
+  ASSERT(buf_ring_ != nullptr);
+  // TODO (soulxu): Handling the case of CQ ring is overflow.
+  ASSERT(!(*(ring_.sq.kflags) & IORING_SQ_CQ_OVERFLOW));
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+  if (sqe == nullptr) {
+    return IoUringResult::Failed;
+  }
+
+  io_uring_prep_recvmsg_multishot(sqe, fd, msg, 0);
+  sqe->flags |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group = ProvidedBufferGroup;
+  io_uring_sqe_set_data(sqe, user_data);
+  return IoUringResult::Ok;
+}
+
 IoUringResult IoUringImpl::prepareWritev(os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs,
                                          off_t offset, Request* user_data) {
   ENVOY_LOG(trace, "prepare writev for fd = {}", fd);
@@ -190,12 +269,122 @@ IoUringResult IoUringImpl::prepareShutdown(os_fd_t fd, int how, Request* user_da
   return IoUringResult::Ok;
 }
 
+IoUringResult IoUringImpl::prepareOpenat(os_fd_t dir_fd, const char* path, int flags, mode_t mode,
+                                         Request* user_data) {
+  ENVOY_LOG(trace, "prepare openat for path = {}, flags = {}", path, flags);
+  ASSERT(!(*(ring_.sq.kflags) & IORING_SQ_CQ_OVERFLOW));
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+  if (sqe == nullptr) {
+    ENVOY_LOG(trace, "failed to prepare openat for path = {}", path);
+    return IoUringResult::Failed;
+  }
+
+  io_uring_prep_openat(sqe, dir_fd, path, flags, mode);
+  io_uring_sqe_set_data(sqe, user_data);
+  return IoUringResult::Ok;
+}
+
+IoUringResult IoUringImpl::prepareStatx(os_fd_t dir_fd, const char* path, int flags,
+                                        unsigned mask, struct statx* statx_buf,
+                                        Request* user_data) {
+  ENVOY_LOG(trace, "prepare statx for fd = {}, path = {}", dir_fd, path);
+  ASSERT(!(*(ring_.sq.kflags) & IORING_SQ_CQ_OVERFLOW));
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+  if (sqe == nullptr) {
+    ENVOY_LOG(trace, "failed to prepare statx for fd = {}, path = {}", dir_fd, path);
+    return IoUringResult::Failed;
+  }
+
+  io_uring_prep_statx(sqe, dir_fd, path, flags, mask, statx_buf);
+  io_uring_sqe_set_data(sqe, user_data);
+  return IoUringResult::Ok;
+}
+
+IoUringResult IoUringImpl::prepareUnlinkat(os_fd_t dir_fd, const char* path, int flags,
+                                           Request* user_data) {
+  ENVOY_LOG(trace, "prepare unlinkat for path = {}", path);
+  ASSERT(!(*(ring_.sq.kflags) & IORING_SQ_CQ_OVERFLOW));
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+  if (sqe == nullptr) {
+    ENVOY_LOG(trace, "failed to prepare unlinkat for path = {}", path);
+    return IoUringResult::Failed;
+  }
+
+  io_uring_prep_unlinkat(sqe, dir_fd, path, flags);
+  io_uring_sqe_set_data(sqe, user_data);
+  return IoUringResult::Ok;
+}
+
+IoUringResult IoUringImpl::prepareLinkat(os_fd_t old_dir_fd, const char* old_path,
+                                         os_fd_t new_dir_fd, const char* new_path, int flags,
+                                         Request* user_data) {
+  ENVOY_LOG(trace, "prepare linkat for path = {}", new_path);
+  ASSERT(!(*(ring_.sq.kflags) & IORING_SQ_CQ_OVERFLOW));
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+  if (sqe == nullptr) {
+    ENVOY_LOG(trace, "failed to prepare linkat for path = {}", new_path);
+    return IoUringResult::Failed;
+  }
+
+  io_uring_prep_linkat(sqe, old_dir_fd, old_path, new_dir_fd, new_path, flags);
+  io_uring_sqe_set_data(sqe, user_data);
+  return IoUringResult::Ok;
+}
+
+IoUringResult IoUringImpl::prepareFtruncate(os_fd_t fd, off_t length, Request* user_data) {
+  ENVOY_LOG(trace, "prepare ftruncate for fd = {}, length = {}", fd, length);
+  ASSERT(!(*(ring_.sq.kflags) & IORING_SQ_CQ_OVERFLOW));
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+  if (sqe == nullptr) {
+    ENVOY_LOG(trace, "failed to prepare ftruncate for fd = {}", fd);
+    return IoUringResult::Failed;
+  }
+
+  io_uring_prep_ftruncate(sqe, fd, length);
+  io_uring_sqe_set_data(sqe, user_data);
+  return IoUringResult::Ok;
+}
+
 IoUringResult IoUringImpl::submit() {
   int res = io_uring_submit(&ring_);
   RELEASE_ASSERT(res >= 0 || res == -EBUSY, "unable to submit io_uring queue entries");
   return res == -EBUSY ? IoUringResult::Busy : IoUringResult::Ok;
 }
 
+IoUringResult IoUringImpl::registerProvidedBuffers(uint32_t num_buffers, uint32_t buffer_size) {
+  ASSERT(buf_ring_ == nullptr);
+  ASSERT(num_buffers > 0 && num_buffers <= 32768 && (num_buffers & (num_buffers - 1)) == 0);
+  // Kernels before 5.19 have no provided buffer rings and fail the setup. Kernels with them but
+  // without multishot receives (5.19) are detected by the worker from the first completion.
+  int ret = 0;
+  buf_ring_ = io_uring_setup_buf_ring(&ring_, num_buffers, ProvidedBufferGroup, 0, &ret);
+  if (buf_ring_ == nullptr) {
+    ENVOY_LOG(debug, "unable to register provided buffers: {}", errorDetails(-ret));
+    return IoUringResult::Failed;
+  }
+
+  num_provided_buffers_ = num_buffers;
+  provided_buffer_size_ = buffer_size;
+  provided_buffers_ = std::make_unique<uint8_t[]>(static_cast<size_t>(num_buffers) * buffer_size);
+  const int mask = io_uring_buf_ring_mask(num_buffers);
+  for (uint32_t i = 0; i < num_buffers; i++) {
+    io_uring_buf_ring_add(buf_ring_, providedBuffer(i), buffer_size, i, mask, i);
+  }
+  io_uring_buf_ring_advance(buf_ring_, num_buffers);
+  return IoUringResult::Ok;
+}
+
+uint8_t* IoUringImpl::providedBuffer(uint16_t buffer_id) {
+  ASSERT(buffer_id < num_provided_buffers_);
+  return provided_buffers_.get() + static_cast<size_t>(buffer_id) * provided_buffer_size_;
+}
+
+void IoUringImpl::recycleProvidedBuffer(uint16_t buffer_id) {
+  io_uring_buf_ring_add(buf_ring_, providedBuffer(buffer_id), provided_buffer_size_, buffer_id,
+                        io_uring_buf_ring_mask(num_provided_buffers_), 0);
+  io_uring_buf_ring_advance(buf_ring_, 1);
+}
+
 void IoUringImpl::injectCompletion(os_fd_t fd, Request* user_data, int32_t result) {
   injected_completions_.emplace_back(fd, user_data, result);
   ENVOY_LOG(trace, "inject completion, fd = {}, req = {}, num injects = {}", fd,
@@ -12,6 +12,9 @@ namespace Io {
 
 bool isIoUringSupported();
 
+// Returns whether the kernel supports the io_uring operation with the given IORING_OP_* code.
+bool isIoUringOperationSupported(uint8_t opcode);
+
 struct InjectedCompletion {
   InjectedCompletion(os_fd_t fd, Request* user_data, int32_t result)
       : fd_(fd), user_data_(user_data), result_(result) {}
@@ -34,24 +37,49 @@ public:
   void forEveryCompletion(const CompletionCb& completion_cb) override;
   IoUringResult prepareAccept(os_fd_t fd, struct sockaddr* remote_addr, socklen_t* remote_addr_len,
                               Request* user_data) override;
+  IoUringResult prepareAcceptMultishot(os_fd_t fd, Request* user_data) override;
   IoUringResult prepareConnect(os_fd_t fd, const Network::Address::InstanceConstSharedPtr& address,
                                Request* user_data) override;
   IoUringResult prepareReadv(os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs, off_t offset,
                              Request* user_data) override;
+  IoUringResult prepareRecvMultishot(os_fd_t fd, Request* user_data) override;
+  IoUringResult prepareRecvmsg(os_fd_t fd, struct msghdr* msg, Request* user_data) override;
+  IoUringResult prepareRecvmsgMultishot(os_fd_t fd, struct msghdr* msg,
+                                        Request* user_data) override;
   IoUringResult prepareWritev(os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs,
                               off_t offset, Request* user_data) override;
   IoUringResult prepareClose(os_fd_t fd, Request* user_data) override;
   IoUringResult prepareCancel(Request* cancelling_user_data, Request* user_data) override;
   IoUringResult prepareShutdown(os_fd_t fd, int how, Request* user_data) override;
+  IoUringResult prepareOpenat(os_fd_t dir_fd, const char* path, int flags, mode_t mode,
+                              Request* user_data) override;
+  IoUringResult prepareStatx(os_fd_t dir_fd, const char* path, int flags, unsigned mask,
+                             struct statx* statx_buf, Request* user_data) override;
+  IoUringResult prepareUnlinkat(os_fd_t dir_fd, const char* path, int flags,
+                                Request* user_data) override;
+  IoUringResult prepareLinkat(os_fd_t old_dir_fd, const char* old_path, os_fd_t new_dir_fd,
+                              const char* new_path, int flags, Request* user_data) override;
+  IoUringResult prepareFtruncate(os_fd_t fd, off_t length, Request* user_data) override;
   IoUringResult submit() override;
+  IoUringResult registerProvidedBuffers(uint32_t num_buffers, uint32_t buffer_size) override;
+  uint8_t* providedBuffer(uint16_t buffer_id) override;
+  void recycleProvidedBuffer(uint16_t buffer_id) override;
   void injectCompletion(os_fd_t fd, Request* user_data, int32_t result) override;
   void removeInjectedCompletion(os_fd_t fd) override;
 
 private:
+  // The buffer group of the provided buffers. There is a single group per ring.
+  static constexpr uint16_t ProvidedBufferGroup = 0;
+
   struct io_uring ring_ {};
   std::vector<struct io_uring_cqe*> cqes_;
   os_fd_t event_fd_{INVALID_SOCKET};
   std::list<InjectedCompletion> injected_completions_;
+  // The ring the kernel picks provided buffers from, and the memory of the buffers.
+  struct io_uring_buf_ring* buf_ring_{nullptr};
+  std::unique_ptr<uint8_t[]> provided_buffers_;
+  uint32_t num_provided_buffers_{0};
+  uint32_t provided_buffer_size_{0};
 };
 
 } // namespace Io
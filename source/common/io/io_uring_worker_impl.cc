@@ -1,5 +1,7 @@
 #include "source/common/io/io_uring_worker_impl.h"
 
+#include "source/common/common/utility.h"
+
 namespace Envoy {
 namespace Io {
 
@@ -10,6 +12,25 @@ ReadRequest::ReadRequest(IoUringSocket& socket, uint32_t size)
   iov_->iov_len = size;
 }
 
+ReadRequest::ReadRequest(IoUringSocket& socket) : Request(RequestType::Read, socket) {}
+
+RecvmsgRequest::RecvmsgRequest(IoUringSocket& socket, uint32_t size)
+    : ReadRequest(socket, size), control_(std::make_unique<uint8_t[]>(ControlLength)) {
+  msg_.msg_name = &peer_address_;
+  msg_.msg_namelen = sizeof(peer_address_);
+  msg_.msg_iov = iov_.get();
+  msg_.msg_iovlen = 1;
+  msg_.msg_control = control_.get();
+  msg_.msg_controllen = ControlLength;
+}
+
+RecvmsgRequest::RecvmsgRequest(IoUringSocket& socket) : ReadRequest(socket) {
+  // A multishot recvmsg only takes the lengths of the name and the control messages, they are
+  // laid out in the provided buffer ahead of the payload.
+  msg_.msg_namelen = sizeof(peer_address_);
+  msg_.msg_controllen = ControlLength;
+}
+
 WriteRequest::WriteRequest(IoUringSocket& socket, const Buffer::RawSliceVector& slices)
     : Request(RequestType::Write, socket), iov_(std::make_unique<struct iovec[]>(slices.size())) {
   for (size_t i = 0; i < slices.size(); i++) {
@@ -60,14 +81,24 @@ void IoUringSocketEntry::onRemoteClose() {
 
 IoUringWorkerImpl::IoUringWorkerImpl(uint32_t io_uring_size, bool use_submission_queue_polling,
                                      uint32_t read_buffer_size, uint32_t write_timeout_ms,
-                                     Event::Dispatcher& dispatcher)
+                                     Event::Dispatcher& dispatcher, uint32_t read_buffer_ring_size)
     : IoUringWorkerImpl(std::make_unique<IoUringImpl>(io_uring_size, use_submission_queue_polling),
-                        read_buffer_size, write_timeout_ms, dispatcher) {}
+                        read_buffer_size, write_timeout_ms, dispatcher, read_buffer_ring_size) {}
 
 IoUringWorkerImpl::IoUringWorkerImpl(IoUringPtr&& io_uring, uint32_t read_buffer_size,
-                                     uint32_t write_timeout_ms, Event::Dispatcher& dispatcher)
+                                     uint32_t write_timeout_ms, Event::Dispatcher& dispatcher,
+                                     uint32_t read_buffer_ring_size)
     : io_uring_(std::move(io_uring)), read_buffer_size_(read_buffer_size),
       write_timeout_ms_(write_timeout_ms), dispatcher_(dispatcher) {
+  // Kernels without provided buffer rings fall back to a read buffer per request.
+  if (read_buffer_ring_size > 0) {
+    has_provided_buffers_ =
+        io_uring_->registerProvidedBuffers(read_buffer_ring_size, read_buffer_size_) ==
+        IoUringResult::Ok;
+    ENVOY_LOG(debug, "io_uring provided buffers {}, ring size = {}, buffer size = {}",
+              has_provided_buffers_ ? "enabled" : "not supported", read_buffer_ring_size,
+              read_buffer_size_);
+  }
   const os_fd_t event_fd = io_uring_->registerEventfd();
   // We only care about the read event of Eventfd, since we only receive the
   // event here.
@@ -127,6 +158,22 @@ IoUringSocket& IoUringWorkerImpl::addClientSocket(os_fd_t fd, Event::FileReadyCb
   return addSocket(std::move(socket));
 }
 
+IoUringSocket& IoUringWorkerImpl::addAcceptSocket(os_fd_t fd, Event::FileReadyCb cb) {
+  ENVOY_LOG(trace, "add accept socket, fd = {}", fd);
+  std::unique_ptr<IoUringAcceptSocket> socket =
+      std::make_unique<IoUringAcceptSocket>(fd, *this, std::move(cb));
+  socket->enableRead();
+  return addSocket(std::move(socket));
+}
+
+IoUringSocket& IoUringWorkerImpl::addDatagramSocket(os_fd_t fd, Event::FileReadyCb cb) {
+  ENVOY_LOG(trace, "add datagram socket, fd = {}", fd);
+  std::unique_ptr<IoUringDatagramSocket> socket =
+      std::make_unique<IoUringDatagramSocket>(fd, *this, std::move(cb));
+  socket->enableRead();
+  return addSocket(std::move(socket));
+}
+
 Event::Dispatcher& IoUringWorkerImpl::dispatcher() { return dispatcher_; }
 
 IoUringSocketEntry& IoUringWorkerImpl::addSocket(IoUringSocketEntryPtr&& socket) {
@@ -134,6 +181,29 @@ IoUringSocketEntry& IoUringWorkerImpl::addSocket(IoUringSocketEntryPtr&& socket)
   return *sockets_.back();
 }
 
+Request* IoUringWorkerImpl::submitAcceptRequest(IoUringSocket& socket) {
+  AcceptRequest* req = new AcceptRequest(socket);
+  req->multishot_ = multishotAllowed(socket);
+
+  ENVOY_LOG(trace, "submit accept request, fd = {}, req = {}, multishot = {}", socket.fd(),
+            fmt::ptr(req), req->multishot_);
+
+  // Multishot accept is supported by the same kernels as provided buffer rings.
+  auto prepare = [this, &socket, req]() {
+    return req->multishot_ ? io_uring_->prepareAcceptMultishot(socket.fd(), req)
+                           : io_uring_->prepareAccept(socket.fd(), nullptr, nullptr, req);
+  };
+  auto res = prepare();
+  if (res == IoUringResult::Failed) {
+    // TODO(rojkov): handle `EBUSY` in case the completion queue is never reaped.
+    submit();
+    res = prepare();
+    RELEASE_ASSERT(res == IoUringResult::Ok, "unable to prepare accept");
+  }
+  submit();
+  return req;
+}
+
 Request*
 IoUringWorkerImpl::submitConnectRequest(IoUringSocket& socket,
                                         const Network::Address::InstanceConstSharedPtr& address) {
@@ -153,6 +223,23 @@ IoUringWorkerImpl::submitConnectRequest(IoUringSocket& socket,
 }
 
 Request* IoUringWorkerImpl::submitReadRequest(IoUringSocket& socket) {
+  if (multishotAllowed(socket)) {
+    ReadRequest* req = new ReadRequest(socket);
+
+    ENVOY_LOG(trace, "submit multishot read request, fd = {}, read req = {}", socket.fd(),
+              fmt::ptr(req));
+
+    auto res = io_uring_->prepareRecvMultishot(socket.fd(), req);
+    if (res == IoUringResult::Failed) {
+      // TODO(rojkov): handle `EBUSY` in case the completion queue is never reaped.
+      submit();
+      res = io_uring_->prepareRecvMultishot(socket.fd(), req);
+      RELEASE_ASSERT(res == IoUringResult::Ok, "unable to prepare multishot recv");
+    }
+    submit();
+    return req;
+  }
+
   ReadRequest* req = new ReadRequest(socket, read_buffer_size_);
 
   ENVOY_LOG(trace, "submit read request, fd = {}, read req = {}", socket.fd(), fmt::ptr(req));
@@ -168,6 +255,29 @@ Request* IoUringWorkerImpl::submitReadRequest(IoUringSocket& socket) {
   return req;
 }
 
+Request* IoUringWorkerImpl::submitRecvmsgRequest(IoUringSocket& socket) {
+  const bool multishot = multishotAllowed(socket);
+  RecvmsgRequest* req =
+      multishot ? new RecvmsgRequest(socket) : new RecvmsgRequest(socket, read_buffer_size_);
+
+  ENVOY_LOG(trace, "submit recvmsg request, fd = {}, req = {}, multishot = {}", socket.fd(),
+            fmt::ptr(req), multishot);
+
+  auto prepare = [this, &socket, req, multishot]() {
+    return multishot ? io_uring_->prepareRecvmsgMultishot(socket.fd(), &req->msg_, req)
+                     : io_uring_->prepareRecvmsg(socket.fd(), &req->msg_, req);
+  };
+  auto res = prepare();
+  if (res == IoUringResult::Failed) {
+    // TODO(rojkov): handle `EBUSY` in case the completion queue is never reaped.
+    submit();
+    res = prepare();
+    RELEASE_ASSERT(res == IoUringResult::Ok, "unable to prepare recvmsg");
+  }
+  submit();
+  return req;
+}
+
 Request* IoUringWorkerImpl::submitWriteRequest(IoUringSocket& socket,
                                                const Buffer::RawSliceVector& slices) {
   WriteRequest* req = new WriteRequest(socket, slices);
@@ -251,15 +361,25 @@ void IoUringWorkerImpl::injectCompletion(IoUringSocket& socket, Request::Request
 void IoUringWorkerImpl::onFileEvent() {
   ENVOY_LOG(trace, "io uring worker, on file event");
   delay_submit_ = true;
-  io_uring_->forEveryCompletion([](Request* req, int32_t result, bool injected) {
-    ENVOY_LOG(trace, "receive request completion, type = {}, req = {}",
-              static_cast<uint8_t>(req->type()), fmt::ptr(req));
+  io_uring_->forEveryCompletion([this](Request* req, int32_t result, uint32_t flags,
+                                       bool injected) {
+    ENVOY_LOG(trace, "receive request completion, type = {}, req = {}, flags = {}",
+              static_cast<uint8_t>(req->type()), fmt::ptr(req), flags);
     ASSERT(req != nullptr);
 
+    // A multishot request stays armed, and so alive, until a completion without more.
+    const bool more = (flags & IORING_CQE_F_MORE) != 0;
+
     switch (req->type()) {
     case Request::RequestType::Accept:
       ENVOY_LOG(trace, "receive accept request completion, fd = {}, req = {}", req->socket().fd(),
                 fmt::ptr(req));
+      if (!injected) {
+        AcceptRequest* accept_req = static_cast<AcceptRequest*>(req);
+        accept_req->more_ = more;
+        result = checkMultishotSupport(static_cast<IoUringSocketEntry&>(req->socket()),
+                                       accept_req->multishot_, multishot_accept_verified_, result);
+      }
       req->socket().onAccept(req, result, injected);
       break;
     case Request::RequestType::Connect:
@@ -267,11 +387,29 @@ void IoUringWorkerImpl::onFileEvent() {
                 fmt::ptr(req));
       req->socket().onConnect(req, result, injected);
       break;
-    case Request::RequestType::Read:
+    case Request::RequestType::Read: {
       ENVOY_LOG(trace, "receive Read request completion, fd = {}, req = {}", req->socket().fd(),
                 fmt::ptr(req));
+      if (injected) {
+        req->socket().onRead(req, result, injected);
+        break;
+      }
+      ReadRequest* read_req = static_cast<ReadRequest*>(req);
+      read_req->more_ = more;
+      // Only multishot reads and receives have no buffer of their own.
+      result = checkMultishotSupport(static_cast<IoUringSocketEntry&>(req->socket()),
+                                     read_req->buf_ == nullptr, multishot_recv_verified_, result);
+      const bool has_buffer = (flags & IORING_CQE_F_BUFFER) != 0;
+      const uint16_t buffer_id = flags >> IORING_CQE_BUFFER_SHIFT;
+      read_req->provided_buf_ = has_buffer ? io_uring_->providedBuffer(buffer_id) : nullptr;
       req->socket().onRead(req, result, injected);
+      // The socket copied the data out, the buffer can be used for the next read.
+      if (has_buffer) {
+        read_req->provided_buf_ = nullptr;
+        io_uring_->recycleProvidedBuffer(buffer_id);
+      }
       break;
+    }
     case Request::RequestType::Write:
       ENVOY_LOG(trace, "receive write request completion, fd = {}, req = {}", req->socket().fd(),
                 fmt::ptr(req));
@@ -294,12 +432,47 @@ void IoUringWorkerImpl::onFileEvent() {
       break;
     }
 
-    delete req;
+    if (!more) {
+      delete req;
+    }
   });
   delay_submit_ = false;
   submit();
 }
 
+int32_t IoUringWorkerImpl::checkMultishotSupport(IoUringSocketEntry& socket, bool multishot,
+                                                 bool& verified, int32_t result) {
+  if (verified) {
+    return result;
+  }
+  if (multishot) {
+    if (result != -EINVAL) {
+      verified = true;
+      return result;
+    }
+    ENVOY_LOG(debug, "multishot request of fd = {} failed with EINVAL, retrying with single shot",
+              socket.fd());
+    socket.multishot_fallback_ = IoUringSocketEntry::MultishotFallback::Probing;
+    return -ECANCELED;
+  }
+  if (socket.multishot_fallback_ != IoUringSocketEntry::MultishotFallback::Probing) {
+    return result;
+  }
+  socket.multishot_fallback_ = IoUringSocketEntry::MultishotFallback::Done;
+  if (result != -EINVAL && has_provided_buffers_) {
+    // The socket accepts the single shot request the multishot one was rejected for.
+    ENVOY_LOG(debug, "multishot requests are not supported by the kernel, using single shot");
+    has_provided_buffers_ = false;
+  }
+  return result;
+}
+
+bool IoUringWorkerImpl::multishotAllowed(IoUringSocket& socket) const {
+  return has_provided_buffers_ &&
+         static_cast<IoUringSocketEntry&>(socket).multishot_fallback_ ==
+             IoUringSocketEntry::MultishotFallback::None;
+}
+
 void IoUringWorkerImpl::submit() {
   if (!delay_submit_) {
     io_uring_->submit();
@@ -430,6 +603,11 @@ void IoUringServerSocket::onCancel(Request* req, int32_t result, bool injected)
 
 void IoUringServerSocket::moveReadDataToBuffer(Request* req, size_t data_length) {
   ReadRequest* read_req = static_cast<ReadRequest*>(req);
+  if (read_req->provided_buf_ != nullptr) {
+    // The provided buffer goes back to the kernel once the completion is handled.
+    read_buf_.add(read_req->provided_buf_, data_length);
+    return;
+  }
   Buffer::BufferFragment* fragment = new Buffer::BufferFragmentImpl(
       read_req->buf_.release(), data_length,
       [](const void* data, size_t, const Buffer::BufferFragmentImpl* this_fragment) {
@@ -457,10 +635,13 @@ void IoUringServerSocket::onRead(Request* req, int32_t result, bool injected) {
             "onRead with result {}, fd = {}, injected = {}, status_ = {}, enable_close_event = {}",
             result, fd_, injected, static_cast<int>(status_), enable_close_event_);
   if (!injected) {
-    read_req_ = nullptr;
+    // A multishot read stays armed until a completion without more.
+    if (!static_cast<ReadRequest*>(req)->more_) {
+      read_req_ = nullptr;
+    }
     // If the socket is going to close, discard all results.
-    if (status_ == Closed && write_or_shutdown_req_ == nullptr && read_cancel_req_ == nullptr &&
-        write_or_shutdown_cancel_req_ == nullptr) {
+    if (status_ == Closed && read_req_ == nullptr && write_or_shutdown_req_ == nullptr &&
+        read_cancel_req_ == nullptr && write_or_shutdown_cancel_req_ == nullptr) {
       if (result > 0 && keep_fd_open_) {
         moveReadDataToBuffer(req, result);
       }
@@ -473,7 +654,9 @@ void IoUringServerSocket::onRead(Request* req, int32_t result, bool injected) {
   if (result > 0) {
     moveReadDataToBuffer(req, result);
   } else {
-    if (result != -ECANCELED) {
+    // A multishot read ends with -ENOBUFS when the provided buffers run out. It is submitted again
+    // below, like a canceled read.
+    if (result != -ECANCELED && result != -ENOBUFS) {
       read_error_ = result;
     }
   }
@@ -642,6 +825,310 @@ void IoUringServerSocket::submitWriteOrShutdownRequest() {
   }
 }
 
+IoUringAcceptSocket::IoUringAcceptSocket(os_fd_t fd, IoUringWorkerImpl& parent,
+                                         Event::FileReadyCb cb)
+    : IoUringSocketEntry(fd, parent, std::move(cb), false) {}
+
+void IoUringAcceptSocket::close(bool keep_fd_open, IoUringSocketOnClosedCb cb) {
+  ENVOY_LOG(trace, "close the accept socket, fd = {}, status = {}", fd_,
+            static_cast<int>(status_));
+
+  IoUringSocketEntry::close(keep_fd_open, cb);
+  keep_fd_open_ = keep_fd_open;
+
+  // Delay close until the accept request is drained.
+  if (accept_req_ == nullptr && accept_cancel_req_ == nullptr) {
+    closeInternal();
+    return;
+  }
+  if (accept_req_ != nullptr && accept_cancel_req_ == nullptr) {
+    accept_cancel_req_ = parent_.submitCancelRequest(*this, accept_req_);
+  }
+}
+
+void IoUringAcceptSocket::enableRead() {
+  IoUringSocketEntry::enableRead();
+  ENVOY_LOG(trace, "enable accept, fd = {}, accepted = {}", fd_, accepted_sockets_.size());
+
+  if (!accepted_sockets_.empty()) {
+    injectCompletion(Request::RequestType::Accept);
+  }
+  submitAcceptRequest();
+}
+
+void IoUringAcceptSocket::disableRead() {
+  IoUringSocketEntry::disableRead();
+  ENVOY_LOG(trace, "disable accept, fd = {}", fd_);
+
+  if (accept_req_ != nullptr && accept_cancel_req_ == nullptr) {
+    accept_cancel_req_ = parent_.submitCancelRequest(*this, accept_req_);
+  }
+}
+
+void IoUringAcceptSocket::onAccept(Request* req, int32_t result, bool injected) {
+  IoUringSocketEntry::onAccept(req, result, injected);
+
+  ENVOY_LOG(trace, "onAccept with result {}, fd = {}, injected = {}, status_ = {}", result, fd_,
+            injected, static_cast<int>(status_));
+  if (!injected) {
+    if (!static_cast<AcceptRequest*>(req)->more_) {
+      accept_req_ = nullptr;
+    }
+    if (result >= 0) {
+      if (status_ == Closed) {
+        ::close(result);
+      } else {
+        accepted_sockets_.push_back(result);
+      }
+    } else if (result != -ECANCELED) {
+      ENVOY_LOG(debug, "accept failed, fd = {}, error = {}", fd_, errorDetails(-result));
+    }
+
+    if (status_ == Closed) {
+      if (accept_req_ == nullptr && accept_cancel_req_ == nullptr) {
+        closeInternal();
+      }
+      return;
+    }
+  }
+
+  // An injected completion notifies the handler even without accepted sockets, as a socket
+  // activated for read does.
+  if (status_ == ReadEnabled && (injected || !accepted_sockets_.empty())) {
+    THROW_IF_NOT_OK(cb_(Event::FileReadyType::Read));
+  }
+
+  // The socket may be disabled or closed by the handler.
+  if (status_ == ReadEnabled) {
+    // The handler may stop taking sockets before taking them all. Like a level triggered event,
+    // notify it again for the rest.
+    if (!accepted_sockets_.empty()) {
+      injectCompletion(Request::RequestType::Accept);
+    }
+    submitAcceptRequest();
+  }
+}
+
+void IoUringAcceptSocket::onCancel(Request* req, int32_t result, bool injected) {
+  IoUringSocketEntry::onCancel(req, result, injected);
+  ASSERT(!injected);
+  accept_cancel_req_ = nullptr;
+  if (status_ == Closed && accept_req_ == nullptr) {
+    closeInternal();
+  }
+}
+
+void IoUringAcceptSocket::onClose(Request* req, int32_t result, bool injected) {
+  IoUringSocketEntry::onClose(req, result, injected);
+  ASSERT(!injected);
+  cleanup();
+}
+
+os_fd_t IoUringAcceptSocket::nextAcceptedSocket() {
+  if (accepted_sockets_.empty()) {
+    return INVALID_SOCKET;
+  }
+  const os_fd_t fd = accepted_sockets_.front();
+  accepted_sockets_.pop_front();
+  return fd;
+}
+
+void IoUringAcceptSocket::closeInternal() {
+  // Sockets which were accepted but not taken are closed along with the listen socket.
+  for (const os_fd_t fd : accepted_sockets_) {
+    ::close(fd);
+  }
+  accepted_sockets_.clear();
+
+  if (keep_fd_open_) {
+    cleanup();
+    return;
+  }
+  if (close_req_ == nullptr) {
+    close_req_ = parent_.submitCloseRequest(*this);
+  }
+}
+
+void IoUringAcceptSocket::submitAcceptRequest() {
+  if (accept_req_ == nullptr) {
+    accept_req_ = parent_.submitAcceptRequest(*this);
+  }
+}
+
+IoUringDatagramSocket::IoUringDatagramSocket(os_fd_t fd, IoUringWorkerImpl& parent,
+                                             Event::FileReadyCb cb)
+    : IoUringSocketEntry(fd, parent, std::move(cb), false) {}
+
+void IoUringDatagramSocket::close(bool keep_fd_open, IoUringSocketOnClosedCb cb) {
+  ENVOY_LOG(trace, "close the datagram socket, fd = {}, status = {}", fd_,
+            static_cast<int>(status_));
+
+  IoUringSocketEntry::close(keep_fd_open, cb);
+  keep_fd_open_ = keep_fd_open;
+  datagrams_.clear();
+
+  // Delay close until the recvmsg request is drained.
+  if (recvmsg_req_ == nullptr && recvmsg_cancel_req_ == nullptr) {
+    closeInternal();
+    return;
+  }
+  cancelRecvmsgRequest();
+}
+
+void IoUringDatagramSocket::enableRead() {
+  IoUringSocketEntry::enableRead();
+  ENVOY_LOG(trace, "enable recvmsg, fd = {}, pending = {}", fd_, datagrams_.size());
+
+  if (!datagrams_.empty()) {
+    injectCompletion(Request::RequestType::Read);
+  }
+  submitRecvmsgRequest();
+}
+
+void IoUringDatagramSocket::disableRead() {
+  IoUringSocketEntry::disableRead();
+  ENVOY_LOG(trace, "disable recvmsg, fd = {}", fd_);
+  cancelRecvmsgRequest();
+}
+
+void IoUringDatagramSocket::onRead(Request* req, int32_t result, bool injected) {
+  IoUringSocketEntry::onRead(req, result, injected);
+
+  ENVOY_LOG(trace, "onRead with result {}, fd = {}, injected = {}, status_ = {}", result, fd_,
+            injected, static_cast<int>(status_));
+  if (!injected) {
+    RecvmsgRequest* recvmsg_req = static_cast<RecvmsgRequest*>(req);
+    if (!recvmsg_req->more_) {
+      recvmsg_req_ = nullptr;
+    }
+    if (status_ == Closed) {
+      if (recvmsg_req_ == nullptr && recvmsg_cancel_req_ == nullptr) {
+        closeInternal();
+      }
+      return;
+    }
+
+    if (result >= 0) {
+      ReceivedDatagramPtr datagram = toDatagram(*recvmsg_req, result);
+      if (datagram != nullptr) {
+        datagrams_.push_back(std::move(datagram));
+      }
+    } else if (result != -ECANCELED && result != -ENOBUFS) {
+      ENVOY_LOG(debug, "recvmsg failed, fd = {}, error = {}", fd_, errorDetails(-result));
+    }
+    if (datagrams_.size() >= MaxPendingDatagrams) {
+      cancelRecvmsgRequest();
+    }
+  }
+
+  if (status_ == ReadEnabled && (injected || !datagrams_.empty())) {
+    THROW_IF_NOT_OK(cb_(Event::FileReadyType::Read));
+  }
+
+  // The socket may be disabled or closed by the handler.
+  if (status_ == ReadEnabled) {
+    if (!datagrams_.empty()) {
+      injectCompletion(Request::RequestType::Read);
+    }
+    submitRecvmsgRequest();
+  }
+}
+
+void IoUringDatagramSocket::onWrite(Request* req, int32_t result, bool injected) {
+  IoUringSocketEntry::onWrite(req, result, injected);
+  // Datagrams are sent by the handle directly, only injected write events come here.
+  ASSERT(injected);
+  if (status_ != Closed) {
+    THROW_IF_NOT_OK(cb_(Event::FileReadyType::Write));
+  }
+}
+
+void IoUringDatagramSocket::onCancel(Request* req, int32_t result, bool injected) {
+  IoUringSocketEntry::onCancel(req, result, injected);
+  ASSERT(!injected);
+  recvmsg_cancel_req_ = nullptr;
+  if (status_ == Closed) {
+    if (recvmsg_req_ == nullptr) {
+      closeInternal();
+    }
+    return;
+  }
+  // The recvmsg request may have been canceled for a full queue, or for a disabled socket which
+  // has been enabled again since.
+  if (status_ == ReadEnabled) {
+    submitRecvmsgRequest();
+  }
+}
+
+void IoUringDatagramSocket::onClose(Request* req, int32_t result, bool injected) {
+  IoUringSocketEntry::onClose(req, result, injected);
+  ASSERT(!injected);
+  cleanup();
+}
+
+ReceivedDatagramPtr IoUringDatagramSocket::nextReceivedDatagram() {
+  if (datagrams_.empty()) {
+    return nullptr;
+  }
+  ReceivedDatagramPtr datagram = std::move(datagrams_.front());
+  datagrams_.pop_front();
+  return datagram;
+}
+
+void IoUringDatagramSocket::closeInternal() {
+  if (keep_fd_open_) {
+    cleanup();
+    return;
+  }
+  if (close_req_ == nullptr) {
+    close_req_ = parent_.submitCloseRequest(*this);
+  }
+}
+
+void IoUringDatagramSocket::submitRecvmsgRequest() {
+  if (recvmsg_req_ == nullptr && recvmsg_cancel_req_ == nullptr &&
+      datagrams_.size() < MaxPendingDatagrams) {
+    recvmsg_req_ = parent_.submitRecvmsgRequest(*this);
+  }
+}
+
+void IoUringDatagramSocket::cancelRecvmsgRequest() {
+  if (recvmsg_req_ != nullptr && recvmsg_cancel_req_ == nullptr) {
+    ENVOY_LOG(trace, "cancel the recvmsg request, fd = {}", fd_);
+    recvmsg_cancel_req_ = parent_.submitCancelRequest(*this, recvmsg_req_);
+  }
+}
+
+ReceivedDatagramPtr IoUringDatagramSocket::toDatagram(RecvmsgRequest& req, int32_t result) {
+  auto datagram = std::make_unique<ReceivedDatagram>();
+  if (req.provided_buf_ == nullptr) {
+    datagram->peer_address_ = req.peer_address_;
+    datagram->peer_address_len_ = req.msg_.msg_namelen;
+    datagram->control_.assign(req.control_.get(), req.control_.get() + req.msg_.msg_controllen);
+    datagram->payload_.assign(req.buf_.get(), req.buf_.get() + result);
+    datagram->flags_ = req.msg_.msg_flags;
+    return datagram;
+  }
+
+  // A multishot recvmsg lays out a header, the name, the control messages and the payload in the
+  // provided buffer.
+  struct io_uring_recvmsg_out* out =
+      io_uring_recvmsg_validate(req.provided_buf_, result, &req.msg_);
+  if (out == nullptr) {
+    return nullptr;
+  }
+  const socklen_t name_length = std::min<socklen_t>(out->namelen, req.msg_.msg_namelen);
+  memcpy(&datagram->peer_address_, io_uring_recvmsg_name(out), name_length); // NOLINT(safe-memcpy)
+  datagram->peer_address_len_ = name_length;
+  const uint8_t* control = static_cast<uint8_t*>(io_uring_recvmsg_name(out)) + req.msg_.msg_namelen;
+  datagram->control_.assign(control, control + out->controllen);
+  const uint8_t* payload = static_cast<uint8_t*>(io_uring_recvmsg_payload(out, &req.msg_));
+  datagram->payload_.assign(payload,
+                            payload + io_uring_recvmsg_payload_length(out, result, &req.msg_));
+  datagram->flags_ = out->flags;
+  return datagram;
+}
+
 IoUringClientSocket::IoUringClientSocket(os_fd_t fd, IoUringWorkerImpl& parent,
                                          Event::FileReadyCb cb, uint32_t write_timeout_ms,
                                          bool enable_close_event)
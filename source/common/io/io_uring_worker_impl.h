@@ -1,5 +1,7 @@
 #pragma once
 
+#include <deque>
+
 #include "envoy/common/io/io_uring.h"
 
 #include "source/common/buffer/buffer_impl.h"
@@ -10,12 +12,45 @@
 namespace Envoy {
 namespace Io {
 
+class AcceptRequest : public Request {
+public:
+  explicit AcceptRequest(IoUringSocket& socket) : Request(RequestType::Accept, socket) {}
+
+  // Whether the accept was submitted as a multishot request.
+  bool multishot_{false};
+  // Set by the worker for each completion: whether a multishot accept stays armed.
+  bool more_{false};
+};
+
 class ReadRequest : public Request {
 public:
+  // A read into a buffer of its own.
   ReadRequest(IoUringSocket& socket, uint32_t size);
+  // A multishot read into the buffers provided to the io_uring.
+  explicit ReadRequest(IoUringSocket& socket);
 
   std::unique_ptr<uint8_t[]> buf_;
   std::unique_ptr<struct iovec> iov_;
+  // Set by the worker for each completion: the provided buffer holding the data, which goes back
+  // to the kernel once the completion is handled, and whether a multishot read stays armed.
+  uint8_t* provided_buf_{nullptr};
+  bool more_{false};
+};
+
+class RecvmsgRequest : public ReadRequest {
+public:
+  // A recvmsg into a buffer of its own.
+  RecvmsgRequest(IoUringSocket& socket, uint32_t size);
+  // A multishot recvmsg into the buffers provided to the io_uring.
+  explicit RecvmsgRequest(IoUringSocket& socket);
+
+  // Room for the control messages of a datagram: packet info, packets dropped, GRO segment size
+  // and TOS take less than half of it.
+  static constexpr uint32_t ControlLength = 256;
+
+  struct msghdr msg_ {};
+  sockaddr_storage peer_address_{};
+  std::unique_ptr<uint8_t[]> control_;
 };
 
 class WriteRequest : public Request {
@@ -32,9 +67,11 @@ class IoUringWorkerImpl : public IoUringWorker, private Logger::Loggable<Logger:
 public:
   IoUringWorkerImpl(uint32_t io_uring_size, bool use_submission_queue_polling,
                     uint32_t read_buffer_size, uint32_t write_timeout_ms,
-                    Event::Dispatcher& dispatcher);
+                    Event::Dispatcher& dispatcher, uint32_t read_buffer_ring_size = 0);
+  // If read_buffer_ring_size is not 0 and the kernel supports it, sockets share a ring of that
+  // many read buffers and read, accept and receive with multishot requests.
   IoUringWorkerImpl(IoUringPtr&& io_uring, uint32_t read_buffer_size, uint32_t write_timeout_ms,
-                    Event::Dispatcher& dispatcher);
+                    Event::Dispatcher& dispatcher, uint32_t read_buffer_ring_size = 0);
   ~IoUringWorkerImpl() override;
 
   // IoUringWorker
@@ -44,10 +81,14 @@ public:
                                  bool enable_close_event) override;
   IoUringSocket& addClientSocket(os_fd_t fd, Event::FileReadyCb cb,
                                  bool enable_close_event) override;
+  IoUringSocket& addAcceptSocket(os_fd_t fd, Event::FileReadyCb cb) override;
+  IoUringSocket& addDatagramSocket(os_fd_t fd, Event::FileReadyCb cb) override;
 
+  Request* submitAcceptRequest(IoUringSocket& socket) override;
   Request* submitConnectRequest(IoUringSocket& socket,
                                 const Network::Address::InstanceConstSharedPtr& address) override;
   Request* submitReadRequest(IoUringSocket& socket) override;
+  Request* submitRecvmsgRequest(IoUringSocket& socket) override;
   Request* submitWriteRequest(IoUringSocket& socket, const Buffer::RawSliceVector& slices) override;
   Request* submitCloseRequest(IoUringSocket& socket) override;
   Request* submitCancelRequest(IoUringSocket& socket, Request* request_to_cancel) override;
@@ -64,15 +105,30 @@ public:
   // Return the number of sockets in this worker.
   uint32_t getNumOfSockets() const override { return sockets_.size(); }
 
+  bool hasProvidedBuffers() const override { return has_provided_buffers_; }
+
 protected:
   // Add a socket to the worker.
   IoUringSocketEntry& addSocket(IoUringSocketEntryPtr&& socket);
   void onFileEvent();
   void submit();
+  // Kernels with provided buffer rings but without multishot requests of a type fail those with
+  // -EINVAL, and so do sockets the request is not valid for, e.g. an accept on a socket that is
+  // not listening. Until a multishot request of the type has completed otherwise, such a
+  // completion only switches its socket to single shot requests and is turned into -ECANCELED,
+  // which makes the socket submit the request again. If that single shot request doesn't fail
+  // with -EINVAL as well, it was the kernel that rejected the multishot request, and the worker
+  // switches to single shot requests for every socket.
+  int32_t checkMultishotSupport(IoUringSocketEntry& socket, bool multishot, bool& verified,
+                                int32_t result);
+  bool multishotAllowed(IoUringSocket& socket) const;
 
   // The iouring instance.
   IoUringPtr io_uring_;
   const uint32_t read_buffer_size_;
+  bool has_provided_buffers_{false};
+  bool multishot_accept_verified_{false};
+  bool multishot_recv_verified_{false};
   const uint32_t write_timeout_ms_;
   // The dispatcher of this worker is running on.
   Event::Dispatcher& dispatcher_;
@@ -152,6 +208,15 @@ public:
 
   void setFileReadyCb(Event::FileReadyCb cb) override { cb_ = std::move(cb); }
 
+  os_fd_t nextAcceptedSocket() override { return INVALID_SOCKET; }
+  ReceivedDatagramPtr nextReceivedDatagram() override { return nullptr; }
+
+  // Set by the worker when a multishot request of this socket fails with -EINVAL before the
+  // kernel is known to support them: Probing until the single shot request submitted instead has
+  // completed, and Done after.
+  enum class MultishotFallback { None, Probing, Done };
+  MultishotFallback multishot_fallback_{MultishotFallback::None};
+
 protected:
   /**
    * For the socket to remove itself from the IoUringWorker and defer deletion.
@@ -251,6 +316,72 @@ protected:
   void onWriteCompleted(int32_t result);
 };
 
+class IoUringAcceptSocket : public IoUringSocketEntry {
+public:
+  IoUringAcceptSocket(os_fd_t fd, IoUringWorkerImpl& parent, Event::FileReadyCb cb);
+
+  // IoUringSocket
+  void close(bool keep_fd_open, IoUringSocketOnClosedCb cb = nullptr) override;
+  void enableRead() override;
+  void disableRead() override;
+  void write(Buffer::Instance&) override { PANIC("not implemented"); }
+  uint64_t write(const Buffer::RawSlice*, uint64_t) override { PANIC("not implemented"); }
+  void shutdown(int) override { PANIC("not implemented"); }
+  void onAccept(Request* req, int32_t result, bool injected) override;
+  void onCancel(Request* req, int32_t result, bool injected) override;
+  void onClose(Request* req, int32_t result, bool injected) override;
+  os_fd_t nextAcceptedSocket() override;
+
+protected:
+  void closeInternal();
+  void submitAcceptRequest();
+
+  // The accept request is armed while the socket is read enabled. When the socket is read
+  // disabled, it is canceled, so that connections wait in the kernel backlog.
+  Request* accept_req_{nullptr};
+  Request* accept_cancel_req_{nullptr};
+  Request* close_req_{nullptr};
+  bool keep_fd_open_{false};
+  // Sockets which have been accepted but not taken yet.
+  std::deque<os_fd_t> accepted_sockets_;
+};
+
+class IoUringDatagramSocket : public IoUringSocketEntry {
+public:
+  IoUringDatagramSocket(os_fd_t fd, IoUringWorkerImpl& parent, Event::FileReadyCb cb);
+
+  // Datagrams which have been received but not taken yet are limited to this number. Beyond it,
+  // the recvmsg request is canceled, so that the kernel applies its socket buffer limit and
+  // counts dropped packets.
+  static constexpr size_t MaxPendingDatagrams = 1024;
+
+  // IoUringSocket
+  void close(bool keep_fd_open, IoUringSocketOnClosedCb cb = nullptr) override;
+  void enableRead() override;
+  void disableRead() override;
+  void write(Buffer::Instance&) override { PANIC("not implemented"); }
+  uint64_t write(const Buffer::RawSlice*, uint64_t) override { PANIC("not implemented"); }
+  void shutdown(int) override { PANIC("not implemented"); }
+  void onRead(Request* req, int32_t result, bool injected) override;
+  void onWrite(Request* req, int32_t result, bool injected) override;
+  void onCancel(Request* req, int32_t result, bool injected) override;
+  void onClose(Request* req, int32_t result, bool injected) override;
+  ReceivedDatagramPtr nextReceivedDatagram() override;
+
+protected:
+  void closeInternal();
+  void submitRecvmsgRequest();
+  void cancelRecvmsgRequest();
+  static ReceivedDatagramPtr toDatagram(RecvmsgRequest& req, int32_t result);
+
+  // As for accept sockets, the recvmsg request is armed only while the socket is read enabled.
+  Request* recvmsg_req_{nullptr};
+  Request* recvmsg_cancel_req_{nullptr};
+  Request* close_req_{nullptr};
+  bool keep_fd_open_{false};
+  std::deque<ReceivedDatagramPtr> datagrams_;
+};
+
 class IoUringClientSocket : public IoUringServerSocket {
 public:
   IoUringClientSocket(os_fd_t fd, IoUringWorkerImpl& parent, Event::FileReadyCb cb,
@@ -55,6 +55,11 @@ void ActiveStreamListenerBase::newConnection(Network::ConnectionSocketPtr&& sock
   if (timeout.count() > 0) {
     server_conn_ptr->setBufferHighWatermarkTimeout(timeout);
   }
+  if (const auto shed_timeout = config_->perConnectionIdleMemoryShedTimeout();
+      shed_timeout.count() > 0) {
+    server_conn_ptr->setIdleMemoryShedTimeout(shed_timeout, stats_.downstream_cx_idle_memory_shed_,
+                                              stats_.downstream_cx_idle_memory_shed_bytes_);
+  }
   RELEASE_ASSERT(server_conn_ptr->connectionInfoProvider().remoteAddress() != nullptr, "");
   const bool empty_filter_chain = !config_->filterChainFactory().createNetworkFilterChain(
       *server_conn_ptr, filter_chain->networkFilterFactories());
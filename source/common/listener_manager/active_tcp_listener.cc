@@ -9,9 +9,35 @@
 #include "source/common/network/connection_impl.h"
 #include "source/common/network/utility.h"
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 namespace Envoy {
 namespace Server {
 
+namespace {
+
+// Returns whether the socket was received on a different CPU than the calling thread runs on.
+bool receivedOnOtherCpu(Network::ConnectionSocket& socket) {
+#if defined(__linux__)
+  const Network::SocketOptionName& name = ENVOY_SOCKET_SO_INCOMING_CPU;
+  int incoming_cpu = -1;
+  socklen_t len = sizeof(incoming_cpu);
+  if (!name.hasValue() ||
+      socket.getSocketOption(name.level(), name.option(), &incoming_cpu, &len).return_value_ != 0 ||
+      incoming_cpu < 0) {
+    return false;
+  }
+  return incoming_cpu != sched_getcpu();
+#else
+  UNREFERENCED_PARAMETER(socket);
+  return false;
+#endif
+}
+
+} // namespace
+
 ActiveTcpListener::ActiveTcpListener(Network::TcpConnectionHandler& parent,
                                      Network::ListenerConfig& config, Runtime::Loader& runtime,
                                      Random::RandomGenerator& random,
@@ -125,6 +151,12 @@ void ActiveTcpListener::onAcceptWorker(Network::ConnectionSocketPtr&& socket,
     }
   }
 
+  const Network::ListenerInfoConstSharedPtr& listener_info = config_->listenerInfo();
+  if (listener_info != nullptr && listener_info->trackIncomingCpu() &&
+      receivedOnOtherCpu(*socket)) {
+    stats_.downstream_cx_non_local_cpu_.inc();
+  }
+
   auto active_socket = std::make_unique<ActiveTcpSocket>(
       *this, std::move(socket), hand_off_restored_destination_connections, network_namespace);
 
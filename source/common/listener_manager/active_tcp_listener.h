@@ -93,8 +93,9 @@ public:
 
   Network::TcpConnectionHandler& tcp_conn_handler_;
   // The number of connections currently active on this listener. This is typically used for
-  // connection balancing across per-handler listeners.
-  std::atomic<uint64_t> num_listener_connections_{0};
+  // connection balancing across per-handler listeners. It is read and incremented by the connection
+  // balancer from other workers, so it has a cache line of its own.
+  alignas(64) std::atomic<uint64_t> num_listener_connections_{0};
 
   Network::ConnectionBalancer& connection_balancer_;
   // This is the address this listener is listening on. It's used to get the correct listener
@@ -25,6 +25,7 @@
 #include "source/common/listener_manager/filter_chain_manager_impl.h"
 #include "source/common/listener_manager/listener_manager_impl.h"
 #include "source/common/network/connection_balancer_impl.h"
+#include "source/common/network/incoming_cpu_steering_option_impl.h"
 #include "source/common/network/resolver_impl.h"
 #include "source/common/network/socket_option_factory.h"
 #include "source/common/network/socket_option_impl.h"
@@ -226,7 +227,9 @@ absl::Status ListenSocketFactoryImpl::doFinalPreWorkerInit() {
     }
     return absl::OkStatus();
   };
-  // On all platforms we should listen on the first socket.
+  // On all platforms we should listen on the first socket. With reuse_port, the kernel numbers the
+  // sockets of the group in the order they start listening, and incoming CPU steering relies on
+  // that order being the worker order, so the sockets must be listened on in the order of sockets_.
   auto iterator = sockets_.begin();
   RETURN_IF_NOT_OK(listen_and_apply_options(*iterator, tcp_backlog_size_));
   ++iterator;
@@ -343,6 +346,8 @@ ListenerImpl::ListenerImpl(const envoy::config::listener::v3::Listener& config,
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
       per_connection_buffer_high_watermark_timeout_(std::chrono::milliseconds(
           PROTOBUF_GET_MS_OR_DEFAULT(config, per_connection_buffer_high_watermark_timeout, 0))),
+      per_connection_idle_memory_shed_timeout_(std::chrono::milliseconds(
+          PROTOBUF_GET_MS_OR_DEFAULT(config, per_connection_idle_memory_shed_timeout, 0))),
       listener_tag_(parent_.factory_->nextListenerTag()), name_(name),
       added_via_api_(added_via_api), workers_started_(workers_started), maybe_stale_hash_(hash),
       tcp_backlog_size_(
@@ -355,6 +360,7 @@ ListenerImpl::ListenerImpl(const envoy::config::listener::v3::Listener& config,
                          : parent_.server_.messageValidationContext().staticValidationVisitor()),
       ignore_global_conn_limit_(config.ignore_global_conn_limit()),
       bypass_overload_manager_(config.bypass_overload_manager()),
+      steer_incoming_cpu_(config.incoming_cpu().steer_connections()),
       listener_init_target_(fmt::format("Listener-init-target {}", name),
                             [this]() { dynamic_init_manager_->initialize(local_init_watcher_); }),
       dynamic_init_manager_(std::make_unique<Init::ManagerImpl>(
@@ -510,6 +516,8 @@ ListenerImpl::ListenerImpl(ListenerImpl& origin,
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
       per_connection_buffer_high_watermark_timeout_(std::chrono::milliseconds(
           PROTOBUF_GET_MS_OR_DEFAULT(config, per_connection_buffer_high_watermark_timeout, 0))),
+      per_connection_idle_memory_shed_timeout_(std::chrono::milliseconds(
+          PROTOBUF_GET_MS_OR_DEFAULT(config, per_connection_idle_memory_shed_timeout, 0))),
       listener_tag_(origin.listener_tag_), name_(name), added_via_api_(added_via_api),
       workers_started_(workers_started), maybe_stale_hash_(hash),
       tcp_backlog_size_(
@@ -522,6 +530,7 @@ ListenerImpl::ListenerImpl(ListenerImpl& origin,
                          : parent_.server_.messageValidationContext().staticValidationVisitor()),
       ignore_global_conn_limit_(config.ignore_global_conn_limit()),
       bypass_overload_manager_(config.bypass_overload_manager()),
+      steer_incoming_cpu_(config.incoming_cpu().steer_connections()),
       // listener_init_target_ is not used during in place update because we expect server started.
       listener_init_target_("", nullptr),
       dynamic_init_manager_(std::make_unique<Init::ManagerImpl>(
@@ -598,6 +607,26 @@ absl::Status ListenerImpl::validateConfig() {
           name_));
     }
   }
+  if (steer_incoming_cpu_) {
+    if (socket_type_ != Network::Socket::Type::Stream || !reuse_port_) {
+      return absl::InvalidArgumentError(fmt::format(
+          "listener {}: incoming_cpu.steer_connections requires a TCP listener with reuse_port",
+          name_));
+    }
+    if (parent_.server_.options().workerCpus().empty()) {
+      return absl::InvalidArgumentError(fmt::format(
+          "listener {}: incoming_cpu.steer_connections requires --worker-cpus", name_));
+    }
+    if (!ENVOY_ATTACH_REUSEPORT_CBPF.hasValue()) {
+      return absl::InvalidArgumentError(fmt::format(
+          "listener {}: incoming_cpu.steer_connections is not supported on this platform", name_));
+    }
+  }
+  if (listener_factory_context_->listenerInfo().trackIncomingCpu() &&
+      !ENVOY_SOCKET_SO_INCOMING_CPU.hasValue()) {
+    return absl::InvalidArgumentError(fmt::format(
+        "listener {}: incoming_cpu.track_non_local is not supported on this platform", name_));
+  }
   return absl::OkStatus();
 }
 
@@ -765,6 +794,16 @@ void ListenerImpl::buildListenSocketOptions(
       addListenSocketOptions(listen_socket_options_list_[i],
                              Network::SocketOptionFactory::buildReusePortOptions());
     }
+    if (steer_incoming_cpu_) {
+      // The program indexes the reuse port group by worker, so it needs one socket per pinned
+      // worker. See IncomingCpuSteeringOptionImpl for how the sockets are kept in worker order.
+      ASSERT(parent_.server_.options().workerCpus().size() ==
+             parent_.server_.options().concurrency());
+      addListenSocketOptions(listen_socket_options_list_[i],
+                             std::make_shared<Network::Socket::Options>(
+                                 1, std::make_shared<Network::IncomingCpuSteeringOptionImpl>(
+                                        parent_.server_.options().workerCpus())));
+    }
     if (!address_opts_list[i]->empty()) {
       addListenSocketOptions(listen_socket_options_list_[i], address_opts_list[i]);
     }
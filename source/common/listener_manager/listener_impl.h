@@ -300,6 +300,9 @@ public:
   std::chrono::milliseconds perConnectionBufferHighWatermarkTimeout() const override {
     return per_connection_buffer_high_watermark_timeout_;
   }
+  std::chrono::milliseconds perConnectionIdleMemoryShedTimeout() const override {
+    return per_connection_idle_memory_shed_timeout_;
+  }
   std::chrono::milliseconds listenerFiltersTimeout() const override {
     return listener_filters_timeout_;
   }
@@ -448,6 +451,7 @@ private:
   const bool hand_off_restored_destination_connections_;
   const uint32_t per_connection_buffer_limit_bytes_;
   const std::chrono::milliseconds per_connection_buffer_high_watermark_timeout_;
+  const std::chrono::milliseconds per_connection_idle_memory_shed_timeout_;
   const uint64_t listener_tag_;
   const std::string name_;
   const bool added_via_api_;
@@ -462,6 +466,7 @@ private:
   ProtobufMessage::ValidationVisitor& validation_visitor_;
   const bool ignore_global_conn_limit_;
   const bool bypass_overload_manager_;
+  const bool steer_incoming_cpu_;
 
   // A target is added to Server's InitManager if workers_started_ is false.
   Init::TargetImpl listener_init_target_;
@@ -16,7 +16,8 @@ public:
   explicit ListenerInfoImpl(const envoy::config::listener::v3::Listener& config)
       : metadata_(config.metadata()), direction_(config.traffic_direction()),
         is_quic_(config.udp_listener_config().has_quic_options()),
-        bypass_overload_manager_(config.bypass_overload_manager()) {}
+        bypass_overload_manager_(config.bypass_overload_manager()),
+        track_incoming_cpu_(config.incoming_cpu().track_non_local()) {}
   ListenerInfoImpl() = default;
 
   // Network::ListenerInfo
@@ -25,12 +26,14 @@ public:
   envoy::config::core::v3::TrafficDirection direction() const override { return direction_; }
   bool shouldBypassOverloadManager() const override { return bypass_overload_manager_; };
   bool isQuic() const override { return is_quic_; }
+  bool trackIncomingCpu() const override { return track_incoming_cpu_; }
 
 private:
   const ListenerMetadataPack metadata_;
   const envoy::config::core::v3::TrafficDirection direction_{};
   const bool is_quic_{};
   const bool bypass_overload_manager_{};
+  const bool track_incoming_cpu_{};
 };
 
 } // namespace Server
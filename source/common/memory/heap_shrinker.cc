@@ -1,5 +1,6 @@
 #include "source/common/memory/heap_shrinker.h"
 
+#include "source/common/buffer/slice_storage_pool.h"
 #include "source/common/memory/utils.h"
 #include "source/common/protobuf/utility.h"
 #include "source/common/stats/symbol_table.h"
@@ -46,6 +47,8 @@ HeapShrinker::HeapShrinker(Event::Dispatcher& dispatcher, Server::OverloadManage
 
 void HeapShrinker::shrinkHeap() {
   if (active_) {
+    // Free pooled buffer slices first so that the allocator can return them too.
+    Buffer::SliceStoragePool::releaseFreeMemory();
     Utils::releaseFreeMemory(max_unfreed_memory_bytes_);
     shrink_counter_->inc();
   }
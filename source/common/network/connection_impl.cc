@@ -138,6 +138,10 @@ void ConnectionImpl::removeReadFilter(ReadFilterSharedPtr filter) {
   filter_manager_.removeReadFilter(filter);
 }
 
+bool ConnectionImpl::isSoleFilter(const ReadFilter& filter) const {
+  return filter_manager_.isSoleFilter(filter);
+}
+
 bool ConnectionImpl::initializeReadFilters() { return filter_manager_.initializeReadFilters(); }
 
 void ConnectionImpl::addAccessLogHandler(AccessLog::InstanceSharedPtr handler) {
@@ -354,6 +358,7 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
     delayed_close_timer_->disableTimer();
     delayed_close_timer_ = nullptr;
   }
+  idle_memory_shed_timer_.reset();
 
   ENVOY_CONN_LOG(debug, "closing socket: {}", *this, static_cast<uint32_t>(close_type));
   const bool abort_reset = detected_close_type_ == StreamInfo::DetectedCloseType::RemoteReset ||
@@ -720,6 +725,15 @@ void ConnectionImpl::onFileEvent(uint32_t events) {
   ScopeTrackerScopeState scope(this, this->dispatcher_);
   ENVOY_CONN_LOG(trace, "socket event: {}", *this, events);
 
+  if (idle_memory_shed_timer_ != nullptr) {
+    // Rather than re-arming the timer on every event, the time of the last event is checked when
+    // the timer fires.
+    last_socket_event_time_ = dispatcher_.approximateMonotonicTime();
+    if (!idle_memory_shed_timer_->enabled()) {
+      idle_memory_shed_timer_->enableTimer(idle_memory_shed_timeout_);
+    }
+  }
+
   if (immediate_error_event_ == ConnectionEvent::LocalClose ||
       immediate_error_event_ == ConnectionEvent::RemoteClose) {
     if (bind_error_) {
@@ -1058,6 +1072,24 @@ void ServerConnectionImpl::setTransportSocketConnectTimeout(std::chrono::millise
   transport_socket_connect_timer_->enableTimer(timeout);
 }
 
+void ServerConnectionImpl::setIdleMemoryShedTimeout(std::chrono::milliseconds timeout,
+                                                    Stats::Counter& shed_stat,
+                                                    Stats::Counter& shed_bytes_stat) {
+  if (timeout == std::chrono::milliseconds::zero()) {
+    idle_memory_shed_timer_.reset();
+    return;
+  }
+
+  idle_memory_shed_timeout_ = timeout;
+  idle_memory_shed_stat_ = &shed_stat;
+  idle_memory_shed_bytes_stat_ = &shed_bytes_stat;
+  last_socket_event_time_ = dispatcher_.approximateMonotonicTime();
+  if (idle_memory_shed_timer_ == nullptr) {
+    idle_memory_shed_timer_ = dispatcher_.createTimer([this] { onIdleMemoryShedTimeout(); });
+  }
+  idle_memory_shed_timer_->enableTimer(timeout);
+}
+
 void ServerConnectionImpl::raiseEvent(ConnectionEvent event) {
   switch (event) {
   case ConnectionEvent::ConnectedZeroRtt:
@@ -1091,6 +1123,25 @@ void ServerConnectionImpl::onTransportSocketConnectTimeout() {
   setFailureReason("connect timeout");
 }
 
+void ServerConnectionImpl::onIdleMemoryShedTimeout() {
+  const auto idle_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+      dispatcher_.approximateMonotonicTime() - last_socket_event_time_);
+  if (idle_time < idle_memory_shed_timeout_) {
+    idle_memory_shed_timer_->enableTimer(idle_memory_shed_timeout_ - idle_time);
+    return;
+  }
+
+  // The timer is left disabled until the next socket event, so that a connection that stays idle
+  // is not woken up again.
+  const uint64_t released = read_buffer_->shrinkToFit() + write_buffer_->shrinkToFit();
+  ENVOY_CONN_LOG(debug, "idle for {}ms, released {} bytes of buffer memory", *this,
+                 idle_time.count(), released);
+  if (released > 0) {
+    idle_memory_shed_stat_->inc();
+    idle_memory_shed_bytes_stat_->add(released);
+  }
+}
+
 ClientConnectionImpl::ClientConnectionImpl(
     Event::Dispatcher& dispatcher, const Address::InstanceConstSharedPtr& remote_address,
     const Network::Address::InstanceConstSharedPtr& source_address,
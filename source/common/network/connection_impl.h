@@ -60,6 +60,7 @@ public:
   void addFilter(FilterSharedPtr filter) override;
   void addReadFilter(ReadFilterSharedPtr filter) override;
   void removeReadFilter(ReadFilterSharedPtr filter) override;
+  bool isSoleFilter(const ReadFilter& filter) const override;
   bool initializeReadFilters() override;
   void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) override;
 
@@ -96,6 +97,7 @@ public:
     // SSL info may be overwritten by a filter in the provider.
     return socket_->connectionInfoProvider().sslConnection();
   }
+  bool hasPassthroughTransport() const override { return transport_socket_->isPassthrough(); }
   State state() const override;
   bool connecting() const override {
     ENVOY_CONN_LOG_EVENT(debug, "connection_connecting_state", "current connecting state: {}",
@@ -224,6 +226,11 @@ protected:
   bool connecting_{false};
   ConnectionEvent immediate_error_event_{ConnectionEvent::Connected};
   bool bind_error_{false};
+  // Enabled by ServerConnectionImpl::setIdleMemoryShedTimeout(). Once it fires, it is re-armed by
+  // the next socket event.
+  Event::TimerPtr idle_memory_shed_timer_;
+  std::chrono::milliseconds idle_memory_shed_timeout_{};
+  MonotonicTime last_socket_event_time_;
 
 private:
   friend class MultiConnectionBaseImpl;
@@ -288,6 +295,8 @@ public:
   // ServerConnection impl
   void setTransportSocketConnectTimeout(std::chrono::milliseconds timeout,
                                         Stats::Counter& timeout_stat) override;
+  void setIdleMemoryShedTimeout(std::chrono::milliseconds timeout, Stats::Counter& shed_stat,
+                                Stats::Counter& shed_bytes_stat) override;
   void raiseEvent(ConnectionEvent event) override;
   bool initializeReadFilters() override;
 
@@ -303,12 +312,15 @@ public:
 
 private:
   void onTransportSocketConnectTimeout();
+  void onIdleMemoryShedTimeout();
 
   bool transport_connect_pending_{true};
   // Implements a timeout for the transport socket signaling connection. The timer is enabled by a
   // call to setTransportSocketConnectTimeout and is reset when the connection is established.
   Event::TimerPtr transport_socket_connect_timer_;
   Stats::Counter* transport_socket_timeout_stat_;
+  Stats::Counter* idle_memory_shed_stat_{};
+  Stats::Counter* idle_memory_shed_bytes_stat_{};
 };
 
 /**
@@ -38,6 +38,14 @@ void ConnectionImplBase::setConnectionStats(const ConnectionStats& stats) {
   connection_stats_ = std::make_unique<ConnectionStats>(stats);
 }
 
+void ConnectionImplBase::addDirectSocketBytes(uint64_t bytes_read, uint64_t bytes_written) {
+  if (connection_stats_ == nullptr) {
+    return;
+  }
+  connection_stats_->read_total_.add(bytes_read);
+  connection_stats_->write_total_.add(bytes_written);
+}
+
 void ConnectionImplBase::setDelayedCloseTimeout(std::chrono::milliseconds timeout) {
   // Validate that this is only called prior to issuing a close() or closeSocket().
   ASSERT(delayed_close_timer_ == nullptr && state() == State::Open);
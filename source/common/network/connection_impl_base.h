@@ -32,6 +32,7 @@ public:
   uint64_t id() const override { return id_; }
   void hashKey(std::vector<uint8_t>& hash) const override;
   void setConnectionStats(const ConnectionStats& stats) override;
+  void addDirectSocketBytes(uint64_t bytes_read, uint64_t bytes_written) override;
   void setDelayedCloseTimeout(std::chrono::milliseconds timeout) override;
 
   // ScopeTrackedObject
@@ -38,6 +38,11 @@ void FilterManagerImpl::removeReadFilter(ReadFilterSharedPtr filter_to_remove) {
   }
 }
 
+bool FilterManagerImpl::isSoleFilter(const ReadFilter& filter) const {
+  return downstream_filters_.empty() && upstream_filters_.size() == 1 &&
+         upstream_filters_.front()->filter_.get() == &filter;
+}
+
 bool FilterManagerImpl::initializeReadFilters() {
   if (upstream_filters_.empty()) {
     return false;
@@ -128,6 +128,7 @@ public:
   void addReadFilter(ReadFilterSharedPtr filter);
   void removeReadFilter(ReadFilterSharedPtr filter);
   bool initializeReadFilters();
+  bool isSoleFilter(const ReadFilter& filter) const;
   void onRead();
   FilterStatus onWrite();
   bool startUpstreamSecureTransport();
@@ -0,0 +1,85 @@
+#include "source/common/network/incoming_cpu_steering_option_impl.h"
+
+#include "source/common/common/scalar_to_byte_vector.h"
+#include "source/common/common/utility.h"
+#include "source/common/network/socket_option_impl.h"
+
+#include "absl/strings/str_join.h"
+
+namespace Envoy {
+namespace Network {
+
+IncomingCpuSteeringOptionImpl::IncomingCpuSteeringOptionImpl(
+    const std::vector<uint32_t>& worker_cpus)
+    : worker_cpus_(worker_cpus) {
+  ASSERT(!worker_cpus_.empty());
+#if defined(SO_ATTACH_REUSEPORT_CBPF) && defined(__linux__)
+  // Loads the receiving CPU and compares it against each worker's CPU in turn, returning the index
+  // of the first match. The out of range index returned when nothing matches makes the kernel fall
+  // back to hashing.
+  filter_.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, SKF_AD_OFF + SKF_AD_CPU));
+  for (uint32_t i = 0; i < worker_cpus_.size(); ++i) {
+    filter_.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, worker_cpus_[i], 0, 1));
+    filter_.push_back(BPF_STMT(BPF_RET | BPF_K, i));
+  }
+  filter_.push_back(BPF_STMT(BPF_RET | BPF_K, 0xffffffff));
+#endif
+}
+
+bool IncomingCpuSteeringOptionImpl::setOption(
+    Socket& socket, envoy::config::core::v3::SocketOption::SocketState state) const {
+  if (state != in_state_) {
+    return true;
+  }
+#if defined(SO_ATTACH_REUSEPORT_CBPF) && defined(__linux__)
+  // The program only needs to outlive the call: the kernel copies it.
+  sock_fprog prog;
+  prog.len = filter_.size();
+  prog.filter = const_cast<sock_filter*>(filter_.data());
+  const Api::SysCallIntResult result = SocketOptionImpl::setSocketOption(
+      socket, ENVOY_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog));
+  if (result.return_value_ != 0) {
+    ENVOY_LOG(warn, "Attaching the incoming CPU steering program to socket failed: {}",
+              errorDetails(result.errno_));
+    return false;
+  }
+  return true;
+#else
+  UNREFERENCED_PARAMETER(socket);
+  ENVOY_LOG(warn, "Incoming CPU steering is not supported on this platform");
+  return false;
+#endif
+}
+
+void IncomingCpuSteeringOptionImpl::hashKey(std::vector<uint8_t>& hash_key) const {
+  const Network::SocketOptionName& name = ENVOY_ATTACH_REUSEPORT_CBPF;
+  if (name.hasValue()) {
+    pushScalarToByteVector(name.level(), hash_key);
+    pushScalarToByteVector(name.option(), hash_key);
+  }
+  for (const uint32_t cpu : worker_cpus_) {
+    pushScalarToByteVector(cpu, hash_key);
+  }
+}
+
+absl::optional<Socket::Option::Details> IncomingCpuSteeringOptionImpl::getOptionDetails(
+    const Socket&, envoy::config::core::v3::SocketOption::SocketState state) const {
+  if (state != in_state_ || !isSupported()) {
+    return absl::nullopt;
+  }
+  Socket::Option::Details info;
+  info.name_ = ENVOY_ATTACH_REUSEPORT_CBPF;
+  info.value_ = absl::StrJoin(worker_cpus_, ",");
+  return absl::make_optional(std::move(info));
+}
+
+bool IncomingCpuSteeringOptionImpl::isSupported() const {
+#if defined(__linux__)
+  return ENVOY_ATTACH_REUSEPORT_CBPF.hasValue();
+#else
+  return false;
+#endif
+}
+
+} // namespace Network
+} // namespace Envoy
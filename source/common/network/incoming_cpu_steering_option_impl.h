@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "envoy/common/platform.h"
+#include "envoy/config/core/v3/base.pb.h"
+#include "envoy/network/listen_socket.h"
+
+#include "source/common/common/logger.h"
+
+#if defined(__linux__)
+#include <linux/filter.h>
+#endif
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Attaches a reuse port BPF program to a listen socket that hands each new connection to the
+ * socket of the worker pinned to the CPU that received it. Connections received on a CPU that no
+ * worker is pinned to fall back to the kernel's hash based selection.
+ *
+ * The program returns an index into the kernel's reuse port group, which numbers the sockets in
+ * the order they started listening, while worker i is pinned to worker_cpus[i]. The mapping is
+ * therefore only correct if the socket of worker i is the i-th to join the group, which holds as:
+ * - ListenSocketFactoryImpl::doFinalPreWorkerInit() listens on the sockets in worker order.
+ * - Listener updates and draining listeners duplicate the sockets rather than opening new ones.
+ * - A hot restarted child inherits the socket of each worker from the same worker of its parent.
+ * It does not hold if another process listens on the address with SO_REUSEPORT, or if the parent
+ * of a hot restart ran with a different --worker-cpus.
+ */
+class IncomingCpuSteeringOptionImpl : public Socket::Option,
+                                      Logger::Loggable<Logger::Id::connection> {
+public:
+  explicit IncomingCpuSteeringOptionImpl(const std::vector<uint32_t>& worker_cpus);
+
+  // Socket::Option
+  bool setOption(Socket& socket,
+                 envoy::config::core::v3::SocketOption::SocketState state) const override;
+  void hashKey(std::vector<uint8_t>& hash_key) const override;
+  absl::optional<Details>
+  getOptionDetails(const Socket& socket,
+                   envoy::config::core::v3::SocketOption::SocketState state) const override;
+  bool isSupported() const override;
+
+private:
+  static constexpr envoy::config::core::v3::SocketOption::SocketState in_state_ =
+      envoy::config::core::v3::SocketOption::STATE_BOUND;
+  const std::vector<uint32_t> worker_cpus_;
+#if defined(SO_ATTACH_REUSEPORT_CBPF) && defined(__linux__)
+  std::vector<sock_filter> filter_;
+#endif
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -1,11 +1,13 @@
 #include "source/common/network/io_socket_handle_impl.h"
 
+#include <atomic>
 #include <memory>
 
 #include "envoy/buffer/buffer.h"
 
 #include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/macros.h"
 #include "source/common/common/safe_memcpy.h"
 #include "source/common/common/utility.h"
 #include "source/common/event/file_event_impl.h"
@@ -15,6 +17,17 @@
 #include "absl/container/fixed_array.h"
 #include "absl/types/optional.h"
 
+#if defined(__linux__)
+#include <linux/errqueue.h>
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#endif
+
 using Envoy::Api::SysCallIntResult;
 using Envoy::Api::SysCallSizeResult;
 
@@ -49,6 +62,9 @@ constexpr int messageTruncatedOption() {
 #endif
 }
 
+std::atomic<uint64_t> zero_copy_send_threshold{
+    Network::IoSocketHandleImpl::DefaultZeroCopySendThreshold};
+
 } // namespace
 
 namespace Network {
@@ -63,8 +79,20 @@ Api::IoCallUint64Result IoSocketHandleImpl::close() {
   if (file_event_) {
     file_event_.reset();
   }
-
   ASSERT(SOCKET_VALID(fd_));
+#if defined(__linux__)
+  if (zero_copy_ != nullptr) {
+    processZeroCopyCompletions();
+    if (!zero_copy_->pending_.empty()) {
+      // The kernel may still be sending from the slices of the pending sends, and completions can
+      // only be read from an open socket, so both are handed over until the sends complete.
+      ZeroCopyLinger::start(fd_, std::move(zero_copy_));
+      SET_SOCKET_INVALID(fd_);
+      return {0, Api::IoError::none()};
+    }
+    zero_copy_.reset();
+  }
+#endif
   const int rc = Api::OsSysCallsSingleton::get().close(fd_).return_value_;
   SET_SOCKET_INVALID(fd_);
   return {static_cast<unsigned long>(rc), Api::IoError::none()};
@@ -98,6 +126,10 @@ Api::IoCallUint64Result IoSocketHandleImpl::readv(uint64_t max_length, Buffer::R
 Api::IoCallUint64Result IoSocketHandleImpl::read(Buffer::Instance& buffer,
                                                  absl::optional<uint64_t> max_length_opt) {
   const uint64_t max_length = max_length_opt.value_or(UINT64_MAX);
+  if (zero_copy_ != nullptr && !zero_copy_->pending_.empty()) {
+    // Completions are reported as socket errors which wake up the read side.
+    processZeroCopyCompletions();
+  }
   if (max_length == 0) {
     return Api::ioCallUint64ResultNoError();
   }
@@ -139,6 +171,12 @@ Api::IoCallUint64Result IoSocketHandleImpl::writev(const Buffer::RawSlice* slice
 Api::IoCallUint64Result IoSocketHandleImpl::write(Buffer::Instance& buffer) {
   constexpr uint64_t MaxSlices = 16;
   Buffer::RawSliceVector slices = buffer.getRawSlices(MaxSlices);
+  if (zero_copy_ != nullptr) {
+    absl::optional<Api::IoCallUint64Result> zero_copy_result = maybeWriteZeroCopy(buffer, slices);
+    if (zero_copy_result.has_value()) {
+      return std::move(zero_copy_result.value());
+    }
+  }
   Api::IoCallUint64Result result = writev(slices.begin(), slices.size());
   if (result.ok() && result.return_value_ > 0) {
     buffer.drain(static_cast<uint64_t>(result.return_value_));
@@ -146,6 +184,206 @@ Api::IoCallUint64Result IoSocketHandleImpl::write(Buffer::Instance& buffer) {
   return result;
 }
 
+absl::optional<Api::IoCallUint64Result>
+IoSocketHandleImpl::maybeWriteZeroCopy(Buffer::Instance& buffer,
+                                       const Buffer::RawSliceVector& slices) {
+#if defined(__linux__)
+  if (!zero_copy_->pending_.empty()) {
+    processZeroCopyCompletions();
+  }
+  // The sent slices have to be taken out of the buffer without copying them.
+  auto* owned_buffer = dynamic_cast<Buffer::OwnedImpl*>(&buffer);
+  if (!zero_copy_->enabled_ || zero_copy_->reap_timer_ == nullptr || owned_buffer == nullptr) {
+    return absl::nullopt;
+  }
+  absl::FixedArray<iovec> iov(slices.size());
+  uint64_t num_slices_to_write = 0;
+  uint64_t num_bytes_to_write = 0;
+  for (const Buffer::RawSlice& slice : slices) {
+    if (slice.mem_ != nullptr && slice.len_ != 0) {
+      iov[num_slices_to_write].iov_base = slice.mem_;
+      iov[num_slices_to_write].iov_len = slice.len_;
+      num_slices_to_write++;
+      num_bytes_to_write += slice.len_;
+    }
+  }
+  if (num_bytes_to_write < zero_copy_->threshold_) {
+    return absl::nullopt;
+  }
+
+  msghdr message{};
+  message.msg_iov = iov.begin();
+  message.msg_iovlen = num_slices_to_write;
+  const Api::SysCallSizeResult result =
+      Api::OsSysCallsSingleton::get().sendmsg(fd_, &message, MSG_ZEROCOPY);
+  if (result.return_value_ < 0 && result.errno_ == ENOBUFS) {
+    // The socket is out of option memory to track more completions, fall back to copying.
+    return absl::nullopt;
+  }
+  if (result.return_value_ > 0) {
+    // The kernel assigns consecutive ids to successful zero copy sends.
+    Buffer::SliceDeque sent_slices;
+    owned_buffer->extractSlices(result.return_value_, sent_slices);
+    zero_copy_->pending_.emplace_back(zero_copy_->next_id_++, std::move(sent_slices));
+    if (!zero_copy_->reap_timer_->enabled()) {
+      zero_copy_->reap_timer_->enableTimer(ZeroCopyReapInterval);
+    }
+  }
+  return sysCallResultToIoCallResult(result);
+#else
+  UNREFERENCED_PARAMETER(buffer);
+  UNREFERENCED_PARAMETER(slices);
+  return absl::nullopt;
+#endif
+}
+
+void IoSocketHandleImpl::ZeroCopyState::reapCompletions(os_fd_t fd) {
+#if defined(__linux__)
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  while (!pending_.empty()) {
+    const size_t pending_before = pending_.size();
+    // Reads from the error queue never block.
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(sock_extended_err)) +
+                                  CMSG_SPACE(sizeof(sockaddr_in6))];
+    msghdr message{};
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    if (os_sys_calls.recvmsg(fd, &message, MSG_ERRQUEUE).return_value_ < 0) {
+      return;
+    }
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&message, cmsg)) {
+      if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+      sock_extended_err error;
+      safeMemcpyUnsafeSrc(&error, CMSG_DATA(cmsg));
+      if (error.ee_origin != SO_EE_ORIGIN_ZEROCOPY || error.ee_errno != 0) {
+        continue;
+      }
+      if (error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+        // The kernel had to copy the data, e.g. because the route does not support scatter-gather.
+        // Further zero copy sends on this socket would only add overhead.
+        enabled_ = false;
+      }
+      // The notification covers the inclusive id range [ee_info, ee_data]. TCP completes sends
+      // in order, so the range always starts at the oldest pending send.
+      const uint32_t first = error.ee_info;
+      const uint32_t last = error.ee_data;
+      while (!pending_.empty() && static_cast<int32_t>(pending_.front().id_ - first) >= 0 &&
+             static_cast<int32_t>(last - pending_.front().id_) >= 0) {
+        pending_.pop_front();
+      }
+    }
+    if (pending_.size() == pending_before) {
+      // The error queue held something other than a zero copy completion.
+      return;
+    }
+  }
+#else
+  UNREFERENCED_PARAMETER(fd);
+#endif
+}
+
+#if defined(__linux__)
+class IoSocketHandleImpl::ZeroCopyLinger : public Event::DeferredDeletable {
+public:
+  // Takes over the socket and deletes itself through the dispatcher of the state once the sends
+  // have completed. If the dispatcher exits before that, the slices are leaked rather than freed
+  // while the kernel may still reference them.
+  static void start(os_fd_t fd, std::unique_ptr<ZeroCopyState> state) {
+    new ZeroCopyLinger(fd, std::move(state));
+  }
+
+private:
+  ZeroCopyLinger(os_fd_t fd, std::unique_ptr<ZeroCopyState> state)
+      : fd_(fd), state_(std::move(state)) {
+    auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+    struct linger linger_option {};
+    socklen_t option_length = sizeof(linger_option);
+    if (os_sys_calls.getsockopt(fd_, SOL_SOCKET, SO_LINGER, &linger_option, &option_length)
+                .return_value_ == 0 &&
+        linger_option.l_onoff != 0 && linger_option.l_linger == 0) {
+      // An abortive close resets the connection right away and purges the send queue, so only the
+      // data already handed to the device can still be referenced. Its completions are lost with
+      // the socket, the slices are released after a grace period instead.
+      os_sys_calls.close(fd_);
+      SET_SOCKET_INVALID(fd_);
+    } else {
+      // Lets the peer see the close while the sends drain.
+      os_sys_calls.shutdown(fd_, ENVOY_SHUT_RDWR);
+    }
+    state_->reap_timer_ = state_->dispatcher_->createTimer([this]() { onTimer(); });
+    state_->reap_timer_->enableTimer(SOCKET_VALID(fd_) ? ZeroCopyReapInterval
+                                                       : ZeroCopyAbortiveCloseGracePeriod);
+  }
+
+  void onTimer() {
+    if (SOCKET_VALID(fd_)) {
+      state_->reapCompletions(fd_);
+      if (!state_->pending_.empty()) {
+        state_->reap_timer_->enableTimer(ZeroCopyReapInterval);
+        return;
+      }
+      Api::OsSysCallsSingleton::get().close(fd_);
+    }
+    state_->dispatcher_->deferredDelete(Event::DeferredDeletablePtr{this});
+  }
+
+  static constexpr std::chrono::milliseconds ZeroCopyAbortiveCloseGracePeriod{1000};
+
+  os_fd_t fd_;
+  std::unique_ptr<ZeroCopyState> state_;
+};
+#endif
+
+void IoSocketHandleImpl::onZeroCopyReapTimer() {
+  processZeroCopyCompletions();
+  if (zero_copy_ != nullptr && !zero_copy_->pending_.empty()) {
+    zero_copy_->reap_timer_->enableTimer(ZeroCopyReapInterval);
+  }
+}
+
+Api::SysCallIntResult IoSocketHandleImpl::setOption(int level, int optname, const void* optval,
+                                                    socklen_t optlen) {
+  const Api::SysCallIntResult result =
+      IoSocketHandleBaseImpl::setOption(level, optname, optval, optlen);
+#if defined(__linux__)
+  if (result.return_value_ == 0 && level == SOL_SOCKET && optname == SO_ZEROCOPY &&
+      optlen == sizeof(int)) {
+    int enabled;
+    safeMemcpyUnsafeSrc(&enabled, optval);
+    zero_copy_option_ = enabled != 0;
+    if (zero_copy_ == nullptr) {
+      if (zero_copy_option_) {
+        zero_copy_ = std::make_unique<ZeroCopyState>(zeroCopySendThreshold());
+      }
+    } else if (zero_copy_option_) {
+      zero_copy_->enabled_ = true;
+    } else {
+      // Sends made before the option was turned off still complete through the error queue, so
+      // the state is only dropped once none are pending. Until then the reap timer and the IO on
+      // the socket keep reaping them.
+      zero_copy_->enabled_ = false;
+      processZeroCopyCompletions();
+      if (zero_copy_->pending_.empty()) {
+        zero_copy_.reset();
+      }
+    }
+  }
+#endif
+  return result;
+}
+
+void IoSocketHandleImpl::setZeroCopySendThreshold(uint64_t threshold) {
+  zero_copy_send_threshold.store(threshold, std::memory_order_relaxed);
+}
+
+uint64_t IoSocketHandleImpl::zeroCopySendThreshold() {
+  return zero_copy_send_threshold.load(std::memory_order_relaxed);
+}
+
 Api::IoCallUint64Result IoSocketHandleImpl::sendmsg(const Buffer::RawSlice* slices,
                                                     uint64_t num_slice, int flags,
                                                     const Address::Ip* self_ip,
@@ -230,6 +468,34 @@ Api::IoCallUint64Result IoSocketHandleImpl::sendmsg(const Buffer::RawSlice* slic
   }
 }
 
+Api::IoCallUint64Result IoSocketHandleImpl::sendmmsg(absl::Span<const Buffer::RawSlice> datagrams,
+                                                     const Address::Instance& peer_address) {
+  auto& os_syscalls = Api::OsSysCallsSingleton::get();
+  if (datagrams.empty() || !os_syscalls.supportsMmsg()) {
+    return IoHandle::sendmmsg(datagrams, peer_address);
+  }
+  const auto* address_base = dynamic_cast<const Address::InstanceBase*>(&peer_address);
+  sockaddr* sock_addr = const_cast<sockaddr*>(address_base->sockAddr());
+  if (sock_addr == nullptr) {
+    // Unlikely to happen unless the wrong peer address is passed.
+    return IoSocketError::ioResultSocketInvalidAddress();
+  }
+  absl::FixedArray<iovec> iovs(datagrams.size());
+  absl::FixedArray<mmsghdr> messages(datagrams.size());
+  for (size_t i = 0; i < datagrams.size(); i++) {
+    iovs[i].iov_base = datagrams[i].mem_;
+    iovs[i].iov_len = datagrams[i].len_;
+    messages[i] = {};
+    messages[i].msg_hdr.msg_name = reinterpret_cast<void*>(sock_addr);
+    messages[i].msg_hdr.msg_namelen = address_base->sockAddrLen();
+    messages[i].msg_hdr.msg_iov = &iovs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+  const Api::SysCallIntResult result = os_syscalls.sendmmsg(
+      fd_, messages.begin(), static_cast<unsigned int>(datagrams.size()), 0);
+  return sysCallResultToIoCallResult(result);
+}
+
 Address::InstanceConstSharedPtr
 IoSocketHandleImpl::getOrCreateEnvoyAddressInstance(sockaddr_storage ss, socklen_t ss_len) {
   if (!recent_received_addresses_) {
@@ -365,6 +631,14 @@ Api::IoCallUint64Result IoSocketHandleImpl::recvmsg(Buffer::RawSlice* slices,
   if (result.return_value_ < 0) {
     return sysCallResultToIoCallResult(result);
   }
+  return processReceivedMessage(hdr, result, self_port, save_cmsg_config, output);
+}
+
+Api::IoCallUint64Result
+IoSocketHandleImpl::processReceivedMessage(msghdr& hdr, Api::SysCallSizeResult result,
+                                           uint32_t self_port,
+                                           const UdpSaveCmsgConfig& save_cmsg_config,
+                                           RecvMsgOutput& output) {
   if ((hdr.msg_flags & MSG_TRUNC) != 0) {
     ENVOY_LOG_MISC(debug, "Dropping truncated UDP packet with size: {}.", result.return_value_);
     result.return_value_ = 0;
@@ -377,7 +651,8 @@ Api::IoCallUint64Result IoSocketHandleImpl::recvmsg(Buffer::RawSlice* slices,
                  fmt::format("Incorrectly set control message length: {}", hdr.msg_controllen));
   RELEASE_ASSERT(hdr.msg_namelen > 0,
                  fmt::format("Unable to get remote address from recvmsg() for fd: {}", fd_));
-  output.msg_[0].peer_address_ = getOrCreateEnvoyAddressInstance(peer_addr, hdr.msg_namelen);
+  output.msg_[0].peer_address_ = getOrCreateEnvoyAddressInstance(
+      *static_cast<sockaddr_storage*>(hdr.msg_name), hdr.msg_namelen);
   output.msg_[0].gso_size_ = 0;
 
   if (hdr.msg_controllen > 0) {
@@ -549,8 +824,16 @@ IoHandlePtr IoSocketHandleImpl::accept(struct sockaddr* addr, socklen_t* addrlen
   if (SOCKET_INVALID(result.return_value_)) {
     return nullptr;
   }
-  return SocketInterfaceImpl::makePlatformSpecificSocket(result.return_value_, socket_v6only_,
-                                                         domain_, {});
+  IoHandlePtr accepted = SocketInterfaceImpl::makePlatformSpecificSocket(
+      result.return_value_, socket_v6only_, domain_, {});
+#if defined(__linux__)
+  if (zero_copy_option_) {
+    // Zero copy mode configured on a listener applies to the connections it accepts.
+    const int enable = 1;
+    accepted->setOption(SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable));
+  }
+#endif
+  return accepted;
 }
 
 Api::SysCallIntResult IoSocketHandleImpl::connect(Address::InstanceConstSharedPtr address) {
@@ -592,14 +875,36 @@ IoHandlePtr IoSocketHandleImpl::duplicate() {
   RELEASE_ASSERT(result.return_value_ != -1,
                  fmt::format("duplicate failed for '{}': ({}) {}", fd_, result.errno_,
                              errorDetails(result.errno_)));
-  return SocketInterfaceImpl::makePlatformSpecificSocket(result.return_value_, socket_v6only_,
-                                                         domain_, {false, addressCacheMaxSize()});
+  IoHandlePtr duplicate = SocketInterfaceImpl::makePlatformSpecificSocket(
+      result.return_value_, socket_v6only_, domain_, {false, addressCacheMaxSize()});
+#if defined(__linux__)
+  auto* duplicate_handle = dynamic_cast<IoSocketHandleImpl*>(duplicate.get());
+  if (duplicate_handle != nullptr) {
+    // The duplicate shares the socket and with it the error queue the completions of all its zero
+    // copy sends arrive in, so only this handle sends with MSG_ZEROCOPY and the duplicate copies.
+    // Connections accepted through the duplicate are still put in zero copy mode.
+    duplicate_handle->zero_copy_option_ = zero_copy_option_;
+  }
+#endif
+  return duplicate;
 }
 
 void IoSocketHandleImpl::initializeFileEvent(Event::Dispatcher& dispatcher, Event::FileReadyCb cb,
                                              Event::FileTriggerType trigger, uint32_t events) {
   ASSERT(file_event_ == nullptr, "Attempting to initialize two `file_event_` for the same "
                                  "file descriptor. This is not allowed.");
+  if (zero_copy_ != nullptr) {
+    // The kernel signals completions in the error queue with EPOLLERR, which is delivered as a
+    // read or write event, so reap them on any event before the owner handles it.
+    zero_copy_->dispatcher_ = &dispatcher;
+    zero_copy_->reap_timer_ = dispatcher.createTimer([this]() { onZeroCopyReapTimer(); });
+    cb = [this, cb = std::move(cb)](uint32_t events) {
+      if (zero_copy_ != nullptr && !zero_copy_->pending_.empty()) {
+        processZeroCopyCompletions();
+      }
+      return cb(events);
+    };
+  }
   file_event_ = dispatcher.createFileEvent(fd_, cb, trigger, events);
 }
 
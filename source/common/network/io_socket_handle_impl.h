@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <vector>
 
@@ -9,6 +11,7 @@
 #include "envoy/event/dispatcher.h"
 #include "envoy/network/io_handle.h"
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/logger.h"
 #include "source/common/network/io_socket_error_impl.h"
 #include "source/common/network/io_socket_handle_base_impl.h"
@@ -54,6 +57,9 @@ public:
                                   const Address::Ip* self_ip,
                                   const Address::Instance& peer_address) override;
 
+  Api::IoCallUint64Result sendmmsg(absl::Span<const Buffer::RawSlice> datagrams,
+                                   const Address::Instance& peer_address) override;
+
   Api::IoCallUint64Result recvmsg(Buffer::RawSlice* slices, const uint64_t num_slice,
                                   uint32_t self_port, const UdpSaveCmsgConfig& save_cmsg_config,
                                   RecvMsgOutput& output) override;
@@ -79,6 +85,29 @@ public:
 
   Api::SysCallIntResult shutdown(int how) override;
 
+  // Intercepts SO_ZEROCOPY to switch large writes to MSG_ZEROCOPY sends.
+  Api::SysCallIntResult setOption(int level, int optname, const void* optval,
+                                  socklen_t optlen) override;
+
+  /**
+   * Sets the minimum number of bytes a write must carry to be sent with MSG_ZEROCOPY on sockets
+   * that have SO_ZEROCOPY enabled. Applies to sockets created after the call.
+   */
+  static void setZeroCopySendThreshold(uint64_t threshold);
+  static uint64_t zeroCopySendThreshold();
+
+  // Default value of zeroCopySendThreshold(). Below this size the page pinning and completion
+  // handling of MSG_ZEROCOPY costs more than the copy it saves.
+  static constexpr uint64_t DefaultZeroCopySendThreshold = 16 * 1024;
+  // How often the completions of pending MSG_ZEROCOPY sends are reaped when there is no other IO
+  // on the socket.
+  static constexpr std::chrono::milliseconds ZeroCopyReapInterval{10};
+
+  // Number of MSG_ZEROCOPY sends whose memory is still referenced by the kernel.
+  size_t pendingZeroCopySends() const {
+    return zero_copy_ != nullptr ? zero_copy_->pending_.size() : 0;
+  }
+
 protected:
   // Converts a SysCallSizeResult to IoCallUint64Result.
   template <typename T>
@@ -107,6 +136,12 @@ protected:
 
   size_t addressCacheMaxSize() const { return address_cache_max_capacity_; }
 
+  // Fills the output of recvmsg() from a received message, whose name is a sockaddr_storage.
+  Api::IoCallUint64Result processReceivedMessage(msghdr& hdr, Api::SysCallSizeResult result,
+                                                 uint32_t self_port,
+                                                 const UdpSaveCmsgConfig& save_cmsg_config,
+                                                 RecvMsgOutput& output);
+
 private:
   // Returns the destination address if the control message carries it.
   // Otherwise returns nullptr.
@@ -116,6 +151,49 @@ private:
   Address::InstanceConstSharedPtr getOrCreateEnvoyAddressInstance(sockaddr_storage ss,
                                                                   socklen_t ss_len);
 
+  // Sends the slices with MSG_ZEROCOPY if the socket is in zero copy mode and the write is large
+  // enough. Returns absl::nullopt if the regular copying write should be used instead.
+  absl::optional<Api::IoCallUint64Result> maybeWriteZeroCopy(Buffer::Instance& buffer,
+                                                             const Buffer::RawSliceVector& slices);
+  // Releases the slices of the zero copy sends the kernel reported as complete.
+  void processZeroCopyCompletions() { zero_copy_->reapCompletions(fd_); }
+
+  struct PendingZeroCopySend {
+    PendingZeroCopySend(uint32_t id, Buffer::SliceDeque&& slices)
+        : id_(id), slices_(std::move(slices)) {}
+
+    // Sequence number the kernel assigned to the send.
+    uint32_t id_;
+    // Keeps the sent memory alive until the kernel reports completion.
+    Buffer::SliceDeque slices_;
+  };
+
+  struct ZeroCopyState {
+    explicit ZeroCopyState(uint64_t threshold) : threshold_(threshold) {}
+
+    // Reads the completion notifications of MSG_ZEROCOPY sends from the error queue of the socket
+    // and releases the slices the kernel no longer references.
+    void reapCompletions(os_fd_t fd);
+
+    const uint64_t threshold_;
+    // Cleared once the kernel reports that it had to copy the data anyway, e.g. on loopback, and
+    // when SO_ZEROCOPY is turned off while sends are still pending.
+    bool enabled_{true};
+    uint32_t next_id_{0};
+    std::deque<PendingZeroCopySend> pending_;
+    // Reaps completions while sends are pending, as the socket may see no further IO that would.
+    // Zero copy sends are only made once the file event was initialized, which creates the timer,
+    // as the dispatcher is also needed to keep pending sends alive past close().
+    Event::Dispatcher* dispatcher_{nullptr};
+    Event::TimerPtr reap_timer_;
+  };
+
+  // Keeps the socket of a closed handle open until its pending sends have completed.
+  class ZeroCopyLinger;
+
+  // Reaps completions and re-arms reap_timer_ as long as sends are pending.
+  void onZeroCopyReapTimer();
+
   // Caches the address instances of the most recently received packets on this socket.
   // Should only be used by QUIC client sockets to avoid creating multiple address instances for
   // the same address in each read operation. Since the QUIC client sockets are connected via a
@@ -124,6 +202,13 @@ private:
   size_t address_cache_max_capacity_;
   // Only non-null if address_cache_max_capacity_ is greater than 0.
   absl::optional<std::vector<QuicEnvoyAddressPair>> recent_received_addresses_ = absl::nullopt;
+  // Whether SO_ZEROCOPY was enabled through this handle. Duplicates inherit it so that the
+  // connections they accept are in zero copy mode as well.
+  bool zero_copy_option_{false};
+  // Only non-null once SO_ZEROCOPY has been enabled on the socket, and kept after it is turned off
+  // until the pending sends have completed. Duplicates do not get one, as the completions of all
+  // sends on the socket arrive in the one error queue it shares with them.
+  std::unique_ptr<ZeroCopyState> zero_copy_;
 
   // For testing and benchmarking non-public methods.
   friend class IoSocketHandleImplTestWrapper;
@@ -40,7 +40,6 @@ IoUringSocketHandleImpl::~IoUringSocketHandleImpl() {
   // TODO(zhxie): for current usage of server socket and client socket, the check may be
   // redundant.
   if (io_uring_socket_type_ != IoUringSocketType::Unknown &&
-      io_uring_socket_type_ != IoUringSocketType::Accept &&
       io_uring_worker_factory_.currentThreadRegistered() && io_uring_socket_.has_value()) {
     if (io_uring_socket_->getStatus() != Io::IoUringSocketStatus::Closed) {
       io_uring_socket_.ref().close(false);
@@ -57,8 +56,7 @@ Api::IoCallUint64Result IoUringSocketHandleImpl::close() {
 
   ASSERT(SOCKET_VALID(fd_));
 
-  if (io_uring_socket_type_ == IoUringSocketType::Unknown ||
-      io_uring_socket_type_ == IoUringSocketType::Accept || !io_uring_socket_.has_value()) {
+  if (io_uring_socket_type_ == IoUringSocketType::Unknown || !io_uring_socket_.has_value()) {
     if (file_event_) {
       file_event_.reset();
     }
@@ -186,6 +184,19 @@ IoHandlePtr IoUringSocketHandleImpl::accept(struct sockaddr* addr, socklen_t* ad
 
   ASSERT(io_uring_socket_type_ == IoUringSocketType::Accept);
 
+  if (io_uring_socket_.has_value()) {
+    const os_fd_t fd = io_uring_socket_->nextAcceptedSocket();
+    if (SOCKET_INVALID(fd)) {
+      return nullptr;
+    }
+    // The multishot accept can't return remote addresses, get it from the accepted socket.
+    if (addr != nullptr) {
+      Api::OsSysCallsSingleton::get().getpeername(fd, addr, addrlen);
+    }
+    return std::make_unique<IoUringSocketHandleImpl>(io_uring_worker_factory_, fd, socket_v6only_,
+                                                     domain_, true);
+  }
+
   Envoy::Api::SysCallSocketResult result =
       Api::OsSysCallsSingleton::get().accept(fd_, addr, addrlen);
   if (SOCKET_INVALID(result.return_value_)) {
@@ -277,6 +288,15 @@ void IoUringSocketHandleImpl::initializeFileEvent(Event::Dispatcher& dispatcher,
 
   switch (io_uring_socket_type_) {
   case IoUringSocketType::Accept:
+    // A single accept request per connection is no better than epoll, listeners only accept
+    // through io_uring with multishot accept.
+    if (io_uring_worker_factory_.getIoUringWorker()->hasProvidedBuffers()) {
+      io_uring_socket_ = io_uring_worker_factory_.getIoUringWorker()->addAcceptSocket(fd_, cb);
+      if (!(events & Event::FileReadyType::Read)) {
+        io_uring_socket_->disableRead();
+      }
+      break;
+    }
     file_event_ = dispatcher.createFileEvent(fd_, cb, trigger, events);
     break;
   case IoUringSocketType::Server:
@@ -297,6 +317,12 @@ void IoUringSocketHandleImpl::activateFileEvents(uint32_t events) {
             ioUringSocketTypeStr());
 
   if (io_uring_socket_type_ == IoUringSocketType::Accept) {
+    if (io_uring_socket_.has_value()) {
+      if (events & Event::FileReadyType::Read) {
+        io_uring_socket_->injectCompletion(Io::Request::RequestType::Accept);
+      }
+      return;
+    }
     ASSERT(file_event_ != nullptr);
     file_event_->activate(events);
     return;
@@ -315,6 +341,14 @@ void IoUringSocketHandleImpl::enableFileEvents(uint32_t events) {
             ioUringSocketTypeStr());
 
   if (io_uring_socket_type_ == IoUringSocketType::Accept) {
+    if (io_uring_socket_.has_value()) {
+      if (events & Event::FileReadyType::Read) {
+        io_uring_socket_->enableRead();
+      } else {
+        io_uring_socket_->disableRead();
+      }
+      return;
+    }
     ASSERT(file_event_ != nullptr);
     file_event_->setEnabled(events);
     return;
@@ -332,6 +366,11 @@ void IoUringSocketHandleImpl::resetFileEvents() {
   ENVOY_LOG(trace, "reset file events, fd = {}, type = {}", fd_, ioUringSocketTypeStr());
 
   if (io_uring_socket_type_ == IoUringSocketType::Accept) {
+    // The listen socket stays open, but sockets accepted and not taken yet are closed.
+    if (io_uring_socket_.has_value()) {
+      io_uring_socket_->close(true);
+      io_uring_socket_.reset();
+    }
     file_event_.reset();
     return;
   }
@@ -419,5 +458,152 @@ Api::IoCallUint64Result IoUringSocketHandleImpl::copyOut(uint64_t max_length,
   return {num_bytes_to_read, IoSocketError::none()};
 }
 
+IoUringDatagramSocketHandleImpl::IoUringDatagramSocketHandleImpl(
+    Io::IoUringWorkerFactory& io_uring_worker_factory, os_fd_t fd, bool socket_v6only,
+    absl::optional<int> domain, size_t address_cache_max_capacity)
+    : IoSocketHandleImpl(fd, socket_v6only, domain, address_cache_max_capacity),
+      io_uring_worker_factory_(io_uring_worker_factory) {
+  ENVOY_LOG(trace, "construct io uring datagram socket handle, fd = {}", fd_);
+}
+
+IoUringDatagramSocketHandleImpl::~IoUringDatagramSocketHandleImpl() {
+  // The base destructor closes the socket with a syscall otherwise.
+  if (SOCKET_VALID(fd_) && io_uring_socket_.has_value() &&
+      io_uring_worker_factory_.currentThreadRegistered()) {
+    if (io_uring_socket_->getStatus() != Io::IoUringSocketStatus::Closed) {
+      io_uring_socket_->close(false);
+    }
+    SET_SOCKET_INVALID(fd_);
+  }
+}
+
+Api::IoCallUint64Result IoUringDatagramSocketHandleImpl::close() {
+  ENVOY_LOG(trace, "close datagram socket, fd = {}", fd_);
+
+  if (!io_uring_socket_.has_value()) {
+    return IoSocketHandleImpl::close();
+  }
+  ASSERT(SOCKET_VALID(fd_));
+  io_uring_socket_->close(false);
+  io_uring_socket_.reset();
+  SET_SOCKET_INVALID(fd_);
+  return Api::ioCallUint64ResultNoError();
+}
+
+Api::IoCallUint64Result IoUringDatagramSocketHandleImpl::recvmsg(
+    Buffer::RawSlice* slices, const uint64_t num_slice, uint32_t self_port,
+    const UdpSaveCmsgConfig& save_cmsg_config, RecvMsgOutput& output) {
+  if (!io_uring_socket_.has_value()) {
+    return IoSocketHandleImpl::recvmsg(slices, num_slice, self_port, save_cmsg_config, output);
+  }
+  ASSERT(!output.msg_.empty());
+
+  Io::ReceivedDatagramPtr datagram = io_uring_socket_->nextReceivedDatagram();
+  if (datagram == nullptr) {
+    return {0, IoSocketError::getIoSocketEagainError()};
+  }
+
+  uint64_t copied = 0;
+  for (uint64_t i = 0; i < num_slice && copied < datagram->payload_.size(); i++) {
+    const uint64_t length = std::min<uint64_t>(slices[i].len_, datagram->payload_.size() - copied);
+    memcpy(slices[i].mem_, datagram->payload_.data() + copied, length); // NOLINT(safe-memcpy)
+    copied += length;
+  }
+
+  // Rebuild the received message, so that it is handled as if it came from recvmsg().
+  msghdr hdr{};
+  hdr.msg_name = &datagram->peer_address_;
+  hdr.msg_namelen = datagram->peer_address_len_;
+  hdr.msg_control = datagram->control_.data();
+  hdr.msg_controllen = datagram->control_.size();
+  hdr.msg_flags = datagram->flags_;
+  if (copied < datagram->payload_.size()) {
+    hdr.msg_flags |= MSG_TRUNC;
+  }
+  return processReceivedMessage(hdr, Api::SysCallSizeResult{static_cast<ssize_t>(copied), 0},
+                                self_port, save_cmsg_config, output);
+}
+
+bool IoUringDatagramSocketHandleImpl::supportsMmsg() const {
+  // Datagrams received through io_uring are taken one at a time.
+  return !io_uring_socket_.has_value() && IoSocketHandleImpl::supportsMmsg();
+}
+
+bool IoUringDatagramSocketHandleImpl::supportsUdpGro() const {
+  return !io_uring_socket_.has_value() && IoSocketHandleImpl::supportsUdpGro();
+}
+
+IoHandlePtr IoUringDatagramSocketHandleImpl::duplicate() {
+  ENVOY_LOG(trace, "duplicate datagram socket, fd = {}", fd_);
+
+  Api::SysCallSocketResult result = Api::OsSysCallsSingleton::get().duplicate(fd_);
+  RELEASE_ASSERT(result.return_value_ != -1,
+                 fmt::format("duplicate failed for '{}': ({}) {}", fd_, result.errno_,
+                             errorDetails(result.errno_)));
+  return std::make_unique<IoUringDatagramSocketHandleImpl>(io_uring_worker_factory_,
+                                                           result.return_value_, socket_v6only_,
+                                                           domain_, addressCacheMaxSize());
+}
+
+void IoUringDatagramSocketHandleImpl::initializeFileEvent(Event::Dispatcher& dispatcher,
+                                                          Event::FileReadyCb cb,
+                                                          Event::FileTriggerType trigger,
+                                                          uint32_t events) {
+  ASSERT(!io_uring_socket_.has_value());
+  if (!io_uring_worker_factory_.currentThreadRegistered() ||
+      io_uring_worker_factory_.getIoUringWorker() == absl::nullopt) {
+    IoSocketHandleImpl::initializeFileEvent(dispatcher, std::move(cb), trigger, events);
+    return;
+  }
+
+  ENVOY_LOG(trace, "initialize datagram file event, fd = {}", fd_);
+#ifdef UDP_GRO
+  // GRO would coalesce the datagrams which are taken one at a time.
+  int gro = 0;
+  Api::OsSysCallsSingleton::get().setsockopt(fd_, IPPROTO_UDP, UDP_GRO, &gro, sizeof(gro));
+#endif
+  io_uring_socket_ = io_uring_worker_factory_.getIoUringWorker()->addDatagramSocket(fd_, cb);
+  enableFileEvents(events);
+}
+
+void IoUringDatagramSocketHandleImpl::activateFileEvents(uint32_t events) {
+  if (!io_uring_socket_.has_value()) {
+    IoSocketHandleImpl::activateFileEvents(events);
+    return;
+  }
+  if (events & Event::FileReadyType::Read) {
+    io_uring_socket_->injectCompletion(Io::Request::RequestType::Read);
+  }
+  if (events & Event::FileReadyType::Write) {
+    io_uring_socket_->injectCompletion(Io::Request::RequestType::Write);
+  }
+}
+
+void IoUringDatagramSocketHandleImpl::enableFileEvents(uint32_t events) {
+  if (!io_uring_socket_.has_value()) {
+    IoSocketHandleImpl::enableFileEvents(events);
+    return;
+  }
+  if (events & Event::FileReadyType::Read) {
+    io_uring_socket_->enableRead();
+  } else {
+    io_uring_socket_->disableRead();
+  }
+  // Sends are syscalls on the non blocking socket. As an edge triggered event would, the write
+  // event fires once when enabled.
+  if (events & Event::FileReadyType::Write) {
+    io_uring_socket_->injectCompletion(Io::Request::RequestType::Write);
+  }
+}
+
+void IoUringDatagramSocketHandleImpl::resetFileEvents() {
+  if (!io_uring_socket_.has_value()) {
+    IoSocketHandleImpl::resetFileEvents();
+    return;
+  }
+  io_uring_socket_->close(true);
+  io_uring_socket_.reset();
+}
+
 } // namespace Network
 } // namespace Envoy
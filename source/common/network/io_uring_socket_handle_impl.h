@@ -7,6 +7,7 @@
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/logger.h"
 #include "source/common/network/io_socket_handle_base_impl.h"
+#include "source/common/network/io_socket_handle_impl.h"
 
 namespace Envoy {
 
@@ -93,5 +94,37 @@ protected:
                                   uint64_t num_slice);
 };
 
+/**
+ * IoHandle derivative for UDP sockets, which receives datagrams through io_uring with multishot
+ * recvmsg. Datagrams are sent with the syscalls of IoSocketHandleImpl, so the socket stays non
+ * blocking. A handle initialized on a thread without io_uring worker behaves as
+ * IoSocketHandleImpl.
+ */
+class IoUringDatagramSocketHandleImpl : public IoSocketHandleImpl {
+public:
+  IoUringDatagramSocketHandleImpl(Io::IoUringWorkerFactory& io_uring_worker_factory,
+                                  os_fd_t fd = INVALID_SOCKET, bool socket_v6only = false,
+                                  absl::optional<int> domain = absl::nullopt,
+                                  size_t address_cache_max_capacity = 0);
+  ~IoUringDatagramSocketHandleImpl() override;
+
+  Api::IoCallUint64Result close() override;
+  Api::IoCallUint64Result recvmsg(Buffer::RawSlice* slices, const uint64_t num_slice,
+                                  uint32_t self_port, const UdpSaveCmsgConfig& save_cmsg_config,
+                                  RecvMsgOutput& output) override;
+  bool supportsMmsg() const override;
+  bool supportsUdpGro() const override;
+  IoHandlePtr duplicate() override;
+  void initializeFileEvent(Event::Dispatcher& dispatcher, Event::FileReadyCb cb,
+                           Event::FileTriggerType trigger, uint32_t events) override;
+  void activateFileEvents(uint32_t events) override;
+  void enableFileEvents(uint32_t events) override;
+  void resetFileEvents() override;
+
+private:
+  Io::IoUringWorkerFactory& io_uring_worker_factory_;
+  OptRef<Io::IoUringSocket> io_uring_socket_{absl::nullopt};
+};
+
 } // namespace Network
 } // namespace Envoy
@@ -83,6 +83,12 @@ bool MultiConnectionBaseImpl::initializeReadFilters() {
   return true;
 }
 
+bool MultiConnectionBaseImpl::isSoleFilter(const ReadFilter& filter) const {
+  // Until the final connection has been determined the filters are not installed on any
+  // connection yet.
+  return connect_finished_ && connections_[0]->isSoleFilter(filter);
+}
+
 void MultiConnectionBaseImpl::addAccessLogHandler(AccessLog::InstanceSharedPtr handler) {
   if (connect_finished_) {
     connections_[0]->addAccessLogHandler(handler);
@@ -207,6 +213,10 @@ Ssl::ConnectionInfoConstSharedPtr MultiConnectionBaseImpl::ssl() const {
   return connections_[0]->ssl();
 }
 
+bool MultiConnectionBaseImpl::hasPassthroughTransport() const {
+  return connections_[0]->hasPassthroughTransport();
+}
+
 Connection::State MultiConnectionBaseImpl::state() const {
   if (!connect_finished_) {
     ASSERT(connections_[0]->state() == Connection::State::Open);
@@ -407,6 +417,13 @@ void MultiConnectionBaseImpl::hashKey(std::vector<uint8_t>& hash_key) const {
   }
 }
 
+void MultiConnectionBaseImpl::addDirectSocketBytes(uint64_t bytes_read, uint64_t bytes_written) {
+  // Bytes can only be moved on the socket of the final connection.
+  if (connect_finished_) {
+    connections_[0]->addDirectSocketBytes(bytes_read, bytes_written);
+  }
+}
+
 void MultiConnectionBaseImpl::setConnectionStats(const ConnectionStats& stats) {
   if (!connect_finished_) {
     per_connection_state_.connection_stats_ = std::make_unique<ConnectionStats>(stats);
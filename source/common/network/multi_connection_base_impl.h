@@ -81,6 +81,7 @@ public:
   void addReadFilter(ReadFilterSharedPtr filter) override;
   void removeReadFilter(ReadFilterSharedPtr filter) override;
   bool initializeReadFilters() override;
+  bool isSoleFilter(const ReadFilter& filter) const override;
   void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) override;
   void addBytesSentCallback(BytesSentCb cb) override;
   void write(Buffer::Instance& data, bool end_stream) override;
@@ -93,6 +94,7 @@ public:
   ReadDisableStatus readDisable(bool disable) override;
   void detectEarlyCloseWhenReadDisabled(bool value) override;
   void setConnectionStats(const ConnectionStats& stats) override;
+  void addDirectSocketBytes(uint64_t bytes_read, uint64_t bytes_written) override;
   void setDelayedCloseTimeout(std::chrono::milliseconds timeout) override;
   void setBufferLimits(uint32_t limit) override;
   void setBufferHighWatermarkTimeout(std::chrono::milliseconds timeout) override;
@@ -115,6 +117,8 @@ public:
   absl::optional<UnixDomainSocketPeerCredentials> unixSocketPeerCredentials() const override;
   // Note, this might change before connect finishes.
   Ssl::ConnectionInfoConstSharedPtr ssl() const override;
+  // Note, this might change before connect finishes.
+  bool hasPassthroughTransport() const override;
   State state() const override;
   bool connecting() const override;
   uint32_t bufferLimit() const override;
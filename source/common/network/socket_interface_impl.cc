@@ -11,6 +11,8 @@
 #include "source/common/network/io_socket_handle_impl.h"
 #include "source/common/network/win32_socket_handle_impl.h"
 
+#include "absl/numeric/bits.h"
+
 #if defined(__linux__) && !defined(__ANDROID_API__) && defined(ENVOY_ENABLE_IO_URING)
 #include "source/common/io/io_uring_impl.h"
 #include "source/common/io/io_uring_worker_factory_impl.h"
@@ -57,6 +59,18 @@ IoHandlePtr SocketInterfaceImpl::makeSocket(int socket_fd, bool socket_v6only,
                                             Socket::Type socket_type, absl::optional<int> domain,
                                             const SocketCreationOptions& options) const {
   if (socket_type == Socket::Type::Datagram) {
+#if defined(__linux__) && !defined(__ANDROID_API__) && defined(ENVOY_ENABLE_IO_URING)
+    // Datagrams are only received through io_uring with multishot recvmsg, which needs provided
+    // buffers.
+    std::shared_ptr<Io::IoUringWorkerFactory> io_uring_worker_factory =
+        io_uring_worker_factory_.lock();
+    if (hasIoUringWorkerFactory(io_uring_worker_factory.get()) &&
+        io_uring_worker_factory->getIoUringWorker()->hasProvidedBuffers()) {
+      return std::make_unique<IoUringDatagramSocketHandleImpl>(
+          *io_uring_worker_factory, socket_fd, socket_v6only, domain,
+          options.max_addresses_cache_size_);
+    }
+#endif
     return makePlatformSpecificSocket(socket_fd, socket_v6only, domain, options, nullptr);
   }
   return makePlatformSpecificSocket(socket_fd, socket_v6only, domain, options,
@@ -165,21 +179,27 @@ bool SocketInterfaceImpl::ipFamilySupported(int domain) {
 }
 
 Server::BootstrapExtensionPtr SocketInterfaceImpl::createBootstrapExtension(
-    [[maybe_unused]] const Protobuf::Message& config,
-    [[maybe_unused]] Server::Configuration::ServerFactoryContext& context) {
-#if defined(__linux__) && !defined(__ANDROID_API__) && defined(ENVOY_ENABLE_IO_URING)
+    const Protobuf::Message& config, Server::Configuration::ServerFactoryContext& context) {
   const auto& message = MessageUtil::downcastAndValidate<
       const envoy::extensions::network::socket_interface::v3::DefaultSocketInterface&>(
       config, context.messageValidationVisitor());
+  IoSocketHandleImpl::setZeroCopySendThreshold(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      message, zero_copy_send_threshold, IoSocketHandleImpl::DefaultZeroCopySendThreshold));
+#if defined(__linux__) && !defined(__ANDROID_API__) && defined(ENVOY_ENABLE_IO_URING)
   if (message.has_io_uring_options() && Io::isIoUringSupported()) {
     const auto& options = message.io_uring_options();
+    uint32_t read_buffer_ring_size =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, read_buffer_ring_size, 256);
+    if (read_buffer_ring_size > 0) {
+      read_buffer_ring_size = absl::bit_ceil(read_buffer_ring_size);
+    }
     std::shared_ptr<Io::IoUringWorkerFactoryImpl> io_uring_worker_factory =
         std::make_shared<Io::IoUringWorkerFactoryImpl>(
             PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, io_uring_size, 1000),
             options.enable_submission_queue_polling(),
             PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, read_buffer_size, 8192),
             PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, write_timeout_ms, 1000),
-            context.threadLocal());
+            context.threadLocal(), read_buffer_ring_size);
     io_uring_worker_factory_ = io_uring_worker_factory;
 
     return std::make_unique<DefaultSocketInterfaceExtension>(*this, io_uring_worker_factory);
@@ -48,6 +48,10 @@ void QuicFilterManagerConnectionImpl::removeReadFilter(Network::ReadFilterShared
   filter_manager_->removeReadFilter(filter);
 }
 
+bool QuicFilterManagerConnectionImpl::isSoleFilter(const Network::ReadFilter& filter) const {
+  return filter_manager_->isSoleFilter(filter);
+}
+
 bool QuicFilterManagerConnectionImpl::initializeReadFilters() {
   return filter_manager_->initializeReadFilters();
 }
@@ -44,6 +44,7 @@ public:
   void addFilter(Network::FilterSharedPtr filter) override;
   void addReadFilter(Network::ReadFilterSharedPtr filter) override;
   void removeReadFilter(Network::ReadFilterSharedPtr filter) override;
+  bool isSoleFilter(const Network::ReadFilter& filter) const override;
   bool initializeReadFilters() override;
   void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) override;
 
@@ -115,6 +116,7 @@ public:
     network_connection_->setConnectionStats(stats);
   }
   Ssl::ConnectionInfoConstSharedPtr ssl() const override;
+  bool hasPassthroughTransport() const override { return false; }
   Network::Connection::State state() const override {
     if (!initialized_ || (quicConnection() != nullptr && quicConnection()->connected())) {
       return Network::Connection::State::Open;
@@ -1812,9 +1812,57 @@ VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& vi
       SET_AND_RETURN_IF_NOT_OK(route_or_error.status(), creation_status);
       routes_.emplace_back(route_or_error.value());
     }
+    if (shared_virtual_host_->globalRouteConfig().enablePathIndex()) {
+      buildPathIndex();
+    }
   }
 }
 
+void VirtualHostImpl::buildPathIndex() {
+  auto path_index = std::make_unique<RoutePathIndex>();
+  for (uint32_t i = 0; i < routes_.size(); ++i) {
+    const RouteEntryImplBase& route = *routes_[i];
+    // Case insensitive matchers would need the path to be lower cased for every lookup, so they
+    // are evaluated like any other route.
+    if (!route.case_sensitive()) {
+      path_index->addUnindexed(i);
+      continue;
+    }
+    switch (route.matchType()) {
+    case PathMatchType::Exact:
+      path_index->addExact(i, route.matcher());
+      break;
+    case PathMatchType::Prefix:
+      path_index->addPrefix(i, route.matcher());
+      break;
+    default:
+      path_index->addUnindexed(i);
+      break;
+    }
+  }
+  ENVOY_LOG(debug, "indexed {} of {} routes of virtual host {} by path",
+            path_index->indexedRoutes(), routes_.size(), shared_virtual_host_->name());
+  path_index_ = std::move(path_index);
+}
+
+RouteConstSharedPtr
+VirtualHostImpl::getRouteFromPathIndex(const RouteMatchContext& route_match_context,
+                                       const StreamInfo::StreamInfo& stream_info,
+                                       uint64_t random_value) const {
+  // Path matchers ignore the query string and fragment, see Matchers::PathMatcher::match().
+  const absl::string_view path =
+      Http::PathUtil::removeQueryAndFragment(route_match_context.sanitizedPath());
+  RouteConstSharedPtr route_entry;
+  path_index_->forEachCandidate(path, [&](uint32_t position) {
+    route_entry = routes_[position]->matches(route_match_context, stream_info, random_value);
+    return route_entry == nullptr;
+  });
+  if (route_entry == nullptr) {
+    ENVOY_LOG(debug, "route was resolved but final route list did not match incoming request");
+  }
+  return route_entry;
+}
+
 RouteConstSharedPtr VirtualHostImpl::getRouteFromRoutes(
     const RouteCallback& cb, const RouteMatchContext& route_match_context,
     const StreamInfo::StreamInfo& stream_info, uint64_t random_value,
@@ -1908,31 +1956,17 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const RouteCallback& cb
     return nullptr;
   }
 
+  // The index skips routes that cannot match, which is only transparent when nobody observes the
+  // individual matches through a callback. Requests without a path have to consider the routes
+  // supporting pathless headers, which are never indexed.
+  if (path_index_ != nullptr && cb == nullptr && headers.Path() != nullptr) {
+    return getRouteFromPathIndex(route_match_context, stream_info, random_value);
+  }
+
   // Check for a route that matches the request.
   return getRouteFromRoutes(cb, route_match_context, stream_info, random_value, routes_);
 }
 
-const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(
-    absl::string_view host, const RouteMatcher::WildcardVirtualHosts& wildcard_virtual_hosts,
-    RouteMatcher::SubstringFunction substring_function) const {
-  // We do a longest wildcard match against the host that's passed in
-  // (e.g. "foo-bar.baz.com" should match "*-bar.baz.com" before matching "*.baz.com" for suffix
-  // wildcards). This is done by scanning the length => wildcards map looking for every wildcard
-  // whose size is < length.
-  for (const auto& iter : wildcard_virtual_hosts) {
-    const uint32_t wildcard_length = iter.first;
-    const auto& wildcard_map = iter.second;
-    // >= because *.foo.com shouldn't match .foo.com.
-    if (wildcard_length >= host.size()) {
-      continue;
-    }
-    const auto match = wildcard_map.find(substring_function(host, wildcard_length));
-    if (match != wildcard_map.end()) {
-      return match->second.get();
-    }
-  }
-  return nullptr;
-}
 absl::StatusOr<std::unique_ptr<RouteMatcher>>
 RouteMatcher::create(const envoy::config::route::v3::RouteConfiguration& route_config,
                      const CommonConfigSharedPtr& global_route_config,
@@ -1971,13 +2005,10 @@ RouteMatcher::RouteMatcher(const envoy::config::route::v3::RouteConfiguration& r
         }
         default_virtual_host_ = virtual_host;
       } else if (!domain.empty() && '*' == domain[0]) {
-        duplicate_found = !wildcard_virtual_host_suffixes_[domain.size() - 1]
-                               .emplace(domain.substr(1), virtual_host)
-                               .second;
+        duplicate_found = !wildcard_virtual_host_suffixes_.add(domain.substr(1), virtual_host);
       } else if (!domain.empty() && '*' == domain[domain.size() - 1]) {
-        duplicate_found = !wildcard_virtual_host_prefixes_[domain.size() - 1]
-                               .emplace(domain.substr(0, domain.size() - 1), virtual_host)
-                               .second;
+        duplicate_found =
+            !wildcard_virtual_host_prefixes_.add(domain.substr(0, domain.size() - 1), virtual_host);
       } else {
         duplicate_found = !virtual_hosts_.emplace(domain, virtual_host).second;
       }
@@ -2032,17 +2063,13 @@ const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::RequestHeaderMa
     return iter->second.get();
   }
   if (!wildcard_virtual_host_suffixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(
-        host, wildcard_virtual_host_suffixes_,
-        [](absl::string_view h, int l) -> absl::string_view { return h.substr(h.size() - l); });
+    const VirtualHostImpl* vhost = wildcard_virtual_host_suffixes_.find(host);
     if (vhost != nullptr) {
       return vhost;
     }
   }
   if (!wildcard_virtual_host_prefixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(
-        host, wildcard_virtual_host_prefixes_,
-        [](absl::string_view h, int l) -> absl::string_view { return h.substr(0, l); });
+    const VirtualHostImpl* vhost = wildcard_virtual_host_prefixes_.find(host);
     if (vhost != nullptr) {
       return vhost;
     }
@@ -2107,7 +2134,8 @@ CommonConfigImpl::CommonConfigImpl(const envoy::config::route::v3::RouteConfigur
                                           DEFAULT_MAX_DIRECT_RESPONSE_BODY_SIZE_BYTES)),
       uses_vhds_(config.has_vhds()),
       most_specific_header_mutations_wins_(config.most_specific_header_mutations_wins()),
-      ignore_path_parameters_in_path_matching_(config.ignore_path_parameters_in_path_matching()) {
+      ignore_path_parameters_in_path_matching_(config.ignore_path_parameters_in_path_matching()),
+      enable_path_index_(config.enable_path_index()) {
   if (!config.request_mirror_policies().empty()) {
     shadow_policies_.reserve(config.request_mirror_policies().size());
     for (const auto& mirror_policy_config : config.request_mirror_policies()) {
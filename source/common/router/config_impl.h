@@ -37,8 +37,10 @@
 #include "source/common/router/metadatamatchcriteria_impl.h"
 #include "source/common/router/per_filter_config.h"
 #include "source/common/router/retry_policy_impl.h"
+#include "source/common/router/route_path_index.h"
 #include "source/common/router/router_ratelimit.h"
 #include "source/common/router/tls_context_match_criteria_impl.h"
+#include "source/common/router/wildcard_domain_matcher.h"
 #include "source/common/stats/symbol_table.h"
 
 #include "absl/container/flat_hash_map.h"
@@ -480,12 +482,19 @@ public:
 private:
   enum class SslRequirements : uint8_t { None, ExternalOnly, All };
 
+  void buildPathIndex();
+  RouteConstSharedPtr getRouteFromPathIndex(const RouteMatchContext& route_match_context,
+                                            const StreamInfo::StreamInfo& stream_info,
+                                            uint64_t random_value) const;
+
   CommonVirtualHostSharedPtr shared_virtual_host_;
 
   std::shared_ptr<const SslRedirectRoute> ssl_redirect_route_;
   SslRequirements ssl_requirements_;
 
   absl::InlinedVector<RouteEntryImplBaseConstSharedPtr, 2> routes_;
+  // Only set if enable_path_index is configured.
+  std::unique_ptr<const RoutePathIndex> path_index_;
   Matcher::MatchTreeSharedPtr<Http::HttpMatchingData> matcher_;
 };
 
@@ -676,6 +685,8 @@ public:
 
   bool isRedirect() const;
 
+  bool case_sensitive() const { return case_sensitive_; }
+
   bool matchRoute(const RouteMatchContext& route_match_context,
                   const StreamInfo::StreamInfo& stream_info, uint64_t random_value) const;
   absl::Status validateClusters(const Upstream::ClusterManager& cluster_manager) const;
@@ -868,7 +879,6 @@ protected:
 
   std::unique_ptr<ConnectConfig> connect_config_;
 
-  bool case_sensitive() const { return case_sensitive_; }
   RouteConstSharedPtr clusterEntry(const Http::RequestHeaderMap& headers,
                                    const StreamInfo::StreamInfo& stream_info,
                                    uint64_t random_value) const;
@@ -1307,27 +1317,15 @@ private:
                ProtobufMessage::ValidationVisitor& validator, bool validate_clusters,
                absl::Status& creation_status);
 
-  using WildcardVirtualHosts =
-      std::map<int64_t, absl::flat_hash_map<std::string, VirtualHostImplSharedPtr>, std::greater<>>;
-  using SubstringFunction = std::function<absl::string_view(absl::string_view, int)>;
-  const VirtualHostImpl* findWildcardVirtualHost(absl::string_view host,
-                                                 const WildcardVirtualHosts& wildcard_virtual_hosts,
-                                                 SubstringFunction substring_function) const;
+  using WildcardVirtualHosts = WildcardDomainMatcher<VirtualHostImpl>;
   bool ignorePortInHostMatching() const { return ignore_port_in_host_matching_; }
 
   Stats::ScopeSharedPtr vhost_scope_;
   absl::flat_hash_map<std::string, VirtualHostImplSharedPtr> virtual_hosts_;
-  // std::greater as a minor optimization to iterate from more to less specific
-  //
-  // A note on using an unordered_map versus a vector of (string, VirtualHostImplSharedPtr) pairs:
-  //
-  // Based on local benchmarks, each vector entry costs around 20ns for recall and (string)
-  // comparison with a fixed cost of about 25ns. For unordered_map, the empty map costs about 65ns
-  // and climbs to about 110ns once there are any entries.
-  //
-  // The break-even is 4 entries.
-  WildcardVirtualHosts wildcard_virtual_host_suffixes_;
-  WildcardVirtualHosts wildcard_virtual_host_prefixes_;
+  // The longest matching wildcard wins, e.g. "foo-bar.baz.com" matches "*-bar.baz.com" before
+  // "*.baz.com". The lookup cost depends on the host length, not on the number of wildcards.
+  WildcardVirtualHosts wildcard_virtual_host_suffixes_{WildcardVirtualHosts::Type::Suffix};
+  WildcardVirtualHosts wildcard_virtual_host_prefixes_{WildcardVirtualHosts::Type::Prefix};
 
   VirtualHostImplSharedPtr default_virtual_host_;
   const bool ignore_port_in_host_matching_{false};
@@ -1382,6 +1380,7 @@ public:
   bool ignorePathParametersInPathMatching() const {
     return ignore_path_parameters_in_path_matching_;
   }
+  bool enablePathIndex() const { return enable_path_index_; }
   const envoy::config::core::v3::Metadata& metadata() const override;
   const Envoy::Config::TypedMetadata& typedMetadata() const override;
 
@@ -1404,6 +1403,7 @@ private:
   const bool uses_vhds_ : 1;
   const bool most_specific_header_mutations_wins_ : 1;
   const bool ignore_path_parameters_in_path_matching_ : 1;
+  const bool enable_path_index_ : 1;
 };
 
 /**
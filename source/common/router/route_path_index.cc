@@ -0,0 +1,26 @@
+#include "source/common/router/route_path_index.h"
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+namespace Router {
+
+void RoutePathIndex::addExact(uint32_t position, absl::string_view path) {
+  std::vector<uint32_t>& positions = exact_[path];
+  ASSERT(positions.empty() || positions.back() < position);
+  positions.push_back(position);
+  ++indexed_routes_;
+}
+
+void RoutePathIndex::addPrefix(uint32_t position, absl::string_view prefix) {
+  auto [it, inserted] = prefix_positions_.try_emplace(prefix);
+  if (inserted) {
+    prefixes_.add(prefix, &it->second);
+  }
+  ASSERT(it->second.empty() || it->second.back() < position);
+  it->second.push_back(position);
+  ++indexed_routes_;
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "source/common/common/radix_tree.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Index over the ordered route list of a virtual host that narrows down which routes can match a
+ * given path. Routes with a case sensitive exact path or prefix match are keyed by that literal,
+ * every other route is a candidate for every path. Candidates are visited in route list order, so
+ * evaluating them one by one and stopping at the first match yields the same route as walking the
+ * whole list.
+ */
+class RoutePathIndex {
+public:
+  /**
+   * Registers a route that can only match a path equal to the given one.
+   * @param position the position of the route in the route list.
+   * @param path the exact path matched by the route.
+   */
+  void addExact(uint32_t position, absl::string_view path);
+
+  /**
+   * Registers a route that can only match paths starting with the given prefix.
+   * @param position the position of the route in the route list.
+   * @param prefix the path prefix matched by the route.
+   */
+  void addPrefix(uint32_t position, absl::string_view prefix);
+
+  /**
+   * Registers a route that has to be evaluated for every path.
+   * @param position the position of the route in the route list.
+   */
+  void addUnindexed(uint32_t position) { unindexed_.push_back(position); }
+
+  /**
+   * @return the number of routes that are only evaluated for matching paths.
+   */
+  uint64_t indexedRoutes() const { return indexed_routes_; }
+
+  /**
+   * Calls cb with the position of every route that may match the given path, in ascending order,
+   * until cb returns false. Positions must have been registered in ascending order.
+   * @param path the request path, without query string and fragment.
+   * @param cb supplies the callback, returning whether to continue with the next candidate.
+   */
+  template <class Callback> void forEachCandidate(absl::string_view path, Callback cb) const {
+    absl::InlinedVector<absl::Span<const uint32_t>, 8> lists;
+    if (!unindexed_.empty()) {
+      lists.push_back(unindexed_);
+    }
+    const auto exact = exact_.find(path);
+    if (exact != exact_.end()) {
+      lists.push_back(exact->second);
+    }
+    for (const std::vector<uint32_t>* positions : prefixes_.findMatchingPrefixes(path)) {
+      lists.push_back(*positions);
+    }
+
+    // Merge the sorted candidate lists lazily, most requests stop at the first candidate or two.
+    while (true) {
+      absl::Span<const uint32_t>* next = nullptr;
+      for (absl::Span<const uint32_t>& list : lists) {
+        if (!list.empty() && (next == nullptr || list.front() < next->front())) {
+          next = &list;
+        }
+      }
+      if (next == nullptr) {
+        return;
+      }
+      const uint32_t position = next->front();
+      next->remove_prefix(1);
+      if (!cb(position)) {
+        return;
+      }
+    }
+  }
+
+private:
+  std::vector<uint32_t> unindexed_;
+  absl::flat_hash_map<std::string, std::vector<uint32_t>> exact_;
+  // The radix tree values point into prefix_positions_, whose nodes never move.
+  absl::node_hash_map<std::string, std::vector<uint32_t>> prefix_positions_;
+  RadixTree<const std::vector<uint32_t>*> prefixes_;
+  uint64_t indexed_routes_{};
+};
+
+} // namespace Router
+} // namespace Envoy
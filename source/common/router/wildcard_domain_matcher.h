@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "source/common/common/radix_tree.h"
+
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Matches hosts against a set of wildcard domains of the same kind, either suffix wildcards such
+ * as "*.example.com" or prefix wildcards such as "example.*". Wildcards are stored without the
+ * '*' in a radix tree, with suffix wildcards stored reversed, so that the longest wildcard matching
+ * a host is found in a single walk over the host no matter how many wildcards are configured. The
+ * '*' has to match at least one character, so "*.example.com" does not match ".example.com".
+ */
+template <class Value> class WildcardDomainMatcher {
+public:
+  enum class Type { Suffix, Prefix };
+
+  explicit WildcardDomainMatcher(Type type) : type_(type) {}
+
+  /**
+   * Adds a wildcard domain.
+   * @param literal the wildcard domain without the leading or trailing '*'.
+   * @param value the value returned for hosts matching the wildcard.
+   * @return false if the wildcard has already been added.
+   */
+  bool add(absl::string_view literal, std::shared_ptr<Value> value) {
+    bool added;
+    if (type_ == Type::Suffix) {
+      const std::string reversed(literal.rbegin(), literal.rend());
+      added = tree_.add(reversed, value.get(), false);
+    } else {
+      added = tree_.add(literal, value.get(), false);
+    }
+    if (added) {
+      values_.push_back(std::move(value));
+    }
+    return added;
+  }
+
+  /**
+   * @param host the lower cased host.
+   * @return the value of the longest wildcard matching the host, or nullptr if none matches.
+   */
+  const Value* find(absl::string_view host) const {
+    // The '*' matches at least one character, so the wildcard literal can span at most all but
+    // one character of the host.
+    if (host.size() < 2) {
+      return nullptr;
+    }
+    if (type_ == Type::Prefix) {
+      return tree_.findLongestPrefix(host.substr(0, host.size() - 1));
+    }
+    absl::InlinedVector<char, 128> reversed(host.rbegin(), host.rend() - 1);
+    return tree_.findLongestPrefix(absl::string_view(reversed.data(), reversed.size()));
+  }
+
+  bool empty() const { return values_.empty(); }
+
+private:
+  const Type type_;
+  RadixTree<const Value*> tree_;
+  // Keeps the values referenced by the tree alive.
+  std::vector<std::shared_ptr<Value>> values_;
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <thread>
 
 #include "envoy/stats/sink.h"
 #include "envoy/stats/stats.h"
@@ -168,6 +170,79 @@ private:
   std::atomic<uint64_t> pending_increment_{0};
 };
 
+// A counter for stats that are incremented at high rates from every worker. Each thread adds into
+// its own cache-line sized slot, so that workers do not contend on a single atomic, and the slots
+// are summed when the counter is read or latched. This costs a cache line per slot, so it is only
+// used for counters selected in the stats config.
+class ShardedCounterImpl : public StatsSharedImpl<Counter> {
+public:
+  ShardedCounterImpl(StatName name, Allocator& alloc, StatName tag_extracted_name,
+                     StatNameTagSpan stat_name_tags)
+      : StatsSharedImpl(name, alloc, tag_extracted_name, stat_name_tags),
+        slots_(new Slot[numSlots()]) {}
+
+  void removeFromSetLockHeld() ABSL_EXCLUSIVE_LOCKS_REQUIRED(alloc_.mutex_) override {
+    const size_t count = alloc_.counters_.erase(statName());
+    ASSERT(count == 1);
+    alloc_.sinked_counters_.erase(this);
+  }
+
+  // Stats::Counter
+  void add(uint64_t amount) override {
+    Slot& slot = slots_[threadSlot()];
+    slot.value_.fetch_add(amount, std::memory_order_relaxed);
+    slot.pending_increment_.fetch_add(amount, std::memory_order_relaxed);
+    // Avoid writing the shared flags once the counter is marked used, as that would bring back
+    // the contention the slots avoid.
+    if (!(flags_.load(std::memory_order_relaxed) & Flags::Used)) {
+      flags_ |= Flags::Used;
+    }
+  }
+  void inc() override { add(1); }
+  uint64_t latch() override {
+    uint64_t pending = 0;
+    for (uint32_t i = 0; i < numSlots(); i++) {
+      pending += slots_[i].pending_increment_.exchange(0);
+    }
+    return pending;
+  }
+  void reset() override {
+    for (uint32_t i = 0; i < numSlots(); i++) {
+      slots_[i].value_ = 0;
+    }
+  }
+  uint64_t value() const override {
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < numSlots(); i++) {
+      value += slots_[i].value_.load(std::memory_order_relaxed);
+    }
+    return value;
+  }
+
+private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> value_{0};
+    std::atomic<uint64_t> pending_increment_{0};
+  };
+
+  // One slot per hardware thread, which covers one per worker in the usual configuration, up to a
+  // limit that keeps the size of each counter bounded.
+  static uint32_t numSlots() {
+    static const uint32_t num_slots =
+        std::clamp<uint32_t>(std::thread::hardware_concurrency(), 1, 64);
+    return num_slots;
+  }
+
+  // Threads are assigned slots round-robin the first time they add to any sharded counter.
+  static uint32_t threadSlot() {
+    static std::atomic<uint32_t> next_slot{0};
+    thread_local const uint32_t slot = next_slot++ % numSlots();
+    return slot;
+  }
+
+  std::unique_ptr<Slot[]> slots_;
+};
+
 class GaugeImpl : public StatsSharedImpl<Gauge> {
 public:
   GaugeImpl(StatName name, Allocator& alloc, StatName tag_extracted_name,
@@ -299,7 +374,7 @@ private:
 };
 
 CounterSharedPtr Allocator::makeCounter(StatName name, StatName tag_extracted_name,
-                                        StatNameTagSpan stat_name_tags) {
+                                        StatNameTagSpan stat_name_tags, bool sharded) {
   Thread::LockGuard lock(mutex_);
   ASSERT(gauges_.find(name) == gauges_.end());
   ASSERT(text_readouts_.find(name) == text_readouts_.end());
@@ -307,7 +382,8 @@ CounterSharedPtr Allocator::makeCounter(StatName name, StatName tag_extracted_na
   if (iter != counters_.end()) {
     return {*iter};
   }
-  auto counter = CounterSharedPtr(makeCounterInternal(name, tag_extracted_name, stat_name_tags));
+  auto counter =
+      CounterSharedPtr(makeCounterInternal(name, tag_extracted_name, stat_name_tags, sharded));
   counters_.insert(counter.get());
   // Add counter to sinked_counters_ if it matches the sink predicate.
   if (sink_predicates_ != nullptr && sink_predicates_->includeCounter(*counter)) {
@@ -366,7 +442,10 @@ bool Allocator::isMutexLockedForTest() {
 }
 
 Counter* Allocator::makeCounterInternal(StatName name, StatName tag_extracted_name,
-                                        StatNameTagSpan stat_name_tags) {
+                                        StatNameTagSpan stat_name_tags, bool sharded) {
+  if (sharded) {
+    return new ShardedCounterImpl(name, *this, tag_extracted_name, stat_name_tags);
+  }
   return new CounterImpl(name, *this, tag_extracted_name, stat_name_tags);
 }
 
@@ -28,10 +28,13 @@ public:
    * @param name the full name of the stat.
    * @param tag_extracted_name the name of the stat with tag-values stripped out.
    * @param tags the tag values.
+   * @param sharded whether a newly created counter should spread its increments over per-thread
+   *        slots that are summed when read, rather than a single atomic. Ignored if the counter
+   *        already exists.
    * @return CounterSharedPtr a counter.
    */
   CounterSharedPtr makeCounter(StatName name, StatName tag_extracted_name,
-                               StatNameTagSpan stat_name_tags);
+                               StatNameTagSpan stat_name_tags, bool sharded = false);
 
   /**
    * @param name the full name of the stat.
@@ -107,11 +110,12 @@ public:
 
 protected:
   virtual Counter* makeCounterInternal(StatName name, StatName tag_extracted_name,
-                                       StatNameTagSpan stat_name_tags);
+                                       StatNameTagSpan stat_name_tags, bool sharded);
 
 private:
   template <class BaseClass> friend class StatsSharedImpl;
   friend class CounterImpl;
+  friend class ShardedCounterImpl;
   friend class GaugeImpl;
   friend class TextReadoutImpl;
 
@@ -0,0 +1,144 @@
+#include "source/common/stats/exponential_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+namespace Stats {
+namespace ExponentialHistogram {
+
+namespace {
+
+constexpr double ZeroThreshold = 0.5;
+
+// base^index, computed as 2^(index * 2^-scale) so that boundaries which are powers of two are
+// exact.
+double lowerBoundary(int32_t index, int8_t scale) {
+  return std::exp2(std::ldexp(static_cast<double>(index), -scale));
+}
+
+} // namespace
+
+double zeroThreshold(Histogram::Unit unit) {
+  return (unit == Histogram::Unit::Percent) ? (ZeroThreshold / Histogram::PercentScale)
+                                            : ZeroThreshold;
+}
+
+int32_t bucketIndex(double value, int8_t scale) {
+  ASSERT(value > 0);
+  // Bucket i covers (base^i, base^(i+1)], so value v is in bucket ceil(log_base(v)) - 1. This
+  // puts v = base^k exactly in bucket k-1, not k.
+  int32_t index = static_cast<int32_t>(std::ceil(std::ldexp(std::log2(value), scale))) - 1;
+  // Rounding in log2() can be off by one near a boundary; settle it against the boundaries.
+  if (lowerBoundary(index + 1, scale) < value) {
+    ++index;
+  } else if (lowerBoundary(index, scale) >= value) {
+    --index;
+  }
+  return index;
+}
+
+absl::optional<std::set<int32_t>> bucketIndices(const std::vector<ParentHistogram::Bucket>& buckets,
+                                                int8_t scale, double zero_threshold,
+                                                absl::optional<uint32_t> max_buckets) {
+  std::set<int32_t> indices;
+
+  const double log_base = std::log(std::pow(2.0, std::pow(2.0, static_cast<double>(-scale))));
+
+  for (const auto& bucket : buckets) {
+    ASSERT(bucket.count_ > 0, "unexpected empty bucket");
+    const double upper_bound = bucket.lower_bound_ + bucket.width_;
+    if (upper_bound <= zero_threshold) {
+      continue; // Entire bucket is in zero bucket range
+    }
+
+    ASSERT(bucket.lower_bound_ >= 0, "Envoy histograms only have unsigned integers recorded.");
+
+    // Clamp lower bound to zero_threshold to prevent log(0).
+    const double effective_lower = std::max(bucket.lower_bound_, zero_threshold);
+    // Use ceil(...) - 1 to find the bucket containing effective_lower.
+    // Bucket i covers (base^i, base^(i+1)], so value v is in bucket
+    // ceil(log(v)/log(base)) - 1. This correctly handles boundary cases where
+    // v = base^k exactly (it goes in bucket k-1, not k).
+    const int32_t lower_index =
+        static_cast<int32_t>(std::ceil(std::log(effective_lower) / log_base)) - 1;
+    const int32_t upper_index = static_cast<int32_t>(std::ceil(std::log(upper_bound) / log_base));
+
+    for (int32_t idx = lower_index; idx <= upper_index; ++idx) {
+      indices.insert(idx);
+
+      // Early termination if we've exceeded the limit
+      if (max_buckets.has_value() && indices.size() > *max_buckets) {
+        return absl::nullopt;
+      }
+    }
+  }
+
+  return indices;
+}
+
+std::pair<int8_t, std::set<int32_t>>
+chooseScale(const std::vector<ParentHistogram::Bucket>& buckets, uint32_t max_buckets,
+            double zero_threshold) {
+  for (int8_t scale = DefaultScale; scale >= MinScale; --scale) {
+    absl::optional<std::set<int32_t>> indices =
+        bucketIndices(buckets, scale, zero_threshold, max_buckets);
+    // If it doesn't have a value, that means it exceeded `max_buckets`.
+    if (indices.has_value()) {
+      return {scale, std::move(*indices)};
+    }
+  }
+  // Fallback if nothing fits - compute indices at coarsest scale without limit
+  return {MinScale, bucketIndices(buckets, MinScale, zero_threshold).value()};
+}
+
+Buckets fromDetailedBuckets(const std::vector<ParentHistogram::Bucket>& buckets,
+                            uint32_t max_buckets, double zero_threshold) {
+  Buckets result;
+
+  // Index every populated bucket once at the finest scale; coarser scales are derived from
+  // these by shifting, since bucket i at scale s lies within bucket i >> 1 at scale s - 1.
+  std::vector<std::pair<int32_t, uint64_t>> indexed;
+  indexed.reserve(buckets.size());
+  for (const auto& bucket : buckets) {
+    if (bucket.count_ == 0) {
+      continue;
+    }
+    if (bucket.lower_bound_ <= zero_threshold) {
+      result.zero_count_ += bucket.count_;
+      continue;
+    }
+    indexed.emplace_back(bucketIndex(bucket.lower_bound_, DefaultScale), bucket.count_);
+  }
+  if (indexed.empty()) {
+    return result;
+  }
+
+  const auto [min_it, max_it] =
+      std::minmax_element(indexed.begin(), indexed.end(),
+                          [](const auto& a, const auto& b) { return a.first < b.first; });
+  int32_t min_index = min_it->first;
+  int32_t max_index = max_it->first;
+  const int64_t limit = std::max<uint32_t>(max_buckets, 1);
+  int8_t scale = DefaultScale;
+  while (scale > MinScale && static_cast<int64_t>(max_index) - min_index + 1 > limit) {
+    min_index >>= 1;
+    max_index >>= 1;
+    --scale;
+  }
+
+  const int shift = DefaultScale - scale;
+  result.scale_ = scale;
+  result.offset_ = min_index;
+  result.counts_.resize(static_cast<size_t>(max_index - min_index) + 1);
+  for (const auto& [index, count] : indexed) {
+    result.counts_[(index >> shift) - min_index] += count;
+  }
+  return result;
+}
+
+} // namespace ExponentialHistogram
+} // namespace Stats
+} // namespace Envoy
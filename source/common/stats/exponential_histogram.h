@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "envoy/stats/histogram.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Stats {
+namespace ExponentialHistogram {
+
+/**
+ * Helpers for mapping Envoy's log-linear (circllhist) buckets onto exponential buckets, as used by
+ * Prometheus native histograms and OpenTelemetry exponential histograms. Both formats define
+ * bucket i as covering (base^i, base^(i+1)] with base = 2^(2^-scale); Prometheus calls the scale
+ * the "schema".
+ *
+ * circllhist has ~90 buckets per decade, which is ~27 buckets per doubling. That resolution falls
+ * between scale 4 (16 buckets/doubling) and scale 5 (32 buckets/doubling). Scales above 5 would
+ * only add artificial precision, and scale 4 is usually plenty, so it is the finest scale used.
+ */
+constexpr int8_t MinScale = -4;
+constexpr int8_t DefaultScale = 4;
+
+/**
+ * Setting the zero threshold to 0.5 ensures zeros go to the zero bucket while values >= 1 get
+ * positive bucket indices, and avoids interpolation issues at the bucket boundary that occur with
+ * 1.0. Percent histograms record values scaled by 1/PercentScale, so the threshold is scaled too.
+ * @param unit the unit of the histogram.
+ * @return the zero threshold to use for a histogram of that unit.
+ */
+double zeroThreshold(Histogram::Unit unit);
+
+/**
+ * @param value a positive value.
+ * @param scale the exponential bucket scale.
+ * @return the index of the exponential bucket (base^i, base^(i+1)] that contains the value.
+ */
+int32_t bucketIndex(double value, int8_t scale);
+
+/**
+ * For the vector of histogram buckets, return the set of all exponential bucket indices that
+ * cover any part of the range of any of the buckets.
+ *
+ * If max_buckets is provided and the limit would be exceeded, returns nullopt.
+ */
+absl::optional<std::set<int32_t>>
+bucketIndices(const std::vector<ParentHistogram::Bucket>& buckets, int8_t scale,
+              double zero_threshold, absl::optional<uint32_t> max_buckets = absl::nullopt);
+
+/**
+ * Choose the highest-resolution scale that keeps the number of covering bucket indices within
+ * max_buckets. Returns both the scale and the computed bucket indices to avoid recomputing them.
+ */
+std::pair<int8_t, std::set<int32_t>>
+chooseScale(const std::vector<ParentHistogram::Bucket>& buckets, uint32_t max_buckets,
+            double zero_threshold);
+
+/**
+ * A dense run of exponential bucket counts.
+ */
+struct Buckets {
+  int8_t scale_{DefaultScale};
+  // Number of samples at or below the zero threshold.
+  uint64_t zero_count_{};
+  // Index of the first entry in counts_.
+  int32_t offset_{};
+  std::vector<uint64_t> counts_;
+};
+
+/**
+ * Converts log-linear buckets into exponential buckets in a single pass over the buckets, without
+ * querying the histogram per exponential bucket. Each log-linear bucket is attributed as a whole
+ * to the exponential bucket containing its lower bound, which is exact for the integral values
+ * Envoy records below 100. The scale starts at DefaultScale and is reduced (halving resolution
+ * each step) until the dense run of counts spans at most max_buckets, or MinScale is reached.
+ *
+ * The input buckets may come from several histograms, so merging histograms is just a matter of
+ * concatenating their buckets.
+ * @param buckets the log-linear buckets, e.g. from ParentHistogram::detailedTotalBuckets().
+ * @param max_buckets the maximum number of dense buckets to produce.
+ * @param zero_threshold samples in buckets whose lower bound is at most this are zero_count_.
+ * @return the exponential buckets.
+ */
+Buckets fromDetailedBuckets(const std::vector<ParentHistogram::Bucket>& buckets,
+                            uint32_t max_buckets, double zero_threshold);
+
+} // namespace ExponentialHistogram
+} // namespace Stats
+} // namespace Envoy
@@ -115,7 +115,8 @@ HistogramSettingsImpl::HistogramSettingsImpl(const envoy::config::metrics::v3::S
         }
 
         return configs;
-      }()) {}
+      }()),
+      merge_threads_(config.histogram_merge_threads()) {}
 
 const ConstSupportedBuckets& HistogramSettingsImpl::buckets(absl::string_view stat_name) const {
   for (const auto& config : configs_) {
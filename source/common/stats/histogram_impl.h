@@ -26,6 +26,7 @@ public:
   // HistogramSettings
   const ConstSupportedBuckets& buckets(absl::string_view stat_name) const override;
   absl::optional<uint32_t> bins(absl::string_view stat_name) const override;
+  uint32_t mergeThreads() const override { return merge_threads_; }
 
   static ConstSupportedBuckets& defaultBuckets();
 
@@ -36,6 +37,7 @@ private:
     absl::optional<uint32_t> bins_;
   };
   const std::vector<Config> configs_;
+  const uint32_t merge_threads_{0};
 };
 
 /**
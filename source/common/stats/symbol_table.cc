@@ -4,9 +4,11 @@
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 #include "source/common/common/assert.h"
+#include "source/common/common/hash.h"
 #include "source/common/common/logger.h"
 #include "source/common/common/utility.h"
 
@@ -228,11 +230,8 @@ bool StatName::startsWith(StatName prefix) const {
 
 std::vector<absl::string_view> SymbolTable::decodeStrings(StatName stat_name) const {
   std::vector<absl::string_view> strings;
-  Thread::LockGuard lock(lock_);
   Encoding::decodeTokens(
-      stat_name,
-      [this, &strings](Symbol symbol)
-          ABSL_NO_THREAD_SAFETY_ANALYSIS { strings.push_back(fromSymbol(symbol)); },
+      stat_name, [this, &strings](Symbol symbol) { strings.push_back(fromSymbol(symbol)); },
       [&strings](absl::string_view str) { strings.push_back(str); });
   return strings;
 }
@@ -249,8 +248,8 @@ void SymbolTable::Encoding::appendToMemBlock(StatName stat_name,
 }
 
 SymbolTable::SymbolTable()
-    // Have to be explicitly initialized, if we want to use the ABSL_GUARDED_BY macro.
-    : next_symbol_(FirstValidSymbol), monotonic_counter_(FirstValidSymbol) {}
+    // Has to be explicitly initialized, if we want to use the ABSL_GUARDED_BY macro.
+    : monotonic_counter_(FirstValidSymbol) {}
 
 SymbolTable::~SymbolTable() {
   // To avoid leaks into the symbol table, we expect all StatNames to be freed.
@@ -274,18 +273,21 @@ void SymbolTable::addTokensToEncoding(const absl::string_view name, Encoding& en
   std::vector<Symbol> symbols;
   symbols.reserve(tokens.size());
 
-  // Now take the lock and populate the Symbol objects, which involves bumping
-  // ref-counts in this.
-  {
-    Thread::LockGuard lock(lock_);
+  if (record_recent_lookups_.load(std::memory_order_relaxed)) {
+    Thread::LockGuard lock(recent_lookups_lock_);
     recent_lookups_.lookup(name);
-    for (auto& token : tokens) {
-      // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
-      // length below some threshold, say 4 bytes. It might be preferable not to
-      // reserve Symbols for every 3 digit number found (for example) in ipv4
-      // addresses.
-      symbols.push_back(toSymbol(token));
-    }
+  } else {
+    unrecorded_lookups_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Populate the Symbol objects, which involves bumping ref-counts in this. Each
+  // token only locks the shard it belongs to.
+  for (auto& token : tokens) {
+    // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
+    // length below some threshold, say 4 bytes. It might be preferable not to
+    // reserve Symbols for every 3 digit number found (for example) in ipv4
+    // addresses.
+    symbols.push_back(toSymbol(token));
   }
 
   // Now efficiently encode the array of 32-bit symbols into a uint8_t array.
@@ -293,9 +295,12 @@ void SymbolTable::addTokensToEncoding(const absl::string_view name, Encoding& en
 }
 
 uint64_t SymbolTable::numSymbols() const {
-  Thread::LockGuard lock(lock_);
-  ASSERT(encode_map_.size() == decode_map_.size());
-  return encode_map_.size();
+  uint64_t num_symbols = 0;
+  for (const Shard& shard : shards_) {
+    absl::ReaderMutexLock lock(shard.mutex_);
+    num_symbols += shard.encode_map_.size();
+  }
+  return num_symbols;
 }
 
 std::string SymbolTable::toString(const StatName& stat_name) const {
@@ -317,7 +322,6 @@ size_t SymbolTable::serializeToBuffer(const StatName& stat_name, char* buffer,
     bytes_required += token.size();
   };
 
-  Thread::LockGuard lock(lock_);
   Encoding::TokenIter iter(stat_name);
   bool first = true;
   for (Encoding::TokenIter::TokenType type = iter.next();
@@ -326,7 +330,6 @@ size_t SymbolTable::serializeToBuffer(const StatName& stat_name, char* buffer,
       append(".");
     }
     first = false;
-    // fromSymbol() requires lock_, which is held for the duration of this call.
     append(type == Encoding::TokenIter::TokenType::Symbol ? fromSymbol(iter.symbol())
                                                           : iter.stringView());
   }
@@ -334,48 +337,45 @@ size_t SymbolTable::serializeToBuffer(const StatName& stat_name, char* buffer,
 }
 
 void SymbolTable::incRefCount(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
+  // The caller holds a reference to every symbol in stat_name, so they all exist
+  // and none can be removed concurrently; no lock is needed.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name);
-
-  Thread::LockGuard lock(lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-
-    ASSERT(decode_search != decode_map_.end(),
+    SharedSymbol* shared_symbol = decode_table_.find(symbol);
+    ASSERT(shared_symbol != nullptr,
            "Please see "
            "https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md#"
            "debugging-symbol-table-assertions");
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end(),
-           "Please see "
-           "https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md#"
-           "debugging-symbol-table-assertions");
-
-    ++encode_search->second.ref_count_;
+    shared_symbol->ref_count_.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
 void SymbolTable::free(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name);
-
-  Thread::LockGuard lock(lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
-
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
-
-    // If that was the last remaining client usage of the symbol, erase the
-    // current mappings and add the now-unused symbol to the reuse pool.
-    //
-    // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
-    // symbol_table_speed_test.cc, relative to breaking out the decrement into a
-    // separate step, likely due to the non-trivial dereferences in EXPR.
-    if (--encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
-      encode_map_.erase(encode_search);
+    SharedSymbol* shared_symbol = decode_table_.find(symbol);
+    ASSERT(shared_symbol != nullptr);
+
+    // Releasing a reference which is not the last one doesn't need the lock.
+    uint32_t ref_count = shared_symbol->ref_count_.load(std::memory_order_relaxed);
+    while (ref_count > 1 && !shared_symbol->ref_count_.compare_exchange_weak(
+                                ref_count, ref_count - 1, std::memory_order_acq_rel)) {
+    }
+    if (ref_count > 1) {
+      continue;
+    }
+
+    // This may have been the last remaining client usage of the symbol. Under the
+    // writer lock nothing else can take a new reference, so if the count drops to
+    // zero, erase the mappings and add the now-unused symbol to the reuse pool.
+    Shard& shard = shards_[shared_symbol->shard_];
+    absl::WriterMutexLock lock(shard.mutex_);
+    if (shared_symbol->ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      decode_table_.set(symbol, nullptr);
+      auto encode_search = shard.encode_map_.find(shared_symbol->str_->toStringView());
+      ASSERT(encode_search != shard.encode_map_.end());
+      shard.encode_map_.erase(encode_search);
+      Thread::LockGuard symbol_lock(symbol_lock_);
       pool_.push(symbol);
     }
   }
@@ -385,15 +385,16 @@ uint64_t SymbolTable::getRecentLookups(const RecentLookupsFn& iter) const {
   uint64_t total = 0;
   absl::flat_hash_map<std::string, uint64_t> name_count_map;
 
-  // We don't want to hold lock_ while calling the iterator, but we need it to
-  // access recent_lookups_, so we buffer in name_count_map.
+  // We don't want to hold recent_lookups_lock_ while calling the iterator, but we
+  // need it to access recent_lookups_, so we buffer in name_count_map.
   {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(recent_lookups_lock_);
     recent_lookups_.forEach(
         [&name_count_map](absl::string_view str, uint64_t count)
             ABSL_NO_THREAD_SAFETY_ANALYSIS { name_count_map[std::string(str)] += count; });
     total += recent_lookups_.total();
   }
+  total += unrecorded_lookups_.load(std::memory_order_relaxed);
 
   // Now we have the collated name-count map data: we need to vectorize and
   // sort. We define the pair with the count first as std::pair::operator<
@@ -437,17 +438,19 @@ DynamicSpans SymbolTable::getDynamicSpans(StatName stat_name) const {
 }
 
 void SymbolTable::setRecentLookupCapacity(uint64_t capacity) {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   recent_lookups_.setCapacity(capacity);
+  record_recent_lookups_.store(capacity > 0, std::memory_order_relaxed);
 }
 
 void SymbolTable::clearRecentLookups() {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   recent_lookups_.clear();
+  unrecorded_lookups_.store(0, std::memory_order_relaxed);
 }
 
 uint64_t SymbolTable::recentLookupCapacity() const {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   return recent_lookups_.capacity();
 }
 
@@ -458,59 +461,98 @@ StatNameSetPtr SymbolTable::makeSet(absl::string_view name) {
 }
 
 Symbol SymbolTable::toSymbol(absl::string_view sv) {
-  Symbol result;
-  auto encode_find = encode_map_.find(sv);
-  // If the string segment doesn't already exist,
-  if (encode_find == encode_map_.end()) {
-    // We create the actual string, place it in the decode_map_, and then insert
-    // a string_view pointing to it in the encode_map_. This allows us to only
-    // store the string once. We use unique_ptr so copies are not made as
-    // flat_hash_map moves values around.
-    InlineStringPtr str = InlineString::create(sv);
-    auto encode_insert = encode_map_.insert({str->toStringView(), SharedSymbol(next_symbol_)});
-    ASSERT(encode_insert.second);
-    auto decode_insert = decode_map_.insert({next_symbol_, std::move(str)});
-    ASSERT(decode_insert.second);
-
-    result = next_symbol_;
-    newSymbol();
-  } else {
-    // If the insertion didn't take place, return the actual value at that location and up the
-    // refcount at that location
-    result = encode_find->second.symbol_;
-    ++(encode_find->second.ref_count_);
+  const uint32_t shard_index = HashUtil::xxHash64(sv) % NumShards;
+  Shard& shard = shards_[shard_index];
+  {
+    // The common case: the token is already in the table, and other threads may
+    // be encoding it at the same time.
+    absl::ReaderMutexLock lock(shard.mutex_);
+    auto encode_find = shard.encode_map_.find(sv);
+    if (encode_find != shard.encode_map_.end()) {
+      encode_find->second->ref_count_.fetch_add(1, std::memory_order_relaxed);
+      return encode_find->second->symbol_;
+    }
+  }
+
+  absl::WriterMutexLock lock(shard.mutex_);
+  // Another thread may have added the token since the reader lock was released.
+  auto encode_find = shard.encode_map_.find(sv);
+  if (encode_find != shard.encode_map_.end()) {
+    encode_find->second->ref_count_.fetch_add(1, std::memory_order_relaxed);
+    return encode_find->second->symbol_;
   }
-  return result;
+
+  // We create the actual string, owned by the SharedSymbol, and insert a
+  // string_view pointing to it in the encode map. This allows us to only store
+  // the string once.
+  const Symbol symbol = allocateSymbol();
+  auto shared_symbol =
+      std::make_unique<SharedSymbol>(InlineString::create(sv), symbol, shard_index);
+  decode_table_.set(symbol, shared_symbol.get());
+  const absl::string_view key = shared_symbol->str_->toStringView();
+  shard.encode_map_.emplace(key, std::move(shared_symbol));
+  return symbol;
 }
 
-absl::string_view SymbolTable::fromSymbol(const Symbol symbol) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
-  auto search = decode_map_.find(symbol);
-  RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
-  return search->second->toStringView();
+absl::string_view SymbolTable::fromSymbol(const Symbol symbol) const {
+  const SharedSymbol* shared_symbol = decode_table_.find(symbol);
+  RELEASE_ASSERT(shared_symbol != nullptr, "no such symbol");
+  return shared_symbol->str_->toStringView();
 }
 
-void SymbolTable::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+Symbol SymbolTable::allocateSymbol() {
+  Thread::LockGuard lock(symbol_lock_);
   if (pool_.empty()) {
-    next_symbol_ = ++monotonic_counter_;
-  } else {
-    next_symbol_ = pool_.top();
-    pool_.pop();
+    // This should catch integer overflow for the new symbol.
+    ASSERT(monotonic_counter_ + 1 != 0);
+    return monotonic_counter_++;
   }
-  // This should catch integer overflow for the new symbol.
-  ASSERT(monotonic_counter_ != 0);
+  const Symbol symbol = pool_.top();
+  pool_.pop();
+  return symbol;
 }
 
-bool SymbolTable::lessThan(const StatName& a, const StatName& b) const {
-  // Proactively take the table lock in anticipation that we'll need to
-  // convert at least one symbol to a string_view, and it's easier not to
-  // bother to lazily take the lock.
-  Thread::LockGuard lock(lock_);
-  return lessThanLockHeld(a, b);
+SymbolTable::SharedSymbol* SymbolTable::DecodeTable::find(Symbol symbol) const {
+  const Directory* directory = directory_.load(std::memory_order_acquire);
+  const uint32_t chunk = symbol >> ChunkBits;
+  if (directory == nullptr || chunk >= directory->size()) {
+    return nullptr;
+  }
+  return (*(*directory)[chunk])[symbol & (ChunkSize - 1)].load(std::memory_order_acquire);
+}
+
+void SymbolTable::DecodeTable::set(Symbol symbol, SharedSymbol* shared_symbol) {
+  const uint32_t chunk = symbol >> ChunkBits;
+  const Directory* directory = directory_.load(std::memory_order_acquire);
+  if (directory == nullptr || chunk >= directory->size()) {
+    grow(chunk + 1);
+    directory = directory_.load(std::memory_order_acquire);
+  }
+  (*(*directory)[chunk])[symbol & (ChunkSize - 1)].store(shared_symbol,
+                                                         std::memory_order_release);
 }
 
-bool SymbolTable::lessThanLockHeld(const StatName& a, const StatName& b) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+void SymbolTable::DecodeTable::grow(uint32_t num_chunks) {
+  Thread::LockGuard lock(grow_lock_);
+  const Directory* directory = directory_.load(std::memory_order_acquire);
+  if (directory != nullptr && directory->size() >= num_chunks) {
+    return; // Another thread grew the table first.
+  }
+  // Grow geometrically so that directories are copied a logarithmic number of times.
+  num_chunks = std::max<uint32_t>(num_chunks, 2 * chunks_.size());
+  auto new_directory = std::make_unique<Directory>();
+  new_directory->reserve(num_chunks);
+  while (chunks_.size() < num_chunks) {
+    chunks_.push_back(std::make_unique<Chunk>()); // Value-initialized, so all slots are null.
+  }
+  for (const auto& chunk : chunks_) {
+    new_directory->push_back(chunk.get());
+  }
+  directory_.store(new_directory.get(), std::memory_order_release);
+  directories_.push_back(std::move(new_directory));
+}
+
+bool SymbolTable::lessThan(const StatName& a, const StatName& b) const {
   Encoding::TokenIter a_iter(a), b_iter(b);
   while (true) {
     Encoding::TokenIter::TokenType a_type = a_iter.next();
@@ -540,16 +582,17 @@ bool SymbolTable::lessThanLockHeld(const StatName& a, const StatName& b) const
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTable::debugPrint() const {
-  Thread::LockGuard lock(lock_);
-  std::vector<Symbol> symbols;
-  for (const auto& p : decode_map_) {
-    symbols.push_back(p.first);
+  std::vector<std::tuple<Symbol, std::string, uint32_t>> symbols;
+  for (const Shard& shard : shards_) {
+    absl::ReaderMutexLock lock(shard.mutex_);
+    for (const auto& p : shard.encode_map_) {
+      symbols.emplace_back(p.second->symbol_, std::string(p.first),
+                           p.second->ref_count_.load(std::memory_order_relaxed));
+    }
   }
   std::sort(symbols.begin(), symbols.end());
-  for (Symbol symbol : symbols) {
-    const InlineString& token = *decode_map_.find(symbol)->second;
-    const SharedSymbol& shared_symbol = encode_map_.find(token.toStringView())->second;
-    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(), shared_symbol.ref_count_);
+  for (const auto& [symbol, token, ref_count] : symbols) {
+    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token, ref_count);
   }
 }
 #endif
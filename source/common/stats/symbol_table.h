@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <stack>
 #include <string>
@@ -19,6 +21,7 @@
 #include "absl/container/inlined_vector.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Stats {
@@ -246,9 +249,8 @@ public:
    * caller-provided buffer, without allocating. This lets callers that already own a buffer, such
    * as stats sinks during flush, avoid the per-name std::string allocation that toString() incurs.
    *
-   * At most buffer_size bytes are written and no null terminator is added. The symbol-table lock is
-   * acquired once for the call, so this suits periodic operations such as the stats flush rather
-   * than the request hot path.
+   * At most buffer_size bytes are written and no null terminator is added. Symbols are decoded
+   * without taking any lock.
    *
    * @param stat_name the stat name to serialize.
    * @param buffer the destination buffer. May be null only if buffer_size is 0, which makes this a
@@ -365,8 +367,6 @@ public:
    */
   DynamicSpans getDynamicSpans(StatName stat_name) const;
 
-  bool lessThanLockHeld(const StatName& a, const StatName& b) const;
-
   template <class GetStatName, class Obj> struct StatNameCompare {
     StatNameCompare(const SymbolTable& symbol_table, GetStatName getter)
         : symbol_table_(symbol_table), getter_(getter) {}
@@ -378,9 +378,8 @@ public:
   };
 
   /**
-   * Sorts a range by StatName. This API is more efficient than
-   * calling std::sort directly as it takes a single lock for the
-   * entire sort, rather than locking on each comparison.
+   * Sorts a range by StatName. Comparisons decode symbols without locking, so
+   * this is equivalent to calling std::sort with StatNameLessThan.
    *
    * @param begin the beginning of the range to sort
    * @param end the end of the range to sort
@@ -388,9 +387,6 @@ public:
    */
   template <class Obj, class Iter, class GetStatName>
   void sortByStatNames(Iter begin, Iter end, GetStatName get_stat_name) const {
-    // Grab the lock once before sorting begins, so we don't have to re-take
-    // it on every comparison.
-    Thread::LockGuard lock(lock_);
     StatNameCompare<GetStatName, Obj> compare(*this, get_stat_name);
     std::sort(begin, end, compare);
   }
@@ -436,15 +432,61 @@ private:
    */
   void incRefCount(const StatName& stat_name);
 
+  // Number of independently locked partitions of the encode map. Tokens are assigned to a shard
+  // by their hash, so that threads encoding different tokens don't contend.
+  static constexpr uint32_t NumShards = 16;
+
   struct SharedSymbol {
-    SharedSymbol(Symbol symbol) : symbol_(symbol) {}
+    SharedSymbol(InlineStringPtr str, Symbol symbol, uint32_t shard)
+        : str_(std::move(str)), symbol_(symbol), shard_(shard) {}
+
+    const InlineStringPtr str_;
+    const Symbol symbol_;
+    const uint32_t shard_;
+    // Holders of a reference may increment this, and decrement it while it stays above one,
+    // without locking. Encoding increments it with the shard's reader lock held, and it is
+    // only decremented to zero with the shard's writer lock held.
+    std::atomic<uint32_t> ref_count_{1};
+  };
 
-    Symbol symbol_;
-    uint32_t ref_count_{1};
+  // Each shard gets its own cache line, so that threads locking neighbouring shards don't
+  // invalidate each other's mutex.
+  struct alignas(64) Shard {
+    // Encoding existing tokens takes the reader lock; adding and removing tokens takes the
+    // writer lock.
+    mutable absl::Mutex mutex_;
+    // The keys are views of SharedSymbol::str_, so that the string is only stored once.
+    absl::flat_hash_map<absl::string_view, std::unique_ptr<SharedSymbol>>
+        encode_map_ ABSL_GUARDED_BY(mutex_);
   };
 
-  // This must be held during both encode() and free().
-  mutable Thread::MutexBasicLockable lock_;
+  /**
+   * Maps symbols back to their SharedSymbol without locking. Symbols are small dense integers,
+   * so the table is an array of fixed-size chunks of slots. Chunks never move once allocated;
+   * when more are needed, the directory of chunks is copied and the copy published, and the
+   * replaced directories are kept until destruction as readers may still be using them.
+   *
+   * A slot may only be read while the caller holds a reference to its symbol, which is the case
+   * whenever a StatName containing the symbol is being decoded.
+   */
+  class DecodeTable {
+  public:
+    SharedSymbol* find(Symbol symbol) const;
+    void set(Symbol symbol, SharedSymbol* shared_symbol);
+
+  private:
+    static constexpr uint32_t ChunkBits = 8;
+    static constexpr uint32_t ChunkSize = 1 << ChunkBits;
+    using Chunk = std::array<std::atomic<SharedSymbol*>, ChunkSize>;
+    using Directory = std::vector<Chunk*>;
+
+    void grow(uint32_t num_chunks);
+
+    std::atomic<const Directory*> directory_{nullptr};
+    Thread::MutexBasicLockable grow_lock_;
+    std::vector<std::unique_ptr<Chunk>> chunks_ ABSL_GUARDED_BY(grow_lock_);
+    std::vector<std::unique_ptr<const Directory>> directories_ ABSL_GUARDED_BY(grow_lock_);
+  };
 
   /**
    * Decodes a uint8_t array into an array of period-delimited strings. Note
@@ -467,20 +509,20 @@ private:
    * @param sv the individual string to be encoded as a symbol.
    * @return Symbol the encoded string.
    */
-  Symbol toSymbol(absl::string_view sv) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  Symbol toSymbol(absl::string_view sv);
 
   /**
-   * Convenience function for decode(), decoding one symbol at a time.
+   * Convenience function for decode(), decoding one symbol at a time. Does not lock.
    *
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  absl::string_view fromSymbol(Symbol symbol) const;
 
   /**
-   * Stages a new symbol for use. To be called after a successful insertion.
+   * Takes a symbol from the free pool, or a new one if the pool is empty.
    */
-  void newSymbol();
+  Symbol allocateSymbol();
 
   /**
    * Tokenizes name, finds or allocates symbols for each token, and adds them
@@ -492,30 +534,30 @@ private:
   void addTokensToEncoding(absl::string_view name, Encoding& encoding);
 
   Symbol monotonicCounter() {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(symbol_lock_);
     return monotonic_counter_;
   }
 
-  // Stores the symbol to be used at next insertion. This should exist ahead of insertion time so
-  // that if insertion succeeds, the value written is the correct one.
-  Symbol next_symbol_ ABSL_GUARDED_BY(lock_);
+  std::array<Shard, NumShards> shards_;
+  DecodeTable decode_table_;
 
-  // If the free pool is exhausted, we monotonically increase this counter.
-  Symbol monotonic_counter_;
+  // Guards symbol allocation, which only happens when a token is added to the table.
+  Thread::MutexBasicLockable symbol_lock_;
 
-  // Bitmap implementation.
-  // The encode map stores both the symbol and the ref count of that symbol.
-  // Using absl::string_view lets us only store the complete string once, in the decode map.
-  using EncodeMap = absl::flat_hash_map<absl::string_view, SharedSymbol>;
-  using DecodeMap = absl::flat_hash_map<Symbol, InlineStringPtr>;
-  EncodeMap encode_map_ ABSL_GUARDED_BY(lock_);
-  DecodeMap decode_map_ ABSL_GUARDED_BY(lock_);
+  // If the free pool is exhausted, we monotonically increase this counter.
+  Symbol monotonic_counter_ ABSL_GUARDED_BY(symbol_lock_);
 
   // Free pool of symbols for re-use.
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
   // using an Envoy::IntervalSet.
-  std::stack<Symbol> pool_ ABSL_GUARDED_BY(lock_);
-  RecentLookups recent_lookups_ ABSL_GUARDED_BY(lock_);
+  std::stack<Symbol> pool_ ABSL_GUARDED_BY(symbol_lock_);
+
+  // Recent lookups are only recorded, under their own lock, when a capacity is set. Otherwise
+  // only the number of lookups is counted, so that encoding doesn't serialize on this lock.
+  mutable Thread::MutexBasicLockable recent_lookups_lock_;
+  RecentLookups recent_lookups_ ABSL_GUARDED_BY(recent_lookups_lock_);
+  std::atomic<bool> record_recent_lookups_{false};
+  std::atomic<uint64_t> unrecorded_lookups_{0};
 };
 
 // Base class for holding the backing-storing for a StatName. The two derived
@@ -1141,7 +1183,7 @@ template <class GetStatName, class Obj>
 bool SymbolTable::StatNameCompare<GetStatName, Obj>::operator()(const Obj& a, const Obj& b) const {
   StatName a_stat_name = getter_(a);
   StatName b_stat_name = getter_(b);
-  return symbol_table_.lessThanLockHeld(a_stat_name, b_stat_name);
+  return symbol_table_.lessThan(a_stat_name, b_stat_name);
 }
 
 using SymbolTablePtr = std::unique_ptr<SymbolTable>;
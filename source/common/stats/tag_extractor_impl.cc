@@ -94,7 +94,8 @@ bool TagExtractorImplBase::substrMismatch(absl::string_view stat_name) const {
 
 TagExtractorStdRegexImpl::TagExtractorStdRegexImpl(absl::string_view name, absl::string_view regex,
                                                    absl::string_view substr)
-    : TagExtractorImplBase(name, regex, substr), regex_(parseStdRegex(std::string(regex))) {}
+    : TagExtractorImplBase(name, regex, substr), pattern_(regex),
+      regex_(parseStdRegex(pattern_)) {}
 
 std::string& TagExtractorImplBase::addTagReturningValueRef(std::vector<Tag>& tags) const {
   tags.emplace_back();
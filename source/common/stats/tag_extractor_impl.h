@@ -82,6 +82,7 @@ public:
 #endif
   absl::string_view name() const override { return name_; }
   absl::string_view prefixToken() const override { return prefix_; }
+  absl::string_view prefilterPattern() const override { return {}; }
   bool otherExtractorWithSameNameExists() const override {
     return other_extractor_with_same_name_exists_;
   }
@@ -128,8 +129,12 @@ public:
 
   bool extractTag(TagExtractionContext& context, std::vector<Tag>& tags,
                   IntervalSet<size_t>& remove_characters) const override;
+  // The ECMAScript patterns that RE2 also accepts have the same matches on stat names, the others
+  // are rejected when building the prefilter.
+  absl::string_view prefilterPattern() const override { return pattern_; }
 
 private:
+  const std::string pattern_;
   const std::regex regex_;
 };
 
@@ -140,6 +145,7 @@ public:
 
   bool extractTag(TagExtractionContext& context, std::vector<Tag>& tags,
                   IntervalSet<size_t>& remove_characters) const override;
+  absl::string_view prefilterPattern() const override { return regex_.pattern(); }
 
 private:
   const re2::RE2 regex_;
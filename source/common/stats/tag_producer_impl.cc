@@ -8,6 +8,10 @@
 #include "source/common/common/utility.h"
 #include "source/common/stats/tag_extractor_impl.h"
 
+#include "absl/algorithm/container.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/ascii.h"
+
 namespace Envoy {
 namespace Stats {
 
@@ -59,6 +63,7 @@ TagProducerImpl::TagProducerImpl(const envoy::config::metrics::v3::StatsConfig&
       fixed_tags_.push_back(Tag{name, tag_specifier.fixed_value()});
     }
   }
+  compilePrefilter();
 }
 
 absl::Status TagProducerImpl::addExtractorsMatching(absl::string_view name) {
@@ -95,27 +100,75 @@ void TagProducerImpl::addExtractor(TagExtractorPtr extractor) {
     other.get().setOtherExtractorWithSameNameExists(true);
   }
 
+  // Patterns RE2 cannot parse, e.g. ECMAScript lookaheads, are left out of the prefilter, and
+  // their extractors are always applied.
+  int prefilter_index = -1;
+  const absl::string_view pattern = extractor->prefilterPattern();
+  if (!pattern.empty()) {
+    if (prefilter_ == nullptr) {
+      re2::RE2::Options options;
+      options.set_log_errors(false);
+      prefilter_ = std::make_unique<re2::RE2::Set>(options, re2::RE2::UNANCHORED);
+    }
+    prefilter_index = prefilter_->Add(pattern, nullptr);
+    if (prefilter_index >= 0) {
+      prefilter_size_ = prefilter_index + 1;
+    }
+  }
+
   const absl::string_view prefix = extractor->prefixToken();
   if (prefix.empty()) {
-    tag_extractors_without_prefix_.emplace_back(std::move(extractor));
+    tag_extractors_without_prefix_.push_back({std::move(extractor), prefilter_index});
   } else {
-    tag_extractor_prefix_map_[prefix].emplace_back(std::move(extractor));
+    tag_extractor_prefix_map_[prefix].push_back({std::move(extractor), prefilter_index});
+  }
+}
+
+void TagProducerImpl::compilePrefilter() {
+  if (prefilter_ == nullptr) {
+    return;
+  }
+  if (prefilter_size_ == 0 || !prefilter_->Compile()) {
+    // Without a prefilter, every extractor is applied.
+    prefilter_.reset();
+    prefilter_size_ = 0;
   }
 }
 
 void TagProducerImpl::forEachExtractorMatching(
     absl::string_view stat_name, std::function<void(const TagExtractorPtr&)> f) const {
-  IntervalSetImpl<size_t> remove_characters;
-  for (const TagExtractorPtr& tag_extractor : tag_extractors_without_prefix_) {
-    f(tag_extractor);
+  // The prefilter is only used on ASCII names, on which RE2 and ECMAScript regexes agree on what
+  // a character is.
+  absl::InlinedVector<bool, 64> prefilter_matched;
+  if (prefilter_ != nullptr && absl::c_all_of(stat_name, absl::ascii_isascii)) {
+    std::vector<int> matches;
+    re2::RE2::Set::ErrorInfo error_info;
+    if (prefilter_->Match(stat_name, &matches, &error_info) ||
+        error_info.kind == re2::RE2::Set::kNoError) {
+      prefilter_matched.resize(prefilter_size_, false);
+      for (int index : matches) {
+        prefilter_matched[index] = true;
+      }
+    }
+  }
+  const auto apply = [&prefilter_matched, &f](const PrefilteredExtractor& entry) {
+    if (entry.prefilter_index_ >= 0 && !prefilter_matched.empty() &&
+        !prefilter_matched[entry.prefilter_index_]) {
+      return;
+    }
+    f(entry.extractor_);
+  };
+
+  for (const PrefilteredExtractor& entry : tag_extractors_without_prefix_) {
+    apply(entry);
   }
   const absl::string_view::size_type dot = stat_name.find('.');
   if (dot != std::string::npos) {
     const absl::string_view token = absl::string_view(stat_name.data(), dot);
     const auto iter = tag_extractor_prefix_map_.find(token);
     if (iter != tag_extractor_prefix_map_.end()) {
-      for (const TagExtractorPtr& tag_extractor : iter->second) {
-        f(tag_extractor);
+      for (const PrefilteredExtractor& entry : iter->second) {
+        apply(entry);
       }
     }
   }
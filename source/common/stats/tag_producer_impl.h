@@ -18,6 +18,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "re2/set.h"
 
 namespace Envoy {
 namespace Stats {
@@ -64,6 +65,12 @@ private:
    */
   void addExtractor(TagExtractorPtr extractor);
 
+  /**
+   * Compiles the prefilter patterns of the extractors added so far. Must be called once all
+   * extractors are added.
+   */
+  void compilePrefilter();
+
   /**
    * Adds all default extractors matching the specified tag name. In this model,
    * more than one TagExtractor can be used to generate a given tag. The default
@@ -95,6 +102,8 @@ private:
    *   1. Finding the first '.' separated token in stat_name.
    *   2. Collecting the TagExtractors whose regexes have that same prefix "^prefix\\."
    *   3. Collecting also the TagExtractors whose regexes don't start with any prefix.
+   *   4. Dropping the TagExtractors whose prefilter pattern did not match stat_name. All
+   *      the patterns are matched in a single scan of stat_name.
    * In the future, we may also do substring searches in some cases.
    * See DefaultTagRegexTester::produceTagsReverse in test/common/stats/stats_impl_test.cc.
    *
@@ -104,12 +113,24 @@ private:
   void forEachExtractorMatching(absl::string_view stat_name,
                                 std::function<void(const TagExtractorPtr&)> f) const;
 
-  std::vector<TagExtractorPtr> tag_extractors_without_prefix_;
+  struct PrefilteredExtractor {
+    TagExtractorPtr extractor_;
+    // The index of the extractor's pattern in prefilter_, or -1 if the extractor is always
+    // applied.
+    int prefilter_index_;
+  };
+
+  std::vector<PrefilteredExtractor> tag_extractors_without_prefix_;
 
   // Maps a prefix word extracted out of a regex to a vector of TagExtractors. Note that
   // the storage for the prefix string is owned by the TagExtractor, which, depending on
   // implementation, may need make a copy of the prefix.
-  absl::flat_hash_map<absl::string_view, std::vector<TagExtractorPtr>> tag_extractor_prefix_map_;
+  absl::flat_hash_map<absl::string_view, std::vector<PrefilteredExtractor>>
+      tag_extractor_prefix_map_;
+
+  // Matches the prefilter patterns of all extractors that have one in a single scan.
+  std::unique_ptr<re2::RE2::Set> prefilter_;
+  int prefilter_size_{0};
 
   // Keep track of which names have extractors. If an extractor is added and there's
   // already one for that name, we set a bit in the extractor so we can decide whether
@@ -1,5 +1,6 @@
 #include "source/common/stats/thread_local_store.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <list>
@@ -27,10 +28,12 @@ const char ThreadLocalStoreImpl::DeleteScopeSync[] = "delete-scope";
 const char ThreadLocalStoreImpl::IterateScopeSync[] = "iterate-scope";
 const char ThreadLocalStoreImpl::MainDispatcherCleanupSync[] = "main-dispatcher-cleanup";
 
-ThreadLocalStoreImpl::ThreadLocalStoreImpl(Allocator& alloc)
+ThreadLocalStoreImpl::ThreadLocalStoreImpl(Allocator& alloc,
+                                           OptRef<Thread::ThreadFactory> thread_factory)
     : alloc_(alloc), tag_producer_(std::make_unique<TagProducerImpl>()),
       stats_matcher_(std::make_unique<StatsMatcherImpl>()),
       histogram_settings_(std::make_unique<HistogramSettingsImpl>()),
+      thread_factory_(thread_factory),
       null_counter_(alloc.symbolTable()), null_gauge_(alloc.symbolTable()),
       null_histogram_(alloc.symbolTable()), null_text_readout_(alloc.symbolTable()),
       well_known_tags_(alloc.symbolTable().makeSet("well_known_tags")) {
@@ -234,6 +237,8 @@ void ThreadLocalStoreImpl::shutdownThreading() {
     central_cache_entries_to_cleanup_.clear();
   }
 
+  merge_pool_.reset();
+
   Thread::LockGuard lock(hist_mutex_);
   for (ParentHistogramImpl* histogram : histogram_set_) {
     histogram->setShuttingDown(true);
@@ -262,7 +267,18 @@ void ThreadLocalStoreImpl::mergeHistograms(PostMergeCb merge_complete_cb) {
 
 void ThreadLocalStoreImpl::mergeInternal(PostMergeCb merge_complete_cb) {
   if (!shutting_down_) {
-    forEachHistogram(nullptr, [](ParentHistogram& histogram) { histogram.merge(); });
+    const uint32_t merge_threads = histogram_settings_->mergeThreads();
+    if (merge_threads > 0 && thread_factory_.has_value()) {
+      if (merge_pool_ == nullptr) {
+        merge_pool_ = std::make_unique<HistogramMergePool>(*thread_factory_, merge_threads);
+      }
+      Thread::LockGuard lock(hist_mutex_);
+      const std::vector<ParentHistogramImpl*> histograms(histogram_set_.begin(),
+                                                         histogram_set_.end());
+      merge_pool_->merge(histograms);
+    } else {
+      forEachHistogram(nullptr, [](ParentHistogram& histogram) { histogram.merge(); });
+    }
     merge_complete_cb();
     merge_in_progress_ = false;
   }
@@ -612,8 +628,10 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::getOrCreateCounterBase(
   return safeMakeStat<Counter>(
       final_stat_name, joiner.tagExtractedName(), joiner.effectiveTags(), central_cache->counters_,
       fast_reject_result, central_cache->rejected_stats_,
-      [](Allocator& allocator, StatName name, StatName tag_extracted_name, StatNameTagSpan tags)
-          -> CounterSharedPtr { return allocator.makeCounter(name, tag_extracted_name, tags); },
+      [this](Allocator& allocator, StatName name, StatName tag_extracted_name,
+             StatNameTagSpan tags) -> CounterSharedPtr {
+        return allocator.makeCounter(name, tag_extracted_name, tags, parent_.shardsCounter(name));
+      },
       tls_cache, tls_rejected_stats, parent_.null_counter_);
 }
 
@@ -900,13 +918,20 @@ ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
 void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   ASSERT(std::this_thread::get_id() == created_thread_id_);
   hist_insert_intscale(histograms_[current_active_], value, 0, 1);
+  recorded_[current_active_] = true;
   used_ = true;
 }
 
-void ThreadLocalHistogramImpl::merge(histogram_t* target) {
-  histogram_t** other_histogram = &histograms_[otherHistogramIndex()];
+bool ThreadLocalHistogramImpl::merge(histogram_t* target) {
+  const uint64_t other_index = otherHistogramIndex();
+  if (!recorded_[other_index]) {
+    return false;
+  }
+  histogram_t** other_histogram = &histograms_[other_index];
   hist_accumulate(target, other_histogram, 1);
   hist_clear(*other_histogram);
+  recorded_[other_index] = false;
+  return true;
 }
 
 ParentHistogramImpl::ParentHistogramImpl(StatName name, Histogram::Unit unit,
@@ -1008,14 +1033,23 @@ void ParentHistogramImpl::merge() {
     // then release the lock before we do the actual merge. However it is not a big deal
     // because the tls_histogram merge is not that expensive as it is a single histogram
     // merge and adding TLS histograms is rare.
+    bool recorded = false;
     for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
-      tls_histogram->merge(interval_histogram_);
+      recorded |= tls_histogram->merge(interval_histogram_);
     }
     // Since TLS merge is done, we can release the lock here.
     lock.release();
-    hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
-    cumulative_statistics_.refresh(cumulative_histogram_);
-    interval_statistics_.refresh(interval_histogram_);
+    // Computing the statistics is the expensive part of the merge. The cumulative statistics only
+    // change if values were recorded in this interval, and the interval statistics only if values
+    // were recorded in this interval or the previous one, so idle histograms skip both.
+    if (recorded) {
+      hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
+      cumulative_statistics_.refresh(cumulative_histogram_);
+    }
+    if (recorded || interval_recorded_) {
+      interval_statistics_.refresh(interval_histogram_);
+    }
+    interval_recorded_ = recorded;
     merged_ = true;
   }
 }
@@ -1094,6 +1128,84 @@ bool ParentHistogramImpl::usedLockHeld() const {
   return false;
 }
 
+namespace {
+
+// Histograms are claimed by merging threads in chunks, to amortize the cost of claiming them.
+constexpr size_t HistogramMergeChunkSize = 256;
+
+} // namespace
+
+HistogramMergePool::HistogramMergePool(Thread::ThreadFactory& thread_factory,
+                                       uint32_t thread_count) {
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    threads_.push_back(thread_factory.createThread([this]() { threadRoutine(); },
+                                                   Thread::Options{"StatsMerge"}));
+  }
+}
+
+HistogramMergePool::~HistogramMergePool() {
+  {
+    Thread::LockGuard lock(mutex_);
+    terminate_ = true;
+    work_available_.notifyAll();
+  }
+  for (const Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+void HistogramMergePool::merge(const std::vector<ParentHistogramImpl*>& histograms) {
+  {
+    Thread::LockGuard lock(mutex_);
+    histograms_ = &histograms;
+    next_ = 0;
+    busy_threads_ = threads_.size();
+    ++generation_;
+    work_available_.notifyAll();
+  }
+  mergeChunks(histograms);
+
+  Thread::LockGuard lock(mutex_);
+  while (busy_threads_ > 0) {
+    work_done_.wait(mutex_);
+  }
+  histograms_ = nullptr;
+}
+
+void HistogramMergePool::threadRoutine() {
+  uint64_t generation = 0;
+  while (true) {
+    const std::vector<ParentHistogramImpl*>* histograms;
+    {
+      Thread::LockGuard lock(mutex_);
+      while (!terminate_ && generation_ == generation) {
+        work_available_.wait(mutex_);
+      }
+      if (terminate_) {
+        return;
+      }
+      generation = generation_;
+      histograms = histograms_;
+    }
+    mergeChunks(*histograms);
+
+    Thread::LockGuard lock(mutex_);
+    if (--busy_threads_ == 0) {
+      work_done_.notifyOne();
+    }
+  }
+}
+
+void HistogramMergePool::mergeChunks(const std::vector<ParentHistogramImpl*>& histograms) {
+  for (size_t begin = next_.fetch_add(HistogramMergeChunkSize); begin < histograms.size();
+       begin = next_.fetch_add(HistogramMergeChunkSize)) {
+    const size_t end = std::min(begin + HistogramMergeChunkSize, histograms.size());
+    for (size_t i = begin; i < end; ++i) {
+      histograms[i]->merge();
+    }
+  }
+}
+
 void ThreadLocalStoreImpl::forEachCounter(SizeFn f_size, StatFn<Counter> f_stat) const {
   alloc_.forEachCounter(f_size, f_stat);
 }
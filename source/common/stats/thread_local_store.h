@@ -6,12 +6,15 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/stats/stats_matcher.h"
 #include "envoy/stats/tag.h"
+#include "envoy/thread/thread.h"
 #include "envoy/thread_local/thread_local.h"
 
 #include "source/common/common/hash.h"
+#include "source/common/common/thread.h"
 #include "source/common/common/thread_synchronizer.h"
 #include "source/common/stats/allocator.h"
 #include "source/common/stats/histogram_impl.h"
@@ -40,7 +43,11 @@ public:
                            absl::optional<uint32_t> bins);
   ~ThreadLocalHistogramImpl() override;
 
-  void merge(histogram_t* target);
+  /**
+   * Merges the values recorded before the last call to beginMerge() into target.
+   * @return false if there were none, in which case target is left untouched.
+   */
+  bool merge(histogram_t* target);
 
   /**
    * Called in the beginning of merge process. Swaps the histogram used for collection so that we do
@@ -71,6 +78,9 @@ private:
   uint64_t otherHistogramIndex() const { return 1 - current_active_; }
   uint64_t current_active_{0};
   histogram_t* histograms_[2];
+  // Whether each of histograms_ holds values that have not been merged yet. The recording thread
+  // only sets the flag of the active histogram, and the merging thread only clears the other.
+  bool recorded_[2]{false, false};
   std::atomic<bool> used_;
   const std::thread::id created_thread_id_;
   SymbolTable& symbol_table_;
@@ -150,6 +160,9 @@ private:
   mutable Thread::MutexBasicLockable merge_lock_;
   std::list<TlsHistogramSharedPtr> tls_histograms_ ABSL_GUARDED_BY(merge_lock_);
   bool merged_{false};
+  // Whether the last merge found any recorded values, i.e. whether the interval histogram is
+  // non-empty.
+  bool interval_recorded_{false};
   std::atomic<bool> shutting_down_{false};
   std::atomic<uint32_t> ref_count_{0};
   const uint64_t id_; // Index into TlsCache::histogram_cache_.
@@ -157,6 +170,39 @@ private:
 
 using ParentHistogramImplSharedPtr = RefcountPtr<ParentHistogramImpl>;
 
+/**
+ * Helper threads that merge parent histograms together with the main thread. The main thread waits
+ * for all histograms to be merged, so that they are never read while being merged.
+ */
+class HistogramMergePool {
+public:
+  HistogramMergePool(Thread::ThreadFactory& thread_factory, uint32_t thread_count);
+  ~HistogramMergePool();
+
+  /**
+   * Merges all of the histograms on the calling thread and the helper threads, and returns once
+   * they are all merged.
+   */
+  void merge(const std::vector<ParentHistogramImpl*>& histograms);
+
+private:
+  void threadRoutine();
+  void mergeChunks(const std::vector<ParentHistogramImpl*>& histograms);
+
+  Thread::MutexBasicLockable mutex_;
+  Thread::CondVar work_available_;
+  Thread::CondVar work_done_;
+  const std::vector<ParentHistogramImpl*>* histograms_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  // Incremented for each merge, so that helper threads know when there is new work.
+  uint64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The number of helper threads that have not finished the current merge.
+  size_t busy_threads_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool terminate_ ABSL_GUARDED_BY(mutex_) = false;
+  // Index of the next histogram to be claimed by a merging thread.
+  std::atomic<size_t> next_{0};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
 /**
  * Store implementation with thread local caching. For design details see
  * https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md
@@ -167,7 +213,11 @@ public:
   static const char IterateScopeSync[];
   static const char MainDispatcherCleanupSync[];
 
-  ThreadLocalStoreImpl(Allocator& alloc);
+  /**
+   * @param thread_factory creates the helper threads over which histogram merges are spread, if
+   *        HistogramSettings::mergeThreads() asks for any.
+   */
+  ThreadLocalStoreImpl(Allocator& alloc, OptRef<Thread::ThreadFactory> thread_factory = {});
   ~ThreadLocalStoreImpl() override;
   // Stats::Store
   NullCounterImpl& nullCounter() override { return null_counter_; }
@@ -201,6 +251,9 @@ public:
     tag_producer_ = std::move(tag_producer);
   }
   void setStatsMatcher(StatsMatcherPtr&& stats_matcher) override;
+  void setShardedCounterMatcher(StatsMatcherPtr&& sharded_counter_matcher) override {
+    sharded_counter_matcher_ = std::move(sharded_counter_matcher);
+  }
   void setHistogramSettings(HistogramSettingsConstPtr&& histogram_settings) override;
   void initializeThreading(Event::Dispatcher& main_thread_dispatcher,
                            ThreadLocal::Instance& tls) override;
@@ -563,6 +616,9 @@ private:
   bool rejects(StatName name) const { return stats_matcher_->rejects(name); }
   StatsMatcher::FastResult fastRejects(StatName name) const;
   bool rejectsAll() const { return stats_matcher_->rejectsAll(); }
+  bool shardsCounter(StatName name) const {
+    return sharded_counter_matcher_ != nullptr && !sharded_counter_matcher_->rejects(name);
+  }
   template <class StatMapClass, class StatListClass>
   void removeRejectedStats(StatMapClass& map, StatListClass& list);
   template <class StatSharedPtr>
@@ -585,7 +641,12 @@ private:
   std::vector<std::reference_wrapper<Sink>> timer_sinks_;
   TagProducerPtr tag_producer_;
   StatsMatcherPtr stats_matcher_;
+  // Selects the counters that are created sharded. If null, no counters are.
+  StatsMatcherPtr sharded_counter_matcher_;
   HistogramSettingsConstPtr histogram_settings_;
+  OptRef<Thread::ThreadFactory> thread_factory_;
+  // Created on the first merge if histogram_settings_ asks for helper threads.
+  std::unique_ptr<HistogramMergePool> merge_pool_;
   std::atomic<bool> threading_ever_initialized_{false};
   std::atomic<bool> shutting_down_{false};
   std::atomic<bool> merge_in_progress_{false};
@@ -0,0 +1,198 @@
+#include "source/common/tcp_proxy/splice.h"
+
+#include "envoy/event/file_event.h"
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/assert.h"
+#include "source/common/common/macros.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+
+#include "source/common/api/os_sys_calls_impl_linux.h"
+#endif
+
+namespace Envoy {
+namespace TcpProxy {
+
+SplicePipePool::~SplicePipePool() {
+  for (const SplicePipe& pipe : idle_pipes_) {
+    close(pipe);
+  }
+}
+
+absl::optional<SplicePipe> SplicePipePool::acquire() {
+  if (!idle_pipes_.empty()) {
+    SplicePipe pipe = idle_pipes_.back();
+    idle_pipes_.pop_back();
+    return pipe;
+  }
+#if defined(__linux__)
+  int fds[2];
+  const Api::SysCallIntResult result =
+      Api::LinuxOsSysCallsSingleton::get().pipe2(fds, O_NONBLOCK | O_CLOEXEC);
+  if (result.return_value_ != 0) {
+    ENVOY_LOG_MISC(debug, "failed to create splice pipe: errno {}", result.errno_);
+    return absl::nullopt;
+  }
+  return SplicePipe{fds[0], fds[1]};
+#else
+  return absl::nullopt;
+#endif
+}
+
+void SplicePipePool::release(SplicePipe pipe, bool empty) {
+  if (empty && idle_pipes_.size() < max_idle_pipes_) {
+    idle_pipes_.push_back(pipe);
+    return;
+  }
+  close(pipe);
+}
+
+void SplicePipePool::close(SplicePipe pipe) {
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  os_sys_calls.close(pipe.read_fd_);
+  os_sys_calls.close(pipe.write_fd_);
+}
+
+SpliceForwarderPtr SpliceForwarder::create(SplicePipePool& pool, Network::Connection& downstream,
+                                           Network::Connection& upstream,
+                                           SpliceForwarderCallbacks& callbacks) {
+  absl::optional<SplicePipe> downstream_pipe = pool.acquire();
+  if (!downstream_pipe.has_value()) {
+    return nullptr;
+  }
+  absl::optional<SplicePipe> upstream_pipe = pool.acquire();
+  if (!upstream_pipe.has_value()) {
+    pool.release(downstream_pipe.value(), true);
+    return nullptr;
+  }
+
+  SpliceForwarderPtr forwarder(
+      new SpliceForwarder(pool, downstream_pipe.value(), upstream_pipe.value(), callbacks));
+
+  // The connections keep their own file events registered on their sockets, so the forwarder
+  // watches duplicates of the descriptors instead.
+  forwarder->downstream_handle_ = downstream.getSocket()->ioHandle().duplicate();
+  forwarder->upstream_handle_ = upstream.getSocket()->ioHandle().duplicate();
+  if (!forwarder->downstream_handle_->isOpen() || !forwarder->upstream_handle_->isOpen()) {
+    return nullptr;
+  }
+
+  Direction& to_upstream = forwarder->downstream_to_upstream_;
+  to_upstream.source_ = forwarder->downstream_handle_.get();
+  to_upstream.destination_ = &upstream;
+  to_upstream.destination_handle_ = forwarder->upstream_handle_.get();
+
+  Direction& to_downstream = forwarder->upstream_to_downstream_;
+  to_downstream.source_ = forwarder->upstream_handle_.get();
+  to_downstream.destination_ = &downstream;
+  to_downstream.destination_handle_ = forwarder->downstream_handle_.get();
+
+  SpliceForwarder* raw = forwarder.get();
+  const uint32_t events = Event::FileReadyType::Read | Event::FileReadyType::Write;
+  for (Network::IoHandle* handle : {raw->downstream_handle_.get(), raw->upstream_handle_.get()}) {
+    handle->initializeFileEvent(
+        downstream.dispatcher(),
+        [raw](uint32_t) {
+          raw->onFileEvent();
+          return absl::OkStatus();
+        },
+        Event::PlatformDefaultTriggerType, events);
+  }
+  // Data may already be queued on either socket, so start moving it right away.
+  raw->downstream_handle_->activateFileEvents(Event::FileReadyType::Read);
+  return forwarder;
+}
+
+SpliceForwarder::SpliceForwarder(SplicePipePool& pool, SplicePipe downstream_pipe,
+                                 SplicePipe upstream_pipe, SpliceForwarderCallbacks& callbacks)
+    : pool_(pool), callbacks_(callbacks), downstream_to_upstream_(true, downstream_pipe),
+      upstream_to_downstream_(false, upstream_pipe) {}
+
+SpliceForwarder::~SpliceForwarder() {
+  for (Network::IoHandlePtr* handle : {&downstream_handle_, &upstream_handle_}) {
+    if (*handle != nullptr && (*handle)->isOpen()) {
+      (*handle)->resetFileEvents();
+      (*handle)->close();
+    }
+  }
+  pool_.release(downstream_to_upstream_.pipe_, downstream_to_upstream_.bytes_in_pipe_ == 0);
+  pool_.release(upstream_to_downstream_.pipe_, upstream_to_downstream_.bytes_in_pipe_ == 0);
+}
+
+void SpliceForwarder::onFileEvent() {
+  if (done_) {
+    return;
+  }
+  if (!pump(downstream_to_upstream_) || !pump(upstream_to_downstream_)) {
+    done_ = true;
+    // The owner is expected to destroy the forwarder from this callback.
+    callbacks_.onSpliceError();
+    return;
+  }
+  if (downstream_to_upstream_.end_stream_sent_ && upstream_to_downstream_.end_stream_sent_) {
+    done_ = true;
+    callbacks_.onSpliceComplete();
+  }
+}
+
+bool SpliceForwarder::pump(Direction& direction) {
+#if defined(__linux__)
+  auto& os_sys_calls = Api::LinuxOsSysCallsSingleton::get();
+  const unsigned int flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+  while (!direction.end_stream_sent_) {
+    if (direction.bytes_in_pipe_ > 0) {
+      const Api::SysCallSizeResult result =
+          os_sys_calls.splice(direction.pipe_.read_fd_, direction.destination_handle_->fdDoNotUse(),
+                              direction.bytes_in_pipe_, flags);
+      if (result.return_value_ < 0) {
+        if (result.errno_ == EAGAIN) {
+          // The destination is full. Stop reading the source until it drains, which pushes the
+          // backpressure to the source peer through its TCP receive window.
+          return true;
+        }
+        ENVOY_LOG(debug, "splice to {} failed: errno {}",
+                  direction.downstream_to_upstream_ ? "upstream" : "downstream", result.errno_);
+        return false;
+      }
+      direction.bytes_in_pipe_ -= result.return_value_;
+      callbacks_.onSplicedBytes(direction.downstream_to_upstream_, result.return_value_);
+      continue;
+    }
+
+    if (direction.source_eof_) {
+      // Everything read from the source has been flushed, propagate the half close.
+      Buffer::OwnedImpl empty;
+      direction.destination_->write(empty, true);
+      direction.end_stream_sent_ = true;
+      return true;
+    }
+
+    const Api::SysCallSizeResult result = os_sys_calls.splice(
+        direction.source_->fdDoNotUse(), direction.pipe_.write_fd_, ChunkSize, flags);
+    if (result.return_value_ == 0) {
+      direction.source_eof_ = true;
+    } else if (result.return_value_ < 0) {
+      if (result.errno_ == EAGAIN) {
+        return true;
+      }
+      ENVOY_LOG(debug, "splice from {} failed: errno {}",
+                direction.downstream_to_upstream_ ? "downstream" : "upstream", result.errno_);
+      return false;
+    } else {
+      direction.bytes_in_pipe_ += result.return_value_;
+    }
+  }
+  return true;
+#else
+  UNREFERENCED_PARAMETER(direction);
+  // enable_splice is rejected at configuration time and no pipes can be acquired here.
+  IS_ENVOY_BUG("splice is only supported on Linux");
+  return false;
+#endif
+}
+
+} // namespace TcpProxy
+} // namespace Envoy
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/network/connection.h"
+#include "envoy/network/io_handle.h"
+#include "envoy/thread_local/thread_local_object.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace TcpProxy {
+
+/**
+ * A kernel pipe used as the intermediate buffer of splice(2).
+ */
+struct SplicePipe {
+  int read_fd_{-1};
+  int write_fd_{-1};
+};
+
+/**
+ * Per-worker pool of kernel pipes. Pipes are only returned to the pool when they are empty, so
+ * that a pipe taken from the pool never carries bytes of a previous connection.
+ */
+class SplicePipePool : public ThreadLocal::ThreadLocalObject {
+public:
+  explicit SplicePipePool(uint32_t max_idle_pipes) : max_idle_pipes_(max_idle_pipes) {}
+  ~SplicePipePool() override;
+
+  /**
+   * @return an empty pipe, or absl::nullopt if pipes are not supported on this platform or the
+   *         pipe could not be created.
+   */
+  absl::optional<SplicePipe> acquire();
+
+  /**
+   * Returns a pipe to the pool. The pipe is closed instead if it still holds data or the pool is
+   * full.
+   * @param pipe supplies the pipe to return.
+   * @param empty supplies whether all bytes written to the pipe have been read back.
+   */
+  void release(SplicePipe pipe, bool empty);
+
+  size_t idlePipes() const { return idle_pipes_.size(); }
+
+private:
+  static void close(SplicePipe pipe);
+
+  const uint32_t max_idle_pipes_;
+  std::vector<SplicePipe> idle_pipes_;
+};
+
+/**
+ * Callbacks used by SpliceForwarder to report progress to its owner.
+ */
+class SpliceForwarderCallbacks {
+public:
+  virtual ~SpliceForwarderCallbacks() = default;
+
+  /**
+   * Called when bytes have been moved from one connection to the other.
+   * @param downstream_to_upstream supplies the direction the bytes were moved in.
+   * @param bytes supplies the number of bytes written to the destination socket.
+   */
+  virtual void onSplicedBytes(bool downstream_to_upstream, uint64_t bytes) PURE;
+
+  /**
+   * Called once both directions have seen end of stream and all bytes have been flushed.
+   */
+  virtual void onSpliceComplete() PURE;
+
+  /**
+   * Called when moving bytes failed, e.g. because a peer reset the connection.
+   */
+  virtual void onSpliceError() PURE;
+};
+
+/**
+ * Moves payload between two established connections with splice(2) so that it is never copied
+ * into user space. Both connections must be read disabled and must use a passthrough transport
+ * socket for the whole lifetime of the forwarder. Each direction owns a pipe; a direction only
+ * reads from its source socket once its pipe has been fully flushed to the destination socket,
+ * so the pipe capacity bounds the amount of data in flight.
+ */
+class SpliceForwarder : Logger::Loggable<Logger::Id::filter> {
+public:
+  /**
+   * @return a forwarder for the given connections, or nullptr if the pipes or file events could
+   *         not be set up, in which case the caller should keep using the buffered path.
+   */
+  static std::unique_ptr<SpliceForwarder> create(SplicePipePool& pool,
+                                                 Network::Connection& downstream,
+                                                 Network::Connection& upstream,
+                                                 SpliceForwarderCallbacks& callbacks);
+  ~SpliceForwarder();
+
+  // Bytes requested from the source socket per splice(2) call. This matches the default pipe
+  // capacity on Linux.
+  static constexpr size_t ChunkSize = 64 * 1024;
+
+private:
+  struct Direction {
+    Direction(bool downstream_to_upstream, SplicePipe pipe)
+        : downstream_to_upstream_(downstream_to_upstream), pipe_(pipe) {}
+
+    const bool downstream_to_upstream_;
+    SplicePipe pipe_;
+    Network::IoHandle* source_{};
+    Network::Connection* destination_{};
+    Network::IoHandle* destination_handle_{};
+    uint64_t bytes_in_pipe_{};
+    bool source_eof_{};
+    bool end_stream_sent_{};
+  };
+
+  SpliceForwarder(SplicePipePool& pool, SplicePipe downstream_pipe, SplicePipe upstream_pipe,
+                  SpliceForwarderCallbacks& callbacks);
+
+  void onFileEvent();
+  // Moves as many bytes as possible in one direction. Returns false on a fatal error.
+  bool pump(Direction& direction);
+
+  SplicePipePool& pool_;
+  SpliceForwarderCallbacks& callbacks_;
+  Network::IoHandlePtr downstream_handle_;
+  Network::IoHandlePtr upstream_handle_;
+  Direction downstream_to_upstream_;
+  Direction upstream_to_downstream_;
+  bool done_{};
+};
+
+using SpliceForwarderPtr = std::unique_ptr<SpliceForwarder>;
+
+} // namespace TcpProxy
+} // namespace Envoy
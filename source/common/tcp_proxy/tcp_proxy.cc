@@ -233,6 +233,20 @@ Config::Config(const envoy::extensions::filters::network::tcp_proxy::v3::TcpProx
     return drain_manager;
   });
 
+#if !defined(__linux__)
+  if (config.enable_splice()) {
+    throw EnvoyException("tcp_proxy: enable_splice is only supported on Linux");
+  }
+#else
+  if (config.enable_splice()) {
+    splice_pipe_pool_slot_ = context.serverFactoryContext().threadLocal().allocateSlot();
+    splice_pipe_pool_slot_->set([](Event::Dispatcher&) {
+      // Keep enough idle pipes around to serve a burst of new connections without pipe2() calls.
+      return std::make_shared<SplicePipePool>(/*max_idle_pipes=*/256);
+    });
+  }
+#endif
+
   if (!config.cluster().empty()) {
     default_route_ = std::make_shared<const SimpleRouteImpl>(*this, config.cluster());
   }
@@ -1242,6 +1256,7 @@ void Filter::onDownstreamEvent(Network::ConnectionEvent event) {
         read_callbacks_->connection().dispatcher().timeSource());
     // Cancel the potential odcds callback.
     cluster_discovery_handle_ = nullptr;
+    splice_forwarder_.reset();
   }
 
   ENVOY_CONN_LOG(trace, "on downstream event {}, has upstream = {}", read_callbacks_->connection(),
@@ -1308,6 +1323,7 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
 
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
+    splice_forwarder_.reset();
     // Propagate the upstream local close reason to the downstream stream info's upstreamInfo.
     if (upstream_) {
       getStreamInfo().upstreamInfo()->setUpstreamLocalCloseReason(upstream_->localCloseReason());
@@ -1389,6 +1405,8 @@ void Filter::onUpstreamConnection() {
     ASSERT(0 == early_data_buffer_.length());
   }
 
+  const bool splicing = maybeStartSplice();
+
   // Re-enable downstream reads if we disabled reading.
   // Reading can be disabled in two cases:
   // 1. Buffer overflow when receive_before_connect is enabled (tracked by
@@ -1397,9 +1415,10 @@ void Filter::onUpstreamConnection() {
   if (read_disabled_due_to_buffer_) {
     read_callbacks_->connection().readDisable(false);
     read_disabled_due_to_buffer_ = false;
-  } else if (!receive_before_connect_) {
+  } else if (!receive_before_connect_ && !splicing) {
     // Re-enable downstream reads that were disabled in establishUpstreamConnection()
-    // when early data reception was NOT enabled.
+    // when early data reception was NOT enabled. When splicing, the socket is read by the
+    // forwarder instead and the connection stays read disabled.
     read_callbacks_->connection().readDisable(false);
   }
 
@@ -1429,6 +1448,65 @@ void Filter::onUpstreamConnection() {
   }
 }
 
+bool Filter::maybeStartSplice() {
+  OptRef<SplicePipePool> pipe_pool = config_->splicePipePool();
+  // Data received before the upstream connection existed went through the filter chain, so only
+  // take the fast path when the downstream socket has not been read yet.
+  if (!pipe_pool.has_value() || receive_before_connect_ || upstream_ == nullptr) {
+    return false;
+  }
+  Network::Connection& downstream_connection = read_callbacks_->connection();
+  // Any other filter on the connection, e.g. RBAC or ext_authz, expects to see every byte, so it
+  // must not be bypassed.
+  if (!downstream_connection.isSoleFilter(*this)) {
+    return false;
+  }
+  OptRef<Network::Connection> upstream_connection = upstream_->rawConnection();
+  if (!upstream_connection.has_value() || !downstream_connection.hasPassthroughTransport() ||
+      !upstream_connection->hasPassthroughTransport()) {
+    return false;
+  }
+
+  splice_forwarder_ = SpliceForwarder::create(pipe_pool.ref(), downstream_connection,
+                                              upstream_connection.ref(), *this);
+  if (splice_forwarder_ == nullptr) {
+    return false;
+  }
+  upstream_->readDisable(true);
+  config_->stats().downstream_cx_splice_total_.inc();
+  ENVOY_CONN_LOG(debug, "moving payload with splice", downstream_connection);
+  return true;
+}
+
+void Filter::onSplicedBytes(bool downstream_to_upstream, uint64_t bytes) {
+  // The bytes never pass through the connection buffers, so account them on both connections the
+  // same way the buffered path does. This feeds the downstream and upstream cluster byte counters.
+  Network::Connection& downstream_connection = read_callbacks_->connection();
+  OptRef<Network::Connection> upstream_connection = upstream_->rawConnection();
+  if (downstream_to_upstream) {
+    getStreamInfo().getDownstreamBytesMeter()->addWireBytesReceived(bytes);
+    getStreamInfo().getUpstreamBytesMeter()->addWireBytesSent(bytes);
+    downstream_connection.addDirectSocketBytes(bytes, 0);
+    upstream_connection->addDirectSocketBytes(0, bytes);
+  } else {
+    getStreamInfo().getUpstreamBytesMeter()->addWireBytesReceived(bytes);
+    getStreamInfo().getDownstreamBytesMeter()->addWireBytesSent(bytes);
+    upstream_connection->addDirectSocketBytes(bytes, 0);
+    downstream_connection.addDirectSocketBytes(0, bytes);
+  }
+  resetIdleTimer();
+}
+
+void Filter::onSpliceComplete() {
+  ENVOY_CONN_LOG(debug, "splice: both directions reached end of stream",
+                 read_callbacks_->connection());
+  read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
+}
+
+void Filter::onSpliceError() {
+  read_callbacks_->connection().close(Network::ConnectionCloseType::NoFlush);
+}
+
 void Filter::onIdleTimeout() {
   ENVOY_CONN_LOG(debug, "Session timed out", read_callbacks_->connection());
   config_->stats().idle_timeout_.inc();
@@ -34,6 +34,7 @@
 #include "source/common/network/hash_policy.h"
 #include "source/common/network/utility.h"
 #include "source/common/stream_info/stream_info_impl.h"
+#include "source/common/tcp_proxy/splice.h"
 #include "source/common/tcp_proxy/upstream.h"
 #include "source/common/upstream/load_balancer_context_base.h"
 #include "source/common/upstream/od_cds_api_impl.h"
@@ -62,6 +63,7 @@ constexpr absl::string_view ReceiveBeforeConnectKey = "envoy.tcp_proxy.receive_b
   COUNTER(downstream_cx_drain_close)                                                               \
   COUNTER(downstream_cx_no_route)                                                                  \
   COUNTER(downstream_cx_rx_bytes_total)                                                            \
+  COUNTER(downstream_cx_splice_total)                                                              \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_tx_bytes_total)                                                            \
   COUNTER(downstream_flow_control_paused_reading_total)                                            \
@@ -382,6 +384,12 @@ public:
   bool checkDrainClose() const { return check_drain_close_; }
   const Network::DrainDecision& drainDecision() const { return drain_decision_; }
   Network::DrainDirection drainCloseScope() const { return drain_close_scope_; }
+  // Returns an empty reference if splice is not enabled.
+  OptRef<SplicePipePool> splicePipePool() {
+    return splice_pipe_pool_slot_ != nullptr
+               ? makeOptRef(splice_pipe_pool_slot_->getTyped<SplicePipePool>())
+               : OptRef<SplicePipePool>();
+  }
 
 private:
   struct SimpleRouteImpl : public Route {
@@ -430,6 +438,7 @@ private:
   AccessLog::InstanceSharedPtrVector access_logs_;
   const uint32_t max_connect_attempts_;
   ThreadLocal::SlotPtr upstream_drain_manager_slot_;
+  ThreadLocal::SlotPtr splice_pipe_pool_slot_;
   SharedConfigSharedPtr shared_config_;
   std::unique_ptr<const Router::MetadataMatchCriteria> cluster_metadata_match_criteria_;
   Random::RandomGenerator& random_generator_;
@@ -467,7 +476,8 @@ private:
 class Filter : public Network::ReadFilter,
                public Upstream::LoadBalancerContextBase,
                protected Logger::Loggable<Logger::Id::filter>,
-               public GenericConnectionPoolCallbacks {
+               public GenericConnectionPoolCallbacks,
+               public SpliceForwarderCallbacks {
 public:
   Filter(ConfigSharedPtr config, Upstream::ClusterManager& cluster_manager);
   ~Filter() override;
@@ -487,6 +497,11 @@ public:
                             absl::string_view failure_reason,
                             Upstream::HostDescriptionConstSharedPtr host) override;
 
+  // SpliceForwarderCallbacks
+  void onSplicedBytes(bool downstream_to_upstream, uint64_t bytes) override;
+  void onSpliceComplete() override;
+  void onSpliceError() override;
+
   // Upstream::LoadBalancerContext
   const Router::MetadataMatchCriteria* metadataMatchCriteria() override;
   absl::optional<uint64_t> computeHashKey() override {
@@ -700,6 +715,9 @@ protected:
   void onUpstreamEvent(Network::ConnectionEvent event);
   void maybeCloseDownstreamForDrainClose();
   void onUpstreamConnection();
+  // Hands the established connections over to a SpliceForwarder if splice is enabled and both
+  // sides carry plaintext bytes. Returns true if the forwarder was started.
+  bool maybeStartSplice();
   void onIdleTimeout();
   void resetIdleTimer();
   void disableIdleTimer();
@@ -770,6 +788,8 @@ protected:
   bool read_disabled_due_to_buffer_{false}; // Track if we disabled reading due to buffer overflow.
   uint32_t max_buffered_bytes_{65536};      // Default 64KB.
   bool delay_route_selection_{false};
+  // Set while payload is moved with splice(2) instead of through the connection buffers.
+  SpliceForwarderPtr splice_forwarder_;
 };
 
 // This class deals with an upstream connection that needs to finish flushing, when the downstream
@@ -65,6 +65,7 @@ public:
   AccessLog::AccessLogManager& accessLogManager() const override {
     return factory_context_.serverFactoryContext().accessLogManager();
   }
+  bool kernelTlsOffload() const override { return kernel_tls_offload_; }
 
   bool isReady() const override {
     const bool tls_is_ready =
@@ -137,6 +138,7 @@ private:
   const absl::optional<
       envoy::extensions::transport_sockets::tls::v3::TlsParameters::CompliancePolicy>
       compliance_policy_;
+  const bool kernel_tls_offload_;
 };
 
 class ClientContextConfigImpl : public ContextConfigImpl, public Envoy::Ssl::ClientContextConfig {
@@ -0,0 +1,316 @@
+#include "source/common/tls/ktls.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "source/common/api/os_sys_calls_impl.h"
+#include "source/common/common/assert.h"
+#include "source/common/common/utility.h"
+#include "source/common/network/io_socket_error_impl.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "openssl/hkdf.h"
+#include "openssl/mem.h"
+
+#ifdef __linux__
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace Ktls {
+
+#ifdef __linux__
+
+namespace {
+
+// Size of the nonce of all AEADs supported by the kernel TLS record layer.
+constexpr size_t AeadNonceSize = 12;
+
+struct CipherParams {
+  uint16_t kernel_cipher_type_;
+  size_t key_size_;
+  // Size of the implicit part of the nonce derived from the TLS 1.2 key block. The remainder of
+  // the nonce is explicit and carried in each record.
+  size_t tls12_fixed_iv_size_;
+};
+
+const CipherParams* cipherParams(const SSL* ssl) {
+  static const CipherParams aes_128_gcm{TLS_CIPHER_AES_GCM_128, 16, 4};
+  static const CipherParams aes_256_gcm{TLS_CIPHER_AES_GCM_256, 32, 4};
+  static const CipherParams chacha20_poly1305{TLS_CIPHER_CHACHA20_POLY1305, 32, 12};
+
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  if (cipher == nullptr) {
+    return nullptr;
+  }
+  switch (SSL_CIPHER_get_cipher_nid(cipher)) {
+  case NID_aes_128_gcm:
+    return &aes_128_gcm;
+  case NID_aes_256_gcm:
+    return &aes_256_gcm;
+  case NID_chacha20_poly1305:
+    return &chacha20_poly1305;
+  default:
+    return nullptr;
+  }
+}
+
+// Implements HKDF-Expand-Label with an empty context, see
+// https://www.rfc-editor.org/rfc/rfc8446#section-7.1.
+bool hkdfExpandLabel(const EVP_MD* digest, absl::Span<const uint8_t> secret,
+                     absl::string_view label, absl::Span<uint8_t> out) {
+  constexpr absl::string_view LabelPrefix = "tls13 ";
+  std::vector<uint8_t> info;
+  info.reserve(4 + LabelPrefix.size() + label.size());
+  info.push_back(static_cast<uint8_t>(out.size() >> 8));
+  info.push_back(static_cast<uint8_t>(out.size()));
+  info.push_back(static_cast<uint8_t>(LabelPrefix.size() + label.size()));
+  info.insert(info.end(), LabelPrefix.begin(), LabelPrefix.end());
+  info.insert(info.end(), label.begin(), label.end());
+  info.push_back(0);
+  return HKDF_expand(out.data(), out.size(), digest, secret.data(), secret.size(), info.data(),
+                     info.size()) == 1;
+}
+
+// Writes sequence as a big-endian integer filling out.
+void writeSequence(uint64_t sequence, absl::Span<uint8_t> out) {
+  for (size_t i = 0; i < out.size(); ++i) {
+    out[i] = static_cast<uint8_t>(sequence >> (8 * (out.size() - 1 - i)));
+  }
+}
+
+// Copies the key, the nonce and the sequence number into one of the kernel's
+// tls12_crypto_info_* structures. The nonce is split into the implicit salt and the iv the same
+// way for both protocol versions.
+template <class CryptoInfo>
+void fillCryptoInfo(CryptoInfo& info, uint16_t version, uint16_t cipher_type,
+                    absl::Span<const uint8_t> key, absl::Span<const uint8_t> nonce,
+                    uint64_t sequence) {
+  static_assert(sizeof(info.salt) + sizeof(info.iv) == AeadNonceSize);
+  ASSERT(key.size() == sizeof(info.key));
+  ASSERT(nonce.size() == AeadNonceSize);
+  info.info.version = version;
+  info.info.cipher_type = cipher_type;
+  memcpy(info.key, key.data(), sizeof(info.key));
+  memcpy(info.salt, nonce.data(), sizeof(info.salt));
+  memcpy(info.iv, nonce.data() + sizeof(info.salt), sizeof(info.iv));
+  writeSequence(sequence, absl::MakeSpan(info.rec_seq));
+}
+
+template <class CryptoInfo>
+absl::Status setCryptoInfo(Network::IoHandle& io_handle, Direction direction, uint16_t version,
+                           uint16_t cipher_type, absl::Span<const uint8_t> key,
+                           absl::Span<const uint8_t> nonce, uint64_t sequence) {
+  CryptoInfo info{};
+  fillCryptoInfo(info, version, cipher_type, key, nonce, sequence);
+  const Api::SysCallIntResult result = io_handle.setOption(
+      SOL_TLS, direction == Direction::Tx ? TLS_TX : TLS_RX, &info, sizeof(info));
+  OPENSSL_cleanse(&info, sizeof(info));
+  if (result.return_value_ != 0) {
+    return absl::InternalError(
+        absl::StrCat("setsockopt(SOL_TLS) failed: ", errorDetails(result.errno_)));
+  }
+  return absl::OkStatus();
+}
+
+} // namespace
+
+bool isOffloadSupported(const SSL* ssl) {
+  const uint16_t version = SSL_version(ssl);
+  return (version == TLS1_2_VERSION || version == TLS1_3_VERSION) && cipherParams(ssl) != nullptr;
+}
+
+absl::Status attachUlp(Network::IoHandle& io_handle) {
+  static constexpr char UlpName[] = "tls";
+  const Api::SysCallIntResult result =
+      io_handle.setOption(IPPROTO_TCP, TCP_ULP, UlpName, sizeof(UlpName));
+  if (result.return_value_ != 0) {
+    return absl::UnavailableError(
+        absl::StrCat("setsockopt(TCP_ULP) failed: ", errorDetails(result.errno_)));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status installKeys(const SSL* ssl, Network::IoHandle& io_handle, Direction direction) {
+  const CipherParams* params = cipherParams(ssl);
+  if (params == nullptr) {
+    return absl::UnimplementedError("cipher is not supported by kernel TLS");
+  }
+
+  std::vector<uint8_t> key(params->key_size_);
+  std::array<uint8_t, AeadNonceSize> nonce;
+  uint16_t kernel_version;
+  const uint64_t sequence =
+      direction == Direction::Tx ? SSL_get_write_sequence(ssl) : SSL_get_read_sequence(ssl);
+
+  switch (SSL_version(ssl)) {
+  case TLS1_3_VERSION: {
+    bssl::Span<const uint8_t> read_secret;
+    bssl::Span<const uint8_t> write_secret;
+    if (!bssl::SSL_get_traffic_secrets(ssl, &read_secret, &write_secret)) {
+      return absl::InternalError("unable to obtain the TLS 1.3 traffic secrets");
+    }
+    const bssl::Span<const uint8_t> secret =
+        direction == Direction::Tx ? write_secret : read_secret;
+    const EVP_MD* digest = SSL_CIPHER_get_handshake_digest(SSL_get_current_cipher(ssl));
+    const absl::Span<const uint8_t> secret_span(secret.data(), secret.size());
+    if (!hkdfExpandLabel(digest, secret_span, "key", absl::MakeSpan(key)) ||
+        !hkdfExpandLabel(digest, secret_span, "iv", absl::MakeSpan(nonce))) {
+      return absl::InternalError("unable to derive the TLS 1.3 traffic keys");
+    }
+    kernel_version = TLS_1_3_VERSION;
+    break;
+  }
+  case TLS1_2_VERSION: {
+    // For AEAD ciphers the key block is client_write_key, server_write_key, client_write_IV and
+    // server_write_IV, see https://www.rfc-editor.org/rfc/rfc5246#section-6.3.
+    const size_t key_block_size = SSL_get_key_block_len(ssl);
+    if (key_block_size != 2 * (params->key_size_ + params->tls12_fixed_iv_size_)) {
+      return absl::InternalError("unexpected TLS 1.2 key block size");
+    }
+    std::vector<uint8_t> key_block(key_block_size);
+    if (!SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+      return absl::InternalError("unable to generate the TLS 1.2 key block");
+    }
+    // Clients transmit, and servers receive, with the client keys.
+    const bool client_keys = (direction == Direction::Tx) != static_cast<bool>(SSL_is_server(ssl));
+    const uint8_t* key_start = key_block.data() + (client_keys ? 0 : params->key_size_);
+    const uint8_t* iv_start = key_block.data() + 2 * params->key_size_ +
+                              (client_keys ? 0 : params->tls12_fixed_iv_size_);
+    memcpy(key.data(), key_start, params->key_size_);
+    memcpy(nonce.data(), iv_start, params->tls12_fixed_iv_size_);
+    // The explicit part of the nonce only needs to be unique per record, so the kernel starts it
+    // at the sequence number and increments it with every record, like BoringSSL does.
+    writeSequence(sequence, absl::MakeSpan(nonce).subspan(params->tls12_fixed_iv_size_));
+    OPENSSL_cleanse(key_block.data(), key_block.size());
+    kernel_version = TLS_1_2_VERSION;
+    break;
+  }
+  default:
+    return absl::UnimplementedError("protocol version is not supported by kernel TLS");
+  }
+
+  absl::Status status;
+  switch (params->kernel_cipher_type_) {
+  case TLS_CIPHER_AES_GCM_128:
+    status = setCryptoInfo<tls12_crypto_info_aes_gcm_128>(io_handle, direction, kernel_version,
+                                                          params->kernel_cipher_type_, key,
+                                                          nonce, sequence);
+    break;
+  case TLS_CIPHER_AES_GCM_256:
+    status = setCryptoInfo<tls12_crypto_info_aes_gcm_256>(io_handle, direction, kernel_version,
+                                                          params->kernel_cipher_type_, key,
+                                                          nonce, sequence);
+    break;
+  default:
+    ASSERT(params->kernel_cipher_type_ == TLS_CIPHER_CHACHA20_POLY1305);
+    status = setCryptoInfo<tls12_crypto_info_chacha20_poly1305>(
+        io_handle, direction, kernel_version, params->kernel_cipher_type_, key, nonce, sequence);
+    break;
+  }
+  OPENSSL_cleanse(key.data(), key.size());
+  OPENSSL_cleanse(nonce.data(), nonce.size());
+  return status;
+}
+
+Api::IoCallUint64Result readRecord(Network::IoHandle& io_handle, uint8_t& record_type,
+                                   Buffer::Instance& buffer) {
+  Buffer::Reservation reservation = buffer.reserveSingleSlice(MaxRecordPlaintextSize);
+  iovec iov;
+  iov.iov_base = reservation.slice().mem_;
+  iov.iov_len = reservation.slice().len_;
+  alignas(cmsghdr) char cbuf[CMSG_SPACE(sizeof(record_type))];
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cbuf;
+  msg.msg_controllen = sizeof(cbuf);
+
+  const Api::SysCallSizeResult result =
+      Api::OsSysCallsSingleton::get().recvmsg(io_handle.fdDoNotUse(), &msg, 0);
+  if (result.return_value_ < 0) {
+    return {0, result.errno_ == SOCKET_ERROR_AGAIN
+                   ? Network::IoSocketError::getIoSocketEagainError()
+                   : Network::IoSocketError::create(result.errno_)};
+  }
+
+  // Records without a type control message carry application data.
+  record_type = RecordTypeApplicationData;
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_TLS && cmsg->cmsg_type == TLS_GET_RECORD_TYPE) {
+      record_type = *reinterpret_cast<uint8_t*>(CMSG_DATA(cmsg));
+    }
+  }
+  reservation.commit(result.return_value_);
+  return {static_cast<uint64_t>(result.return_value_), Api::IoError::none()};
+}
+
+Api::IoCallUint64Result sendAlert(Network::IoHandle& io_handle, uint8_t level,
+                                  uint8_t description) {
+  uint8_t alert[2] = {level, description};
+  iovec iov;
+  iov.iov_base = alert;
+  iov.iov_len = sizeof(alert);
+  alignas(cmsghdr) char cbuf[CMSG_SPACE(sizeof(uint8_t))] = {};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cbuf;
+  msg.msg_controllen = sizeof(cbuf);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *reinterpret_cast<uint8_t*>(CMSG_DATA(cmsg)) = RecordTypeAlert;
+
+  const Api::SysCallSizeResult result =
+      Api::OsSysCallsSingleton::get().sendmsg(io_handle.fdDoNotUse(), &msg, 0);
+  if (result.return_value_ < 0) {
+    return {0, result.errno_ == SOCKET_ERROR_AGAIN
+                   ? Network::IoSocketError::getIoSocketEagainError()
+                   : Network::IoSocketError::create(result.errno_)};
+  }
+  return {static_cast<uint64_t>(result.return_value_), Api::IoError::none()};
+}
+
+#else
+
+bool isOffloadSupported(const SSL*) { return false; }
+
+absl::Status attachUlp(Network::IoHandle&) {
+  return absl::UnimplementedError("kernel TLS is only supported on Linux");
+}
+
+absl::Status installKeys(const SSL*, Network::IoHandle&, Direction) {
+  return absl::UnimplementedError("kernel TLS is only supported on Linux");
+}
+
+Api::IoCallUint64Result readRecord(Network::IoHandle&, uint8_t&, Buffer::Instance&) {
+  return {0, Network::IoSocketError::create(SOCKET_ERROR_NOT_SUP)};
+}
+
+Api::IoCallUint64Result sendAlert(Network::IoHandle&, uint8_t, uint8_t) {
+  return {0, Network::IoSocketError::create(SOCKET_ERROR_NOT_SUP)};
+}
+
+#endif
+
+} // namespace Ktls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+#include "envoy/api/io_error.h"
+#include "envoy/buffer/buffer.h"
+#include "envoy/network/io_handle.h"
+
+#include "absl/status/status.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace Ktls {
+
+// TLS record content types, see https://www.rfc-editor.org/rfc/rfc8446#section-5.1.
+constexpr uint8_t RecordTypeAlert = 21;
+constexpr uint8_t RecordTypeHandshake = 22;
+constexpr uint8_t RecordTypeApplicationData = 23;
+
+// Largest plaintext carried by a single TLS record.
+constexpr uint64_t MaxRecordPlaintextSize = 16384;
+
+enum class Direction { Rx, Tx };
+
+/**
+ * @return true if the negotiated protocol version and cipher of a completed handshake can be
+ * handled by the kernel TLS record layer on this platform.
+ */
+bool isOffloadSupported(const SSL* ssl);
+
+/**
+ * Attaches the kernel "tls" upper layer protocol to a connected TCP socket. Until keys are
+ * installed for a direction, data in that direction passes through unmodified.
+ * @param io_handle the connected socket.
+ * @return absl::OkStatus() on success.
+ */
+absl::Status attachUlp(Network::IoHandle& io_handle);
+
+/**
+ * Installs the record protection keys and the current sequence number of one direction of a
+ * completed TLS 1.2 or TLS 1.3 handshake into the kernel. Once this succeeds, BoringSSL must no
+ * longer be used for that direction of the connection.
+ * @param ssl the connection whose handshake completed.
+ * @param io_handle the socket the "tls" upper layer protocol has been attached to.
+ * @param direction the direction to offload.
+ * @return absl::OkStatus() on success. On failure the direction keeps being handled by BoringSSL.
+ */
+absl::Status installKeys(const SSL* ssl, Network::IoHandle& io_handle, Direction direction);
+
+/**
+ * Receives a single record from a socket whose receive direction has been offloaded. This is
+ * used once a plain read failed with EIO, which is how the kernel signals that the next record
+ * is not application data.
+ * @param io_handle the offloaded socket.
+ * @param record_type supplies the content type of the received record.
+ * @param buffer supplies the decrypted payload of the received record.
+ * @return the size of the payload or the error of the underlying recvmsg().
+ */
+Api::IoCallUint64Result readRecord(Network::IoHandle& io_handle, uint8_t& record_type,
+                                   Buffer::Instance& buffer);
+
+/**
+ * Sends an alert record through a socket whose transmit direction has been offloaded.
+ * @param io_handle the offloaded socket.
+ * @param level the alert level, e.g. SSL3_AL_WARNING.
+ * @param description the alert description, e.g. SSL_AD_CLOSE_NOTIFY.
+ * @return the number of bytes written or the error of the underlying sendmsg().
+ */
+Api::IoCallUint64Result sendAlert(Network::IoHandle& io_handle, uint8_t level,
+                                  uint8_t description);
+
+} // namespace Ktls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
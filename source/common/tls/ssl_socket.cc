@@ -2,12 +2,14 @@
 
 #include "envoy/stats/scope.h"
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/empty_string.h"
 #include "source/common/common/hex.h"
 #include "source/common/http/headers.h"
 #include "source/common/runtime/runtime_features.h"
 #include "source/common/tls/io_handle_bio.h"
+#include "source/common/tls/ktls.h"
 #include "source/common/tls/ssl_handshaker.h"
 #include "source/common/tls/utility.h"
 
@@ -118,6 +120,10 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
     }
   }
 
+  if (ktls_rx_) {
+    return doKtlsRead(read_buffer);
+  }
+
   bool keep_reading = true;
   bool end_stream = false;
   PostIoAction action = PostIoAction::KeepOpen;
@@ -192,6 +198,9 @@ Network::Connection& SslSocket::connection() const { return callbacks_->connecti
 
 void SslSocket::onSuccess(SSL* ssl) {
   ctx_->logHandshake(ssl);
+  if (ctx_->kernelTlsOffload()) {
+    enableKernelTlsOffload();
+  }
   if (callbacks_->connection().streamInfo().upstreamInfo()) {
     callbacks_->connection()
         .streamInfo()
@@ -207,6 +216,160 @@ void SslSocket::onSuccess(SSL* ssl) {
 
 void SslSocket::onFailure() { drainErrorQueue(); }
 
+void SslSocket::enableKernelTlsOffload() {
+  SSL* ssl = rawSsl();
+  // Records that BoringSSL already read from the socket cannot be handed over to the kernel.
+  if (!Ktls::isOffloadSupported(ssl) || SSL_has_pending(ssl)) {
+    ENVOY_CONN_LOG(debug, "kTLS: negotiated parameters can not be offloaded",
+                   callbacks_->connection());
+    ctx_->stats().ktls_not_offloaded_.inc();
+    return;
+  }
+
+  // The receive direction is offloaded first: if the transmit direction fails afterwards,
+  // BoringSSL still owns a consistent write state. The reverse would leave BoringSSL unable to
+  // answer post-handshake messages it reads.
+  Network::IoHandle& io_handle = callbacks_->ioHandle();
+  absl::Status status = Ktls::attachUlp(io_handle);
+  if (status.ok()) {
+    status = Ktls::installKeys(ssl, io_handle, Ktls::Direction::Rx);
+  }
+  if (!status.ok()) {
+    ENVOY_CONN_LOG(debug, "kTLS: unable to offload receive direction: {}",
+                   callbacks_->connection(), status.message());
+    ctx_->stats().ktls_not_offloaded_.inc();
+    return;
+  }
+  ktls_rx_ = true;
+  ctx_->stats().ktls_rx_offloaded_.inc();
+
+  status = Ktls::installKeys(ssl, io_handle, Ktls::Direction::Tx);
+  if (!status.ok()) {
+    ENVOY_CONN_LOG(debug, "kTLS: unable to offload transmit direction: {}",
+                   callbacks_->connection(), status.message());
+    return;
+  }
+  ktls_tx_ = true;
+  ctx_->stats().ktls_tx_offloaded_.inc();
+}
+
+Network::IoResult SslSocket::doKtlsRead(Buffer::Instance& read_buffer) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  absl::optional<Api::IoError::IoErrorCode> err;
+  do {
+    Api::IoCallUint64Result result = callbacks_->ioHandle().read(read_buffer, absl::nullopt);
+    if (result.ok()) {
+      ENVOY_CONN_LOG(trace, "kTLS read returns: {}", callbacks_->connection(),
+                     result.return_value_);
+      if (result.return_value_ == 0) {
+        // Non-graceful shutdown by closing the underlying socket.
+        end_stream = true;
+        break;
+      }
+      bytes_read += result.return_value_;
+    } else if (result.err_->getSystemErrorCode() == EIO) {
+      // The kernel refuses to return records that are not application data through read().
+      const KtlsRecordAction record_action = onKtlsNonDataRecord(read_buffer, bytes_read);
+      if (record_action == KtlsRecordAction::EndStream) {
+        end_stream = true;
+        break;
+      }
+      if (record_action == KtlsRecordAction::Close) {
+        action = PostIoAction::Close;
+        break;
+      }
+      continue;
+    } else {
+      ENVOY_CONN_LOG(trace, "kTLS read error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() != Api::IoError::IoErrorCode::Again) {
+        action = PostIoAction::Close;
+        err = result.err_->getErrorCode();
+      }
+      break;
+    }
+    if (callbacks_->shouldDrainReadBuffer()) {
+      callbacks_->setTransportSocketIsReadable();
+      break;
+    }
+  } while (true);
+
+  return {action, bytes_read, end_stream, err};
+}
+
+SslSocket::KtlsRecordAction SslSocket::onKtlsNonDataRecord(Buffer::Instance& read_buffer,
+                                                           uint64_t& bytes_read) {
+  uint8_t record_type;
+  Buffer::OwnedImpl record;
+  Api::IoCallUint64Result result = Ktls::readRecord(callbacks_->ioHandle(), record_type, record);
+  if (!result.ok()) {
+    failure_reason_ = absl::StrCat("TLS_error:kTLS:", result.err_->getErrorDetails());
+    ctx_->stats().connection_error_.inc();
+    return KtlsRecordAction::Close;
+  }
+
+  switch (record_type) {
+  case Ktls::RecordTypeApplicationData:
+    bytes_read += record.length();
+    read_buffer.move(record);
+    return KtlsRecordAction::Continue;
+  case Ktls::RecordTypeAlert:
+    // Graceful shutdown using close_notify TLS alert.
+    if (record.length() == 2 && record.peekBEInt<uint8_t>(1) == SSL_AD_CLOSE_NOTIFY) {
+      return KtlsRecordAction::EndStream;
+    }
+    failure_reason_ = "TLS_error:kTLS:received alert";
+    break;
+  case Ktls::RecordTypeHandshake:
+    // Session tickets sent by TLS 1.3 servers after the handshake are dropped, since they can no
+    // longer be processed by BoringSSL. Anything else would require re-keying the kernel.
+    if (!SSL_is_server(rawSsl()) && SSL_version(rawSsl()) == TLS1_3_VERSION &&
+        record.length() > 0 && record.peekBEInt<uint8_t>() == SSL3_MT_NEW_SESSION_TICKET) {
+      ENVOY_CONN_LOG(trace, "kTLS: dropping session ticket", callbacks_->connection());
+      return KtlsRecordAction::Continue;
+    }
+    failure_reason_ = "TLS_error:kTLS:unsupported post-handshake message";
+    break;
+  default:
+    failure_reason_ =
+        absl::StrCat("TLS_error:kTLS:unexpected record type ", static_cast<int>(record_type));
+    break;
+  }
+  ENVOY_CONN_LOG(debug, "{}", callbacks_->connection(), failure_reason_);
+  ctx_->stats().connection_error_.inc();
+  return KtlsRecordAction::Close;
+}
+
+Network::IoResult SslSocket::doKtlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_written = 0;
+  absl::optional<Api::IoError::IoErrorCode> err;
+  while (write_buffer.length() > 0) {
+    Api::IoCallUint64Result result = callbacks_->ioHandle().write(write_buffer);
+    if (result.ok()) {
+      ENVOY_CONN_LOG(trace, "kTLS write returns: {}", callbacks_->connection(),
+                     result.return_value_);
+      bytes_written += result.return_value_;
+    } else {
+      ENVOY_CONN_LOG(trace, "kTLS write error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() != Api::IoError::IoErrorCode::Again) {
+        err = result.err_->getErrorCode();
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+  }
+
+  if (write_buffer.length() == 0 && end_stream) {
+    shutdownSsl();
+  }
+
+  return {action, bytes_written, false, err};
+}
+
 PostIoAction SslSocket::doHandshake() { return info_->doHandshake(); }
 
 void SslSocket::drainErrorQueue() {
@@ -290,6 +453,10 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  if (ktls_tx_) {
+    return doKtlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
@@ -348,6 +515,15 @@ void SslSocket::shutdownSsl() {
   ASSERT(info_->state() != Ssl::SocketState::PreHandshake);
   if (info_->state() != Ssl::SocketState::ShutdownSent &&
       callbacks_->connection().state() != Network::Connection::State::Closed) {
+    if (ktls_tx_) {
+      // BoringSSL no longer owns the write sequence number, so the kernel sends close_notify.
+      Api::IoCallUint64Result result =
+          Ktls::sendAlert(callbacks_->ioHandle(), SSL3_AL_WARNING, SSL_AD_CLOSE_NOTIFY);
+      ENVOY_CONN_LOG(debug, "kTLS shutdown: {}", callbacks_->connection(),
+                     result.ok() ? "ok" : result.err_->getErrorDetails());
+      info_->setState(Ssl::SocketState::ShutdownSent);
+      return;
+    }
     int rc = SSL_shutdown(rawSsl());
     if constexpr (Event::PlatformDefaultTriggerType == Event::FileTriggerType::EmulatedEdge) {
       // Windows operate under `EmulatedEdge`. These are level events that are artificially
@@ -93,7 +93,14 @@ private:
   };
   ReadResult sslReadIntoSlice(Buffer::RawSlice& slice);
 
+  // Outcome of handling a record that is not application data on a kernel TLS socket.
+  enum class KtlsRecordAction { Continue, EndStream, Close };
+
   Network::PostIoAction doHandshake();
+  void enableKernelTlsOffload();
+  Network::IoResult doKtlsRead(Buffer::Instance& read_buffer);
+  Network::IoResult doKtlsWrite(Buffer::Instance& write_buffer, bool end_stream);
+  KtlsRecordAction onKtlsNonDataRecord(Buffer::Instance& read_buffer, uint64_t& bytes_read);
   void drainErrorQueue();
   void shutdownSsl();
   void shutdownBasic();
@@ -105,6 +112,10 @@ private:
   uint64_t bytes_to_retry_{};
   std::string failure_reason_;
   absl::optional<Api::IoError::IoErrorCode> detected_io_error_;
+  // Set once the receive/transmit record layer has been handed to kernel TLS. The transmit
+  // direction is only ever offloaded together with the receive direction.
+  bool ktls_rx_{};
+  bool ktls_tx_{};
 
   SslHandshakerImplSharedPtr info_;
 };
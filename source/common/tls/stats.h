@@ -20,7 +20,10 @@ namespace Tls {
   COUNTER(ocsp_staple_failed)                                                                      \
   COUNTER(ocsp_staple_omitted)                                                                     \
   COUNTER(ocsp_staple_responses)                                                                   \
-  COUNTER(ocsp_staple_requests)
+  COUNTER(ocsp_staple_requests)                                                                    \
+  COUNTER(ktls_rx_offloaded)                                                                       \
+  COUNTER(ktls_tx_offloaded)                                                                       \
+  COUNTER(ktls_not_offloaded)
 /**
  * Wrapper struct for SSL stats. @see stats_macros.h
  */
@@ -1122,8 +1122,9 @@ void ClusterManagerImpl::postThreadLocalRemoveHosts(const Cluster& cluster,
   // Drain the connection pools for the given hosts. For deferred clusters have
   // been created.
   tls_.runOnAllThreads([name = cluster.info()->name(),
-                        hosts_removed](OptRef<ThreadLocalClusterManagerImpl> cluster_manager) {
-    cluster_manager->removeHosts(name, hosts_removed);
+                        hosts_removed = std::make_shared<const HostVector>(hosts_removed)](
+                           OptRef<ThreadLocalClusterManagerImpl> cluster_manager) {
+    cluster_manager->removeHosts(name, *hosts_removed);
   });
 }
 
@@ -1196,7 +1197,10 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(ClusterManagerCluster& cm_
                                                         load_balancer_factory, host_map,
                                                         drop_overload, drop_category);
 
-  tls_.runOnAllThreads([info = cm_cluster.cluster().info(), params = std::move(params),
+  // The callback below is copied into the queue of every worker. Share the update between them,
+  // so that posting it does not copy the added and removed hosts once per worker.
+  auto shared_params = std::make_shared<const ThreadLocalClusterUpdateParams>(std::move(params));
+  tls_.runOnAllThreads([info = cm_cluster.cluster().info(), params = std::move(shared_params),
                         add_or_update_cluster, load_balancer_factory, map = std::move(host_map),
                         cluster_initialization_object = std::move(cluster_initialization_object),
                         drop_overload, drop_category = std::move(drop_category)](
@@ -1260,7 +1264,7 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(ClusterManagerCluster& cm_
         cluster_manager->thread_local_clusters_[info->name()]->setDropOverload(drop_overload);
         cluster_manager->thread_local_clusters_[info->name()]->setDropCategory(drop_category);
       }
-      for (const auto& per_priority : params.per_priority_update_params_) {
+      for (const auto& per_priority : params->per_priority_update_params_) {
         cluster_manager->updateClusterMembership(
             info->name(), per_priority.priority_, per_priority.update_hosts_params_,
             per_priority.locality_weights_, per_priority.hosts_added_, per_priority.hosts_removed_,
@@ -1,5 +1,6 @@
 #include "source/common/upstream/upstream_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <limits>
@@ -806,6 +807,15 @@ void HostSetImpl::updateHosts(PrioritySet::UpdateHostsParams&& update_hosts_para
   degraded_hosts_per_locality_ = std::move(update_hosts_params.degraded_hosts_per_locality);
   excluded_hosts_per_locality_ = std::move(update_hosts_params.excluded_hosts_per_locality);
   locality_weights_ = std::move(locality_weights);
+  if (update_hosts_params.host_weights_are_equal.has_value()) {
+    host_weights_are_equal_ = update_hosts_params.host_weights_are_equal.value();
+  } else {
+    host_weights_are_equal_ = std::all_of(
+        hosts_->begin(), hosts_->end(),
+        [weight = hosts_->empty() ? 0 : hosts_->front()->weight()](const HostSharedPtr& host) {
+          return host->weight() == weight;
+        });
+  }
 
   runUpdateCallbacks(hosts_added, hosts_removed);
 }
@@ -826,14 +836,19 @@ HostSetImpl::updateHostsParams(HostVectorConstSharedPtr hosts,
                                         std::move(hosts_per_locality),
                                         std::move(healthy_hosts_per_locality),
                                         std::move(degraded_hosts_per_locality),
-                                        std::move(excluded_hosts_per_locality)};
+                                        std::move(excluded_hosts_per_locality),
+                                        absl::nullopt};
 }
 
 PrioritySet::UpdateHostsParams HostSetImpl::updateHostsParams(const HostSet& host_set) {
-  return updateHostsParams(host_set.hostsPtr(), host_set.hostsPerLocalityPtr(),
-                           host_set.healthyHostsPtr(), host_set.healthyHostsPerLocalityPtr(),
-                           host_set.degradedHostsPtr(), host_set.degradedHostsPerLocalityPtr(),
-                           host_set.excludedHostsPtr(), host_set.excludedHostsPerLocalityPtr());
+  PrioritySet::UpdateHostsParams params = updateHostsParams(
+      host_set.hostsPtr(), host_set.hostsPerLocalityPtr(), host_set.healthyHostsPtr(),
+      host_set.healthyHostsPerLocalityPtr(), host_set.degradedHostsPtr(),
+      host_set.degradedHostsPerLocalityPtr(), host_set.excludedHostsPtr(),
+      host_set.excludedHostsPerLocalityPtr());
+  // The hosts are the same, so is their weight equality.
+  params.host_weights_are_equal = host_set.hostWeightsAreEqual();
+  return params;
 }
 PrioritySet::UpdateHostsParams
 HostSetImpl::partitionHosts(HostVectorConstSharedPtr hosts,
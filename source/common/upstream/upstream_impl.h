@@ -651,6 +651,7 @@ public:
   uint32_t priority() const override { return priority_; }
   uint32_t overprovisioningFactor() const override { return overprovisioning_factor_; }
   bool weightedPriorityHealth() const override { return weighted_priority_health_; }
+  bool hostWeightsAreEqual() const override { return host_weights_are_equal_; }
 
   static PrioritySet::UpdateHostsParams
   updateHostsParams(HostVectorConstSharedPtr hosts,
@@ -680,6 +681,7 @@ private:
   const uint32_t priority_;
   uint32_t overprovisioning_factor_;
   bool weighted_priority_health_;
+  bool host_weights_are_equal_{true};
   HostVectorConstSharedPtr hosts_;
   HealthyHostVectorConstSharedPtr healthy_hosts_;
   DegradedHostVectorConstSharedPtr degraded_hosts_;
@@ -113,6 +113,7 @@ protected:
         IS_ENVOY_BUG("Unexpected function call");
       }
       bool initializeReadFilters() override { return true; }
+      bool isSoleFilter(const Network::ReadFilter&) const override { return false; }
 
       // Network::Connection
       void addConnectionCallbacks(Network::ConnectionCallbacks& cb) override {
@@ -163,7 +164,11 @@ protected:
         return absl::nullopt;
       }
       void setConnectionStats(const Network::Connection::ConnectionStats&) override {}
+      void addDirectSocketBytes(uint64_t, uint64_t) override {
+        IS_ENVOY_BUG("Unexpected function call");
+      }
       Ssl::ConnectionInfoConstSharedPtr ssl() const override { return nullptr; }
+      bool hasPassthroughTransport() const override { return false; }
       absl::string_view requestedServerName() const override { return EMPTY_STRING; }
       State state() const override { return Network::Connection::State::Open; }
       bool connecting() const override { return false; }
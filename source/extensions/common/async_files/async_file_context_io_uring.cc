@@ -0,0 +1,403 @@
+#include "source/extensions/common/async_files/async_file_context_io_uring.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/sysmacros.h>
+#include <sys/uio.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/io/io_uring_impl.h"
+#include "source/extensions/common/async_files/async_file_action.h"
+#include "source/extensions/common/async_files/async_file_context_base.h"
+#include "source/extensions/common/async_files/async_file_manager_io_uring.h"
+#include "source/extensions/common/async_files/status_after_file_error.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+struct stat statFromStatx(const struct statx& statx_buf) {
+  struct stat ret {};
+  ret.st_dev = makedev(statx_buf.stx_dev_major, statx_buf.stx_dev_minor);
+  ret.st_ino = statx_buf.stx_ino;
+  ret.st_mode = statx_buf.stx_mode;
+  ret.st_nlink = statx_buf.stx_nlink;
+  ret.st_uid = statx_buf.stx_uid;
+  ret.st_gid = statx_buf.stx_gid;
+  ret.st_rdev = makedev(statx_buf.stx_rdev_major, statx_buf.stx_rdev_minor);
+  ret.st_size = statx_buf.stx_size;
+  ret.st_blksize = statx_buf.stx_blksize;
+  ret.st_blocks = statx_buf.stx_blocks;
+  ret.st_atim.tv_sec = statx_buf.stx_atime.tv_sec;
+  ret.st_atim.tv_nsec = statx_buf.stx_atime.tv_nsec;
+  ret.st_mtim.tv_sec = statx_buf.stx_mtime.tv_sec;
+  ret.st_mtim.tv_nsec = statx_buf.stx_mtime.tv_nsec;
+  ret.st_ctim.tv_sec = statx_buf.stx_ctime.tv_sec;
+  ret.st_ctim.tv_nsec = statx_buf.stx_ctime.tv_nsec;
+  return ret;
+}
+
+namespace {
+
+template <typename T>
+class AsyncFileActionIoUringContext : public AsyncFileActionIoUringWithResult<T> {
+public:
+  explicit AsyncFileActionIoUringContext(AsyncFileHandle handle,
+                                         absl::AnyInvocable<void(T)> on_complete)
+      : AsyncFileActionIoUringWithResult<T>(std::move(on_complete)), handle_(std::move(handle)) {}
+
+protected:
+  int& fileDescriptor() { return context()->fileDescriptor(); }
+  AsyncFileContextIoUring* context() const {
+    return static_cast<AsyncFileContextIoUring*>(handle_.get());
+  }
+
+  AsyncFileHandle handle_;
+};
+
+// Actions without an io_uring operation, performed on the blocking thread of the manager.
+template <typename T> class AsyncFileActionBlocking : public AsyncFileActionWithResult<T> {
+public:
+  explicit AsyncFileActionBlocking(AsyncFileHandle handle, absl::AnyInvocable<void(T)> on_complete)
+      : AsyncFileActionWithResult<T>(std::move(on_complete)), handle_(std::move(handle)) {}
+
+protected:
+  int& fileDescriptor() { return context()->fileDescriptor(); }
+  AsyncFileContextIoUring* context() const {
+    return static_cast<AsyncFileContextIoUring*>(handle_.get());
+  }
+
+  Api::OsSysCalls& posix() const { return context()->ioUringManager().posix(); }
+
+  AsyncFileHandle handle_;
+};
+
+class ActionStat : public AsyncFileActionIoUringContext<absl::StatusOr<struct stat>> {
+public:
+  ActionStat(AsyncFileHandle handle,
+             absl::AnyInvocable<void(absl::StatusOr<struct stat>)> on_complete)
+      : AsyncFileActionIoUringContext<absl::StatusOr<struct stat>>(handle,
+                                                                   std::move(on_complete)) {}
+
+  Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) override {
+    ASSERT(fileDescriptor() != -1);
+    return ring.prepareStatx(fileDescriptor(), "", AT_EMPTY_PATH, STATX_BASIC_STATS, &statx_buf_,
+                             request);
+  }
+
+  absl::StatusOr<struct stat> resultFromRing(int32_t result) override {
+    if (result < 0) {
+      return statusAfterFileError(-result);
+    }
+    return statFromStatx(statx_buf_);
+  }
+
+private:
+  struct statx statx_buf_ {};
+};
+
+class ActionCreateHardLink : public AsyncFileActionIoUringContext<absl::Status> {
+public:
+  ActionCreateHardLink(AsyncFileHandle handle, absl::string_view filename,
+                       absl::AnyInvocable<void(absl::Status)> on_complete)
+      : AsyncFileActionIoUringContext<absl::Status>(handle, std::move(on_complete)),
+        filename_(filename) {}
+
+  Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) override {
+    ASSERT(fileDescriptor() != -1);
+    procfile_ = absl::StrCat("/proc/self/fd/", fileDescriptor());
+    return ring.prepareLinkat(AT_FDCWD, procfile_.c_str(), AT_FDCWD, filename_.c_str(),
+                              AT_SYMLINK_FOLLOW, request);
+  }
+
+  absl::Status resultFromRing(int32_t result) override {
+    if (result < 0) {
+      return statusAfterFileError(-result);
+    }
+    return absl::OkStatus();
+  }
+
+  void onCancelledBeforeCallback() override {
+    if (result_.value().ok()) {
+      context()->ioUringManager().unlink(nullptr, filename_, [](absl::Status) {});
+    }
+  }
+  bool hasActionIfCancelledBeforeCallback() const override { return true; }
+
+private:
+  const std::string filename_;
+  std::string procfile_;
+};
+
+class ActionCloseFile : public AsyncFileActionIoUringContext<absl::Status> {
+public:
+  // Here we take a copy of the AsyncFileContext's file descriptor, because the close function
+  // sets the AsyncFileContext's file descriptor to -1. This way there will be no race of trying
+  // to use the handle again while the close is in flight.
+  explicit ActionCloseFile(AsyncFileHandle handle,
+                           absl::AnyInvocable<void(absl::Status)> on_complete)
+      : AsyncFileActionIoUringContext<absl::Status>(handle, std::move(on_complete)),
+        file_descriptor_(fileDescriptor()) {}
+
+  Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) override {
+    return ring.prepareClose(file_descriptor_, request);
+  }
+
+  absl::Status resultFromRing(int32_t result) override {
+    if (result < 0) {
+      return statusAfterFileError(-result);
+    }
+    return absl::OkStatus();
+  }
+
+private:
+  const int file_descriptor_;
+};
+
+class ActionReadFile
+    : public AsyncFileActionIoUringContext<absl::StatusOr<Buffer::InstancePtr>> {
+public:
+  ActionReadFile(AsyncFileHandle handle, off_t offset, size_t length,
+                 absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete)
+      : AsyncFileActionIoUringContext<absl::StatusOr<Buffer::InstancePtr>>(handle,
+                                                                           std::move(on_complete)),
+        offset_(offset), length_(length), buffer_(std::make_unique<Buffer::OwnedImpl>()),
+        reservation_(buffer_->reserveSingleSlice(length)) {}
+
+  Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) override {
+    ASSERT(fileDescriptor() != -1);
+    // The kernel reads straight into the reserved slice, which stays valid until the completion
+    // has been reaped as the action outlives the operation.
+    iov_.iov_base = reservation_.slice().mem_;
+    iov_.iov_len = length_;
+    return ring.prepareReadv(fileDescriptor(), &iov_, 1, offset_, request);
+  }
+
+  absl::StatusOr<Buffer::InstancePtr> resultFromRing(int32_t result) override {
+    if (result < 0) {
+      return statusAfterFileError(-result);
+    }
+    if (static_cast<size_t>(result) != length_) {
+      return std::make_unique<Buffer::OwnedImpl>(reservation_.slice().mem_, result);
+    }
+    reservation_.commit(result);
+    return std::move(buffer_);
+  }
+
+private:
+  const off_t offset_;
+  const size_t length_;
+  Buffer::InstancePtr buffer_;
+  Buffer::ReservationSingleSlice reservation_;
+  struct iovec iov_ {};
+};
+
+class ActionWriteFile : public AsyncFileActionIoUringContext<absl::StatusOr<size_t>> {
+public:
+  ActionWriteFile(AsyncFileHandle handle, Buffer::Instance& contents, off_t offset,
+                  absl::AnyInvocable<void(absl::StatusOr<size_t>)> on_complete)
+      : AsyncFileActionIoUringContext<absl::StatusOr<size_t>>(handle, std::move(on_complete)),
+        offset_(offset) {
+    contents_.move(contents);
+  }
+
+  Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) override {
+    ASSERT(fileDescriptor() != -1);
+    Buffer::RawSliceVector slices = contents_.getRawSlices();
+    if (slices.size() > IOV_MAX) {
+      // A single writev cannot take more slices than this, so copy them into one.
+      contents_.linearize(contents_.length());
+      slices = contents_.getRawSlices();
+    }
+    iovecs_.clear();
+    iovecs_.reserve(slices.size());
+    for (const Buffer::RawSlice& slice : slices) {
+      iovecs_.push_back({slice.mem_, slice.len_});
+    }
+    return ring.prepareWritev(fileDescriptor(), iovecs_.data(), iovecs_.size(), offset_ + written_,
+                              request);
+  }
+
+  // As in the thread pool, a short write is retried with the rest of the buffer until everything
+  // has been written or the kernel reports an error.
+  Completion onRingCompletion(int32_t result) override {
+    if (result > 0 && static_cast<size_t>(result) < contents_.length()) {
+      contents_.drain(result);
+      written_ += result;
+      return Completion::Resubmit;
+    }
+    if (result > 0) {
+      written_ += result;
+    }
+    return AsyncFileActionIoUringContext<absl::StatusOr<size_t>>::onRingCompletion(result);
+  }
+
+  absl::StatusOr<size_t> resultFromRing(int32_t result) override {
+    if (result < 0) {
+      return statusAfterFileError(-result);
+    }
+    return written_;
+  }
+
+private:
+  Buffer::OwnedImpl contents_;
+  const off_t offset_;
+  size_t written_ = 0;
+  std::vector<struct iovec> iovecs_;
+};
+
+// Truncates through the ring where the kernel supports it (Linux 6.9 and later), otherwise on the
+// blocking thread.
+class ActionTruncateFile : public AsyncFileActionIoUringContext<absl::Status> {
+public:
+  ActionTruncateFile(AsyncFileHandle handle, size_t length,
+                     absl::AnyInvocable<void(absl::Status)> on_complete)
+      : AsyncFileActionIoUringContext<absl::Status>(handle, std::move(on_complete)),
+        length_(length) {}
+
+  Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) override {
+    ASSERT(fileDescriptor() != -1);
+    return ring.prepareFtruncate(fileDescriptor(), length_, request);
+  }
+
+  absl::Status resultFromRing(int32_t result) override {
+    if (result < 0) {
+      return statusAfterFileError(-result);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status executeFallback() override {
+    ASSERT(fileDescriptor() != -1);
+    Api::SysCallIntResult result =
+        context()->ioUringManager().posix().ftruncate(fileDescriptor(), length_);
+    if (result.return_value_ == -1) {
+      return statusAfterFileError(result);
+    }
+    return absl::OkStatus();
+  }
+
+private:
+  const size_t length_;
+};
+
+class ActionDuplicateFile : public AsyncFileActionBlocking<absl::StatusOr<AsyncFileHandle>> {
+public:
+  ActionDuplicateFile(AsyncFileHandle handle,
+                      absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete)
+      : AsyncFileActionBlocking<absl::StatusOr<AsyncFileHandle>>(handle, std::move(on_complete)) {}
+
+  absl::StatusOr<AsyncFileHandle> executeImpl() override {
+    ASSERT(fileDescriptor() != -1);
+    auto newfd = posix().duplicate(fileDescriptor());
+    if (newfd.return_value_ == -1) {
+      return statusAfterFileError(newfd);
+    }
+    return std::make_shared<AsyncFileContextIoUring>(context()->ioUringManager(),
+                                                     newfd.return_value_);
+  }
+
+  void onCancelledBeforeCallback() override {
+    if (result_.value().ok()) {
+      result_.value().value()->close(nullptr, [](absl::Status) {}).IgnoreError();
+    }
+  }
+  bool hasActionIfCancelledBeforeCallback() const override { return true; }
+};
+
+} // namespace
+
+absl::StatusOr<CancelFunction> AsyncFileContextIoUring::stat(
+    Event::Dispatcher* dispatcher,
+    absl::AnyInvocable<void(absl::StatusOr<struct stat>)> on_complete) {
+  return checkFileAndSubmit(dispatcher,
+                            std::make_unique<ActionStat>(handle(), std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::createHardLink(Event::Dispatcher* dispatcher, absl::string_view filename,
+                                        absl::AnyInvocable<void(absl::Status)> on_complete) {
+  return checkFileAndSubmit(dispatcher, std::make_unique<ActionCreateHardLink>(
+                                            handle(), filename, std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::close(Event::Dispatcher* dispatcher,
+                               absl::AnyInvocable<void(absl::Status)> on_complete) {
+  auto ret = checkFileAndSubmit(
+      dispatcher, std::make_unique<ActionCloseFile>(handle(), std::move(on_complete)));
+  fileDescriptor() = -1;
+  return ret;
+}
+
+absl::StatusOr<CancelFunction> AsyncFileContextIoUring::read(
+    Event::Dispatcher* dispatcher, off_t offset, size_t length,
+    absl::AnyInvocable<void(absl::StatusOr<Buffer::InstancePtr>)> on_complete) {
+  return checkFileAndSubmit(dispatcher, std::make_unique<ActionReadFile>(handle(), offset, length,
+                                                                         std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::write(Event::Dispatcher* dispatcher, Buffer::Instance& contents,
+                               off_t offset,
+                               absl::AnyInvocable<void(absl::StatusOr<size_t>)> on_complete) {
+  return checkFileAndSubmit(dispatcher, std::make_unique<ActionWriteFile>(
+                                            handle(), contents, offset, std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction> AsyncFileContextIoUring::duplicate(
+    Event::Dispatcher* dispatcher,
+    absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) {
+  return checkFileAndEnqueue(
+      dispatcher, std::make_unique<ActionDuplicateFile>(handle(), std::move(on_complete)));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::truncate(Event::Dispatcher* dispatcher, size_t length,
+                                  absl::AnyInvocable<void(absl::Status)> on_complete) {
+  auto action = std::make_unique<ActionTruncateFile>(handle(), length, std::move(on_complete));
+  if (!ioUringManager().supportsFtruncate()) {
+    action->useFallback();
+  }
+  return checkFileAndSubmit(dispatcher, std::move(action));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::checkFileAndSubmit(Event::Dispatcher* dispatcher,
+                                            std::unique_ptr<AsyncFileActionIoUring> action) {
+  if (fileDescriptor() == -1) {
+    return absl::FailedPreconditionError("file was already closed");
+  }
+  return ioUringManager().submit(dispatcher, std::move(action));
+}
+
+absl::StatusOr<CancelFunction>
+AsyncFileContextIoUring::checkFileAndEnqueue(Event::Dispatcher* dispatcher,
+                                             std::unique_ptr<AsyncFileAction> action) {
+  if (fileDescriptor() == -1) {
+    return absl::FailedPreconditionError("file was already closed");
+  }
+  return enqueue(dispatcher, std::move(action));
+}
+
+AsyncFileManagerIoUring& AsyncFileContextIoUring::ioUringManager() const {
+  return static_cast<AsyncFileManagerIoUring&>(manager_);
+}
+
+AsyncFileContextIoUring::AsyncFileContextIoUring(AsyncFileManagerIoUring& manager, int fd)
+    : AsyncFileContextBase(manager), file_descriptor_(fd) {}
+
+AsyncFileContextIoUring::~AsyncFileContextIoUring() { ASSERT(file_descriptor_ == -1); }
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,493 @@
+#include "source/extensions/common/async_files/async_file_manager_io_uring.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "source/common/io/io_uring_impl.h"
+#include "source/extensions/common/async_files/async_file_action.h"
+#include "source/extensions/common/async_files/async_file_context_io_uring.h"
+#include "source/extensions/common/async_files/status_after_file_error.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+namespace {
+constexpr uint32_t DefaultSubmissionQueueSize = 256;
+} // namespace
+
+// The user data of an operation in the ring. It owns the action, and with it everything the
+// kernel reads from or writes to, until the completion of the operation has been handled.
+class AsyncFileManagerIoUring::Request : public Io::Request {
+public:
+  explicit Request(QueuedAction&& queued_action)
+      : Io::Request(RequestType::File), queued_action_(std::move(queued_action)) {}
+
+  AsyncFileActionIoUring& action() const {
+    return static_cast<AsyncFileActionIoUring&>(*queued_action_.action_);
+  }
+
+  QueuedAction queued_action_;
+};
+
+AsyncFileManagerIoUring::AsyncFileManagerIoUring(
+    const envoy::extensions::common::async_files::v3::AsyncFileManagerConfig& config,
+    Api::OsSysCalls& posix)
+    : submission_queue_size_(config.io_uring().submission_queue_size() > 0
+                                 ? config.io_uring().submission_queue_size()
+                                 : DefaultSubmissionQueueSize),
+      posix_(posix), supports_ftruncate_(Io::isIoUringOperationSupported(IORING_OP_FTRUNCATE)) {
+  if (!posix.supportsAllPosixFileOperations() || !Io::isIoUringSupported()) {
+    throw EnvoyException("AsyncFileManagerIoUring not supported");
+  }
+  ENVOY_LOG(info,
+            fmt::format("AsyncFileManagerIoUring created with id '{}', with {} submission entries",
+                        config.id(), submission_queue_size_));
+  {
+    absl::MutexLock lock(ring_mutex_);
+    ring_ = std::make_unique<Io::IoUringImpl>(submission_queue_size_, false);
+    event_fd_ = ring_->registerEventfd();
+  }
+  completion_thread_ = std::thread([this]() { completionThread(); });
+  blocking_thread_ = std::thread([this]() { blockingThread(); });
+}
+
+AsyncFileManagerIoUring::~AsyncFileManagerIoUring() ABSL_LOCKS_EXCLUDED(ring_mutex_) {
+  {
+    absl::MutexLock lock(ring_mutex_);
+    terminate_ = true;
+  }
+  // Wake the completion thread up; it exits once every operation has completed and the blocking
+  // thread is idle, after which the blocking thread exits too.
+  eventfd_write(event_fd_, 1);
+  completion_thread_.join();
+  blocking_thread_.join();
+  absl::MutexLock lock(ring_mutex_);
+  ring_->unregisterEventfd();
+  ::close(event_fd_);
+}
+
+std::string AsyncFileManagerIoUring::describe() const {
+  return absl::StrCat("io_uring_submission_queue_size = ", submission_queue_size_);
+}
+
+bool AsyncFileManagerIoUring::isIdle() const {
+  return in_flight_ == 0 && pending_.empty() && blocking_queue_.empty() && !blocking_busy_;
+}
+
+void AsyncFileManagerIoUring::waitForIdle() {
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(ring_mutex_) { return isIdle(); };
+  absl::MutexLock lock(ring_mutex_);
+  ring_mutex_.Await(absl::Condition(&condition));
+}
+
+CancelFunction AsyncFileManagerIoUring::submit(Event::Dispatcher* dispatcher,
+                                               std::unique_ptr<AsyncFileActionIoUring> action) {
+  if (action->usesFallback()) {
+    return enqueue(dispatcher, std::move(action));
+  }
+  QueuedAction entry{std::move(action), dispatcher};
+  auto cancel_func = [dispatcher, state = entry.state_]() {
+    ASSERT(dispatcher == nullptr || dispatcher->isThreadSafe());
+    state->store(QueuedAction::State::Cancelled);
+  };
+  // The operation is handed to the kernel right away, or as soon as there is room for it, so it
+  // can't be prevented from executing, only from calling back.
+  entry.state_->store(QueuedAction::State::Executing);
+  auto request = std::make_unique<Request>(std::move(entry));
+  absl::MutexLock lock(ring_mutex_);
+  // The completion queue has twice as many entries as the submission queue. Keeping at most that
+  // many operations in flight guarantees that it never overflows, so the operations beyond that
+  // wait until the completion thread has reaped earlier ones.
+  if (!pending_.empty() || in_flight_ >= 2 * submission_queue_size_ || !prepare(*request)) {
+    pending_.push_back(std::move(request));
+    return cancel_func;
+  }
+  ++in_flight_;
+  submitPrepared();
+  // The completion thread takes the ownership back once the operation has completed.
+  request.release();
+  return cancel_func;
+}
+
+bool AsyncFileManagerIoUring::prepare(Request& request) {
+  if (request.action().prepare(*ring_, &request) == Io::IoUringResult::Ok) {
+    return true;
+  }
+  // The submission queue is full, make room by submitting it and try again.
+  submitPrepared();
+  return request.action().prepare(*ring_, &request) == Io::IoUringResult::Ok;
+}
+
+void AsyncFileManagerIoUring::submitPending() {
+  bool prepared = false;
+  while (!pending_.empty() && in_flight_ < 2 * submission_queue_size_) {
+    if (!prepare(*pending_.front())) {
+      break;
+    }
+    ++in_flight_;
+    pending_.front().release();
+    pending_.pop_front();
+    prepared = true;
+  }
+  if (prepared) {
+    submitPrepared();
+  }
+}
+
+void AsyncFileManagerIoUring::submitPrepared() {
+  if (ring_->submit() == Io::IoUringResult::Busy) {
+    // The completion queue is overcommitted; the completion thread submits the prepared
+    // operations again after it has reaped some completions.
+    submit_pending_ = true;
+  }
+}
+
+CancelFunction AsyncFileManagerIoUring::enqueue(Event::Dispatcher* dispatcher,
+                                                std::unique_ptr<AsyncFileAction> action) {
+  QueuedAction entry{std::move(action), dispatcher};
+  auto cancel_func = [dispatcher, state = entry.state_]() {
+    ASSERT(dispatcher == nullptr || dispatcher->isThreadSafe());
+    state->store(QueuedAction::State::Cancelled);
+  };
+  absl::MutexLock lock(ring_mutex_);
+  blocking_queue_.push_back(std::move(entry));
+  return cancel_func;
+}
+
+void AsyncFileManagerIoUring::postCancelledActionForCleanup(
+    std::unique_ptr<AsyncFileAction> action) {
+  // Undoing an action only submits another operation, which doesn't block, so it can be done
+  // right here on the dispatcher's thread.
+  action->onCancelledBeforeCallback();
+}
+
+void AsyncFileManagerIoUring::onActionPerformed(QueuedAction&& queued_action) {
+  using State = QueuedAction::State;
+  std::shared_ptr<std::atomic<State>> state = std::move(queued_action.state_);
+  std::unique_ptr<AsyncFileAction> action = std::move(queued_action.action_);
+  action->execute();
+  State expected = State::Executing;
+  if (!state->compare_exchange_strong(expected, State::InCallback)) {
+    ASSERT(expected == State::Cancelled);
+    action->onCancelledBeforeCallback();
+    return;
+  }
+  if (queued_action.dispatcher_ == nullptr) {
+    // No need to bother arranging the callback, because a dispatcher was not provided.
+    return;
+  }
+  // As in AsyncFileManagerThreadPool, only capture the manager if the action has side-effects
+  // which have to be undone if it is cancelled after being posted.
+  std::shared_ptr<AsyncFileManagerIoUring> manager;
+  if (action->hasActionIfCancelledBeforeCallback()) {
+    manager = shared_from_this();
+  }
+  queued_action.dispatcher_->post([manager = std::move(manager), action = std::move(action),
+                                   state = std::move(state)]() mutable {
+    // This callback runs on the caller's thread.
+    State expected = State::InCallback;
+    if (state->compare_exchange_strong(expected, State::Done)) {
+      action->onComplete();
+      return;
+    }
+    ASSERT(expected == State::Cancelled);
+    if (manager == nullptr) {
+      return;
+    }
+    manager->postCancelledActionForCleanup(std::move(action));
+  });
+}
+
+void AsyncFileManagerIoUring::completionThread() {
+  using Completion = AsyncFileActionIoUring::Completion;
+  std::vector<std::pair<Request*, int32_t>> completions;
+  completions.reserve(submission_queue_size_);
+  std::vector<std::unique_ptr<Request>> resubmit;
+  std::vector<QueuedAction> fallback;
+  bool drained = true;
+  while (true) {
+    if (drained) {
+      struct pollfd event {
+        event_fd_, POLLIN, 0
+      };
+      ::poll(&event, 1, -1);
+    }
+    {
+      absl::MutexLock lock(ring_mutex_);
+      ring_->forEveryCompletion(
+          [&completions](Io::Request* request, int32_t result, uint32_t, bool) {
+            completions.emplace_back(static_cast<Request*>(request), result);
+          });
+      if (submit_pending_) {
+        submit_pending_ = false;
+        submitPrepared();
+      }
+    }
+    // Completions are reaped in batches of at most the ring size, and reaping drains the eventfd,
+    // so a full batch means there may be more completions which won't wake the thread up.
+    drained = completions.size() < submission_queue_size_;
+    // The callbacks are posted without holding the lock, as undoing a cancelled action submits
+    // another operation.
+    for (auto& [request, result] : completions) {
+      std::unique_ptr<Request> owned_request(request);
+      switch (owned_request->action().onRingCompletion(result)) {
+      case Completion::Done:
+        onActionPerformed(std::move(owned_request->queued_action_));
+        break;
+      case Completion::Resubmit:
+        resubmit.push_back(std::move(owned_request));
+        break;
+      case Completion::Fallback:
+        owned_request->action().useFallback();
+        fallback.push_back(std::move(owned_request->queued_action_));
+        break;
+      }
+    }
+    absl::MutexLock lock(ring_mutex_);
+    in_flight_ -= completions.size();
+    completions.clear();
+    for (std::unique_ptr<Request>& request : resubmit) {
+      pending_.push_back(std::move(request));
+    }
+    resubmit.clear();
+    for (QueuedAction& queued_action : fallback) {
+      blocking_queue_.push_back(std::move(queued_action));
+    }
+    fallback.clear();
+    // Completions have made room in the completion queue for the operations that were waiting.
+    submitPending();
+    if (terminate_ && isIdle()) {
+      completion_thread_exited_ = true;
+      return;
+    }
+  }
+}
+
+void AsyncFileManagerIoUring::blockingThread() {
+  using State = QueuedAction::State;
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(ring_mutex_) {
+    return !blocking_queue_.empty() || completion_thread_exited_;
+  };
+  while (true) {
+    QueuedAction queued_action;
+    {
+      absl::MutexLock lock(ring_mutex_);
+      blocking_busy_ = false;
+      if (terminate_) {
+        // The completion thread only exits once this thread is idle, wake it up to notice.
+        eventfd_write(event_fd_, 1);
+      }
+      ring_mutex_.Await(absl::Condition(&condition));
+      if (blocking_queue_.empty()) {
+        return;
+      }
+      queued_action = std::move(blocking_queue_.front());
+      blocking_queue_.pop_front();
+      blocking_busy_ = true;
+    }
+    // Actions handed over by the completion thread after the ring couldn't perform them are
+    // already executing, enqueued actions can still be cancelled before they start.
+    State expected = State::Queued;
+    if (queued_action.state_->compare_exchange_strong(expected, State::Executing) ||
+        expected == State::Executing) {
+      onActionPerformed(std::move(queued_action));
+      continue;
+    }
+    ASSERT(expected == State::Cancelled);
+    if (queued_action.action_->executesEvenIfCancelled()) {
+      queued_action.action_->execute();
+    }
+  }
+}
+
+namespace {
+
+class ActionWithFileResult
+    : public AsyncFileActionIoUringWithResult<absl::StatusOr<AsyncFileHandle>> {
+public:
+  ActionWithFileResult(AsyncFileManagerIoUring& manager,
+                       absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete)
+      : AsyncFileActionIoUringWithResult(std::move(on_complete)), manager_(manager) {}
+
+  absl::StatusOr<AsyncFileHandle> resultFromRing(int32_t result) override {
+    if (result < 0) {
+      return statusAfterFileError(-result);
+    }
+    return std::make_shared<AsyncFileContextIoUring>(manager_, result);
+  }
+
+protected:
+  void onCancelledBeforeCallback() override {
+    if (result_.value().ok()) {
+      result_.value().value()->close(nullptr, [](absl::Status) {}).IgnoreError();
+    }
+  }
+  bool hasActionIfCancelledBeforeCallback() const override { return true; }
+
+  AsyncFileManagerIoUring& manager_;
+};
+
+class ActionCreateAnonymousFile : public ActionWithFileResult {
+public:
+  ActionCreateAnonymousFile(AsyncFileManagerIoUring& manager, absl::string_view path,
+                            absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete)
+      : ActionWithFileResult(manager, std::move(on_complete)), path_(path) {}
+
+  Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) override {
+    return ring.prepareOpenat(AT_FDCWD, path_.c_str(), O_TMPFILE | O_RDWR, S_IRUSR | S_IWUSR,
+                              request);
+  }
+
+  Completion onRingCompletion(int32_t result) override {
+    // The file system of path doesn't support O_TMPFILE, or the kernel doesn't at all.
+    if (result == -EOPNOTSUPP || result == -EISDIR) {
+      manager_.setSupportsOTmpfile(false);
+      return Completion::Fallback;
+    }
+    return ActionWithFileResult::onRingCompletion(result);
+  }
+
+  // As in AsyncFileManagerThreadPool, fall back to creating a named file and unlinking it.
+  absl::StatusOr<AsyncFileHandle> executeFallback() override {
+    Api::OsSysCalls& posix = manager_.posix();
+    char filename[4096];
+    static const char file_suffix[] = "/buffer.XXXXXX";
+    if (path_.size() + sizeof(file_suffix) > sizeof(filename)) {
+      return absl::InvalidArgumentError(
+          "AsyncFileManagerIoUring::createAnonymousFile: pathname too long for tmpfile");
+    }
+    snprintf(filename, sizeof(filename), "%s%s", path_.c_str(), file_suffix);
+    Api::SysCallIntResult open_result = posix.mkstemp(filename);
+    if (open_result.return_value_ == -1) {
+      return statusAfterFileError(open_result);
+    }
+    if (posix.unlink(filename).return_value_ != 0) {
+      // Don't leave a named file behind if it can't be unlinked while it is open.
+      posix.close(open_result.return_value_);
+      posix.unlink(filename);
+      return absl::UnimplementedError(
+          "AsyncFileManagerIoUring::createAnonymousFile: not supported for "
+          "target filesystem (failed to unlink an open file)");
+    }
+    return std::make_shared<AsyncFileContextIoUring>(manager_, open_result.return_value_);
+  }
+
+private:
+  const std::string path_;
+};
+
+class ActionOpenExistingFile : public ActionWithFileResult {
+public:
+  ActionOpenExistingFile(AsyncFileManagerIoUring& manager, absl::string_view filename,
+                         AsyncFileManager::Mode mode,
+                         absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete)
+      : ActionWithFileResult(manager, std::move(on_complete)), filename_(filename), mode_(mode) {}
+
+  Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) override {
+    return ring.prepareOpenat(AT_FDCWD, filename_.c_str(), openFlags(), 0, request);
+  }
+
+private:
+  int openFlags() const {
+    switch (mode_) {
+    case AsyncFileManager::Mode::ReadOnly:
+      return O_RDONLY;
+    case AsyncFileManager::Mode::WriteOnly:
+      return O_WRONLY;
+    case AsyncFileManager::Mode::ReadWrite:
+      return O_RDWR;
+    }
+    PANIC_DUE_TO_CORRUPT_ENUM;
+  }
+  const std::string filename_;
+  const AsyncFileManager::Mode mode_;
+};
+
+class ActionStat : public AsyncFileActionIoUringWithResult<absl::StatusOr<struct stat>> {
+public:
+  ActionStat(absl::string_view filename,
+             absl::AnyInvocable<void(absl::StatusOr<struct stat>)> on_complete)
+      : AsyncFileActionIoUringWithResult(std::move(on_complete)), filename_(filename) {}
+
+  Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) override {
+    return ring.prepareStatx(AT_FDCWD, filename_.c_str(), 0, STATX_BASIC_STATS, &statx_buf_,
+                             request);
+  }
+
+  absl::StatusOr<struct stat> resultFromRing(int32_t result) override {
+    if (result < 0) {
+      return statusAfterFileError(-result);
+    }
+    return statFromStatx(statx_buf_);
+  }
+
+private:
+  const std::string filename_;
+  struct statx statx_buf_ {};
+};
+
+class ActionUnlink : public AsyncFileActionIoUringWithResult<absl::Status> {
+public:
+  ActionUnlink(absl::string_view filename, absl::AnyInvocable<void(absl::Status)> on_complete)
+      : AsyncFileActionIoUringWithResult(std::move(on_complete)), filename_(filename) {}
+
+  Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) override {
+    return ring.prepareUnlinkat(AT_FDCWD, filename_.c_str(), 0, request);
+  }
+
+  absl::Status resultFromRing(int32_t result) override {
+    if (result < 0) {
+      return statusAfterFileError(-result);
+    }
+    return absl::OkStatus();
+  }
+
+private:
+  const std::string filename_;
+};
+
+} // namespace
+
+CancelFunction AsyncFileManagerIoUring::createAnonymousFile(
+    Event::Dispatcher* dispatcher, absl::string_view path,
+    absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) {
+  auto action = std::make_unique<ActionCreateAnonymousFile>(*this, path, std::move(on_complete));
+  if (!supportsOTmpfile()) {
+    action->useFallback();
+  }
+  return submit(dispatcher, std::move(action));
+}
+
+CancelFunction AsyncFileManagerIoUring::openExistingFile(
+    Event::Dispatcher* dispatcher, absl::string_view filename, Mode mode,
+    absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) {
+  return submit(dispatcher, std::make_unique<ActionOpenExistingFile>(*this, filename, mode,
+                                                                     std::move(on_complete)));
+}
+
+CancelFunction
+AsyncFileManagerIoUring::stat(Event::Dispatcher* dispatcher, absl::string_view filename,
+                              absl::AnyInvocable<void(absl::StatusOr<struct stat>)> on_complete) {
+  return submit(dispatcher, std::make_unique<ActionStat>(filename, std::move(on_complete)));
+}
+
+CancelFunction AsyncFileManagerIoUring::unlink(Event::Dispatcher* dispatcher,
+                                               absl::string_view filename,
+                                               absl::AnyInvocable<void(absl::Status)> on_complete) {
+  return submit(dispatcher, std::make_unique<ActionUnlink>(filename, std::move(on_complete)));
+}
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
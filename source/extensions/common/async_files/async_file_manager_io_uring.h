@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/common/io/io_uring.h"
+#include "envoy/extensions/common/async_files/v3/async_file_manager.pb.h"
+
+#include "source/common/common/logger.h"
+#include "source/extensions/common/async_files/async_file_handle.h"
+#include "source/extensions/common/async_files/async_file_manager.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+// An action that is performed by the kernel as a single io_uring operation.
+class AsyncFileActionIoUring : public AsyncFileAction {
+public:
+  // What the manager does with the action once the completion of its operation has been reaped.
+  enum class Completion {
+    // The operation is finished, the action is executed and its callback posted.
+    Done,
+    // The operation has to be prepared and submitted again, e.g. to finish a short write.
+    Resubmit,
+    // The kernel can't perform the operation, the action falls back to executing blocking system
+    // calls on the blocking thread of the manager.
+    Fallback,
+  };
+
+  // Puts the operation into the submission queue of the ring, tagged with request.
+  virtual Io::IoUringResult prepare(Io::IoUring& ring, Io::Request* request) PURE;
+
+  // Handles the result of the operation as reported by the completion queue entry, i.e. the
+  // return value of the equivalent system call or a negated errno.
+  virtual Completion onRingCompletion(int32_t result) {
+    ring_result_ = result;
+    return Completion::Done;
+  }
+
+  // Makes the action execute blocking system calls instead of an io_uring operation.
+  void useFallback() { fallback_ = true; }
+  bool usesFallback() const { return fallback_; }
+
+protected:
+  int32_t ring_result_ = 0;
+  bool fallback_ = false;
+};
+
+// All concrete AsyncFileActionIoUring are a subclass of AsyncFileActionIoUringWithResult, which
+// translates the result of the operation into the argument of the on_complete callback.
+template <typename T> class AsyncFileActionIoUringWithResult : public AsyncFileActionIoUring {
+public:
+  explicit AsyncFileActionIoUringWithResult(absl::AnyInvocable<void(T)> on_complete)
+      : on_complete_(std::move(on_complete)) {}
+
+  void execute() final { result_ = fallback_ ? executeFallback() : resultFromRing(ring_result_); }
+  void onComplete() final { std::move(on_complete_)(std::move(result_.value())); }
+
+protected:
+  absl::optional<T> result_;
+  virtual T resultFromRing(int32_t result) PURE;
+  // Only the actions which use the fallback implement it; it runs on the blocking thread.
+  virtual T executeFallback() { PANIC("no fallback for io_uring action"); }
+
+private:
+  absl::AnyInvocable<void(T)> on_complete_;
+};
+
+// An AsyncFileManager which has the kernel perform file operations through a single io_uring.
+// Operations are submitted from the calling thread, so they are in flight as soon as the call
+// returns, and no thread is blocked while the kernel performs them. A single completion thread
+// reaps the completion queue and posts the callbacks to the dispatchers that requested the
+// operations, exactly like AsyncFileManagerThreadPool does.
+//
+// Operations beyond what the completion queue can hold wait in a queue of the manager, and are
+// submitted by the completion thread as earlier operations complete.
+//
+// Operations that have no io_uring equivalent, e.g. duplicating a file, or that the kernel
+// doesn't support, e.g. truncating a file before Linux 6.9 or creating an anonymous file on a
+// file system without O_TMPFILE, are performed with blocking system calls on a single blocking
+// thread, never on the calling thread.
+class AsyncFileManagerIoUring : public AsyncFileManager,
+                                public std::enable_shared_from_this<AsyncFileManagerIoUring>,
+                                protected Logger::Loggable<Logger::Id::main> {
+public:
+  explicit AsyncFileManagerIoUring(
+      const envoy::extensions::common::async_files::v3::AsyncFileManagerConfig& config,
+      Api::OsSysCalls& posix);
+  ~AsyncFileManagerIoUring() ABSL_LOCKS_EXCLUDED(ring_mutex_) override;
+  CancelFunction createAnonymousFile(
+      Event::Dispatcher* dispatcher, absl::string_view path,
+      absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) override;
+  CancelFunction
+  openExistingFile(Event::Dispatcher* dispatcher, absl::string_view filename, Mode mode,
+                   absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) override;
+  CancelFunction stat(Event::Dispatcher* dispatcher, absl::string_view filename,
+                      absl::AnyInvocable<void(absl::StatusOr<struct stat>)> on_complete) override;
+  CancelFunction unlink(Event::Dispatcher* dispatcher, absl::string_view filename,
+                        absl::AnyInvocable<void(absl::Status)> on_complete) override;
+  std::string describe() const override;
+  void waitForIdle() ABSL_LOCKS_EXCLUDED(ring_mutex_) override;
+  Api::OsSysCalls& posix() const { return posix_; }
+  bool supportsFtruncate() const { return supports_ftruncate_; }
+  bool supportsOTmpfile() const { return supports_o_tmpfile_; }
+  void setSupportsOTmpfile(bool supported) { supports_o_tmpfile_ = supported; }
+
+  // Submits an action to the ring, or hands it to the blocking thread if it uses the fallback.
+  CancelFunction submit(Event::Dispatcher* dispatcher,
+                        std::unique_ptr<AsyncFileActionIoUring> action)
+      ABSL_LOCKS_EXCLUDED(ring_mutex_);
+
+private:
+  class Request;
+
+  // Hands an action that has no io_uring operation to the blocking thread.
+  CancelFunction enqueue(Event::Dispatcher* dispatcher,
+                         std::unique_ptr<AsyncFileAction> action) override;
+  void postCancelledActionForCleanup(std::unique_ptr<AsyncFileAction> action) override;
+  void onActionPerformed(QueuedAction&& queued_action);
+  void completionThread() ABSL_LOCKS_EXCLUDED(ring_mutex_);
+  void blockingThread() ABSL_LOCKS_EXCLUDED(ring_mutex_);
+  // Prepares the operation of request, returns false if the submission queue has no room for it
+  // even after submitting what it holds.
+  bool prepare(Request& request) ABSL_EXCLUSIVE_LOCKS_REQUIRED(ring_mutex_);
+  // Prepares and submits the operations waiting in pending_ while the completion queue has room
+  // for them.
+  void submitPending() ABSL_EXCLUSIVE_LOCKS_REQUIRED(ring_mutex_);
+  // Submits prepared operations, retrying once the completion thread has made room in the
+  // completion queue if the kernel reports it as overcommitted.
+  void submitPrepared() ABSL_EXCLUSIVE_LOCKS_REQUIRED(ring_mutex_);
+  bool isIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(ring_mutex_);
+
+  const uint32_t submission_queue_size_;
+  absl::Mutex ring_mutex_;
+  Io::IoUringPtr ring_ ABSL_GUARDED_BY(ring_mutex_);
+  os_fd_t event_fd_;
+  // The number of operations submitted to the ring whose completion has not been handled yet.
+  uint64_t in_flight_ ABSL_GUARDED_BY(ring_mutex_) = 0;
+  // Operations waiting for room in the completion queue, in the order they were requested.
+  std::deque<std::unique_ptr<Request>> pending_ ABSL_GUARDED_BY(ring_mutex_);
+  // Actions waiting to be executed by the blocking thread.
+  std::deque<QueuedAction> blocking_queue_ ABSL_GUARDED_BY(ring_mutex_);
+  bool blocking_busy_ ABSL_GUARDED_BY(ring_mutex_) = false;
+  bool submit_pending_ ABSL_GUARDED_BY(ring_mutex_) = false;
+  bool terminate_ ABSL_GUARDED_BY(ring_mutex_) = false;
+  bool completion_thread_exited_ ABSL_GUARDED_BY(ring_mutex_) = false;
+  std::thread completion_thread_;
+  std::thread blocking_thread_;
+  Api::OsSysCalls& posix_;
+  const bool supports_ftruncate_;
+  // Cleared the first time the kernel rejects O_TMPFILE for an anonymous file, after which
+  // anonymous files are created as named files that are unlinked right away.
+  std::atomic<bool> supports_o_tmpfile_{true};
+};
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
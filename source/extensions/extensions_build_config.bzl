@@ -548,6 +548,12 @@ EXTENSIONS = {
     # Hickory DNS resolver extension uses a Rust-based DNS library with support for DoT, DoH, and `DNSSEC`.
     "envoy.network.dns_resolver.hickory":              "//source/extensions/network/dns_resolver/hickory:config",
 
+    #
+    # Connection balancers
+    #
+
+    "envoy.network.connection_balance.least_connections": "//source/extensions/network/connection_balance/least_connections:config",
+
     #
     # Address Resolvers
     #
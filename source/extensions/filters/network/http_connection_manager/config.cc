@@ -447,6 +447,8 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
                                ? std::make_unique<HttpConnectionManagerProto::ProxyStatusConfig>(
                                      config.proxy_status_config())
                                : nullptr),
+      stream_arena_initial_block_size_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, stream_arena_initial_block_size, 0)),
       header_validator_factory_(createHeaderValidatorFactory(config, context, creation_status)),
       append_local_overload_(config.append_local_overload()),
       append_x_forwarded_port_(config.append_x_forwarded_port()),
@@ -734,6 +736,20 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
     return;
   }
 
+  if (config.has_filter_latency()) {
+    std::vector<std::string> filter_names;
+    for (const auto& filter : config.http_filters()) {
+      filter_names.push_back(filter.name());
+    }
+    for (const auto& upgrade_config : config.upgrade_configs()) {
+      for (const auto& filter : upgrade_config.filters()) {
+        filter_names.push_back(filter.name());
+      }
+    }
+    filter_latency_config_ = std::make_unique<Http::FilterLatencyConfig>(
+        config.filter_latency().sampling(), filter_names, stats_prefix_, context_.scope());
+  }
+
   Http::FilterChainHelper<Server::Configuration::FactoryContext,
                           Server::Configuration::NamedHttpFilterConfigFactory>
       helper(filter_config_provider_manager_, context_.serverFactoryContext(),
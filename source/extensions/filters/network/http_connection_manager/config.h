@@ -262,6 +262,12 @@ public:
   const HttpConnectionManagerProto::ProxyStatusConfig* proxyStatusConfig() const override {
     return proxy_status_config_.get();
   }
+  const Http::FilterLatencyConfig* filterLatencyConfig() const override {
+    return filter_latency_config_.get();
+  }
+  uint32_t streamArenaInitialBlockSize() const override {
+    return stream_arena_initial_block_size_;
+  }
   Http::ServerHeaderValidatorPtr
   makeHeaderValidator([[maybe_unused]] Http::Protocol protocol) override {
 #ifdef ENVOY_ENABLE_UHV
@@ -380,6 +386,8 @@ private:
   const bool strip_trailing_host_dot_;
   const uint64_t max_requests_per_connection_;
   const std::unique_ptr<HttpConnectionManagerProto::ProxyStatusConfig> proxy_status_config_;
+  Http::FilterLatencyConfigPtr filter_latency_config_;
+  const uint32_t stream_arena_initial_block_size_;
   const Http::HeaderValidatorFactoryPtr header_validator_factory_;
   const bool append_local_overload_;
   const bool append_x_forwarded_port_;
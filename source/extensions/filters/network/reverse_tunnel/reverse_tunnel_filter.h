@@ -169,6 +169,7 @@ private:
     StreamInfo::StreamInfo& streamInfo() override;
     AccessLog::InstanceSharedPtrVector accessLogHandlers() override;
     Http::RequestDecoderHandlePtr getRequestDecoderHandle() override;
+    Http::StreamArenaSharedPtr streamArena() override { return nullptr; }
 
   private:
     void processIfComplete(bool end_stream);
@@ -1,5 +1,7 @@
 #include "source/extensions/http/cache_v2/simple_http_cache/simple_http_cache.h"
 
+#include <algorithm>
+
 #include "envoy/extensions/http/cache_v2/simple_http_cache/v3/config.pb.h"
 #include "envoy/registry/registry.h"
 
@@ -17,16 +19,47 @@ constexpr absl::string_view Name = "envoy.extensions.http.cache_v2.simple";
 
 constexpr uint64_t InsertReadChunkSize = 512 * 1024;
 
+// Body chunks are at least this large when referenced rather than copied into a lookup's buffer.
+constexpr uint64_t MinReferencedChunkSize = 1024;
+
+// Hash multipliers selecting a counter in each row of the frequency sketch.
+constexpr uint64_t SketchSeeds[] = {0x9e3779b97f4a7c15, 0xc2b2ae3d27d4eb4f, 0x165667b19e3779f9,
+                                    0xd6e8feb86659fd93};
+
+// A reference to part of a body chunk, keeping the chunk alive until the buffer is done with it.
+class BodyChunkFragment : public Buffer::BufferFragment {
+public:
+  BodyChunkFragment(std::shared_ptr<const std::string> chunk, uint64_t offset, uint64_t length)
+      : chunk_(std::move(chunk)), offset_(offset), length_(length) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return chunk_->data() + offset_; }
+  size_t size() const override { return length_; }
+  void done() override { delete this; }
+
+private:
+  const std::shared_ptr<const std::string> chunk_;
+  const uint64_t offset_;
+  const uint64_t length_;
+};
+
 class InsertContext {
 public:
-  static void start(std::shared_ptr<SimpleHttpCache::Entry> entry,
+  static void start(std::shared_ptr<SimpleHttpCache::ShardSet> shards,
+                    SimpleHttpCache::Shard& shard, Key key,
+                    std::shared_ptr<SimpleHttpCache::Entry> entry,
                     std::shared_ptr<CacheProgressReceiver> progress_receiver, HttpSourcePtr source);
 
 private:
-  InsertContext(std::shared_ptr<SimpleHttpCache::Entry> entry,
+  InsertContext(std::shared_ptr<SimpleHttpCache::ShardSet> shards, SimpleHttpCache::Shard& shard,
+                Key key, std::shared_ptr<SimpleHttpCache::Entry> entry,
                 std::shared_ptr<CacheProgressReceiver> progress_receiver, HttpSourcePtr source);
   void onBody(AdjustedByteRange range, Buffer::InstancePtr buffer, EndStream end_stream);
   void onTrailers(Http::ResponseTrailerMapPtr trailers, EndStream end_stream);
+  // Keeps shard_ alive if the cache is destroyed before the insert completes.
+  std::shared_ptr<SimpleHttpCache::ShardSet> shards_;
+  SimpleHttpCache::Shard& shard_;
+  const Key key_;
   std::shared_ptr<SimpleHttpCache::Entry> entry_;
   std::shared_ptr<CacheProgressReceiver> progress_receiver_;
   HttpSourcePtr source_;
@@ -47,26 +80,32 @@ void SimpleHttpCacheReader::getBody(Event::Dispatcher&, AdjustedByteRange range,
   cb(entry_->body(std::move(range)), EndStream::More);
 }
 
-void InsertContext::start(std::shared_ptr<SimpleHttpCache::Entry> entry,
+void InsertContext::start(std::shared_ptr<SimpleHttpCache::ShardSet> shards,
+                          SimpleHttpCache::Shard& shard, Key key,
+                          std::shared_ptr<SimpleHttpCache::Entry> entry,
                           std::shared_ptr<CacheProgressReceiver> progress_receiver,
                           HttpSourcePtr source) {
-  auto ctx = new InsertContext(std::move(entry), std::move(progress_receiver), std::move(source));
+  auto ctx = new InsertContext(std::move(shards), shard, std::move(key), std::move(entry),
+                               std::move(progress_receiver), std::move(source));
   ctx->source_->getBody(AdjustedByteRange(0, InsertReadChunkSize), [ctx](Buffer::InstancePtr buffer,
                                                                          EndStream end_stream) {
     ctx->onBody(AdjustedByteRange(0, InsertReadChunkSize), std::move(buffer), end_stream);
   });
 }
 
-InsertContext::InsertContext(std::shared_ptr<SimpleHttpCache::Entry> entry,
+InsertContext::InsertContext(std::shared_ptr<SimpleHttpCache::ShardSet> shards,
+                             SimpleHttpCache::Shard& shard, Key key,
+                             std::shared_ptr<SimpleHttpCache::Entry> entry,
                              std::shared_ptr<CacheProgressReceiver> progress_receiver,
                              HttpSourcePtr source)
-    : entry_(std::move(entry)), progress_receiver_(std::move(progress_receiver)),
-      source_(std::move(source)) {}
+    : shards_(std::move(shards)), shard_(shard), key_(std::move(key)), entry_(std::move(entry)),
+      progress_receiver_(std::move(progress_receiver)), source_(std::move(source)) {}
 
 void InsertContext::onBody(AdjustedByteRange range, Buffer::InstancePtr buffer,
                            EndStream end_stream) {
   if (end_stream == EndStream::Reset) {
     progress_receiver_->onInsertFailed(absl::UnavailableError("upstream reset"));
+    shard_.onInsertFailed(key_, entry_);
     delete this;
     return;
   }
@@ -77,6 +116,7 @@ void InsertContext::onBody(AdjustedByteRange range, Buffer::InstancePtr buffer,
     ASSERT(range.length() >= buffer->length());
     range = AdjustedByteRange(range.begin(), range.begin() + buffer->length());
     entry_->appendBody(std::move(buffer));
+    shard_.onBodyAppended(key_, entry_);
   } else if (end_stream == EndStream::More) {
     // Neither buffer nor EndStream::End means we want trailers.
     return source_->getTrailers([this](Http::ResponseTrailerMapPtr trailers, EndStream end_stream) {
@@ -93,15 +133,18 @@ void InsertContext::onBody(AdjustedByteRange range, Buffer::InstancePtr buffer,
                               onBody(next_range, std::move(buffer), end_stream);
                             });
   }
+  shard_.onInsertComplete(key_, entry_);
   delete this;
 }
 
 void InsertContext::onTrailers(Http::ResponseTrailerMapPtr trailers, EndStream end_stream) {
   if (end_stream == EndStream::Reset) {
     progress_receiver_->onInsertFailed(absl::UnavailableError("upstream reset during trailers"));
+    shard_.onInsertFailed(key_, entry_);
   } else {
     entry_->setTrailers(std::move(trailers));
     progress_receiver_->onTrailersInserted(entry_->copyTrailers());
+    shard_.onInsertComplete(key_, entry_);
   }
   delete this;
 }
@@ -109,19 +152,41 @@ void InsertContext::onTrailers(Http::ResponseTrailerMapPtr trailers, EndStream e
 } // namespace
 
 Buffer::InstancePtr SimpleHttpCache::Entry::body(AdjustedByteRange range) const {
+  auto buffer = std::make_unique<Buffer::OwnedImpl>();
   absl::ReaderMutexLock lock(mu_);
-  return std::make_unique<Buffer::OwnedImpl>(
-      absl::string_view{body_}.substr(range.begin(), range.length()));
+  uint64_t pos = range.begin();
+  const uint64_t end = std::min(range.end(), body_size_);
+  auto chunk =
+      std::upper_bound(body_.begin(), body_.end(), pos,
+                       [](uint64_t offset, const BodyChunk& c) { return offset < c.end_; });
+  for (; chunk != body_.end() && pos < end; ++chunk) {
+    const uint64_t offset = pos - (chunk->end_ - chunk->data_->size());
+    const uint64_t length = std::min(chunk->end_, end) - pos;
+    if (length < MinReferencedChunkSize) {
+      buffer->add(chunk->data_->data() + offset, length);
+    } else {
+      buffer->addBufferFragment(*new BodyChunkFragment(chunk->data_, offset, length));
+    }
+    pos += length;
+  }
+  return buffer;
 }
 
 void SimpleHttpCache::Entry::appendBody(Buffer::InstancePtr buf) {
+  auto data = std::make_shared<const std::string>(buf->toString());
   absl::WriterMutexLock lock(mu_);
-  body_ += buf->toString();
+  body_size_ += data->size();
+  body_.push_back(BodyChunk{body_size_, std::move(data)});
 }
 
 uint64_t SimpleHttpCache::Entry::bodySize() const {
   absl::ReaderMutexLock lock(mu_);
-  return body_.size();
+  return body_size_;
+}
+
+uint64_t SimpleHttpCache::Entry::sizeBytes() const {
+  absl::ReaderMutexLock lock(mu_);
+  return response_headers_->byteSize() + body_size_ + (trailers_ ? trailers_->byteSize() : 0);
 }
 
 Http::ResponseHeaderMapPtr SimpleHttpCache::Entry::copyHeaders() const {
@@ -159,6 +224,246 @@ void SimpleHttpCache::Entry::setEndStreamAfterBody() {
   end_stream_after_body_ = true;
 }
 
+SimpleHttpCache::FrequencySketch::FrequencySketch() : counters_(Depth * Width) {}
+
+uint32_t SimpleHttpCache::FrequencySketch::index(uint64_t hash, uint32_t row) const {
+  // The top bits of the product depend on all bits of the hash, unlike the low bits which also
+  // select the shard.
+  return row * Width + ((hash * SketchSeeds[row]) >> 52) % Width;
+}
+
+void SimpleHttpCache::FrequencySketch::increment(uint64_t hash) {
+  for (uint32_t row = 0; row < Depth; row++) {
+    uint8_t& counter = counters_[index(hash, row)];
+    if (counter < 15) {
+      counter++;
+    }
+  }
+  if (++additions_ == 10 * Width) {
+    // Age all counts so that keys which were popular long ago don't keep out new ones forever.
+    for (uint8_t& counter : counters_) {
+      counter >>= 1;
+    }
+    additions_ /= 2;
+  }
+}
+
+uint32_t SimpleHttpCache::FrequencySketch::estimate(uint64_t hash) const {
+  uint32_t result = 15;
+  for (uint32_t row = 0; row < Depth; row++) {
+    result = std::min<uint32_t>(result, counters_[index(hash, row)]);
+  }
+  return result;
+}
+
+std::shared_ptr<SimpleHttpCache::Entry> SimpleHttpCache::Shard::lookup(const Key& key,
+                                                                      uint64_t hash) {
+  if (!bounded()) {
+    absl::ReaderMutexLock lock(mu_);
+    auto it = entries_.find(key);
+    return it == entries_.end() ? nullptr : it->second.entry_;
+  }
+  absl::WriterMutexLock lock(mu_);
+  // Misses are counted too, so that a response requested repeatedly can be admitted over
+  // entries that are requested less often.
+  sketch_.increment(hash);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru_position_);
+  return it->second.entry_;
+}
+
+void SimpleHttpCache::Shard::touch(const Key& key) {
+  if (!bounded()) {
+    return;
+  }
+  absl::WriterMutexLock lock(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second.lru_position_);
+  }
+}
+
+void SimpleHttpCache::Shard::evict(const Key& key) {
+  absl::WriterMutexLock lock(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    erase(it);
+  }
+}
+
+void SimpleHttpCache::Shard::updateHeaders(const Key& key,
+                                           Http::ResponseHeaderMapPtr response_headers,
+                                           const ResponseMetadata& metadata) {
+  bool reclaim = false;
+  {
+    absl::WriterMutexLock lock(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return;
+    }
+    it->second.entry_->updateHeadersAndMetadata(std::move(response_headers), metadata);
+    if (bounded()) {
+      charge(it->second, it->second.entry_->sizeBytes());
+      reclaim = enforceBudget(entries_.end());
+    }
+  }
+  if (reclaim) {
+    shard_set_.reclaim(*this);
+  }
+}
+
+void SimpleHttpCache::Shard::insert(const Key& key, uint64_t hash, std::shared_ptr<Entry> entry) {
+  absl::WriterMutexLock lock(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    erase(it);
+  }
+  // The entry is charged for its headers until its body arrives.
+  const uint64_t size = bounded() ? entry->sizeBytes() : 0;
+  it = entries_.emplace(key, Slot{std::move(entry), hash, 0, lru_.end()}).first;
+  if (bounded()) {
+    sketch_.increment(hash);
+    it->second.lru_position_ = lru_.insert(lru_.begin(), &it->first);
+    charge(it->second, size);
+  }
+}
+
+void SimpleHttpCache::Shard::onBodyAppended(const Key& key, const std::shared_ptr<Entry>& entry) {
+  chargeEntry(key, entry);
+}
+
+void SimpleHttpCache::Shard::onInsertComplete(const Key& key, const std::shared_ptr<Entry>& entry) {
+  chargeEntry(key, entry);
+}
+
+void SimpleHttpCache::Shard::chargeEntry(const Key& key, const std::shared_ptr<Entry>& entry) {
+  if (!bounded()) {
+    return;
+  }
+  bool reclaim;
+  {
+    absl::WriterMutexLock lock(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.entry_ != entry) {
+      // The entry was evicted, rejected or replaced while it was being inserted. It keeps
+      // streaming to the lookups already reading it, but is no longer charged.
+      return;
+    }
+    const uint64_t size = entry->sizeBytes();
+    charge(it->second, size);
+    if (size > shard_set_.maxSizeBytes()) {
+      // Never evict anything to make room for an entry that can't fit anyway.
+      erase(it);
+      return;
+    }
+    reclaim = enforceBudget(it);
+  }
+  // The other shards are only locked once this one is released, so shards never wait on each
+  // other while holding their own lock.
+  if (reclaim) {
+    shard_set_.reclaim(*this);
+  }
+}
+
+void SimpleHttpCache::Shard::onInsertFailed(const Key& key, const std::shared_ptr<Entry>& entry) {
+  absl::WriterMutexLock lock(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end() && it->second.entry_ == entry) {
+    erase(it);
+  }
+}
+
+bool SimpleHttpCache::Shard::enforceBudget(SlotMap::iterator candidate) {
+  while (shard_set_.overBudget()) {
+    // The least recently used entry other than the candidate.
+    const Key* candidate_key = candidate == entries_.end() ? nullptr : &candidate->first;
+    auto position = std::find_if(lru_.rbegin(), lru_.rend(),
+                                 [candidate_key](const Key* key) { return key != candidate_key; });
+    if (position == lru_.rend()) {
+      // The rest of the budget is held by other shards.
+      return true;
+    }
+    auto victim = entries_.find(**position);
+    ASSERT(victim != entries_.end());
+    if (candidate != entries_.end() &&
+        sketch_.estimate(candidate->second.hash_) <= sketch_.estimate(victim->second.hash_)) {
+      // TinyLFU admission: the new entry is not worth more than what it would displace.
+      erase(candidate);
+      candidate = entries_.end();
+      continue;
+    }
+    erase(victim);
+  }
+  return false;
+}
+
+void SimpleHttpCache::Shard::shrink() {
+  absl::WriterMutexLock lock(mu_);
+  while (shard_set_.overBudget() && !lru_.empty()) {
+    auto victim = entries_.find(*lru_.back());
+    ASSERT(victim != entries_.end());
+    erase(victim);
+  }
+}
+
+bool SimpleHttpCache::Shard::bounded() const { return shard_set_.bounded(); }
+
+void SimpleHttpCache::Shard::charge(Slot& slot, uint64_t size) {
+  if (size > slot.charged_bytes_) {
+    shard_set_.charge(size - slot.charged_bytes_);
+  } else {
+    shard_set_.release(slot.charged_bytes_ - size);
+  }
+  slot.charged_bytes_ = size;
+}
+
+void SimpleHttpCache::Shard::erase(SlotMap::iterator it) {
+  if (bounded()) {
+    shard_set_.release(it->second.charged_bytes_);
+    lru_.erase(it->second.lru_position_);
+  }
+  entries_.erase(it);
+}
+
+size_t SimpleHttpCache::Shard::entryCount() const {
+  absl::ReaderMutexLock lock(mu_);
+  return entries_.size();
+}
+
+SimpleHttpCache::ShardSet::ShardSet(uint64_t max_size_bytes, uint32_t shard_count)
+    : max_size_bytes_(max_size_bytes) {
+  shards_.reserve(shard_count);
+  for (uint32_t i = 0; i < shard_count; i++) {
+    shards_.push_back(std::make_unique<Shard>(*this));
+  }
+}
+
+void SimpleHttpCache::ShardSet::reclaim(const Shard& except) {
+  for (const auto& shard : shards_) {
+    if (!overBudget()) {
+      return;
+    }
+    if (shard.get() != &except) {
+      shard->shrink();
+    }
+  }
+}
+
+size_t SimpleHttpCache::ShardSet::entryCount() const {
+  size_t count = 0;
+  for (const auto& shard : shards_) {
+    count += shard->entryCount();
+  }
+  return count;
+}
+
+SimpleHttpCache::SimpleHttpCache(uint64_t max_size_bytes, uint32_t shard_count)
+    : shards_(std::make_shared<ShardSet>(max_size_bytes,
+                                         shard_count == 0 ? DefaultShardCount : shard_count)) {}
+
 CacheInfo SimpleHttpCache::cacheInfo() const {
   CacheInfo cache_info;
   cache_info.name_ = Name;
@@ -167,35 +472,32 @@ CacheInfo SimpleHttpCache::cacheInfo() const {
 
 void SimpleHttpCache::lookup(LookupRequest&& request, LookupCallback&& callback) {
   LookupResult result;
-  {
-    absl::ReaderMutexLock lock(mu_);
-    auto it = entries_.find(request.key());
-    if (it != entries_.end()) {
-      result.cache_reader_ = std::make_unique<SimpleHttpCacheReader>(it->second);
-      result.response_headers_ = it->second->copyHeaders();
-      result.response_metadata_ = it->second->metadata();
-      result.response_trailers_ = it->second->copyTrailers();
-      result.body_length_ = it->second->bodySize();
-    }
+  const uint64_t hash = MessageUtil::hash(request.key());
+  std::shared_ptr<Entry> entry = shardFor(hash).lookup(request.key(), hash);
+  if (entry) {
+    result.response_headers_ = entry->copyHeaders();
+    result.response_metadata_ = entry->metadata();
+    result.response_trailers_ = entry->copyTrailers();
+    result.body_length_ = entry->bodySize();
+    result.cache_reader_ = std::make_unique<SimpleHttpCacheReader>(std::move(entry));
   }
   callback(std::move(result));
 }
 
 void SimpleHttpCache::evict(Event::Dispatcher&, const Key& key) {
-  absl::WriterMutexLock lock(mu_);
-  entries_.erase(key);
+  shardFor(MessageUtil::hash(key)).evict(key);
+}
+
+void SimpleHttpCache::touch(const Key& key, SystemTime) {
+  shardFor(MessageUtil::hash(key)).touch(key);
 }
 
 void SimpleHttpCache::updateHeaders(Event::Dispatcher&, const Key& key,
                                     const Http::ResponseHeaderMap& updated_headers,
                                     const ResponseMetadata& updated_metadata) {
-  absl::WriterMutexLock lock(mu_);
-  auto it = entries_.find(key);
-  if (it == entries_.end()) {
-    return;
-  }
-  it->second->updateHeadersAndMetadata(
-      Http::createHeaderMap<Http::ResponseHeaderMapImpl>(updated_headers), updated_metadata);
+  shardFor(MessageUtil::hash(key))
+      .updateHeaders(key, Http::createHeaderMap<Http::ResponseHeaderMapImpl>(updated_headers),
+                     updated_metadata);
 }
 
 void SimpleHttpCache::insert(Event::Dispatcher&, Key key, Http::ResponseHeaderMapPtr headers,
@@ -203,19 +505,24 @@ void SimpleHttpCache::insert(Event::Dispatcher&, Key key, Http::ResponseHeaderMa
                              std::shared_ptr<CacheProgressReceiver> progress) {
   auto entry = std::make_shared<Entry>(Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*headers),
                                        std::move(metadata));
-  {
-    absl::WriterMutexLock lock(mu_);
-    entries_.emplace(key, entry);
-  }
+  const uint64_t hash = MessageUtil::hash(key);
+  Shard& shard = shardFor(hash);
+  shard.insert(key, hash, entry);
   if (source) {
     progress->onHeadersInserted(std::make_unique<SimpleHttpCacheReader>(entry), std::move(headers),
                                 false);
-    InsertContext::start(entry, std::move(progress), std::move(source));
+    InsertContext::start(shards_, shard, std::move(key), entry, std::move(progress),
+                         std::move(source));
   } else {
+    shard.onInsertComplete(key, entry);
     progress->onHeadersInserted(nullptr, std::move(headers), true);
   }
 }
 
+uint64_t SimpleHttpCache::sizeBytes() const { return shards_->sizeBytes(); }
+
+size_t SimpleHttpCache::entryCount() const { return shards_->entryCount(); }
+
 SINGLETON_MANAGER_REGISTRATION(simple_http_cache_v2_singleton);
 
 class SimpleHttpCacheFactory : public HttpCacheFactory {
@@ -229,11 +536,15 @@ public:
   }
   // From HttpCacheFactory
   absl::StatusOr<std::shared_ptr<CacheSessions>>
-  getCache(const envoy::extensions::filters::http::cache_v2::v3::CacheV2Config&,
+  getCache(const envoy::extensions::filters::http::cache_v2::v3::CacheV2Config& filter_config,
            Server::Configuration::FactoryContext& context) override {
+    envoy::extensions::http::cache_v2::simple_http_cache::v3::SimpleHttpCacheV2Config config;
+    RETURN_IF_NOT_OK(MessageUtil::unpackTo(filter_config.typed_config(), config));
     return context.serverFactoryContext().singletonManager().getTyped<CacheSessions>(
-        SINGLETON_MANAGER_REGISTERED_NAME(simple_http_cache_v2_singleton), [&context]() {
-          return CacheSessions::create(context, std::make_unique<SimpleHttpCache>());
+        SINGLETON_MANAGER_REGISTERED_NAME(simple_http_cache_v2_singleton), [&context, &config]() {
+          return CacheSessions::create(context,
+                                       std::make_unique<SimpleHttpCache>(
+                                           config.max_cache_size_bytes(), config.shard_count()));
         });
   }
 
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <list>
+#include <memory>
+#include <vector>
+
 #include "source/common/protobuf/utility.h"
 #include "source/extensions/filters/http/cache_v2/http_cache.h"
 
 #include "absl/base/thread_annotations.h"
-#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/synchronization/mutex.h"
 
 namespace Envoy {
@@ -12,16 +17,25 @@ namespace Extensions {
 namespace HttpFilters {
 namespace CacheV2 {
 
-// Example cache backend that never evicts. Not suitable for production use.
+// In-memory cache backend. Entries are spread over independently locked shards by the hash of
+// their key. If the cache is bounded, all shards share one byte budget: a shard that goes over it
+// evicts its own least recently used entries first, with TinyLFU admission keeping rarely
+// requested responses from displacing frequently requested ones, and only then reclaims space from
+// the other shards.
 class SimpleHttpCache : public HttpCache {
 public:
+  static constexpr uint32_t DefaultShardCount = 16;
+
   class Entry {
   public:
     Entry(Http::ResponseHeaderMapPtr response_headers, ResponseMetadata metadata)
         : response_headers_(std::move(response_headers)), metadata_(std::move(metadata)) {}
+    // Returns the range of the body as references to the stored chunks, without copying them.
     Buffer::InstancePtr body(AdjustedByteRange range) const;
     void appendBody(Buffer::InstancePtr buf);
     uint64_t bodySize() const;
+    // The number of bytes the entry is charged against the cache budget.
+    uint64_t sizeBytes() const;
     Http::ResponseHeaderMapPtr copyHeaders() const;
     Http::ResponseTrailerMapPtr copyTrailers() const;
     ResponseMetadata metadata() const;
@@ -31,21 +45,129 @@ public:
     void setEndStreamAfterBody();
 
   private:
+    struct BodyChunk {
+      // The offset in the body one past the last byte of this chunk.
+      uint64_t end_;
+      std::shared_ptr<const std::string> data_;
+    };
+
     mutable absl::Mutex mu_;
-    // Body can be being written to while being read from, so mutex guarded.
-    std::string body_ ABSL_GUARDED_BY(mu_);
+    // Body can be being written to while being read from, so mutex guarded. Chunks are never
+    // modified once appended, so readers can keep referencing them after the lock is released,
+    // and after the entry is evicted.
+    std::vector<BodyChunk> body_ ABSL_GUARDED_BY(mu_);
+    uint64_t body_size_ ABSL_GUARDED_BY(mu_) = 0;
     Http::ResponseHeaderMapPtr response_headers_ ABSL_GUARDED_BY(mu_);
     ResponseMetadata metadata_ ABSL_GUARDED_BY(mu_);
-    bool end_stream_after_body_{false};
-    Http::ResponseTrailerMapPtr trailers_;
+    bool end_stream_after_body_ ABSL_GUARDED_BY(mu_) = false;
+    Http::ResponseTrailerMapPtr trailers_ ABSL_GUARDED_BY(mu_);
   };
 
+  // A count-min sketch of how often keys have been requested recently, with 4-bit saturating
+  // counters that are halved periodically so that past popularity fades.
+  class FrequencySketch {
+  public:
+    FrequencySketch();
+    void increment(uint64_t hash);
+    uint32_t estimate(uint64_t hash) const;
+
+  private:
+    static constexpr uint32_t Depth = 4;
+    static constexpr uint32_t Width = 4096;
+    uint32_t index(uint64_t hash, uint32_t row) const;
+    std::vector<uint8_t> counters_;
+    uint64_t additions_{0};
+  };
+
+  class ShardSet;
+
+  // A partition of the cache with its own lock and LRU order. Its entries are charged against the
+  // budget of the ShardSet it belongs to.
+  class Shard {
+  public:
+    explicit Shard(ShardSet& shard_set) : shard_set_(shard_set) {}
+    std::shared_ptr<Entry> lookup(const Key& key, uint64_t hash);
+    void touch(const Key& key);
+    void evict(const Key& key);
+    void updateHeaders(const Key& key, Http::ResponseHeaderMapPtr response_headers,
+                       const ResponseMetadata& metadata);
+    void insert(const Key& key, uint64_t hash, std::shared_ptr<Entry> entry);
+    // Charges a chunk of body appended to an entry that is being inserted, evicting or rejecting
+    // entries as needed to bring the cache back within budget, so that a response can't exceed it
+    // while it streams in.
+    void onBodyAppended(const Key& key, const std::shared_ptr<Entry>& entry);
+    // Charges the final size of a completely inserted entry, evicting or rejecting entries as
+    // needed to bring the cache back within budget.
+    void onInsertComplete(const Key& key, const std::shared_ptr<Entry>& entry);
+    // Removes an entry whose upstream was reset before it was completely inserted.
+    void onInsertFailed(const Key& key, const std::shared_ptr<Entry>& entry);
+    // Evicts least recently used entries until the cache is within budget or the shard is empty.
+    void shrink();
+    size_t entryCount() const;
+
+  private:
+    struct Slot {
+      std::shared_ptr<Entry> entry_;
+      uint64_t hash_;
+      uint64_t charged_bytes_;
+      std::list<const Key*>::iterator lru_position_;
+    };
+    using SlotMap = absl::node_hash_map<Key, Slot, MessageUtil, MessageUtil>;
+
+    bool bounded() const;
+    // Charges the current size of the entry if it is still cached under the key.
+    void chargeEntry(const Key& key, const std::shared_ptr<Entry>& entry);
+    void charge(Slot& slot, uint64_t size) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    void erase(SlotMap::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    // Evicts this shard's entries other than the candidate, or rejects the candidate, until the
+    // cache is within budget. Returns true if the cache is still over budget once no other entries
+    // are left in this shard.
+    bool enforceBudget(SlotMap::iterator candidate) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+    ShardSet& shard_set_;
+    mutable absl::Mutex mu_;
+    SlotMap entries_ ABSL_GUARDED_BY(mu_);
+    // Keys in the order they were last used, most recent first. Only maintained when bounded.
+    std::list<const Key*> lru_ ABSL_GUARDED_BY(mu_);
+    FrequencySketch sketch_ ABSL_GUARDED_BY(mu_);
+  };
+
+  // The shards of a cache and the byte budget they share. Shared with in-progress inserts, which
+  // charge their entry as its body arrives.
+  class ShardSet {
+  public:
+    // max_size_bytes of zero means the cache is unbounded.
+    ShardSet(uint64_t max_size_bytes, uint32_t shard_count);
+    Shard& shardFor(uint64_t hash) { return *shards_[hash % shards_.size()]; }
+    bool bounded() const { return max_size_bytes_ > 0; }
+    uint64_t maxSizeBytes() const { return max_size_bytes_; }
+    bool overBudget() const { return sizeBytes() > max_size_bytes_; }
+    uint64_t sizeBytes() const { return size_bytes_.load(std::memory_order_relaxed); }
+    void charge(uint64_t bytes) { size_bytes_.fetch_add(bytes, std::memory_order_relaxed); }
+    void release(uint64_t bytes) { size_bytes_.fetch_sub(bytes, std::memory_order_relaxed); }
+    // Shrinks the shards other than `except` until the cache is within budget. These evictions
+    // follow each shard's LRU order, without an admission check against the entry that needs the
+    // space.
+    void reclaim(const Shard& except);
+    size_t entryCount() const;
+
+  private:
+    const uint64_t max_size_bytes_;
+    std::atomic<uint64_t> size_bytes_{0};
+    std::vector<std::unique_ptr<Shard>> shards_;
+  };
+
+  // An unbounded cache.
+  SimpleHttpCache() : SimpleHttpCache(0, DefaultShardCount) {}
+  // max_size_bytes of zero means unbounded; shard_count of zero means DefaultShardCount.
+  SimpleHttpCache(uint64_t max_size_bytes, uint32_t shard_count);
+
   // HttpCache
   CacheInfo cacheInfo() const override;
   void lookup(LookupRequest&& request, LookupCallback&& callback) override;
   void evict(Event::Dispatcher& dispatcher, const Key& key) override;
-  // Touch is to influence expiry, this implementation has no expiry.
-  void touch(const Key&, SystemTime) override {}
+  // This implementation has no expiry, touch only refreshes the entry's eviction order.
+  void touch(const Key& key, SystemTime) override;
   void updateHeaders(Event::Dispatcher& dispatcher, const Key& key,
                      const Http::ResponseHeaderMap& updated_headers,
                      const ResponseMetadata& updated_metadata) override;
@@ -53,9 +175,14 @@ public:
               ResponseMetadata metadata, HttpSourcePtr source,
               std::shared_ptr<CacheProgressReceiver> progress) override;
 
-  absl::Mutex mu_;
-  absl::flat_hash_map<Key, std::shared_ptr<Entry>, MessageUtil, MessageUtil>
-      entries_ ABSL_GUARDED_BY(mu_);
+  // The total number of bytes charged against the budget, and of entries, across all shards.
+  uint64_t sizeBytes() const;
+  size_t entryCount() const;
+
+private:
+  Shard& shardFor(uint64_t hash) const { return shards_->shardFor(hash); }
+
+  const std::shared_ptr<ShardSet> shards_;
 };
 
 } // namespace CacheV2
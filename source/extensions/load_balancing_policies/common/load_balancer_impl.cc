@@ -982,9 +982,11 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
         });
     member_update_cb_ =
         priority_set.addMemberUpdateCb([this](const HostVector& hosts_added, const HostVector&) {
+          refreshing_on_membership_update_ = true;
           for (uint32_t priority : dirty_priorities_) {
             refresh(priority);
           }
+          refreshing_on_membership_update_ = false;
           dirty_priorities_.clear();
           if (isSlowStartEnabled()) {
             recalculateHostsInSlowStart(hosts_added);
@@ -992,7 +994,11 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
         });
   } else {
     priority_update_cb_ = priority_set.addPriorityUpdateCb(
-        [this](uint32_t priority, const HostVector&, const HostVector&) { refresh(priority); });
+        [this](uint32_t priority, const HostVector&, const HostVector&) {
+          refreshing_on_membership_update_ = true;
+          refresh(priority);
+          refreshing_on_membership_update_ = false;
+        });
     member_update_cb_ =
         priority_set.addMemberUpdateCb([this](const HostVector& hosts_added, const HostVector&) {
           if (isSlowStartEnabled()) {
@@ -1037,7 +1043,14 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
   if (priority >= priority_set_.hostSetsPerPriority().size()) {
     return;
   }
-  const auto add_hosts_source = [this](HostsSource source, const HostVector& hosts) {
+  const auto& host_set = priority_set_.hostSetsPerPriority()[priority];
+  // On a membership update the host set knows whether all of its hosts have the same weight, in
+  // which case so do all of the host sources below and none of them needs to be scanned. Weights
+  // changed in place since the update are only seen by scanning.
+  const bool host_set_weights_are_equal =
+      refreshing_on_membership_update_ && host_set->hostWeightsAreEqual();
+  const auto add_hosts_source = [this, host_set_weights_are_equal](HostsSource source,
+                                                                   const HostVector& hosts) {
     // Nuke existing scheduler if it exists.
     auto& scheduler = scheduler_[source] = Scheduler{};
     refreshHostSource(source);
@@ -1049,7 +1062,7 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
     // case EDF creation is skipped. When all original weights are equal and no hosts are in slow
     // start mode we can rely on unweighted host pick to do optimal round robin and least-loaded
     // host selection with lower memory and CPU overhead.
-    if (hostWeightsAreEqual(hosts) && noHostsAreInSlowStart()) {
+    if ((host_set_weights_are_equal || hostWeightsAreEqual(hosts)) && noHostsAreInSlowStart()) {
       // Skip edf creation.
       return;
     }
@@ -1075,7 +1088,6 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
         [this](const Host& host) { return hostWeight(host); }, seed_));
   };
   // Populate EdfSchedulers for each valid HostsSource value for the host set at this priority.
-  const auto& host_set = priority_set_.hostSetsPerPriority()[priority];
   add_hosts_source(HostsSource(priority, HostsSource::SourceType::AllHosts), host_set->hosts());
   add_hosts_source(HostsSource(priority, HostsSource::SourceType::HealthyHosts),
                    host_set->healthyHosts());
@@ -566,6 +566,9 @@ private:
   Common::CallbackHandlePtr priority_update_cb_;
   Common::CallbackHandlePtr member_update_cb_;
   absl::flat_hash_set<uint32_t> dirty_priorities_;
+  // Set while priorities are refreshed because of a membership update, when the host sets'
+  // hostWeightsAreEqual() still matches the weights of their hosts.
+  bool refreshing_on_membership_update_{false};
 
 protected:
   // Slow start related config
@@ -0,0 +1,154 @@
+#include "source/extensions/network/connection_balance/least_connections/least_connections_balancer.h"
+
+#include <thread>
+
+#include "envoy/config/core/v3/extension.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "source/common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Network {
+namespace LeastConnections {
+
+LeastConnectionsBalancerImpl::LeastConnectionsBalancerImpl(Selection selection,
+                                                           Random::RandomGenerator& random)
+    : selection_(selection), random_(random) {}
+
+LeastConnectionsBalancerImpl::~LeastConnectionsBalancerImpl() {
+  for (std::atomic<Chunk*>& chunk : chunks_) {
+    delete chunk.load();
+  }
+}
+
+void LeastConnectionsBalancerImpl::registerHandler(BalancedConnectionHandler& handler) {
+  absl::MutexLock lock(registration_lock_);
+  const uint32_t num_slots = num_slots_.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < num_slots; ++i) {
+    if (slot(i).handler_.load() == nullptr) {
+      slot(i).handler_.store(&handler);
+      return;
+    }
+  }
+
+  if (num_slots == MaxHandlers) {
+    ENVOY_LOG(warn, "least connections balancer is full, connections will not be balanced to a "
+                    "new handler");
+    return;
+  }
+  std::atomic<Chunk*>& chunk = chunks_[num_slots / SlotsPerChunk];
+  if (chunk.load(std::memory_order_relaxed) == nullptr) {
+    chunk.store(new Chunk(), std::memory_order_release);
+  }
+  slot(num_slots).handler_.store(&handler);
+  num_slots_.store(num_slots + 1, std::memory_order_release);
+}
+
+void LeastConnectionsBalancerImpl::unregisterHandler(BalancedConnectionHandler& handler) {
+  absl::MutexLock lock(registration_lock_);
+  const uint32_t num_slots = num_slots_.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < num_slots; ++i) {
+    Slot& handler_slot = slot(i);
+    if (handler_slot.handler_.load() == &handler) {
+      handler_slot.handler_.store(nullptr);
+      // A picker that pinned the slot before the store may still be looking at the handler. Pins
+      // are held for a few instructions, so spin rather than block.
+      while (handler_slot.pins_.load() != 0) {
+        std::this_thread::yield();
+      }
+      return;
+    }
+  }
+}
+
+BalancedConnectionHandler&
+LeastConnectionsBalancerImpl::pickTargetHandler(BalancedConnectionHandler& current_handler) {
+  BalancedConnectionHandler* target = &current_handler;
+  uint64_t target_connections = current_handler.numConnections();
+  // The pinned slot of target, unless target is the current handler.
+  Slot* target_slot = nullptr;
+  const auto consider = [&](Slot& candidate_slot) {
+    BalancedConnectionHandler* candidate = pin(candidate_slot);
+    if (candidate == nullptr) {
+      return;
+    }
+    const uint64_t connections = candidate->numConnections();
+    if (connections >= target_connections) {
+      unpin(candidate_slot);
+      return;
+    }
+    if (target_slot != nullptr) {
+      unpin(*target_slot);
+    }
+    target = candidate;
+    target_connections = connections;
+    target_slot = &candidate_slot;
+  };
+
+  const uint32_t num_slots = num_slots_.load(std::memory_order_acquire);
+  switch (selection_) {
+  case Selection::PowerOfTwoChoices:
+    if (num_slots > 0) {
+      const uint64_t random = random_.random();
+      const uint32_t first = random % num_slots;
+      consider(slot(first));
+      if (num_slots > 1) {
+        // Another slot than the first one, using the high bits of the random value.
+        consider(slot((first + 1 + (random >> 32) % (num_slots - 1)) % num_slots));
+      }
+    }
+    break;
+  case Selection::ApproximateMin:
+    for (uint32_t i = 0; i < num_slots; ++i) {
+      consider(slot(i));
+    }
+    break;
+  }
+
+  target->preIncNumConnections();
+  target->postIncNumConnections();
+  if (target_slot != nullptr) {
+    unpin(*target_slot);
+  }
+  return *target;
+}
+
+LeastConnectionsBalancerImpl::Slot& LeastConnectionsBalancerImpl::slot(uint32_t index) const {
+  return (*chunks_[index / SlotsPerChunk].load(std::memory_order_acquire))[index % SlotsPerChunk];
+}
+
+BalancedConnectionHandler* LeastConnectionsBalancerImpl::pin(Slot& handler_slot) {
+  // Both the increment and the load are sequentially consistent, and so are the store and the
+  // load in unregisterHandler(): either unregisterHandler() sees the pin and waits, or the load
+  // below sees the cleared slot.
+  handler_slot.pins_.fetch_add(1);
+  BalancedConnectionHandler* handler = handler_slot.handler_.load();
+  if (handler == nullptr) {
+    unpin(handler_slot);
+  }
+  return handler;
+}
+
+void LeastConnectionsBalancerImpl::unpin(Slot& handler_slot) {
+  handler_slot.pins_.fetch_sub(1, std::memory_order_release);
+}
+
+ConnectionBalancerSharedPtr LeastConnectionsBalanceFactory::createConnectionBalancerFromProto(
+    const Protobuf::Message& config, Server::Configuration::FactoryContext& context) {
+  const auto& typed_config =
+      dynamic_cast<const envoy::config::core::v3::TypedExtensionConfig&>(config);
+  const auto balance_config = MessageUtil::anyConvertAndValidate<LeastConnectionsBalanceProto>(
+      typed_config.typed_config(), context.messageValidationVisitor());
+  const LeastConnectionsBalancerImpl::Selection selection =
+      balance_config.selection() == LeastConnectionsBalanceProto::APPROXIMATE_MIN
+          ? LeastConnectionsBalancerImpl::Selection::ApproximateMin
+          : LeastConnectionsBalancerImpl::Selection::PowerOfTwoChoices;
+  return std::make_shared<LeastConnectionsBalancerImpl>(
+      selection, context.serverFactoryContext().api().randomGenerator());
+}
+
+REGISTER_FACTORY(LeastConnectionsBalanceFactory, ConnectionBalanceFactory);
+
+} // namespace LeastConnections
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/random_generator.h"
+#include "envoy/extensions/network/connection_balance/least_connections/v3/least_connections.pb.h"
+#include "envoy/extensions/network/connection_balance/least_connections/v3/least_connections.pb.validate.h"
+#include "envoy/network/connection_balancer.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/network/connection_balancer_impl.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Network {
+namespace LeastConnections {
+
+using LeastConnectionsBalanceProto =
+    envoy::extensions::network::connection_balance::least_connections::v3::LeastConnectionsBalance;
+
+/**
+ * Connection balancer that hands each connection to the handler with the fewest connections,
+ * like ExactConnectionBalancerImpl, but without a lock shared by the handlers. Handlers are kept
+ * in slots that pickers read without locking; a picker pins the slots it looks at, and
+ * unregisterHandler() waits for the slot of the handler to be unpinned, so that a handler is not
+ * destroyed while it is being looked at. Connection counts change while they are compared, so
+ * balancing is approximate.
+ *
+ * The current handler is always a candidate, and is kept on ties, so that a connection only
+ * moves to another worker when that worker has fewer connections.
+ */
+class LeastConnectionsBalancerImpl : public ConnectionBalancer,
+                                     public Logger::Loggable<Logger::Id::conn_handler> {
+public:
+  enum class Selection {
+    // Compare the current handler with two handlers picked at random.
+    PowerOfTwoChoices,
+    // Compare the current handler with every handler.
+    ApproximateMin,
+  };
+
+  // Slots are allocated in chunks, so that pickers can index them while handlers are registered.
+  static constexpr uint32_t SlotsPerChunk = 64;
+  static constexpr uint32_t MaxChunks = 64;
+  static constexpr uint32_t MaxHandlers = SlotsPerChunk * MaxChunks;
+
+  LeastConnectionsBalancerImpl(Selection selection, Random::RandomGenerator& random);
+  ~LeastConnectionsBalancerImpl() override;
+
+  // ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler& handler) override;
+  void unregisterHandler(BalancedConnectionHandler& handler) override;
+  BalancedConnectionHandler& pickTargetHandler(BalancedConnectionHandler& current_handler) override;
+
+private:
+  // Each slot has a cache line of its own, as it is written by every picker that looks at it.
+  struct alignas(64) Slot {
+    std::atomic<BalancedConnectionHandler*> handler_{};
+    // Number of pickers looking at handler_.
+    std::atomic<uint32_t> pins_{};
+  };
+  using Chunk = std::array<Slot, SlotsPerChunk>;
+
+  Slot& slot(uint32_t index) const;
+  // Pins the slot, and returns its handler, or nullptr and leaves the slot unpinned if it is empty.
+  static BalancedConnectionHandler* pin(Slot& handler_slot);
+  static void unpin(Slot& handler_slot);
+
+  const Selection selection_;
+  Random::RandomGenerator& random_;
+  std::array<std::atomic<Chunk*>, MaxChunks> chunks_{};
+  // Number of slots that have been handed out. Pickers only look at slots below it.
+  std::atomic<uint32_t> num_slots_{0};
+  // Serializes registration. Never taken by pickers.
+  absl::Mutex registration_lock_;
+};
+
+/**
+ * Config registration for the least connections connection balancer.
+ */
+class LeastConnectionsBalanceFactory : public ConnectionBalanceFactory {
+public:
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<LeastConnectionsBalanceProto>();
+  }
+  ConnectionBalancerSharedPtr
+  createConnectionBalancerFromProto(const Protobuf::Message& config,
+                                    Server::Configuration::FactoryContext& context) override;
+  std::string name() const override {
+    return "envoy.network.connection_balance.least_connections";
+  }
+};
+
+} // namespace LeastConnections
+} // namespace Network
+} // namespace Envoy
@@ -10,10 +10,10 @@
 #include "envoy/stats/scope.h"
 #include "envoy/upstream/cluster_manager.h"
 
-#include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/fmt.h"
+#include "source/common/common/lock_guard.h"
 #include "source/common/common/utility.h"
 #include "source/common/config/utility.h"
 #include "source/common/network/socket_interface.h"
@@ -28,6 +28,39 @@ namespace StatSinks {
 namespace Common {
 namespace Statsd {
 
+void DatagramBatch::add(absl::string_view metric, uint64_t max_datagram_size) {
+  if (metric.size() >= max_datagram_size) {
+    // The metric is too large to share a datagram; give it one of its own.
+    data_.append(metric.data(), metric.size());
+    ends_.push_back(data_.size());
+    last_open_ = false;
+    return;
+  }
+  if (last_open_ && (datagram(ends_.size() - 1).size() + metric.size() + 1) <= max_datagram_size) {
+    // There is room in the last datagram, add a newline to separate metric entries.
+    data_.push_back('\n');
+    data_.append(metric.data(), metric.size());
+    ends_.back() = data_.size();
+    return;
+  }
+  data_.append(metric.data(), metric.size());
+  ends_.push_back(data_.size());
+  last_open_ = true;
+}
+
+void DatagramBatch::clear() {
+  data_.clear();
+  ends_.clear();
+  last_open_ = false;
+}
+
+void UdpStatsdSink::Writer::writeBatch(const DatagramBatch& batch) {
+  for (size_t i = 0; i < batch.size(); ++i) {
+    Buffer::OwnedImpl buffer(batch.datagram(i));
+    writeBuffer(buffer);
+  }
+}
+
 UdpStatsdSink::WriterImpl::WriterImpl(UdpStatsdSink& parent)
     : parent_(parent), io_handle_(Network::ioHandleForAddr(Network::Socket::Type::Datagram,
                                                            parent_.server_address_, {})) {}
@@ -43,75 +76,151 @@ void UdpStatsdSink::WriterImpl::writeBuffer(Buffer::Instance& data) {
   Network::Utility::writeToSocket(*io_handle_, data, nullptr, *parent_.server_address_);
 }
 
+void UdpStatsdSink::WriterImpl::writeBatch(const DatagramBatch& batch) {
+  const size_t count = batch.size();
+  slices_.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const absl::string_view datagram = batch.datagram(i);
+    slices_[i] = {const_cast<char*>(datagram.data()), datagram.size()};
+  }
+
+  const absl::Span<const Buffer::RawSlice> slices(slices_);
+  size_t sent = 0;
+  while (sent < count) {
+    const Api::IoCallUint64Result result =
+        io_handle_->sendmmsg(slices.subspan(sent), *parent_.server_address_);
+    if (result.ok() && result.return_value_ > 0) {
+      sent += result.return_value_;
+    } else if (result.wouldBlock()) {
+      // The socket buffer is full, and the rest of the batch would fail the same way.
+      if (parent_.udp_batches_dropped_stat_ != nullptr) {
+        parent_.udp_batches_dropped_stat_->inc();
+      }
+      return;
+    } else {
+      // Only the first datagram could not be sent. Skip it and carry on with the rest, as writing
+      // the datagrams one at a time would.
+      ++sent;
+    }
+  }
+}
+
+UdpStatsdSink::FlushThread::FlushThread(Thread::ThreadFactory& thread_factory,
+                                        std::shared_ptr<Writer> writer)
+    : writer_(std::move(writer)),
+      thread_(thread_factory.createThread([this]() { threadRoutine(); },
+                                          Thread::Options{"StatsdFlush"})) {}
+
+UdpStatsdSink::FlushThread::~FlushThread() {
+  {
+    Thread::LockGuard lock(mutex_);
+    terminate_ = true;
+    work_available_.notifyOne();
+  }
+  thread_->join();
+}
+
+void UdpStatsdSink::FlushThread::enqueue(DatagramBatch&& batch) {
+  Thread::LockGuard lock(mutex_);
+  if (queue_.size() >= MaxQueuedBatches) {
+    return;
+  }
+  queue_.push_back(std::move(batch));
+  work_available_.notifyOne();
+}
+
+void UdpStatsdSink::FlushThread::threadRoutine() {
+  while (true) {
+    DatagramBatch batch;
+    {
+      Thread::LockGuard lock(mutex_);
+      while (!terminate_ && queue_.empty()) {
+        work_available_.wait(mutex_);
+      }
+      if (terminate_) {
+        return;
+      }
+      batch = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    writer_->writeBatch(batch);
+  }
+}
+
 UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
                              Network::Address::InstanceConstSharedPtr address, const bool use_tag,
                              const std::string& prefix, absl::optional<uint64_t> buffer_size,
-                             const Statsd::TagFormat& tag_format)
+                             const Statsd::TagFormat& tag_format,
+                             OptRef<Thread::ThreadFactory> flush_thread_factory,
+                             OptRef<Stats::Scope> scope)
     : tls_(tls.allocateSlot()), server_address_(std::move(address)), use_tag_(use_tag),
       prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix),
-      buffer_size_(buffer_size.value_or(0)), tag_format_(tag_format) {
+      buffer_size_(buffer_size.value_or(0)), tag_format_(tag_format),
+      udp_batches_dropped_stat_(
+          scope.has_value()
+              ? &scope->counterFromStatName(
+                    Stats::StatNameManagedStorage("statsd.udp_batches_dropped",
+                                                  scope->symbolTable())
+                        .statName())
+              : nullptr) {
   tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::make_shared<WriterImpl>(*this);
   });
+  if (flush_thread_factory.has_value()) {
+    // The flush thread gets a writer, and so a socket, of its own.
+    flush_thread_ =
+        std::make_unique<FlushThread>(*flush_thread_factory, std::make_shared<WriterImpl>(*this));
+  }
 }
 
 void UdpStatsdSink::flush(Stats::MetricSnapshot& snapshot) {
-  Writer& writer = tls_->getTyped<Writer>();
-  Buffer::OwnedImpl buffer;
+  DatagramBatch batch;
 
   for (const auto& counter : snapshot.counters()) {
     if (counter.counter_.get().used()) {
       const std::string counter_str = buildMessage(counter.counter_.get(), counter.delta_, "|c");
-      writeBuffer(buffer, writer, counter_str);
+      addToBatch(batch, counter_str);
     }
   }
 
   for (const auto& counter : snapshot.hostCounters()) {
     const std::string counter_str = buildMessage(counter, counter.delta(), "|c");
-    writeBuffer(buffer, writer, counter_str);
+    addToBatch(batch, counter_str);
   }
 
   for (const auto& gauge : snapshot.gauges()) {
     if (gauge.get().used()) {
       const std::string gauge_str = buildMessage(gauge.get(), gauge.get().value(), "|g");
-      writeBuffer(buffer, writer, gauge_str);
+      addToBatch(batch, gauge_str);
     }
   }
 
   for (const auto& gauge : snapshot.hostGauges()) {
     const std::string gauge_str = buildMessage(gauge, gauge.value(), "|g");
-    writeBuffer(buffer, writer, gauge_str);
+    addToBatch(batch, gauge_str);
   }
 
-  flushBuffer(buffer, writer);
+  writeBatch(batch);
   // TODO(efimki): Add support of text readouts stats.
 }
 
-void UdpStatsdSink::writeBuffer(Buffer::OwnedImpl& buffer, Writer& writer,
-                                const std::string& statsd_metric) const {
-  if (statsd_metric.length() >= buffer_size_) {
-    // Our statsd_metric is too large to fit into the buffer, skip buffering and write directly
-    writer.write(statsd_metric);
-  } else {
-    if ((buffer.length() + statsd_metric.length() + 1) > buffer_size_) {
-      // If we add the new statsd_metric, we'll overflow our buffer. Flush the buffer to make
-      // room for the new statsd_metric.
-      flushBuffer(buffer, writer);
-    } else if (buffer.length() > 0) {
-      // We have room and have metrics already in the buffer, add a newline to separate
-      // metric entries.
-      buffer.add("\n");
-    }
-    buffer.add(statsd_metric);
+void UdpStatsdSink::addToBatch(DatagramBatch& batch, const std::string& statsd_metric) {
+  batch.add(statsd_metric, buffer_size_);
+  if (batch.size() >= MaxDatagramsPerBatch) {
+    writeBatch(batch);
   }
 }
 
-void UdpStatsdSink::flushBuffer(Buffer::OwnedImpl& buffer, Writer& writer) const {
-  if (buffer.length() == 0) {
+void UdpStatsdSink::writeBatch(DatagramBatch& batch) {
+  if (batch.empty()) {
     return;
   }
-  writer.writeBuffer(buffer);
-  buffer.drain(buffer.length());
+  if (flush_thread_ != nullptr) {
+    flush_thread_->enqueue(std::move(batch));
+  } else {
+    tls_->getTyped<Writer>().writeBatch(batch);
+  }
+  batch.clear();
 }
 
 void UdpStatsdSink::onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) {
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <deque>
+
 #include "envoy/buffer/buffer.h"
+#include "envoy/common/optref.h"
 #include "envoy/common/platform.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/network/connection.h"
@@ -9,14 +12,17 @@
 #include "envoy/stats/sink.h"
 #include "envoy/stats/stats.h"
 #include "envoy/stats/tag.h"
+#include "envoy/thread/thread.h"
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/macros.h"
+#include "source/common/common/thread.h"
 #include "source/common/network/io_socket_handle_impl.h"
 #include "source/extensions/stat_sinks/common/statsd/tag_formats.h"
 
+#include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
@@ -27,6 +33,41 @@ namespace Statsd {
 
 static const std::string& getDefaultPrefix() { CONSTRUCT_ON_FIRST_USE(std::string, "envoy"); }
 
+/**
+ * The datagrams built by a flush of the UDP statsd sink. They are stored back to back in a single
+ * string, so that building a batch does not allocate per datagram.
+ */
+class DatagramBatch {
+public:
+  /**
+   * Adds a metric. Metrics are packed into the last datagram, separated by newlines, as long as
+   * it stays within max_datagram_size bytes. A metric which does not fit within max_datagram_size
+   * on its own is given a datagram of its own.
+   * @param metric supplies the metric to add.
+   * @param max_datagram_size supplies the maximum size of a datagram with several metrics.
+   */
+  void add(absl::string_view metric, uint64_t max_datagram_size);
+
+  /**
+   * @return the datagram at the given index.
+   */
+  absl::string_view datagram(size_t index) const {
+    const size_t begin = index == 0 ? 0 : ends_[index - 1];
+    return absl::string_view(data_).substr(begin, ends_[index] - begin);
+  }
+
+  size_t size() const { return ends_.size(); }
+  bool empty() const { return ends_.empty(); }
+  void clear();
+
+private:
+  std::string data_;
+  // The end offset of each datagram in data_.
+  std::vector<size_t> ends_;
+  // Whether more metrics may be appended to the last datagram.
+  bool last_open_{false};
+};
+
 /**
  * Implementation of Sink that writes to a UDP statsd address.
  */
@@ -39,22 +80,46 @@ public:
   public:
     virtual void write(const std::string& message) PURE;
     virtual void writeBuffer(Buffer::Instance& data) PURE;
+
+    /**
+     * Writes all the datagrams of a batch. The default implementation writes them one at a time
+     * with writeBuffer().
+     * @param batch supplies the datagrams to write.
+     */
+    virtual void writeBatch(const DatagramBatch& batch);
   };
 
+  // The maximum number of datagrams handed to the writer at once. This is the most that a single
+  // sendmmsg() call accepts on Linux (UIO_MAXIOV).
+  static constexpr size_t MaxDatagramsPerBatch = 1024;
+
+  /**
+   * @param flush_thread_factory if set, the datagrams built by flush() are written from a
+   *        dedicated thread created with this factory, so that the main thread does not block
+   *        on the socket.
+   * @param scope if set, statsd.udp_batches_dropped is counted in it each time the rest of a batch
+   *        is dropped because the socket buffer is full.
+   */
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address,
                 const bool use_tag, const std::string& prefix = getDefaultPrefix(),
                 absl::optional<uint64_t> buffer_size = absl::nullopt,
-                const Statsd::TagFormat& tag_format = Statsd::getDefaultTagFormat());
+                const Statsd::TagFormat& tag_format = Statsd::getDefaultTagFormat(),
+                OptRef<Thread::ThreadFactory> flush_thread_factory = {},
+                OptRef<Stats::Scope> scope = {});
   // For testing.
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, const std::shared_ptr<Writer>& writer,
                 const bool use_tag, const std::string& prefix = getDefaultPrefix(),
                 absl::optional<uint64_t> buffer_size = absl::nullopt,
-                const Statsd::TagFormat& tag_format = Statsd::getDefaultTagFormat())
+                const Statsd::TagFormat& tag_format = Statsd::getDefaultTagFormat(),
+                OptRef<Thread::ThreadFactory> flush_thread_factory = {})
       : tls_(tls.allocateSlot()), use_tag_(use_tag),
         prefix_(prefix.empty() ? getDefaultPrefix() : prefix),
         buffer_size_(buffer_size.value_or(0)), tag_format_(tag_format) {
     tls_->set(
         [writer](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr { return writer; });
+    if (flush_thread_factory.has_value()) {
+      flush_thread_ = std::make_unique<FlushThread>(*flush_thread_factory, writer);
+    }
   }
 
   // Stats::Sink
@@ -76,14 +141,45 @@ private:
     // Writer
     void write(const std::string& message) override;
     void writeBuffer(Buffer::Instance& data) override;
+    void writeBatch(const DatagramBatch& batch) override;
 
   private:
     UdpStatsdSink& parent_;
     const Network::IoHandlePtr io_handle_;
+    // Reused across batches to avoid allocating on every flush.
+    std::vector<Buffer::RawSlice> slices_;
+  };
+
+  /**
+   * Writes the batches built by flush() on a dedicated thread.
+   */
+  class FlushThread {
+  public:
+    FlushThread(Thread::ThreadFactory& thread_factory, std::shared_ptr<Writer> writer);
+    ~FlushThread();
+
+    /**
+     * Queues a batch to be written. The batch is dropped if the thread is too far behind.
+     */
+    void enqueue(DatagramBatch&& batch);
+
+  private:
+    void threadRoutine();
+
+    // If this many batches are waiting, the statsd server or the network cannot keep up, and
+    // further batches are dropped rather than buffered without bound.
+    static constexpr size_t MaxQueuedBatches = 1024;
+
+    const std::shared_ptr<Writer> writer_;
+    Thread::MutexBasicLockable mutex_;
+    Thread::CondVar work_available_;
+    std::deque<DatagramBatch> queue_ ABSL_GUARDED_BY(mutex_);
+    bool terminate_ ABSL_GUARDED_BY(mutex_){false};
+    Thread::ThreadPtr thread_;
   };
 
-  void flushBuffer(Buffer::OwnedImpl& buffer, Writer& writer) const;
-  void writeBuffer(Buffer::OwnedImpl& buffer, Writer& writer, const std::string& data) const;
+  void addToBatch(DatagramBatch& batch, const std::string& statsd_metric);
+  void writeBatch(DatagramBatch& batch);
 
   template <class StatType, typename ValueType>
   const std::string buildMessage(const StatType& metric, ValueType value,
@@ -98,6 +194,9 @@ private:
   const std::string prefix_;
   const uint64_t buffer_size_;
   const Statsd::TagFormat tag_format_;
+  // Only set if the sink was given a scope. Incremented from the flush thread too.
+  Stats::Counter* const udp_batches_dropped_stat_{};
+  std::unique_ptr<FlushThread> flush_thread_;
 };
 
 /**
@@ -1,5 +1,6 @@
 #include "source/extensions/stat_sinks/open_telemetry/open_telemetry_impl.h"
 
+#include "source/common/stats/exponential_histogram.h"
 #include "source/common/tracing/null_span_impl.h"
 #include "source/extensions/stat_sinks/open_telemetry/stat_match_action.h"
 
@@ -20,7 +21,8 @@ using HistogramDataPoint = opentelemetry::proto::metrics::v1::HistogramDataPoint
 using KeyValue = opentelemetry::proto::common::v1::KeyValue;
 
 MetricAggregator::AggregationResult MetricAggregator::releaseResult() {
-  return {std::move(gauge_data_), std::move(counter_data_), std::move(histogram_data_)};
+  return {std::move(gauge_data_), std::move(counter_data_), std::move(histogram_data_),
+          std::move(exponential_histogram_data_)};
 }
 
 void MetricAggregator::addGauge(std::string&& metric_name, uint64_t value,
@@ -85,14 +87,43 @@ void MetricAggregator::addHistogram(std::string&& metric_name,
   }
 }
 
+void MetricAggregator::addExponentialHistogram(std::string&& metric_name,
+                                               CustomExponentialHistogram&& hist,
+                                               SortedAttributesVector&& attributes) {
+  if (hist.count_ == 0 &&
+      histogram_temporality_ == AggregationTemporality::AGGREGATION_TEMPORALITY_DELTA) {
+    return;
+  }
+
+  MetricKey key{std::move(metric_name), std::move(attributes)};
+  auto it = exponential_histogram_data_.find(key);
+  if (it != exponential_histogram_data_.end()) {
+    auto& existing_point = it->second;
+    if (existing_point.zero_threshold_ == hist.zero_threshold_) {
+      // The exponential buckets are derived from the union of the log-linear buckets when the
+      // point is emitted, so merging only needs to collect them.
+      existing_point.count_ += hist.count_;
+      existing_point.sum_ += hist.sum_;
+      existing_point.buckets_.insert(existing_point.buckets_.end(), hist.buckets_.begin(),
+                                     hist.buckets_.end());
+    } else {
+      ENVOY_LOG(error, "Histogram unit mismatch for metric {} aggregated from stat", key.name());
+    }
+  } else {
+    exponential_histogram_data_.emplace(std::move(key), std::move(hist));
+  }
+}
+
 RequestStreamer::RequestStreamer(
     uint32_t max_dp,
     const Protobuf::RepeatedPtrField<opentelemetry::proto::common::v1::KeyValue>&
         resource_attributes,
     AggregationTemporality counter_temporality, AggregationTemporality histogram_temporality,
     absl::AnyInvocable<void(MetricsExportRequestPtr)> send_callback, int64_t snapshot_time_ns,
-    int64_t delta_start_time_ns, int64_t cumulative_start_time_ns, bool enable_metric_aggregation)
+    int64_t delta_start_time_ns, int64_t cumulative_start_time_ns, bool enable_metric_aggregation,
+    uint32_t exponential_histogram_max_buckets)
     : max_dp_(max_dp), enable_metric_aggregation_(enable_metric_aggregation),
+      exponential_histogram_max_buckets_(exponential_histogram_max_buckets),
       resource_attributes_(resource_attributes), counter_temporality_(counter_temporality),
       histogram_temporality_(histogram_temporality), send_callback_(std::move(send_callback)),
       snapshot_time_ns_(snapshot_time_ns), delta_start_time_ns_(delta_start_time_ns),
@@ -223,6 +254,37 @@ void RequestStreamer::addHistogram(std::string&& name,
   addHistogram(std::move(name), std::move(custom_hist), std::move(attributes));
 }
 
+void RequestStreamer::addExponentialHistogram(
+    std::string&& name, MetricAggregator::CustomExponentialHistogram&& hist,
+    MetricAggregator::SortedAttributesVector&& attributes) {
+  sendIfFullAndPrepareRequest();
+  auto temp = histogram_temporality_;
+  if (hist.count_ == 0 && temp == AggregationTemporality::AGGREGATION_TEMPORALITY_DELTA) {
+    return;
+  }
+  auto* metric = findOrCreateMetric(std::move(name));
+  if (metric->mutable_exponential_histogram()->data_points_size() == 0) {
+    metric->mutable_exponential_histogram()->set_aggregation_temporality(temp);
+  }
+  auto* point = metric->mutable_exponential_histogram()->add_data_points();
+  point->set_count(hist.count_);
+  point->set_sum(hist.sum_);
+  point->set_zero_threshold(hist.zero_threshold_);
+
+  const Stats::ExponentialHistogram::Buckets buckets =
+      Stats::ExponentialHistogram::fromDetailedBuckets(
+          hist.buckets_, exponential_histogram_max_buckets_, hist.zero_threshold_);
+  point->set_scale(buckets.scale_);
+  point->set_zero_count(buckets.zero_count_);
+  if (!buckets.counts_.empty()) {
+    auto* positive = point->mutable_positive();
+    positive->set_offset(buckets.offset_);
+    positive->mutable_bucket_counts()->Add(buckets.counts_.begin(), buckets.counts_.end());
+  }
+  setCommonFields(point, std::move(attributes), temp);
+  dp_num_++;
+}
+
 void RequestStreamer::addAggregationResult(MetricAggregator::AggregationResult&& metrics) {
   while (!metrics.gauge_data_.empty()) {
     auto node = metrics.gauge_data_.extract(metrics.gauge_data_.begin());
@@ -239,6 +301,13 @@ void RequestStreamer::addAggregationResult(MetricAggregator::AggregationResult&&
     auto& key = node.key();
     addHistogram(key.releaseName(), std::move(node.mapped()), key.releaseAttributes());
   }
+  while (!metrics.exponential_histogram_data_.empty()) {
+    auto node = metrics.exponential_histogram_data_.extract(
+        metrics.exponential_histogram_data_.begin());
+    auto& key = node.key();
+    addExponentialHistogram(key.releaseName(), std::move(node.mapped()),
+                            key.releaseAttributes());
+  }
 }
 
 void RequestStreamer::send() {
@@ -283,7 +352,14 @@ OtlpOptions::OtlpOptions(const SinkConfig& sink_config,
       enable_metric_aggregation_(sink_config.has_custom_metric_conversions()),
       resource_attributes_(generateResourceAttributes(resource)),
       matcher_(createMatcher(sink_config.custom_metric_conversions(), server)),
-      max_data_points_per_request_(sink_config.max_data_points_per_request()) {}
+      max_data_points_per_request_(sink_config.max_data_points_per_request()),
+      exponential_histogram_max_buckets_(
+          sink_config.has_exponential_histogram()
+              ? absl::make_optional(
+                    PROTOBUF_GET_WRAPPED_OR_DEFAULT(sink_config.exponential_histogram(),
+                                                    max_buckets,
+                                                    DefaultExponentialHistogramMaxBuckets))
+              : absl::nullopt) {}
 
 OpenTelemetryGrpcMetricsExporterImpl::OpenTelemetryGrpcMetricsExporterImpl(
     const OtlpOptionsSharedPtr config, Grpc::RawAsyncClientSharedPtr raw_async_client)
@@ -420,6 +496,7 @@ void OtlpMetricsFlusherImpl::sinkMetrics(Stats::MetricSnapshot& snapshot, SinkTy
 
   // Process Histograms
   const bool report_histograms_as_deltas = config_->reportHistogramsAsDeltas();
+  const bool report_exponential_histograms = config_->exponentialHistogramMaxBuckets().has_value();
   for (const auto& histogram : snapshot.histograms()) {
     const auto& h = histogram.get();
     if (predicate_(h)) {
@@ -429,6 +506,18 @@ void OtlpMetricsFlusherImpl::sinkMetrics(Stats::MetricSnapshot& snapshot, SinkTy
       }
       const Stats::HistogramStatistics& histogram_stats =
           report_histograms_as_deltas ? h.intervalStatistics() : h.cumulativeStatistics();
+      if (report_exponential_histograms) {
+        // Read the log-linear buckets directly rather than the explicit bucket summary, so the
+        // exponential buckets are not limited to the configured histogram bucket bounds.
+        MetricAggregator::CustomExponentialHistogram exponential_hist{
+            histogram_stats.sampleCount(), histogram_stats.sampleSum(),
+            Stats::ExponentialHistogram::zeroThreshold(h.unit()),
+            report_histograms_as_deltas ? h.detailedIntervalBuckets() : h.detailedTotalBuckets()};
+        sink.addExponentialHistogram(getMetricName(h, metric_config.conversion_action),
+                                     std::move(exponential_hist),
+                                     getCombinedAttributes(h, metric_config.conversion_action));
+        continue;
+      }
       sink.addHistogram(getMetricName(h, metric_config.conversion_action), histogram_stats,
                         getCombinedAttributes(h, metric_config.conversion_action));
     }
@@ -445,7 +534,8 @@ void OtlpMetricsFlusherImpl::flush(
   RequestStreamer streamer(config_->maxDataPointsPerRequest(), config_->resource_attributes(),
                            counter_temporality_, histogram_temporality_, std::move(send_callback),
                            snapshot_time, delta_start_time_ns, cumulative_start_time_ns,
-                           config_->enableMetricAggregation());
+                           config_->enableMetricAggregation(),
+                           config_->exponentialHistogramMaxBuckets().value_or(0));
 
   if (!config_->enableMetricAggregation()) {
     sinkMetrics(snapshot, streamer);
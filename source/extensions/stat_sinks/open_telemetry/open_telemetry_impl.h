@@ -110,11 +110,24 @@ public:
     std::vector<double> explicit_bounds_;
   };
 
+  struct CustomExponentialHistogram {
+    // Total number of data points.
+    uint64_t count_;
+    // Sum of all data point values.
+    double sum_;
+    // Values in buckets at or below this are reported in the zero bucket.
+    double zero_threshold_;
+    // The underlying log-linear buckets, possibly from several stats. These are only converted
+    // into exponential buckets once the data point is emitted.
+    std::vector<Stats::ParentHistogram::Bucket> buckets_;
+  };
+
   // Maps a unique combination of metric name and attributes to their data point.
   struct AggregationResult {
     absl::flat_hash_map<MetricKey, uint64_t> gauge_data_;
     absl::flat_hash_map<MetricKey, uint64_t> counter_data_;
     absl::flat_hash_map<MetricKey, CustomHistogram> histogram_data_;
+    absl::flat_hash_map<MetricKey, CustomExponentialHistogram> exponential_histogram_data_;
   };
 
   AggregationResult releaseResult();
@@ -132,10 +145,16 @@ public:
   void addHistogram(std::string&& metric_name, const Envoy::Stats::HistogramStatistics& stats,
                     SortedAttributesVector&& attributes);
 
+  // Adds an exponential histogram data point. Aggregates counts, sums and buckets if a point
+  // with the same attributes and zero threshold exists.
+  void addExponentialHistogram(std::string&& metric_name, CustomExponentialHistogram&& hist,
+                               SortedAttributesVector&& attributes);
+
 private:
   absl::flat_hash_map<MetricKey, uint64_t> gauge_data_;
   absl::flat_hash_map<MetricKey, uint64_t> counter_data_;
   absl::flat_hash_map<MetricKey, CustomHistogram> histogram_data_;
+  absl::flat_hash_map<MetricKey, CustomExponentialHistogram> exponential_histogram_data_;
   const AggregationTemporality counter_temporality_;
   const AggregationTemporality histogram_temporality_;
 };
@@ -155,7 +174,8 @@ public:
                   opentelemetry::proto::metrics::v1::AggregationTemporality histogram_temporality,
                   absl::AnyInvocable<void(MetricsExportRequestPtr)> send_callback,
                   int64_t snapshot_time_ns, int64_t delta_start_time_ns,
-                  int64_t cumulative_start_time_ns, bool enable_metric_aggregation);
+                  int64_t cumulative_start_time_ns, bool enable_metric_aggregation,
+                  uint32_t exponential_histogram_max_buckets = 0);
 
   // Adds a gauge metric data point to the streamer.
   void addGauge(std::string&& name, uint64_t value,
@@ -173,6 +193,12 @@ public:
   void addHistogram(std::string&& name, const Envoy::Stats::HistogramStatistics& stats,
                     MetricAggregator::SortedAttributesVector&& attributes);
 
+  // Adds an exponential histogram data point to the streamer, converting its log-linear buckets
+  // into at most `exponential_histogram_max_buckets` exponential buckets.
+  void addExponentialHistogram(std::string&& name,
+                               MetricAggregator::CustomExponentialHistogram&& hist,
+                               MetricAggregator::SortedAttributesVector&& attributes);
+
   // Adds all metrics from an aggregation result to the streamer.
   void addAggregationResult(MetricAggregator::AggregationResult&& result);
 
@@ -196,6 +222,7 @@ private:
 
   const uint32_t max_dp_;
   const bool enable_metric_aggregation_;
+  const uint32_t exponential_histogram_max_buckets_;
   const Protobuf::RepeatedPtrField<opentelemetry::proto::common::v1::KeyValue>&
       resource_attributes_;
   const opentelemetry::proto::metrics::v1::AggregationTemporality counter_temporality_;
@@ -218,6 +245,9 @@ private:
 
 class OtlpOptions {
 public:
+  // Matches the default maximum size of exponential histograms in the OpenTelemetry SDKs.
+  static constexpr uint32_t DefaultExponentialHistogramMaxBuckets = 160;
+
   OtlpOptions(const SinkConfig& sink_config, const Tracers::OpenTelemetry::Resource& resource,
               Server::Configuration::ServerFactoryContext& server);
 
@@ -237,6 +267,11 @@ public:
   }
   bool enableMetricAggregation() const { return enable_metric_aggregation_; }
 
+  // If set, histograms are exported as exponential histograms with at most this many buckets.
+  absl::optional<uint32_t> exponentialHistogramMaxBuckets() const {
+    return exponential_histogram_max_buckets_;
+  }
+
   uint32_t maxDataPointsPerRequest() const { return max_data_points_per_request_; }
 
 private:
@@ -249,6 +284,7 @@ private:
   const Protobuf::RepeatedPtrField<opentelemetry::proto::common::v1::KeyValue> resource_attributes_;
   const Envoy::Matcher::MatchTreeSharedPtr<Stats::StatMatchingData> matcher_;
   const uint32_t max_data_points_per_request_;
+  const absl::optional<uint32_t> exponential_histogram_max_buckets_;
 };
 
 using OtlpOptionsSharedPtr = std::shared_ptr<OtlpOptions>;
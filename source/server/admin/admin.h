@@ -235,6 +235,8 @@ public:
   const HttpConnectionManagerProto::ProxyStatusConfig* proxyStatusConfig() const override {
     return proxy_status_config_.get();
   }
+  const Http::FilterLatencyConfig* filterLatencyConfig() const override { return nullptr; }
+  uint32_t streamArenaInitialBlockSize() const override { return 0; }
   Http::ServerHeaderValidatorPtr
   makeHeaderValidator([[maybe_unused]] Http::Protocol protocol) override {
 #ifdef ENVOY_ENABLE_UHV
@@ -401,6 +403,9 @@ private:
     std::chrono::milliseconds perConnectionBufferHighWatermarkTimeout() const override {
       return std::chrono::milliseconds::zero();
     }
+    std::chrono::milliseconds perConnectionIdleMemoryShedTimeout() const override {
+      return std::chrono::milliseconds::zero();
+    }
     std::chrono::milliseconds listenerFiltersTimeout() const override { return {}; }
     bool continueOnListenerFiltersTimeout() const override { return false; }
     Stats::Scope& listenerScope() override { return scope_; }
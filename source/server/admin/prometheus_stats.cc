@@ -1,13 +1,15 @@
 #include "source/server/admin/prometheus_stats.h"
 
 #include <cmath>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <set>
 
-#include "source/common/common/empty_string.h"
 #include "source/common/common/macros.h"
 #include "source/common/common/regex.h"
 #include "source/common/protobuf/protobuf.h"
+#include "source/common/stats/exponential_histogram.h"
 #include "source/common/stats/histogram_impl.h"
 #include "source/common/upstream/host_utility.h"
 
@@ -73,6 +75,14 @@ struct MetricLessThan {
   }
 };
 
+// Renders the text exposition prefix of a metric: its prefixed tag-extracted name followed by '{'
+// and its formatted labels.
+std::string renderPrefix(absl::string_view prefixed_tag_extracted_name,
+                         std::vector<Stats::Tag>&& tags) {
+  return absl::StrCat(prefixed_tag_extracted_name, "{",
+                      PrometheusStatsFormatter::formattedTags(std::move(tags)));
+}
+
 struct PrimitiveMetricSnapshotLessThan {
   bool operator()(const Stats::PrimitiveMetricMetadata* a,
                   const Stats::PrimitiveMetricMetadata* b) {
@@ -82,6 +92,9 @@ struct PrimitiveMetricSnapshotLessThan {
 
 class TextFormat : public PrometheusStatsFormatter::OutputFormat {
 public:
+  explicit TextFormat(PrometheusStatsFormatter::PrefixCache* prefix_cache = nullptr)
+      : prefix_cache_(prefix_cache) {}
+
   void generateOutput(Buffer::Instance& output, const std::vector<const Stats::Counter*>& counters,
                       const std::string& prefixed_tag_extracted_name) const override {
     generateNumericOutput(output, counters, prefixed_tag_extracted_name);
@@ -133,15 +146,36 @@ public:
     // TextReadout stats are returned in gauge format, so "gauge" type is set intentionally.
     generateTypeOutput(output, "gauge", prefixed_tag_extracted_name);
 
+    std::string scratch;
     for (const auto* text_readout : text_readouts) {
-      auto tags = text_readout->tags();
-      tags.push_back(Stats::Tag{"text_value", text_readout->value()});
-      const std::string formattedTags = PrometheusStatsFormatter::formattedTags(std::move(tags));
-      output.add(fmt::format("{0}{{{1}}} 0\n", prefixed_tag_extracted_name, formattedTags));
+      const absl::string_view metric_prefix =
+          prefix(*text_readout, prefixed_tag_extracted_name, scratch);
+      const std::string value = sanitizeValue(text_readout->value());
+      // The prefix ends with the opening brace when the text readout has no tags.
+      output.addFragments({metric_prefix, metric_prefix.back() == '{' ? "" : ",", "text_value=\"",
+                           value, "\"} 0\n"});
     }
   }
 
 private:
+  // Returns `prefixed_tag_extracted_name{labels` for metric, from the prefix cache if there is
+  // one, and otherwise rendered into scratch.
+  absl::string_view prefix(const Stats::Metric& metric,
+                           const std::string& prefixed_tag_extracted_name,
+                           std::string& scratch) const {
+    if (prefix_cache_ != nullptr) {
+      return prefix_cache_->prefix(metric, prefixed_tag_extracted_name);
+    }
+    scratch = renderPrefix(prefixed_tag_extracted_name, metric.tags());
+    return scratch;
+  }
+
+  // Returns the labels part of a prefix returned by prefix().
+  static absl::string_view labels(absl::string_view metric_prefix,
+                                  const std::string& prefixed_tag_extracted_name) {
+    return metric_prefix.substr(prefixed_tag_extracted_name.size() + 1);
+  }
+
   void generateTypeOutput(Buffer::Instance& output, absl::string_view type,
                           const std::string& prefixed_tag_extracted_name) const {
     output.add(fmt::format("# TYPE {0} {1}\n", prefixed_tag_extracted_name, type));
@@ -160,10 +194,11 @@ private:
     }
 
     generateTypeOutput(output, type, prefixed_tag_extracted_name);
+    std::string scratch;
     for (const auto* metric : metrics) {
-      const std::string formatted_tags = PrometheusStatsFormatter::formattedTags(metric->tags());
-      output.add(fmt::format("{0}{{{1}}} {2}\n", prefixed_tag_extracted_name, formatted_tags,
-                             metric->value()));
+      const fmt::format_int value(metric->value());
+      output.addFragments({prefix(*metric, prefixed_tag_extracted_name, scratch), "} ",
+                           absl::string_view(value.data(), value.size()), "\n"});
     }
   }
 
@@ -198,16 +233,18 @@ private:
                                const std::string& prefixed_tag_extracted_name) const {
     generateTypeOutput(output, "histogram", prefixed_tag_extracted_name);
 
+    std::string scratch;
+    fmt::memory_buffer lines;
     for (const auto* histogram : histograms) {
-      auto histogram_tags = histogram->tags();
-      const bool empty_tags = histogram_tags.empty();
-
-      const std::string tags = PrometheusStatsFormatter::formattedTags(std::move(histogram_tags));
-      const std::string hist_tags = empty_tags ? EMPTY_STRING : (tags + ",");
+      const absl::string_view tags =
+          labels(prefix(*histogram, prefixed_tag_extracted_name, scratch),
+                 prefixed_tag_extracted_name);
+      const absl::string_view separator = tags.empty() ? "" : ",";
 
       const Stats::HistogramStatistics& stats = histogram->cumulativeStatistics();
       Stats::ConstSupportedBuckets& supported_buckets = stats.supportedBuckets();
       const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
+      lines.clear();
       for (size_t i = 0; i < supported_buckets.size(); ++i) {
         double bucket = supported_buckets[i];
         uint64_t value = computed_buckets[i];
@@ -216,16 +253,17 @@ private:
         // 'g' operator which prints the number in general fixed point format or scientific format
         // with precision 50 to round the number up to 32 significant digits in fixed point format
         // which should cover pretty much all cases
-        output.add(fmt::format("{0}_bucket{{{1}le=\"{2:.32g}\"}} {3}\n",
-                               prefixed_tag_extracted_name, hist_tags, bucket, value));
+        fmt::format_to(std::back_inserter(lines), "{0}_bucket{{{1}{2}le=\"{3:.32g}\"}} {4}\n",
+                       prefixed_tag_extracted_name, tags, separator, bucket, value);
       }
 
-      output.add(fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", prefixed_tag_extracted_name,
-                             hist_tags, stats.sampleCount()));
-      output.add(fmt::format("{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
-                             stats.sampleSum()));
-      output.add(fmt::format("{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
-                             stats.sampleCount()));
+      fmt::format_to(std::back_inserter(lines), "{0}_bucket{{{1}{2}le=\"+Inf\"}} {3}\n",
+                     prefixed_tag_extracted_name, tags, separator, stats.sampleCount());
+      fmt::format_to(std::back_inserter(lines), "{0}_sum{{{1}}} {2:.32g}\n",
+                     prefixed_tag_extracted_name, tags, stats.sampleSum());
+      fmt::format_to(std::back_inserter(lines), "{0}_count{{{1}}} {2}\n",
+                     prefixed_tag_extracted_name, tags, stats.sampleCount());
+      output.add(lines.data(), lines.size());
     }
   }
 
@@ -239,26 +277,34 @@ private:
                              const std::string& prefixed_tag_extracted_name) const {
     generateTypeOutput(output, "summary", prefixed_tag_extracted_name);
 
+    std::string scratch;
+    fmt::memory_buffer lines;
     for (const auto* histogram : histograms) {
-      const std::string tags = PrometheusStatsFormatter::formattedTags(histogram->tags());
-      const std::string hist_tags = histogram->tags().empty() ? EMPTY_STRING : (tags + ",");
+      const absl::string_view tags =
+          labels(prefix(*histogram, prefixed_tag_extracted_name, scratch),
+                 prefixed_tag_extracted_name);
+      const absl::string_view separator = tags.empty() ? "" : ",";
 
       const Stats::HistogramStatistics& stats = histogram->intervalStatistics();
       Stats::ConstSupportedBuckets& supported_quantiles = stats.supportedQuantiles();
       const std::vector<double>& computed_quantiles = stats.computedQuantiles();
+      lines.clear();
       for (size_t i = 0; i < supported_quantiles.size(); ++i) {
         double quantile = supported_quantiles[i];
         double value = computed_quantiles[i];
-        output.add(fmt::format("{0}{{{1}quantile=\"{2}\"}} {3:.32g}\n", prefixed_tag_extracted_name,
-                               hist_tags, quantile, value));
+        fmt::format_to(std::back_inserter(lines), "{0}{{{1}{2}quantile=\"{3}\"}} {4:.32g}\n",
+                       prefixed_tag_extracted_name, tags, separator, quantile, value);
       }
 
-      output.add(fmt::format("{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
-                             stats.sampleSum()));
-      output.add(fmt::format("{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
-                             stats.sampleCount()));
+      fmt::format_to(std::back_inserter(lines), "{0}_sum{{{1}}} {2:.32g}\n",
+                     prefixed_tag_extracted_name, tags, stats.sampleSum());
+      fmt::format_to(std::back_inserter(lines), "{0}_count{{{1}}} {2}\n",
+                     prefixed_tag_extracted_name, tags, stats.sampleCount());
+      output.add(lines.data(), lines.size());
     }
   }
+
+  PrometheusStatsFormatter::PrefixCache* const prefix_cache_;
 };
 
 class ProtobufFormat : public PrometheusStatsFormatter::OutputFormat {
@@ -477,20 +523,6 @@ private:
 
   // Set zero threshold - values below this go in zero bucket.
   // Since Histogram::recordValue() only accepts integers, the minimum non-zero value is 1.
-  // Setting threshold to 0.5 ensures:
-  // - Zeros go to zero bucket (0 < 0.5)
-  // - Values >= 1 get positive bucket indices (1 > 0.5).
-  // Using 0.5 avoids interpolation issues at bucket boundaries that occur with 1.0.
-  // For Percent unit histograms, values are scaled by 1/PercentScale, so the threshold
-  // must also be scaled accordingly.
-  static constexpr double kNativeHistogramZeroThreshold = 0.5;
-
-  static constexpr double nativeHistogramZeroThreshold(Stats::Histogram::Unit unit) {
-    return (unit == Stats::Histogram::Unit::Percent)
-               ? (kNativeHistogramZeroThreshold / Stats::Histogram::PercentScale)
-               : kNativeHistogramZeroThreshold;
-  }
-
   /**
    * Generates Prometheus native histogram output from Envoy's circllhist histograms.
    *
@@ -533,11 +565,11 @@ private:
       proto_histogram->set_sample_count(stats.sampleCount());
       proto_histogram->set_sample_sum(stats.sampleSum());
 
-      const double zero_threshold = nativeHistogramZeroThreshold(histogram->unit());
+      const double zero_threshold = Stats::ExponentialHistogram::zeroThreshold(histogram->unit());
       proto_histogram->set_zero_threshold(zero_threshold);
 
       const auto detailed_buckets = histogram->detailedTotalBuckets();
-      const auto [schema, needed_indices] = chooseNativeHistogramSchema(
+      const auto [schema, needed_indices] = Stats::ExponentialHistogram::chooseScale(
           detailed_buckets, native_histogram_max_buckets_, zero_threshold);
       proto_histogram->set_schema(schema);
 
@@ -602,84 +634,6 @@ private:
     }
   }
 
-  // Choose the highest-resolution schema that keeps the bucket count within max_buckets.
-  // Returns both the schema and the computed bucket indices to avoid recomputing them.
-  static std::pair<int8_t, std::set<int32_t>>
-  chooseNativeHistogramSchema(const std::vector<Stats::ParentHistogram::Bucket>& detailed_buckets,
-                              uint32_t max_buckets, double zero_threshold) {
-    // Schema ranges from -4 (coarsest: 16x per bucket) to 8 (finest: ~0.27% per bucket). However,
-    // we cap at schema 5 because circllhist has ~90 buckets per decade, which translates to ~27
-    // buckets per doubling. This resolution falls between schema 4 (16 buckets/doubling) and schema
-    // 5 (32 buckets/doubling). Using schemas higher than 5 would create artificial precision via
-    // interpolation, not real accuracy gains.
-    //
-    // The default schema used is 4. Often schema 5 is more precision than is required, and because
-    // the underlying data is at an accuracy between schemas 4 and 5, choose the lower value to
-    // reduce resource usage.
-
-    // Uncomment and use this if schema is every directly specified.
-    // constexpr int8_t kSchemaMax = 5;
-
-    constexpr int8_t kSchemaMin = -4;
-    constexpr int8_t kSchemaDefault = 4;
-
-    for (int8_t schema = kSchemaDefault; schema >= kSchemaMin; --schema) {
-      absl::optional<std::set<int32_t>> indices = nativeHistogramBucketIndicesFromHistogramBuckets(
-          detailed_buckets, schema, zero_threshold, max_buckets);
-      // If it doesn't have a value, that means it exceeded `max_buckets`.
-      if (indices.has_value()) {
-        return {schema, std::move(*indices)};
-      }
-    }
-    // Fallback if nothing fits - compute indices at coarsest schema without limit
-    return {kSchemaMin, nativeHistogramBucketIndicesFromHistogramBuckets(detailed_buckets,
-                                                                         kSchemaMin, zero_threshold)
-                            .value()};
-  }
-
-  // For the vector of histogram buckets, return the set of all native histogram indices that
-  // cover any part of the range of any of the buckets.
-  //
-  // If max_buckets is provided and the limit would be exceeded, returns nullopt.
-  static absl::optional<std::set<int32_t>> nativeHistogramBucketIndicesFromHistogramBuckets(
-      const std::vector<Stats::ParentHistogram::Bucket>& buckets, int8_t schema,
-      double zero_threshold, absl::optional<uint32_t> max_buckets = absl::nullopt) {
-    std::set<int32_t> indices;
-
-    const double log_base = std::log(std::pow(2.0, std::pow(2.0, static_cast<double>(-schema))));
-
-    for (const auto& bucket : buckets) {
-      ASSERT(bucket.count_ > 0, "unexpected empty bucket");
-      const double upper_bound = bucket.lower_bound_ + bucket.width_;
-      if (upper_bound <= zero_threshold) {
-        continue; // Entire bucket is in zero bucket range
-      }
-
-      ASSERT(bucket.lower_bound_ >= 0, "Envoy histograms only have unsigned integers recorded.");
-
-      // Clamp lower bound to zero_threshold to prevent log(0).
-      const double effective_lower = std::max(bucket.lower_bound_, zero_threshold);
-      // Use ceil(...) - 1 to find the bucket containing effective_lower.
-      // Prometheus bucket i covers (base^i, base^(i+1)], so value v is in bucket
-      // ceil(log(v)/log(base)) - 1. This correctly handles boundary cases where
-      // v = base^k exactly (it goes in bucket k-1, not k).
-      const int32_t lower_index =
-          static_cast<int32_t>(std::ceil(std::log(effective_lower) / log_base)) - 1;
-      const int32_t upper_index = static_cast<int32_t>(std::ceil(std::log(upper_bound) / log_base));
-
-      for (int32_t idx = lower_index; idx <= upper_index; ++idx) {
-        indices.insert(idx);
-
-        // Early termination if we've exceeded the limit
-        if (max_buckets.has_value() && indices.size() > *max_buckets) {
-          return absl::nullopt;
-        }
-      }
-    }
-
-    return indices;
-  }
-
   // Write a varint-length-delimited protobuf message to the buffer.
   void writeDelimitedMessage(const Protobuf::MessageLite& message, Buffer::Instance& output) const {
     constexpr size_t kMaxVarintLength = 10; // This is documented, but not exported as a constant.
@@ -701,164 +655,50 @@ private:
   uint32_t native_histogram_max_buckets_{kDefaultMaxNativeHistogramBuckets};
 };
 
-/**
- * Processes a stat type (counter, gauge, histogram) by generating all output lines, sorting
- * them by tag-extracted metric name, and then outputting them in the correct sorted order into
- * response.
- *
- * @param response The buffer to put the output into.
- * @param used_only Whether to only output stats that are used.
- * @param regex A filter on which stats to output.
- * @param metrics The metrics to output stats for. This must contain all stats of the given type
- *        to be included in the same output.
- * @param generate_output A function which returns the output text for this metric.
- * @param type The name of the prometheus metric type for used in TYPE annotations.
- */
-template <class StatType>
-uint64_t outputStatType(Buffer::Instance& response, const StatsParams& params,
-                        const std::vector<Stats::RefcountPtr<StatType>>& metrics,
-                        const PrometheusStatsFormatter::OutputFormat& output_format,
-                        const Stats::CustomStatNamespaces& custom_namespaces) {
-
-  /*
-   * From
-   * https://github.com/prometheus/docs/blob/master/content/docs/instrumenting/exposition_formats.md#grouping-and-sorting:
-   *
-   * All lines for a given metric must be provided as one single group, with the optional HELP and
-   * TYPE lines first (in no particular order). Beyond that, reproducible sorting in repeated
-   * expositions is preferred but not required, i.e. do not sort if the computational cost is
-   * prohibitive.
-   */
-
-  // This is an unsorted collection of dumb-pointers (no need to increment then decrement every
-  // refcount; ownership is held throughout by `metrics`). It is unsorted for efficiency, but will
-  // be sorted before producing the final output to satisfy the "preferred" ordering from the
-  // prometheus spec: metrics will be sorted by their tags' textual representation, which will be
-  // consistent across calls.
-  using StatTypeUnsortedCollection = std::vector<const StatType*>;
-
-  // Return early to avoid crashing when getting the symbol table from the first metric.
-  if (metrics.empty()) {
-    return 0;
-  }
-
-  // There should only be one symbol table for all of the stats in the admin
-  // interface. If this assumption changes, the name comparisons in this function
-  // will have to change to compare to convert all StatNames to strings before
-  // comparison.
-  const Stats::SymbolTable& global_symbol_table = metrics.front()->constSymbolTable();
-
-  // Collection of metrics by their tagExtractedName.
-  // Sorting will be done on the names separately.
-  absl::flat_hash_map<Stats::StatName, StatTypeUnsortedCollection> groups;
-
-  for (const auto& metric : metrics) {
-    ASSERT(&global_symbol_table == &metric->constSymbolTable());
-    if (!params.shouldShowMetric(*metric)) {
-      continue;
-    }
-    groups[metric->tagExtractedStatName()].push_back(metric.get());
-  }
-
-  std::vector<Stats::StatName> sorted_stat_names;
-  sorted_stat_names.reserve(groups.size());
-  for (const auto& [group, _] : groups) {
-    sorted_stat_names.push_back(group);
-  }
-  Stats::StatNameLessThan comp(global_symbol_table);
-  std::sort(sorted_stat_names.begin(), sorted_stat_names.end(), comp);
-
-  auto result = groups.size();
-  for (auto& group_name : sorted_stat_names) {
-    auto& group = groups[group_name];
-    const absl::optional<std::string> prefixed_tag_extracted_name =
-        PrometheusStatsFormatter::metricName(global_symbol_table.toString(group_name),
-                                             custom_namespaces);
-    if (!prefixed_tag_extracted_name.has_value()) {
-      --result;
-      continue;
-    }
-
-    // Sort before producing the final output to satisfy the "preferred" ordering from the
-    // prometheus spec: metrics will be sorted by their tags' textual representation, which will
-    // be consistent across calls.
-    std::sort(group.begin(), group.end(), MetricLessThan());
-
-    output_format.generateOutput(response, group, prefixed_tag_extracted_name.value());
+PrometheusStatsFormatter::OutputFormat::HistogramType histogramType(const StatsParams& params) {
+  using HistogramType = PrometheusStatsFormatter::OutputFormat::HistogramType;
+  // Validation of bucket modes is handled separately.
+  switch (params.histogram_buckets_mode_) {
+  case Utility::HistogramBucketsMode::Summary:
+    return HistogramType::Summary;
+  case Utility::HistogramBucketsMode::Unset:
+  case Utility::HistogramBucketsMode::Cumulative:
+    return HistogramType::ClassicHistogram;
+  case Utility::HistogramBucketsMode::PrometheusNative:
+    return HistogramType::NativeHistogram;
+  // "Detailed" and "Disjoint" don't make sense for prometheus histogram semantics. These types were
+  // have been filtered out in validateParams().
+  case Utility::HistogramBucketsMode::Detailed:
+  case Utility::HistogramBucketsMode::Disjoint:
+    IS_ENVOY_BUG("unsupported prometheus histogram bucket mode");
+    return HistogramType::ClassicHistogram;
   }
-  return result;
+  return HistogramType::ClassicHistogram;
 }
 
-template <class StatType, class OutputFormat>
-uint64_t outputPrimitiveStatType(Buffer::Instance& response, const StatsParams& params,
-                                 std::vector<StatType>&& metrics, const OutputFormat& output_format,
-                                 const Stats::CustomStatNamespaces& custom_namespaces) {
-
-  /*
-   * From
-   * https:*github.com/prometheus/docs/blob/master/content/docs/instrumenting/exposition_formats.md#grouping-and-sorting:
-   *
-   * All lines for a given metric must be provided as one single group, with the optional HELP and
-   * TYPE lines first (in no particular order). Beyond that, reproducible sorting in repeated
-   * expositions is preferred but not required, i.e. do not sort if the computational cost is
-   * prohibitive.
-   */
-
-  // This is an unsorted collection of dumb-pointers (no need to increment then decrement every
-  // refcount; ownership is held throughout by `metrics`). It is unsorted for efficiency, but will
-  // be sorted before producing the final output to satisfy the "preferred" ordering from the
-  // prometheus spec: metrics will be sorted by their tags' textual representation, which will be
-  // consistent across calls.
-  using StatTypeUnsortedCollection = std::vector<StatType*>;
-
-  // Return early to avoid crashing when getting the symbol table from the first metric.
-  if (metrics.empty()) {
-    return 0;
-  }
-
-  // Collection of metrics sorted by their tagExtractedName.
-  // We satisfy the requirements of the exposition format by iterating over the sorted keys.
-  absl::flat_hash_map<std::string, StatTypeUnsortedCollection> groups;
-
-  for (auto& metric : metrics) {
-    if (!params.shouldShowMetric(metric)) {
-      continue;
-    }
-    groups[metric.tagExtractedName()].push_back(&metric);
-  }
-
-  std::vector<std::string> sorted_group_names;
-  sorted_group_names.reserve(groups.size());
-  for (const auto& [group, _] : groups) {
-    sorted_group_names.push_back(group);
-  }
-  std::sort(sorted_group_names.begin(), sorted_group_names.end());
-
-  auto result = groups.size();
-  for (auto& group_name : sorted_group_names) {
-    auto& group = groups[group_name];
-    const absl::optional<std::string> prefixed_tag_extracted_name =
-        PrometheusStatsFormatter::metricName(std::move(group_name), custom_namespaces);
-    if (!prefixed_tag_extracted_name.has_value()) {
-      --result;
-      continue;
-    }
+void setProtobufContentType(Http::ResponseHeaderMap& response_headers) {
+  response_headers.setReferenceContentType(
+      "application/vnd.google.protobuf; "
+      "proto=io.prometheus.client.MetricFamily; encoding=delimited");
+}
 
-    // Sort before producing the final output to satisfy the "preferred" ordering from the
-    // prometheus spec: metrics will be sorted by their tags' textual representation, which will
-    // be consistent across calls.
-    std::sort(group.begin(), group.end(), PrimitiveMetricSnapshotLessThan());
+} // namespace
 
-    output_format.generateOutput(response, std::move(group), prefixed_tag_extracted_name.value());
+std::string PrometheusStatsFormatter::formattedTags(std::vector<Stats::Tag>&& tags) {
+  std::vector<std::string> buf;
+  buf.reserve(tags.size());
+  for (Stats::Tag& tag : tags) {
+    sanitizeNameInPlace(tag.name_);
+    buf.push_back(fmt::format("{}=\"{}\"", tag.name_, sanitizeValue(tag.value_)));
   }
-  return result;
+  return absl::StrJoin(buf, ",");
 }
 
 // Determine the format based on Accept header, using first-match priority.
 // Per HTTP spec, clients SHOULD send media types in priority order.
 // Text format is only selected if explicitly requested as version 0.0.4 or as fallback.
-// Returns true if protobuf format should be used, false for text format.
-bool useProtobufFormat(const StatsParams& params, const Http::RequestHeaderMap& headers) {
+bool PrometheusStatsFormatter::useProtobufFormat(const StatsParams& params,
+                                                 const Http::RequestHeaderMap& headers) {
   bool use_protobuf = false; // Default to using the text format.
 
   if (auto prom_format = params.query_.getFirstValue("prom_protobuf"); prom_format.has_value()) {
@@ -899,18 +739,6 @@ bool useProtobufFormat(const StatsParams& params, const Http::RequestHeaderMap&
   return use_protobuf;
 }
 
-} // namespace
-
-std::string PrometheusStatsFormatter::formattedTags(std::vector<Stats::Tag>&& tags) {
-  std::vector<std::string> buf;
-  buf.reserve(tags.size());
-  for (Stats::Tag& tag : tags) {
-    sanitizeNameInPlace(tag.name_);
-    buf.push_back(fmt::format("{}=\"{}\"", tag.name_, sanitizeValue(tag.value_)));
-  }
-  return absl::StrJoin(buf, ",");
-}
-
 absl::Status PrometheusStatsFormatter::validateParams(const StatsParams& params,
                                                       const Http::RequestHeaderMap& headers) {
   absl::Status result;
@@ -963,71 +791,267 @@ PrometheusStatsFormatter::metricName(std::string&& extracted_name,
   return absl::StrCat("envoy_", extracted_name);
 }
 
-uint64_t PrometheusStatsFormatter::generateWithOutputFormat(
+absl::string_view PrometheusStatsFormatter::PrefixCache::prefix(const Stats::Metric& metric,
+                                                                absl::string_view prefixed_name) {
+  auto it = entries_.find(metric.statName());
+  if (it == entries_.end()) {
+    ASSERT(&metric.constSymbolTable() == &symbol_table_);
+    auto entry = std::make_unique<Entry>(metric.statName(), symbol_table_);
+    entry->prefix_ = renderPrefix(prefixed_name, metric.tags());
+    // The key references the name stored in the entry, which keeps its symbols alive.
+    const Stats::StatName key = entry->name_.statName();
+    it = entries_.emplace(key, std::move(entry)).first;
+  }
+  it->second->generation_ = generation_;
+  return it->second->prefix_;
+}
+
+void PrometheusStatsFormatter::PrefixCache::finishScrape(uint64_t generation,
+                                                         const StatsParams& params) {
+  if (params.re2_filter_ != nullptr || params.used_only_ || params.type_ != StatsType::All ||
+      params.hidden_ == HiddenFlag::ShowOnly) {
+    return;
+  }
+  absl::erase_if(entries_, [generation](const auto& name_and_entry) {
+    return name_and_entry.second->generation_ < generation;
+  });
+}
+
+PrometheusStatsFormatter::StreamingRenderer::StreamingRenderer(
     const std::vector<Stats::CounterSharedPtr>& counters,
     const std::vector<Stats::GaugeSharedPtr>& gauges,
     const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
     const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
-    const Upstream::ClusterManager& cluster_manager, Buffer::Instance& response,
-    const StatsParams& params, const Stats::CustomStatNamespaces& custom_namespaces,
-    OutputFormat& output_format) {
+    const Upstream::ClusterManager& cluster_manager, const StatsParams& params,
+    const Stats::CustomStatNamespaces& custom_namespaces, OutputFormat& output_format)
+    : counters_(counters), gauges_(gauges), histograms_(histograms),
+      text_readouts_(text_readouts), cluster_manager_(cluster_manager), params_(params),
+      custom_namespaces_(custom_namespaces), output_format_(output_format) {}
+
+bool PrometheusStatsFormatter::StreamingRenderer::nextChunk(Buffer::Instance& response,
+                                                            uint64_t chunk_size) {
+  const uint64_t start_length = response.length();
+  const uint64_t end_length = chunk_size > std::numeric_limits<uint64_t>::max() - start_length
+                                  ? std::numeric_limits<uint64_t>::max()
+                                  : start_length + chunk_size;
+  while (phase_ != Phase::Done) {
+    // Groups are only collected when their phase starts, so that the first chunk is produced
+    // without visiting every stat, and are released when it finishes.
+    bool finished = false;
+    switch (phase_) {
+    case Phase::Counters:
+      if (!phase_started_) {
+        groupMetrics(counters_, counter_groups_);
+      }
+      finished = renderGroups(counter_groups_, response, end_length);
+      break;
+    case Phase::Gauges:
+      if (!phase_started_) {
+        groupMetrics(gauges_, gauge_groups_);
+      }
+      finished = renderGroups(gauge_groups_, response, end_length);
+      break;
+    case Phase::TextReadouts:
+      if (!phase_started_) {
+        groupMetrics(text_readouts_, text_readout_groups_);
+      }
+      finished = renderGroups(text_readout_groups_, response, end_length);
+      break;
+    case Phase::Histograms:
+      if (!phase_started_) {
+        groupMetrics(histograms_, histogram_groups_);
+      }
+      finished = renderGroups(histogram_groups_, response, end_length);
+      break;
+    case Phase::HostCounters:
+      if (!phase_started_) {
+        collectHostMetrics();
+      }
+      finished = renderPrimitiveGroups(host_counter_groups_, response, end_length);
+      break;
+    case Phase::HostGauges:
+      finished = renderPrimitiveGroups(host_gauge_groups_, response, end_length);
+      break;
+    case Phase::Done:
+      break;
+    }
+    if (!finished) {
+      phase_started_ = true;
+      return true;
+    }
+    phase_ = static_cast<Phase>(static_cast<int>(phase_) + 1);
+    phase_started_ = false;
+  }
+  return false;
+}
 
-  OutputFormat::HistogramType hist_type;
+template <class StatType>
+void PrometheusStatsFormatter::StreamingRenderer::groupMetrics(
+    const std::vector<Stats::RefcountPtr<StatType>>& metrics, Groups<StatType>& groups) {
+  /*
+   * From
+   * https://github.com/prometheus/docs/blob/master/content/docs/instrumenting/exposition_formats.md#grouping-and-sorting:
+   *
+   * All lines for a given metric must be provided as one single group, with the optional HELP and
+   * TYPE lines first (in no particular order). Beyond that, reproducible sorting in repeated
+   * expositions is preferred but not required, i.e. do not sort if the computational cost is
+   * prohibitive.
+   */
 
-  // Validation of bucket modes is handled separately.
-  switch (params.histogram_buckets_mode_) {
-  case Utility::HistogramBucketsMode::Summary:
-    hist_type = OutputFormat::HistogramType::Summary;
-    break;
-  case Utility::HistogramBucketsMode::Unset:
-  case Utility::HistogramBucketsMode::Cumulative:
-    hist_type = OutputFormat::HistogramType::ClassicHistogram;
-    break;
-  case Utility::HistogramBucketsMode::PrometheusNative:
-    hist_type = OutputFormat::HistogramType::NativeHistogram;
-    break;
-  // "Detailed" and "Disjoint" don't make sense for prometheus histogram semantics. These types were
-  // have been filtered out in validateParams().
-  case Utility::HistogramBucketsMode::Detailed:
-  case Utility::HistogramBucketsMode::Disjoint:
-    hist_type = OutputFormat::HistogramType::ClassicHistogram;
-    IS_ENVOY_BUG("unsupported prometheus histogram bucket mode");
-    break;
+  // Return early to avoid crashing when getting the symbol table from the first metric.
+  if (metrics.empty()) {
+    return;
   }
 
-  output_format.setHistogramType(hist_type);
+  // There should only be one symbol table for all of the stats in the admin
+  // interface. If this assumption changes, the name comparisons in this function
+  // will have to change to compare to convert all StatNames to strings before
+  // comparison.
+  const Stats::SymbolTable& global_symbol_table = metrics.front()->constSymbolTable();
+
+  // Collection of metrics by their tagExtractedName. The metrics are dumb-pointers (no need to
+  // increment then decrement every refcount; ownership is held throughout by `metrics`), and are
+  // unsorted for efficiency until their group is rendered.
+  absl::flat_hash_map<Stats::StatName, std::vector<const StatType*>> by_name;
+  for (const auto& metric : metrics) {
+    ASSERT(&global_symbol_table == &metric->constSymbolTable());
+    if (!params_.shouldShowMetric(*metric)) {
+      continue;
+    }
+    by_name[metric->tagExtractedStatName()].push_back(metric.get());
+  }
 
-  uint64_t metric_name_count = 0;
-  metric_name_count +=
-      outputStatType<Stats::Counter>(response, params, counters, output_format, custom_namespaces);
+  groups.groups_.reserve(by_name.size());
+  for (auto& [name, group] : by_name) {
+    groups.groups_.emplace_back(name, std::move(group));
+  }
+  Stats::StatNameLessThan comp(global_symbol_table);
+  std::sort(groups.groups_.begin(), groups.groups_.end(),
+            [&comp](const auto& a, const auto& b) { return comp(a.first, b.first); });
+}
 
-  metric_name_count +=
-      outputStatType<Stats::Gauge>(response, params, gauges, output_format, custom_namespaces);
+template <class StatType>
+bool PrometheusStatsFormatter::StreamingRenderer::renderGroups(Groups<StatType>& groups,
+                                                               Buffer::Instance& response,
+                                                               uint64_t end_length) {
+  for (; groups.next_ < groups.groups_.size(); ++groups.next_) {
+    if (response.length() >= end_length) {
+      return false;
+    }
+    auto& [group_name, group] = groups.groups_[groups.next_];
+    const absl::optional<std::string> prefixed_tag_extracted_name =
+        PrometheusStatsFormatter::metricName(group.front()->constSymbolTable().toString(group_name),
+                                             custom_namespaces_);
+    if (!prefixed_tag_extracted_name.has_value()) {
+      continue;
+    }
+    ++metric_name_count_;
 
-  metric_name_count += outputStatType<Stats::TextReadout>(response, params, text_readouts,
-                                                          output_format, custom_namespaces);
+    // Sort before producing the final output to satisfy the "preferred" ordering from the
+    // prometheus spec: metrics will be sorted by their tags' textual representation, which will
+    // be consistent across calls.
+    std::sort(group.begin(), group.end(), MetricLessThan());
 
-  metric_name_count += outputStatType<Stats::ParentHistogram>(response, params, histograms,
-                                                              output_format, custom_namespaces);
+    output_format_.generateOutput(response, group, prefixed_tag_extracted_name.value());
+  }
+  groups = {};
+  return true;
+}
 
+void PrometheusStatsFormatter::StreamingRenderer::collectHostMetrics() {
   // Note: This assumes that there is no overlap in stat name between per-endpoint stats and all
   // other stats. If this is not true, then the counters/gauges for per-endpoint need to be combined
   // with the above counter/gauge calls so that stats can be properly grouped.
-  std::vector<Stats::PrimitiveCounterSnapshot> host_counters;
-  std::vector<Stats::PrimitiveGaugeSnapshot> host_gauges;
   Upstream::HostUtility::forEachHostMetric(
-      cluster_manager,
-      [&](Stats::PrimitiveCounterSnapshot&& metric) {
-        host_counters.emplace_back(std::move(metric));
+      cluster_manager_,
+      [this](Stats::PrimitiveCounterSnapshot&& metric) {
+        host_counter_groups_.snapshots_.emplace_back(std::move(metric));
       },
-      [&](Stats::PrimitiveGaugeSnapshot&& metric) { host_gauges.emplace_back(std::move(metric)); });
+      [this](Stats::PrimitiveGaugeSnapshot&& metric) {
+        host_gauge_groups_.snapshots_.emplace_back(std::move(metric));
+      });
+  groupPrimitiveMetrics(host_counter_groups_);
+  groupPrimitiveMetrics(host_gauge_groups_);
+}
+
+template <class SnapshotType>
+void PrometheusStatsFormatter::StreamingRenderer::groupPrimitiveMetrics(
+    PrimitiveGroups<SnapshotType>& groups) {
+  // Collection of metrics by their tagExtractedName, pointing into the snapshots which are not
+  // modified anymore.
+  absl::flat_hash_map<std::string, std::vector<SnapshotType*>> by_name;
+  for (auto& metric : groups.snapshots_) {
+    if (!params_.shouldShowMetric(metric)) {
+      continue;
+    }
+    by_name[metric.tagExtractedName()].push_back(&metric);
+  }
 
-  metric_name_count += outputPrimitiveStatType(response, params, std::move(host_counters),
-                                               output_format, custom_namespaces);
-  metric_name_count += outputPrimitiveStatType(response, params, std::move(host_gauges),
-                                               output_format, custom_namespaces);
+  groups.groups_.reserve(by_name.size());
+  for (auto& [name, group] : by_name) {
+    groups.groups_.emplace_back(name, std::move(group));
+  }
+  std::sort(groups.groups_.begin(), groups.groups_.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+}
+
+template <class SnapshotType>
+bool PrometheusStatsFormatter::StreamingRenderer::renderPrimitiveGroups(
+    PrimitiveGroups<SnapshotType>& groups, Buffer::Instance& response, uint64_t end_length) {
+  for (; groups.next_ < groups.groups_.size(); ++groups.next_) {
+    if (response.length() >= end_length) {
+      return false;
+    }
+    auto& [group_name, group] = groups.groups_[groups.next_];
+    const absl::optional<std::string> prefixed_tag_extracted_name =
+        PrometheusStatsFormatter::metricName(std::move(group_name), custom_namespaces_);
+    if (!prefixed_tag_extracted_name.has_value()) {
+      continue;
+    }
+    ++metric_name_count_;
+
+    // Sort before producing the final output to satisfy the "preferred" ordering from the
+    // prometheus spec: metrics will be sorted by their tags' textual representation, which will
+    // be consistent across calls.
+    std::sort(group.begin(), group.end(), PrimitiveMetricSnapshotLessThan());
+
+    output_format_.generateOutput(response, std::move(group), prefixed_tag_extracted_name.value());
+  }
+  groups = {};
+  return true;
+}
 
-  return metric_name_count;
+uint64_t PrometheusStatsFormatter::generateWithOutputFormat(
+    const std::vector<Stats::CounterSharedPtr>& counters,
+    const std::vector<Stats::GaugeSharedPtr>& gauges,
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+    const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
+    const Upstream::ClusterManager& cluster_manager, Buffer::Instance& response,
+    const StatsParams& params, const Stats::CustomStatNamespaces& custom_namespaces,
+    OutputFormat& output_format) {
+  output_format.setHistogramType(histogramType(params));
+
+  StreamingRenderer renderer(counters, gauges, histograms, text_readouts, cluster_manager, params,
+                             custom_namespaces, output_format);
+  while (renderer.nextChunk(response, std::numeric_limits<uint64_t>::max())) {
+  }
+  return renderer.metricNameCount();
+}
+
+std::unique_ptr<PrometheusStatsFormatter::OutputFormat>
+PrometheusStatsFormatter::makeOutputFormat(const StatsParams& params,
+                                           const Http::RequestHeaderMap& request_headers,
+                                           Http::ResponseHeaderMap& response_headers,
+                                           PrefixCache* prefix_cache) {
+  std::unique_ptr<OutputFormat> output_format;
+  if (useProtobufFormat(params, request_headers)) {
+    setProtobufContentType(response_headers);
+    output_format = std::make_unique<ProtobufFormat>(params.native_histogram_max_buckets_);
+  } else {
+    output_format = std::make_unique<TextFormat>(prefix_cache);
+  }
+  output_format->setHistogramType(histogramType(params));
+  return output_format;
 }
 
 uint64_t PrometheusStatsFormatter::statsAsPrometheusText(
@@ -1052,9 +1076,7 @@ uint64_t PrometheusStatsFormatter::statsAsPrometheusProtobuf(
     Buffer::Instance& response, const StatsParams& params,
     const Stats::CustomStatNamespaces& custom_namespaces) {
 
-  response_headers.setReferenceContentType(
-      "application/vnd.google.protobuf; "
-      "proto=io.prometheus.client.MetricFamily; encoding=delimited");
+  setProtobufContentType(response_headers);
 
   ProtobufFormat output_format(params.native_histogram_max_buckets_);
   return generateWithOutputFormat(counters, gauges, histograms, text_readouts, cluster_manager,
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/buffer/buffer.h"
 #include "envoy/stats/custom_stat_namespaces.h"
 #include "envoy/stats/histogram.h"
+#include "envoy/stats/primitive_stats.h"
 #include "envoy/stats/stats.h"
 
+#include "source/common/stats/symbol_table.h"
 #include "source/server/admin/stats_params.h"
 
 namespace Envoy {
@@ -68,6 +72,147 @@ public:
     HistogramType histogram_type_;
   };
 
+  /**
+   * Caches the rendered text exposition prefix of each metric across scrapes: its prefixed
+   * tag-extracted name followed by '{' and its formatted labels. Rendering the labels requires
+   * decoding and sanitizing every tag, which otherwise dominates the cost of a scrape. Entries are
+   * keyed by the metric's name, whose symbols they keep a reference to, and entries that no scrape
+   * since the one passed to finishScrape() has used are dropped, so the cache only holds the
+   * metrics that are still being exported.
+   */
+  class PrefixCache {
+  public:
+    explicit PrefixCache(Stats::SymbolTable& symbol_table) : symbol_table_(symbol_table) {}
+
+    /**
+     * Returns the cached prefix of metric, rendering and caching it on a miss.
+     * @param metric the metric to render the prefix for.
+     * @param prefixed_name the metric's tag-extracted name as exported, e.g. with "envoy_".
+     * @return the prefix, which remains valid until the next call to finishScrape().
+     */
+    absl::string_view prefix(const Stats::Metric& metric, absl::string_view prefixed_name);
+
+    /**
+     * Starts a scrape that uses the cache.
+     * @return the generation to pass to finishScrape() once the scrape is complete.
+     */
+    uint64_t startScrape() { return ++generation_; }
+
+    /**
+     * Drops the entries that were not used since the scrape with the given generation started.
+     * Scrapes narrowed by a filter, usedonly, a type or hidden=showonly don't render every
+     * metric, so they leave the cache as it is rather than dropping the entries of the metrics
+     * they skipped.
+     * @param generation the value startScrape() returned for the scrape.
+     * @param params the query parameters of the scrape.
+     */
+    void finishScrape(uint64_t generation, const StatsParams& params);
+
+    size_t size() const { return entries_.size(); }
+
+  private:
+    struct Entry {
+      Entry(Stats::StatName name, Stats::SymbolTable& symbol_table) : name_(name, symbol_table) {}
+
+      Stats::StatNameManagedStorage name_;
+      std::string prefix_;
+      uint64_t generation_{0};
+    };
+
+    Stats::SymbolTable& symbol_table_;
+    Stats::StatNameHashMap<std::unique_ptr<Entry>> entries_;
+    uint64_t generation_{0};
+  };
+
+  /**
+   * Renders stats in the prometheus exposition format incrementally, one group of metrics sharing
+   * a tag-extracted name at a time, so that a large exposition can be streamed out in chunks
+   * rather than being assembled in memory first. The metric vectors, cluster manager, params,
+   * namespaces and output format must outlive the renderer.
+   */
+  class StreamingRenderer {
+  public:
+    StreamingRenderer(const std::vector<Stats::CounterSharedPtr>& counters,
+                      const std::vector<Stats::GaugeSharedPtr>& gauges,
+                      const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+                      const std::vector<Stats::TextReadoutSharedPtr>& text_readouts,
+                      const Upstream::ClusterManager& cluster_manager, const StatsParams& params,
+                      const Stats::CustomStatNamespaces& custom_namespaces,
+                      OutputFormat& output_format);
+
+    /**
+     * Renders whole metric groups into response until it has grown by at least chunk_size bytes,
+     * or until everything has been rendered.
+     * @return true if there is more to render.
+     */
+    bool nextChunk(Buffer::Instance& response, uint64_t chunk_size);
+
+    /**
+     * @return the number of metric names rendered so far.
+     */
+    uint64_t metricNameCount() const { return metric_name_count_; }
+
+  private:
+    template <class StatType> struct Groups {
+      std::vector<std::pair<Stats::StatName, std::vector<const StatType*>>> groups_;
+      size_t next_{0};
+    };
+    template <class SnapshotType> struct PrimitiveGroups {
+      std::vector<SnapshotType> snapshots_;
+      std::vector<std::pair<std::string, std::vector<SnapshotType*>>> groups_;
+      size_t next_{0};
+    };
+    enum class Phase {
+      Counters,
+      Gauges,
+      TextReadouts,
+      Histograms,
+      HostCounters,
+      HostGauges,
+      Done,
+    };
+
+    template <class StatType>
+    void groupMetrics(const std::vector<Stats::RefcountPtr<StatType>>& metrics,
+                      Groups<StatType>& groups);
+    template <class SnapshotType> void groupPrimitiveMetrics(PrimitiveGroups<SnapshotType>& groups);
+    template <class StatType>
+    bool renderGroups(Groups<StatType>& groups, Buffer::Instance& response, uint64_t end_length);
+    template <class SnapshotType>
+    bool renderPrimitiveGroups(PrimitiveGroups<SnapshotType>& groups, Buffer::Instance& response,
+                               uint64_t end_length);
+    void collectHostMetrics();
+
+    const std::vector<Stats::CounterSharedPtr>& counters_;
+    const std::vector<Stats::GaugeSharedPtr>& gauges_;
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms_;
+    const std::vector<Stats::TextReadoutSharedPtr>& text_readouts_;
+    const Upstream::ClusterManager& cluster_manager_;
+    const StatsParams& params_;
+    const Stats::CustomStatNamespaces& custom_namespaces_;
+    OutputFormat& output_format_;
+
+    Phase phase_{Phase::Counters};
+    bool phase_started_{false};
+    Groups<Stats::Counter> counter_groups_;
+    Groups<Stats::Gauge> gauge_groups_;
+    Groups<Stats::TextReadout> text_readout_groups_;
+    Groups<Stats::ParentHistogram> histogram_groups_;
+    PrimitiveGroups<Stats::PrimitiveCounterSnapshot> host_counter_groups_;
+    PrimitiveGroups<Stats::PrimitiveGaugeSnapshot> host_gauge_groups_;
+    uint64_t metric_name_count_{0};
+  };
+
+  /**
+   * Creates the output format requested by the params and request headers, setting the response
+   * content type for the protobuf format.
+   * @param prefix_cache if non-null, the text format renders each metric's name and labels from
+   *        it. The protobuf format does not use it.
+   */
+  static std::unique_ptr<OutputFormat>
+  makeOutputFormat(const StatsParams& params, const Http::RequestHeaderMap& request_headers,
+                   Http::ResponseHeaderMap& response_headers, PrefixCache* prefix_cache);
+
   /**
    * Extracts counters and gauges and relevant tags, appending them to
    * the response buffer after sanitizing the metric / label names.
@@ -119,6 +264,13 @@ public:
    */
   static std::string formattedTags(std::vector<Stats::Tag>&& tags);
 
+  /**
+   * Determines from the params and the request's Accept header whether to emit the protobuf
+   * exposition format rather than the text one.
+   * @return true if the protobuf format should be used.
+   */
+  static bool useProtobufFormat(const StatsParams& params, const Http::RequestHeaderMap& headers);
+
   /**
    * Validate the given params, returning an error on invalid arguments
    */
@@ -4,6 +4,8 @@
 #include <vector>
 
 #include "envoy/admin/v3/mutex_stats.pb.h"
+#include "envoy/compression/compressor/config.h"
+#include "envoy/registry/registry.h"
 #include "envoy/server/admin.h"
 
 #include "source/common/buffer/buffer_impl.h"
@@ -12,8 +14,12 @@
 #include "source/common/http/utility.h"
 #include "source/server/admin/prometheus_stats.h"
 #include "source/server/admin/stats_request.h"
+#include "source/server/generic_factory_context.h"
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 
 namespace Envoy {
 namespace Server {
@@ -21,30 +27,107 @@ namespace Server {
 const uint64_t RecentLookupsCapacity = 100;
 
 namespace {
-// Implements a chunked request for Prometheus stats.
+// Implements a chunked request for Prometheus stats. Metric groups are rendered as the response is
+// drained, and each chunk is compressed as it is produced if the client accepts it.
 class PrometheusRequest : public Admin::Request {
 public:
-  PrometheusRequest(StatsHandler& handler, const StatsParams& params, AdminStream& admin_stream)
-      : handler_(handler), params_(params), admin_stream_(admin_stream) {}
+  PrometheusRequest(Stats::Store& stats, const Stats::CustomStatNamespaces& custom_namespaces,
+                    const Upstream::ClusterManager& cluster_manager, const StatsParams& params,
+                    const Http::RequestHeaderMap& request_headers,
+                    PrometheusStatsFormatter::PrefixCache* prefix_cache,
+                    Compression::Compressor::CompressorFactory* compressor_factory)
+      : stats_(stats), custom_namespaces_(custom_namespaces), cluster_manager_(cluster_manager),
+        params_(params), request_headers_(request_headers),
+        // The protobuf format does not use the cache, so its scrapes must not sweep it.
+        prefix_cache_(PrometheusStatsFormatter::useProtobufFormat(params, request_headers)
+                          ? nullptr
+                          : prefix_cache),
+        compressor_factory_(compressor_factory) {}
 
   Http::Code start(Http::ResponseHeaderMap& response_headers) override {
-    code_ = handler_.prometheusFlushAndRender(params_, admin_stream_.getRequestHeaders(),
-                                              response_headers, response_);
-    return code_;
+    counters_ = stats_.counters();
+    gauges_ = stats_.gauges();
+    histograms_ = stats_.histograms();
+    if (params_.prometheus_text_readouts_) {
+      text_readouts_ = stats_.textReadouts();
+    }
+    output_format_ = PrometheusStatsFormatter::makeOutputFormat(params_, request_headers_,
+                                                                response_headers, prefix_cache_);
+    renderer_ = std::make_unique<PrometheusStatsFormatter::StreamingRenderer>(
+        counters_, gauges_, histograms_, text_readouts_, cluster_manager_, params_,
+        custom_namespaces_, *output_format_);
+    if (prefix_cache_ != nullptr) {
+      generation_ = prefix_cache_->startScrape();
+    }
+    if (compressor_factory_ != nullptr) {
+      compressor_ = compressor_factory_->createCompressor();
+      response_headers.setCopy(Http::CustomHeaders::get().ContentEncoding,
+                               compressor_factory_->contentEncoding());
+      response_headers.setReferenceKey(Http::CustomHeaders::get().Vary,
+                                       Http::CustomHeaders::get().VaryValues.AcceptEncoding);
+    }
+    return Http::Code::OK;
   }
 
   bool nextChunk(Buffer::Instance& response) override {
-    response.move(response_);
-    return false;
+    const bool more = renderer_->nextChunk(chunk_, chunk_size_);
+    if (!more && prefix_cache_ != nullptr) {
+      prefix_cache_->finishScrape(generation_, params_);
+    }
+    if (compressor_ != nullptr) {
+      // Flushing makes each chunk decodable as soon as it is received.
+      compressor_->compress(chunk_, more ? Compression::Compressor::State::Flush
+                                         : Compression::Compressor::State::Finish);
+    }
+    response.move(chunk_);
+    return more;
   }
 
 private:
-  StatsHandler& handler_;
+  Stats::Store& stats_;
+  const Stats::CustomStatNamespaces& custom_namespaces_;
+  const Upstream::ClusterManager& cluster_manager_;
   const StatsParams params_;
-  AdminStream& admin_stream_;
-  Buffer::OwnedImpl response_;
-  Http::Code code_{Http::Code::OK};
+  const Http::RequestHeaderMap& request_headers_;
+  PrometheusStatsFormatter::PrefixCache* const prefix_cache_;
+  Compression::Compressor::CompressorFactory* const compressor_factory_;
+  std::vector<Stats::CounterSharedPtr> counters_;
+  std::vector<Stats::GaugeSharedPtr> gauges_;
+  std::vector<Stats::ParentHistogramSharedPtr> histograms_;
+  std::vector<Stats::TextReadoutSharedPtr> text_readouts_;
+  std::unique_ptr<PrometheusStatsFormatter::OutputFormat> output_format_;
+  std::unique_ptr<PrometheusStatsFormatter::StreamingRenderer> renderer_;
+  Compression::Compressor::CompressorPtr compressor_;
+  Buffer::OwnedImpl chunk_;
+  const uint64_t chunk_size_{StatsRequest::DefaultChunkSize};
+  uint64_t generation_{0};
 };
+
+// Returns the compressor extension name for a lower case content coding supported by prometheus
+// requests.
+absl::optional<absl::string_view> compressorExtensionName(absl::string_view coding) {
+  if (coding == Http::CustomHeaders::get().ContentEncodingValues.Zstd) {
+    return "envoy.compression.zstd.compressor";
+  }
+  if (coding == Http::CustomHeaders::get().ContentEncodingValues.Gzip) {
+    return "envoy.compression.gzip.compressor";
+  }
+  return absl::nullopt;
+}
+
+// Returns true if an Accept-Encoding entry's parameters refuse the coding, i.e. contain "q=0".
+bool refusesCoding(absl::string_view params) {
+  for (absl::string_view param : absl::StrSplit(params, ';', absl::SkipWhitespace())) {
+    const std::pair<absl::string_view, absl::string_view> name_value =
+        absl::StrSplit(absl::StripAsciiWhitespace(param), absl::MaxSplits('=', 1));
+    double q;
+    if (absl::EqualsIgnoreCase(name_value.first, "q") &&
+        absl::SimpleAtod(name_value.second, &q) && q == 0) {
+      return true;
+    }
+  }
+  return false;
+}
 } // namespace
 
 StatsHandler::StatsHandler(Server::Instance& server) : HandlerContextBase(server) {}
@@ -107,14 +190,7 @@ Admin::RequestPtr StatsHandler::makeRequest(AdminStream& admin_stream) {
   }
 
   if (params.format_ == StatsFormat::Prometheus) {
-    // TODO(#16139): modify streaming algorithm to cover Prometheus.
-    //
-    // This may be easiest to accomplish by populating the set
-    // with tagExtractedName(), and allowing for vectors of
-    // stats as multiples will have the same tag-extracted names.
-    // Ideally we'd find a way to do this without slowing down
-    // the non-Prometheus implementations.
-    return std::make_unique<PrometheusRequest>(*this, params, admin_stream);
+    return makePrometheusRequest(params, admin_stream.getRequestHeaders());
   }
 
   if (params.histogram_buckets_mode_ == Utility::HistogramBucketsMode::PrometheusNative) {
@@ -143,39 +219,85 @@ Admin::RequestPtr StatsHandler::makeRequest(Stats::Store& stats, const StatsPara
   return std::make_unique<StatsRequest>(stats, params, cluster_manager, url_handler_fn);
 }
 
-Http::Code StatsHandler::handlerPrometheusStats(Http::ResponseHeaderMap& response_headers,
-                                                Buffer::Instance& response,
-                                                AdminStream& admin_stream) {
-  return prometheusStats(admin_stream.getRequestHeaders(), response_headers, response);
+Admin::RequestPtr StatsHandler::makePrometheusRequest(
+    Stats::Store& stats, const Stats::CustomStatNamespaces& custom_namespaces,
+    const Upstream::ClusterManager& cluster_manager, const StatsParams& params,
+    const Http::RequestHeaderMap& request_headers,
+    PrometheusStatsFormatter::PrefixCache* prefix_cache,
+    Compression::Compressor::CompressorFactory* compressor_factory) {
+  return std::make_unique<PrometheusRequest>(stats, custom_namespaces, cluster_manager, params,
+                                             request_headers, prefix_cache, compressor_factory);
 }
 
-Http::Code StatsHandler::prometheusStats(const Http::RequestHeaderMap& request_headers,
-                                         Http::ResponseHeaderMap& response_headers,
-                                         Buffer::Instance& response) {
+Admin::RequestPtr StatsHandler::makePrometheusRequest(AdminStream& admin_stream) {
   StatsParams params;
-  Http::Code code = params.parse(request_headers.getPathValue(), response);
+  Buffer::OwnedImpl response;
+  Http::Code code = params.parse(admin_stream.getRequestHeaders().getPathValue(), response);
   if (code != Http::Code::OK) {
-    return code;
+    return Admin::makeStaticTextRequest(response, code);
   }
-
-  return prometheusFlushAndRender(params, request_headers, response_headers, response);
+  return makePrometheusRequest(params, admin_stream.getRequestHeaders());
 }
 
-Http::Code StatsHandler::prometheusFlushAndRender(const StatsParams& params,
-                                                  const Http::RequestHeaderMap& request_headers,
-                                                  Http::ResponseHeaderMap& response_headers,
-                                                  Buffer::Instance& response) {
-  absl::Status paramsStatus = PrometheusStatsFormatter::validateParams(params, request_headers);
-  if (!paramsStatus.ok()) {
-    response.add(paramsStatus.message());
-    return Http::Code::BadRequest;
+Admin::RequestPtr
+StatsHandler::makePrometheusRequest(const StatsParams& params,
+                                    const Http::RequestHeaderMap& request_headers) {
+  absl::Status params_status = PrometheusStatsFormatter::validateParams(params, request_headers);
+  if (!params_status.ok()) {
+    return Admin::makeStaticTextRequest(params_status.message(), Http::Code::BadRequest);
   }
   if (server_.statsConfig().flushOnAdmin()) {
     server_.flushStats();
   }
-  prometheusRender(server_.stats(), server_.api().customStatNamespaces(), server_.clusterManager(),
-                   params, request_headers, response_headers, response);
-  return Http::Code::OK;
+  if (prometheus_prefix_cache_ == nullptr) {
+    prometheus_prefix_cache_ =
+        std::make_unique<PrometheusStatsFormatter::PrefixCache>(server_.stats().symbolTable());
+  }
+  return makePrometheusRequest(server_.stats(), server_.api().customStatNamespaces(),
+                               server_.clusterManager(), params, request_headers,
+                               prometheus_prefix_cache_.get(),
+                               prometheusCompressorFactory(request_headers));
+}
+
+Compression::Compressor::CompressorFactory*
+StatsHandler::prometheusCompressorFactory(const Http::RequestHeaderMap& request_headers) {
+  Compression::Compressor::CompressorFactory* result = nullptr;
+  request_headers.get(Http::CustomHeaders::get().AcceptEncoding)
+      .iterate([&](const Http::HeaderEntry& header) -> Http::HeaderMap::Iterate {
+        for (absl::string_view entry :
+             absl::StrSplit(header.value().getStringView(), ',', absl::SkipWhitespace())) {
+          const std::pair<absl::string_view, absl::string_view> coding_params =
+              absl::StrSplit(entry, absl::MaxSplits(';', 1));
+          const std::string coding =
+              absl::AsciiStrToLower(absl::StripAsciiWhitespace(coding_params.first));
+          const absl::optional<absl::string_view> extension_name = compressorExtensionName(coding);
+          if (!extension_name.has_value() || refusesCoding(coding_params.second)) {
+            continue;
+          }
+          auto it = compressor_factories_.find(coding);
+          if (it == compressor_factories_.end()) {
+            Compression::Compressor::CompressorFactoryPtr factory;
+            auto* config_factory = Registry::FactoryRegistry<
+                Compression::Compressor::NamedCompressorLibraryConfigFactory>::
+                getFactory(*extension_name);
+            if (config_factory != nullptr) {
+              // The compressor extensions' default configuration is used.
+              ProtobufTypes::MessagePtr config = config_factory->createEmptyConfigProto();
+              GenericFactoryContextImpl context(
+                  server_.serverFactoryContext(),
+                  server_.messageValidationContext().staticValidationVisitor());
+              factory = config_factory->createCompressorFactoryFromProto(*config, context);
+            }
+            it = compressor_factories_.emplace(coding, std::move(factory)).first;
+          }
+          if (it->second != nullptr) {
+            result = it->second.get();
+            return Http::HeaderMap::Iterate::Break;
+          }
+        }
+        return Http::HeaderMap::Iterate::Continue;
+      });
+  return result;
 }
 
 void StatsHandler::prometheusRender(Stats::Store& stats,
@@ -249,5 +371,26 @@ Admin::UrlHandler StatsHandler::statsHandler(bool active_mode) {
       params};
 }
 
+Admin::UrlHandler StatsHandler::prometheusHandler() {
+  return {"/stats/prometheus",
+          "print server stats in prometheus format",
+          [this](AdminStream& admin_stream) -> Admin::RequestPtr {
+            return makePrometheusRequest(admin_stream);
+          },
+          false,
+          false,
+          {{Admin::ParamDescriptor::Type::Boolean, "usedonly",
+            "Only include stats that have been written by system since restart"},
+           {Admin::ParamDescriptor::Type::Boolean, "text_readouts",
+            "Render text_readouts as new gaugues with value 0 (increases Prometheus "
+            "data size)"},
+           {Admin::ParamDescriptor::Type::String, "filter",
+            "Regular expression (Google re2) for filtering stats"},
+           {Admin::ParamDescriptor::Type::Enum,
+            "histogram_buckets",
+            "Histogram bucket display mode",
+            {"cumulative", "summary"}}}};
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -4,15 +4,18 @@
 #include <string>
 
 #include "envoy/buffer/buffer.h"
+#include "envoy/compression/compressor/factory.h"
 #include "envoy/http/codes.h"
 #include "envoy/http/header_map.h"
 #include "envoy/server/admin.h"
 #include "envoy/server/instance.h"
 
 #include "source/server/admin/handler_ctx.h"
+#include "source/server/admin/prometheus_stats.h"
 #include "source/server/admin/stats_request.h"
 #include "source/server/admin/utils.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
@@ -33,31 +36,6 @@ public:
                                               Buffer::Instance& response, AdminStream&);
   Http::Code handlerStatsRecentLookupsEnable(Http::ResponseHeaderMap& response_headers,
                                              Buffer::Instance& response, AdminStream&);
-  Http::Code handlerPrometheusStats(Http::ResponseHeaderMap& response_headers,
-                                    Buffer::Instance& response, AdminStream&);
-
-  /**
-   * Parses and executes a prometheus stats request.
-   *
-   * @param path_and_query the URL path and query
-   * @param response buffer into which to write response
-   * @return http response code
-   */
-  Http::Code prometheusStats(const Http::RequestHeaderMap& request_headers,
-                             Http::ResponseHeaderMap& response_headers, Buffer::Instance& response);
-
-  /**
-   * Checks the server_ to see if a flush is needed, and then renders the
-   * prometheus stats request.
-   *
-   * @params params the already-parsed parameters.
-   * @param response buffer into which to write response
-   */
-  Http::Code prometheusFlushAndRender(const StatsParams& params,
-                                      const Http::RequestHeaderMap& request_headers,
-                                      Http::ResponseHeaderMap& response_headers,
-                                      Buffer::Instance& response);
-
   /**
    * Renders the stats as prometheus. This is broken out as a separately
    * callable API to facilitate the benchmark
@@ -92,10 +70,50 @@ public:
    */
   Admin::UrlHandler statsHandler(bool active_mode);
 
+  /**
+   * @return a URL handler for /stats/prometheus, which streams the stats out in chunks.
+   */
+  Admin::UrlHandler prometheusHandler();
+
   static Admin::RequestPtr makeRequest(Stats::Store& stats, const StatsParams& params,
                                        const Upstream::ClusterManager& cm,
                                        StatsRequest::UrlHandlerFn url_handler_fn = nullptr);
   Admin::RequestPtr makeRequest(AdminStream&);
+
+  /**
+   * Makes a request that streams the stats out in the prometheus exposition format, a group of
+   * metrics sharing a name at a time. This is broken out as a separately callable API to
+   * facilitate the benchmark (test/server/admin/stats_handler_speed_test.cc) which does not have a
+   * server object. The params must have been validated.
+   *
+   * @param request_headers the request headers, which must outlive the request.
+   * @param prefix_cache if non-null, caches the rendered name and labels of each metric across
+   *        requests.
+   * @param compressor_factory if non-null, compresses the response with the encoding it provides.
+   */
+  static Admin::RequestPtr
+  makePrometheusRequest(Stats::Store& stats, const Stats::CustomStatNamespaces& custom_namespaces,
+                        const Upstream::ClusterManager& cluster_manager, const StatsParams& params,
+                        const Http::RequestHeaderMap& request_headers,
+                        PrometheusStatsFormatter::PrefixCache* prefix_cache,
+                        Compression::Compressor::CompressorFactory* compressor_factory);
+  Admin::RequestPtr makePrometheusRequest(AdminStream& admin_stream);
+
+private:
+  Admin::RequestPtr makePrometheusRequest(const StatsParams& params,
+                                          const Http::RequestHeaderMap& request_headers);
+
+  // Returns the factory for the first content coding accepted by the request for which a
+  // compressor extension is linked in, or nullptr if the response is to be sent uncompressed.
+  Compression::Compressor::CompressorFactory*
+  prometheusCompressorFactory(const Http::RequestHeaderMap& request_headers);
+
+  // Shared by all prometheus requests, and created on first use.
+  std::unique_ptr<PrometheusStatsFormatter::PrefixCache> prometheus_prefix_cache_;
+  // Compressor factories by content coding, created on first use. An entry is null if the
+  // compressor extension for the coding is not linked in.
+  absl::flat_hash_map<std::string, Compression::Compressor::CompressorFactoryPtr>
+      compressor_factories_;
 };
 
 } // namespace Server
@@ -9,6 +9,9 @@ namespace Server {
 // This macro defines the listener stats which each Envoy listener will have.
 #define ALL_LISTENER_STATS(COUNTER, GAUGE, HISTOGRAM)                                              \
   COUNTER(downstream_cx_destroy)                                                                   \
+  COUNTER(downstream_cx_idle_memory_shed)                                                          \
+  COUNTER(downstream_cx_idle_memory_shed_bytes)                                                    \
+  COUNTER(downstream_cx_non_local_cpu)                                                             \
   COUNTER(downstream_cx_overflow)                                                                  \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_transport_socket_connect_timeout)                                          \
@@ -15,6 +15,7 @@
 #include "source/common/version/version.h"
 #include "source/server/options_impl_platform.h"
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
@@ -161,6 +162,10 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
       "", "enable-mutex-tracing", "Enable mutex contention tracing functionality", cmd, false);
   TCLAP::SwitchArg cpuset_threads(
       "", "cpuset-threads", "Get the default # of worker threads from cpuset size", cmd, false);
+  TCLAP::ValueArg<std::string> worker_cpus(
+      "", "worker-cpus",
+      "Comma-separated list of CPUs to pin worker threads to, one per worker", false, "", "string",
+      cmd);
 
   TCLAP::ValueArg<std::string> disable_extensions("", "disable-extensions",
                                                   "Comma-separated list of extensions to disable",
@@ -276,6 +281,17 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
     concurrency_ = std::max(1U, concurrency.getValue());
   }
 
+  if (!worker_cpus.getValue().empty()) {
+    parseWorkerCpus(worker_cpus.getValue());
+    if (concurrency.isSet() && concurrency_ != worker_cpus_.size()) {
+      throw MalformedArgvException(
+          fmt::format("error: --worker-cpus lists {} CPUs but --concurrency is {}",
+                      worker_cpus_.size(), concurrency_));
+    }
+    // Without an explicit --concurrency, run one worker per listed CPU.
+    concurrency_ = worker_cpus_.size();
+  }
+
   config_path_ = config_path.getValue();
   config_yaml_ = config_yaml.getValue();
   if (allow_unknown_fields.getValue()) {
@@ -395,6 +411,16 @@ void OptionsImpl::parseComponentLogLevels(const std::string& component_log_level
   }
 }
 
+void OptionsImpl::parseWorkerCpus(const std::string& worker_cpus) {
+  for (absl::string_view cpu_string : absl::StrSplit(worker_cpus, ',')) {
+    uint32_t cpu;
+    if (!absl::SimpleAtoi(cpu_string, &cpu)) {
+      throw MalformedArgvException(fmt::format("error: invalid worker CPU '{}'", cpu_string));
+    }
+    worker_cpus_.push_back(cpu);
+  }
+}
+
 void OptionsImpl::logError(const std::string& error) { throw MalformedArgvException(error); }
 
 Server::CommandLineOptionsPtr OptionsImpl::toCommandLineOptions() const {
@@ -449,6 +475,9 @@ Server::CommandLineOptionsPtr OptionsImpl::toCommandLineOptions() const {
   command_line_options->set_disable_hot_restart(hotRestartDisabled());
   command_line_options->set_enable_mutex_tracing(mutexTracingEnabled());
   command_line_options->set_cpuset_threads(cpusetThreadsEnabled());
+  for (const uint32_t cpu : workerCpus()) {
+    command_line_options->add_worker_cpus(cpu);
+  }
   command_line_options->set_restart_epoch(restartEpoch());
   for (const auto& e : disabledExtensions()) {
     command_line_options->add_disabled_extensions(e);
@@ -98,7 +98,8 @@ InstanceBase::InstanceBase(Init::Manager& init_manager, const Options& options,
       dispatcher_(api_->allocateDispatcher("main_thread")),
       access_log_manager_(options.fileFlushIntervalMsec(), options.fileFlushMinSizeKB(), *api_,
                           *dispatcher_, access_log_lock, store),
-      handler_(getHandler(*dispatcher_)), worker_factory_(thread_local_, *api_, hooks),
+      handler_(getHandler(*dispatcher_)),
+      worker_factory_(thread_local_, *api_, hooks, options.workerCpus()),
       mutex_tracer_(options.mutexTracingEnabled() ? &Envoy::MutexTracerImpl::getOrCreateTracer()
                                                   : nullptr),
       grpc_context_(store.symbolTable()), http_context_(store.symbolTable()),
@@ -167,35 +168,84 @@ void InstanceBase::failHealthcheck(bool fail) {
   server_stats_->live_.set(live_.load());
 }
 
+bool MetricDeltaTracker::startFlush() {
+  if (flush_count_++ % full_flush_on_flush_ == 0) {
+    // Every gauge is included in a full flush, so forget the gauges that were freed since the
+    // previous one.
+    flushed_gauges_.clear();
+    return false;
+  }
+  return true;
+}
+
+bool MetricDeltaTracker::gaugeChanged(const Stats::Gauge& gauge) {
+  const uint64_t value = gauge.value();
+  const uint64_t name_hash = gauge.statName().hash();
+  auto [it, inserted] = flushed_gauges_.try_emplace(&gauge, FlushedGauge{value, name_hash});
+  if (inserted) {
+    return true;
+  }
+  if (it->second.value_ == value && it->second.name_hash_ == name_hash) {
+    return false;
+  }
+  it->second = {value, name_hash};
+  return true;
+}
+
 MetricSnapshotImpl::MetricSnapshotImpl(Stats::Store& store,
                                        Upstream::ClusterManager& cluster_manager,
-                                       TimeSource& time_source) {
+                                       TimeSource& time_source,
+                                       OptRef<MetricDeltaTracker> delta_tracker) {
+  partial_ = delta_tracker.has_value() && delta_tracker->startFlush();
+
+  // In a partial snapshot, the vectors are only reserved for the metrics that are included, as
+  // they are typically a small fraction of all metrics.
   store.forEachSinkedCounter(
       [this](std::size_t size) {
-        snapped_counters_.reserve(size);
-        counters_.reserve(size);
+        if (!partial_) {
+          snapped_counters_.reserve(size);
+          counters_.reserve(size);
+        }
       },
       [this](Stats::Counter& counter) {
+        // Counters are latched even if they are not included, so that the next delta only covers
+        // the increments since this snapshot.
+        const uint64_t delta = counter.latch();
+        if (partial_ && delta == 0) {
+          return;
+        }
         snapped_counters_.push_back(Stats::CounterSharedPtr(&counter));
-        counters_.push_back({counter.latch(), counter});
+        counters_.push_back({delta, counter});
       });
 
   store.forEachSinkedGauge(
       [this](std::size_t size) {
-        snapped_gauges_.reserve(size);
-        gauges_.reserve(size);
+        if (!partial_) {
+          snapped_gauges_.reserve(size);
+          gauges_.reserve(size);
+        }
       },
-      [this](Stats::Gauge& gauge) {
+      [this, delta_tracker](Stats::Gauge& gauge) {
+        // The tracker sees the gauges of full flushes too, to remember their values.
+        const bool changed = !delta_tracker.has_value() || delta_tracker->gaugeChanged(gauge);
+        if (partial_ && !changed) {
+          return;
+        }
         snapped_gauges_.push_back(Stats::GaugeSharedPtr(&gauge));
         gauges_.push_back(gauge);
       });
 
   store.forEachSinkedHistogram(
       [this](std::size_t size) {
-        snapped_histograms_.reserve(size);
-        histograms_.reserve(size);
+        if (!partial_) {
+          snapped_histograms_.reserve(size);
+          histograms_.reserve(size);
+        }
       },
       [this](Stats::ParentHistogram& histogram) {
+        if (partial_ && histogram.intervalStatistics().sampleCount() == 0) {
+          return;
+        }
         snapped_histograms_.push_back(Stats::ParentHistogramSharedPtr(&histogram));
         histograms_.push_back(histogram);
       });
@@ -213,6 +263,9 @@ MetricSnapshotImpl::MetricSnapshotImpl(Stats::Store& store,
   Upstream::HostUtility::forEachHostMetric(
       cluster_manager,
       [this](Stats::PrimitiveCounterSnapshot&& metric) {
+        if (partial_ && metric.delta() == 0) {
+          return;
+        }
         host_counters_.emplace_back(std::move(metric));
       },
       [this](Stats::PrimitiveGaugeSnapshot&& metric) {
@@ -223,12 +276,13 @@ MetricSnapshotImpl::MetricSnapshotImpl(Stats::Store& store,
 }
 
 void InstanceUtil::flushMetricsToSinks(const std::list<Stats::SinkPtr>& sinks, Stats::Store& store,
-                                       Upstream::ClusterManager& cm, TimeSource& time_source) {
+                                       Upstream::ClusterManager& cm, TimeSource& time_source,
+                                       OptRef<MetricDeltaTracker> delta_tracker) {
   // Create a snapshot and flush to all sinks.
   // NOTE: Even if there are no sinks, creating the snapshot has the important property that it
   //       latches all counters on a periodic basis. The hot restart code assumes this is being
   //       done so this should not be removed.
-  MetricSnapshotImpl snapshot(store, cm, time_source);
+  MetricSnapshotImpl snapshot(store, cm, time_source, delta_tracker);
   for (const auto& sink : sinks) {
     sink->flush(snapshot);
   }
@@ -291,7 +345,7 @@ void InstanceBase::flushStatsInternal() {
   auto& stats_config = config_.statsConfig();
   ASSERT(config_.clusterManager() != nullptr);
   InstanceUtil::flushMetricsToSinks(stats_config.sinks(), stats_store_, *config_.clusterManager(),
-                                    time_source_);
+                                    time_source_, makeOptRefFromPtr(metric_delta_tracker_.get()));
   if (const auto evict_on_flush = stats_config.evictOnFlush(); evict_on_flush > 0) {
     stats_eviction_counter_ = (stats_eviction_counter_ + 1) % evict_on_flush;
     if (stats_eviction_counter_ == 0) {
@@ -548,6 +602,11 @@ absl::Status InstanceBase::initializeOrThrow(Network::Address::InstanceConstShar
   stats_store_.setTagProducer(std::move(producer_or_error.value()));
   stats_store_.setStatsMatcher(std::make_unique<Stats::StatsMatcherImpl>(
       bootstrap_.stats_config(), stats_store_.symbolTable(), server_contexts_));
+  if (bootstrap_.stats_config().has_sharded_counters()) {
+    stats_store_.setShardedCounterMatcher(std::make_unique<Stats::StatsMatcherImpl>(
+        bootstrap_.stats_config().sharded_counters(), stats_store_.symbolTable(),
+        server_contexts_));
+  }
   stats_store_.setHistogramSettings(
       std::make_unique<Stats::HistogramSettingsImpl>(bootstrap_.stats_config(), server_contexts_));
 
@@ -866,6 +925,9 @@ absl::Status InstanceBase::initializeOrThrow(Network::Address::InstanceConstShar
   for (const Stats::SinkPtr& sink : stats_config.sinks()) {
     stats_store_.addSink(*sink);
   }
+  if (const auto full_flush_on_flush = stats_config.fullFlushOnFlush(); full_flush_on_flush > 0) {
+    metric_delta_tracker_ = std::make_unique<MetricDeltaTracker>(full_flush_on_flush);
+  }
   if (!stats_config.flushOnAdmin()) {
     // Some of the stat sinks may need dispatcher support so don't flush until the main loop starts.
     // Just setup the timer.
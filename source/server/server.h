@@ -48,6 +48,7 @@
 #include "source/server/listener_hooks.h"
 #include "source/server/worker_impl.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/types/optional.h"
 
@@ -116,6 +117,8 @@ public:
   virtual Runtime::LoaderPtr createRuntime(Instance& server, Configuration::Initial& config) PURE;
 };
 
+class MetricDeltaTracker;
+
 /**
  * Helpers used during server creation.
  */
@@ -132,9 +135,12 @@ public:
    * flush() on each sink.
    * @param sinks supplies the list of sinks.
    * @param store provides the store being flushed.
+   * @param delta_tracker if set, tracks the metrics flushed previously so that the flush only
+   *        includes the metrics that changed, unless a full flush is due.
    */
   static void flushMetricsToSinks(const std::list<Stats::SinkPtr>& sinks, Stats::Store& store,
-                                  Upstream::ClusterManager& cm, TimeSource& time_source);
+                                  Upstream::ClusterManager& cm, TimeSource& time_source,
+                                  OptRef<MetricDeltaTracker> delta_tracker = {});
 
   /**
    * Load a bootstrap config and perform validation.
@@ -453,6 +459,8 @@ private:
   };
 
   uint32_t stats_eviction_counter_{0};
+  // Set if flushes only include the metrics that changed since the previous flush.
+  std::unique_ptr<MetricDeltaTracker> metric_delta_tracker_;
 
 #ifdef ENVOY_PERFETTO
   std::unique_ptr<perfetto::TracingSession> tracing_session_{};
@@ -460,6 +468,32 @@ private:
 #endif
 };
 
+// Remembers what the previous stats flushes included, so that a flush can only include the
+// metrics that changed since, with a full flush every full_flush_on_flush flushes so that sinks
+// that missed a flush eventually see every metric again.
+class MetricDeltaTracker {
+public:
+  explicit MetricDeltaTracker(uint32_t full_flush_on_flush)
+      : full_flush_on_flush_(full_flush_on_flush) {}
+
+  // Starts a flush, returning whether it only includes the metrics that changed.
+  bool startFlush();
+  // Returns whether the gauge is new or its value changed since the previous flush.
+  bool gaugeChanged(const Stats::Gauge& gauge);
+
+private:
+  struct FlushedGauge {
+    uint64_t value_;
+    // Distinguishes a gauge that was freed from a new one allocated at the same address.
+    uint64_t name_hash_;
+  };
+
+  const uint32_t full_flush_on_flush_;
+  uint32_t flush_count_{0};
+  // Gauges that were freed are only dropped at the next full flush.
+  absl::flat_hash_map<const Stats::Gauge*, FlushedGauge> flushed_gauges_;
+};
+
 // Local implementation of Stats::MetricSnapshot used to flush metrics to sinks. We could
 // potentially have a single class instance held in a static and have a clear() method to avoid some
 // vector constructions and reservations, but I'm not sure it's worth the extra complexity until it
@@ -470,9 +504,11 @@ private:
 class MetricSnapshotImpl : public Stats::MetricSnapshot {
 public:
   // MetricSnapshotImpl captures a snapshot of metrics by latching the delta usage, and optionally
-  // marking the stats as used.
+  // marking the stats as used. If delta_tracker is set and no full flush is due, only the metrics
+  // that changed since the previous snapshot are included. Counters are latched either way.
   explicit MetricSnapshotImpl(Stats::Store& store, Upstream::ClusterManager& cluster_manager,
-                              TimeSource& time_source);
+                              TimeSource& time_source,
+                              OptRef<MetricDeltaTracker> delta_tracker = {});
 
   // Stats::MetricSnapshot
   const std::vector<CounterSnapshot>& counters() override { return counters_; }
@@ -490,6 +526,7 @@ public:
   }
   const std::vector<Stats::PrimitiveGaugeSnapshot>& hostGauges() override { return host_gauges_; }
   SystemTime snapshotTime() const override { return snapshot_time_; }
+  bool partial() const override { return partial_; }
 
 private:
   std::vector<Stats::CounterSharedPtr> snapped_counters_;
@@ -503,6 +540,7 @@ private:
   std::vector<Stats::PrimitiveCounterSnapshot> host_counters_;
   std::vector<Stats::PrimitiveGaugeSnapshot> host_gauges_;
   SystemTime snapshot_time_;
+  bool partial_{false};
 };
 
 } // namespace Server
@@ -1,5 +1,7 @@
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "source/common/access_log/access_log_manager_impl.h"
 #include "source/common/filesystem/file_shared_impl.h"
@@ -11,6 +13,8 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -159,6 +163,25 @@ TEST_F(AccessLogManagerImplTest, FlushToLogFilePeriodically) {
   EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+TEST_F(AccessLogManagerImplTest, FlushTimerSkipsEmptyShards) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
+  AccessLogFileSharedPtr log_file =
+      access_log_manager_
+          .createAccessLog(Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"})
+          .value();
+
+  // Nothing has been written, so the timer is re-enabled without requesting a flush.
+  EXPECT_CALL(*file_, write_(_)).Times(0);
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
+  timer->invokeCallback();
+  EXPECT_EQ(0UL, store_.counter("filesystem.flushed_by_timer").value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
 TEST_F(AccessLogManagerImplTest, FlushToLogFileOnDemand) {
   NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
 
@@ -171,9 +194,9 @@ TEST_F(AccessLogManagerImplTest, FlushToLogFileOnDemand) {
 
   EXPECT_EQ(0UL, store_.counter("filesystem.flushed_by_timer").value());
 
-  // The first write to a given file will start the flush thread. Because AccessManagerImpl::write
-  // holds the write_lock_ when the thread is started, the thread will flush on its first loop, once
-  // it obtains the write_lock_. Perform a write to get all that out of the way.
+  // The first write to a given file will start the flush thread. The thread is started with a
+  // pending flush request, so it will flush on its first loop. Perform a write to get all that out
+  // of the way.
   EXPECT_CALL(*file_, write_(_))
       .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
         return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
@@ -446,6 +469,63 @@ TEST_F(AccessLogManagerImplTest, BigDataChunkShouldBeFlushedWithoutTimer) {
   EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+TEST_F(AccessLogManagerImplTest, ConcurrentWriters) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file =
+      access_log_manager_
+          .createAccessLog(Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"})
+          .value();
+
+  absl::Mutex written_mutex;
+  std::string written;
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        absl::MutexLock lock(&written_mutex);
+        written.append(data);
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  constexpr int num_threads = 4;
+  constexpr int num_lines = 200;
+  std::vector<Thread::ThreadPtr> writers;
+  for (int t = 0; t < num_threads; ++t) {
+    writers.push_back(thread_factory_.createThread([&log_file, t]() {
+      for (int i = 0; i < num_lines; ++i) {
+        log_file->write(absl::StrCat(t, " ", i, "\n"));
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& writer : writers) {
+    writer->join();
+  }
+  log_file->flush();
+
+  EXPECT_EQ(num_threads * num_lines, store_.counter("filesystem.write_buffered").value());
+  EXPECT_TRUE(waitForGauge("filesystem.write_total_buffered", Eq(0)));
+
+  // Lines of different threads may be interleaved in any order, but every line is intact and the
+  // lines of a single thread keep their order.
+  std::vector<int> next_line(num_threads, 0);
+  {
+    absl::MutexLock lock(&written_mutex);
+    for (absl::string_view line : absl::StrSplit(written, '\n', absl::SkipEmpty())) {
+      std::vector<absl::string_view> fields = absl::StrSplit(line, ' ');
+      ASSERT_EQ(2, fields.size());
+      int t;
+      int i;
+      ASSERT_TRUE(absl::SimpleAtoi(fields[0], &t));
+      ASSERT_TRUE(absl::SimpleAtoi(fields[1], &i));
+      ASSERT_LT(t, num_threads);
+      EXPECT_EQ(next_line[t]++, i);
+    }
+  }
+  for (int t = 0; t < num_threads; ++t) {
+    EXPECT_EQ(num_lines, next_line[t]);
+  }
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
 TEST_F(AccessLogManagerImplTest, ReopenAllFiles) {
   EXPECT_CALL(dispatcher_, createTimer_(_)).WillRepeatedly(ReturnNew<NiceMock<Event::MockTimer>>());
 
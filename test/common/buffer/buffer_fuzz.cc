@@ -152,6 +152,9 @@ public:
     return mutableStart();
   }
 
+  // The content lives in a fixed array, there is no spare memory to release.
+  uint64_t shrinkToFit() override { return 0; }
+
   Buffer::SliceDataPtr extractMutableFrontSlice() override { PANIC("not implemented"); }
 
   void move(Buffer::Instance& rhs) override { move(rhs, rhs.length()); }
@@ -343,6 +343,37 @@ BENCHMARK(bufferReserveCommitPartial)
     ->Arg(64 * 1024)
     ->Arg(128 * 1024);
 
+// Test adding a slice worth of data to an empty buffer and draining it again. The storage of a
+// default-sized (16 KiB) slice is recycled through the SliceStoragePool, while the storage of the
+// next larger slice size (20 KiB) comes from the allocator every time.
+static void bufferAddDrainSlice(benchmark::State& state) {
+  const std::string data(state.range(0), 'a');
+  const absl::string_view input(data);
+  Buffer::OwnedImpl buffer;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    buffer.add(input);
+    buffer.drain(buffer.length());
+  }
+  benchmark::DoNotOptimize(buffer.length());
+}
+BENCHMARK(bufferAddDrainSlice)->Arg(16 * 1024)->Arg(20 * 1024);
+
+// Same as bufferAddDrainSlice, without copying the data, so that the cost of allocating and
+// releasing the slice storage dominates.
+static void bufferReserveDrainSlice(benchmark::State& state) {
+  const uint64_t size = state.range(0);
+  Buffer::OwnedImpl buffer;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    Buffer::ReservationSingleSlice reservation = buffer.reserveSingleSlice(size);
+    reservation.commit(1);
+    buffer.drain(buffer.length());
+  }
+  benchmark::DoNotOptimize(buffer.length());
+}
+BENCHMARK(bufferReserveDrainSlice)->Arg(16 * 1024)->Arg(20 * 1024);
+
 // Test the linearization of a buffer in the best case where the data is in one slice.
 static void bufferLinearizeSimple(benchmark::State& state) {
   const std::string data(state.range(0), 'a');
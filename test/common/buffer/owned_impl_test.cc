@@ -456,6 +456,63 @@ TEST_F(OwnedImplTest, ExtractWithDrainTracker) {
   slice.reset();
 }
 
+TEST_F(OwnedImplTest, ExtractSlicesKeepsStorageUntilDestroyed) {
+  testing::InSequence s;
+
+  Buffer::OwnedImpl buffer;
+  buffer.appendSliceForTest("aaaa");
+  testing::MockFunction<void()> tracker;
+  buffer.addDrainTracker(tracker.AsStdFunction());
+  buffer.appendSliceForTest("bbbb");
+  const void* first_slice_memory = buffer.frontSlice().mem_;
+
+  // Extract the first slice and half of the second one.
+  Buffer::SliceDeque slices;
+  buffer.extractSlices(6, slices);
+  EXPECT_EQ("bb", buffer.toString());
+  EXPECT_EQ(1, buffer.getRawSlices().size());
+  ASSERT_EQ(2, slices.size());
+  EXPECT_EQ(first_slice_memory, slices[0].data());
+  EXPECT_EQ("aaaa", absl::string_view(reinterpret_cast<const char*>(slices[0].data()), 4));
+  EXPECT_EQ("bbbb", absl::string_view(reinterpret_cast<const char*>(slices[1].data()), 4));
+
+  // Drain trackers only fire once the extracted slices are released.
+  testing::MockFunction<void()> done;
+  EXPECT_CALL(done, Call());
+  EXPECT_CALL(tracker, Call());
+  done.Call();
+  slices = Buffer::SliceDeque();
+}
+
+TEST_F(OwnedImplTest, ShrinkToFit) {
+  Buffer::OwnedImpl buffer;
+  EXPECT_EQ(0, buffer.shrinkToFit());
+
+  // A few bytes left in a 12 KiB slice are copied to a 4 KiB one.
+  buffer.add(std::string(10000, 'a'));
+  buffer.drain(9990);
+  EXPECT_EQ(8192, buffer.shrinkToFit());
+  EXPECT_EQ(std::string(10, 'a'), buffer.toString());
+  EXPECT_EQ(0, buffer.shrinkToFit());
+
+  // Once drained, slices that outgrew the inline ring of the buffer free the ring they grew.
+  for (int i = 0; i < 20; ++i) {
+    buffer.appendSliceForTest("b");
+  }
+  buffer.drain(buffer.length() - 1);
+  EXPECT_EQ(32 * sizeof(Buffer::Slice), buffer.shrinkToFit());
+  EXPECT_EQ("b", buffer.toString());
+
+  // Slices with drain trackers are kept.
+  testing::MockFunction<void()> tracker;
+  buffer.add(std::string(10000, 'c'));
+  buffer.addDrainTracker(tracker.AsStdFunction());
+  buffer.drain(9990);
+  EXPECT_EQ(0, buffer.shrinkToFit());
+  EXPECT_CALL(tracker, Call());
+  buffer.drain(buffer.length());
+}
+
 TEST_F(OwnedImplTest, DrainTracking) {
   testing::InSequence s;
 
@@ -0,0 +1,142 @@
+#include <vector>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/buffer/slice_storage_pool.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+
+class SliceStoragePoolPeer {
+public:
+  static void setMaxGlobalBytes(uint64_t max_bytes) {
+    SliceStoragePool::setMaxGlobalBytes(max_bytes);
+  }
+};
+
+namespace {
+
+class SliceStoragePoolTest : public testing::Test {
+protected:
+  SliceStoragePoolTest() { reset(); }
+  ~SliceStoragePoolTest() override { reset(); }
+
+  static void reset() {
+    SliceStoragePoolPeer::setMaxGlobalBytes(SliceStoragePool::DefaultMaxGlobalBytes);
+    SliceStoragePool::releaseFreeMemory();
+  }
+
+  static void releaseAll(std::vector<SliceStoragePool::StoragePtr>& storages) {
+    for (auto& storage : storages) {
+      SliceStoragePool::release(std::move(storage));
+    }
+    storages.clear();
+  }
+};
+
+TEST_F(SliceStoragePoolTest, ReusesReleasedStorage) {
+  SliceStoragePool::StoragePtr storage = SliceStoragePool::allocate();
+  uint8_t* const address = storage.get();
+  SliceStoragePool::release(std::move(storage));
+  EXPECT_EQ(1, SliceStoragePool::threadCacheSize());
+
+  storage = SliceStoragePool::allocate();
+  EXPECT_EQ(address, storage.get());
+  EXPECT_EQ(0, SliceStoragePool::threadCacheSize());
+  SliceStoragePool::release(std::move(storage));
+}
+
+TEST_F(SliceStoragePoolTest, FullThreadCacheSpillsToGlobalPool) {
+  std::vector<SliceStoragePool::StoragePtr> storages;
+  for (uint32_t i = 0; i < SliceStoragePool::ThreadCacheMax + 1; ++i) {
+    storages.push_back(SliceStoragePool::allocate());
+  }
+  releaseAll(storages);
+  EXPECT_EQ(SliceStoragePool::ThreadCacheMax - SliceStoragePool::TransferBatch + 1,
+            SliceStoragePool::threadCacheSize());
+  EXPECT_EQ(SliceStoragePool::TransferBatch * SliceStoragePool::StorageSize,
+            SliceStoragePool::globalPoolBytes());
+}
+
+TEST_F(SliceStoragePoolTest, GlobalPoolIsBounded) {
+  SliceStoragePoolPeer::setMaxGlobalBytes(SliceStoragePool::StorageSize);
+
+  std::vector<SliceStoragePool::StoragePtr> storages;
+  for (uint32_t i = 0; i < SliceStoragePool::ThreadCacheMax + 1; ++i) {
+    storages.push_back(SliceStoragePool::allocate());
+  }
+  releaseAll(storages);
+  EXPECT_EQ(SliceStoragePool::StorageSize, SliceStoragePool::globalPoolBytes());
+
+  SliceStoragePoolPeer::setMaxGlobalBytes(0);
+  EXPECT_EQ(0, SliceStoragePool::globalPoolBytes());
+}
+
+TEST_F(SliceStoragePoolTest, ReleaseFreeMemoryDropsEveryThreadCache) {
+  std::vector<SliceStoragePool::StoragePtr> storages;
+  for (uint32_t i = 0; i < SliceStoragePool::ThreadCacheMax + 1; ++i) {
+    storages.push_back(SliceStoragePool::allocate());
+  }
+  releaseAll(storages);
+
+  size_t other_thread_cache_size = 0;
+  Thread::threadFactoryForTest()
+      .createThread([&]() {
+        SliceStoragePool::release(SliceStoragePool::allocate());
+        SliceStoragePool::releaseFreeMemory();
+        other_thread_cache_size = SliceStoragePool::threadCacheSize();
+      })
+      ->join();
+
+  EXPECT_EQ(0, other_thread_cache_size);
+  EXPECT_EQ(0, SliceStoragePool::globalPoolBytes());
+  // This thread's cache is dropped the next time it uses the pool.
+  SliceStoragePool::release(SliceStoragePool::allocate());
+  EXPECT_EQ(1, SliceStoragePool::threadCacheSize());
+}
+
+TEST_F(SliceStoragePoolTest, ThreadsShareTheGlobalPool) {
+  Thread::threadFactoryForTest()
+      .createThread([&]() {
+        std::vector<SliceStoragePool::StoragePtr> storages;
+        for (uint32_t i = 0; i < SliceStoragePool::ThreadCacheMax + 1; ++i) {
+          storages.push_back(SliceStoragePool::allocate());
+        }
+        releaseAll(storages);
+      })
+      ->join();
+  EXPECT_EQ(SliceStoragePool::TransferBatch * SliceStoragePool::StorageSize,
+            SliceStoragePool::globalPoolBytes());
+
+  SliceStoragePool::StoragePtr storage = SliceStoragePool::allocate();
+  EXPECT_EQ((SliceStoragePool::TransferBatch - 1) * SliceStoragePool::StorageSize,
+            SliceStoragePool::globalPoolBytes() +
+                SliceStoragePool::threadCacheSize() * SliceStoragePool::StorageSize);
+  SliceStoragePool::release(std::move(storage));
+}
+
+TEST_F(SliceStoragePoolTest, DefaultSizedSlicesUseThePool) {
+  {
+    OwnedImpl buffer;
+    buffer.add(std::string(Slice::default_slice_size_, 'a'));
+    // Non-default sizes bypass the pool.
+    OwnedImpl small;
+    small.add(std::string(100, 'b'));
+  }
+  EXPECT_EQ(1, SliceStoragePool::threadCacheSize());
+
+  {
+    OwnedImpl buffer;
+    auto reservation = buffer.reserveForRead();
+    EXPECT_EQ(0, SliceStoragePool::threadCacheSize());
+    reservation.commit(1);
+  }
+  EXPECT_EQ(Reservation::MAX_SLICES_, SliceStoragePool::threadCacheSize());
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
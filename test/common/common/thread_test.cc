@@ -1,5 +1,9 @@
 #include <functional>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 #if defined(__linux__) || defined(__APPLE__)
 #include "source/common/common/posix/thread_impl.h"
 #endif
@@ -301,6 +305,36 @@ TEST(PosixThreadTest, InvalidThreadPriority) {
   EXPECT_NE(thread_priority, options.priority_);
 }
 
+#if defined(__linux__)
+TEST(PosixThreadTest, ThreadCpu) {
+  // Pin to the last CPU this process may run on, so the test also works under a restricted mask.
+  cpu_set_t allowed;
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+  Options options;
+  for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      options.cpu_ = cpu;
+    }
+  }
+  ASSERT_TRUE(options.cpu_.has_value());
+
+  auto thread_factory = PosixThreadFactory::create();
+  cpu_set_t thread_cpus;
+  int running_cpu = -1;
+  auto thread = thread_factory->createThread(
+      [&]() {
+        pthread_getaffinity_np(pthread_self(), sizeof(thread_cpus), &thread_cpus);
+        running_cpu = sched_getcpu();
+      },
+      options, /* crash_on_failure= */ false);
+  thread->join();
+
+  EXPECT_EQ(1, CPU_COUNT(&thread_cpus));
+  EXPECT_TRUE(CPU_ISSET(*options.cpu_, &thread_cpus));
+  EXPECT_EQ(static_cast<int>(*options.cpu_), running_cpu);
+}
+#endif
+
 class PosixThreadFactoryFailCreate : public PosixThreadFactory {
 protected:
   int createPthread(ThreadHandle*) override { return 1; }
@@ -0,0 +1,197 @@
+#include <chrono>
+#include <sstream>
+#include <vector>
+
+#include "envoy/event/scaled_timer.h"
+#include "envoy/event/timer.h"
+
+#include "source/common/event/dispatcher_impl.h"
+#include "source/common/event/timing_wheel_scheduler.h"
+
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+using testing::ElementsAre;
+
+class TimingWheelSchedulerTest : public testing::Test {
+protected:
+  TimingWheelSchedulerTest()
+      : api_(Api::createApiForTest(time_system_)),
+        dispatcher_(api_->allocateDispatcher("test_thread")) {
+    dispatcherImpl().enableTimingWheel(std::chrono::milliseconds(10));
+  }
+
+  DispatcherImpl& dispatcherImpl() { return static_cast<DispatcherImpl&>(*dispatcher_); }
+
+  void advance(std::chrono::milliseconds duration) {
+    time_system_.advanceTimeAndRun(duration, *dispatcher_, Dispatcher::RunType::NonBlock);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+};
+
+TEST_F(TimingWheelSchedulerTest, DeadlineIsRoundedUpToResolution) {
+  bool fired = false;
+  TimerPtr timer = dispatcher_->createTimer([&fired]() { fired = true; });
+  timer->enableTimer(std::chrono::milliseconds(25));
+  EXPECT_TRUE(timer->enabled());
+
+  advance(std::chrono::milliseconds(29));
+  EXPECT_FALSE(fired);
+  advance(std::chrono::milliseconds(1));
+  EXPECT_TRUE(fired);
+  EXPECT_FALSE(timer->enabled());
+}
+
+TEST_F(TimingWheelSchedulerTest, ZeroDelayRunsOnNextLoop) {
+  bool fired = false;
+  TimerPtr timer = dispatcher_->createTimer([&fired]() { fired = true; });
+  timer->enableTimer(std::chrono::milliseconds(0));
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+  EXPECT_TRUE(fired);
+}
+
+// Timers filed at every level of the wheel fire in deadline order.
+TEST_F(TimingWheelSchedulerTest, FiresInDeadlineOrder) {
+  std::vector<int> fired;
+  const std::vector<int> delays_ms = {3000, 20, 700000, 1, 90000000};
+  std::vector<TimerPtr> timers;
+  for (const int delay_ms : delays_ms) {
+    timers.push_back(dispatcher_->createTimer([&fired, delay_ms]() { fired.push_back(delay_ms); }));
+    timers.back()->enableTimer(std::chrono::milliseconds(delay_ms));
+  }
+
+  advance(std::chrono::milliseconds(700000));
+  EXPECT_THAT(fired, ElementsAre(1, 20, 3000, 700000));
+  advance(std::chrono::milliseconds(90000000 - 700000));
+  EXPECT_THAT(fired, ElementsAre(1, 20, 3000, 700000, 90000000));
+}
+
+TEST_F(TimingWheelSchedulerTest, DisableAndReEnable) {
+  int fired = 0;
+  TimerPtr timer = dispatcher_->createTimer([&fired]() { ++fired; });
+  timer->enableTimer(std::chrono::milliseconds(50));
+  timer->disableTimer();
+  EXPECT_FALSE(timer->enabled());
+  advance(std::chrono::milliseconds(100));
+  EXPECT_EQ(0, fired);
+
+  timer->enableTimer(std::chrono::milliseconds(50));
+  advance(std::chrono::milliseconds(20));
+  // Re-enabling moves the deadline.
+  timer->enableTimer(std::chrono::milliseconds(50));
+  advance(std::chrono::milliseconds(40));
+  EXPECT_EQ(0, fired);
+  advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(1, fired);
+}
+
+TEST_F(TimingWheelSchedulerTest, CallbackCanRearmAndDestroyTimers) {
+  int fired = 0;
+  TimerPtr other = dispatcher_->createTimer([]() { FAIL(); });
+  TimerPtr timer;
+  timer = dispatcher_->createTimer([&]() {
+    if (++fired == 1) {
+      other.reset();
+      timer->enableTimer(std::chrono::milliseconds(10));
+    }
+  });
+  timer->enableTimer(std::chrono::milliseconds(10));
+  other->enableTimer(std::chrono::milliseconds(10));
+
+  advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(1, fired);
+  EXPECT_TRUE(timer->enabled());
+  advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(2, fired);
+}
+
+// Deadlines beyond the 2^32 tick span of the wheel wait in the overflow list.
+TEST_F(TimingWheelSchedulerTest, DeadlineBeyondWheelSpan) {
+  const std::chrono::milliseconds span(uint64_t(10) << 32);
+  bool fired = false;
+  TimerPtr timer = dispatcher_->createTimer([&fired]() { fired = true; });
+  timer->enableTimer(span + span / 2);
+
+  advance(span);
+  EXPECT_FALSE(fired);
+  advance(span / 2 - std::chrono::milliseconds(10));
+  EXPECT_FALSE(fired);
+  advance(std::chrono::milliseconds(10));
+  EXPECT_TRUE(fired);
+}
+
+TEST_F(TimingWheelSchedulerTest, TimerIsScopeTracked) {
+  MessageTrackedObject tracked("tracked");
+  std::string dump;
+  TimerPtr timer = dispatcher_->createTimer([&]() {
+    std::ostringstream os;
+    dispatcherImpl().onFatalError(os);
+    dump = os.str();
+  });
+  timer->enableTimer(std::chrono::milliseconds(10), &tracked);
+  advance(std::chrono::milliseconds(10));
+  EXPECT_THAT(dump, testing::HasSubstr("tracked"));
+}
+
+// High resolution timers run on libevent, so their deadlines are not rounded up to a tick.
+TEST_F(TimingWheelSchedulerTest, HRTimersBypassTheWheel) {
+  bool fired = false;
+  TimerPtr timer = dispatcher_->createTimer([&fired]() { fired = true; });
+  timer->enableHRTimer(std::chrono::microseconds(2500));
+  EXPECT_TRUE(timer->enabled());
+
+  time_system_.advanceTimeAndRun(std::chrono::microseconds(2499), *dispatcher_,
+                                 Dispatcher::RunType::NonBlock);
+  EXPECT_FALSE(fired);
+  time_system_.advanceTimeAndRun(std::chrono::microseconds(1), *dispatcher_,
+                                 Dispatcher::RunType::NonBlock);
+  EXPECT_TRUE(fired);
+  EXPECT_FALSE(timer->enabled());
+
+  // Re-arming with a coarse deadline moves the timer back to the wheel, and disarms the libevent
+  // timer.
+  fired = false;
+  timer->enableHRTimer(std::chrono::microseconds(100));
+  timer->enableTimer(std::chrono::milliseconds(5));
+  advance(std::chrono::milliseconds(5));
+  EXPECT_FALSE(fired);
+  advance(std::chrono::milliseconds(5));
+  EXPECT_TRUE(fired);
+
+  fired = false;
+  timer->enableHRTimer(std::chrono::microseconds(100));
+  timer->disableTimer();
+  EXPECT_FALSE(timer->enabled());
+  advance(std::chrono::milliseconds(10));
+  EXPECT_FALSE(fired);
+}
+
+// Scaled timers are backed by wheel timers, so their deadlines are rounded up too.
+TEST_F(TimingWheelSchedulerTest, ScaledTimersUseTheWheel) {
+  bool fired = false;
+  TimerPtr timer = dispatcher_->createScaledTimer(
+      ScaledTimerMinimum(AbsoluteMinimum(std::chrono::milliseconds(0))),
+      [&fired]() { fired = true; });
+  timer->enableTimer(std::chrono::milliseconds(95));
+  // Let the minimum duration elapse, which arms the timer of the scaled timer queue.
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+
+  advance(std::chrono::milliseconds(95));
+  EXPECT_FALSE(fired);
+  advance(std::chrono::milliseconds(5));
+  EXPECT_TRUE(fired);
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,78 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <chrono>
+#include <vector>
+
+#include "source/common/event/dispatcher_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+
+class TimerPerf {
+public:
+  TimerPerf(bool use_timing_wheel, uint64_t num_timers)
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")) {
+    if (use_timing_wheel) {
+      static_cast<DispatcherImpl&>(*dispatcher_).enableTimingWheel(std::chrono::milliseconds(10));
+    }
+    timers_.reserve(num_timers);
+    for (uint64_t i = 0; i < num_timers; ++i) {
+      timers_.push_back(dispatcher_->createTimer([]() {}));
+    }
+  }
+
+  // Coarse timeouts, spread over a minute like connection idle timeouts are.
+  static std::chrono::milliseconds timeout(uint64_t i) {
+    return std::chrono::milliseconds(1000 + (i * 7919) % 59000);
+  }
+
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+  std::vector<TimerPtr> timers_;
+};
+
+// Arms every timer, then cancels every timer.
+static void timerArmAndCancel(benchmark::State& state) {
+  TimerPerf perf(state.range(0) != 0, state.range(1));
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    for (uint64_t i = 0; i < perf.timers_.size(); ++i) {
+      perf.timers_[i]->enableTimer(TimerPerf::timeout(i));
+    }
+    for (TimerPtr& timer : perf.timers_) {
+      timer->disableTimer();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * perf.timers_.size());
+}
+BENCHMARK(timerArmAndCancel)
+    ->ArgNames({"wheel", "timers"})
+    ->ArgsProduct({{0, 1}, {1000, 100000, 1000000}})
+    ->Unit(benchmark::kMillisecond);
+
+// Re-arms armed timers, as connections do with their idle timeout on every read.
+static void timerRearm(benchmark::State& state) {
+  TimerPerf perf(state.range(0) != 0, state.range(1));
+  for (uint64_t i = 0; i < perf.timers_.size(); ++i) {
+    perf.timers_[i]->enableTimer(TimerPerf::timeout(i));
+  }
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    for (uint64_t i = 0; i < perf.timers_.size(); ++i) {
+      perf.timers_[i]->enableTimer(TimerPerf::timeout(i + 1));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * perf.timers_.size());
+}
+BENCHMARK(timerRearm)
+    ->ArgNames({"wheel", "timers"})
+    ->ArgsProduct({{0, 1}, {1000, 100000, 1000000}})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace Event
+} // namespace Envoy
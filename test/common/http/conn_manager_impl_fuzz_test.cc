@@ -240,6 +240,8 @@ public:
   const HttpConnectionManagerProto::ProxyStatusConfig* proxyStatusConfig() const override {
     return proxy_status_config_.get();
   }
+  const Http::FilterLatencyConfig* filterLatencyConfig() const override { return nullptr; }
+  uint32_t streamArenaInitialBlockSize() const override { return 0; }
   Http::ServerHeaderValidatorPtr makeHeaderValidator(Protocol) override {
     // TODO(yanavlasov): fuzz test interface should use the default validator, although this could
     // be changed too
@@ -1740,6 +1740,23 @@ TEST_F(HttpConnectionManagerImplTest, AlterFilterWatermarkLimits) {
   doRemoteClose();
 }
 
+TEST_F(HttpConnectionManagerImplTest, NoStreamArenaByDefault) {
+  setup();
+  setUpEncoderAndDecoder(false, false);
+  sendRequestHeadersAndData();
+  EXPECT_EQ(nullptr, decoder_->streamArena());
+  doRemoteClose();
+}
+
+TEST_F(HttpConnectionManagerImplTest, StreamArena) {
+  stream_arena_initial_block_size_ = 1024;
+  setup();
+  setUpEncoderAndDecoder(false, false);
+  sendRequestHeadersAndData();
+  EXPECT_NE(nullptr, decoder_->streamArena());
+  doRemoteClose();
+}
+
 TEST_F(HttpConnectionManagerImplTest, HitFilterWatermarkLimits) {
   log_handler_ = std::make_shared<NiceMock<AccessLog::MockInstance>>();
 
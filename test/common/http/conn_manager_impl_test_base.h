@@ -239,6 +239,10 @@ public:
   const HttpConnectionManagerProto::ProxyStatusConfig* proxyStatusConfig() const override {
     return proxy_status_config_.get();
   }
+  const FilterLatencyConfig* filterLatencyConfig() const override {
+    return filter_latency_config_.get();
+  }
+  uint32_t streamArenaInitialBlockSize() const override { return stream_arena_initial_block_size_; }
   ServerHeaderValidatorPtr makeHeaderValidator(Protocol protocol) override {
     return header_validator_factory_.createServerHeaderValidator(protocol, header_validator_stats_);
   }
@@ -379,6 +383,8 @@ public:
               KEEP_UNCHANGED};
   bool strip_trailing_host_dot_ = false;
   std::unique_ptr<HttpConnectionManagerProto::ProxyStatusConfig> proxy_status_config_;
+  FilterLatencyConfigPtr filter_latency_config_;
+  uint32_t stream_arena_initial_block_size_ = 0;
   NiceMock<MockHeaderValidatorFactory> header_validator_factory_;
   NiceMock<MockHeaderValidatorStats> header_validator_stats_;
   envoy::extensions::http::header_validators::envoy_default::v3::HeaderValidatorConfig
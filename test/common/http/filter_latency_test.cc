@@ -0,0 +1,102 @@
+#include "envoy/type/v3/percent.pb.h"
+
+#include "source/common/http/filter_latency.h"
+
+#include "test/common/stats/stat_test_utility.h"
+#include "test/mocks/common.h"
+#include "test/mocks/stream_info/mocks.h"
+
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+MonotonicTime atMs(int64_t ms) { return MonotonicTime(std::chrono::milliseconds(ms)); }
+
+class FilterLatencyTest : public testing::Test {
+public:
+  FilterLatencyConfig makeConfig(uint32_t numerator) {
+    envoy::type::v3::FractionalPercent sampling;
+    sampling.set_numerator(numerator);
+    sampling.set_denominator(envoy::type::v3::FractionalPercent::HUNDRED);
+    return {sampling, {"a", "b"}, "http.test.", *store_.rootScope()};
+  }
+
+  Stats::TestUtil::TestStore store_;
+  NiceMock<MockTimeSystem> time_system_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+};
+
+TEST_F(FilterLatencyTest, SampleStream) {
+  NiceMock<Random::MockRandomGenerator> random;
+  EXPECT_CALL(random, random()).WillRepeatedly(Return(149));
+
+  EXPECT_FALSE(makeConfig(0).sampleStream(random));
+  EXPECT_FALSE(makeConfig(49).sampleStream(random));
+  EXPECT_TRUE(makeConfig(50).sampleStream(random));
+  EXPECT_TRUE(makeConfig(100).sampleStream(random));
+}
+
+TEST_F(FilterLatencyTest, SequentialCallbacksAccumulate) {
+  const FilterLatencyConfig config = makeConfig(100);
+  FilterLatencyTracker tracker(config, time_system_);
+
+  EXPECT_CALL(time_system_, monotonicTime())
+      .WillOnce(Return(atMs(0)))
+      .WillOnce(Return(atMs(2)))
+      .WillOnce(Return(atMs(10)))
+      .WillOnce(Return(atMs(13)));
+  auto timing = tracker.onCallbackStart();
+  tracker.onCallbackEnd("a", FilterLatencyCallback::DecodeData, timing);
+  timing = tracker.onCallbackStart();
+  tracker.onCallbackEnd("a", FilterLatencyCallback::DecodeData, timing);
+
+  tracker.finalize(stream_info_);
+  EXPECT_EQ(std::vector<uint64_t>{5000},
+            store_.histogramValues("http.test.filter_latency.a.decode_data_us", false));
+  EXPECT_FALSE(store_.findHistogramByString("http.test.filter_latency.a.decode_headers_us"));
+}
+
+TEST_F(FilterLatencyTest, NestedCallbacksAreAttributedToTheInnerFilter) {
+  const FilterLatencyConfig config = makeConfig(100);
+  FilterLatencyTracker tracker(config, time_system_);
+
+  // Filter "a" runs from 0 to 10ms, and while it does filter "b" runs from 2 to 5ms and an
+  // unknown filter from 6 to 7ms.
+  EXPECT_CALL(time_system_, monotonicTime())
+      .WillOnce(Return(atMs(0)))
+      .WillOnce(Return(atMs(2)))
+      .WillOnce(Return(atMs(5)))
+      .WillOnce(Return(atMs(6)))
+      .WillOnce(Return(atMs(7)))
+      .WillOnce(Return(atMs(10)));
+  const auto outer = tracker.onCallbackStart();
+  auto inner = tracker.onCallbackStart();
+  tracker.onCallbackEnd("b", FilterLatencyCallback::EncodeHeaders, inner);
+  inner = tracker.onCallbackStart();
+  tracker.onCallbackEnd("unknown", FilterLatencyCallback::EncodeHeaders, inner);
+  tracker.onCallbackEnd("a", FilterLatencyCallback::DecodeHeaders, outer);
+
+  tracker.finalize(stream_info_);
+  EXPECT_EQ(std::vector<uint64_t>{6000},
+            store_.histogramValues("http.test.filter_latency.a.decode_headers_us", false));
+  EXPECT_EQ(std::vector<uint64_t>{3000},
+            store_.histogramValues("http.test.filter_latency.b.encode_headers_us", false));
+  EXPECT_EQ(std::vector<uint64_t>{1000},
+            store_.histogramValues("http.test.filter_latency.other.encode_headers_us", false));
+
+  const auto* state = stream_info_.filterState()->getDataReadOnly<FilterLatencyFilterState>(
+      FilterLatencyFilterState::key());
+  ASSERT_NE(nullptr, state);
+  EXPECT_EQ("b:3000,unknown:1000,a:6000", state->serializeAsString().value());
+  EXPECT_EQ(int64_t(6000), absl::get<int64_t>(state->getField("a")));
+  EXPECT_TRUE(absl::holds_alternative<absl::monostate>(state->getField("c")));
+}
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
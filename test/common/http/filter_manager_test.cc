@@ -13,6 +13,7 @@
 #include "source/common/stream_info/filter_state_impl.h"
 #include "source/common/stream_info/stream_info_impl.h"
 
+#include "test/common/stats/stat_test_utility.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/local_reply/mocks.h"
@@ -980,6 +981,75 @@ TEST_F(FilterManagerTest, AllDecodeOperationsBlockedAfterDownstreamReset) {
   filter_manager_->destroyFilters();
 }
 
+TEST_F(FilterManagerTest, FilterLatencyTracking) {
+  initialize();
+
+  Stats::TestUtil::TestStore store;
+  envoy::type::v3::FractionalPercent sampling;
+  sampling.set_numerator(100);
+  const FilterLatencyConfig config(sampling, {"first", "second"}, "http.test.",
+                                   *store.rootScope());
+  filter_manager_->enableFilterLatencyTracking(config);
+
+  auto first = std::make_shared<NiceMock<MockStreamDecoderFilter>>();
+  auto second = std::make_shared<NiceMock<MockStreamDecoderFilter>>();
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> bool {
+        callbacks.setFilterConfigName("first");
+        createDecoderFilterFactoryCb(first)(callbacks);
+        callbacks.setFilterConfigName("second");
+        createDecoderFilterFactoryCb(second)(callbacks);
+        return true;
+      }));
+  filter_manager_->createDownstreamFilterChain();
+
+  RequestHeaderMapPtr headers{
+      new TestRequestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+  ON_CALL(filter_manager_callbacks_, requestHeaders()).WillByDefault(Return(makeOptRef(*headers)));
+  filter_manager_->requestHeadersInitialized();
+  filter_manager_->decodeHeaders(*headers, true);
+
+  filter_manager_->onStreamComplete();
+  EXPECT_TRUE(store.histogramRecordedValues("http.test.filter_latency.first.decode_headers_us"));
+  EXPECT_TRUE(store.histogramRecordedValues("http.test.filter_latency.second.decode_headers_us"));
+  EXPECT_FALSE(store.findHistogramByString("http.test.filter_latency.first.decode_data_us"));
+
+  const auto* state =
+      filter_manager_->streamInfo().filterState()->getDataReadOnly<FilterLatencyFilterState>(
+          FilterLatencyFilterState::key());
+  ASSERT_NE(nullptr, state);
+  ASSERT_EQ(2, state->entries().size());
+  EXPECT_EQ("first", state->entries()[0].first);
+  EXPECT_EQ("second", state->entries()[1].first);
+
+  filter_manager_->destroyFilters();
+}
+
+TEST_F(FilterManagerTest, FilterLatencyNotTrackedByDefault) {
+  initialize();
+
+  auto filter = std::make_shared<NiceMock<MockStreamDecoderFilter>>();
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> bool {
+        callbacks.setFilterConfigName("filter");
+        createDecoderFilterFactoryCb(filter)(callbacks);
+        return true;
+      }));
+  filter_manager_->createDownstreamFilterChain();
+
+  RequestHeaderMapPtr headers{
+      new TestRequestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+  ON_CALL(filter_manager_callbacks_, requestHeaders()).WillByDefault(Return(makeOptRef(*headers)));
+  filter_manager_->requestHeadersInitialized();
+  filter_manager_->decodeHeaders(*headers, true);
+
+  filter_manager_->onStreamComplete();
+  EXPECT_FALSE(filter_manager_->streamInfo().filterState()->hasDataWithName(
+      FilterLatencyFilterState::key()));
+
+  filter_manager_->destroyFilters();
+}
+
 } // namespace
 } // namespace Http
 } // namespace Envoy
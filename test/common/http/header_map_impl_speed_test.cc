@@ -1,3 +1,5 @@
+#include <memory_resource>
+
 #include "source/common/http/header_map_impl.h"
 #include "source/common/http/headers.h"
 
@@ -362,5 +364,54 @@ BENCHMARK(bmHeaderMapImplResponseStaticLookupHits);
 BENCHMARK(bmHeaderMapImplRequestStaticLookupMisses);
 BENCHMARK(bmHeaderMapImplResponseStaticLookupMisses);
 
+// Forwards to the heap, counting the allocations.
+class CountingMemoryResource : public std::pmr::memory_resource {
+public:
+  uint64_t allocations_{};
+
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    ++allocations_;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+/**
+ * Measure the cost of decoding the headers and trailers of a typical request, and count the
+ * header entry allocations that reach the heap per request. With Arg(0) every entry is allocated
+ * separately; otherwise the entries come from a stream arena whose first block has Arg bytes.
+ */
+static void headerMapImplStreamArena(benchmark::State& state) {
+  const uint32_t initial_block_size = state.range(0);
+  auto counting = std::make_shared<CountingMemoryResource>();
+  for (auto _ : state) { // NOLINT
+    StreamArenaSharedPtr arena =
+        initial_block_size == 0
+            ? StreamArenaSharedPtr(counting)
+            : std::make_shared<std::pmr::monotonic_buffer_resource>(initial_block_size,
+                                                                     counting.get());
+    auto headers = RequestHeaderMapImpl::create(UINT32_MAX, UINT32_MAX, arena);
+    headers->setReferenceKey(Headers::get().Method, "GET");
+    headers->setReferenceKey(Headers::get().Path, "/some/path?with=query");
+    headers->setReferenceKey(Headers::get().Scheme, "https");
+    headers->setReferenceKey(Headers::get().Host, "www.example.com");
+    headers->setReferenceKey(Headers::get().UserAgent, "benchmark/1.0");
+    headers->setReferenceKey(Headers::get().ContentType, "application/json");
+    addDummyHeaders(*headers, 6);
+    auto trailers = RequestTrailerMapImpl::create(UINT32_MAX, UINT32_MAX, std::move(arena));
+    addDummyHeaders(*trailers, 2);
+    benchmark::DoNotOptimize(headers->size() + trailers->size());
+  }
+  state.counters["allocs_per_request"] =
+      benchmark::Counter(counting->allocations_, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(headerMapImplStreamArena)->Arg(0)->Arg(1024)->Arg(4096);
+
 } // namespace Http
 } // namespace Envoy
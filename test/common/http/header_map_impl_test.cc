@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <memory>
+#include <memory_resource>
 #include <string>
 
 #include "source/common/http/header_list_view.h"
@@ -1087,5 +1088,53 @@ TEST(HeaderMapImplTest, HeaderMapMaxLimits) {
   EXPECT_EQ(response_trailer->maxHeadersCount(), 3);
 }
 
+TEST(HeaderMapImplTest, StreamArena) {
+  // Counts the allocations made by the arena, and fails if any is freed before the arena is.
+  class TestArena : public std::pmr::memory_resource {
+  public:
+    ~TestArena() override { EXPECT_EQ(0, live_); }
+
+    uint64_t allocations_{};
+    uint64_t live_{};
+
+  private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+      ++allocations_;
+      ++live_;
+      return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+      --live_;
+      std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+  };
+
+  auto arena = std::make_shared<TestArena>();
+  TestArena* arena_ptr = arena.get();
+  RequestHeaderMapSharedPtr headers = RequestHeaderMapImpl::create(UINT32_MAX, UINT32_MAX, arena);
+  headers->setPath("/");
+  headers->addCopy(LowerCaseString("foo"), "bar");
+  headers->addCopy(LowerCaseString("baz"), "qux");
+  EXPECT_EQ(3, arena_ptr->allocations_);
+  EXPECT_EQ(3, arena_ptr->live_);
+
+  headers->remove(LowerCaseString("foo"));
+  EXPECT_EQ(2, arena_ptr->live_);
+  EXPECT_EQ("qux", headers->get(LowerCaseString("baz"))[0]->value().getStringView());
+
+  // Copies are not allocated from the arena of the source map.
+  auto copy = createHeaderMap<RequestHeaderMapImpl>(*headers);
+  EXPECT_EQ(*headers, *copy);
+  EXPECT_EQ(3, arena_ptr->allocations_);
+
+  // The header map keeps the arena alive after the stream releases it.
+  arena.reset();
+  EXPECT_EQ("/", headers->getPathValue());
+  headers.reset();
+}
+
 } // namespace Http
 } // namespace Envoy
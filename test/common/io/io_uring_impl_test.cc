@@ -1,3 +1,5 @@
+#include <sys/socket.h>
+
 #include <functional>
 
 #include "source/common/io/io_uring_impl.h"
@@ -89,6 +91,22 @@ INSTANTIATE_TEST_SUITE_P(
         [](IoUring& uring, os_fd_t fd) -> IoUringResult { return uring.prepareClose(fd, nullptr); },
         [](IoUring& uring, os_fd_t fd) -> IoUringResult {
           return uring.prepareShutdown(fd, 0, nullptr);
+        },
+        [](IoUring& uring, os_fd_t fd) -> IoUringResult {
+          return uring.prepareOpenat(fd, "file", O_RDONLY, 0, nullptr);
+        },
+        [](IoUring& uring, os_fd_t fd) -> IoUringResult {
+          static struct statx statx_buf;
+          return uring.prepareStatx(fd, "", AT_EMPTY_PATH, STATX_BASIC_STATS, &statx_buf, nullptr);
+        },
+        [](IoUring& uring, os_fd_t fd) -> IoUringResult {
+          return uring.prepareUnlinkat(fd, "file", 0, nullptr);
+        },
+        [](IoUring& uring, os_fd_t fd) -> IoUringResult {
+          return uring.prepareLinkat(fd, "file", fd, "link", 0, nullptr);
+        },
+        [](IoUring& uring, os_fd_t fd) -> IoUringResult {
+          return uring.prepareFtruncate(fd, 0, nullptr);
         }));
 
 TEST_P(IoUringImplParamTest, InvalidParams) {
@@ -102,7 +120,7 @@ TEST_P(IoUringImplParamTest, InvalidParams) {
   auto file_event = dispatcher->createFileEvent(
       event_fd,
       [this, &completions_nr](uint32_t) {
-        io_uring_->forEveryCompletion([&completions_nr](Request*, int32_t res, bool) {
+        io_uring_->forEveryCompletion([&completions_nr](Request*, int32_t res, uint32_t, bool) {
           EXPECT_TRUE(res < 0);
           completions_nr++;
         });
@@ -139,7 +157,7 @@ TEST_F(IoUringImplTest, InjectCompletion) {
       event_fd,
       [this, &completions_nr](uint32_t) {
         io_uring_->forEveryCompletion(
-            [&completions_nr](Request* user_data, int32_t res, bool injected) {
+            [&completions_nr](Request* user_data, int32_t res, uint32_t, bool injected) {
               EXPECT_TRUE(injected);
               EXPECT_EQ(1, dynamic_cast<TestRequest*>(user_data)->data_);
               EXPECT_EQ(-11, res);
@@ -173,7 +191,8 @@ TEST_F(IoUringImplTest, NestInjectCompletion) {
       event_fd,
       [this, &fd2, &completions_nr, &request2](uint32_t) {
         io_uring_->forEveryCompletion([this, &fd2, &completions_nr,
-                                       &request2](Request* user_data, int32_t res, bool injected) {
+                                       &request2](Request* user_data, int32_t res, uint32_t,
+                                                  bool injected) {
           EXPECT_TRUE(injected);
           if (completions_nr == 0) {
             EXPECT_EQ(1, dynamic_cast<TestRequest*>(user_data)->data_);
@@ -214,7 +233,7 @@ TEST_F(IoUringImplTest, RemoveInjectCompletion) {
       event_fd,
       [this, &completions_nr](uint32_t) {
         io_uring_->forEveryCompletion(
-            [&completions_nr](Request* user_data, int32_t res, bool injected) {
+            [&completions_nr](Request* user_data, int32_t res, uint32_t, bool injected) {
               EXPECT_TRUE(injected);
               EXPECT_EQ(1, dynamic_cast<TestRequest*>(user_data)->data_);
               EXPECT_EQ(-11, res);
@@ -250,7 +269,8 @@ TEST_F(IoUringImplTest, NestRemoveInjectCompletion) {
       event_fd,
       [this, &fd2, &completions_nr, &data2](uint32_t) {
         io_uring_->forEveryCompletion(
-            [this, &fd2, &completions_nr, &data2](Request* user_data, int32_t res, bool injected) {
+            [this, &fd2, &completions_nr, &data2](Request* user_data, int32_t res, uint32_t,
+                                                  bool injected) {
               EXPECT_TRUE(injected);
               if (completions_nr == 0) {
                 EXPECT_EQ(1, dynamic_cast<TestRequest*>(user_data)->data_);
@@ -305,7 +325,7 @@ TEST_F(IoUringImplTest, PrepareReadvAllDataFitsOneChunk) {
   auto file_event = dispatcher->createFileEvent(
       event_fd,
       [this, &completions_nr, d = dispatcher.get()](uint32_t) {
-        io_uring_->forEveryCompletion([&completions_nr](Request*, int32_t res, bool) {
+        io_uring_->forEveryCompletion([&completions_nr](Request*, int32_t res, uint32_t, bool) {
           completions_nr++;
           EXPECT_EQ(res, strlen("test text"));
         });
@@ -351,7 +371,8 @@ TEST_F(IoUringImplTest, PrepareReadvQueueOverflow) {
   auto file_event = dispatcher->createFileEvent(
       event_fd,
       [this, &completions_nr](uint32_t) {
-        io_uring_->forEveryCompletion([&completions_nr](Request* user_data, int32_t res, bool) {
+        io_uring_->forEveryCompletion([&completions_nr](Request* user_data, int32_t res, uint32_t,
+                                                        bool) {
           EXPECT_TRUE(user_data != nullptr);
           EXPECT_EQ(res, 2);
           completions_nr++;
@@ -404,6 +425,55 @@ TEST_F(IoUringImplTest, PrepareReadvQueueOverflow) {
   EXPECT_EQ(static_cast<char*>(iov3.iov_base)[1], 'f');
 }
 
+TEST_F(IoUringImplTest, RecvMultishotWithProvidedBuffers) {
+  if (io_uring_->registerProvidedBuffers(4, 16) != IoUringResult::Ok) {
+    GTEST_SKIP() << "multishot recv is not supported on this kernel";
+  }
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+  auto dispatcher = api_->allocateDispatcher("test_thread");
+  os_fd_t event_fd = io_uring_->registerEventfd();
+  const Event::FileTriggerType trigger = Event::PlatformDefaultTriggerType;
+  std::string received;
+  uint32_t last_flags = 0;
+  auto file_event = dispatcher->createFileEvent(
+      event_fd,
+      [this, &received, &last_flags](uint32_t) {
+        io_uring_->forEveryCompletion(
+            [this, &received, &last_flags](Request*, int32_t res, uint32_t flags, bool) {
+              last_flags = flags;
+              if (res > 0) {
+                ASSERT_TRUE(flags & IORING_CQE_F_BUFFER);
+                const uint16_t buffer_id = flags >> IORING_CQE_BUFFER_SHIFT;
+                received.append(reinterpret_cast<char*>(io_uring_->providedBuffer(buffer_id)),
+                                res);
+                io_uring_->recycleProvidedBuffer(buffer_id);
+              }
+            });
+        return absl::OkStatus();
+      },
+      trigger, Event::FileReadyType::Read);
+
+  int data = 1;
+  TestRequest request(data);
+  EXPECT_EQ(IoUringResult::Ok, io_uring_->prepareRecvMultishot(fds[0], &request));
+  EXPECT_EQ(IoUringResult::Ok, io_uring_->submit());
+
+  // The single recv request completes for every write, each time into a provided buffer.
+  ASSERT_EQ(5, ::write(fds[1], "hello", 5));
+  waitForCondition(*dispatcher, [&received]() { return received == "hello"; });
+  EXPECT_TRUE(last_flags & IORING_CQE_F_MORE);
+  ASSERT_EQ(6, ::write(fds[1], " world", 6));
+  waitForCondition(*dispatcher, [&received]() { return received == "hello world"; });
+  EXPECT_TRUE(last_flags & IORING_CQE_F_MORE);
+
+  // The remote close ends the request.
+  ::close(fds[1]);
+  waitForCondition(*dispatcher, [&last_flags]() { return !(last_flags & IORING_CQE_F_MORE); });
+  ::close(fds[0]);
+}
+
 } // namespace
 } // namespace Io
 } // namespace Envoy
@@ -9,6 +9,7 @@
 
 #include "gtest/gtest.h"
 
+using testing::AnyNumber;
 using testing::DoAll;
 using testing::Invoke;
 using testing::NiceMock;
@@ -33,8 +34,10 @@ public:
 
 class IoUringWorkerTestImpl : public IoUringWorkerImpl {
 public:
-  IoUringWorkerTestImpl(IoUringPtr io_uring_instance, Event::Dispatcher& dispatcher)
-      : IoUringWorkerImpl(std::move(io_uring_instance), 8192, 1000, dispatcher) {}
+  IoUringWorkerTestImpl(IoUringPtr io_uring_instance, Event::Dispatcher& dispatcher,
+                        uint32_t read_buffer_ring_size = 0)
+      : IoUringWorkerImpl(std::move(io_uring_instance), 8192, 1000, dispatcher,
+                          read_buffer_ring_size) {}
 
   IoUringSocket& addTestSocket(os_fd_t fd) {
     return addSocket(std::make_unique<IoUringSocketTestImpl>(fd, *this));
@@ -218,7 +221,7 @@ TEST(IoUringWorkerImplTest, ServerSocketInjectAfterWrite) {
   EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
       .WillOnce(Invoke([&io_uring_socket](const CompletionCb& cb) {
         auto* req = new Request(Request::RequestType::Write, io_uring_socket);
-        cb(req, -EAGAIN, true);
+        cb(req, -EAGAIN, 0, true);
       }));
   EXPECT_CALL(mock_io_uring, submit()).Times(1).RetiresOnSaturation();
   ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
@@ -244,9 +247,9 @@ TEST(IoUringWorkerImplTest, ServerSocketInjectAfterWrite) {
   // Finish the read, cancel and write request, then expect the close request submitted.
   EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
       .WillOnce(Invoke([&read_req, &cancel_req, &write_req](const CompletionCb& cb) {
-        cb(read_req, -EAGAIN, false);
-        cb(cancel_req, 0, false);
-        cb(write_req, -EAGAIN, false);
+        cb(read_req, -EAGAIN, 0, false);
+        cb(cancel_req, 0, 0, false);
+        cb(write_req, -EAGAIN, 0, false);
       }));
   Request* close_req = nullptr;
   EXPECT_CALL(mock_io_uring, prepareClose(_, _))
@@ -257,7 +260,7 @@ TEST(IoUringWorkerImplTest, ServerSocketInjectAfterWrite) {
 
   // After the close request finished, the socket will be cleanup.
   EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
-      .WillOnce(Invoke([&close_req](const CompletionCb& cb) { cb(close_req, 0, false); }));
+      .WillOnce(Invoke([&close_req](const CompletionCb& cb) { cb(close_req, 0, 0, false); }));
   EXPECT_CALL(mock_io_uring, removeInjectedCompletion(fd));
   EXPECT_CALL(dispatcher, deferredDelete_);
   EXPECT_CALL(dispatcher, clearDeferredDeleteList());
@@ -296,7 +299,7 @@ TEST(IoUringWorkerImplTest, ServerSocketInjectAfterRead) {
   EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
       .WillOnce(Invoke([&io_uring_socket](const CompletionCb& cb) {
         auto* req = new Request(Request::RequestType::Write, io_uring_socket);
-        cb(req, -EAGAIN, true);
+        cb(req, -EAGAIN, 0, true);
       }));
   EXPECT_CALL(mock_io_uring, submit()).Times(1).RetiresOnSaturation();
   ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
@@ -313,8 +316,8 @@ TEST(IoUringWorkerImplTest, ServerSocketInjectAfterRead) {
   // Finish the read and cancel request, then expect the close request submitted.
   EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
       .WillOnce(Invoke([&read_req, &cancel_req](const CompletionCb& cb) {
-        cb(read_req, -EAGAIN, false);
-        cb(cancel_req, 0, false);
+        cb(read_req, -EAGAIN, 0, false);
+        cb(cancel_req, 0, 0, false);
       }));
   Request* close_req = nullptr;
   EXPECT_CALL(mock_io_uring, prepareClose(_, _))
@@ -325,7 +328,7 @@ TEST(IoUringWorkerImplTest, ServerSocketInjectAfterRead) {
 
   // After the close request finished, the socket will be cleanup.
   EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
-      .WillOnce(Invoke([&close_req](const CompletionCb& cb) { cb(close_req, 0, false); }));
+      .WillOnce(Invoke([&close_req](const CompletionCb& cb) { cb(close_req, 0, 0, false); }));
   EXPECT_CALL(mock_io_uring, removeInjectedCompletion(fd));
   EXPECT_CALL(dispatcher, deferredDelete_);
   EXPECT_CALL(dispatcher, clearDeferredDeleteList());
@@ -380,13 +383,13 @@ TEST(IoUringWorkerImplTest, CloseAllSocketsWhenDestruction) {
         EXPECT_CALL(mock_io_uring, removeInjectedCompletion(fd));
 
         // Fake the read request cancel completion.
-        cb(read_req, -ECANCELED, false);
+        cb(read_req, -ECANCELED, 0, false);
 
         // Fake the cancel request is done.
-        cb(cancel_req, 0, false);
+        cb(cancel_req, 0, 0, false);
 
         // Fake the close request is done.
-        cb(close_req, 0, false);
+        cb(close_req, 0, 0, false);
       }));
 
   EXPECT_CALL(dispatcher, deferredDelete_);
@@ -422,7 +425,7 @@ TEST(IoUringWorkerImplTest, ServerCloseWithWriteRequestOnly) {
   io_uring_socket.disableRead();
   // Fake the read request finish.
   EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
-      .WillOnce(Invoke([&read_req](const CompletionCb& cb) { cb(read_req, -EAGAIN, false); }));
+      .WillOnce(Invoke([&read_req](const CompletionCb& cb) { cb(read_req, -EAGAIN, 0, false); }));
   EXPECT_CALL(mock_io_uring, submit()).Times(1).RetiresOnSaturation();
   ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
 
@@ -448,13 +451,13 @@ TEST(IoUringWorkerImplTest, ServerCloseWithWriteRequestOnly) {
             .RetiresOnSaturation();
         EXPECT_CALL(mock_io_uring, submit()).Times(1).RetiresOnSaturation();
 
-        cb(write_req, -EAGAIN, false);
+        cb(write_req, -EAGAIN, 0, false);
       }));
   ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
 
   // After the close request finished, the socket will be cleanup.
   EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
-      .WillOnce(Invoke([&close_req](const CompletionCb& cb) { cb(close_req, 0, false); }));
+      .WillOnce(Invoke([&close_req](const CompletionCb& cb) { cb(close_req, 0, 0, false); }));
   EXPECT_CALL(mock_io_uring, removeInjectedCompletion(fd));
   EXPECT_CALL(dispatcher, deferredDelete_);
   EXPECT_CALL(dispatcher, clearDeferredDeleteList());
@@ -693,6 +696,399 @@ TEST(IoUringWorkerImplTest, NoEnableReadOnConnectError) {
   delete static_cast<Request*>(connect_req);
 }
 
+// Expects the socket of fd to be closed when the worker is destroyed, and its pending request to
+// be canceled.
+void expectCloseOnDestruction(MockIoUring& mock_io_uring, Event::MockDispatcher& dispatcher,
+                              os_fd_t fd, Request*& pending_req) {
+  Request* cancel_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareCancel(pending_req, _))
+      .WillOnce(DoAll(SaveArg<1>(&cancel_req), Return<IoUringResult>(IoUringResult::Ok)));
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(Invoke([&mock_io_uring, fd, &pending_req, &cancel_req](const CompletionCb& cb) {
+        Request* close_req = nullptr;
+        EXPECT_CALL(mock_io_uring, prepareClose(fd, _))
+            .WillOnce(DoAll(SaveArg<1>(&close_req), Return<IoUringResult>(IoUringResult::Ok)));
+        EXPECT_CALL(mock_io_uring, removeInjectedCompletion(fd));
+        cb(pending_req, -ECANCELED, 0, false);
+        cb(cancel_req, 0, 0, false);
+        cb(close_req, 0, 0, false);
+      }))
+      .RetiresOnSaturation();
+  EXPECT_CALL(dispatcher, deferredDelete_);
+  EXPECT_CALL(dispatcher, clearDeferredDeleteList());
+}
+
+TEST(IoUringWorkerImplTest, MultishotReadWithProvidedBuffers) {
+  Event::MockDispatcher dispatcher;
+  IoUringPtr io_uring_instance = std::make_unique<MockIoUring>();
+  MockIoUring& mock_io_uring = *dynamic_cast<MockIoUring*>(io_uring_instance.get());
+  Event::FileReadyCb file_event_callback;
+
+  EXPECT_CALL(mock_io_uring, registerProvidedBuffers(16, 8192))
+      .WillOnce(Return<IoUringResult>(IoUringResult::Ok));
+  EXPECT_CALL(mock_io_uring, registerEventfd());
+  EXPECT_CALL(mock_io_uring, submit()).Times(AnyNumber());
+  EXPECT_CALL(dispatcher,
+              createFileEvent_(_, _, Event::PlatformDefaultTriggerType, Event::FileReadyType::Read))
+      .WillOnce(
+          DoAll(SaveArg<1>(&file_event_callback), ReturnNew<NiceMock<Event::MockFileEvent>>()));
+  auto worker = std::make_unique<IoUringWorkerTestImpl>(std::move(io_uring_instance), dispatcher,
+                                                        16);
+  EXPECT_TRUE(worker->hasProvidedBuffers());
+
+  os_fd_t fd = 11;
+  Request* read_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareRecvMultishot(fd, _))
+      .WillOnce(DoAll(SaveArg<1>(&read_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  IoUringSocket* io_uring_socket = nullptr;
+  std::string received;
+  io_uring_socket = &worker->addServerSocket(
+      fd,
+      [&io_uring_socket, &received](uint32_t events) {
+        EXPECT_EQ(Event::FileReadyType::Read, events);
+        Buffer::Instance& buf = io_uring_socket->getReadParam()->buf_;
+        received += buf.toString();
+        buf.drain(buf.length());
+        return absl::OkStatus();
+      },
+      false);
+
+  // The data of each completion is copied out of its provided buffer, which is recycled right
+  // after, while the read stays armed.
+  uint8_t provided_buf[8192];
+  memcpy(provided_buf, "hello", 5); // NOLINT(safe-memcpy)
+  EXPECT_CALL(mock_io_uring, providedBuffer(3)).Times(2).WillRepeatedly(Return(provided_buf));
+  EXPECT_CALL(mock_io_uring, recycleProvidedBuffer(3)).Times(2);
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(Invoke([&read_req](const CompletionCb& cb) {
+        const uint32_t flags =
+            IORING_CQE_F_MORE | IORING_CQE_F_BUFFER | (3 << IORING_CQE_BUFFER_SHIFT);
+        cb(read_req, 5, flags, false);
+        cb(read_req, 5, flags, false);
+      }))
+      .RetiresOnSaturation();
+  ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
+  EXPECT_EQ("hellohello", received);
+
+  // The read ends when the provided buffers run out, and is submitted again.
+  Request* ended_req = read_req;
+  EXPECT_CALL(mock_io_uring, prepareRecvMultishot(fd, _))
+      .WillOnce(DoAll(SaveArg<1>(&read_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(Invoke([ended_req](const CompletionCb& cb) { cb(ended_req, -ENOBUFS, 0, false); }))
+      .RetiresOnSaturation();
+  ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
+  EXPECT_EQ("hellohello", received);
+
+  expectCloseOnDestruction(mock_io_uring, dispatcher, fd, read_req);
+  worker.reset();
+}
+
+TEST(IoUringWorkerImplTest, MultishotReadFallsBackToSingleShotOnEinval) {
+  Event::MockDispatcher dispatcher;
+  IoUringPtr io_uring_instance = std::make_unique<MockIoUring>();
+  MockIoUring& mock_io_uring = *dynamic_cast<MockIoUring*>(io_uring_instance.get());
+  Event::FileReadyCb file_event_callback;
+
+  EXPECT_CALL(mock_io_uring, registerProvidedBuffers(16, 8192))
+      .WillOnce(Return<IoUringResult>(IoUringResult::Ok));
+  EXPECT_CALL(mock_io_uring, registerEventfd());
+  EXPECT_CALL(mock_io_uring, submit()).Times(AnyNumber());
+  EXPECT_CALL(dispatcher,
+              createFileEvent_(_, _, Event::PlatformDefaultTriggerType, Event::FileReadyType::Read))
+      .WillOnce(
+          DoAll(SaveArg<1>(&file_event_callback), ReturnNew<NiceMock<Event::MockFileEvent>>()));
+  auto worker = std::make_unique<IoUringWorkerTestImpl>(std::move(io_uring_instance), dispatcher,
+                                                        16);
+  EXPECT_TRUE(worker->hasProvidedBuffers());
+
+  os_fd_t fd = 11;
+  Request* read_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareRecvMultishot(fd, _))
+      .WillOnce(DoAll(SaveArg<1>(&read_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  worker->addServerSocket(
+      fd,
+      [](uint32_t) {
+        ADD_FAILURE() << "no data was read";
+        return absl::OkStatus();
+      },
+      false);
+
+  // A kernel with provided buffer rings but without multishot recv fails the first read with
+  // -EINVAL. The socket switches to single shot reads, and reads again.
+  Request* failed_req = read_req;
+  EXPECT_CALL(mock_io_uring, prepareReadv(fd, _, 1, 0, _))
+      .WillOnce(DoAll(SaveArg<4>(&read_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(Invoke([failed_req](const CompletionCb& cb) { cb(failed_req, -EINVAL, 0, false); }))
+      .RetiresOnSaturation();
+  ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
+  EXPECT_TRUE(worker->hasProvidedBuffers());
+
+  // The single shot read does not fail with -EINVAL, so it was the kernel that rejected the
+  // multishot read, and the whole worker switches to single shot requests.
+  failed_req = read_req;
+  EXPECT_CALL(mock_io_uring, prepareReadv(fd, _, 1, 0, _))
+      .WillOnce(DoAll(SaveArg<4>(&read_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(
+          Invoke([failed_req](const CompletionCb& cb) { cb(failed_req, -ECANCELED, 0, false); }))
+      .RetiresOnSaturation();
+  ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
+  EXPECT_FALSE(worker->hasProvidedBuffers());
+
+  expectCloseOnDestruction(mock_io_uring, dispatcher, fd, read_req);
+  worker.reset();
+}
+
+// An accept fails with -EINVAL on a socket that is not listening, too. If the single shot accept
+// submitted instead fails the same way, the socket was at fault and other sockets keep using
+// multishot requests.
+TEST(IoUringWorkerImplTest, MultishotAcceptEinvalFromSocketKeepsMultishot) {
+  Event::MockDispatcher dispatcher;
+  IoUringPtr io_uring_instance = std::make_unique<MockIoUring>();
+  MockIoUring& mock_io_uring = *dynamic_cast<MockIoUring*>(io_uring_instance.get());
+  Event::FileReadyCb file_event_callback;
+
+  EXPECT_CALL(mock_io_uring, registerProvidedBuffers(16, 8192))
+      .WillOnce(Return<IoUringResult>(IoUringResult::Ok));
+  EXPECT_CALL(mock_io_uring, registerEventfd());
+  EXPECT_CALL(mock_io_uring, submit()).Times(AnyNumber());
+  EXPECT_CALL(dispatcher,
+              createFileEvent_(_, _, Event::PlatformDefaultTriggerType, Event::FileReadyType::Read))
+      .WillOnce(
+          DoAll(SaveArg<1>(&file_event_callback), ReturnNew<NiceMock<Event::MockFileEvent>>()));
+  auto worker = std::make_unique<IoUringWorkerTestImpl>(std::move(io_uring_instance), dispatcher,
+                                                        16);
+
+  os_fd_t fd = 11;
+  Request* accept_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareAcceptMultishot(fd, _))
+      .WillOnce(DoAll(SaveArg<1>(&accept_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  worker->addAcceptSocket(fd, [](uint32_t) {
+    ADD_FAILURE() << "no socket was accepted";
+    return absl::OkStatus();
+  });
+
+  Request* failed_req = accept_req;
+  EXPECT_CALL(mock_io_uring, prepareAccept(fd, nullptr, nullptr, _))
+      .WillOnce(DoAll(SaveArg<3>(&accept_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(Invoke([failed_req](const CompletionCb& cb) { cb(failed_req, -EINVAL, 0, false); }))
+      .RetiresOnSaturation();
+  ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
+
+  failed_req = accept_req;
+  EXPECT_CALL(mock_io_uring, prepareAccept(fd, nullptr, nullptr, _))
+      .WillOnce(DoAll(SaveArg<3>(&accept_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(Invoke([failed_req](const CompletionCb& cb) { cb(failed_req, -EINVAL, 0, false); }))
+      .RetiresOnSaturation();
+  ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
+  EXPECT_TRUE(worker->hasProvidedBuffers());
+
+  expectCloseOnDestruction(mock_io_uring, dispatcher, fd, accept_req);
+  worker.reset();
+}
+
+TEST(IoUringWorkerImplTest, MultishotAccept) {
+  Event::MockDispatcher dispatcher;
+  IoUringPtr io_uring_instance = std::make_unique<MockIoUring>();
+  MockIoUring& mock_io_uring = *dynamic_cast<MockIoUring*>(io_uring_instance.get());
+  Event::FileReadyCb file_event_callback;
+
+  EXPECT_CALL(mock_io_uring, registerProvidedBuffers(16, 8192))
+      .WillOnce(Return<IoUringResult>(IoUringResult::Ok));
+  EXPECT_CALL(mock_io_uring, registerEventfd());
+  EXPECT_CALL(mock_io_uring, submit()).Times(AnyNumber());
+  EXPECT_CALL(dispatcher,
+              createFileEvent_(_, _, Event::PlatformDefaultTriggerType, Event::FileReadyType::Read))
+      .WillOnce(
+          DoAll(SaveArg<1>(&file_event_callback), ReturnNew<NiceMock<Event::MockFileEvent>>()));
+  auto worker = std::make_unique<IoUringWorkerTestImpl>(std::move(io_uring_instance), dispatcher,
+                                                        16);
+
+  os_fd_t fd = 11;
+  Request* accept_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareAcceptMultishot(fd, _))
+      .WillOnce(DoAll(SaveArg<1>(&accept_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  IoUringSocket* io_uring_socket = nullptr;
+  std::vector<os_fd_t> accepted;
+  io_uring_socket =
+      &worker->addAcceptSocket(fd, [&io_uring_socket, &accepted](uint32_t events) {
+        EXPECT_EQ(Event::FileReadyType::Read, events);
+        for (os_fd_t accepted_fd = io_uring_socket->nextAcceptedSocket();
+             SOCKET_VALID(accepted_fd); accepted_fd = io_uring_socket->nextAcceptedSocket()) {
+          accepted.push_back(accepted_fd);
+        }
+        return absl::OkStatus();
+      });
+
+  // A single accept request accepts every connection.
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(Invoke([&accept_req](const CompletionCb& cb) {
+        cb(accept_req, 20, IORING_CQE_F_MORE, false);
+        cb(accept_req, 21, IORING_CQE_F_MORE, false);
+      }))
+      .RetiresOnSaturation();
+  ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
+  EXPECT_EQ((std::vector<os_fd_t>{20, 21}), accepted);
+
+  // Disabling the socket cancels the accept, so that connections wait in the backlog.
+  Request* cancel_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareCancel(accept_req, _))
+      .WillOnce(DoAll(SaveArg<1>(&cancel_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  io_uring_socket->disableRead();
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(Invoke([&accept_req, &cancel_req](const CompletionCb& cb) {
+        cb(accept_req, -ECANCELED, 0, false);
+        cb(cancel_req, 0, 0, false);
+      }))
+      .RetiresOnSaturation();
+  ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
+
+  EXPECT_CALL(mock_io_uring, prepareAcceptMultishot(fd, _))
+      .WillOnce(DoAll(SaveArg<1>(&accept_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  io_uring_socket->enableRead();
+
+  expectCloseOnDestruction(mock_io_uring, dispatcher, fd, accept_req);
+  worker.reset();
+}
+
+TEST(IoUringWorkerImplTest, Recvmsg) {
+  Event::MockDispatcher dispatcher;
+  IoUringPtr io_uring_instance = std::make_unique<MockIoUring>();
+  MockIoUring& mock_io_uring = *dynamic_cast<MockIoUring*>(io_uring_instance.get());
+  Event::FileReadyCb file_event_callback;
+
+  EXPECT_CALL(mock_io_uring, registerEventfd());
+  EXPECT_CALL(mock_io_uring, submit()).Times(AnyNumber());
+  EXPECT_CALL(dispatcher,
+              createFileEvent_(_, _, Event::PlatformDefaultTriggerType, Event::FileReadyType::Read))
+      .WillOnce(
+          DoAll(SaveArg<1>(&file_event_callback), ReturnNew<NiceMock<Event::MockFileEvent>>()));
+  auto worker = std::make_unique<IoUringWorkerTestImpl>(std::move(io_uring_instance), dispatcher);
+
+  os_fd_t fd = 11;
+  Request* recvmsg_req = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareRecvmsg(fd, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&recvmsg_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  IoUringSocket* io_uring_socket = nullptr;
+  ReceivedDatagramPtr datagram;
+  io_uring_socket = &worker->addDatagramSocket(fd, [&io_uring_socket, &datagram](uint32_t) {
+    datagram = io_uring_socket->nextReceivedDatagram();
+    EXPECT_EQ(nullptr, io_uring_socket->nextReceivedDatagram());
+    return absl::OkStatus();
+  });
+
+  // Fake a datagram received into the buffer of the request.
+  RecvmsgRequest* received_req = static_cast<RecvmsgRequest*>(recvmsg_req);
+  memcpy(received_req->buf_.get(), "hello", 5); // NOLINT(safe-memcpy)
+  auto* peer = reinterpret_cast<sockaddr_in*>(&received_req->peer_address_);
+  peer->sin_family = AF_INET;
+  peer->sin_port = htons(53);
+  received_req->msg_.msg_namelen = sizeof(sockaddr_in);
+  received_req->msg_.msg_controllen = 0;
+
+  EXPECT_CALL(mock_io_uring, prepareRecvmsg(fd, _, _))
+      .WillOnce(DoAll(SaveArg<2>(&recvmsg_req), Return<IoUringResult>(IoUringResult::Ok)))
+      .RetiresOnSaturation();
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(Invoke([received_req](const CompletionCb& cb) { cb(received_req, 5, 0, false); }))
+      .RetiresOnSaturation();
+  ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
+
+  ASSERT_NE(nullptr, datagram);
+  EXPECT_EQ("hello", std::string(datagram->payload_.begin(), datagram->payload_.end()));
+  EXPECT_EQ(sizeof(sockaddr_in), datagram->peer_address_len_);
+  EXPECT_EQ(htons(53), reinterpret_cast<sockaddr_in*>(&datagram->peer_address_)->sin_port);
+  EXPECT_TRUE(datagram->control_.empty());
+
+  expectCloseOnDestruction(mock_io_uring, dispatcher, fd, recvmsg_req);
+  worker.reset();
+}
+
+TEST(IoUringWorkerImplTest, MultishotRecvmsgWithProvidedBuffers) {
+  Event::MockDispatcher dispatcher;
+  IoUringPtr io_uring_instance = std::make_unique<MockIoUring>();
+  MockIoUring& mock_io_uring = *dynamic_cast<MockIoUring*>(io_uring_instance.get());
+  Event::FileReadyCb file_event_callback;
+
+  EXPECT_CALL(mock_io_uring, registerProvidedBuffers(16, 8192))
+      .WillOnce(Return<IoUringResult>(IoUringResult::Ok));
+  EXPECT_CALL(mock_io_uring, registerEventfd());
+  EXPECT_CALL(mock_io_uring, submit()).Times(AnyNumber());
+  EXPECT_CALL(dispatcher,
+              createFileEvent_(_, _, Event::PlatformDefaultTriggerType, Event::FileReadyType::Read))
+      .WillOnce(
+          DoAll(SaveArg<1>(&file_event_callback), ReturnNew<NiceMock<Event::MockFileEvent>>()));
+  auto worker = std::make_unique<IoUringWorkerTestImpl>(std::move(io_uring_instance), dispatcher,
+                                                        16);
+
+  os_fd_t fd = 11;
+  Request* recvmsg_req = nullptr;
+  struct msghdr* msg = nullptr;
+  EXPECT_CALL(mock_io_uring, prepareRecvmsgMultishot(fd, _, _))
+      .WillOnce(DoAll(SaveArg<1>(&msg), SaveArg<2>(&recvmsg_req),
+                      Return<IoUringResult>(IoUringResult::Ok)));
+  IoUringSocket* io_uring_socket = nullptr;
+  std::vector<ReceivedDatagramPtr> datagrams;
+  io_uring_socket = &worker->addDatagramSocket(fd, [&io_uring_socket, &datagrams](uint32_t) {
+    for (ReceivedDatagramPtr datagram = io_uring_socket->nextReceivedDatagram();
+         datagram != nullptr; datagram = io_uring_socket->nextReceivedDatagram()) {
+      datagrams.push_back(std::move(datagram));
+    }
+    return absl::OkStatus();
+  });
+  ASSERT_NE(nullptr, msg);
+
+  // Lay out a datagram in the provided buffer as the kernel does: a header, the name, the control
+  // messages, then the payload.
+  uint8_t provided_buf[8192] = {};
+  auto* out = reinterpret_cast<struct io_uring_recvmsg_out*>(provided_buf);
+  out->namelen = sizeof(sockaddr_in);
+  out->controllen = 0;
+  out->payloadlen = 5;
+  out->flags = 0;
+  auto* peer = reinterpret_cast<sockaddr_in*>(out + 1);
+  peer->sin_family = AF_INET;
+  peer->sin_port = htons(53);
+  uint8_t* payload = reinterpret_cast<uint8_t*>(out + 1) + msg->msg_namelen + msg->msg_controllen;
+  memcpy(payload, "hello", 5); // NOLINT(safe-memcpy)
+  const int32_t result = static_cast<int32_t>(payload + 5 - provided_buf);
+
+  EXPECT_CALL(mock_io_uring, providedBuffer(2)).WillOnce(Return(provided_buf));
+  EXPECT_CALL(mock_io_uring, recycleProvidedBuffer(2));
+  EXPECT_CALL(mock_io_uring, forEveryCompletion(_))
+      .WillOnce(Invoke([&recvmsg_req, result](const CompletionCb& cb) {
+        cb(recvmsg_req, result,
+           IORING_CQE_F_MORE | IORING_CQE_F_BUFFER | (2 << IORING_CQE_BUFFER_SHIFT), false);
+      }))
+      .RetiresOnSaturation();
+  ASSERT_TRUE(file_event_callback(Event::FileReadyType::Read).ok());
+
+  ASSERT_EQ(1, datagrams.size());
+  EXPECT_EQ("hello", std::string(datagrams[0]->payload_.begin(), datagrams[0]->payload_.end()));
+  EXPECT_EQ(sizeof(sockaddr_in), datagrams[0]->peer_address_len_);
+  EXPECT_EQ(htons(53), reinterpret_cast<sockaddr_in*>(&datagrams[0]->peer_address_)->sin_port);
+  EXPECT_EQ(0, datagrams[0]->flags_);
+
+  expectCloseOnDestruction(mock_io_uring, dispatcher, fd, recvmsg_req);
+  worker.reset();
+}
+
 class ReproSocket : public IoUringSocketEntry {
 public:
   ReproSocket(os_fd_t fd, IoUringWorkerImpl& parent)
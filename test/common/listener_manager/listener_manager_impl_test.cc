@@ -561,6 +561,24 @@ filter_chains:
             manager_->listeners().back().get().perConnectionBufferHighWatermarkTimeout());
 }
 
+TEST_P(ListenerManagerImplWithRealFiltersTest, IdleMemoryShedTimeoutConfigured) {
+  const std::string yaml = R"EOF(
+address:
+  socket_address:
+    address: 127.0.0.1
+    port_value: 1234
+per_connection_idle_memory_shed_timeout: 30s
+filter_chains:
+- filters: []
+  name: foo
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, default_bind_type, _, 0));
+  addOrUpdateListener(parseListenerFromV3Yaml(yaml));
+  EXPECT_EQ(std::chrono::seconds(30),
+            manager_->listeners().back().get().perConnectionIdleMemoryShedTimeout());
+}
+
 TEST_P(ListenerManagerImplWithRealFiltersTest, TlsTransportSocket) {
   const std::string yaml = TestEnvironment::substitute(R"EOF(
 address:
@@ -7124,6 +7142,39 @@ TEST_P(ListenerManagerImplWithRealFiltersTest, MptcpNotSupported) {
       "listener mptcp-udp: enable_mptcp is set but MPTCP is not supported by the operating system");
 }
 
+TEST_P(ListenerManagerImplWithRealFiltersTest, IncomingCpuSteeringWithoutReusePort) {
+  auto listener = createIPv4Listener("SteeringListener");
+  listener.mutable_enable_reuse_port()->set_value(false);
+  listener.mutable_incoming_cpu()->set_steer_connections(true);
+  server_.options_.worker_cpus_ = {0};
+  EXPECT_THROW_WITH_MESSAGE(addOrUpdateListener(listener), EnvoyException,
+                            "listener SteeringListener: incoming_cpu.steer_connections requires a "
+                            "TCP listener with reuse_port");
+}
+
+TEST_P(ListenerManagerImplWithRealFiltersTest, IncomingCpuSteeringOnUdp) {
+  auto listener = createIPv4Listener("SteeringListener");
+  listener.mutable_address()->mutable_socket_address()->set_protocol(
+      envoy::config::core::v3::SocketAddress::UDP);
+  listener.mutable_incoming_cpu()->set_steer_connections(true);
+  server_.options_.worker_cpus_ = {0};
+  EXPECT_THROW_WITH_MESSAGE(addOrUpdateListener(listener), EnvoyException,
+                            "listener SteeringListener: incoming_cpu.steer_connections requires a "
+                            "TCP listener with reuse_port");
+}
+
+// reuse_port is only honored for TCP on Linux.
+#if defined(__linux__)
+TEST_P(ListenerManagerImplWithRealFiltersTest, IncomingCpuSteeringWithoutWorkerCpus) {
+  auto listener = createIPv4Listener("SteeringListener");
+  listener.mutable_enable_reuse_port()->set_value(true);
+  listener.mutable_incoming_cpu()->set_steer_connections(true);
+  EXPECT_THROW_WITH_MESSAGE(
+      addOrUpdateListener(listener), EnvoyException,
+      "listener SteeringListener: incoming_cpu.steer_connections requires --worker-cpus");
+}
+#endif
+
 // Test that hasCompatibleAddress returns false if network namespace is different.
 TEST_P(ListenerManagerImplTest, HasCompatibleAddressWithNetNs) {
   const std::string yaml_config1 = R"EOF(
@@ -1,5 +1,6 @@
 #include "envoy/config/overload/v3/overload.pb.h"
 
+#include "source/common/buffer/slice_storage_pool.h"
 #include "source/common/event/dispatcher_impl.h"
 #include "source/common/memory/heap_shrinker.h"
 #include "source/common/memory/stats.h"
@@ -85,6 +86,25 @@ TEST_F(HeapShrinkerTest, ShrinkWhenTriggered) {
   EXPECT_EQ(2, shrink_count.value());
 }
 
+TEST_F(HeapShrinkerTest, ShrinkReleasesPooledSliceStorage) {
+  Server::OverloadActionCb action_cb;
+  EXPECT_CALL(overload_manager_, registerForAction(_, _, _))
+      .WillOnce(Invoke([&](const std::string&, Event::Dispatcher&, Server::OverloadActionCb cb) {
+        action_cb = cb;
+        return true;
+      }));
+
+  HeapShrinker h(dispatcher_, overload_manager_, *stats_.rootScope());
+
+  Buffer::SliceStoragePool::release(Buffer::SliceStoragePool::allocate());
+  EXPECT_EQ(1, Buffer::SliceStoragePool::threadCacheSize());
+
+  action_cb(Server::OverloadActionState::saturated());
+  step();
+  EXPECT_EQ(0, Buffer::SliceStoragePool::threadCacheSize());
+  EXPECT_EQ(0, Buffer::SliceStoragePool::globalPoolBytes());
+}
+
 TEST_F(HeapShrinkerTest, CustomTimerInterval) {
   Server::OverloadActionCb action_cb;
   envoy::config::overload::v3::ShrinkHeapConfig config;
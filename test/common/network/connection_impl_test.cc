@@ -56,6 +56,7 @@ using testing::Invoke;
 using testing::InvokeWithoutArgs;
 using testing::Optional;
 using testing::Return;
+using testing::ReturnPointee;
 using testing::SaveArg;
 using testing::Sequence;
 using testing::StartsWith;
@@ -564,6 +565,64 @@ TEST_P(ConnectionImplTest, ServerTransportSocketTimeoutDisabledOnConnect) {
   server_connection->close(ConnectionCloseType::NoFlush);
 }
 
+TEST_P(ConnectionImplTest, IdleMemoryShedTimeout) {
+  ConnectionMocks mocks = createConnectionMocks(false);
+  MockTransportSocket* transport_socket = mocks.transport_socket_.get();
+  IoHandlePtr io_handle = std::make_unique<Network::Test::IoSocketHandlePlatformImpl>(0);
+  auto server_connection = std::make_unique<Network::ServerConnectionImpl>(
+      *mocks.dispatcher_,
+      std::make_unique<ConnectionSocketImpl>(std::move(io_handle), nullptr, nullptr),
+      std::move(mocks.transport_socket_), stream_info_);
+  server_connection->addReadFilter(std::make_shared<NiceMock<MockReadFilter>>());
+
+  MonotonicTime now;
+  ON_CALL(*mocks.dispatcher_, approximateMonotonicTime()).WillByDefault(ReturnPointee(&now));
+  auto* idle_timer = new Event::MockTimer(mocks.dispatcher_.get());
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(10 * 1000), _));
+  Stats::MockCounter shed_counter;
+  Stats::MockCounter shed_bytes_counter;
+  server_connection->setIdleMemoryShedTimeout(std::chrono::seconds(10), shed_counter,
+                                              shed_bytes_counter);
+
+  // A read leaves a few bytes in a 12 KiB slice. It doesn't re-arm the timer.
+  now += std::chrono::seconds(4);
+  EXPECT_CALL(*transport_socket, doRead(_)).WillOnce(Invoke([](Buffer::Instance& buffer) {
+    buffer.add(std::string(10000, 'a'));
+    return IoResult{PostIoAction::KeepOpen, 10000, false};
+  }));
+  (*mocks.file_ready_cb_)(Event::FileReadyType::Read);
+  server_connection->getReadBuffer().buffer.drain(9990);
+
+  // The timer fires 6 seconds after the read, and waits for the rest of the timeout.
+  now += std::chrono::seconds(6);
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(4 * 1000), _));
+  idle_timer->invokeCallback();
+
+  // The bytes left are moved to a 4 KiB slice once the connection has been idle for the timeout.
+  now += std::chrono::seconds(4);
+  EXPECT_CALL(shed_counter, inc());
+  EXPECT_CALL(shed_bytes_counter, add(8192));
+  idle_timer->invokeCallback();
+  EXPECT_EQ(10, server_connection->getReadBuffer().buffer.length());
+
+  // The timer stays disabled until the next socket event.
+  EXPECT_FALSE(idle_timer->enabled());
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(10 * 1000), _));
+  EXPECT_CALL(*transport_socket, doRead(_))
+      .WillOnce(Return(IoResult{PostIoAction::KeepOpen, 0, false}));
+  (*mocks.file_ready_cb_)(Event::FileReadyType::Read);
+
+  // The buffers are already as small as they get, so the next timeout releases nothing and is not
+  // counted.
+  now += std::chrono::seconds(10);
+  EXPECT_CALL(shed_counter, inc()).Times(0);
+  EXPECT_CALL(shed_bytes_counter, add(_)).Times(0);
+  idle_timer->invokeCallback();
+  EXPECT_EQ(10, server_connection->getReadBuffer().buffer.length());
+
+  server_connection->close(ConnectionCloseType::NoFlush);
+}
+
 TEST_P(ConnectionImplTest, SocketOptions) {
   Network::ClientConnectionPtr upstream_connection_;
 
@@ -113,6 +113,28 @@ TEST_F(NetworkFilterManagerTest, All) {
   manager.onWrite();
 }
 
+TEST_F(NetworkFilterManagerTest, IsSoleFilter) {
+  auto read_filter = std::make_shared<NiceMock<MockReadFilter>>();
+  auto other_read_filter = std::make_shared<NiceMock<MockReadFilter>>();
+
+  FilterManagerImpl manager(connection_, socket_);
+  EXPECT_FALSE(manager.isSoleFilter(*read_filter));
+
+  manager.addReadFilter(read_filter);
+  EXPECT_TRUE(manager.isSoleFilter(*read_filter));
+  EXPECT_FALSE(manager.isSoleFilter(*other_read_filter));
+
+  // Another read filter would not see the data.
+  manager.addReadFilter(other_read_filter);
+  EXPECT_FALSE(manager.isSoleFilter(*read_filter));
+
+  // Neither would a write filter.
+  FilterManagerImpl write_manager(connection_, socket_);
+  write_manager.addReadFilter(read_filter);
+  write_manager.addWriteFilter(std::make_shared<NiceMock<MockWriteFilter>>());
+  EXPECT_FALSE(write_manager.isSoleFilter(*read_filter));
+}
+
 TEST_F(NetworkFilterManagerTest, ConnectionClosedBeforeRunningFilter) {
   InSequence s;
 
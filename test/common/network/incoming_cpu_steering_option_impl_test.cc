@@ -0,0 +1,103 @@
+#include "source/common/network/incoming_cpu_steering_option_impl.h"
+
+#include "test/common/network/socket_option_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class IncomingCpuSteeringOptionImplTest : public SocketOptionTest {};
+
+TEST_F(IncomingCpuSteeringOptionImplTest, IgnoresOptionOnDifferentState) {
+  IncomingCpuSteeringOptionImpl socket_option{{0, 1}};
+  EXPECT_CALL(socket_, setSocketOption(_, _, _, _)).Times(0);
+  EXPECT_TRUE(
+      socket_option.setOption(socket_, envoy::config::core::v3::SocketOption::STATE_PREBIND));
+  EXPECT_TRUE(
+      socket_option.setOption(socket_, envoy::config::core::v3::SocketOption::STATE_LISTENING));
+}
+
+TEST_F(IncomingCpuSteeringOptionImplTest, HashKeyDependsOnCpus) {
+  std::vector<uint8_t> hash;
+  IncomingCpuSteeringOptionImpl{{0, 1}}.hashKey(hash);
+  std::vector<uint8_t> same_hash;
+  IncomingCpuSteeringOptionImpl{{0, 1}}.hashKey(same_hash);
+  std::vector<uint8_t> other_hash;
+  IncomingCpuSteeringOptionImpl{{1, 0}}.hashKey(other_hash);
+  EXPECT_EQ(hash, same_hash);
+  EXPECT_NE(hash, other_hash);
+}
+
+#if defined(SO_ATTACH_REUSEPORT_CBPF) && defined(__linux__)
+// Runs the subset of classic BPF used by the steering program for a connection received on cpu.
+uint32_t runProgram(const sock_fprog& prog, uint32_t cpu) {
+  uint32_t accumulator = 0;
+  for (uint32_t pc = 0; pc < prog.len; ++pc) {
+    const sock_filter& insn = prog.filter[pc];
+    switch (insn.code) {
+    case BPF_LD | BPF_W | BPF_ABS:
+      EXPECT_EQ(static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU), insn.k);
+      accumulator = cpu;
+      break;
+    case BPF_JMP | BPF_JEQ | BPF_K:
+      pc += accumulator == insn.k ? insn.jt : insn.jf;
+      break;
+    case BPF_RET | BPF_K:
+      return insn.k;
+    default:
+      ADD_FAILURE() << "unexpected instruction " << insn.code;
+      return 0;
+    }
+  }
+  ADD_FAILURE() << "program did not return";
+  return 0;
+}
+
+TEST_F(IncomingCpuSteeringOptionImplTest, SteersToWorkerOnReceivingCpu) {
+  IncomingCpuSteeringOptionImpl socket_option{{4, 6, 2}};
+  EXPECT_TRUE(socket_option.isSupported());
+  EXPECT_CALL(socket_, setSocketOption(SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, _, sizeof(sock_fprog)))
+      .WillOnce(Invoke([](int, int, const void* optval, socklen_t) -> Api::SysCallIntResult {
+        const auto& prog = *static_cast<const sock_fprog*>(optval);
+        EXPECT_EQ(0, runProgram(prog, 4));
+        EXPECT_EQ(1, runProgram(prog, 6));
+        EXPECT_EQ(2, runProgram(prog, 2));
+        // CPUs without a pinned worker fall back to the kernel's hash.
+        EXPECT_EQ(0xffffffff, runProgram(prog, 5));
+        return {0, 0};
+      }));
+  EXPECT_TRUE(
+      socket_option.setOption(socket_, envoy::config::core::v3::SocketOption::STATE_BOUND));
+
+  auto details =
+      socket_option.getOptionDetails(socket_, envoy::config::core::v3::SocketOption::STATE_BOUND);
+  ASSERT_TRUE(details.has_value());
+  EXPECT_EQ(ENVOY_ATTACH_REUSEPORT_CBPF, details->name_);
+  EXPECT_EQ("4,6,2", details->value_);
+  EXPECT_FALSE(
+      socket_option
+          .getOptionDetails(socket_, envoy::config::core::v3::SocketOption::STATE_PREBIND)
+          .has_value());
+}
+
+TEST_F(IncomingCpuSteeringOptionImplTest, FailsOnSyscallFailure) {
+  IncomingCpuSteeringOptionImpl socket_option{{0}};
+  EXPECT_CALL(socket_, setSocketOption(SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, _, _))
+      .WillOnce(testing::Return(Api::SysCallIntResult{-1, EINVAL}));
+  EXPECT_FALSE(
+      socket_option.setOption(socket_, envoy::config::core::v3::SocketOption::STATE_BOUND));
+}
+#else
+TEST_F(IncomingCpuSteeringOptionImplTest, Unsupported) {
+  IncomingCpuSteeringOptionImpl socket_option{{0}};
+  EXPECT_FALSE(socket_option.isSupported());
+  EXPECT_FALSE(
+      socket_option.setOption(socket_, envoy::config::core::v3::SocketOption::STATE_BOUND));
+}
+#endif
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
@@ -1,8 +1,21 @@
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <memory>
+#include <string>
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/network/io_socket_handle_impl.h"
 
+#if defined(ENVOY_ENABLE_IO_URING)
+#include "source/common/io/io_uring_impl.h"
+#include "source/common/io/io_uring_worker_impl.h"
+#endif
+
 #include "test/test_common/network_utility.h"
+#include "test/test_common/utility.h"
 
 #include "absl/strings/str_cat.h"
 #include "benchmark/benchmark.h"
@@ -88,5 +101,137 @@ static void bmGetOrCreateEnvoyAddressInstanceUnconnectedSocketLargerCache(benchm
 }
 BENCHMARK(bmGetOrCreateEnvoyAddressInstanceUnconnectedSocketLargerCache)->Iterations(1000);
 
+#if defined(__linux__)
+namespace {
+
+// A connected loopback TCP connection, of which the benchmarks write to one end with blocking
+// sends and receive on the other end through the event loop. The receiving end is non-blocking
+// for epoll, but not for io_uring, where it would only cause needless -EAGAIN completions.
+class LoopbackConnection {
+public:
+  explicit LoopbackConnection(bool non_blocking) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_length = sizeof(address);
+    const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    RELEASE_ASSERT(listener != -1, "");
+    RELEASE_ASSERT(::bind(listener, reinterpret_cast<sockaddr*>(&address), address_length) == 0,
+                   "");
+    RELEASE_ASSERT(
+        ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &address_length) == 0, "");
+    RELEASE_ASSERT(::listen(listener, 1) == 0, "");
+    writer_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    RELEASE_ASSERT(
+        ::connect(writer_, reinterpret_cast<sockaddr*>(&address), address_length) == 0, "");
+    reader_ = ::accept4(listener, nullptr, nullptr, non_blocking ? SOCK_NONBLOCK : 0);
+    RELEASE_ASSERT(reader_ != -1, "");
+    ::close(listener);
+  }
+  ~LoopbackConnection() { ::close(writer_); }
+
+  void send(const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+      const ssize_t rc = ::send(writer_, data.data() + sent, data.size() - sent, 0);
+      RELEASE_ASSERT(rc > 0, "");
+      sent += rc;
+    }
+  }
+
+  // The receiving end, owned by the handle or socket that reads from it.
+  int reader() const { return reader_; }
+
+private:
+  int writer_;
+  int reader_;
+};
+
+} // namespace
+
+// Receives state.range(0) bytes per iteration through an IoSocketHandleImpl whose file event is
+// driven by epoll, for comparison with bmLoopbackReceiveIoUring.
+static void bmLoopbackReceiveEpoll(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("bench");
+  LoopbackConnection connection(/*non_blocking=*/true);
+  IoSocketHandleImpl handle(connection.reader());
+  const std::string data(state.range(0), 'a');
+  Buffer::OwnedImpl buffer;
+  handle.initializeFileEvent(
+      *dispatcher,
+      [&](uint32_t) {
+        while (handle.read(buffer, absl::nullopt).return_value_ > 0) {
+        }
+        if (buffer.length() >= data.size()) {
+          buffer.drain(buffer.length());
+          dispatcher->exit();
+        }
+        return absl::OkStatus();
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read);
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    connection.send(data);
+    dispatcher->run(Event::Dispatcher::RunType::RunUntilExit);
+  }
+  handle.close();
+}
+BENCHMARK(bmLoopbackReceiveEpoll)->Arg(4096)->Arg(16384)->Arg(65536);
+
+#if defined(ENVOY_ENABLE_IO_URING)
+// Receives state.range(0) bytes per iteration through an io_uring server socket, with a read
+// buffer per request if state.range(1) is 0, or with multishot reads into a ring of that many
+// provided buffers otherwise.
+static void bmLoopbackReceiveIoUring(benchmark::State& state) {
+  if (!Io::isIoUringSupported()) {
+    state.SkipWithError("io_uring is not supported by the kernel");
+    return;
+  }
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("bench");
+  LoopbackConnection connection(/*non_blocking=*/false);
+  const std::string data(state.range(0), 'a');
+  auto worker = std::make_unique<Io::IoUringWorkerImpl>(
+      /*io_uring_size=*/64, /*use_submission_queue_polling=*/false, /*read_buffer_size=*/16384,
+      /*write_timeout_ms=*/1000, *dispatcher, /*read_buffer_ring_size=*/state.range(1));
+  if (state.range(1) > 0 && !worker->hasProvidedBuffers()) {
+    state.SkipWithError("provided buffer rings are not supported by the kernel");
+    ::close(connection.reader());
+    return;
+  }
+  uint64_t received = 0;
+  Io::IoUringSocket* socket = nullptr;
+  socket = &worker->addServerSocket(
+      connection.reader(),
+      [&](uint32_t) {
+        Buffer::Instance& buffer = socket->getReadParam()->buf_;
+        received += buffer.length();
+        buffer.drain(buffer.length());
+        if (received >= data.size()) {
+          received = 0;
+          dispatcher->exit();
+        }
+        return absl::OkStatus();
+      },
+      false);
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    connection.send(data);
+    dispatcher->run(Event::Dispatcher::RunType::RunUntilExit);
+  }
+  // The worker closes the socket on destruction.
+  worker.reset();
+}
+BENCHMARK(bmLoopbackReceiveIoUring)
+    ->Args({4096, 0})
+    ->Args({16384, 0})
+    ->Args({65536, 0})
+    ->Args({4096, 64})
+    ->Args({16384, 64})
+    ->Args({65536, 64});
+#endif
+#endif
+
 } // namespace Network
 } // namespace Envoy
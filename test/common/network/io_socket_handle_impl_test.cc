@@ -1,3 +1,6 @@
+#include <chrono>
+#include <thread>
+
 #include "source/common/common/utility.h"
 #include "source/common/network/address_impl.h"
 #include "source/common/network/io_socket_error_impl.h"
@@ -5,6 +8,7 @@
 #include "source/common/network/listen_socket_impl.h"
 
 #include "test/mocks/api/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
@@ -13,6 +17,10 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#endif
+
 using testing::_;
 using testing::Eq;
 using testing::Invoke;
@@ -225,6 +233,198 @@ TEST(IoSocketHandleImpl, DroppedUdpDatagramsMsg) {
   EXPECT_EQ(dropped_packets, 5);
 }
 
+#if defined(__linux__)
+// Returns a recvmsg() of the error queue that reports the completion of the sends [first, last].
+std::function<Api::SysCallSizeResult(os_fd_t, msghdr*, int)> zeroCopyCompletion(uint32_t first,
+                                                                               uint32_t last) {
+  return [first, last](os_fd_t, msghdr* message, int) {
+    cmsghdr* cmsg = CMSG_FIRSTHDR(message);
+    cmsg->cmsg_level = SOL_IP;
+    cmsg->cmsg_type = IP_RECVERR;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(sock_extended_err));
+    sock_extended_err error{};
+    error.ee_origin = SO_EE_ORIGIN_ZEROCOPY;
+    error.ee_info = first;
+    error.ee_data = last;
+    memcpy(CMSG_DATA(cmsg), &error, sizeof(error));
+    message->msg_controllen = cmsg->cmsg_len;
+    return Api::SysCallSizeResult{0, 0};
+  };
+}
+
+class IoSocketHandleImplZeroCopyTest : public testing::Test {
+protected:
+  IoSocketHandleImplZeroCopyTest() {
+    const int enable = 1;
+    EXPECT_EQ(0,
+              io_handle_.setOption(SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)).return_value_);
+    io_handle_.initializeFileEvent(
+        dispatcher_, [](uint32_t) { return absl::OkStatus(); }, Event::PlatformDefaultTriggerType,
+        Event::FileReadyType::Read);
+  }
+
+  // Writes a buffer large enough to be sent with MSG_ZEROCOPY, whose slices call released_ once
+  // they are freed.
+  void writeLarge() {
+    Buffer::OwnedImpl large(std::string(IoSocketHandleImpl::DefaultZeroCopySendThreshold, 'a'));
+    const uint64_t size = large.length();
+    large.addDrainTracker(released_.AsStdFunction());
+    EXPECT_CALL(os_sys_calls_, sendmsg(42, _, MSG_ZEROCOPY))
+        .WillOnce(Return(Api::SysCallSizeResult{static_cast<ssize_t>(size), 0}));
+    EXPECT_EQ(size, io_handle_.write(large).return_value_);
+    EXPECT_EQ(0, large.length());
+  }
+
+  NiceMock<Api::MockOsSysCalls> os_sys_calls_;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls_{&os_sys_calls_};
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  testing::MockFunction<void()> released_;
+  IoSocketHandleImpl io_handle_{42};
+};
+
+TEST_F(IoSocketHandleImplZeroCopyTest, SendKeepsSlicesUntilCompletion) {
+  writeLarge();
+  EXPECT_EQ(1, io_handle_.pendingZeroCopySends());
+
+  // The next write first collects the completion of send 0 from the error queue, which releases
+  // the slices of the first write. Small writes keep using the copying path.
+  EXPECT_CALL(os_sys_calls_, recvmsg(42, _, MSG_ERRQUEUE))
+      .WillOnce(Invoke(zeroCopyCompletion(0, 0)));
+  EXPECT_CALL(released_, Call());
+  Buffer::OwnedImpl small("hello");
+  EXPECT_CALL(os_sys_calls_, send(42, _, 5, 0)).WillOnce(Return(Api::SysCallSizeResult{5, 0}));
+  EXPECT_EQ(5, io_handle_.write(small).return_value_);
+  EXPECT_EQ(0, io_handle_.pendingZeroCopySends());
+}
+
+TEST_F(IoSocketHandleImplZeroCopyTest, CloseKeepsSocketOpenUntilCompletion) {
+  writeLarge();
+
+  // The send is still pending on close, so the socket is only shut down and its error queue is
+  // reaped until the completion arrives.
+  auto* linger_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  EXPECT_CALL(os_sys_calls_, recvmsg(42, _, MSG_ERRQUEUE))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, EAGAIN}));
+  EXPECT_CALL(os_sys_calls_, shutdown(42, ENVOY_SHUT_RDWR));
+  EXPECT_CALL(os_sys_calls_, close(42)).Times(0);
+  EXPECT_CALL(released_, Call()).Times(0);
+  io_handle_.close();
+  EXPECT_FALSE(io_handle_.isOpen());
+  EXPECT_TRUE(linger_timer->enabled());
+
+  EXPECT_CALL(os_sys_calls_, recvmsg(42, _, MSG_ERRQUEUE))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, EAGAIN}));
+  linger_timer->invokeCallback();
+  EXPECT_TRUE(linger_timer->enabled());
+  testing::Mock::VerifyAndClearExpectations(&released_);
+
+  EXPECT_CALL(os_sys_calls_, recvmsg(42, _, MSG_ERRQUEUE))
+      .WillOnce(Invoke(zeroCopyCompletion(0, 0)));
+  EXPECT_CALL(released_, Call());
+  EXPECT_CALL(os_sys_calls_, close(42));
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  linger_timer->invokeCallback();
+}
+
+TEST_F(IoSocketHandleImplZeroCopyTest, TurningZeroCopyOffKeepsPendingSends) {
+  writeLarge();
+
+  EXPECT_CALL(os_sys_calls_, recvmsg(42, _, MSG_ERRQUEUE))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, EAGAIN}));
+  EXPECT_CALL(released_, Call()).Times(0);
+  const int disable = 0;
+  EXPECT_EQ(0,
+            io_handle_.setOption(SOL_SOCKET, SO_ZEROCOPY, &disable, sizeof(disable)).return_value_);
+  EXPECT_EQ(1, io_handle_.pendingZeroCopySends());
+  testing::Mock::VerifyAndClearExpectations(&released_);
+
+  // New writes copy, while the send made before is still reaped.
+  EXPECT_CALL(os_sys_calls_, recvmsg(42, _, MSG_ERRQUEUE))
+      .WillOnce(Invoke(zeroCopyCompletion(0, 0)));
+  EXPECT_CALL(released_, Call());
+  EXPECT_CALL(os_sys_calls_, sendmsg(_, _, MSG_ZEROCOPY)).Times(0);
+  Buffer::OwnedImpl large(std::string(IoSocketHandleImpl::DefaultZeroCopySendThreshold, 'a'));
+  io_handle_.write(large);
+  EXPECT_EQ(0, io_handle_.pendingZeroCopySends());
+}
+
+TEST_F(IoSocketHandleImplZeroCopyTest, DuplicateDoesNotSendZeroCopy) {
+  EXPECT_CALL(os_sys_calls_, duplicate(42)).WillOnce(Return(Api::SysCallSocketResult{43, 0}));
+  IoHandlePtr duplicate = io_handle_.duplicate();
+  duplicate->initializeFileEvent(
+      dispatcher_, [](uint32_t) { return absl::OkStatus(); }, Event::PlatformDefaultTriggerType,
+      Event::FileReadyType::Read);
+
+  // The completions of sends on the shared socket would be reaped by whichever handle reads the
+  // error queue first, so only the original handle sends with MSG_ZEROCOPY.
+  Buffer::OwnedImpl large(std::string(IoSocketHandleImpl::DefaultZeroCopySendThreshold, 'a'));
+  EXPECT_CALL(os_sys_calls_, sendmsg(43, _, MSG_ZEROCOPY)).Times(0);
+  duplicate->write(large);
+  EXPECT_EQ(0, dynamic_cast<IoSocketHandleImpl&>(*duplicate).pendingZeroCopySends());
+  duplicate->close();
+}
+
+// MSG_ZEROCOPY is not supported on AF_UNIX sockets, so the pair is a loopback TCP connection.
+TEST(IoSocketHandleImpl, ZeroCopyCompletionsAreReapedWithoutFurtherIo) {
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_length = sizeof(address);
+  const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_NE(-1, listener);
+  if (::bind(listener, reinterpret_cast<sockaddr*>(&address), address_length) != 0) {
+    ::close(listener);
+    GTEST_SKIP() << "IPv4 loopback is not available";
+  }
+  ASSERT_EQ(0, ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &address_length));
+  ASSERT_EQ(0, ::listen(listener, 1));
+  const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(0, ::connect(client, reinterpret_cast<sockaddr*>(&address), address_length));
+  const int server = ::accept(listener, nullptr, nullptr);
+  ::close(listener);
+  ASSERT_NE(-1, server);
+
+  IoSocketHandleImpl sender(client);
+  const int enable = 1;
+  if (sender.setOption(SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)).return_value_ != 0) {
+    ::close(server);
+    GTEST_SKIP() << "SO_ZEROCOPY is not supported by the kernel";
+  }
+  sender.initializeFileEvent(
+      *dispatcher, [](uint32_t) { return absl::OkStatus(); }, Event::PlatformDefaultTriggerType,
+      Event::FileReadyType::Read);
+
+  Buffer::OwnedImpl large(std::string(IoSocketHandleImpl::DefaultZeroCopySendThreshold, 'a'));
+  const uint64_t size = large.length();
+  testing::MockFunction<void()> released;
+  large.addDrainTracker(released.AsStdFunction());
+  ASSERT_EQ(size, sender.write(large).return_value_);
+  EXPECT_EQ(1, sender.pendingZeroCopySends());
+
+  std::string received(size, '\0');
+  size_t received_length = 0;
+  while (received_length < size) {
+    const ssize_t rc = ::recv(server, &received[received_length], size - received_length, 0);
+    ASSERT_GT(rc, 0);
+    received_length += rc;
+  }
+  EXPECT_EQ(std::string(size, 'a'), received);
+
+  // Nothing is read from or written to the sender anymore, the completion is still reaped and
+  // the slices of the send are released.
+  EXPECT_CALL(released, Call());
+  for (int i = 0; i < 1000 && sender.pendingZeroCopySends() > 0; i++) {
+    dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(0, sender.pendingZeroCopySends());
+  sender.close();
+  ::close(server);
+}
+#endif
+
 TEST(IoSocketHandleImpl, DroppedUdpDatagramsMmsg) {
   NiceMock<Envoy::Api::MockOsSysCalls> os_sys_calls;
   auto os_calls =
@@ -278,6 +478,60 @@ TEST(IoSocketHandleImpl, DroppedUdpDatagramsMmsg) {
   EXPECT_EQ(dropped_packets, 5);
 }
 
+TEST(IoSocketHandleImpl, SendmmsgSendsAllDatagramsInOneCall) {
+  NiceMock<Envoy::Api::MockOsSysCalls> os_sys_calls;
+  Envoy::TestThreadsafeSingletonInjector<Envoy::Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  EXPECT_CALL(os_sys_calls, supportsMmsg()).WillRepeatedly(Return(true));
+
+  char first[] = "abc";
+  char second[] = "defg";
+  const Buffer::RawSlice datagrams[] = {{first, 3}, {second, 4}};
+  const Address::Ipv4Instance peer("127.0.0.1", 8125);
+  EXPECT_CALL(os_sys_calls, sendmsg(_, _, _)).Times(0);
+  EXPECT_CALL(os_sys_calls, sendmmsg(42, _, 2, 0))
+      .WillOnce(Invoke([&](os_fd_t, mmsghdr* messages, unsigned int, int) {
+        for (size_t i = 0; i < 2; i++) {
+          EXPECT_EQ(datagrams[i].mem_, messages[i].msg_hdr.msg_iov->iov_base);
+          EXPECT_EQ(datagrams[i].len_, messages[i].msg_hdr.msg_iov->iov_len);
+          EXPECT_EQ(peer.sockAddr(), messages[i].msg_hdr.msg_name);
+        }
+        return Api::SysCallIntResult{1, 0};
+      }));
+
+  IoSocketHandleImpl io_handle(42);
+  const Api::IoCallUint64Result result = io_handle.sendmmsg(datagrams, peer);
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(1, result.return_value_);
+}
+
+TEST(IoSocketHandleImpl, SendmmsgWithoutMmsgSupportSendsDatagramsOneAtATime) {
+  NiceMock<Envoy::Api::MockOsSysCalls> os_sys_calls;
+  Envoy::TestThreadsafeSingletonInjector<Envoy::Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  EXPECT_CALL(os_sys_calls, supportsMmsg()).WillRepeatedly(Return(false));
+  EXPECT_CALL(os_sys_calls, sendmmsg(_, _, _, _)).Times(0);
+
+  char first[] = "abc";
+  char second[] = "def";
+  char third[] = "ghi";
+  const Buffer::RawSlice datagrams[] = {{first, 3}, {second, 3}, {third, 3}};
+  const Address::Ipv4Instance peer("127.0.0.1", 8125);
+  IoSocketHandleImpl io_handle(42);
+
+  // Sending stops at the first datagram that fails.
+  EXPECT_CALL(os_sys_calls, sendmsg(42, _, 0))
+      .WillOnce(Return(Api::SysCallSizeResult{3, 0}))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, SOCKET_ERROR_AGAIN}));
+  Api::IoCallUint64Result result = io_handle.sendmmsg(datagrams, peer);
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(1, result.return_value_);
+
+  // An error is only reported if no datagram was sent.
+  EXPECT_CALL(os_sys_calls, sendmsg(42, _, 0))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, SOCKET_ERROR_AGAIN}));
+  result = io_handle.sendmmsg(absl::MakeConstSpan(datagrams).subspan(1), peer);
+  EXPECT_TRUE(result.wouldBlock());
+}
+
 class IoSocketHandleImplTest : public testing::TestWithParam<Network::Address::IpVersion> {};
 INSTANTIATE_TEST_SUITE_P(IpVersions, IoSocketHandleImplTest,
                          testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
@@ -1,6 +1,7 @@
 #include "source/common/network/address_impl.h"
 #include "source/common/network/io_uring_socket_handle_impl.h"
 
+#include "test/mocks/api/mocks.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/io/mocks.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
@@ -14,6 +15,7 @@ public:
   IoUringSocketHandleTestImpl(Io::IoUringWorkerFactory& factory, bool is_server_socket)
       : IoUringSocketHandleImpl(factory, INVALID_SOCKET, false, absl::nullopt, is_server_socket) {}
   IoUringSocketType ioUringSocketType() const { return io_uring_socket_type_; }
+  void setIoUringSocketType(IoUringSocketType type) { io_uring_socket_type_ = type; }
 };
 
 class IoUringSocketHandleTest : public ::testing::Test {
@@ -131,6 +133,104 @@ TEST_F(IoUringSocketHandleTest, RecvmmsgNotSupported) {
               Api::IoError::IoErrorCode::NoSupport);
 }
 
+TEST_F(IoUringSocketHandleTest, AcceptWithMultishotAccept) {
+  IoUringSocketHandleTestImpl impl(factory_, false);
+  impl.setIoUringSocketType(IoUringSocketType::Accept);
+  EXPECT_CALL(factory_, getIoUringWorker())
+      .WillRepeatedly(testing::Return(OptRef<Io::IoUringWorker>(worker_)));
+  EXPECT_CALL(worker_, hasProvidedBuffers()).WillOnce(testing::Return(true));
+  EXPECT_CALL(worker_, addAcceptSocket(_, _)).WillOnce(testing::ReturnRef(socket_));
+  impl.initializeFileEvent(
+      dispatcher_, [](uint32_t) { return absl::OkStatus(); }, Event::PlatformDefaultTriggerType,
+      Event::FileReadyType::Read);
+
+  // Sockets accepted through io_uring are taken one by one, with their peer address.
+  const os_fd_t accepted_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_TRUE(SOCKET_VALID(accepted_fd));
+  testing::StrictMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  EXPECT_CALL(socket_, nextAcceptedSocket())
+      .WillOnce(testing::Return(accepted_fd))
+      .WillOnce(testing::Return(INVALID_SOCKET));
+  EXPECT_CALL(os_sys_calls, getpeername(accepted_fd, _, _))
+      .WillOnce(testing::Return(Api::SysCallIntResult{0, 0}));
+  sockaddr_storage addr;
+  socklen_t addr_len = sizeof(addr);
+  IoHandlePtr accepted = impl.accept(reinterpret_cast<sockaddr*>(&addr), &addr_len);
+  ASSERT_NE(nullptr, accepted);
+  EXPECT_EQ(accepted_fd, accepted->fdDoNotUse());
+  EXPECT_EQ(nullptr, impl.accept(reinterpret_cast<sockaddr*>(&addr), &addr_len));
+
+  EXPECT_CALL(socket_, disableRead());
+  impl.enableFileEvents(0);
+  EXPECT_CALL(socket_, enableRead());
+  impl.enableFileEvents(Event::FileReadyType::Read);
+  EXPECT_CALL(socket_, injectCompletion(Io::Request::RequestType::Accept));
+  impl.activateFileEvents(Event::FileReadyType::Read);
+
+  // The listen socket is kept open when its file events are reset.
+  EXPECT_CALL(socket_, close(true, _));
+  impl.resetFileEvents();
+}
+
+TEST_F(IoUringSocketHandleTest, DatagramRecvmsg) {
+  const os_fd_t fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+  ASSERT_TRUE(SOCKET_VALID(fd));
+  IoUringDatagramSocketHandleImpl impl(factory_, fd);
+  EXPECT_CALL(factory_, currentThreadRegistered()).WillRepeatedly(testing::Return(true));
+  EXPECT_CALL(factory_, getIoUringWorker())
+      .WillRepeatedly(testing::Return(OptRef<Io::IoUringWorker>(worker_)));
+  EXPECT_CALL(worker_, addDatagramSocket(fd, _)).WillOnce(testing::ReturnRef(socket_));
+  EXPECT_CALL(socket_, enableRead());
+  EXPECT_CALL(socket_, injectCompletion(Io::Request::RequestType::Write));
+  impl.initializeFileEvent(
+      dispatcher_, [](uint32_t) { return absl::OkStatus(); }, Event::PlatformDefaultTriggerType,
+      Event::FileReadyType::Read | Event::FileReadyType::Write);
+  EXPECT_FALSE(impl.supportsMmsg());
+  EXPECT_FALSE(impl.supportsUdpGro());
+
+  auto makeDatagram = [](absl::string_view payload) {
+    auto datagram = std::make_unique<Io::ReceivedDatagram>();
+    auto* peer = reinterpret_cast<sockaddr_in*>(&datagram->peer_address_);
+    peer->sin_family = AF_INET;
+    peer->sin_port = htons(53);
+    peer->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    datagram->peer_address_len_ = sizeof(sockaddr_in);
+    datagram->payload_.assign(payload.begin(), payload.end());
+    return datagram;
+  };
+  EXPECT_CALL(socket_, nextReceivedDatagram())
+      .WillOnce(testing::Return(testing::ByMove(makeDatagram("hello"))))
+      .WillOnce(testing::Return(testing::ByMove(makeDatagram("a datagram too large"))))
+      .WillOnce(testing::Return(testing::ByMove(Io::ReceivedDatagramPtr())));
+
+  char buf[16];
+  Buffer::RawSlice slice{buf, sizeof(buf)};
+  uint32_t dropped_packets = 0;
+  IoHandle::RecvMsgOutput output(1, &dropped_packets);
+  Api::IoCallUint64Result result = impl.recvmsg(&slice, 1, 0, {}, output);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(5, result.return_value_);
+  EXPECT_EQ("hello", absl::string_view(buf, 5));
+  EXPECT_EQ("127.0.0.1:53", output.msg_[0].peer_address_->asString());
+
+  // Datagrams which don't fit are dropped, as recvmsg() truncates them.
+  IoHandle::RecvMsgOutput truncated_output(1, &dropped_packets);
+  result = impl.recvmsg(&slice, 1, 0, {}, truncated_output);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(0, result.return_value_);
+  EXPECT_TRUE(truncated_output.msg_[0].truncated_and_dropped_);
+  EXPECT_EQ(1, dropped_packets);
+
+  IoHandle::RecvMsgOutput empty_output(1, &dropped_packets);
+  result = impl.recvmsg(&slice, 1, 0, {}, empty_output);
+  EXPECT_EQ(Api::IoError::IoErrorCode::Again, result.err_->getErrorCode());
+
+  EXPECT_CALL(socket_, close(false, _));
+  impl.close();
+  ::close(fd);
+}
+
 } // namespace
 } // namespace Network
 } // namespace Envoy
@@ -39,9 +39,11 @@ static Http::TestRequestHeaderMapImpl genRequestHeaders(int route_num) {
  * Generates the route config for the type of matcher being tested.
  */
 static RouteConfiguration genRouteConfig(benchmark::State& state,
-                                         RouteMatch::PathSpecifierCase match_type) {
+                                         RouteMatch::PathSpecifierCase match_type,
+                                         bool enable_path_index = false) {
   // Create the base route config.
   RouteConfiguration route_config;
+  route_config.set_enable_path_index(enable_path_index);
   VirtualHost* v_host = route_config.add_virtual_hosts();
   v_host->set_name("default");
   v_host->add_domains("*");
@@ -204,7 +206,8 @@ static RouteConfiguration genPrefixMatcherTreeRouteConfig(benchmark::State& stat
  * We then time how long it takes for the request to be matched against the
  * last route.
  */
-static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierCase match_type) {
+static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierCase match_type,
+                             bool enable_path_index = false) {
   // Setup router for benchmarking.
   Api::ApiPtr api = Api::createApiForTest();
   NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
@@ -213,7 +216,7 @@ static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierC
 
   // Create router config.
   std::shared_ptr<ConfigImpl> config =
-      *ConfigImpl::create(genRouteConfig(state, match_type), factory_context,
+      *ConfigImpl::create(genRouteConfig(state, match_type, enable_path_index), factory_context,
                           ProtobufMessage::getNullValidationVisitor(), true);
 
   for (auto _ : state) { // NOLINT
@@ -244,6 +247,20 @@ static void bmRouteTableSizeWithExactPathMatch(benchmark::State& state) {
   bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kPath);
 }
 
+/**
+ * Same as bmRouteTableSizeWithPathPrefixMatch, with the route table compiled into a path index.
+ */
+static void bmRouteTableSizeWithIndexedPathPrefixMatch(benchmark::State& state) {
+  bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kPrefix, true);
+}
+
+/**
+ * Same as bmRouteTableSizeWithExactPathMatch, with the route table compiled into a path index.
+ */
+static void bmRouteTableSizeWithIndexedExactPathMatch(benchmark::State& state) {
+  bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kPath, true);
+}
+
 /**
  * Benchmark a route table with regex path matchers in the form of:
  * - /shelves/{shelf_id}/route_1
@@ -314,6 +331,8 @@ static void bmRouteTableSizeWithPrefixMatcherTree(benchmark::State& state) {
 BENCHMARK(bmRouteTableSizeWithPathPrefixMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 BENCHMARK(bmRouteTableSizeWithExactPathMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 BENCHMARK(bmRouteTableSizeWithRegexMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
+BENCHMARK(bmRouteTableSizeWithIndexedPathPrefixMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
+BENCHMARK(bmRouteTableSizeWithIndexedExactPathMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 
 BENCHMARK(bmRouteTableSizeWithExactMatcherTree)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 BENCHMARK(bmRouteTableSizeWithPrefixMatcherTree)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
@@ -334,8 +353,9 @@ static RouteConfiguration genPlainRouteConfig(int n) {
 
 // N routes: first n/2 share prefix "/api/" with a non-matching query param;
 // last route is a plain prefix match.
-static RouteConfiguration genMixedRouteConfig(int n) {
+static RouteConfiguration genMixedRouteConfig(int n, bool enable_path_index = false) {
   RouteConfiguration route_config;
+  route_config.set_enable_path_index(enable_path_index);
   VirtualHost* v_host = route_config.add_virtual_hosts();
   v_host->set_name("default");
   v_host->add_domains("*");
@@ -378,14 +398,15 @@ static void bmPlainRoutes(benchmark::State& state) {
 }
 
 // N routes, first half with non-matching query params. Request matches the last route.
-static void bmMixedRoutes(benchmark::State& state) {
+static void bmMixedRouteTable(benchmark::State& state, bool enable_path_index) {
   const int n = state.range(0);
   Api::ApiPtr api = Api::createApiForTest();
   NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
   NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
   ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
-  std::shared_ptr<ConfigImpl> config = *ConfigImpl::create(
-      genMixedRouteConfig(n), factory_context, ProtobufMessage::getNullValidationVisitor(), true);
+  std::shared_ptr<ConfigImpl> config =
+      *ConfigImpl::create(genMixedRouteConfig(n, enable_path_index), factory_context,
+                          ProtobufMessage::getNullValidationVisitor(), true);
   Http::TestRequestHeaderMapImpl headers{{":authority", "www.example.com"},
                                          {":method", "GET"},
                                          {":path", "/api/foo?id=target"},
@@ -395,8 +416,15 @@ static void bmMixedRoutes(benchmark::State& state) {
   }
 }
 
+static void bmMixedRoutes(benchmark::State& state) { bmMixedRouteTable(state, false); }
+
+// Same as bmMixedRoutes with the route table compiled into a path index. The routes with query
+// parameter matchers share the request path prefix, so they are still evaluated in order.
+static void bmIndexedMixedRoutes(benchmark::State& state) { bmMixedRouteTable(state, true); }
+
 BENCHMARK(bmPlainRoutes)->RangeMultiplier(2)->Ranges({{64, 2 << 10}});
 BENCHMARK(bmMixedRoutes)->RangeMultiplier(2)->Ranges({{64, 2 << 10}});
+BENCHMARK(bmIndexedMixedRoutes)->RangeMultiplier(2)->Ranges({{64, 2 << 10}});
 
 } // namespace
 } // namespace Router
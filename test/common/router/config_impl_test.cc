@@ -2663,6 +2663,99 @@ virtual_hosts:
   }
 }
 
+// Tests that 'enable_path_index' selects the same routes as walking the route list, including
+// routes that are not indexed and indexed routes with additional header or query matchers.
+TEST_F(RouteMatcherTest, PathIndexPreservesFirstMatchWins) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+- name: local_service
+  domains: ["*"]
+  routes:
+  - match:
+      prefix: "/api/"
+      headers:
+      - name: x-canary
+        string_match:
+          exact: "true"
+    name: "canary"
+    route:
+      cluster: canary
+  - match:
+      safe_regex:
+        regex: "^/api/v[0-9]+/users$"
+    name: "users-regex"
+    route:
+      cluster: users
+  - match:
+      path: "/api/v1/status"
+    name: "status"
+    route:
+      cluster: status
+  - match:
+      prefix: "/API/V2/"
+      case_sensitive: false
+    name: "v2-any-case"
+    route:
+      cluster: v2
+  - match:
+      prefix: "/api/v1/"
+      query_parameters:
+      - name: debug
+        present_match: true
+    name: "v1-debug"
+    route:
+      cluster: debug
+  - match:
+      prefix: "/api/v1/"
+    name: "v1"
+    route:
+      cluster: v1
+  - match:
+      prefix: "/api/"
+    name: "api"
+    route:
+      cluster: api
+  - match:
+      prefix: "/"
+    name: "catchall"
+    route:
+      cluster: default
+  )EOF";
+  auto route_configuration = parseRouteConfigurationFromYaml(yaml);
+  factory_context_.cluster_manager_.initializeClusters(
+      {"canary", "users", "status", "v2", "debug", "v1", "api", "default"}, {});
+
+  struct Expectation {
+    std::string path;
+    std::string canary;
+    std::string route;
+  };
+  const std::vector<Expectation> expectations = {
+      {"/api/v1/status", "", "status"},
+      {"/api/v1/status?debug", "", "status"},
+      {"/api/v1/status", "true", "canary"},
+      {"/api/v1/users", "", "users-regex"},
+      {"/api/v1/other?debug=1", "", "v1-debug"},
+      {"/api/v1/other#frag", "", "v1"},
+      {"/api/v2/other", "", "v2-any-case"},
+      {"/api/v3/", "", "api"},
+      {"/apix", "", "catchall"},
+  };
+
+  for (const bool enable_path_index : {false, true}) {
+    route_configuration.set_enable_path_index(enable_path_index);
+    TestConfigImpl config(route_configuration, factory_context_, true, creation_status_);
+    for (const Expectation& expectation : expectations) {
+      Http::TestRequestHeaderMapImpl headers = genHeaders("www.lyft.com", expectation.path, "GET");
+      if (!expectation.canary.empty()) {
+        headers.addCopy("x-canary", expectation.canary);
+      }
+      EXPECT_EQ(config.route(headers, 0)->routeName(), expectation.route)
+          << expectation.path << " with enable_path_index " << enable_path_index;
+    }
+  }
+}
+
 // Tests that when 'ignore_port_in_host_matching' is true, port from host header
 // is ignored in host matching.
 TEST_F(RouteMatcherTest, IgnorePortInHostMatching) {
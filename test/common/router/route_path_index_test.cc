@@ -0,0 +1,66 @@
+#include <vector>
+
+#include "source/common/router/route_path_index.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+std::vector<uint32_t> candidates(const RoutePathIndex& index, absl::string_view path) {
+  std::vector<uint32_t> positions;
+  index.forEachCandidate(path, [&positions](uint32_t position) {
+    positions.push_back(position);
+    return true;
+  });
+  return positions;
+}
+
+TEST(RoutePathIndexTest, Empty) {
+  RoutePathIndex index;
+  EXPECT_THAT(candidates(index, "/foo"), IsEmpty());
+  EXPECT_EQ(0, index.indexedRoutes());
+}
+
+TEST(RoutePathIndexTest, CandidatesInRouteOrder) {
+  RoutePathIndex index;
+  index.addPrefix(0, "/foo/");
+  index.addUnindexed(1);
+  index.addExact(2, "/foo/bar");
+  index.addPrefix(3, "/bar/");
+  index.addPrefix(4, "/foo/");
+  index.addPrefix(5, "/");
+  index.addExact(6, "/foo");
+  index.addUnindexed(7);
+  index.addPrefix(8, "");
+  EXPECT_EQ(7, index.indexedRoutes());
+
+  EXPECT_THAT(candidates(index, "/foo/bar"), ElementsAre(0, 1, 2, 4, 5, 7, 8));
+  EXPECT_THAT(candidates(index, "/foo/baz"), ElementsAre(0, 1, 4, 5, 7, 8));
+  EXPECT_THAT(candidates(index, "/foo"), ElementsAre(1, 5, 6, 7, 8));
+  EXPECT_THAT(candidates(index, "/bar/"), ElementsAre(1, 3, 5, 7, 8));
+  EXPECT_THAT(candidates(index, "bar"), ElementsAre(1, 7, 8));
+}
+
+TEST(RoutePathIndexTest, StopsAtFirstAcceptedCandidate) {
+  RoutePathIndex index;
+  index.addPrefix(0, "/a");
+  index.addPrefix(1, "/ab");
+  index.addPrefix(2, "/abc");
+
+  std::vector<uint32_t> visited;
+  index.forEachCandidate("/abcd", [&visited](uint32_t position) {
+    visited.push_back(position);
+    return position < 1;
+  });
+  EXPECT_THAT(visited, ElementsAre(0, 1));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
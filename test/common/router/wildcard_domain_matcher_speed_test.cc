@@ -0,0 +1,101 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/common/router/wildcard_domain_matcher.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+// The length => wildcards map that RouteMatcher used before WildcardDomainMatcher, kept here as a
+// baseline. Every configured wildcard length costs a substring and a hash lookup.
+class MapOfMapsMatcher {
+public:
+  bool add(absl::string_view literal, std::shared_ptr<const std::string> value) {
+    return wildcards_[literal.size()].emplace(literal, std::move(value)).second;
+  }
+
+  const std::string* find(absl::string_view host) const {
+    for (const auto& [wildcard_length, wildcard_map] : wildcards_) {
+      if (wildcard_length >= static_cast<int64_t>(host.size())) {
+        continue;
+      }
+      const auto match = wildcard_map.find(host.substr(host.size() - wildcard_length));
+      if (match != wildcard_map.end()) {
+        return match->second.get();
+      }
+    }
+    return nullptr;
+  }
+
+private:
+  std::map<int64_t, absl::flat_hash_map<std::string, std::shared_ptr<const std::string>>,
+           std::greater<>>
+      wildcards_;
+};
+
+// Tenant wildcards of varying lengths, e.g. "*.t12.eu.example.com" and "*-t12.svc.example.com".
+std::vector<std::string> tenantWildcards(int64_t count) {
+  std::vector<std::string> literals;
+  for (int64_t i = 0; i < count; ++i) {
+    literals.push_back(i % 2 == 0 ? absl::StrCat(".t", i, ".eu.example.com")
+                                  : absl::StrCat("-t", i, ".svc.example.com"));
+  }
+  return literals;
+}
+
+template <class MatcherType>
+void bmWildcardLookup(benchmark::State& state, MatcherType& matcher, bool hit) {
+  const int64_t count = state.range(0);
+  for (const std::string& literal : tenantWildcards(count)) {
+    matcher.add(literal, std::make_shared<const std::string>(literal));
+  }
+  // The last even tenant uses a "*.tN.eu.example.com" wildcard.
+  const int64_t tenant = (count - 1) / 2 * 2;
+  const std::string host = hit ? absl::StrCat("api.t", tenant, ".eu.example.com")
+                               : std::string("api.unknown.example.org");
+  for (auto _ : state) { // NOLINT
+    benchmark::DoNotOptimize(matcher.find(host));
+  }
+}
+
+void bmWildcardDomainMatcherHit(benchmark::State& state) {
+  WildcardDomainMatcher<const std::string> matcher(
+      WildcardDomainMatcher<const std::string>::Type::Suffix);
+  bmWildcardLookup(state, matcher, true);
+}
+
+void bmWildcardDomainMatcherMiss(benchmark::State& state) {
+  WildcardDomainMatcher<const std::string> matcher(
+      WildcardDomainMatcher<const std::string>::Type::Suffix);
+  bmWildcardLookup(state, matcher, false);
+}
+
+void bmMapOfMapsHit(benchmark::State& state) {
+  MapOfMapsMatcher matcher;
+  bmWildcardLookup(state, matcher, true);
+}
+
+void bmMapOfMapsMiss(benchmark::State& state) {
+  MapOfMapsMatcher matcher;
+  bmWildcardLookup(state, matcher, false);
+}
+
+BENCHMARK(bmWildcardDomainMatcherHit)->RangeMultiplier(8)->Range(1, 1 << 15);
+BENCHMARK(bmWildcardDomainMatcherMiss)->RangeMultiplier(8)->Range(1, 1 << 15);
+BENCHMARK(bmMapOfMapsHit)->RangeMultiplier(8)->Range(1, 1 << 15);
+BENCHMARK(bmMapOfMapsMiss)->RangeMultiplier(8)->Range(1, 1 << 15);
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,68 @@
+#include <memory>
+#include <string>
+
+#include "source/common/router/wildcard_domain_matcher.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+using Matcher = WildcardDomainMatcher<const std::string>;
+
+std::shared_ptr<const std::string> value(absl::string_view name) {
+  return std::make_shared<const std::string>(name);
+}
+
+std::string find(const Matcher& matcher, absl::string_view host) {
+  const std::string* match = matcher.find(host);
+  return match != nullptr ? *match : "";
+}
+
+TEST(WildcardDomainMatcherTest, SuffixLongestMatchWins) {
+  Matcher matcher(Matcher::Type::Suffix);
+  EXPECT_TRUE(matcher.empty());
+  EXPECT_TRUE(matcher.add(".baz.com", value("*.baz.com")));
+  EXPECT_TRUE(matcher.add("-bar.baz.com", value("*-bar.baz.com")));
+  EXPECT_TRUE(matcher.add("r.baz.com", value("*r.baz.com")));
+  EXPECT_FALSE(matcher.empty());
+
+  EXPECT_EQ("*-bar.baz.com", find(matcher, "foo-bar.baz.com"));
+  EXPECT_EQ("*r.baz.com", find(matcher, "bar.baz.com"));
+  EXPECT_EQ("*.baz.com", find(matcher, "foo.baz.com"));
+  EXPECT_EQ("", find(matcher, "foo.bar.com"));
+  // The wildcard has to match at least one character.
+  EXPECT_EQ("", find(matcher, ".baz.com"));
+  EXPECT_EQ("*r.baz.com", find(matcher, "-bar.baz.com"));
+  EXPECT_EQ("", find(matcher, ""));
+}
+
+TEST(WildcardDomainMatcherTest, PrefixLongestMatchWins) {
+  Matcher matcher(Matcher::Type::Prefix);
+  EXPECT_TRUE(matcher.add("foo.", value("foo.*")));
+  EXPECT_TRUE(matcher.add("foo.bar-", value("foo.bar-*")));
+
+  EXPECT_EQ("foo.bar-*", find(matcher, "foo.bar-baz"));
+  EXPECT_EQ("foo.*", find(matcher, "foo.bar"));
+  EXPECT_EQ("foo.*", find(matcher, "foo.bar-"));
+  EXPECT_EQ("", find(matcher, "foo."));
+  EXPECT_EQ("", find(matcher, "bar.foo"));
+}
+
+TEST(WildcardDomainMatcherTest, RejectsDuplicates) {
+  Matcher matcher(Matcher::Type::Suffix);
+  EXPECT_TRUE(matcher.add(".foo.com", value("first")));
+  EXPECT_FALSE(matcher.add(".foo.com", value("second")));
+  EXPECT_EQ("first", find(matcher, "www.foo.com"));
+}
+
+TEST(WildcardDomainMatcherTest, LongHost) {
+  Matcher matcher(Matcher::Type::Suffix);
+  EXPECT_TRUE(matcher.add(".foo.com", value("*.foo.com")));
+  EXPECT_EQ("*.foo.com", find(matcher, std::string(512, 'a') + ".foo.com"));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
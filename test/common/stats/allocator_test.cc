@@ -84,6 +84,54 @@ TEST_F(AllocatorTest, GaugesWithSameName) {
   EXPECT_EQ(0, g2->value());
 }
 
+// A sharded counter behaves like a plain one, with its slots summed on read and latch.
+TEST_F(AllocatorTest, ShardedCounter) {
+  StatName counter_name = makeStat("counter.name");
+  CounterSharedPtr c1 = alloc_.makeCounter(counter_name, StatName(), {}, true);
+  EXPECT_FALSE(c1->used());
+  c1->inc();
+  c1->add(4);
+  EXPECT_TRUE(c1->used());
+  EXPECT_EQ(5, c1->value());
+  EXPECT_EQ(5, c1->latch());
+  EXPECT_EQ(0, c1->latch());
+  EXPECT_EQ(5, c1->value());
+
+  // Looking the counter up again returns the existing counter, whatever the sharding requested.
+  CounterSharedPtr c2 = alloc_.makeCounter(counter_name, StatName(), {}, false);
+  EXPECT_EQ(c1.get(), c2.get());
+  c1->markUnused();
+  EXPECT_FALSE(c2->used());
+  c2->reset();
+  EXPECT_EQ(0, c1->value());
+}
+
+// Increments from many threads land in different slots and are all accounted for.
+TEST_F(AllocatorTest, ShardedCounterConcurrentIncrements) {
+  StatName counter_name = makeStat("counter.name");
+  CounterSharedPtr counter = alloc_.makeCounter(counter_name, StatName(), {}, true);
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+
+  const uint32_t num_threads = 12;
+  const uint32_t iters = 10000;
+  std::vector<Thread::ThreadPtr> threads;
+  absl::Notification go;
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([&]() {
+      go.WaitForNotification();
+      for (uint32_t i = 0; i < iters; ++i) {
+        counter->inc();
+      }
+    }));
+  }
+  go.Notify();
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads[i]->join();
+  }
+  EXPECT_EQ(num_threads * iters, counter->value());
+  EXPECT_EQ(num_threads * iters, counter->latch());
+}
+
 // Test for a race-condition where we may decrement the ref-count of a stat to
 // zero at the same time as we are allocating another instance of that
 // stat. This test reproduces that race organically by having a 12 threads each
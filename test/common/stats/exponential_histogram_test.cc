@@ -0,0 +1,111 @@
+#include <cmath>
+#include <numeric>
+
+#include "source/common/stats/exponential_histogram.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+namespace ExponentialHistogram {
+namespace {
+
+uint64_t totalCount(const Buckets& buckets) {
+  return std::accumulate(buckets.counts_.begin(), buckets.counts_.end(), buckets.zero_count_);
+}
+
+TEST(ExponentialHistogramTest, ZeroThreshold) {
+  EXPECT_EQ(0.5, zeroThreshold(Histogram::Unit::Milliseconds));
+  EXPECT_EQ(0.5 / Histogram::PercentScale, zeroThreshold(Histogram::Unit::Percent));
+}
+
+TEST(ExponentialHistogramTest, BucketIndexIsUpperInclusive) {
+  // At scale 0 the buckets are (0.5, 1], (1, 2], (2, 4], ...
+  EXPECT_EQ(-1, bucketIndex(1.0, 0));
+  EXPECT_EQ(0, bucketIndex(1.5, 0));
+  EXPECT_EQ(0, bucketIndex(2.0, 0));
+  EXPECT_EQ(1, bucketIndex(3.0, 0));
+  EXPECT_EQ(-2, bucketIndex(0.5, 0));
+
+  // Powers of two are exact boundaries at every scale.
+  EXPECT_EQ(63, bucketIndex(16.0, 4));
+  EXPECT_EQ(64, bucketIndex(16.001, 4));
+  EXPECT_EQ(0, bucketIndex(16.0, -2));
+  EXPECT_EQ(1, bucketIndex(17.0, -2));
+}
+
+TEST(ExponentialHistogramTest, BucketIndexMatchesBoundaries) {
+  for (int8_t scale = MinScale; scale <= DefaultScale; ++scale) {
+    for (double value = 0.75; value < 1e7; value *= 1.37) {
+      const int32_t index = bucketIndex(value, scale);
+      EXPECT_LT(std::exp2(std::ldexp(static_cast<double>(index), -scale)), value);
+      EXPECT_GE(std::exp2(std::ldexp(static_cast<double>(index + 1), -scale)), value);
+    }
+  }
+}
+
+TEST(ExponentialHistogramTest, Empty) {
+  const Buckets buckets = fromDetailedBuckets({}, 20, 0.5);
+  EXPECT_EQ(DefaultScale, buckets.scale_);
+  EXPECT_EQ(0, buckets.zero_count_);
+  EXPECT_TRUE(buckets.counts_.empty());
+}
+
+TEST(ExponentialHistogramTest, OnlyZeros) {
+  const Buckets buckets = fromDetailedBuckets({{0.0, 0.0, 7}}, 20, 0.5);
+  EXPECT_EQ(7, buckets.zero_count_);
+  EXPECT_TRUE(buckets.counts_.empty());
+}
+
+TEST(ExponentialHistogramTest, KeepsDefaultScaleWhenBucketsFit) {
+  const std::vector<ParentHistogram::Bucket> detailed = {
+      {0.0, 0.0, 3}, {10.0, 1.0, 2}, {11.0, 1.0, 4}, {12.0, 1.0, 1}};
+  const Buckets buckets = fromDetailedBuckets(detailed, 20, 0.5);
+  EXPECT_EQ(DefaultScale, buckets.scale_);
+  EXPECT_EQ(3, buckets.zero_count_);
+  EXPECT_EQ(bucketIndex(10.0, DefaultScale), buckets.offset_);
+  ASSERT_EQ(bucketIndex(12.0, DefaultScale) - buckets.offset_ + 1, buckets.counts_.size());
+  EXPECT_EQ(2, buckets.counts_.front());
+  EXPECT_EQ(1, buckets.counts_.back());
+  EXPECT_EQ(10, totalCount(buckets));
+}
+
+TEST(ExponentialHistogramTest, ReducesScaleToFitMaxBuckets) {
+  const std::vector<ParentHistogram::Bucket> detailed = {{1.5, 0.1, 1}, {1000.0, 100.0, 2}};
+  const Buckets buckets = fromDetailedBuckets(detailed, 20, 0.5);
+  // At scale 4 these are 151 buckets apart; each scale reduction halves that.
+  EXPECT_EQ(1, buckets.scale_);
+  EXPECT_EQ(bucketIndex(1.5, 1), buckets.offset_);
+  ASSERT_EQ(bucketIndex(1000.0, 1) - buckets.offset_ + 1, buckets.counts_.size());
+  EXPECT_LE(buckets.counts_.size(), 20);
+  EXPECT_EQ(1, buckets.counts_.front());
+  EXPECT_EQ(2, buckets.counts_.back());
+}
+
+TEST(ExponentialHistogramTest, StopsAtMinScale) {
+  const std::vector<ParentHistogram::Bucket> detailed = {{1.0, 0.1, 1}, {1e12, 1e11, 1}};
+  const Buckets buckets = fromDetailedBuckets(detailed, 1, 0.5);
+  EXPECT_EQ(MinScale, buckets.scale_);
+  EXPECT_EQ(bucketIndex(1.0, MinScale), buckets.offset_);
+  EXPECT_EQ(bucketIndex(1e12, MinScale) - buckets.offset_ + 1, buckets.counts_.size());
+  EXPECT_EQ(2, totalCount(buckets));
+}
+
+TEST(ExponentialHistogramTest, ConcatenatedBucketsMerge) {
+  const std::vector<ParentHistogram::Bucket> first = {{0.0, 0.0, 1}, {5.0, 1.0, 2}};
+  const std::vector<ParentHistogram::Bucket> second = {{5.0, 1.0, 3}, {40.0, 1.0, 4}};
+  std::vector<ParentHistogram::Bucket> merged = first;
+  merged.insert(merged.end(), second.begin(), second.end());
+
+  const Buckets buckets = fromDetailedBuckets(merged, 20, 0.5);
+  EXPECT_EQ(1, buckets.zero_count_);
+  EXPECT_EQ(bucketIndex(5.0, buckets.scale_), buckets.offset_);
+  EXPECT_EQ(5, buckets.counts_.front());
+  EXPECT_EQ(4, buckets.counts_.back());
+  EXPECT_EQ(10, totalCount(buckets));
+}
+
+} // namespace
+} // namespace ExponentialHistogram
+} // namespace Stats
+} // namespace Envoy
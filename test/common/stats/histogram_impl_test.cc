@@ -18,11 +18,13 @@ public:
     for (auto& item : buckets_configs_) {
       bucket_settings.Add(std::move(item));
     }
+    config.set_histogram_merge_threads(merge_threads_);
     settings_ = std::make_unique<HistogramSettingsImpl>(config, context_);
   }
 
   NiceMock<Server::Configuration::MockServerFactoryContext> context_;
   std::vector<envoy::config::metrics::v3::HistogramBucketSettings> buckets_configs_;
+  uint32_t merge_threads_{0};
   std::unique_ptr<HistogramSettingsImpl> settings_;
 };
 
@@ -41,6 +43,15 @@ TEST_F(HistogramSettingsImplTest, Basic) {
 }
 
 // Test that buckets are correctly sorted.
+TEST_F(HistogramSettingsImplTest, MergeThreads) {
+  EXPECT_EQ(0, HistogramSettingsImpl().mergeThreads());
+  initialize();
+  EXPECT_EQ(0, settings_->mergeThreads());
+  merge_threads_ = 4;
+  initialize();
+  EXPECT_EQ(4, settings_->mergeThreads());
+}
+
 TEST_F(HistogramSettingsImplTest, Sorted) {
   envoy::config::metrics::v3::HistogramBucketSettings setting;
   setting.mutable_match()->set_exact("a");
@@ -0,0 +1,53 @@
+// Measures the throughput of incrementing one hot counter from many threads at once, with the
+// counter stored in a single atomic and sharded into per thread slots.
+
+#include <memory>
+
+#include "source/common/stats/allocator.h"
+#include "source/common/stats/symbol_table.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Stats {
+namespace {
+
+struct CounterContext {
+  explicit CounterContext(bool sharded)
+      : pool_(symbol_table_), alloc_(symbol_table_),
+        counter_(alloc_.makeCounter(pool_.add("http.ingress.downstream_rq_total"), StatName(), {},
+                                    sharded)) {}
+  ~CounterContext() {
+    counter_.reset();
+    pool_.clear();
+  }
+
+  SymbolTableImpl symbol_table_;
+  StatNamePool pool_;
+  Allocator alloc_;
+  CounterSharedPtr counter_;
+};
+
+std::unique_ptr<CounterContext> context;
+
+// Each of state.threads() workers increments the same counter, which is sharded if state.range(0)
+// is non-zero. The counter is latched and read at the end, as a stats flush would.
+void bmIncrementCounter(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    context = std::make_unique<CounterContext>(state.range(0) != 0);
+  }
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    context->counter_->inc();
+  }
+  if (state.thread_index() == 0) {
+    benchmark::DoNotOptimize(context->counter_->latch());
+    benchmark::DoNotOptimize(context->counter_->value());
+    context.reset();
+  }
+}
+
+BENCHMARK(bmIncrementCounter)->Arg(0)->Arg(1)->ThreadRange(1, 64)->UseRealTime();
+
+} // namespace
+} // namespace Stats
+} // namespace Envoy
@@ -327,7 +327,6 @@ TEST_F(StatNameTest, TestSuccessfulDecode) {
 class StatNameDeathTest : public StatNameTest {
 public:
   void decodeSymbolVec(const SymbolVec& symbol_vec) {
-    Thread::LockGuard lock(table_.lock_);
     for (Symbol symbol : symbol_vec) {
       table_.fromSymbol(symbol);
     }
@@ -663,20 +662,10 @@ TEST_F(StatNameTest, RacingSymbolCreation) {
   access.setReady();
   accesses.Wait();
 
-  // In a perfect world, we could use reader-locks in the SymbolTable
-  // implementation, and there should be zero additional contentions
-  // after latching 'create_contentions' above. And we can definitely
-  // have this world, but this slows down BM_CreateRace in
-  // symbol_table_speed_test.cc, even on a 72-core machine.
-  //
-  // Thus it is better to avoid symbol-table contention by refactoring
-  // all stat-creation code to symbolize all stat string elements at
-  // construction, as composition does not require a lock.
-  //
-  // See this commit
-  // https://github.com/envoyproxy/envoy/pull/5321/commits/ef712d0f5a11ff49831c1935e8a2ef8a0a935bc9
-  // for a working reader-lock implementation, which would pass this EXPECT:
-  //     EXPECT_EQ(create_contentions, mutex_tracer.numContentions());
+  // Encoding symbols that already exist only takes the reader lock of each
+  // token's shard, so readers don't wait for each other. We don't EXPECT
+  // that the number of contentions is unchanged though, as the threads
+  // holding 'initial' may still be finishing up when access starts.
   //
   // Note also that we cannot guarantee there *will* be contentions
   // as a machine or OS is free to run all threads serially.
@@ -731,20 +720,10 @@ TEST_F(StatNameTest, MutexContentionOnExistingSymbols) {
   access.setReady();
   accesses.Wait();
 
-  // In a perfect world, we could use reader-locks in the SymbolTable
-  // implementation, and there should be zero additional contentions
-  // after latching 'create_contentions' above. And we can definitely
-  // have this world, but this slows down BM_CreateRace in
-  // symbol_table_speed_test.cc, even on a 72-core machine.
-  //
-  // Thus it is better to avoid symbol-table contention by refactoring
-  // all stat-creation code to symbolize all stat string elements at
-  // construction, as composition does not require a lock.
-  //
-  // See this commit
-  // https://github.com/envoyproxy/envoy/pull/5321/commits/ef712d0f5a11ff49831c1935e8a2ef8a0a935bc9
-  // for a working reader-lock implementation, which would pass this EXPECT:
-  //     EXPECT_EQ(create_contentions, mutex_tracer.numContentions());
+  // Encoding symbols that already exist only takes the reader lock of each
+  // token's shard, so readers don't wait for each other. We don't EXPECT
+  // that the number of contentions is unchanged though, as the threads
+  // holding 'initial' may still be finishing up when access starts.
   //
   // Note also that we cannot guarantee there *will* be contentions
   // as a machine or OS is free to run all threads serially.
@@ -755,6 +734,48 @@ TEST_F(StatNameTest, MutexContentionOnExistingSymbols) {
   }
 }
 
+// Creates and frees overlapping names from many threads at once, so that
+// symbols are concurrently added, shared, released and recycled.
+TEST_F(StatNameTest, RacingSymbolCreationAndFree) {
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+  constexpr int num_threads = 16;
+  std::vector<Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  ConditionalInitializer start;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([this, i, &start]() {
+      start.wait();
+      for (int j = 0; j < 1000; ++j) {
+        const std::string name = absl::StrCat("cluster.c", j % 50, ".thread", i % 4, ".rq");
+        StatNameStorage storage(name, table_);
+        EXPECT_EQ(name, table_.toString(storage.statName()));
+        storage.free(table_);
+      }
+    }));
+  }
+  start.setReady();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(0, table_.numSymbols());
+}
+
+// Exercises growth of the table mapping symbols back to their strings.
+TEST_F(StatNameTest, ManySymbols) {
+  constexpr int num_names = 5000;
+  std::vector<StatName> names;
+  names.reserve(num_names);
+  for (int i = 0; i < num_names; ++i) {
+    names.push_back(makeStat(absl::StrCat("token", i)));
+  }
+  EXPECT_EQ(num_names, table_.numSymbols());
+  for (int i = 0; i < num_names; ++i) {
+    EXPECT_EQ(absl::StrCat("token", i), table_.toString(names[i]));
+  }
+  clearStorage();
+  EXPECT_EQ(0, table_.numSymbols());
+}
+
 TEST_F(StatNameTest, SharedStatNameStorageSetInsertAndFind) {
   StatNameStorageSet set;
   const int iters = 10;
@@ -1041,6 +1062,9 @@ TEST(SymbolTableTest, Memory) {
   // Make sure we don't regress.
   // Data as of 2019/05/29:
   // symbol_table_mem_used:  1726056 (3.9x) -- does not seem to depend on STL sizes.
+  // The encode map has since been sharded and the decode map replaced with a chunked array, and
+  // the exact value below predates that: it has to be re-measured in a CI release build, the only
+  // configuration where EXPECT_MEMORY_EQ is checked.
   EXPECT_MEMORY_LE(symbol_table_mem_used, string_mem_used / 3);
   EXPECT_MEMORY_EQ(symbol_table_mem_used, 1726056);
 }
@@ -15,6 +15,7 @@
 #include "test/common/stats/make_elements_helper.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "benchmark/benchmark.h"
 
@@ -65,6 +66,61 @@ static void bmCreateRace(benchmark::State& state) {
 }
 BENCHMARK(bmCreateRace)->Unit(::benchmark::kMillisecond);
 
+static Envoy::Stats::SymbolTableImpl* shared_symbol_table;
+static Envoy::Stats::StatNamePool* shared_pool;
+static std::vector<std::string>* shared_names;
+
+// Encodes and frees names whose symbols all exist already, from state.threads()
+// threads, as workers do when creating dynamic stats for known clusters.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmEncodeExistingSymbols(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    shared_symbol_table = new Envoy::Stats::SymbolTableImpl;
+    shared_pool = new Envoy::Stats::StatNamePool(*shared_symbol_table);
+    shared_names = new std::vector<std::string>;
+    for (int i = 0; i < 1000; ++i) {
+      shared_names->push_back(absl::StrCat("cluster.c", i, ".upstream_rq_total"));
+      shared_pool->add(shared_names->back());
+    }
+  }
+  uint32_t index = state.thread_index() * 97;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    Envoy::Stats::StatNameStorage storage((*shared_names)[index++ % shared_names->size()],
+                                          *shared_symbol_table);
+    storage.free(*shared_symbol_table);
+  }
+  if (state.thread_index() == 0) {
+    delete shared_pool;
+    delete shared_names;
+    delete shared_symbol_table;
+  }
+}
+BENCHMARK(bmEncodeExistingSymbols)->ThreadRange(1, 16)->UseRealTime();
+
+// Each of state.threads() threads encodes and frees names with tokens no other
+// thread uses, so every iteration adds and removes a symbol.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmCreateDistinctSymbols(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    shared_symbol_table = new Envoy::Stats::SymbolTableImpl;
+  }
+  std::vector<std::string> names;
+  for (int i = 0; i < 100; ++i) {
+    names.push_back(absl::StrCat("cluster.t", state.thread_index(), "_c", i, ".upstream_rq"));
+  }
+  uint32_t index = 0;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    Envoy::Stats::StatNameStorage storage(names[index++ % names.size()], *shared_symbol_table);
+    storage.free(*shared_symbol_table);
+  }
+  if (state.thread_index() == 0) {
+    delete shared_symbol_table;
+  }
+}
+BENCHMARK(bmCreateDistinctSymbols)->ThreadRange(1, 16)->UseRealTime();
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void bmJoinStatNames(benchmark::State& state) {
   Envoy::Stats::SymbolTableImpl symbol_table;
@@ -46,6 +46,7 @@
 #include "source/common/config/well_known_names.h"
 #include "source/common/stats/tag_producer_impl.h"
 
+#include "absl/strings/str_cat.h"
 #include "benchmark/benchmark.h"
 
 namespace Envoy {
@@ -108,6 +109,31 @@ void BM_ExtractTags(benchmark::State& state) {
 }
 BENCHMARK(BM_ExtractTags)->DenseRange(0, 26, 1);
 
+// Extracts the tags of all the names above, with state.range(0) user-supplied regexes, none of
+// which match, on top of the default extractors. The prefilter matches all the regexes in one
+// scan of each name, so this should scale much better than applying every regex.
+// NOLINTNEXTLINE(readability-identifier-naming)
+void BM_ExtractTagsCustomRegexes(benchmark::State& state) {
+  envoy::config::metrics::v3::StatsConfig config;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    auto& specifier = *config.mutable_stats_tags()->Add();
+    specifier.set_tag_name(absl::StrCat("custom_", i));
+    specifier.set_regex(absl::StrCat("\\.(custom_", i, "_(\\w+))$"));
+  }
+  auto tag_extractors = TagProducerImpl::createTagProducer(config, {}).value();
+
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    for (const auto& p : params) {
+      TagVector tags;
+      tag_extractors->produceTags(std::get<0>(p), tags);
+      RELEASE_ASSERT(tags.size() == std::get<1>(p),
+                     absl::StrCat("tags.size()=", tags.size(), " tags_size==", std::get<1>(p)));
+    }
+  }
+}
+BENCHMARK(BM_ExtractTagsCustomRegexes)->Arg(0)->Arg(10)->Arg(100);
+
 } // namespace
 } // namespace Stats
 } // namespace Envoy
@@ -139,6 +139,31 @@ TEST_F(TagProducerTest, Fixed) {
   checkTags(tag_config, tags);
 }
 
+// Extractors whose regex RE2 cannot parse are left out of the prefilter and still applied, and
+// names that are not ASCII bypass the prefilter.
+TEST_F(TagProducerTest, Prefilter) {
+  stats_config_.mutable_use_all_default_tags()->set_value(false);
+  // ECMAScript lookahead, which RE2 does not support.
+  addSpecifier("lookahead", "^(?=[a-z]+\\.)(\\w+\\.)");
+  addSpecifier("word", "\\.(word_(\\w+))$");
+  addSpecifier("dot", "^A(\\.(..)\\.)c");
+  auto producer = TagProducerImpl::createTagProducer(stats_config_, {}).value();
+
+  TagVector tags;
+  EXPECT_EQ("other", producer->produceTags("xyz.other", tags));
+  checkTags(TagVector{{"lookahead", "xyz."}}, tags);
+
+  tags.clear();
+  EXPECT_EQ("Abc.", producer->produceTags("Abc.word_y", tags));
+  checkTags(TagVector{{"word", "y"}}, tags);
+
+  // The two bytes of "\xc3\xa9" each match a "." of the ECMAScript regex, while RE2 would see a
+  // single character.
+  tags.clear();
+  EXPECT_EQ("Ac", producer->produceTags("A.\xc3\xa9.c", tags));
+  checkTags(TagVector{{"dot", "\xc3\xa9"}}, tags);
+}
+
 // Test that fixed tags both from cli and from stats_config are returned from `fixedTags()`.
 TEST_F(TagProducerTest, FixedTags) {
   const TagVector tag_config{{"my-tag", "fixed"}};
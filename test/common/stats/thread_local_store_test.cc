@@ -27,8 +27,10 @@
 #include "test/mocks/stats/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/logging.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_split.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -1412,6 +1414,26 @@ TEST_F(StatsMatcherTLSTest, TestExclusionRegex) {
   EXPECT_EQ("", invalid_string_2.value());
 }
 
+// Counters selected by the sharded counter matcher are created sharded, and otherwise behave as
+// the rest.
+TEST_F(StatsMatcherTLSTest, ShardedCounters) {
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+  envoy::config::metrics::v3::StatsMatcher sharded_counters;
+  sharded_counters.mutable_inclusion_list()->add_patterns()->set_suffix("rq_total");
+  store_->setShardedCounterMatcher(
+      std::make_unique<StatsMatcherImpl>(sharded_counters, symbol_table_, context_));
+
+  Counter& sharded = scope_.counterFromString("downstream_rq_total");
+  Counter& plain = scope_.counterFromString("downstream_cx_total");
+  sharded.add(3);
+  plain.add(2);
+  EXPECT_EQ(3, sharded.value());
+  EXPECT_EQ(3, sharded.latch());
+  EXPECT_EQ(2, plain.latch());
+  EXPECT_EQ(&sharded, &scope_.counterFromString("downstream_rq_total"));
+  EXPECT_EQ(3, TestUtility::findCounter(*store_, "downstream_rq_total")->value());
+}
+
 // Rejecting stats of the form "cluster." enables an optimization in the matcher
 // infrastructure that performs the rejection without converting from StatName
 // to string, obviating the need to memoize the rejection in a set. This saves
@@ -1972,6 +1994,7 @@ TEST_F(StatsThreadLocalStoreTestNoFixture, MemoryWithoutTlsRealSymbolTable) {
   Memory::TestUtil::MemoryTest memory_test;
   TestUtil::forEachSampleStat(
       100, true, [this](absl::string_view name) { scope_.counterFromString(std::string(name)); });
+  // Measured before the symbol table was sharded, to be re-measured in a CI release build.
   EXPECT_MEMORY_EQ(memory_test.consumedBytes(), 688080); // July 2, 2020
   EXPECT_MEMORY_LE(memory_test.consumedBytes(), 0.85 * million_);
 }
@@ -1981,6 +2004,7 @@ TEST_F(StatsThreadLocalStoreTestNoFixture, MemoryWithTlsRealSymbolTable) {
   Memory::TestUtil::MemoryTest memory_test;
   TestUtil::forEachSampleStat(
       100, true, [this](absl::string_view name) { scope_.counterFromString(std::string(name)); });
+  // Measured before the symbol table was sharded, to be re-measured in a CI release build.
   EXPECT_MEMORY_EQ(memory_test.consumedBytes(), 827616); // Sep 25, 2020
   EXPECT_MEMORY_LE(memory_test.consumedBytes(), 0.99 * million_);
 }
@@ -2114,6 +2138,78 @@ TEST_F(HistogramTest, MultiHistogramMultipleMerges) {
   EXPECT_EQ(2, validateMerge());
 }
 
+// Histograms that recorded nothing since the last merge skip it, which must leave both their
+// interval and cumulative statistics as they would have been after a full merge.
+TEST_F(HistogramTest, IdleHistogramMerges) {
+  Histogram& h1 = scope_.histogramFromString("h1", Histogram::Unit::Unspecified);
+  Histogram& h2 = scope_.histogramFromString("h2", Histogram::Unit::Unspecified);
+
+  expectCallAndAccumulate(h1, 5);
+  expectCallAndAccumulate(h2, 7);
+  EXPECT_EQ(2, validateMerge());
+
+  // Both idle for several intervals.
+  EXPECT_EQ(2, validateMerge());
+  EXPECT_EQ(2, validateMerge());
+  EXPECT_EQ(2, validateMerge());
+
+  // Only one recording again.
+  expectCallAndAccumulate(h1, 11);
+  EXPECT_EQ(2, validateMerge());
+  EXPECT_EQ(2, validateMerge());
+  expectCallAndAccumulate(h2, 13);
+  EXPECT_EQ(2, validateMerge());
+}
+
+TEST(HistogramMergeThreadsTest, MergesOnHelperThreads) {
+  SymbolTableImpl symbol_table;
+  Allocator alloc(symbol_table);
+  NiceMock<Event::MockDispatcher> main_thread_dispatcher;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+  ThreadLocalStoreImpl store(alloc, Thread::threadFactoryForTest());
+  envoy::config::metrics::v3::StatsConfig config;
+  config.set_histogram_merge_threads(3);
+  store.setHistogramSettings(std::make_unique<HistogramSettingsImpl>(config, context));
+  store.initializeThreading(main_thread_dispatcher, tls);
+
+  // Enough histograms to be merged in several chunks, of which only the even ones record values.
+  constexpr uint32_t NumHistograms = 2000;
+  for (uint32_t i = 0; i < NumHistograms; ++i) {
+    Histogram& histogram = store.rootScope()->histogramFromString(absl::StrCat("h", i),
+                                                                  Histogram::Unit::Unspecified);
+    if (i % 2 == 0) {
+      histogram.recordValue(i);
+    }
+  }
+
+  for (int merge = 0; merge < 2; ++merge) {
+    bool merge_called = false;
+    store.mergeHistograms([&merge_called]() -> void { merge_called = true; });
+    EXPECT_TRUE(merge_called);
+
+    const std::vector<ParentHistogramSharedPtr> histograms = store.histograms();
+    EXPECT_EQ(NumHistograms, histograms.size());
+    for (const ParentHistogramSharedPtr& histogram : histograms) {
+      uint32_t index;
+      ASSERT_TRUE(absl::SimpleAtoi(histogram->name().substr(1), &index));
+      if (index % 2 == 0) {
+        EXPECT_TRUE(histogram->used());
+        EXPECT_EQ(1, histogram->cumulativeStatistics().sampleCount());
+        // Values were only recorded in the first interval.
+        EXPECT_EQ(merge == 0 ? 1 : 0, histogram->intervalStatistics().sampleCount());
+      } else {
+        EXPECT_FALSE(histogram->used());
+        EXPECT_EQ(0, histogram->cumulativeStatistics().sampleCount());
+      }
+    }
+  }
+
+  tls.shutdownGlobalThreading();
+  store.shutdownThreading();
+  tls.shutdownThread();
+}
+
 TEST_F(HistogramTest, BasicScopeHistogramMerge) {
   ScopeSharedPtr scope1 = store_->createScope("scope1.");
 
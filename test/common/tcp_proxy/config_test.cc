@@ -154,6 +154,23 @@ TEST(ConfigTest, DEPRECATED_FEATURE_TEST(DeprecatedFlushAccessLogOnConnected)) {
   }
 }
 
+TEST(ConfigTest, EnableSplice) {
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  const std::string yaml = R"EOF(
+    stat_prefix: name
+    cluster: foo
+    enable_splice: true
+  )EOF";
+
+#if defined(__linux__)
+  Config config_obj(constructConfigFromYaml(yaml, factory_context));
+  EXPECT_TRUE(config_obj.splicePipePool().has_value());
+#else
+  EXPECT_THROW_WITH_MESSAGE(Config config_obj(constructConfigFromYaml(yaml, factory_context)),
+                            EnvoyException, "tcp_proxy: enable_splice is only supported on Linux");
+#endif
+}
+
 TEST(ConfigTest, AccessLogFlushInterval) {
   NiceMock<Server::Configuration::MockFactoryContext> factory_context;
 
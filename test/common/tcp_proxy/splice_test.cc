@@ -0,0 +1,253 @@
+#include <memory>
+
+#include "source/common/tcp_proxy/splice.h"
+
+#include "test/mocks/api/mocks.h"
+#include "test/mocks/network/io_handle.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::DoDefault;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace TcpProxy {
+namespace {
+
+#if defined(__linux__)
+
+class SplicePipePoolTest : public testing::Test {
+public:
+  SplicePipePoolTest() {
+    // Hand out pipes with consecutive descriptors: {10, 11}, {12, 13}, ...
+    ON_CALL(linux_os_sys_calls_, pipe2(_, _)).WillByDefault(Invoke([this](int pipefd[2], int) {
+      pipefd[0] = next_fd_++;
+      pipefd[1] = next_fd_++;
+      return Api::SysCallIntResult{0, 0};
+    }));
+  }
+
+  int next_fd_{10};
+  NiceMock<Api::MockOsSysCalls> os_sys_calls_;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls_{&os_sys_calls_};
+  NiceMock<Api::MockLinuxOsSysCalls> linux_os_sys_calls_;
+  TestThreadsafeSingletonInjector<Api::LinuxOsSysCallsImpl> linux_os_calls_{&linux_os_sys_calls_};
+};
+
+// Running out of descriptors makes the caller fall back to the buffered path.
+TEST_F(SplicePipePoolTest, AcquireFailsWhenPipesAreExhausted) {
+  SplicePipePool pool(4);
+  EXPECT_CALL(linux_os_sys_calls_, pipe2(_, _)).WillOnce(Return(Api::SysCallIntResult{-1, EMFILE}));
+  EXPECT_FALSE(pool.acquire().has_value());
+  EXPECT_EQ(0, pool.idlePipes());
+}
+
+// Empty pipes are pooled up to the limit and handed out again without a new pipe2() call.
+TEST_F(SplicePipePoolTest, ReleaseReusesEmptyPipes) {
+  SplicePipePool pool(1);
+  EXPECT_CALL(linux_os_sys_calls_, pipe2(_, _)).Times(2);
+  absl::optional<SplicePipe> first = pool.acquire();
+  absl::optional<SplicePipe> second = pool.acquire();
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+
+  pool.release(first.value(), true);
+  EXPECT_EQ(1, pool.idlePipes());
+
+  // The pool is full, so the second pipe is closed.
+  EXPECT_CALL(os_sys_calls_, close(12));
+  EXPECT_CALL(os_sys_calls_, close(13));
+  pool.release(second.value(), true);
+  EXPECT_EQ(1, pool.idlePipes());
+
+  absl::optional<SplicePipe> reused = pool.acquire();
+  ASSERT_TRUE(reused.has_value());
+  EXPECT_EQ(10, reused->read_fd_);
+  EXPECT_EQ(11, reused->write_fd_);
+  EXPECT_EQ(0, pool.idlePipes());
+
+  // Pipes still in the pool are closed with it.
+  pool.release(reused.value(), true);
+  EXPECT_CALL(os_sys_calls_, close(10));
+  EXPECT_CALL(os_sys_calls_, close(11));
+}
+
+// A pipe that still holds bytes must never be handed to another connection.
+TEST_F(SplicePipePoolTest, ReleaseClosesPipesWithData) {
+  SplicePipePool pool(4);
+  EXPECT_CALL(linux_os_sys_calls_, pipe2(_, _));
+  absl::optional<SplicePipe> pipe = pool.acquire();
+  ASSERT_TRUE(pipe.has_value());
+
+  EXPECT_CALL(os_sys_calls_, close(10));
+  EXPECT_CALL(os_sys_calls_, close(11));
+  pool.release(pipe.value(), false);
+  EXPECT_EQ(0, pool.idlePipes());
+}
+
+class MockSpliceForwarderCallbacks : public SpliceForwarderCallbacks {
+public:
+  MOCK_METHOD(void, onSplicedBytes, (bool downstream_to_upstream, uint64_t bytes));
+  MOCK_METHOD(void, onSpliceComplete, ());
+  MOCK_METHOD(void, onSpliceError, ());
+};
+
+class SpliceForwarderTest : public SplicePipePoolTest {
+public:
+  static constexpr int DownstreamFd = 100;
+  static constexpr int UpstreamFd = 200;
+  // Pipe descriptors handed out by pipe2(): the downstream to upstream pipe is {10, 11} and the
+  // upstream to downstream pipe is {12, 13}.
+  static constexpr int ToUpstreamPipeRead = 10;
+  static constexpr int ToUpstreamPipeWrite = 11;
+  static constexpr int ToDownstreamPipeWrite = 13;
+
+  SpliceForwarderTest() {
+    setUpConnection(downstream_, downstream_socket_, downstream_handle_, downstream_duplicate_,
+                    DownstreamFd);
+    setUpConnection(upstream_, upstream_socket_, upstream_handle_, upstream_duplicate_, UpstreamFd);
+  }
+
+  // The forwarder watches a duplicate of the connection's handle, which reports the given fd.
+  void setUpConnection(NiceMock<Network::MockConnection>& connection,
+                       Network::ConnectionSocketPtr& socket,
+                       NiceMock<Network::MockIoHandle>& handle,
+                       Network::IoHandlePtr& duplicate_slot, os_fd_t fd) {
+    auto mock_socket = std::make_unique<NiceMock<Network::MockConnectionSocket>>();
+    ON_CALL(*mock_socket, ioHandle()).WillByDefault(ReturnRef(handle));
+    socket = std::move(mock_socket);
+    ON_CALL(connection, getSocket()).WillByDefault(ReturnRef(socket));
+
+    auto duplicate = std::make_unique<NiceMock<Network::MockIoHandle>>();
+    ON_CALL(*duplicate, isOpen()).WillByDefault(Return(true));
+    ON_CALL(*duplicate, fdDoNotUse()).WillByDefault(Return(fd));
+    ON_CALL(*duplicate, close()).WillByDefault(Invoke([]() {
+      return Api::ioCallUint64ResultNoError();
+    }));
+    // Both duplicates share the same callback, so remember either of them.
+    ON_CALL(*duplicate, createFileEvent_(_, _, _, _)).WillByDefault(SaveArg<1>(&file_event_cb_));
+    duplicate_slot = std::move(duplicate);
+    ON_CALL(handle, duplicate()).WillByDefault(Invoke([&duplicate_slot]() {
+      return std::move(duplicate_slot);
+    }));
+  }
+
+  void createForwarder() {
+    forwarder_ = SpliceForwarder::create(pool_, downstream_, upstream_, callbacks_);
+    ASSERT_NE(nullptr, forwarder_);
+  }
+
+  void fileEvent() { ASSERT_TRUE(file_event_cb_(Event::FileReadyType::Read).ok()); }
+
+  static Api::SysCallSizeResult again() { return {-1, EAGAIN}; }
+
+  SplicePipePool pool_{4};
+  NiceMock<Network::MockConnection> downstream_;
+  NiceMock<Network::MockConnection> upstream_;
+  Network::ConnectionSocketPtr downstream_socket_;
+  Network::ConnectionSocketPtr upstream_socket_;
+  NiceMock<Network::MockIoHandle> downstream_handle_;
+  NiceMock<Network::MockIoHandle> upstream_handle_;
+  Network::IoHandlePtr downstream_duplicate_;
+  Network::IoHandlePtr upstream_duplicate_;
+  Event::FileReadyCb file_event_cb_;
+  MockSpliceForwarderCallbacks callbacks_;
+  SpliceForwarderPtr forwarder_;
+};
+
+// The second pipe can not be created, so the first one goes back to the pool and the caller keeps
+// using the buffered path.
+TEST_F(SpliceForwarderTest, CreateFailsWhenPipesAreExhausted) {
+  EXPECT_CALL(linux_os_sys_calls_, pipe2(_, _))
+      .WillOnce(DoDefault())
+      .WillOnce(Return(Api::SysCallIntResult{-1, ENFILE}));
+  // The descriptors are only duplicated once both pipes are available.
+  EXPECT_CALL(downstream_handle_, duplicate()).Times(0);
+  EXPECT_CALL(upstream_handle_, duplicate()).Times(0);
+  EXPECT_EQ(nullptr, SpliceForwarder::create(pool_, downstream_, upstream_, callbacks_));
+  EXPECT_EQ(1, pool_.idlePipes());
+}
+
+// EAGAIN on either socket parks the direction until the next file event without failing.
+TEST_F(SpliceForwarderTest, AgainWaitsForTheNextEvent) {
+  createForwarder();
+
+  EXPECT_CALL(linux_os_sys_calls_, splice(DownstreamFd, ToUpstreamPipeWrite, _, _))
+      .WillOnce(Return(again()));
+  EXPECT_CALL(linux_os_sys_calls_, splice(UpstreamFd, ToDownstreamPipeWrite, _, _))
+      .WillOnce(Return(again()));
+  EXPECT_CALL(callbacks_, onSpliceError()).Times(0);
+  fileEvent();
+
+  // The destination is full: the bytes stay in the pipe and the source is not read again.
+  EXPECT_CALL(linux_os_sys_calls_, splice(DownstreamFd, ToUpstreamPipeWrite, _, _))
+      .WillOnce(Return(Api::SysCallSizeResult{100, 0}));
+  EXPECT_CALL(linux_os_sys_calls_, splice(ToUpstreamPipeRead, UpstreamFd, 100, _))
+      .WillOnce(Return(again()));
+  EXPECT_CALL(linux_os_sys_calls_, splice(UpstreamFd, ToDownstreamPipeWrite, _, _))
+      .WillOnce(Return(again()));
+  fileEvent();
+
+  // Once the destination drains, the pipe is flushed before the source is read again.
+  EXPECT_CALL(linux_os_sys_calls_, splice(ToUpstreamPipeRead, UpstreamFd, 100, _))
+      .WillOnce(Return(Api::SysCallSizeResult{60, 0}));
+  EXPECT_CALL(linux_os_sys_calls_, splice(ToUpstreamPipeRead, UpstreamFd, 40, _))
+      .WillOnce(Return(Api::SysCallSizeResult{40, 0}));
+  EXPECT_CALL(callbacks_, onSplicedBytes(true, 60));
+  EXPECT_CALL(callbacks_, onSplicedBytes(true, 40));
+  EXPECT_CALL(linux_os_sys_calls_, splice(DownstreamFd, ToUpstreamPipeWrite, _, _))
+      .WillOnce(Return(again()));
+  EXPECT_CALL(linux_os_sys_calls_, splice(UpstreamFd, ToDownstreamPipeWrite, _, _))
+      .WillOnce(Return(again()));
+  fileEvent();
+
+  // Both pipes are empty, so they return to the pool.
+  forwarder_.reset();
+  EXPECT_EQ(2, pool_.idlePipes());
+}
+
+// A peer reset while bytes are in flight is reported and the dirty pipe is not reused.
+TEST_F(SpliceForwarderTest, BrokenPipeReportsError) {
+  createForwarder();
+
+  EXPECT_CALL(linux_os_sys_calls_, splice(DownstreamFd, ToUpstreamPipeWrite, _, _))
+      .WillOnce(Return(Api::SysCallSizeResult{100, 0}));
+  EXPECT_CALL(linux_os_sys_calls_, splice(ToUpstreamPipeRead, UpstreamFd, 100, _))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, EPIPE}));
+  EXPECT_CALL(callbacks_, onSplicedBytes(_, _)).Times(0);
+  EXPECT_CALL(callbacks_, onSpliceError()).WillOnce(Invoke([this]() {
+    EXPECT_CALL(os_sys_calls_, close(ToUpstreamPipeRead));
+    EXPECT_CALL(os_sys_calls_, close(ToUpstreamPipeWrite));
+    forwarder_.reset();
+  }));
+  fileEvent();
+  EXPECT_EQ(1, pool_.idlePipes());
+}
+
+// Reading from a reset source fails the same way.
+TEST_F(SpliceForwarderTest, SourceErrorReportsError) {
+  createForwarder();
+
+  EXPECT_CALL(linux_os_sys_calls_, splice(DownstreamFd, ToUpstreamPipeWrite, _, _))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, ECONNRESET}));
+  EXPECT_CALL(callbacks_, onSpliceError());
+  fileEvent();
+
+  // Further events after the error are ignored.
+  EXPECT_CALL(linux_os_sys_calls_, splice(_, _, _, _)).Times(0);
+  fileEvent();
+}
+
+#endif
+
+} // namespace
+} // namespace TcpProxy
+} // namespace Envoy
@@ -4380,6 +4380,42 @@ TEST(PrioritySet, BatchUpdateMemberCallbackFiresOnce) {
   EXPECT_EQ(50, priority_set.hostSetsPerPriority()[1]->hosts().size());
 }
 
+// Test that a host set knows whether its hosts have equal weights, and that the copies of the
+// host set made from it take that over instead of checking the hosts again.
+TEST(PrioritySet, HostWeightsAreEqual) {
+  std::shared_ptr<MockClusterInfo> info{new NiceMock<MockClusterInfo>()};
+  HostsPerLocalitySharedPtr hosts_per_locality = std::make_shared<HostsPerLocalityImpl>();
+  HostVectorSharedPtr hosts(new HostVector(
+      {makeTestHost(info, "tcp://127.0.0.1:80", 2), makeTestHost(info, "tcp://127.0.0.1:81", 2)}));
+
+  PrioritySetImpl main_priority_set;
+  main_priority_set.updateHosts(
+      0,
+      updateHostsParams(hosts, hosts_per_locality, std::make_shared<const HealthyHostVector>(*hosts),
+                        hosts_per_locality),
+      {}, *hosts, {}, absl::nullopt, absl::nullopt);
+  const HostSet& main_host_set = *main_priority_set.hostSetsPerPriority()[0];
+  EXPECT_TRUE(main_host_set.hostWeightsAreEqual());
+
+  HostVector hosts_added{makeTestHost(info, "tcp://127.0.0.1:82", 3)};
+  hosts->push_back(hosts_added.front());
+  main_priority_set.updateHosts(
+      0,
+      updateHostsParams(hosts, hosts_per_locality, std::make_shared<const HealthyHostVector>(*hosts),
+                        hosts_per_locality),
+      {}, hosts_added, {}, absl::nullopt, absl::nullopt);
+  EXPECT_FALSE(main_host_set.hostWeightsAreEqual());
+
+  // The worker copy takes the value over, even though the weights were changed in place since.
+  for (const auto& host : *hosts) {
+    host->weight(1);
+  }
+  PrioritySetImpl worker_priority_set;
+  worker_priority_set.updateHosts(0, HostSetImpl::updateHostsParams(main_host_set), {}, *hosts, {},
+                                  absl::nullopt, absl::nullopt);
+  EXPECT_FALSE(worker_priority_set.hostSetsPerPriority()[0]->hostWeightsAreEqual());
+}
+
 // Helper class used to test MainPrioritySetImpl.
 class TestMainPrioritySetImpl : public MainPrioritySetImpl {
 public:
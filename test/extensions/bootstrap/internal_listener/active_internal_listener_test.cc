@@ -177,6 +177,7 @@ TEST_F(ActiveInternalListenerTest, AcceptSocketAndCreateNetworkFilter) {
   EXPECT_CALL(filter_chain_factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
   EXPECT_CALL(listener_config_, perConnectionBufferLimitBytes());
   EXPECT_CALL(listener_config_, perConnectionBufferHighWatermarkTimeout());
+  EXPECT_CALL(listener_config_, perConnectionIdleMemoryShedTimeout());
   internal_listener_->onAccept(Network::ConnectionSocketPtr{accepted_socket});
   EXPECT_CALL(conn_handler_, decNumConnections());
   connection->close(Network::ConnectionCloseType::NoFlush);
@@ -226,6 +227,7 @@ TEST_F(ActiveInternalListenerTest, DestroyListenerCloseAllConnections) {
   EXPECT_CALL(filter_chain_factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
   EXPECT_CALL(listener_config_, perConnectionBufferLimitBytes());
   EXPECT_CALL(listener_config_, perConnectionBufferHighWatermarkTimeout());
+  EXPECT_CALL(listener_config_, perConnectionIdleMemoryShedTimeout());
   internal_listener_->onAccept(Network::ConnectionSocketPtr{accepted_socket});
 
   EXPECT_CALL(conn_handler_, decNumConnections());
@@ -312,6 +314,9 @@ public:
     std::chrono::milliseconds perConnectionBufferHighWatermarkTimeout() const override {
       return std::chrono::milliseconds::zero();
     }
+    std::chrono::milliseconds perConnectionIdleMemoryShedTimeout() const override {
+      return std::chrono::milliseconds::zero();
+    }
     std::chrono::milliseconds listenerFiltersTimeout() const override {
       return listener_filters_timeout_;
     }
@@ -1,6 +1,8 @@
 // Note: this should be run with --compilation_mode=opt, and would benefit from a
 // quiescent system with disabled cstate power management.
 
+#include <algorithm>
+
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/config/core/v3/health_check.pb.h"
 #include "envoy/config/endpoint/v3/endpoint.pb.h"
@@ -20,6 +22,7 @@
 #include "source/server/transport_socket_config_impl.h"
 
 #include "test/benchmark/main.h"
+#include "test/common/upstream/test_cluster_manager.h"
 #include "test/common/upstream/utility.h"
 #include "test/mocks/config/custom_config_validators.h"
 #include "test/mocks/local_info/mocks.h"
@@ -192,6 +195,102 @@ public:
   NiceMock<AccessLog::MockAccessLogManager> access_log_manager_;
 };
 
+// Runs an EDS cluster inside a ClusterManagerImpl, so that updates take the same path as in a
+// server: the cluster applies an update on the main thread, postThreadLocalClusterUpdate() hands
+// the membership delta to the workers, and each worker updates its copy of the host set and its
+// round robin load balancer. The mocked thread local instance runs the worker side once, on the
+// calling thread, so an update costs the main thread work plus that of one worker.
+class EdsClusterManagerSpeedTest {
+public:
+  EdsClusterManagerSpeedTest() {
+    TestUtility::loadFromYaml(R"EOF(
+      static_resources:
+        clusters:
+        - name: eds
+          connect_timeout: 0.250s
+          load_assignment:
+            cluster_name: eds
+            endpoints:
+            - lb_endpoints:
+              - endpoint:
+                  address:
+                    socket_address:
+                      address: 127.0.0.1
+                      port_value: 60000
+    )EOF",
+                              bootstrap_);
+    cluster_manager_ = TestClusterManagerImpl::createTestClusterManager(bootstrap_, factory_,
+                                                                        factory_.server_context_);
+    ON_CALL(factory_.server_context_, clusterManager())
+        .WillByDefault(testing::ReturnRef(*cluster_manager_));
+    THROW_IF_NOT_OK(cluster_manager_->initialize(bootstrap_));
+    THROW_IF_NOT_OK(cluster_manager_
+                        ->addOrUpdateCluster(parseClusterFromV3Yaml(R"EOF(
+      name: fare
+      connect_timeout: 0.25s
+      lb_policy: ROUND_ROBIN
+      eds_cluster_config:
+        service_name: fare
+        eds_config:
+          api_config_source:
+            api_type: REST
+            cluster_names:
+            - eds
+            refresh_delay: 1s
+    )EOF"),
+                                            "version1")
+                        .status());
+  }
+
+  ~EdsClusterManagerSpeedTest() { factory_.tls_.shutdownThread(); }
+
+  // Returns an EDS update for num_hosts healthy endpoints, of which the first num_changed have a
+  // different address than in the previous update.
+  Config::DecodedResourcesWrapper churnUpdate(size_t num_hosts, size_t num_changed) {
+    envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
+    cluster_load_assignment.set_cluster_name("fare");
+    auto* endpoints = cluster_load_assignment.add_endpoints();
+    auto* locality = endpoints->mutable_locality();
+    locality->set_region("region");
+    locality->set_zone("zone");
+    locality->set_sub_zone("sub_zone");
+    endpoints->mutable_load_balancing_weight()->set_value(1);
+
+    for (size_t i = 0; i < num_hosts; ++i) {
+      auto* lb_endpoint = endpoints->add_lb_endpoints();
+      lb_endpoint->set_health_status(envoy::config::core::v3::HEALTHY);
+      auto* socket_address =
+          lb_endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address();
+      if (i < num_changed) {
+        socket_address->set_address("10.1.0." + std::to_string(version_ % 256));
+        socket_address->set_port_value(1000 + i);
+      } else {
+        socket_address->set_address("10.0.1." + std::to_string(i / 60000));
+        socket_address->set_port_value((1000 + i) % 60000);
+      }
+    }
+    return TestUtility::decodeResources({cluster_load_assignment}, "cluster_name");
+  }
+
+  void deliverUpdate(const Config::DecodedResourcesWrapper& update) {
+    THROW_IF_NOT_OK(factory_.server_context_.xds_manager_.subscription_factory_.callbacks_
+                        ->onConfigUpdate(update.refvec_, fmt::format("version-{}", version_++)));
+  }
+
+  size_t workerHosts() {
+    return cluster_manager_->getThreadLocalCluster("fare")
+        ->prioritySet()
+        .hostSetsPerPriority()[0]
+        ->hosts()
+        .size();
+  }
+
+  TestClusterManagerFactory factory_;
+  envoy::config::bootstrap::v3::Bootstrap bootstrap_;
+  std::unique_ptr<TestClusterManagerImpl> cluster_manager_;
+  uint64_t version_{};
+};
+
 } // namespace Upstream
 } // namespace Envoy
 
@@ -242,3 +341,29 @@ static void healthOnlyUpdate(State& state) {
 }
 
 BENCHMARK(healthOnlyUpdate)->Ranges({{1, 100000}, {false, true}})->Unit(benchmark::kMillisecond);
+
+// Measures an EDS update in which state.range(1) of state.range(0) hosts have been replaced, from
+// the update reaching the cluster until a worker has applied the membership delta to its host set
+// and load balancer. Building the update is not timed.
+static void clusterManagerChurnUpdate(State& state) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_state(spdlog::level::warn,
+                                       Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock, false);
+  Envoy::Upstream::EdsClusterManagerSpeedTest speed_test;
+  const uint32_t endpoints = skipExpensiveBenchmarks() ? 1 : state.range(0);
+  const uint32_t changed = std::min<uint32_t>(endpoints, state.range(1));
+  speed_test.deliverUpdate(speed_test.churnUpdate(endpoints, 0));
+
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    state.PauseTiming();
+    const Envoy::Config::DecodedResourcesWrapper update =
+        speed_test.churnUpdate(endpoints, changed);
+    state.ResumeTiming();
+    speed_test.deliverUpdate(update);
+  }
+  ASSERT(speed_test.workerHosts() == endpoints);
+}
+
+BENCHMARK(clusterManagerChurnUpdate)
+    ->Ranges({{1000, 100000}, {1, 100}})
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,254 @@
+#include <sys/stat.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "envoy/extensions/common/async_files/v3/async_file_manager.pb.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/io/io_uring_impl.h"
+#include "source/common/singleton/manager_impl.h"
+#include "source/extensions/common/async_files/async_file_handle.h"
+#include "source/extensions/common/async_files/async_file_manager.h"
+#include "source/extensions/common/async_files/async_file_manager_factory.h"
+
+#include "test/mocks/buffer/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/status_utility.h"
+#include "test/test_common/utility.h"
+
+#include "absl/status/statusor.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+using StatusHelpers::HasStatusCode;
+using StatusHelpers::IsOkAndHolds;
+
+class AsyncFileManagerIoUringTest : public testing::Test {
+public:
+  void SetUp() override {
+    if (!Io::isIoUringSupported()) {
+      GTEST_SKIP() << "io_uring is not supported by the kernel";
+    }
+    envoy::extensions::common::async_files::v3::AsyncFileManagerConfig config;
+    config.mutable_io_uring()->set_submission_queue_size(4);
+    manager_ = factory_->getAsyncFileManager(config);
+  }
+
+  void resolveFileActions() {
+    manager_->waitForIdle();
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  AsyncFileHandle openExistingFile(absl::string_view filename, AsyncFileManager::Mode mode) {
+    absl::StatusOr<AsyncFileHandle> open_result;
+    manager_->openExistingFile(dispatcher_.get(), filename, mode,
+                               [&](absl::StatusOr<AsyncFileHandle> result) {
+                                 open_result = std::move(result);
+                               });
+    resolveFileActions();
+    EXPECT_OK(open_result);
+    return open_result.value_or(nullptr);
+  }
+
+  void close(AsyncFileHandle& handle) {
+    absl::Status close_result = absl::UnknownError("not called");
+    EXPECT_OK(
+        handle->close(dispatcher_.get(), [&](absl::Status status) { close_result = status; }));
+    resolveFileActions();
+    EXPECT_OK(close_result);
+  }
+
+  std::unique_ptr<Singleton::ManagerImpl> singleton_manager_ =
+      std::make_unique<Singleton::ManagerImpl>();
+  std::shared_ptr<AsyncFileManagerFactory> factory_ =
+      AsyncFileManagerFactory::singleton(singleton_manager_.get());
+  std::shared_ptr<AsyncFileManager> manager_;
+  const char* test_tmpdir = std::getenv("TEST_TMPDIR");
+  std::string tmpdir_ = test_tmpdir ? test_tmpdir : "/tmp";
+  Api::ApiPtr api_ = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher_ = api_->allocateDispatcher("test_thread");
+};
+
+TEST_F(AsyncFileManagerIoUringTest, DescribesSubmissionQueueSize) {
+  EXPECT_THAT(manager_->describe(), testing::ContainsRegex("io_uring_submission_queue_size = 4"));
+}
+
+TEST_F(AsyncFileManagerIoUringTest, OpenReadStatClose) {
+  const std::string filename =
+      TestEnvironment::writeStringToFileForTest("io_uring_read", "hello world", true);
+  AsyncFileHandle handle = openExistingFile(filename, AsyncFileManager::Mode::ReadOnly);
+  ASSERT_NE(handle, nullptr);
+
+  absl::StatusOr<Buffer::InstancePtr> read_result;
+  ASSERT_OK(handle->read(dispatcher_.get(), 6, 5, [&](absl::StatusOr<Buffer::InstancePtr> result) {
+    read_result = std::move(result);
+  }));
+  resolveFileActions();
+  ASSERT_OK(read_result);
+  EXPECT_THAT(*read_result.value(), BufferString("world"));
+
+  // Reading past the end of the file returns what there is.
+  ASSERT_OK(handle->read(dispatcher_.get(), 6, 100,
+                         [&](absl::StatusOr<Buffer::InstancePtr> result) {
+                           read_result = std::move(result);
+                         }));
+  resolveFileActions();
+  ASSERT_OK(read_result);
+  EXPECT_THAT(*read_result.value(), BufferString("world"));
+
+  absl::StatusOr<struct stat> stat_result;
+  ASSERT_OK(handle->stat(dispatcher_.get(), [&](absl::StatusOr<struct stat> result) {
+    stat_result = std::move(result);
+  }));
+  resolveFileActions();
+  ASSERT_OK(stat_result);
+  EXPECT_EQ(11, stat_result.value().st_size);
+  EXPECT_TRUE(S_ISREG(stat_result.value().st_mode));
+
+  close(handle);
+}
+
+TEST_F(AsyncFileManagerIoUringTest, AnonymousFileWriteReadAndLink) {
+  absl::StatusOr<AsyncFileHandle> create_result;
+  manager_->createAnonymousFile(dispatcher_.get(), tmpdir_,
+                                [&](absl::StatusOr<AsyncFileHandle> result) {
+                                  create_result = std::move(result);
+                                });
+  resolveFileActions();
+  if (absl::IsUnimplemented(create_result.status())) {
+    GTEST_SKIP() << "O_TMPFILE is not supported by the file system of " << tmpdir_;
+  }
+  ASSERT_OK(create_result);
+  AsyncFileHandle handle = create_result.value();
+
+  Buffer::OwnedImpl contents("hello");
+  contents.add(" world");
+  absl::StatusOr<size_t> write_result;
+  ASSERT_OK(handle->write(dispatcher_.get(), contents, 0,
+                          [&](absl::StatusOr<size_t> result) { write_result = result; }));
+  EXPECT_EQ(0, contents.length());
+  resolveFileActions();
+  EXPECT_THAT(write_result, IsOkAndHolds(11U));
+
+  absl::Status truncate_result = absl::UnknownError("not called");
+  ASSERT_OK(handle->truncate(dispatcher_.get(), 5,
+                             [&](absl::Status result) { truncate_result = result; }));
+  resolveFileActions();
+  EXPECT_OK(truncate_result);
+
+  absl::StatusOr<Buffer::InstancePtr> read_result;
+  ASSERT_OK(handle->read(dispatcher_.get(), 0, 11, [&](absl::StatusOr<Buffer::InstancePtr> result) {
+    read_result = std::move(result);
+  }));
+  resolveFileActions();
+  ASSERT_OK(read_result);
+  EXPECT_THAT(*read_result.value(), BufferString("hello"));
+
+  const std::string link = TestEnvironment::temporaryPath("io_uring_link");
+  ::unlink(link.c_str());
+  absl::Status link_result = absl::UnknownError("not called");
+  ASSERT_OK(handle->createHardLink(dispatcher_.get(), link,
+                                   [&](absl::Status result) { link_result = result; }));
+  resolveFileActions();
+  EXPECT_OK(link_result);
+  close(handle);
+
+  absl::StatusOr<struct stat> stat_result;
+  manager_->stat(dispatcher_.get(), link,
+                 [&](absl::StatusOr<struct stat> result) { stat_result = std::move(result); });
+  resolveFileActions();
+  ASSERT_OK(stat_result);
+  EXPECT_EQ(5, stat_result.value().st_size);
+
+  absl::Status unlink_result = absl::UnknownError("not called");
+  manager_->unlink(dispatcher_.get(), link, [&](absl::Status result) { unlink_result = result; });
+  resolveFileActions();
+  EXPECT_OK(unlink_result);
+  manager_->stat(dispatcher_.get(), link,
+                 [&](absl::StatusOr<struct stat> result) { stat_result = std::move(result); });
+  resolveFileActions();
+  EXPECT_THAT(stat_result, HasStatusCode(absl::StatusCode::kNotFound));
+}
+
+TEST_F(AsyncFileManagerIoUringTest, OpenMissingFileFails) {
+  absl::StatusOr<AsyncFileHandle> open_result;
+  manager_->openExistingFile(dispatcher_.get(), TestEnvironment::temporaryPath("io_uring_missing"),
+                             AsyncFileManager::Mode::ReadOnly,
+                             [&](absl::StatusOr<AsyncFileHandle> result) {
+                               open_result = std::move(result);
+                             });
+  resolveFileActions();
+  EXPECT_THAT(open_result, HasStatusCode(absl::StatusCode::kNotFound));
+}
+
+TEST_F(AsyncFileManagerIoUringTest, DuplicateReadsSameFile) {
+  const std::string filename =
+      TestEnvironment::writeStringToFileForTest("io_uring_duplicate", "hello", true);
+  AsyncFileHandle handle = openExistingFile(filename, AsyncFileManager::Mode::ReadOnly);
+  ASSERT_NE(handle, nullptr);
+  absl::StatusOr<AsyncFileHandle> duplicate_result;
+  ASSERT_OK(handle->duplicate(dispatcher_.get(), [&](absl::StatusOr<AsyncFileHandle> result) {
+    duplicate_result = std::move(result);
+  }));
+  resolveFileActions();
+  ASSERT_OK(duplicate_result);
+  AsyncFileHandle duplicate = duplicate_result.value();
+  close(handle);
+
+  absl::StatusOr<Buffer::InstancePtr> read_result;
+  ASSERT_OK(duplicate->read(dispatcher_.get(), 0, 5,
+                            [&](absl::StatusOr<Buffer::InstancePtr> result) {
+                              read_result = std::move(result);
+                            }));
+  resolveFileActions();
+  ASSERT_OK(read_result);
+  EXPECT_THAT(*read_result.value(), BufferString("hello"));
+  close(duplicate);
+}
+
+TEST_F(AsyncFileManagerIoUringTest, CancelledOpenDoesNotCallBack) {
+  const std::string filename =
+      TestEnvironment::writeStringToFileForTest("io_uring_cancel", "hello", true);
+  bool called = false;
+  CancelFunction cancel = manager_->openExistingFile(
+      dispatcher_.get(), filename, AsyncFileManager::Mode::ReadOnly,
+      [&](absl::StatusOr<AsyncFileHandle>) { called = true; });
+  cancel();
+  resolveFileActions();
+  // The file opened by the cancelled operation is closed by the manager.
+  manager_->waitForIdle();
+  EXPECT_FALSE(called);
+}
+
+TEST_F(AsyncFileManagerIoUringTest, MoreOperationsThanSubmissionQueueEntries) {
+  const std::string filename =
+      TestEnvironment::writeStringToFileForTest("io_uring_many", "0123456789", true);
+  AsyncFileHandle handle = openExistingFile(filename, AsyncFileManager::Mode::ReadOnly);
+  ASSERT_NE(handle, nullptr);
+  // With a submission queue of 4 entries at most 8 operations can be in flight, the reads
+  // beyond that wait for earlier ones to complete instead of overflowing the completion queue.
+  int succeeded = 0;
+  for (int i = 0; i < 20; i++) {
+    ASSERT_OK(handle->read(dispatcher_.get(), i % 10, 1,
+                           [&, i](absl::StatusOr<Buffer::InstancePtr> result) {
+                             ASSERT_OK(result);
+                             EXPECT_EQ(std::to_string(i % 10), result.value()->toString());
+                             succeeded++;
+                           }));
+  }
+  resolveFileActions();
+  EXPECT_EQ(20, succeeded);
+  close(handle);
+}
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
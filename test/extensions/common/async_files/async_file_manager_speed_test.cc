@@ -0,0 +1,134 @@
+// Compares the thread pool and io_uring AsyncFileManagers serving files from the page cache,
+// which is what a cache filter does on a cache hit.
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/common/async_files/v3/async_file_manager.pb.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/io/io_uring_impl.h"
+#include "source/common/singleton/manager_impl.h"
+#include "source/extensions/common/async_files/async_file_manager.h"
+#include "source/extensions/common/async_files/async_file_manager_factory.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+namespace {
+
+constexpr size_t FileSize = 256 * 1024;
+constexpr size_t ChunkSize = 16 * 1024;
+
+// Opens a file, reads it chunk by chunk with one read in flight at a time, and closes it.
+class CacheHitReader {
+public:
+  CacheHitReader(AsyncFileManager& manager, Event::Dispatcher& dispatcher,
+                 const std::string& filename, std::function<void()> on_done)
+      : manager_(manager), dispatcher_(dispatcher), filename_(filename),
+        on_done_(std::move(on_done)) {}
+
+  void start() {
+    offset_ = 0;
+    manager_.openExistingFile(&dispatcher_, filename_, AsyncFileManager::Mode::ReadOnly,
+                              [this](absl::StatusOr<AsyncFileHandle> result) {
+                                RELEASE_ASSERT(result.ok(), result.status().ToString());
+                                handle_ = std::move(result.value());
+                                readNext();
+                              });
+  }
+
+private:
+  void readNext() {
+    if (offset_ >= FileSize) {
+      auto closed = handle_->close(&dispatcher_, [this](absl::Status) { on_done_(); });
+      RELEASE_ASSERT(closed.ok(), closed.status().ToString());
+      handle_ = nullptr;
+      return;
+    }
+    auto queued = handle_->read(&dispatcher_, offset_, ChunkSize,
+                                [this](absl::StatusOr<Buffer::InstancePtr> result) {
+                                  RELEASE_ASSERT(result.ok(), result.status().ToString());
+                                  offset_ += result.value()->length();
+                                  readNext();
+                                });
+    RELEASE_ASSERT(queued.ok(), queued.status().ToString());
+  }
+
+  AsyncFileManager& manager_;
+  Event::Dispatcher& dispatcher_;
+  const std::string filename_;
+  const std::function<void()> on_done_;
+  AsyncFileHandle handle_;
+  size_t offset_{};
+};
+
+// Serves state.range(0) files concurrently from a single dispatcher, as a worker thread would.
+void bmServeCacheHits(
+    benchmark::State& state,
+    const envoy::extensions::common::async_files::v3::AsyncFileManagerConfig& config) {
+  const int64_t concurrency = state.range(0);
+  Singleton::ManagerImpl singleton_manager;
+  std::shared_ptr<AsyncFileManager> manager =
+      AsyncFileManagerFactory::singleton(&singleton_manager)->getAsyncFileManager(config);
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+
+  std::vector<std::unique_ptr<CacheHitReader>> readers;
+  int64_t pending = 0;
+  for (int64_t i = 0; i < concurrency; i++) {
+    const std::string filename = TestEnvironment::writeStringToFileForTest(
+        absl::StrCat("async_file_cache_hit_", i), std::string(FileSize, 'a'));
+    readers.push_back(std::make_unique<CacheHitReader>(
+        *manager, *dispatcher, filename, [&pending, &dispatcher]() {
+          if (--pending == 0) {
+            dispatcher->exit();
+          }
+        }));
+  }
+
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    pending = concurrency;
+    for (auto& reader : readers) {
+      reader->start();
+    }
+    dispatcher->run(Event::Dispatcher::RunType::RunUntilExit);
+  }
+  state.SetBytesProcessed(state.iterations() * concurrency * FileSize);
+  manager->waitForIdle();
+  dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+void bmThreadPool(benchmark::State& state) {
+  envoy::extensions::common::async_files::v3::AsyncFileManagerConfig config;
+  config.mutable_thread_pool()->set_thread_count(4);
+  bmServeCacheHits(state, config);
+}
+
+void bmIoUring(benchmark::State& state) {
+  if (!Io::isIoUringSupported()) {
+    state.SkipWithError("io_uring is not supported by the kernel");
+    return;
+  }
+  envoy::extensions::common::async_files::v3::AsyncFileManagerConfig config;
+  config.mutable_io_uring()->set_submission_queue_size(256);
+  bmServeCacheHits(state, config);
+}
+
+BENCHMARK(bmThreadPool)->Arg(1)->Arg(16)->Arg(64)->UseRealTime();
+BENCHMARK(bmIoUring)->Arg(1)->Arg(16)->Arg(64)->UseRealTime();
+
+} // namespace
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
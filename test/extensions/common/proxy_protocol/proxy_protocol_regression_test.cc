@@ -79,6 +79,7 @@ public:
   bool handOffRestoredDestinationConnections() const override { return false; }
   uint32_t perConnectionBufferLimitBytes() const override { return 0; }
   std::chrono::milliseconds perConnectionBufferHighWatermarkTimeout() const override { return {}; }
+  std::chrono::milliseconds perConnectionIdleMemoryShedTimeout() const override { return {}; }
   std::chrono::milliseconds listenerFiltersTimeout() const override { return {}; }
   bool continueOnListenerFiltersTimeout() const override { return false; }
   Stats::Scope& listenerScope() override { return *stats_store_.rootScope(); }
@@ -58,6 +58,9 @@ public:
   std::chrono::milliseconds perConnectionBufferHighWatermarkTimeout() const override {
     return std::chrono::milliseconds::zero();
   }
+  std::chrono::milliseconds perConnectionIdleMemoryShedTimeout() const override {
+    return std::chrono::milliseconds::zero();
+  }
   std::chrono::milliseconds listenerFiltersTimeout() const override { return {}; }
   bool continueOnListenerFiltersTimeout() const override { return false; }
   Stats::Scope& listenerScope() override { return *stats_store_.rootScope(); }
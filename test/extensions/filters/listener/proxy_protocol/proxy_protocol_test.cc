@@ -111,6 +111,9 @@ public:
   std::chrono::milliseconds perConnectionBufferHighWatermarkTimeout() const override {
     return std::chrono::milliseconds::zero();
   }
+  std::chrono::milliseconds perConnectionIdleMemoryShedTimeout() const override {
+    return std::chrono::milliseconds::zero();
+  }
   std::chrono::milliseconds listenerFiltersTimeout() const override { return {}; }
   bool continueOnListenerFiltersTimeout() const override { return false; }
   Stats::Scope& listenerScope() override {
@@ -2797,6 +2800,9 @@ public:
   std::chrono::milliseconds perConnectionBufferHighWatermarkTimeout() const override {
     return std::chrono::milliseconds::zero();
   }
+  std::chrono::milliseconds perConnectionIdleMemoryShedTimeout() const override {
+    return std::chrono::milliseconds::zero();
+  }
   std::chrono::milliseconds listenerFiltersTimeout() const override { return {}; }
   ResourceLimit& openConnections() override { return open_connections_; }
   bool continueOnListenerFiltersTimeout() const override { return false; }
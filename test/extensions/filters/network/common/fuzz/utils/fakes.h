@@ -24,6 +24,7 @@ public:
   envoy::config::core::v3::TrafficDirection direction() const override { return direction_; }
   bool isQuic() const override { return is_quic_; }
   bool shouldBypassOverloadManager() const override { return bypass_overload_manager_; }
+  bool trackIncomingCpu() const override { return false; }
 
 private:
   Envoy::Config::MetadataPack<Envoy::Network::ListenerTypedMetadataFactory> metadata_;
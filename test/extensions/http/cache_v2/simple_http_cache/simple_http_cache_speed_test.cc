@@ -0,0 +1,99 @@
+// Measures cache hit throughput of the SimpleHttpCache from several worker threads at once, with
+// all entries in one shard and spread over the default number of shards.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/extensions/http/cache_v2/simple_http_cache/simple_http_cache.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace {
+
+constexpr int NumKeys = 1024;
+constexpr uint64_t BodySize = 16 * 1024;
+
+// A source that provides the whole body at once.
+class StringHttpSource : public HttpSource {
+public:
+  explicit StringHttpSource(std::string body) : body_(std::move(body)) {}
+  void getHeaders(GetHeadersCallback&&) override { PANIC("unexpected"); }
+  void getBody(AdjustedByteRange, GetBodyCallback&& cb) override {
+    cb(std::make_unique<Buffer::OwnedImpl>(body_), EndStream::End);
+  }
+  void getTrailers(GetTrailersCallback&&) override { PANIC("unexpected"); }
+
+private:
+  const std::string body_;
+};
+
+class NullProgressReceiver : public CacheProgressReceiver {
+public:
+  void onHeadersInserted(CacheReaderPtr, Http::ResponseHeaderMapPtr, bool) override {}
+  void onBodyInserted(AdjustedByteRange, bool) override {}
+  void onTrailersInserted(Http::ResponseTrailerMapPtr) override {}
+  void onInsertFailed(absl::Status) override {}
+};
+
+std::unique_ptr<SimpleHttpCache> cache;
+std::vector<Key> keys;
+
+// Each of state.threads() workers looks up cached responses and reads their whole body, from a
+// cache with state.range(0) shards.
+void bmLookupHit(benchmark::State& state) {
+  testing::NiceMock<Event::MockDispatcher> dispatcher;
+  if (state.thread_index() == 0) {
+    // Bounded, so that lookups also maintain the eviction order and frequency sketch, but large
+    // enough to never evict.
+    cache = std::make_unique<SimpleHttpCache>(NumKeys * BodySize * 2, state.range(0));
+    keys.clear();
+    for (int i = 0; i < NumKeys; i++) {
+      Key key;
+      key.set_host("example.com");
+      key.set_path(absl::StrCat("/", i));
+      cache->insert(dispatcher, key,
+                    Http::createHeaderMap<Http::ResponseHeaderMapImpl>(
+                        Http::TestResponseHeaderMapImpl{{":status", "200"}}),
+                    ResponseMetadata{},
+                    std::make_unique<StringHttpSource>(std::string(BodySize, 'x')),
+                    std::make_shared<NullProgressReceiver>());
+      keys.push_back(std::move(key));
+    }
+  }
+  size_t i = state.thread_index() * 7919;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    Key key = keys[i++ % NumKeys];
+    cache->lookup(LookupRequest(std::move(key), dispatcher),
+                  [&dispatcher](absl::StatusOr<LookupResult>&& result) {
+                    RELEASE_ASSERT(result.ok() && result.value().cache_reader_, "expected a hit");
+                    result.value().cache_reader_->getBody(
+                        dispatcher, AdjustedByteRange(0, BodySize),
+                        [](Buffer::InstancePtr buffer, EndStream) {
+                          benchmark::DoNotOptimize(buffer->length());
+                        });
+                  });
+  }
+  state.SetBytesProcessed(state.iterations() * BodySize);
+  if (state.thread_index() == 0) {
+    cache.reset();
+  }
+}
+
+BENCHMARK(bmLookupHit)->Arg(1)->Arg(16)->ThreadRange(1, 16)->UseRealTime();
+
+} // namespace
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,3 +1,4 @@
+#include "envoy/extensions/http/cache_v2/simple_http_cache/v3/config.pb.h"
 #include "envoy/http/header_map.h"
 #include "envoy/registry/registry.h"
 
@@ -8,6 +9,7 @@
 #include "source/extensions/http/cache_v2/simple_http_cache/simple_http_cache.h"
 
 #include "test/extensions/filters/http/cache_v2/http_cache_implementation_test_common.h"
+#include "test/extensions/filters/http/cache_v2/mocks.h"
 #include "test/mocks/server/factory_context.h"
 #include "test/test_common/status_utility.h"
 #include "test/test_common/utility.h"
@@ -34,6 +36,163 @@ INSTANTIATE_TEST_SUITE_P(SimpleHttpCacheTest, HttpCacheImplementationTest,
                            return "SimpleHttpCache";
                          });
 
+// A cache with a single shard, so that every entry competes for the same budget.
+class BoundedSimpleHttpCacheTest : public testing::Test {
+protected:
+  static constexpr uint64_t BodySize = 1000;
+
+  void createCache(uint64_t max_size_bytes, uint32_t shard_count = 1) {
+    cache_ = std::make_unique<SimpleHttpCache>(max_size_bytes, shard_count);
+  }
+
+  Key key(absl::string_view path) {
+    Key key;
+    key.set_path(path);
+    return key;
+  }
+
+  void insert(absl::string_view path, uint64_t body_size = BodySize) {
+    auto progress = std::make_shared<testing::NiceMock<MockCacheProgressReceiver>>();
+    cache_->insert(*dispatcher_, key(path),
+                   Http::createHeaderMap<Http::ResponseHeaderMapImpl>(
+                       Http::TestResponseHeaderMapImpl{{":status", "200"}}),
+                   ResponseMetadata{api_->timeSource().systemTime()},
+                   std::make_unique<FakeStreamHttpSource>(
+                       *dispatcher_, nullptr, std::string(body_size, 'x'), nullptr),
+                   progress);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  CacheReaderPtr lookup(absl::string_view path) {
+    CacheReaderPtr reader;
+    cache_->lookup(LookupRequest(key(path), *dispatcher_),
+                   [&reader](absl::StatusOr<LookupResult>&& result) {
+                     reader = std::move(result.value().cache_reader_);
+                   });
+    return reader;
+  }
+
+  Api::ApiPtr api_ = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher_ = api_->allocateDispatcher("test_thread");
+  std::unique_ptr<SimpleHttpCache> cache_;
+};
+
+TEST_F(BoundedSimpleHttpCacheTest, EvictsLeastRecentlyUsedEntry) {
+  createCache(2500);
+  insert("/a");
+  insert("/b");
+  EXPECT_NE(lookup("/a"), nullptr);
+  // The miss counts as a request, so /c is more popular than /b when it is inserted.
+  EXPECT_EQ(lookup("/c"), nullptr);
+  insert("/c");
+  EXPECT_EQ(cache_->entryCount(), 2);
+  EXPECT_LE(cache_->sizeBytes(), 2500);
+  EXPECT_EQ(lookup("/b"), nullptr);
+  EXPECT_NE(lookup("/a"), nullptr);
+  EXPECT_NE(lookup("/c"), nullptr);
+}
+
+TEST_F(BoundedSimpleHttpCacheTest, DoesNotAdmitLessPopularEntry) {
+  createCache(2500);
+  insert("/a");
+  insert("/b");
+  for (int i = 0; i < 3; i++) {
+    EXPECT_NE(lookup("/a"), nullptr);
+    EXPECT_NE(lookup("/b"), nullptr);
+  }
+  insert("/c");
+  EXPECT_EQ(cache_->entryCount(), 2);
+  EXPECT_EQ(lookup("/c"), nullptr);
+  EXPECT_NE(lookup("/a"), nullptr);
+  EXPECT_NE(lookup("/b"), nullptr);
+}
+
+TEST_F(BoundedSimpleHttpCacheTest, EntryLargerThanBudgetIsNotKeptAndEvictsNothing) {
+  createCache(2500);
+  insert("/a");
+  EXPECT_EQ(lookup("/big"), nullptr);
+  EXPECT_EQ(lookup("/big"), nullptr);
+  insert("/big", 3000);
+  EXPECT_EQ(cache_->entryCount(), 1);
+  EXPECT_EQ(lookup("/big"), nullptr);
+  EXPECT_NE(lookup("/a"), nullptr);
+}
+
+// The budget is shared by all shards, so a response larger than an even share of it is kept,
+// and space held by other shards is reclaimed for it.
+TEST_F(BoundedSimpleHttpCacheTest, EntryLargerThanShardShareReclaimsOtherShards) {
+  createCache(2500, 4);
+  insert("/a");
+  insert("/b");
+  EXPECT_EQ(lookup("/big"), nullptr);
+  EXPECT_EQ(lookup("/big"), nullptr);
+  insert("/big", 2000);
+  EXPECT_EQ(cache_->entryCount(), 1);
+  EXPECT_LE(cache_->sizeBytes(), 2500);
+  EXPECT_NE(lookup("/big"), nullptr);
+  EXPECT_EQ(lookup("/a"), nullptr);
+  EXPECT_EQ(lookup("/b"), nullptr);
+}
+
+// A response is charged as its body streams in, so it is rejected as soon as it doesn't fit,
+// rather than once it has been buffered in full.
+TEST_F(BoundedSimpleHttpCacheTest, BodyIsChargedAsItStreams) {
+  createCache(2500);
+  insert("/a");
+  const uint64_t size_before = cache_->sizeBytes();
+  auto source = std::make_unique<FakeStreamHttpSource>(*dispatcher_, nullptr,
+                                                       std::string(3000, 'x'), nullptr);
+  source->setMaxFragmentSize(500);
+  auto progress = std::make_shared<testing::NiceMock<MockCacheProgressReceiver>>();
+  std::vector<uint64_t> sizes;
+  size_t entries_at_end = 0;
+  EXPECT_CALL(*progress, onBodyInserted(testing::_, testing::_))
+      .WillRepeatedly([this, &sizes, &entries_at_end](AdjustedByteRange, bool end_stream) {
+        sizes.push_back(cache_->sizeBytes());
+        if (end_stream) {
+          entries_at_end = cache_->entryCount();
+        }
+      });
+  cache_->insert(*dispatcher_, key("/big"),
+                 Http::createHeaderMap<Http::ResponseHeaderMapImpl>(
+                     Http::TestResponseHeaderMapImpl{{":status", "200"}}),
+                 ResponseMetadata{api_->timeSource().systemTime()}, std::move(source), progress);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  ASSERT_FALSE(sizes.empty());
+  EXPECT_GE(sizes.front(), size_before + 500);
+  for (uint64_t size : sizes) {
+    EXPECT_LE(size, 2500);
+  }
+  EXPECT_EQ(entries_at_end, 1);
+  EXPECT_EQ(lookup("/big"), nullptr);
+  EXPECT_NE(lookup("/a"), nullptr);
+}
+
+TEST_F(BoundedSimpleHttpCacheTest, TouchRefreshesEvictionOrder) {
+  createCache(2500);
+  insert("/a");
+  insert("/b");
+  cache_->touch(key("/a"), SystemTime());
+  EXPECT_EQ(lookup("/c"), nullptr);
+  insert("/c");
+  EXPECT_EQ(lookup("/b"), nullptr);
+  EXPECT_NE(lookup("/a"), nullptr);
+}
+
+TEST_F(BoundedSimpleHttpCacheTest, BodyOutlivesEvictedEntry) {
+  createCache(1024 * 1024);
+  insert("/a", 64 * 1024);
+  CacheReaderPtr reader = lookup("/a");
+  ASSERT_NE(reader, nullptr);
+  cache_->evict(*dispatcher_, key("/a"));
+  EXPECT_EQ(cache_->entryCount(), 0);
+  EXPECT_EQ(cache_->sizeBytes(), 0);
+  std::string body;
+  reader->getBody(*dispatcher_, AdjustedByteRange(100, 60000),
+                  [&body](Buffer::InstancePtr buffer, EndStream) { body = buffer->toString(); });
+  EXPECT_EQ(body, std::string(59900, 'x'));
+}
+
 TEST(Registration, GetFactory) {
   HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
       "envoy.extensions.http.cache_v2.simple_http_cache.v3.SimpleHttpCacheV2Config");
@@ -46,6 +205,21 @@ TEST(Registration, GetFactory) {
   EXPECT_EQ((*cache)->cacheInfo().name_, "envoy.extensions.http.cache_v2.simple");
 }
 
+TEST(Registration, GetFactoryWithBudget) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache_v2.simple_http_cache.v3.SimpleHttpCacheV2Config");
+  ASSERT_NE(factory, nullptr);
+  envoy::extensions::http::cache_v2::simple_http_cache::v3::SimpleHttpCacheV2Config cache_config;
+  cache_config.set_max_cache_size_bytes(1024 * 1024);
+  cache_config.set_shard_count(4);
+  envoy::extensions::filters::http::cache_v2::v3::CacheV2Config config;
+  config.mutable_typed_config()->PackFrom(cache_config);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  auto cache = factory->getCache(config, factory_context);
+  ASSERT_OK(cache);
+  EXPECT_EQ((*cache)->cacheInfo().name_, "envoy.extensions.http.cache_v2.simple");
+}
+
 } // namespace
 } // namespace CacheV2
 } // namespace HttpFilters
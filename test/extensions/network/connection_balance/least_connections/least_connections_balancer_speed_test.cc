@@ -0,0 +1,102 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "source/common/common/random_generator.h"
+#include "source/common/network/connection_balancer_impl.h"
+#include "source/extensions/network/connection_balance/least_connections/least_connections_balancer.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Network {
+namespace LeastConnections {
+namespace {
+
+class StormHandler : public BalancedConnectionHandler {
+public:
+  // Network::BalancedConnectionHandler
+  uint64_t numConnections() const override { return connections_; }
+  void preIncNumConnections() override { ++connections_; }
+  void postIncNumConnections() override {}
+  void post(ConnectionSocketPtr&&) override {}
+  void onAcceptWorker(ConnectionSocketPtr&&, bool, bool,
+                      const absl::optional<std::string>&) override {}
+
+  void close() { --connections_; }
+
+private:
+  alignas(64) std::atomic<uint64_t> connections_{0};
+};
+
+enum class BalancerType { Nop, Exact, PowerOfTwoChoices, ApproximateMin };
+
+// A balancer and a handler per benchmark thread, set up by the first thread.
+struct Storm {
+  Storm(BalancerType type, uint32_t num_handlers) : handlers_(num_handlers) {
+    switch (type) {
+    case BalancerType::Nop:
+      balancer_ = std::make_unique<NopConnectionBalancerImpl>();
+      break;
+    case BalancerType::Exact:
+      balancer_ = std::make_unique<ExactConnectionBalancerImpl>();
+      break;
+    case BalancerType::PowerOfTwoChoices:
+      balancer_ = std::make_unique<LeastConnectionsBalancerImpl>(
+          LeastConnectionsBalancerImpl::Selection::PowerOfTwoChoices, random_);
+      break;
+    case BalancerType::ApproximateMin:
+      balancer_ = std::make_unique<LeastConnectionsBalancerImpl>(
+          LeastConnectionsBalancerImpl::Selection::ApproximateMin, random_);
+      break;
+    }
+    for (StormHandler& handler : handlers_) {
+      balancer_->registerHandler(handler);
+    }
+  }
+
+  ~Storm() {
+    for (StormHandler& handler : handlers_) {
+      balancer_->unregisterHandler(handler);
+    }
+  }
+
+  Random::RandomGeneratorImpl random_;
+  std::unique_ptr<ConnectionBalancer> balancer_;
+  std::vector<StormHandler> handlers_;
+};
+
+std::unique_ptr<Storm> storm;
+
+// Every benchmark thread accepts connections as fast as it can, each of them handed to the
+// balancer. Connections are closed right away, as in a storm of short lived connections.
+void connectionBalancerAcceptStorm(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    storm = std::make_unique<Storm>(static_cast<BalancerType>(state.range(0)), state.threads());
+  }
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    StormHandler& target = static_cast<StormHandler&>(
+        storm->balancer_->pickTargetHandler(storm->handlers_[state.thread_index()]));
+    target.close();
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index() == 0) {
+    storm.reset();
+  }
+}
+BENCHMARK(connectionBalancerAcceptStorm)
+    ->ArgName("balancer")
+    ->DenseRange(0, 3)
+    ->Threads(1)
+    ->Threads(8)
+    ->Threads(64)
+    ->UseRealTime();
+
+} // namespace
+} // namespace LeastConnections
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,169 @@
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "envoy/config/core/v3/extension.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "source/common/common/random_generator.h"
+#include "source/extensions/network/connection_balance/least_connections/least_connections_balancer.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace LeastConnections {
+namespace {
+
+using testing::NiceMock;
+using testing::Return;
+
+class TestHandler : public BalancedConnectionHandler {
+public:
+  explicit TestHandler(uint64_t connections = 0) : connections_(connections) {}
+
+  // Network::BalancedConnectionHandler
+  uint64_t numConnections() const override { return connections_; }
+  void preIncNumConnections() override { ++connections_; }
+  void postIncNumConnections() override {}
+  void post(ConnectionSocketPtr&&) override {}
+  void onAcceptWorker(ConnectionSocketPtr&&, bool, bool,
+                      const absl::optional<std::string>&) override {}
+
+  std::atomic<uint64_t> connections_;
+};
+
+class LeastConnectionsBalancerTest : public testing::Test {
+protected:
+  void createBalancer(LeastConnectionsBalancerImpl::Selection selection,
+                      const std::vector<uint64_t>& connections) {
+    balancer_ = std::make_unique<LeastConnectionsBalancerImpl>(selection, random_);
+    for (const uint64_t handler_connections : connections) {
+      handlers_.push_back(std::make_unique<TestHandler>(handler_connections));
+      balancer_->registerHandler(*handlers_.back());
+    }
+  }
+
+  NiceMock<Random::MockRandomGenerator> random_;
+  std::unique_ptr<LeastConnectionsBalancerImpl> balancer_;
+  std::vector<std::unique_ptr<TestHandler>> handlers_;
+};
+
+TEST_F(LeastConnectionsBalancerTest, KeepsConnectionOnCurrentHandlerOnTie) {
+  createBalancer(LeastConnectionsBalancerImpl::Selection::ApproximateMin, {2, 2, 2});
+  EXPECT_EQ(handlers_[1].get(), &balancer_->pickTargetHandler(*handlers_[1]));
+  EXPECT_EQ(3, handlers_[1]->numConnections());
+}
+
+TEST_F(LeastConnectionsBalancerTest, PowerOfTwoChoices) {
+  createBalancer(LeastConnectionsBalancerImpl::Selection::PowerOfTwoChoices, {5, 1, 3, 0});
+
+  // Candidates are slots 1 and 2, slot 3 is not looked at.
+  EXPECT_CALL(random_, random()).WillOnce(Return(1));
+  EXPECT_EQ(handlers_[1].get(), &balancer_->pickTargetHandler(*handlers_[0]));
+  EXPECT_EQ(2, handlers_[1]->numConnections());
+  EXPECT_EQ(5, handlers_[0]->numConnections());
+
+  // Candidates are slots 2 and 0.
+  EXPECT_CALL(random_, random()).WillOnce(Return((uint64_t(1) << 32) | 2));
+  EXPECT_EQ(handlers_[2].get(), &balancer_->pickTargetHandler(*handlers_[0]));
+  EXPECT_EQ(4, handlers_[2]->numConnections());
+}
+
+TEST_F(LeastConnectionsBalancerTest, ApproximateMin) {
+  createBalancer(LeastConnectionsBalancerImpl::Selection::ApproximateMin, {5, 3, 1, 4});
+  EXPECT_EQ(handlers_[2].get(), &balancer_->pickTargetHandler(*handlers_[0]));
+  EXPECT_EQ(handlers_[2].get(), &balancer_->pickTargetHandler(*handlers_[0]));
+  EXPECT_EQ(handlers_[1].get(), &balancer_->pickTargetHandler(*handlers_[0]));
+  EXPECT_EQ(4, handlers_[1]->numConnections());
+  EXPECT_EQ(3, handlers_[2]->numConnections());
+}
+
+TEST_F(LeastConnectionsBalancerTest, UnregisteredHandlerIsNotPicked) {
+  createBalancer(LeastConnectionsBalancerImpl::Selection::ApproximateMin, {5, 0});
+  balancer_->unregisterHandler(*handlers_[1]);
+  EXPECT_EQ(handlers_[0].get(), &balancer_->pickTargetHandler(*handlers_[0]));
+
+  // The freed slot is reused.
+  TestHandler handler;
+  balancer_->registerHandler(handler);
+  EXPECT_EQ(&handler, &balancer_->pickTargetHandler(*handlers_[0]));
+  balancer_->unregisterHandler(handler);
+}
+
+TEST_F(LeastConnectionsBalancerTest, ManyHandlers) {
+  std::vector<uint64_t> connections(LeastConnectionsBalancerImpl::SlotsPerChunk * 3, 10);
+  connections.back() = 0;
+  createBalancer(LeastConnectionsBalancerImpl::Selection::ApproximateMin, connections);
+  EXPECT_EQ(handlers_.back().get(), &balancer_->pickTargetHandler(*handlers_[0]));
+}
+
+// Handlers come and go while other threads pick, without any pick being lost.
+TEST_F(LeastConnectionsBalancerTest, ConcurrentPickAndRegistration) {
+  Random::RandomGeneratorImpl random;
+  LeastConnectionsBalancerImpl balancer(LeastConnectionsBalancerImpl::Selection::PowerOfTwoChoices,
+                                        random);
+  constexpr uint32_t NumPickers = 4;
+  constexpr uint32_t PicksPerPicker = 20000;
+  std::vector<std::unique_ptr<TestHandler>> pickers;
+  for (uint32_t i = 0; i < NumPickers; ++i) {
+    pickers.push_back(std::make_unique<TestHandler>());
+    balancer.registerHandler(*pickers.back());
+  }
+
+  std::atomic<uint64_t> transient_connections{0};
+  std::atomic<bool> picking{true};
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < NumPickers; ++i) {
+    threads.push_back(Thread::threadFactoryForTest().createThread([&, i]() {
+      for (uint32_t pick = 0; pick < PicksPerPicker; ++pick) {
+        balancer.pickTargetHandler(*pickers[i]);
+      }
+    }));
+  }
+  Thread::ThreadPtr registrar = Thread::threadFactoryForTest().createThread([&]() {
+    while (picking) {
+      TestHandler handler;
+      balancer.registerHandler(handler);
+      balancer.unregisterHandler(handler);
+      transient_connections += handler.numConnections();
+    }
+  });
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+  picking = false;
+  registrar->join();
+
+  uint64_t connections = transient_connections;
+  for (const auto& picker : pickers) {
+    connections += picker->numConnections();
+  }
+  EXPECT_EQ(NumPickers * PicksPerPicker, connections);
+}
+
+TEST(LeastConnectionsBalanceFactoryTest, CreateFromProto) {
+  auto* factory = Registry::FactoryRegistry<ConnectionBalanceFactory>::getFactory(
+      "envoy.network.connection_balance.least_connections");
+  ASSERT_NE(nullptr, factory);
+
+  LeastConnectionsBalanceProto balance_config;
+  balance_config.set_selection(LeastConnectionsBalanceProto::APPROXIMATE_MIN);
+  envoy::config::core::v3::TypedExtensionConfig typed_config;
+  typed_config.set_name("envoy.network.connection_balance.least_connections");
+  typed_config.mutable_typed_config()->PackFrom(balance_config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  ConnectionBalancerSharedPtr balancer =
+      factory->createConnectionBalancerFromProto(typed_config, context);
+  EXPECT_NE(nullptr, dynamic_cast<LeastConnectionsBalancerImpl*>(balancer.get()));
+}
+
+} // namespace
+} // namespace LeastConnections
+} // namespace Network
+} // namespace Envoy
@@ -7,20 +7,27 @@
 #include "source/common/network/address_impl.h"
 #include "source/common/network/socket_impl.h"
 #include "source/common/network/utility.h"
+#include "source/common/stats/isolated_store_impl.h"
 #include "source/extensions/stat_sinks/common/statsd/statsd.h"
 #include "source/extensions/stat_sinks/common/statsd/tag_formats.h"
 
+#include "test/mocks/api/mocks.h"
 #include "test/mocks/stats/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "spdlog/spdlog.h"
 
+using testing::_;
+using testing::ElementsAre;
 using testing::NiceMock;
+using testing::Return;
 
 namespace Envoy {
 namespace Extensions {
@@ -43,6 +50,31 @@ public:
   std::vector<std::string> buffer_writes;
 };
 
+TEST(DatagramBatchTest, PacksMetricsUpToMaxSize) {
+  DatagramBatch batch;
+  EXPECT_TRUE(batch.empty());
+
+  batch.add("aaaa", 10);
+  batch.add("bbbb", 10);
+  // Does not fit alongside the first two.
+  batch.add("cc", 10);
+  // Too large for any datagram; gets one of its own and closes the previous one.
+  batch.add("dddddddddddd", 10);
+  batch.add("ee", 10);
+
+  ASSERT_EQ(4, batch.size());
+  EXPECT_EQ("aaaa\nbbbb", batch.datagram(0));
+  EXPECT_EQ("cc", batch.datagram(1));
+  EXPECT_EQ("dddddddddddd", batch.datagram(2));
+  EXPECT_EQ("ee", batch.datagram(3));
+
+  batch.clear();
+  EXPECT_TRUE(batch.empty());
+  batch.add("ff", 10);
+  ASSERT_EQ(1, batch.size());
+  EXPECT_EQ("ff", batch.datagram(0));
+}
+
 // Skipping this test as Datagram sockets are not currently supported by UDS on Windows
 #ifndef WIN32
 // Regression test for https://github.com/envoyproxy/envoy/issues/8911
@@ -143,6 +175,123 @@ TEST_P(UdpStatsdSinkTest, InitWithIpAddress) {
   tls_.shutdownThread();
 }
 
+TEST_P(UdpStatsdSinkTest, FlushOnDedicatedThread) {
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Stats::MockMetricSnapshot> snapshot;
+  Network::Test::UdpSyncPeer server(GetParam());
+  UdpStatsdSink sink(tls_, server.localAddress(), false, getDefaultPrefix(), 64,
+                     getDefaultTagFormat(), Thread::threadFactoryForTest());
+
+  NiceMock<Stats::MockCounter> counter_1;
+  counter_1.name_ = "test_counter_1";
+  counter_1.used_ = true;
+  counter_1.latch_ = 1;
+  snapshot.counters_.push_back({1, counter_1});
+
+  NiceMock<Stats::MockCounter> counter_2;
+  counter_2.name_ = "test_counter_2";
+  counter_2.used_ = true;
+  counter_2.latch_ = 1;
+  snapshot.counters_.push_back({1, counter_2});
+
+  NiceMock<Stats::MockGauge> gauge;
+  gauge.name_ = "test_gauge";
+  gauge.value_ = 1;
+  gauge.used_ = true;
+  snapshot.gauges_.push_back(gauge);
+
+  sink.flush(snapshot);
+  {
+    Network::UdpRecvData data;
+    server.recv(data);
+    EXPECT_EQ("envoy.test_counter_1:1|c\nenvoy.test_counter_2:1|c", data.buffer_->toString());
+  }
+  {
+    Network::UdpRecvData data;
+    server.recv(data);
+    EXPECT_EQ("envoy.test_gauge:1|g", data.buffer_->toString());
+  }
+
+  tls_.shutdownThread();
+}
+
+// A datagram which fails to send is skipped, and the rest of the batch is still sent.
+TEST_P(UdpStatsdSinkTest, BatchSkipsDatagramThatFailsToSend) {
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Stats::MockMetricSnapshot> snapshot;
+  UdpStatsdSink sink(tls_, Network::Test::getCanonicalLoopbackAddress(GetParam()), false);
+
+  std::vector<std::unique_ptr<NiceMock<Stats::MockCounter>>> counters;
+  for (int i = 1; i <= 4; ++i) {
+    counters.push_back(std::make_unique<NiceMock<Stats::MockCounter>>());
+    counters.back()->name_ = absl::StrCat("test_counter_", i);
+    counters.back()->used_ = true;
+    counters.back()->latch_ = 1;
+    snapshot.counters_.push_back({1, *counters.back()});
+  }
+
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  std::vector<std::string> sent;
+  auto send_datagrams = [&sent](unsigned int count) {
+    return [&sent, count](os_fd_t, struct mmsghdr* msgvec, unsigned int, int) {
+      for (unsigned int i = 0; i < count; ++i) {
+        const iovec& iov = *msgvec[i].msg_hdr.msg_iov;
+        sent.emplace_back(static_cast<const char*>(iov.iov_base), iov.iov_len);
+      }
+      return Api::SysCallIntResult{static_cast<int>(count), 0};
+    };
+  };
+  EXPECT_CALL(os_sys_calls, supportsMmsg()).WillRepeatedly(Return(true));
+  {
+    testing::InSequence s;
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 4, 0)).WillOnce(send_datagrams(1));
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 3, 0))
+        .WillOnce(Return(Api::SysCallIntResult{-1, EMSGSIZE}));
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 2, 0)).WillOnce(send_datagrams(2));
+  }
+  sink.flush(snapshot);
+  EXPECT_THAT(sent, ElementsAre("envoy.test_counter_1:1|c", "envoy.test_counter_3:1|c",
+                                "envoy.test_counter_4:1|c"));
+
+  tls_.shutdownThread();
+}
+
+// Once the socket buffer is full, the rest of the batch is dropped and counted once, instead of
+// trying every remaining datagram.
+TEST_P(UdpStatsdSinkTest, BatchDroppedWhenSocketBufferIsFull) {
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Stats::MockMetricSnapshot> snapshot;
+  Stats::IsolatedStoreImpl store;
+  UdpStatsdSink sink(tls_, Network::Test::getCanonicalLoopbackAddress(GetParam()), false,
+                     getDefaultPrefix(), absl::nullopt, getDefaultTagFormat(), {},
+                     *store.rootScope());
+
+  std::vector<std::unique_ptr<NiceMock<Stats::MockCounter>>> counters;
+  for (int i = 1; i <= 4; ++i) {
+    counters.push_back(std::make_unique<NiceMock<Stats::MockCounter>>());
+    counters.back()->name_ = absl::StrCat("test_counter_", i);
+    counters.back()->used_ = true;
+    counters.back()->latch_ = 1;
+    snapshot.counters_.push_back({1, *counters.back()});
+  }
+
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  EXPECT_CALL(os_sys_calls, supportsMmsg()).WillRepeatedly(Return(true));
+  {
+    testing::InSequence s;
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 4, 0))
+        .WillOnce(Return(Api::SysCallIntResult{1, 0}));
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 3, 0))
+        .WillOnce(Return(Api::SysCallIntResult{-1, SOCKET_ERROR_AGAIN}));
+  }
+  sink.flush(snapshot);
+  EXPECT_EQ(1, TestUtility::findCounter(store, "statsd.udp_batches_dropped")->value());
+
+  tls_.shutdownThread();
+}
+
 class UdpStatsdSinkWithTagsTest : public testing::TestWithParam<Network::Address::IpVersion> {};
 INSTANTIATE_TEST_SUITE_P(IpVersions, UdpStatsdSinkWithTagsTest,
                          testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
@@ -269,10 +418,11 @@ TEST(UdpStatsdSinkTest, CheckMetricLargerThanBuffer) {
   counter.latch_ = 1;
   snapshot.counters_.push_back({1, counter});
 
-  // Expect the metric to skip the buffer
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_counter:1|c"));
+  // Expect the metric to get a datagram of its own
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
   sink.flush(snapshot);
+  EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
+  EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter:1|c");
   counter.used_ = false;
 
   NiceMock<Stats::MockGauge> gauge;
@@ -281,10 +431,11 @@ TEST(UdpStatsdSinkTest, CheckMetricLargerThanBuffer) {
   gauge.used_ = true;
   snapshot.gauges_.push_back(gauge);
 
-  // Expect the metric to skip the buffer
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_gauge:1|g"));
+  // Expect the metric to get a datagram of its own
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
   sink.flush(snapshot);
+  EXPECT_EQ(writer_ptr->buffer_writes.size(), 2);
+  EXPECT_EQ(writer_ptr->buffer_writes.at(1), "envoy.test_gauge:1|g");
 
   tls_.shutdownThread();
 }
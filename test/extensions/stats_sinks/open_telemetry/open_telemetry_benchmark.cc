@@ -1,7 +1,9 @@
 // This file benchmarks the OpenTelemetry stats sink using the `Stats::Sink::flush` API.
 // The benchmark runs at a scale of 9,000 stats (3,000 counters, 3,000 gauges, 3,000 histograms)
 // with 8 tags each to test end-to-end aggregation and RPC generation performance
-// under realistic load with high cardinality.
+// under realistic load with high cardinality. It also flushes partial snapshots, which only
+// include the metrics that changed since the previous flush, to compare their cost with flushing
+// every metric.
 
 #include "envoy/stats/tag.h"
 
@@ -35,7 +37,9 @@ public:
 };
 
 struct BenchmarkSetup {
-  BenchmarkSetup() {
+  // Only changed_percent of the metrics are included in the snapshot, as in a partial snapshot
+  // when the other metrics did not change since the previous flush.
+  explicit BenchmarkSetup(int changed_percent = 100) {
     snapshot = std::make_unique<testing::NiceMock<Stats::MockMetricSnapshot>>();
     hist = hist_alloc();
     hist_insert(hist, 1.5, 10);
@@ -63,7 +67,9 @@ struct BenchmarkSetup {
       counter->value_ = 100;
       counter->used_ = true;
       counter->setTags(make_tags(i));
-      snapshot->counters_.push_back({1, *counter});
+      if (i % 100 < changed_percent) {
+        snapshot->counters_.push_back({1, *counter});
+      }
       counters.push_back(std::move(counter));
     }
 
@@ -74,7 +80,9 @@ struct BenchmarkSetup {
       gauge->value_ = 100;
       gauge->used_ = true;
       gauge->setTags(make_tags(i));
-      snapshot->gauges_.push_back(*gauge);
+      if (i % 100 < changed_percent) {
+        snapshot->gauges_.push_back(*gauge);
+      }
       gauges.push_back(std::move(gauge));
     }
 
@@ -85,7 +93,9 @@ struct BenchmarkSetup {
       histogram->used_ = true;
       histogram->setTags(make_tags(i));
       ON_CALL(*histogram, cumulativeStatistics()).WillByDefault(testing::ReturnRef(*hist_stats));
-      snapshot->histograms_.push_back(*histogram);
+      if (i % 100 < changed_percent) {
+        snapshot->histograms_.push_back(*histogram);
+      }
       histograms.push_back(std::move(histogram));
     }
   }
@@ -139,6 +149,28 @@ void bmOpenTelemetrySinkFlushTrafficSplit200(benchmark::State& state) {
 }
 BENCHMARK(bmOpenTelemetrySinkFlushTrafficSplit200);
 
+// Flushes a partial snapshot in which state.range(0) percent of the metrics changed. 100 is the
+// cost of a full flush.
+void bmOpenTelemetrySinkFlushPartial(benchmark::State& state) {
+  BenchmarkSetup setup(state.range(0));
+  ON_CALL(*setup.snapshot, partial()).WillByDefault(testing::Return(state.range(0) < 100));
+
+  testing::NiceMock<Server::Configuration::MockServerFactoryContext> server_factory_context;
+  envoy::extensions::stat_sinks::open_telemetry::v3::SinkConfig sink_config;
+  Tracers::OpenTelemetry::Resource resource;
+
+  auto options = std::make_shared<OtlpOptions>(sink_config, resource, server_factory_context);
+  auto flusher = std::make_shared<OtlpMetricsFlusherImpl>(options);
+  auto exporter = std::make_shared<DummyExporter>();
+
+  OpenTelemetrySink sink(flusher, exporter, 0);
+
+  for (auto _ : state) {
+    sink.flush(*setup.snapshot);
+  }
+}
+BENCHMARK(bmOpenTelemetrySinkFlushPartial)->Arg(1)->Arg(10)->Arg(100);
+
 } // namespace
 } // namespace OpenTelemetry
 } // namespace StatSinks
@@ -44,7 +44,8 @@ public:
               bool emit_tags_as_attributes = true, bool use_tag_extracted_name = true,
               const std::string& stat_prefix = "",
               absl::flat_hash_map<std::string, std::string> resource_attributes = {},
-              absl::string_view metric_conversion_pbtext = "") {
+              absl::string_view metric_conversion_pbtext = "",
+              absl::optional<uint32_t> exponential_histogram_max_buckets = absl::nullopt) {
     envoy::extensions::stat_sinks::open_telemetry::v3::SinkConfig sink_config;
     sink_config.set_report_counters_as_deltas(report_counters_as_deltas);
     sink_config.set_report_histograms_as_deltas(report_histograms_as_deltas);
@@ -59,6 +60,10 @@ public:
       Protobuf::TextFormat::ParseFromString(metric_conversion_pbtext,
                                             sink_config.mutable_custom_metric_conversions());
     }
+    if (exponential_histogram_max_buckets.has_value()) {
+      sink_config.mutable_exponential_histogram()->mutable_max_buckets()->set_value(
+          *exponential_histogram_max_buckets);
+    }
     return std::make_shared<OtlpOptions>(sink_config, resource, server_factory_context_);
   }
 
@@ -168,6 +173,45 @@ public:
     snapshot_.histograms_.push_back(*histogram_storage_.back());
   }
 
+  // Adds a histogram recording each of `values` once. Its detailed buckets are read from the
+  // circllhist the same way ParentHistogramImpl does.
+  void addExponentialHistogramToSnapshot(const std::string& name,
+                                         const std::vector<double>& values, bool is_delta = false,
+                                         const Stats::TagVector& tags = {{"hist_key", "hist_val"}}) {
+    auto histogram = std::make_unique<NiceMock<Stats::MockParentHistogram>>();
+
+    histogram_t* hist = hist_alloc();
+    for (double value : values) {
+      hist_insert(hist, value, 1);
+    }
+    std::vector<Stats::ParentHistogram::Bucket> buckets(hist_num_buckets(hist));
+    hist_bucket_t hist_bucket;
+    for (uint32_t i = 0; i < buckets.size(); ++i) {
+      hist_bucket_idx_bucket(hist, i, &hist_bucket, &buckets[i].count_);
+      buckets[i].lower_bound_ = hist_bucket_to_double(hist_bucket);
+      buckets[i].width_ = hist_bucket_to_double_bin_width(hist_bucket);
+    }
+
+    histogram_ptrs_.push_back(hist);
+    hist_stats_.push_back(std::make_unique<Stats::HistogramStatisticsImpl>(hist));
+
+    if (is_delta) {
+      ON_CALL(*histogram, intervalStatistics()).WillByDefault(ReturnRef(*hist_stats_.back()));
+      ON_CALL(*histogram, detailedIntervalBuckets()).WillByDefault(Return(buckets));
+    } else {
+      ON_CALL(*histogram, cumulativeStatistics()).WillByDefault(ReturnRef(*hist_stats_.back()));
+      ON_CALL(*histogram, detailedTotalBuckets()).WillByDefault(Return(buckets));
+    }
+
+    histogram_storage_.emplace_back(std::move(histogram));
+    histogram_storage_.back()->name_ = name;
+    histogram_storage_.back()->setTagExtractedName(getTagExtractedName(name));
+    histogram_storage_.back()->used_ = true;
+    histogram_storage_.back()->setTags(tags);
+
+    snapshot_.histograms_.push_back(*histogram_storage_.back());
+  }
+
   long long int expected_time_ns_;
   std::vector<histogram_t*> histogram_ptrs_;
   std::vector<std::unique_ptr<Stats::HistogramStatisticsImpl>> hist_stats_;
@@ -335,6 +379,17 @@ public:
     return metric;
   }
 
+  const opentelemetry::proto::metrics::v1::Metric*
+  findExponentialHistogram(const MetricsExportRequestSharedPtr& metrics, const std::string& name) {
+    const auto* metric = findMetric(metrics, name);
+    EXPECT_NE(metric, nullptr) << "Exponential histogram metric '" << name << "' not found.";
+    if (metric == nullptr) {
+      return nullptr;
+    }
+    EXPECT_TRUE(metric->has_exponential_histogram());
+    return metric;
+  }
+
   void expectGauge(const opentelemetry::proto::metrics::v1::Metric& metric, std::string name,
                    int value) {
     EXPECT_EQ(name, metric.name());
@@ -672,6 +727,102 @@ TEST_F(OtlpMetricsFlusherTests, DeltaHistogramMetric) {
                   getTagExtractedName("test_histogram2"), /*is_delta=*/true);
 }
 
+TEST_F(OtlpMetricsFlusherTests, CumulativeExponentialHistogramMetric) {
+  OtlpMetricsFlusherImpl flusher(otlpOptions(
+      /*report_counters_as_deltas=*/false, /*report_histograms_as_deltas=*/false,
+      /*emit_tags_as_attributes=*/true, /*use_tag_extracted_name=*/true, "", {}, "",
+      OtlpOptions::DefaultExponentialHistogramMaxBuckets));
+
+  addExponentialHistogramToSnapshot("test_histogram1", {0, 1, 2, 4, 8});
+  addExponentialHistogramToSnapshot("test_histogram2", {});
+
+  auto metrics = flushToSingleRequest(flusher);
+  ASSERT_NE(metrics, nullptr);
+  expectMetricsCount(metrics, 2);
+
+  const auto* metric = findExponentialHistogram(metrics, getTagExtractedName("test_histogram1"));
+  ASSERT_NE(metric, nullptr);
+  EXPECT_EQ(AggregationTemporality::AGGREGATION_TEMPORALITY_CUMULATIVE,
+            metric->exponential_histogram().aggregation_temporality());
+  ASSERT_EQ(1, metric->exponential_histogram().data_points().size());
+  const auto& data_point = metric->exponential_histogram().data_points()[0];
+  EXPECT_EQ(cumulative_start_time_ns_, data_point.start_time_unix_nano());
+  EXPECT_EQ(expected_time_ns_, data_point.time_unix_nano());
+  EXPECT_EQ(5, data_point.count());
+  EXPECT_NEAR(15, data_point.sum(), 0.5);
+  EXPECT_EQ(0.5, data_point.zero_threshold());
+  // The recorded 0 is counted in the zero bucket, not the positive buckets.
+  EXPECT_EQ(1, data_point.zero_count());
+  // At scale 4 there are 16 buckets per doubling, and 1 is in bucket (2^(-1/16), 1].
+  EXPECT_EQ(4, data_point.scale());
+  EXPECT_EQ(-1, data_point.positive().offset());
+  ASSERT_EQ(49, data_point.positive().bucket_counts().size());
+  for (int idx = 0; idx < data_point.positive().bucket_counts().size(); idx++) {
+    EXPECT_EQ(idx % 16 == 0 ? 1 : 0, data_point.positive().bucket_counts()[idx]);
+  }
+  expectAttributes(data_point.attributes(), "hist_key", "hist_val");
+
+  // Cumulative points are reported even when nothing has been recorded.
+  const auto* empty_metric =
+      findExponentialHistogram(metrics, getTagExtractedName("test_histogram2"));
+  ASSERT_NE(empty_metric, nullptr);
+  ASSERT_EQ(1, empty_metric->exponential_histogram().data_points().size());
+  const auto& empty_point = empty_metric->exponential_histogram().data_points()[0];
+  EXPECT_EQ(0, empty_point.count());
+  EXPECT_EQ(0, empty_point.zero_count());
+  EXPECT_FALSE(empty_point.has_positive());
+}
+
+TEST_F(OtlpMetricsFlusherTests, DeltaExponentialHistogramMetric) {
+  OtlpMetricsFlusherImpl flusher(otlpOptions(
+      /*report_counters_as_deltas=*/false, /*report_histograms_as_deltas=*/true,
+      /*emit_tags_as_attributes=*/true, /*use_tag_extracted_name=*/true, "", {}, "",
+      OtlpOptions::DefaultExponentialHistogramMaxBuckets));
+
+  addExponentialHistogramToSnapshot("test_histogram1", {1, 2}, /*is_delta=*/true);
+  addExponentialHistogramToSnapshot("test_histogram2", {}, /*is_delta=*/true);
+
+  auto metrics = flushToSingleRequest(flusher);
+  ASSERT_NE(metrics, nullptr);
+  // Delta points with no samples are dropped.
+  expectMetricsCount(metrics, 1);
+
+  const auto* metric = findExponentialHistogram(metrics, getTagExtractedName("test_histogram1"));
+  ASSERT_NE(metric, nullptr);
+  EXPECT_EQ(AggregationTemporality::AGGREGATION_TEMPORALITY_DELTA,
+            metric->exponential_histogram().aggregation_temporality());
+  ASSERT_EQ(1, metric->exponential_histogram().data_points().size());
+  const auto& data_point = metric->exponential_histogram().data_points()[0];
+  EXPECT_EQ(delta_start_time_ns_, data_point.start_time_unix_nano());
+  EXPECT_EQ(2, data_point.count());
+  EXPECT_EQ(0, data_point.zero_count());
+  EXPECT_EQ(4, data_point.scale());
+  EXPECT_EQ(-1, data_point.positive().offset());
+  ASSERT_EQ(17, data_point.positive().bucket_counts().size());
+  EXPECT_EQ(1, data_point.positive().bucket_counts()[0]);
+  EXPECT_EQ(1, data_point.positive().bucket_counts()[16]);
+}
+
+TEST_F(OtlpMetricsFlusherTests, ExponentialHistogramDownscalesToMaxBuckets) {
+  OtlpMetricsFlusherImpl flusher(otlpOptions(
+      /*report_counters_as_deltas=*/false, /*report_histograms_as_deltas=*/false,
+      /*emit_tags_as_attributes=*/true, /*use_tag_extracted_name=*/true, "", {}, "",
+      /*exponential_histogram_max_buckets=*/4));
+
+  // Spans 49 buckets at scale 4, so the scale is reduced until one bucket covers each doubling.
+  addExponentialHistogramToSnapshot("test_histogram", {1, 2, 4, 8});
+
+  auto metrics = flushToSingleRequest(flusher);
+  ASSERT_NE(metrics, nullptr);
+  const auto* metric = findExponentialHistogram(metrics, getTagExtractedName("test_histogram"));
+  ASSERT_NE(metric, nullptr);
+  const auto& data_point = metric->exponential_histogram().data_points()[0];
+  EXPECT_EQ(4, data_point.count());
+  EXPECT_EQ(0, data_point.scale());
+  EXPECT_EQ(-1, data_point.positive().offset());
+  EXPECT_THAT(data_point.positive().bucket_counts(), testing::ElementsAre(1, 1, 1, 1));
+}
+
 TEST_F(OtlpMetricsFlusherTests, SetResourceAttributes) {
   OtlpMetricsFlusherImpl flusher(
       otlpOptions(true, false, true, true, "", {{"key_foo", "val_foo"}}));
@@ -1082,6 +1233,69 @@ TEST_F(OtlpMetricsFlusherAggregationTests, MetricsWithLabelsAggregationHistogram
   expectAttributes(unmapped_metric.histogram().data_points()[1].attributes(), "keyY", "valY");
 }
 
+TEST_F(OtlpMetricsFlusherAggregationTests, ExponentialHistogramAggregationMergesBuckets) {
+  OtlpMetricsFlusherImpl flusher(otlpOptions(false, false, true, true, "", {},
+                                             R"pb( matcher_list {
+             matchers {
+               predicate {
+                 single_predicate {
+                   input {
+                     name: "stat_full_name_match_input"
+                     typed_config {
+                       [type.googleapis.com/
+                        envoy.extensions.matching.common_inputs.stats.v3.StatFullNameMatchInput] {}
+                     }
+                   }
+                   value_match { safe_regex { regex: "test_histogram-." } }
+                 }
+               }
+               on_match {
+                 action {
+                   name: "otlp_metric_conversion"
+                   typed_config {
+                     [type.googleapis.com/envoy.extensions.stat_sinks
+                          .open_telemetry.v3.SinkConfig.ConversionAction] {
+                       metric_name: "new_histogram_name"
+                     }
+                   }
+                 }
+               }
+             }
+           })pb",
+                                             /*exponential_histogram_max_buckets=*/20));
+  // On their own, both fit in 17 buckets at scale 4, at offsets -1 and 31 respectively.
+  addExponentialHistogramToSnapshot("test_histogram-1", {1, 2}, false, {{"key", "hist1"}});
+  addExponentialHistogramToSnapshot("test_histogram-2", {0, 4, 8}, false, {{"key", "hist1"}});
+  addExponentialHistogramToSnapshot("other_histogram", {4, 8}, false, {{"key", "hist1"}});
+
+  auto metrics = flushToSingleRequest(flusher);
+  ASSERT_NE(metrics, nullptr);
+  expectMetricsCount(metrics, 2);
+
+  // The merged point spans 49 buckets at scale 4, so it is downscaled to scale 2 to fit in 20.
+  const auto* merged = findExponentialHistogram(metrics, "new_histogram_name");
+  ASSERT_NE(merged, nullptr);
+  ASSERT_EQ(1, merged->exponential_histogram().data_points().size());
+  const auto& merged_point = merged->exponential_histogram().data_points()[0];
+  EXPECT_EQ(5, merged_point.count());
+  EXPECT_EQ(1, merged_point.zero_count());
+  EXPECT_EQ(2, merged_point.scale());
+  EXPECT_EQ(-1, merged_point.positive().offset());
+  EXPECT_THAT(merged_point.positive().bucket_counts(),
+              testing::ElementsAre(1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1));
+  expectAttributes(merged_point.attributes(), "key", "hist1");
+
+  const auto* other = findExponentialHistogram(metrics, getTagExtractedName("other_histogram"));
+  ASSERT_NE(other, nullptr);
+  const auto& other_point = other->exponential_histogram().data_points()[0];
+  EXPECT_EQ(2, other_point.count());
+  EXPECT_EQ(4, other_point.scale());
+  EXPECT_EQ(31, other_point.positive().offset());
+  ASSERT_EQ(17, other_point.positive().bucket_counts().size());
+  EXPECT_EQ(1, other_point.positive().bucket_counts()[0]);
+  EXPECT_EQ(1, other_point.positive().bucket_counts()[16]);
+}
+
 TEST_F(OtlpMetricsFlusherAggregationTests, MetricsWithStaticMetricLabels) {
   OtlpMetricsFlusherImpl flusher(otlpOptions(false, false, true, true, "", {},
                                              R"pb(
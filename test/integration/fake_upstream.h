@@ -250,6 +250,7 @@ public:
   }
   AccessLog::InstanceSharedPtrVector accessLogHandlers() override { return access_log_handlers_; }
   Http::RequestDecoderHandlePtr getRequestDecoderHandle() override;
+  Http::StreamArenaSharedPtr streamArena() override { return nullptr; }
 
   // Http::StreamCallbacks
   void onResetStream(Http::StreamResetReason reason,
@@ -964,6 +965,9 @@ private:
     std::chrono::milliseconds perConnectionBufferHighWatermarkTimeout() const override {
       return std::chrono::milliseconds::zero();
     }
+    std::chrono::milliseconds perConnectionIdleMemoryShedTimeout() const override {
+      return std::chrono::milliseconds::zero();
+    }
     std::chrono::milliseconds listenerFiltersTimeout() const override { return {}; }
     bool continueOnListenerFiltersTimeout() const override { return false; }
     Stats::Scope& listenerScope() override { return *parent_.stats_store_.rootScope(); }
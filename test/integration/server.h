@@ -251,10 +251,10 @@ public:
 
 protected:
   Stats::Counter* makeCounterInternal(StatName name, StatName tag_extracted_name,
-                                      StatNameTagSpan stat_name_tags) override {
+                                      StatNameTagSpan stat_name_tags, bool sharded) override {
     Stats::Counter* counter = new NotifyingCounter(
-        Stats::Allocator::makeCounterInternal(name, tag_extracted_name, stat_name_tags), mutex_,
-        condvar_);
+        Stats::Allocator::makeCounterInternal(name, tag_extracted_name, stat_name_tags, sharded),
+        mutex_, condvar_);
     {
       absl::MutexLock l(mutex_);
       // Allow getting the counter directly from the allocator, since it's harder to
@@ -390,6 +390,7 @@ public:
   void addSink(Sink&) override {}
   void setTagProducer(TagProducerPtr&&) override {}
   void setStatsMatcher(StatsMatcherPtr&&) override {}
+  void setShardedCounterMatcher(StatsMatcherPtr&&) override {}
   void setHistogramSettings(HistogramSettingsConstPtr&&) override {}
   void initializeThreading(Event::Dispatcher&, ThreadLocal::Instance&) override {}
   void shutdownThreading() override {}
@@ -266,6 +266,47 @@ TEST_P(TcpProxyIntegrationTest, TcpProxyLargeWrite) {
   EXPECT_EQ(downstream_pauses, downstream_resumes);
 }
 
+#if defined(__linux__)
+// Test that payload and half closes are forwarded in both directions when splice is enabled.
+TEST_P(TcpProxyIntegrationTest, TcpProxySpliceLargeWrite) {
+  config_helper_.addConfigModifier([&](envoy::config::bootstrap::v3::Bootstrap& bootstrap) -> void {
+    auto* listener = bootstrap.mutable_static_resources()->mutable_listeners(0);
+    auto* filter_chain = listener->mutable_filter_chains(0);
+    auto* config_blob = filter_chain->mutable_filters(0)->mutable_typed_config();
+    auto tcp_proxy_config =
+        MessageUtil::anyConvert<envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy>(
+            *config_blob);
+    tcp_proxy_config.set_enable_splice(true);
+    config_blob->PackFrom(tcp_proxy_config);
+  });
+  initialize();
+
+  // Larger than the pipe capacity so that each direction has to cycle its pipe.
+  std::string data(1024 * 512, 'a');
+  IntegrationTcpClientPtr tcp_client = makeTcpConnection(lookupPort("tcp_proxy"));
+  FakeRawConnectionPtr fake_upstream_connection;
+  ASSERT_TRUE(fake_upstreams_[0]->waitForRawConnection(fake_upstream_connection));
+  test_server_->waitForCounter("tcp.tcpproxy_stats.downstream_cx_splice_total", Eq(1));
+
+  ASSERT_TRUE(tcp_client->write(data));
+  ASSERT_TRUE(fake_upstream_connection->waitForData(data.size()));
+  ASSERT_TRUE(fake_upstream_connection->write(data));
+  tcp_client->waitForData(data);
+
+  ASSERT_TRUE(fake_upstream_connection->write("", true));
+  tcp_client->waitForHalfClose();
+  ASSERT_TRUE(tcp_client->write("", true));
+  ASSERT_TRUE(fake_upstream_connection->waitForHalfClose());
+  ASSERT_TRUE(fake_upstream_connection->waitForDisconnect());
+  tcp_client->waitForDisconnect();
+
+  test_server_->waitForCounter("tcp.tcpproxy_stats.downstream_cx_rx_bytes_total",
+                               Eq(data.size()));
+  test_server_->waitForCounter("tcp.tcpproxy_stats.downstream_cx_tx_bytes_total",
+                               Eq(data.size()));
+}
+#endif
+
 // Test that a downstream flush works correctly (all data is flushed)
 TEST_P(TcpProxyIntegrationTest, TcpProxyDownstreamFlush) {
   // Use a very large size to make sure it is larger than the kernel socket read buffer.
@@ -709,6 +709,8 @@ public:
   }
   MOCK_METHOD(uint32_t, maxRequestsPerConnection, (), (const));
   MOCK_METHOD(const HttpConnectionManagerProto::ProxyStatusConfig*, proxyStatusConfig, (), (const));
+  MOCK_METHOD(const FilterLatencyConfig*, filterLatencyConfig, (), (const));
+  MOCK_METHOD(uint32_t, streamArenaInitialBlockSize, (), (const));
   MOCK_METHOD(ServerHeaderValidatorPtr, makeHeaderValidator, (Protocol protocol));
   MOCK_METHOD(bool, appendLocalOverload, (), (const));
   MOCK_METHOD(bool, appendXForwardedPort, (), (const));
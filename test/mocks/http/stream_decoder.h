@@ -43,6 +43,10 @@ public:
   MOCK_METHOD(void, decodeTrailers_, (RequestTrailerMapPtr & trailers));
   MOCK_METHOD(AccessLog::InstanceSharedPtrVector, accessLogHandlers, ());
   MOCK_METHOD(RequestDecoderHandlePtr, getRequestDecoderHandle, ());
+  // Not a mock method so that strict mocks need not expect it.
+  StreamArenaSharedPtr streamArena() override { return stream_arena_; }
+
+  StreamArenaSharedPtr stream_arena_;
 };
 
 class MockResponseDecoder : public ResponseDecoderImplBase {
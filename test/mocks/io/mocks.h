@@ -16,21 +16,40 @@ public:
   MOCK_METHOD(IoUringResult, prepareAccept,
               (os_fd_t fd, struct sockaddr* remote_addr, socklen_t* remote_addr_len,
                Request* user_data));
+  MOCK_METHOD(IoUringResult, prepareAcceptMultishot, (os_fd_t fd, Request* user_data));
   MOCK_METHOD(IoUringResult, prepareConnect,
               (os_fd_t fd, const Network::Address::InstanceConstSharedPtr& address,
                Request* user_data));
   MOCK_METHOD(IoUringResult, prepareReadv,
               (os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs, off_t offset,
                Request* user_data));
+  MOCK_METHOD(IoUringResult, prepareRecvMultishot, (os_fd_t fd, Request* user_data));
+  MOCK_METHOD(IoUringResult, prepareRecvmsg, (os_fd_t fd, struct msghdr* msg, Request* user_data));
+  MOCK_METHOD(IoUringResult, prepareRecvmsgMultishot,
+              (os_fd_t fd, struct msghdr* msg, Request* user_data));
   MOCK_METHOD(IoUringResult, prepareWritev,
               (os_fd_t fd, const struct iovec* iovecs, unsigned nr_vecs, off_t offset,
                Request* user_data));
   MOCK_METHOD(IoUringResult, prepareClose, (os_fd_t fd, Request* user_data));
   MOCK_METHOD(IoUringResult, prepareCancel, (Request * cancelling_user_data, Request* user_data));
   MOCK_METHOD(IoUringResult, prepareShutdown, (os_fd_t fd, int how, Request* user_data));
+  MOCK_METHOD(IoUringResult, prepareOpenat,
+              (os_fd_t dir_fd, const char* path, int flags, mode_t mode, Request* user_data));
+  MOCK_METHOD(IoUringResult, prepareStatx,
+              (os_fd_t dir_fd, const char* path, int flags, unsigned mask,
+               struct statx* statx_buf, Request* user_data));
+  MOCK_METHOD(IoUringResult, prepareUnlinkat,
+              (os_fd_t dir_fd, const char* path, int flags, Request* user_data));
+  MOCK_METHOD(IoUringResult, prepareLinkat,
+              (os_fd_t old_dir_fd, const char* old_path, os_fd_t new_dir_fd, const char* new_path,
+               int flags, Request* user_data));
+  MOCK_METHOD(IoUringResult, prepareFtruncate, (os_fd_t fd, off_t length, Request* user_data));
   MOCK_METHOD(IoUringResult, submit, ());
   MOCK_METHOD(void, injectCompletion, (os_fd_t fd, Request* user_data, int32_t result));
   MOCK_METHOD(void, removeInjectedCompletion, (os_fd_t fd));
+  MOCK_METHOD(IoUringResult, registerProvidedBuffers, (uint32_t num_buffers, uint32_t buffer_size));
+  MOCK_METHOD(uint8_t*, providedBuffer, (uint16_t buffer_id));
+  MOCK_METHOD(void, recycleProvidedBuffer, (uint16_t buffer_id));
 };
 
 class MockIoUringSocket : public IoUringSocket {
@@ -57,6 +76,8 @@ public:
   MOCK_METHOD(const OptRef<ReadParam>&, getReadParam, (), (const));
   MOCK_METHOD(const OptRef<WriteParam>&, getWriteParam, (), (const));
   MOCK_METHOD(void, setFileReadyCb, (Event::FileReadyCb cb));
+  MOCK_METHOD(os_fd_t, nextAcceptedSocket, ());
+  MOCK_METHOD(ReceivedDatagramPtr, nextReceivedDatagram, ());
 };
 
 class MockIoUringWorker : public IoUringWorker {
@@ -68,16 +89,21 @@ public:
                bool enable_close_event));
   MOCK_METHOD(IoUringSocket&, addClientSocket,
               (os_fd_t fd, Event::FileReadyCb cb, bool enable_close_event));
+  MOCK_METHOD(IoUringSocket&, addAcceptSocket, (os_fd_t fd, Event::FileReadyCb cb));
+  MOCK_METHOD(IoUringSocket&, addDatagramSocket, (os_fd_t fd, Event::FileReadyCb cb));
   MOCK_METHOD(Event::Dispatcher&, dispatcher, ());
+  MOCK_METHOD(Request*, submitAcceptRequest, (IoUringSocket & socket));
   MOCK_METHOD(Request*, submitConnectRequest,
               (IoUringSocket & socket, const Network::Address::InstanceConstSharedPtr& address));
   MOCK_METHOD(Request*, submitReadRequest, (IoUringSocket & socket));
+  MOCK_METHOD(Request*, submitRecvmsgRequest, (IoUringSocket & socket));
   MOCK_METHOD(Request*, submitWriteRequest,
               (IoUringSocket & socket, const Buffer::RawSliceVector& slices));
   MOCK_METHOD(Request*, submitCloseRequest, (IoUringSocket & socket));
   MOCK_METHOD(Request*, submitCancelRequest, (IoUringSocket & socket, Request* request_to_cancel));
   MOCK_METHOD(Request*, submitShutdownRequest, (IoUringSocket & socket, int how));
   MOCK_METHOD(uint32_t, getNumOfSockets, (), (const));
+  MOCK_METHOD(bool, hasProvidedBuffers, (), (const));
 };
 
 class MockIoUringWorkerFactory : public IoUringWorkerFactory {
@@ -66,6 +66,7 @@ public:
   MOCK_METHOD(uint64_t, id, (), (const));                                                          \
   MOCK_METHOD(void, hashKey, (std::vector<uint8_t>&), (const));                                    \
   MOCK_METHOD(bool, initializeReadFilters, ());                                                    \
+  MOCK_METHOD(bool, isSoleFilter, (const ReadFilter& filter), (const));                            \
   MOCK_METHOD(std::string, nextProtocol, (), (const));                                             \
   MOCK_METHOD(void, noDelay, (bool enable));                                                       \
   MOCK_METHOD(ReadDisableStatus, readDisable, (bool disable));                                     \
@@ -77,7 +78,9 @@ public:
   MOCK_METHOD(absl::optional<Connection::UnixDomainSocketPeerCredentials>,                         \
               unixSocketPeerCredentials, (), (const));                                             \
   MOCK_METHOD(void, setConnectionStats, (const ConnectionStats& stats));                           \
+  MOCK_METHOD(void, addDirectSocketBytes, (uint64_t bytes_read, uint64_t bytes_written));          \
   MOCK_METHOD(Ssl::ConnectionInfoConstSharedPtr, ssl, (), (const));                                \
+  MOCK_METHOD(bool, hasPassthroughTransport, (), (const));                                         \
   MOCK_METHOD(absl::string_view, requestedServerName, (), (const));                                \
   MOCK_METHOD(absl::string_view, ja3Hash, (), (const));                                            \
   MOCK_METHOD(absl::string_view, ja4Hash, (), (const));                                            \
@@ -121,6 +124,8 @@ public:
 
   // Network::ServerConnection
   MOCK_METHOD(void, setTransportSocketConnectTimeout, (std::chrono::milliseconds, Stats::Counter&));
+  MOCK_METHOD(void, setIdleMemoryShedTimeout,
+              (std::chrono::milliseconds, Stats::Counter&, Stats::Counter&));
 };
 
 /**
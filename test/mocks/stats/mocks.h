@@ -262,6 +262,7 @@ public:
   MOCK_METHOD(const std::vector<Stats::PrimitiveCounterSnapshot>&, hostCounters, ());
   MOCK_METHOD(const std::vector<Stats::PrimitiveGaugeSnapshot>&, hostGauges, ());
   MOCK_METHOD(SystemTime, snapshotTime, (), (const));
+  MOCK_METHOD(bool, partial, (), (const));
 
   std::vector<CounterSnapshot> counters_;
   std::vector<std::reference_wrapper<const Gauge>> gauges_;
@@ -49,6 +49,8 @@ public:
     overprovisioning_factor_ = overprovisioning_factor;
   }
   bool weightedPriorityHealth() const override { return weighted_priority_health_; }
+  // Load balancers check the weights of the hosts themselves.
+  bool hostWeightsAreEqual() const override { return false; }
 
   HostVector hosts_;
   HostVector healthy_hosts_;
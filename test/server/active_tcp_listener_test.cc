@@ -1,3 +1,4 @@
+#include <limits>
 #include <memory>
 
 #include "envoy/network/filter.h"
@@ -154,6 +155,42 @@ TEST_F(ActiveTcpListenerTest, ListenerFilterWithoutInspectData) {
   tcp_socket->continueFilterChain(true);
 }
 
+#if defined(SO_INCOMING_CPU)
+TEST_F(ActiveTcpListenerTest, CountsConnectionsReceivedOnOtherCpu) {
+  auto listener_info = std::make_shared<NiceMock<Network::MockListenerInfo>>();
+  ON_CALL(*listener_info, trackIncomingCpu()).WillByDefault(Return(true));
+  listener_config_.listener_info_ = listener_info;
+  initializeWithFilter();
+
+  EXPECT_CALL(*filter_, onAccept(_)).WillOnce(Return(Network::FilterStatus::StopIteration));
+  EXPECT_CALL(io_handle_, isOpen()).WillRepeatedly(Return(true));
+  // No CPU ever has this index, so the connection is always non-local.
+  EXPECT_CALL(*generic_accepted_socket_, getSocketOption(SOL_SOCKET, SO_INCOMING_CPU, _, _))
+      .WillOnce(Invoke([](int, int, void* optval, socklen_t*) -> Api::SysCallIntResult {
+        *static_cast<int*>(optval) = std::numeric_limits<int>::max();
+        return {0, 0};
+      }));
+  generic_active_listener_->onAcceptWorker(std::move(generic_accepted_socket_), false, true, {});
+  EXPECT_EQ(1, generic_active_listener_->stats_.downstream_cx_non_local_cpu_.value());
+
+  EXPECT_CALL(manager_, findFilterChain(_, _)).WillOnce(Return(nullptr));
+  generic_active_listener_->sockets().front()->continueFilterChain(true);
+}
+#endif
+
+TEST_F(ActiveTcpListenerTest, IncomingCpuNotTrackedByDefault) {
+  initializeWithFilter();
+
+  EXPECT_CALL(*filter_, onAccept(_)).WillOnce(Return(Network::FilterStatus::StopIteration));
+  EXPECT_CALL(io_handle_, isOpen()).WillRepeatedly(Return(true));
+  EXPECT_CALL(*generic_accepted_socket_, getSocketOption(_, _, _, _)).Times(0);
+  generic_active_listener_->onAcceptWorker(std::move(generic_accepted_socket_), false, true, {});
+  EXPECT_EQ(0, generic_active_listener_->stats_.downstream_cx_non_local_cpu_.value());
+
+  EXPECT_CALL(manager_, findFilterChain(_, _)).WillOnce(Return(nullptr));
+  generic_active_listener_->sockets().front()->continueFilterChain(true);
+}
+
 /**
  * Execute peek data two times, then filter return successful.
  */
@@ -20,6 +20,7 @@
 #include "test/test_common/stats_utility.h"
 #include "test/test_common/utility.h"
 
+using testing::HasSubstr;
 using testing::NiceMock;
 using testing::Ref;
 using testing::ReturnRef;
@@ -2848,5 +2849,106 @@ TEST_F(RealHistogramNativePrometheusTest, NativeHistogramSchemaFallback) {
       << "Value 1000000000 should be in bucket 1 at schema -4";
 }
 
+TEST_F(PrometheusStatsFormatterTest, PrefixCache) {
+  Stats::CustomStatNamespacesImpl custom_namespaces;
+
+  addCounter("cluster.test_1.upstream_cx_total",
+             {{makeStat("a.tag-name"), makeStat("a.tag-value")}});
+  addCounter("cluster.test_1.upstream_cx_total", {{makeStat("another_tag_name"),
+                                                  makeStat("another_tag\"value")}});
+  addGauge("cluster.test_2.upstream_cx_active", {});
+  addTextReadout("control_plane.identifier", "cp-1", {{makeStat("cluster"), makeStat("c1")}});
+  addTextReadout("control_plane.version", "v1", {});
+
+  Buffer::OwnedImpl expected;
+  PrometheusStatsFormatter::statsAsPrometheusText(counters_, gauges_, histograms_, textReadouts_,
+                                                  endpoints_helper_->cm_, expected, StatsParams(),
+                                                  custom_namespaces);
+
+  PrometheusStatsFormatter::PrefixCache cache(*symbol_table_);
+  const auto scrape = [&](const StatsParams& params = StatsParams()) {
+    Http::TestRequestHeaderMapImpl request_headers;
+    Http::TestResponseHeaderMapImpl response_headers;
+    auto output_format = PrometheusStatsFormatter::makeOutputFormat(params, request_headers,
+                                                                    response_headers, &cache);
+    const uint64_t generation = cache.startScrape();
+    Buffer::OwnedImpl response;
+    PrometheusStatsFormatter::generateWithOutputFormat(counters_, gauges_, histograms_,
+                                                      textReadouts_, endpoints_helper_->cm_,
+                                                      response, params, custom_namespaces,
+                                                      *output_format);
+    cache.finishScrape(generation, params);
+    return response.toString();
+  };
+
+  // Rendering from cached prefixes does not change the output.
+  EXPECT_EQ(expected.toString(), scrape());
+  EXPECT_EQ(5UL, cache.size());
+  textReadouts_.front()->set("cp-2");
+  EXPECT_THAT(scrape(), HasSubstr("envoy_control_plane_identifier{cluster=\"c1\","
+                                  "text_value=\"cp-2\"} 0\n"));
+  EXPECT_EQ(5UL, cache.size());
+
+  // Scrapes that only render some of the metrics don't drop the entries of the others.
+  StatsParams filtered;
+  filtered.re2_filter_ = std::make_shared<re2::RE2>("upstream_cx_active");
+  EXPECT_THAT(scrape(filtered), HasSubstr("envoy_cluster_test_2_upstream_cx_active"));
+  EXPECT_EQ(5UL, cache.size());
+  StatsParams used_only;
+  used_only.used_only_ = true;
+  scrape(used_only);
+  EXPECT_EQ(5UL, cache.size());
+
+  // Entries of metrics that are not exported anymore are dropped.
+  counters_.pop_back();
+  textReadouts_.clear();
+  scrape();
+  EXPECT_EQ(2UL, cache.size());
+}
+
+TEST_F(PrometheusStatsFormatterTest, StreamingRendererChunks) {
+  Stats::CustomStatNamespacesImpl custom_namespaces;
+
+  addCounter("cluster.test_1.upstream_cx_total",
+             {{makeStat("a.tag-name"), makeStat("a.tag-value")}});
+  addCounter("cluster.test_2.upstream_cx_total",
+             {{makeStat("another_tag_name"), makeStat("another_tag-value")}});
+  addGauge("cluster.test_3.upstream_cx_total",
+           {{makeStat("another_tag_name_3"), makeStat("another_tag_3-value")}});
+  addClusterEndpoints("cluster1", 1, {{"a.tag-name", "a.tag-value"}});
+
+  Buffer::OwnedImpl expected;
+  const uint64_t expected_count = PrometheusStatsFormatter::statsAsPrometheusText(
+      counters_, gauges_, histograms_, textReadouts_, endpoints_helper_->cm_, expected,
+      StatsParams(), custom_namespaces);
+
+  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestResponseHeaderMapImpl response_headers;
+  StatsParams params;
+  auto output_format = PrometheusStatsFormatter::makeOutputFormat(params, request_headers,
+                                                                  response_headers, nullptr);
+  PrometheusStatsFormatter::StreamingRenderer renderer(counters_, gauges_, histograms_,
+                                                       textReadouts_, endpoints_helper_->cm_,
+                                                       params, custom_namespaces, *output_format);
+
+  // With a chunk size of one byte, every chunk holds a single metric group.
+  std::string streamed;
+  uint64_t chunks = 0;
+  bool more;
+  do {
+    Buffer::OwnedImpl chunk;
+    more = renderer.nextChunk(chunk, 1);
+    if (chunk.length() > 0) {
+      ++chunks;
+      EXPECT_TRUE(absl::StartsWith(chunk.toString(), "# TYPE"));
+    }
+    streamed += chunk.toString();
+  } while (more);
+
+  EXPECT_EQ(expected.toString(), streamed);
+  EXPECT_EQ(expected_count, renderer.metricNameCount());
+  EXPECT_EQ(expected_count, chunks);
+}
+
 } // namespace Server
 } // namespace Envoy
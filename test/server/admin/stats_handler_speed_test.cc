@@ -5,6 +5,7 @@
 #include "source/common/http/header_map_impl.h"
 #include "source/common/stats/custom_stat_namespaces_impl.h"
 #include "source/common/stats/thread_local_store.h"
+#include "source/extensions/compression/gzip/compressor/config.h"
 #include "source/server/admin/stats_handler.h"
 
 #include "test/benchmark/main.h"
@@ -219,7 +220,36 @@ public:
     return count;
   }
 
+  /**
+   * Issues a streamed prometheus request against the stats saved in store_, rendering metric names
+   * and labels from the prefix cache that is shared across calls.
+   */
+  uint64_t handlerPrometheusStream(const StatsParams& params,
+                                   Compression::Compressor::CompressorFactory* compressor_factory) {
+    if (prefix_cache_ == nullptr) {
+      prefix_cache_ =
+          std::make_unique<PrometheusStatsFormatter::PrefixCache>(store_->symbolTable());
+    }
+    Buffer::OwnedImpl data;
+    auto request_headers = Http::RequestHeaderMapImpl::create();
+    auto response_headers = Http::ResponseHeaderMapImpl::create();
+    Admin::RequestPtr request =
+        StatsHandler::makePrometheusRequest(*store_, custom_namespaces_, cm_, params,
+                                            *request_headers, prefix_cache_.get(),
+                                            compressor_factory);
+    request->start(*response_headers);
+    uint64_t count = 0;
+    bool more = true;
+    do {
+      more = request->nextChunk(data);
+      count += data.length();
+      data.drain(data.length());
+    } while (more);
+    return count;
+  }
+
   std::vector<Stats::ScopeSharedPtr> scopes_;
+  std::unique_ptr<PrometheusStatsFormatter::PrefixCache> prefix_cache_;
   Envoy::Stats::CustomStatNamespacesImpl custom_namespaces_;
   FastMockClusterManager cm_;
   bool endpoint_stats_initialized_{false};
@@ -459,6 +489,53 @@ BENCHMARK_CAPTURE(BM_PrometheusFull, per_endpoint_stats_disabled, false)
 BENCHMARK_CAPTURE(BM_PrometheusFull, per_endpoint_stats_enabled, true)
     ->Unit(benchmark::kMillisecond);
 
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_PrometheusStreamed(benchmark::State& state, bool per_endpoint_stats) {
+  Envoy::Server::StatsHandlerTest& test_context = testContext(per_endpoint_stats);
+  Envoy::Server::StatsParams params;
+  Envoy::Buffer::OwnedImpl response;
+  params.parse("?format=prometheus", response);
+  const uint64_t lower_limit = per_endpoint_stats ? 400 * 1000 * 1000 : 200 * 1000 * 1000;
+  const uint64_t upper_limit = per_endpoint_stats ? 420 * 1000 * 1000 : 300 * 1000 * 1000;
+
+  // The first scrape fills the prefix cache; the iterations measure scrapes rendered from it.
+  test_context.handlerPrometheusStream(params, nullptr);
+  uint64_t count;
+  for (auto _ : state) { // NOLINT
+    count = test_context.handlerPrometheusStream(params, nullptr);
+    RELEASE_ASSERT(count > lower_limit, "expected count > lower_limit");
+    RELEASE_ASSERT(count < upper_limit, "expected count < upper_limit");
+  }
+
+  auto label = absl::StrCat("output per iteration: ", count);
+  state.SetLabel(label);
+}
+BENCHMARK_CAPTURE(BM_PrometheusStreamed, per_endpoint_stats_disabled, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PrometheusStreamed, per_endpoint_stats_enabled, true)
+    ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_PrometheusStreamedGzip(benchmark::State& state) {
+  Envoy::Server::StatsHandlerTest& test_context = testContext(false);
+  Envoy::Server::StatsParams params;
+  Envoy::Buffer::OwnedImpl response;
+  params.parse("?format=prometheus", response);
+  Envoy::Extensions::Compression::Gzip::Compressor::GzipCompressorFactory compressor_factory(
+      envoy::extensions::compression::gzip::compressor::v3::Gzip{});
+
+  test_context.handlerPrometheusStream(params, &compressor_factory);
+  uint64_t count;
+  for (auto _ : state) { // NOLINT
+    count = test_context.handlerPrometheusStream(params, &compressor_factory);
+    RELEASE_ASSERT(count < 100 * 1000 * 1000, "expected count < 100M");
+  }
+
+  auto label = absl::StrCat("compressed output per iteration: ", count);
+  state.SetLabel(label);
+}
+BENCHMARK(BM_PrometheusStreamedGzip)->Unit(benchmark::kMillisecond);
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_HistogramsJson(benchmark::State& state, bool per_endpoint_stats) {
   Envoy::Server::StatsHandlerTest& test_context = testContext(per_endpoint_stats);
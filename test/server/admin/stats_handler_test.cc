@@ -2,7 +2,9 @@
 #include <string>
 
 #include "source/common/common/regex.h"
+#include "source/extensions/compression/gzip/decompressor/zlib_decompressor_impl.h"
 #include "source/common/stats/custom_stat_namespaces_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
 #include "source/common/stats/thread_local_store.h"
 #include "source/server/admin/stats_handler.h"
 #include "source/server/admin/stats_request.h"
@@ -95,8 +97,8 @@ public:
     StatsHandler handler(instance);
     request_headers_.setPath(url);
     Admin::RequestPtr request = handler.makeRequest(admin_stream_);
-    Http::TestResponseHeaderMapImpl response_headers;
-    Http::Code code = request->start(response_headers);
+    response_headers_ = Http::TestResponseHeaderMapImpl();
+    Http::Code code = request->start(response_headers_);
     Buffer::OwnedImpl data;
     while (request->nextChunk(data)) {
     }
@@ -135,6 +137,7 @@ public:
   Stats::ThreadLocalStoreImplPtr store_;
   Stats::CustomStatNamespacesImpl custom_namespaces_;
   Http::TestRequestHeaderMapImpl request_headers_;
+  Http::TestResponseHeaderMapImpl response_headers_;
   MockAdminStream admin_stream_;
   Configuration::MockStatsConfig stats_config_;
 };
@@ -1566,6 +1569,42 @@ TEST_F(StatsHandlerPrometheusDefaultTest, HandlerStatsPrometheusUnsupportedBucke
   EXPECT_EQ(expected_response, code_response.second);
 }
 
+TEST_F(StatsHandlerPrometheusDefaultTest, HandlerStatsPrometheusGzip) {
+  const std::string url = "/stats?format=prometheus";
+
+  createTestStats();
+  const CodeResponse uncompressed = handlerStats(url);
+  EXPECT_FALSE(response_headers_.has(Http::CustomHeaders::get().ContentEncoding));
+
+  // Brotli is not offered for prometheus responses, so the next accepted coding is used.
+  request_headers_.setCopy(Http::CustomHeaders::get().AcceptEncoding, "br, gzip;q=0.5");
+  const CodeResponse compressed = handlerStats(url);
+  EXPECT_EQ(Http::Code::OK, compressed.first);
+  EXPECT_EQ("gzip", response_headers_.get_(Http::CustomHeaders::get().ContentEncoding));
+  EXPECT_EQ("Accept-Encoding", response_headers_.get_(Http::CustomHeaders::get().Vary));
+
+  Stats::IsolatedStoreImpl decompressor_store;
+  Extensions::Compression::Gzip::Decompressor::ZlibDecompressorImpl decompressor(
+      *decompressor_store.rootScope(), "test.", 4096, 100);
+  decompressor.init(31);
+  Buffer::OwnedImpl input(compressed.second);
+  Buffer::OwnedImpl output;
+  decompressor.decompress(input, output);
+  EXPECT_EQ(uncompressed.second, output.toString());
+}
+
+TEST_F(StatsHandlerPrometheusDefaultTest, HandlerStatsPrometheusRefusedEncoding) {
+  const std::string url = "/stats?format=prometheus";
+
+  createTestStats();
+  request_headers_.setCopy(Http::CustomHeaders::get().AcceptEncoding, "gzip;q=0, identity");
+  const CodeResponse code_response = handlerStats(url);
+  EXPECT_EQ(Http::Code::OK, code_response.first);
+  EXPECT_FALSE(response_headers_.has(Http::CustomHeaders::get().ContentEncoding));
+  EXPECT_THAT(code_response.second,
+              HasSubstr("envoy_cluster_upstream_cx_total{cluster=\"c1\"} 10\n"));
+}
+
 class StatsHandlerPrometheusWithTextReadoutsTest
     : public StatsHandlerPrometheusTest,
       public testing::TestWithParam<std::tuple<Network::Address::IpVersion, std::string>> {};
@@ -94,6 +94,7 @@ TEST_F(ConfigurationImplTest, DefaultStatsFlushInterval) {
   EXPECT_EQ(std::chrono::milliseconds(5000), config.statsConfig().flushInterval());
   EXPECT_FALSE(config.statsConfig().flushOnAdmin());
   EXPECT_EQ(0, config.statsConfig().evictOnFlush());
+  EXPECT_EQ(0, config.statsConfig().fullFlushOnFlush());
 }
 
 TEST_F(ConfigurationImplTest, CustomStatsFlushInterval) {
@@ -252,6 +253,34 @@ TEST_F(ConfigurationImplTest, EvictionNotMultiple) {
               testing::HasSubstr("must be a multiple"));
 }
 
+TEST_F(ConfigurationImplTest, FullFlush) {
+  std::string json = R"EOF(
+  {
+    "stats_flush_interval": "10s",
+    "stats_full_flush_interval": "300s"
+  }
+  )EOF";
+
+  auto bootstrap = Upstream::parseBootstrapFromV3Json(json);
+  MainImpl config;
+  EXPECT_TRUE(config.initialize(bootstrap, server_, cluster_manager_factory_).ok());
+  EXPECT_EQ(30, config.statsConfig().fullFlushOnFlush());
+}
+
+TEST_F(ConfigurationImplTest, FullFlushNotMultiple) {
+  std::string json = R"EOF(
+  {
+    "stats_flush_interval": "10s",
+    "stats_full_flush_interval": "15s"
+  }
+  )EOF";
+
+  auto bootstrap = Upstream::parseBootstrapFromV3Json(json);
+  MainImpl config;
+  EXPECT_THAT(config.initialize(bootstrap, server_, cluster_manager_factory_).message(),
+              testing::HasSubstr("must be a multiple"));
+}
+
 TEST_F(ConfigurationImplTest, SetUpstreamClusterPerConnectionBufferLimit) {
   const std::string json = R"EOF(
   {
@@ -542,6 +542,27 @@ TEST_F(OptionsImplTest, SetCpusetOnly) {
   EXPECT_NE(options->concurrency(), 0);
 }
 
+TEST_F(OptionsImplTest, WorkerCpus) {
+  std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy -c hello --worker-cpus 2,3,6");
+  EXPECT_EQ(std::vector<uint32_t>({2, 3, 6}), options->workerCpus());
+  // One worker is run per listed CPU.
+  EXPECT_EQ(3, options->concurrency());
+  Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
+  EXPECT_THAT(command_line_options->worker_cpus(), testing::ElementsAre(2, 3, 6));
+
+  options = createOptionsImpl("envoy -c hello --worker-cpus 0,1 --concurrency 2");
+  EXPECT_EQ(2, options->concurrency());
+  EXPECT_TRUE(createOptionsImpl("envoy -c hello")->workerCpus().empty());
+}
+
+TEST_F(OptionsImplTest, InvalidWorkerCpus) {
+  EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --worker-cpus 0,x"),
+                          MalformedArgvException, "error: invalid worker CPU 'x'");
+  EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --worker-cpus 0,1 --concurrency 3"),
+                          MalformedArgvException,
+                          "error: --worker-cpus lists 2 CPUs but --concurrency is 3");
+}
+
 TEST_F(OptionsImplTest, LogFormatDefault) {
   std::unique_ptr<OptionsImpl> options = createOptionsImpl({"envoy", "-c", "hello"});
   EXPECT_EQ(options->logFormat(), "[%Y-%m-%d %T.%e][%t][%l][%n] [%g:%#] %v");
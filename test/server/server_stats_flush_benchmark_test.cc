@@ -1,16 +1,24 @@
+#include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <memory>
 
+#include "envoy/config/metrics/v3/stats.pb.h"
 #include "envoy/stats/sink.h"
 #include "envoy/stats/stats.h"
 
+#include "source/common/stats/histogram_impl.h"
 #include "source/common/stats/thread_local_store.h"
 #include "source/server/server.h"
 
 #include "test/benchmark/main.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/server/server_factory_context.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/cluster_manager.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "absl/strings/str_cat.h"
@@ -55,14 +63,15 @@ public:
     // Create counters
     for (uint64_t idx = 0; idx < num_stats; ++idx) {
       auto stat_name = pool_.add(absl::StrCat("counter.", idx));
-      stats_store_.rootScope()->counterFromStatName(stat_name).inc();
+      counters_.push_back(&stats_store_.rootScope()->counterFromStatName(stat_name));
+      counters_.back()->inc();
     }
     // Create gauges
     for (uint64_t idx = 0; idx < num_stats; ++idx) {
       auto stat_name = pool_.add(absl::StrCat("gauge.", idx));
-      stats_store_.rootScope()
-          ->gaugeFromStatName(stat_name, Stats::Gauge::ImportMode::NeverImport)
-          .set(idx);
+      gauges_.push_back(&stats_store_.rootScope()->gaugeFromStatName(
+          stat_name, Stats::Gauge::ImportMode::NeverImport));
+      gauges_.back()->set(idx);
     }
 
     // Create text readouts
@@ -88,6 +97,27 @@ public:
     }
   }
 
+  // Between flushes, changed_percent of the counters and gauges change. Only those are included
+  // in the flushes, except for the first one.
+  void testPartial(::benchmark::State& state, uint32_t changed_percent) {
+    const size_t num_changed = std::max<size_t>(1, counters_.size() * changed_percent / 100);
+    Server::MetricDeltaTracker tracker(std::numeric_limits<uint32_t>::max());
+    std::list<Stats::SinkPtr> sinks;
+    sinks.emplace_back(new testing::NiceMock<Stats::MockSink>());
+    Server::InstanceUtil::flushMetricsToSinks(sinks, stats_store_, cm_, time_system_, tracker);
+    size_t next = 0;
+    for (auto _ : state) {
+      UNREFERENCED_PARAMETER(_);
+      state.PauseTiming();
+      for (size_t i = 0; i < num_changed; ++i, ++next) {
+        counters_[next % counters_.size()]->inc();
+        gauges_[next % gauges_.size()]->inc();
+      }
+      state.ResumeTiming();
+      Server::InstanceUtil::flushMetricsToSinks(sinks, stats_store_, cm_, time_system_, tracker);
+    }
+  }
+
 private:
   Stats::SymbolTableImpl symbol_table_;
   Stats::StatNamePool pool_;
@@ -95,6 +125,61 @@ private:
   Stats::ThreadLocalStoreImpl stats_store_;
   Event::SimulatedTimeSystem time_system_;
   FastMockClusterManager cm_;
+  std::vector<Stats::Counter*> counters_;
+  std::vector<Stats::Gauge*> gauges_;
+};
+
+class HistogramMergeSpeedTest {
+public:
+  HistogramMergeSpeedTest(size_t num_histograms, uint32_t merge_threads)
+      : pool_(symbol_table_), stats_allocator_(symbol_table_),
+        stats_store_(stats_allocator_, Thread::threadFactoryForTest()) {
+    envoy::config::metrics::v3::StatsConfig config;
+    config.set_histogram_merge_threads(merge_threads);
+    stats_store_.setHistogramSettings(
+        std::make_unique<Stats::HistogramSettingsImpl>(config, server_context_));
+    stats_store_.initializeThreading(dispatcher_, tls_);
+
+    for (uint64_t idx = 0; idx < num_histograms; ++idx) {
+      auto stat_name = pool_.add(absl::StrCat("histogram.", idx));
+      histograms_.push_back(&stats_store_.rootScope()->histogramFromStatName(
+          stat_name, Stats::Histogram::Unit::Unspecified));
+      histograms_.back()->recordValue(idx);
+    }
+    // After the first merge all histograms are considered used, and are merged at every flush.
+    stats_store_.mergeHistograms([]() {});
+  }
+
+  ~HistogramMergeSpeedTest() {
+    tls_.shutdownGlobalThreading();
+    stats_store_.shutdownThreading();
+    tls_.shutdownThread();
+  }
+
+  // Between flushes, active_percent of the histograms record a value.
+  void test(::benchmark::State& state, uint32_t active_percent) {
+    const size_t num_active = std::max<size_t>(1, histograms_.size() * active_percent / 100);
+    size_t next = 0;
+    for (auto _ : state) {
+      UNREFERENCED_PARAMETER(_);
+      state.PauseTiming();
+      for (size_t i = 0; i < num_active; ++i, ++next) {
+        histograms_[next % histograms_.size()]->recordValue(next);
+      }
+      state.ResumeTiming();
+      stats_store_.mergeHistograms([]() {});
+    }
+  }
+
+private:
+  Stats::SymbolTableImpl symbol_table_;
+  Stats::StatNamePool pool_;
+  Stats::Allocator stats_allocator_;
+  testing::NiceMock<Event::MockDispatcher> dispatcher_;
+  testing::NiceMock<ThreadLocal::MockInstance> tls_;
+  testing::NiceMock<Server::Configuration::MockServerFactoryContext> server_context_;
+  Stats::ThreadLocalStoreImpl stats_store_;
+  std::vector<Stats::Histogram*> histograms_;
 };
 
 static void bmFlushToSinks(::benchmark::State& state) {
@@ -119,10 +204,43 @@ static void bmFlushToSinksWithPredicatesSet(::benchmark::State& state) {
   speed_test.test(state);
 }
 
+// Flushes partial snapshots of state.range(0) metrics of each type, of which state.range(1)
+// percent changed since the previous flush.
+static void bmFlushChangedToSinks(::benchmark::State& state) {
+  // Skip expensive benchmarks for unit tests.
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 100) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  StatsSinkFlushSpeedTest speed_test(state.range(0));
+  speed_test.testPartial(state, state.range(1));
+}
+
 BENCHMARK(bmFlushToSinks)->Unit(::benchmark::kMillisecond)->RangeMultiplier(10)->Range(10, 1000000);
+BENCHMARK(bmFlushChangedToSinks)
+    ->Unit(::benchmark::kMillisecond)
+    ->ArgsProduct({{100, 10000, 1000000}, {1, 10, 100}});
 BENCHMARK(bmFlushToSinksWithPredicatesSet)
     ->Unit(::benchmark::kMillisecond)
     ->RangeMultiplier(10)
     ->Range(10, 1000000);
 
+// Measures the main thread time of merging state.range(0) histograms, of which state.range(2)
+// percent recorded values since the last merge, using state.range(1) helper threads.
+static void bmMergeHistograms(::benchmark::State& state) {
+  // Skip expensive benchmarks for unit tests.
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 1000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  HistogramMergeSpeedTest speed_test(state.range(0), state.range(1));
+  speed_test.test(state, state.range(2));
+}
+
+BENCHMARK(bmMergeHistograms)
+    ->Unit(::benchmark::kMillisecond)
+    ->ArgsProduct({{1000, 10000, 100000, 300000}, {0, 2, 4}, {1, 100}});
+
 } // namespace Envoy
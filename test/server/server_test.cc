@@ -164,6 +164,51 @@ TEST(ServerInstanceUtil, flushImportModeUninitializedGauges) {
   InstanceUtil::flushMetricsToSinks(sinks, store, cm, time_system);
 }
 
+// With a delta tracker, flushes between full flushes only include the metrics that changed.
+TEST(ServerInstanceUtil, flushPartialSnapshots) {
+  InSequence s;
+
+  NiceMock<Upstream::MockClusterManager> cm;
+  Stats::TestUtil::TestStore store;
+  Event::SimulatedTimeSystem time_system;
+  Stats::Counter& hot = store.counter("hot");
+  Stats::Counter& cold = store.counter("cold");
+  Stats::Gauge& moving = store.gauge("moving", Stats::Gauge::ImportMode::Accumulate);
+  Stats::Gauge& still = store.gauge("still", Stats::Gauge::ImportMode::Accumulate);
+  hot.inc();
+  cold.inc();
+  moving.set(1);
+  still.set(1);
+
+  std::list<Stats::SinkPtr> sinks;
+  Stats::MockSink* sink = new StrictMock<Stats::MockSink>();
+  sinks.emplace_back(sink);
+  MetricDeltaTracker tracker(3);
+  auto flush_expecting = [&](bool partial, size_t counters, size_t gauges) {
+    EXPECT_CALL(*sink, flush(_)).WillOnce(Invoke([=](Stats::MetricSnapshot& snapshot) {
+      EXPECT_EQ(partial, snapshot.partial());
+      EXPECT_EQ(counters, snapshot.counters().size());
+      EXPECT_EQ(gauges, snapshot.gauges().size());
+    }));
+    InstanceUtil::flushMetricsToSinks(sinks, store, cm, time_system, tracker);
+  };
+
+  // The first flush is a full one.
+  flush_expecting(false, 2, 2);
+  hot.inc();
+  moving.set(2);
+  flush_expecting(true, 1, 1);
+  // Nothing changed.
+  flush_expecting(true, 0, 0);
+  // Full flushes include everything, and counters that were not included were still latched.
+  hot.inc();
+  flush_expecting(false, 2, 2);
+  EXPECT_EQ(0, hot.latch());
+  // A gauge that is set to its previous value did not change.
+  still.set(1);
+  flush_expecting(true, 0, 0);
+}
+
 TEST(ServerInstanceUtil, RaiseFileLimits) {
   Api::MockOsSysCalls os_sys_calls_;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls{&os_sys_calls_};